@@ -14,6 +14,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * @{
  */
 
+#define ERRFILE_pmcprof ( ERRFILE_ARCH | ERRFILE_OTHER | 0x00000000 )
+
 /** @} */
 
 #endif /* _BITS_ERRFILE_H */
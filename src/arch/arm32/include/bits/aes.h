@@ -0,0 +1,54 @@
+#ifndef _BITS_AES_H
+#define _BITS_AES_H
+
+/** @file
+ *
+ * AES algorithm
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+struct aes_context;
+
+/**
+ * Check for accelerated AES support
+ *
+ * @ret supported	Accelerated AES is supported
+ */
+static inline __attribute__ (( always_inline )) int
+aes_accel_supported ( void ) {
+
+	/* Not yet optimised */
+	return 0;
+}
+
+/**
+ * Encrypt data block using accelerated AES
+ *
+ * @v aes		AES context
+ * @v src		Data to encrypt
+ * @v dst		Buffer for encrypted data
+ */
+static inline __attribute__ (( always_inline )) void
+aes_accel_encrypt ( struct aes_context *aes __unused,
+		    const void *src __unused, void *dst __unused ) {
+
+	/* Can never be reached */
+}
+
+/**
+ * Decrypt data block using accelerated AES
+ *
+ * @v aes		AES context
+ * @v src		Data to decrypt
+ * @v dst		Buffer for decrypted data
+ */
+static inline __attribute__ (( always_inline )) void
+aes_accel_decrypt ( struct aes_context *aes __unused,
+		    const void *src __unused, void *dst __unused ) {
+
+	/* Can never be reached */
+}
+
+#endif /* _BITS_AES_H */
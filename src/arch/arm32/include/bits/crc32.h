@@ -0,0 +1,19 @@
+#ifndef _BITS_CRC32_H
+#define _BITS_CRC32_H
+
+/** @file
+ *
+ * CRC32 (little-endian) checksums
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+static inline __attribute__ (( always_inline )) u32
+crc32_le ( u32 seed, const void *data, size_t len ) {
+
+	/* Not yet optimised */
+	return generic_crc32_le ( seed, data, len );
+}
+
+#endif /* _BITS_CRC32_H */
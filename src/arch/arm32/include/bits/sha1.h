@@ -0,0 +1,37 @@
+#ifndef _BITS_SHA1_H
+#define _BITS_SHA1_H
+
+/** @file
+ *
+ * SHA-1 algorithm
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+union sha1_digest_data_dwords;
+
+/**
+ * Check for accelerated SHA-1 support
+ *
+ * @ret supported	Accelerated SHA-1 is supported
+ */
+static inline __attribute__ (( always_inline )) int
+sha1_accel_supported ( void ) {
+
+	/* Not yet optimised */
+	return 0;
+}
+
+/**
+ * Calculate SHA-1 digest of data block using accelerated SHA-1
+ *
+ * @v ddd		SHA-1 digest and data block
+ */
+static inline __attribute__ (( always_inline )) void
+sha1_accel_digest ( union sha1_digest_data_dwords *ddd __unused ) {
+
+	/* Can never be reached */
+}
+
+#endif /* _BITS_SHA1_H */
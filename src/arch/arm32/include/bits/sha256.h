@@ -0,0 +1,37 @@
+#ifndef _BITS_SHA256_H
+#define _BITS_SHA256_H
+
+/** @file
+ *
+ * SHA-256 algorithm
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+union sha256_digest_data_dwords;
+
+/**
+ * Check for accelerated SHA-256 support
+ *
+ * @ret supported	Accelerated SHA-256 is supported
+ */
+static inline __attribute__ (( always_inline )) int
+sha256_accel_supported ( void ) {
+
+	/* Not yet optimised */
+	return 0;
+}
+
+/**
+ * Calculate SHA-256 digest of data block using accelerated SHA-256
+ *
+ * @v ddd		SHA-256 digest and data block
+ */
+static inline __attribute__ (( always_inline )) void
+sha256_accel_digest ( union sha256_digest_data_dwords *ddd __unused ) {
+
+	/* Can never be reached */
+}
+
+#endif /* _BITS_SHA256_H */
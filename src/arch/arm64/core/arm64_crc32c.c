@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksums
+ *
+ * The optional ARMv8 CRC32 extension provides instructions
+ * implementing exactly the CRC32C polynomial, processing up to eight
+ * bytes per instruction.
+ *
+ */
+
+#include <ipxe/crc32c.h>
+
+/** CRC32 field within ID_AA64ISAR0_EL1 */
+#define ID_AA64ISAR0_EL1_CRC32(isar0) ( ( (isar0) >> 16 ) & 0xf )
+
+/**
+ * Check for ARMv8 CRC32 instruction support
+ *
+ * @ret supported	CRC32 instructions are supported
+ */
+static int crc32c_supported ( void ) {
+	static int supported = -1;
+	uint64_t isar0;
+
+	/* Determine support from ID_AA64ISAR0_EL1, if not yet known */
+	if ( supported < 0 ) {
+		__asm__ ( "mrs %0, id_aa64isar0_el1" : "=r" ( isar0 ) );
+		supported = ( ID_AA64ISAR0_EL1_CRC32 ( isar0 ) ? 1 : 0 );
+		DBG ( "CRC32C instructions are%s supported\n",
+		      ( supported ? "" : " not" ) );
+	}
+
+	return supported;
+}
+
+/**
+ * Calculate 32-bit Castagnoli CRC checksum
+ *
+ * @v seed	Initial value
+ * @v data	Data to checksum
+ * @v len	Length of data
+ * @ret crc	Updated CRC checksum value
+ */
+uint32_t crc32c ( uint32_t seed, const void *data, size_t len ) {
+	uint32_t crc = seed;
+	const uint8_t *src = data;
+
+	/* Use generic implementation if instructions are not supported */
+	if ( ! crc32c_supported() )
+		return generic_crc32c ( seed, data, len );
+
+	/* Process whole doublewords */
+	while ( len >= sizeof ( uint64_t ) ) {
+		__asm__ ( ".arch_extension crc\n\t"
+			  "crc32cx %w0, %w0, %1"
+			  : "+r" ( crc )
+			  : "r" ( *( ( const uint64_t * ) src ) ) );
+		src += sizeof ( uint64_t );
+		len -= sizeof ( uint64_t );
+	}
+
+	/* Process remaining bytes */
+	while ( len-- ) {
+		__asm__ ( ".arch_extension crc\n\t"
+			  "crc32cb %w0, %w0, %w1"
+			  : "+r" ( crc )
+			  : "r" ( *src ) );
+		src++;
+	}
+
+	return crc;
+}
@@ -30,6 +30,22 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <string.h>
+#include <ipxe/init.h>
+
+/** Minimum length for which to prefer a SIMD copy
+ *
+ * Below this length the general-purpose register pair loop is at
+ * least as fast and avoids touching vector state at all.
+ */
+#define MEMCPY_SIMD_THRESHOLD 64
+
+/** SIMD register access is enabled and usable for bulk copies
+ *
+ * Advanced SIMD is architecturally mandatory, but access to the
+ * vector register file may be trapped (CPACR_EL1.FPEN / CPTR_EL2),
+ * so it is checked once at startup rather than assumed.
+ */
+static int memcpy_simd;
 
 /**
  * Copy memory area
@@ -48,6 +64,39 @@ void arm64_memcpy ( void *dest, const void *src, size_t len ) {
 	unsigned long discard_low;
 	unsigned long discard_high;
 
+	/* Use quadword register pairs to copy 32 bytes at a time for
+	 * bulk copies, where the vector register file is usable: one
+	 * initial potentially unaligned access, multiple
+	 * destination-aligned accesses, one final potentially
+	 * unaligned access.  The flag never changes after startup, so
+	 * this branch predicts perfectly.
+	 */
+	if ( memcpy_simd && ( len >= MEMCPY_SIMD_THRESHOLD ) ) {
+		__asm__ __volatile__ ( "ldp q0, q1, [%1], #32\n\t"
+				       "stp q0, q1, [%0], #32\n\t"
+				       "and %3, %0, #31\n\t"
+				       "sub %0, %0, %3\n\t"
+				       "sub %1, %1, %3\n\t"
+				       "bic %2, %4, #31\n\t"
+				       "b 2f\n\t"
+				       "\n1:\n\t"
+				       "ldp q0, q1, [%1], #32\n\t"
+				       "stp q0, q1, [%0], #32\n\t"
+				       "\n2:\n\t"
+				       "cmp %0, %2\n\t"
+				       "bne 1b\n\t"
+				       "ldp q0, q1, [%5, #-32]\n\t"
+				       "stp q0, q1, [%4, #-32]\n\t"
+				       : "=&r" ( discard_dest ),
+					 "=&r" ( discard_src ),
+					 "=&r" ( discard_end ),
+					 "=&r" ( discard_offset )
+				       : "r" ( dest + len ), "r" ( src + len ),
+					 "0" ( dest ), "1" ( src )
+				       : "memory", "cc", "v0", "v1" );
+		return;
+	}
+
 	/* If length is too short for an "ldp"/"stp" instruction pair,
 	 * then just copy individual bytes.
 	 */
@@ -106,6 +155,29 @@ void arm64_bzero ( void *dest, size_t len ) {
 	void *discard_dest;
 	void *discard_end;
 
+	/* Use quadword register pairs to zero 32 bytes at a time for
+	 * bulk zeroing, where the vector register file is usable (as
+	 * for arm64_memcpy()).
+	 */
+	if ( memcpy_simd && ( len >= MEMCPY_SIMD_THRESHOLD ) ) {
+		__asm__ __volatile__ ( "movi v0.2d, #0\n\t"
+				       "stp q0, q0, [%0], #32\n\t"
+				       "bic %0, %0, #31\n\t"
+				       "bic %1, %2, #31\n\t"
+				       "b 2f\n\t"
+				       "\n1:\n\t"
+				       "stp q0, q0, [%0], #32\n\t"
+				       "\n2:\n\t"
+				       "cmp %0, %1\n\t"
+				       "bne 1b\n\t"
+				       "stp q0, q0, [%2, #-32]\n\t"
+				       : "=&r" ( discard_dest ),
+					 "=&r" ( discard_end )
+				       : "r" ( dest + len ), "0" ( dest )
+				       : "memory", "cc", "v0" );
+		return;
+	}
+
 	/* If length is too short for an "stp" instruction, then just
 	 * zero individual bytes.
 	 */
@@ -247,3 +319,51 @@ void arm64_memmove ( void *dest, const void *src, size_t len ) {
 		arm64_memmove_backwards ( dest, src, len );
 	}
 }
+
+/**
+ * Detect available string operation optimisations
+ *
+ * Mirrors the x86 startup-time dispatch: the selection flag is set
+ * once here and never changes, so the per-call checks are
+ * perfectly-predicted branches.
+ */
+static void arm64_string_init ( void ) {
+	unsigned long el;
+	unsigned long ctrl;
+
+	/* Use SIMD copies only where access to the vector register
+	 * file is already enabled for our current exception level;
+	 * we do not take ownership of the trap configuration.
+	 */
+	__asm__ ( "mrs %0, CurrentEL" : "=r" ( el ) );
+	switch ( el >> 2 ) {
+	case 1:
+		/* EL1: usable unless CPACR_EL1.FPEN traps EL1 */
+		__asm__ ( "mrs %0, CPACR_EL1" : "=r" ( ctrl ) );
+		memcpy_simd = ( !! ( ctrl & ( 1UL << 20 ) ) );
+		break;
+	case 2:
+		/* EL2: trap control depends on HCR_EL2.E2H */
+		__asm__ ( "mrs %0, HCR_EL2" : "=r" ( ctrl ) );
+		if ( ctrl & ( 1UL << 34 ) ) {
+			/* E2H: usable unless CPTR_EL2.FPEN traps EL2 */
+			__asm__ ( "mrs %0, CPTR_EL2" : "=r" ( ctrl ) );
+			memcpy_simd = ( !! ( ctrl & ( 1UL << 20 ) ) );
+		} else {
+			/* Usable unless CPTR_EL2.TFP is set */
+			__asm__ ( "mrs %0, CPTR_EL2" : "=r" ( ctrl ) );
+			memcpy_simd = ( ! ( ctrl & ( 1UL << 10 ) ) );
+		}
+		break;
+	default:
+		memcpy_simd = 0;
+		break;
+	}
+	if ( memcpy_simd )
+		DBG ( "MEMCPY using SIMD register pairs\n" );
+}
+
+/** String operation initialisation function */
+struct init_fn arm64_string_init_fn __init_fn ( INIT_EARLY ) = {
+	.initialise = arm64_string_init,
+};
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Performance counter profiling
+ *
+ * Enables the performance monitors cycle counter (PMCCNTR_EL0) so
+ * that profile_pmc() can attach a true core cycle count to any
+ * profiler as a secondary dimension, complementing the
+ * fixed-frequency generic timer used for profiling timestamps.
+ */
+
+#include <errno.h>
+#include <ipxe/init.h>
+#include <ipxe/profile.h>
+
+/** Performance monitors control register: enable */
+#define PMCR_EL0_E 0x00000001UL
+
+/** Performance monitors control register: reset cycle counter */
+#define PMCR_EL0_C 0x00000004UL
+
+/** Performance monitors count enable: cycle counter */
+#define PMCNTENSET_EL0_C ( 1UL << 31 )
+
+/**
+ * Enable fixed-function performance counter
+ *
+ * @ret rc		Return status code
+ */
+int profile_pmc_enable ( void ) {
+	uint64_t dfr0;
+	uint64_t pmcr;
+	unsigned int pmuver;
+
+	/* Check that a performance monitors extension is implemented */
+	__asm__ ( "mrs %0, ID_AA64DFR0_EL1" : "=r" ( dfr0 ) );
+	pmuver = ( ( dfr0 >> 8 ) & 0xf );
+	if ( ( pmuver == 0x0 ) || ( pmuver == 0xf ) )
+		return -ENOTSUP;
+
+	/* Enable and reset the cycle counter */
+	__asm__ ( "mrs %0, PMCR_EL0" : "=r" ( pmcr ) );
+	pmcr |= ( PMCR_EL0_E | PMCR_EL0_C );
+	__asm__ __volatile__ ( "msr PMCR_EL0, %0" : : "r" ( pmcr ) );
+	__asm__ __volatile__ ( "msr PMCNTENSET_EL0, %0"
+			       : : "r" ( PMCNTENSET_EL0_C ) );
+
+	/* Mark performance counter sampling as enabled */
+	profile_pmc_enabled = 1;
+
+	return 0;
+}
+
+/**
+ * Record generic timer frequency
+ *
+ * Profiling timestamps are taken from the generic timer counter
+ * (CNTVCT_EL0), whose fixed frequency is reported by CNTFRQ_EL0.
+ * Expose it to the profiler so that timestamp deltas can be converted
+ * to wall-clock time, as on x86.
+ */
+static void cntfrq_init ( void ) {
+	uint64_t cntfrq;
+
+	/* Read generic timer frequency */
+	__asm__ ( "mrs %0, CNTFRQ_EL0" : "=r" ( cntfrq ) );
+
+	/* Expose frequency for profiler cycle count conversions */
+	profile_mhz = ( cntfrq / 1000000 );
+}
+
+/** Generic timer frequency initialisation function */
+struct init_fn cntfrq_init_fn __init_fn ( INIT_NORMAL ) = {
+	.initialise = cntfrq_init,
+};
@@ -15,6 +15,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Element of a big integer */
 typedef uint64_t bigint_element_t;
 
+/** Type capable of holding the product of two big integer elements */
+typedef unsigned __int128 bigint_dual_element_t;
+
 /**
  * Initialise big integer
  *
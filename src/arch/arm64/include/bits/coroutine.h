@@ -0,0 +1,34 @@
+#ifndef _BITS_COROUTINE_H
+#define _BITS_COROUTINE_H
+
+/** @file
+ *
+ * Coroutines
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <setjmp.h>
+
+/**
+ * Prime a jump buffer to begin execution on a new stack
+ *
+ * @v env		Jump buffer
+ * @v stack_top		Top of stack (16-byte aligned)
+ * @v fn		Function to begin executing (which must not return)
+ *
+ * longjmp() restores the stack pointer directly and returns via the
+ * saved link register.  The frame pointer is zeroed to terminate
+ * backtraces within the coroutine.
+ */
+static inline void coroutine_prime ( jmp_buf env, void *stack_top,
+				     void ( * fn ) ( void ) ) {
+
+	env->x29 = 0;
+	env->x30 = ( ( intptr_t ) fn );
+	env->sp = ( ( intptr_t ) stack_top );
+}
+
+#endif /* _BITS_COROUTINE_H */
@@ -25,4 +25,26 @@ profile_timestamp ( void ) {
 	return cycles;
 }
 
+/** Architecture provides a fixed-function performance counter
+ *
+ * The counter records true core cycles (PMCCNTR_EL0, enabled by
+ * profile_pmc_enable()), as opposed to the fixed-frequency generic
+ * timer used for profiling timestamps.
+ */
+#define PROFILE_PMC 1
+
+/**
+ * Read fixed-function performance counter
+ *
+ * @ret pmc		Core cycle count
+ */
+static inline __attribute__ (( always_inline )) uint64_t
+profile_pmc ( void ) {
+	uint64_t cycles;
+
+	/* Read performance monitors cycle counter */
+	__asm__ __volatile__ ( "mrs %0, PMCCNTR_EL0\n\t" : "=r" ( cycles ) );
+	return cycles;
+}
+
 #endif /* _BITS_PROFILE_H */
@@ -25,4 +25,26 @@ profile_timestamp ( void ) {
 	return tsc;
 }
 
+/** Architecture provides a fixed-function performance counter
+ *
+ * The counter records retired instructions (architectural
+ * fixed-function counter 0, enabled by profile_pmc_enable()).
+ */
+#define PROFILE_PMC 1
+
+/**
+ * Read fixed-function performance counter
+ *
+ * @ret pmc		Retired instruction count
+ */
+static inline __attribute__ (( always_inline )) uint64_t
+profile_pmc ( void ) {
+	uint64_t pmc;
+
+	/* Read fixed-function counter 0 (instructions retired) */
+	__asm__ __volatile__ ( "rdpmc" : "=A" ( pmc )
+			       : "c" ( 0x40000000UL ) );
+	return pmc;
+}
+
 #endif /* _BITS_PROFILE_H */
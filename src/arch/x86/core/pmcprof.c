@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Performance counter profiling
+ *
+ * Enables architectural fixed-function counter 0 (instructions
+ * retired) so that profile_pmc() can attach a retired instruction
+ * count to any profiler as a secondary dimension.  iPXE runs at
+ * CPL 0, so RDPMC is usable regardless of CR4.PCE.
+ */
+
+#include <errno.h>
+#include <ipxe/cpuid.h>
+#include <ipxe/msr.h>
+#include <ipxe/profile.h>
+
+/** Get architectural performance monitoring information */
+#define CPUID_PERFMON 0x0000000aUL
+
+/** Fixed counter control register */
+#define MSR_FIXED_CTR_CTRL 0x0000038d
+
+/** Enable fixed counter 0 at all privilege levels */
+#define MSR_FIXED_CTR_CTRL_EN0 0x00000003ULL
+
+/** Global performance counter control register */
+#define MSR_PERF_GLOBAL_CTRL 0x0000038f
+
+/** Enable fixed counter 0 */
+#define MSR_PERF_GLOBAL_CTRL_FIXED0 ( 1ULL << 32 )
+
+/**
+ * Enable fixed-function performance counter
+ *
+ * @ret rc		Return status code
+ */
+int profile_pmc_enable ( void ) {
+	uint32_t eax;
+	uint32_t ebx;
+	uint32_t ecx;
+	uint32_t edx;
+	unsigned int version;
+	unsigned int fixed;
+
+	/* Check for architectural performance monitoring with at
+	 * least one fixed-function counter.  Hypervisors commonly
+	 * report no counters at all, in which case we fail cleanly.
+	 */
+	if ( cpuid_supported ( CPUID_PERFMON ) != 0 )
+		return -ENOTSUP;
+	cpuid ( CPUID_PERFMON, 0, &eax, &ebx, &ecx, &edx );
+	version = ( eax & 0xff );
+	fixed = ( edx & 0x1f );
+	if ( ( version < 2 ) || ( fixed < 1 ) )
+		return -ENOTSUP;
+
+	/* Enable fixed counter 0 (instructions retired) */
+	wrmsr ( MSR_FIXED_CTR_CTRL,
+		( rdmsr ( MSR_FIXED_CTR_CTRL ) | MSR_FIXED_CTR_CTRL_EN0 ) );
+	wrmsr ( MSR_PERF_GLOBAL_CTRL,
+		( rdmsr ( MSR_PERF_GLOBAL_CTRL ) |
+		  MSR_PERF_GLOBAL_CTRL_FIXED0 ) );
+
+	/* Mark performance counter sampling as enabled */
+	profile_pmc_enabled = 1;
+
+	return 0;
+}
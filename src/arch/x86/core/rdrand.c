@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * RDRAND-based entropy source
+ *
+ * Unlike the RTC- and timer-based entropy sources, RDRAND requires
+ * no calibration and no waiting for timer events: seeding the DRBG
+ * takes microseconds rather than hundreds of milliseconds.
+ */
+
+#include <errno.h>
+#include <ipxe/cpuid.h>
+#include <ipxe/entropy.h>
+
+/** Number of times to retry the RDRAND instruction
+ *
+ * The hardware DRBG can transiently fail to return data if its output
+ * queue is empty.  The Intel Digital Random Number Generator Software
+ * Implementation Guide recommends retrying, with ten retries being
+ * sufficient in practice to guarantee success.
+ */
+#define RDRAND_MAX_RETRIES 16
+
+/**
+ * Enable entropy gathering
+ *
+ * @ret rc		Return status code
+ */
+static int rdrand_entropy_enable ( void ) {
+	uint32_t eax;
+	uint32_t ebx;
+	uint32_t ecx;
+	uint32_t edx;
+
+	/* Check that the RDRAND instruction is available */
+	if ( cpuid_supported ( CPUID_FEATURES ) != 0 ) {
+		DBG ( "RDRAND has no CPUID\n" );
+		return -ENOTSUP;
+	}
+	cpuid ( CPUID_FEATURES, 0, &eax, &ebx, &ecx, &edx );
+	if ( ! ( ecx & CPUID_FEATURES_INTEL_ECX_RDRAND ) ) {
+		DBG ( "RDRAND not supported by CPU\n" );
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+/**
+ * Disable entropy gathering
+ *
+ */
+static void rdrand_entropy_disable ( void ) {
+
+	/* Nothing to do */
+}
+
+/**
+ * Get noise sample
+ *
+ * @ret noise		Noise sample
+ * @ret rc		Return status code
+ */
+int rdrand_sample ( noise_sample_t *noise ) {
+	unsigned int retries;
+	uint32_t value;
+	uint8_t ok;
+
+	/* Retry in case the hardware DRBG output queue is
+	 * transiently empty.
+	 */
+	for ( retries = 0 ; retries < RDRAND_MAX_RETRIES ; retries++ ) {
+
+		/* Attempt to read a random value */
+		__asm__ __volatile__ ( "rdrand %0\n\t"
+				       "setc %1\n\t"
+				       : "=r" ( value ), "=qm" ( ok ) );
+		if ( ok ) {
+			*noise = value;
+			return 0;
+		}
+	}
+
+	DBG ( "RDRAND failed to become ready\n" );
+	return -EBUSY;
+}
+
+PROVIDE_ENTROPY_INLINE ( rdrand, min_entropy_per_sample );
+PROVIDE_ENTROPY ( rdrand, entropy_enable, rdrand_entropy_enable );
+PROVIDE_ENTROPY ( rdrand, entropy_disable, rdrand_entropy_disable );
+PROVIDE_ENTROPY_INLINE ( rdrand, get_noise );
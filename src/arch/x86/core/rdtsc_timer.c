@@ -33,6 +33,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <errno.h>
 #include <ipxe/timer.h>
 #include <ipxe/cpuid.h>
+#include <ipxe/profile.h>
 #include <ipxe/pit8254.h>
 
 /** Number of microseconds to use for TSC calibration */
@@ -111,6 +112,61 @@ static void rdtsc_udelay ( unsigned long usecs ) {
 	} while ( elapsed < threshold );
 }
 
+/**
+ * Get TSC frequency directly via CPUID, if reported
+ *
+ * @ret rc		Return status code
+ *
+ * Recent CPUs report the TSC frequency (or the information needed to
+ * derive it) directly via CPUID, allowing us to avoid wasting
+ * startup wall-clock time on a measured calibration spin.
+ */
+static int rdtsc_cpuid_frequency ( void ) {
+	uint32_t numerator;
+	uint32_t denominator;
+	uint32_t crystal;
+	uint32_t mhz;
+	uint32_t discard_b;
+	uint32_t discard_c;
+	uint32_t discard_d;
+	uint64_t hz;
+
+	/* Use TSC to core crystal clock ratio, if reported */
+	if ( cpuid_supported ( CPUID_TSC_CRYSTAL ) == 0 ) {
+		cpuid ( CPUID_TSC_CRYSTAL, 0, &denominator, &numerator,
+			&crystal, &discard_d );
+		if ( denominator && numerator && crystal ) {
+			hz = ( ( ( ( uint64_t ) crystal ) * numerator ) /
+			       denominator );
+			tsc_per_us = ( hz / 1000000 );
+			if ( tsc_per_us ) {
+				DBGC ( colour, "RDTSC has %ld tsc per us via "
+				       "%dHz crystal ratio %d/%d\n", tsc_per_us,
+				       crystal, numerator, denominator );
+				return 0;
+			}
+		}
+	}
+
+	/* Use processor base frequency, if reported.  The TSC on
+	 * invariant-TSC processors counts at the base frequency
+	 * regardless of the current core clock.
+	 */
+	if ( cpuid_supported ( CPUID_FREQUENCY ) == 0 ) {
+		cpuid ( CPUID_FREQUENCY, 0, &mhz, &discard_b, &discard_c,
+			&discard_d );
+		mhz &= 0xffff;
+		if ( mhz ) {
+			tsc_per_us = mhz;
+			DBGC ( colour, "RDTSC has %ld tsc per us via base "
+			       "frequency\n", tsc_per_us );
+			return 0;
+		}
+	}
+
+	return -ENOTSUP;
+}
+
 /**
  * Probe RDTSC timer
  *
@@ -139,17 +195,24 @@ static int rdtsc_probe ( void ) {
 		return -ENOTTY;
 	}
 
-	/* Calibrate udelay() timer via 8254 PIT */
-	before = rdtsc_raw();
-	pit8254_udelay ( TSC_CALIBRATE_US );
-	after = rdtsc_raw();
-	elapsed = ( after - before );
-	tsc_per_us = ( elapsed / TSC_CALIBRATE_US );
+	/* Calibrate udelay() timer via 8254 PIT, if frequency is not
+	 * reported directly
+	 */
+	if ( rdtsc_cpuid_frequency() != 0 ) {
+		before = rdtsc_raw();
+		pit8254_udelay ( TSC_CALIBRATE_US );
+		after = rdtsc_raw();
+		elapsed = ( after - before );
+		tsc_per_us = ( elapsed / TSC_CALIBRATE_US );
+	}
 	if ( ! tsc_per_us ) {
 		DBGC ( colour, "RDTSC has zero TSC per microsecond\n" );
 		return -EIO;
 	}
 
+	/* Expose frequency for profiler cycle count conversions */
+	profile_mhz = tsc_per_us;
+
 	/* Calibrate currticks() scaling factor */
 	tsc_scale = 31;
 	ticks_per_scaled_tsc = ( ( 1UL << tsc_scale ) /
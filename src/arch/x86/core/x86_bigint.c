@@ -26,12 +26,132 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <string.h>
 #include <ipxe/bigint.h>
+#include <ipxe/init.h>
+#include <ipxe/cpuid.h>
 
 /** @file
  *
  * Big integer support
  */
 
+#ifdef __x86_64__
+
+/** MULX/ADCX/ADOX instructions are supported and enabled */
+static int bigint_mulx;
+
+/**
+ * Multiply big integers using MULX/ADCX/ADOX
+ *
+ * @v multiplicand0	Element 0 of big integer to be multiplied
+ * @v multiplier0	Element 0 of big integer to be multiplied
+ * @v result0		Element 0 of big integer to hold result
+ * @v size		Number of elements (must be even)
+ *
+ * Operate on 64-bit words using the two independent carry chains
+ * provided by ADCX (carry flag) and ADOX (overflow flag), with MULX
+ * leaving both flags untouched.  Each row adds one multiplicand word
+ * multiplied by the whole multiplier into the result: the low product
+ * halves and the existing result words accumulate via the carry
+ * flag's chain, the high product halves via the overflow flag's
+ * chain.  This roughly halves the instruction count per product bit
+ * compared to the 32-bit MUL/ADC loop.
+ */
+static void bigint_multiply_raw_mulx ( const uint32_t *multiplicand0,
+				       const uint32_t *multiplier0,
+				       uint32_t *result0, unsigned int size ) {
+	unsigned int words = ( size / 2 );
+	const uint64_t *multiplicand = ( ( const void * ) multiplicand0 );
+	const uint64_t *multiplier = ( ( const void * ) multiplier0 );
+	bigint_t ( size * 2 ) __attribute__ (( may_alias )) *result =
+		( ( void * ) result0 );
+	uint64_t *result_elements;
+	uint64_t discard_lo;
+	uint64_t discard_hi;
+	uint64_t discard_carry;
+	const uint64_t *discard_S;
+	uint64_t *discard_r;
+	long discard_c;
+	unsigned int i;
+
+	/* Zero result */
+	memset ( result, 0, sizeof ( *result ) );
+
+	/* Multiply integers one row at a time.  As for the generic
+	 * version, the carry can never overflow beyond the end of the
+	 * result, since:
+	 *
+	 *     a < 2^{n}, b < 2^{n} => ab < 2^{2n}
+	 *
+	 * Note that "loop" and "lea" are used for loop control and
+	 * pointer arithmetic since (unlike "dec" and "inc") they
+	 * leave both carry chains' flags intact.
+	 */
+	for ( i = 0 ; i < words ; i++ ) {
+		result_elements = &( ( uint64_t * ) result->element )[i];
+		__asm__ __volatile__ ( "xor %k2, %k2\n\t" /* Clear CF and OF */
+				       "\n1:\n\t"
+				       "mulxq (%3), %0, %1\n\t"
+				       "adcxq %2, %0\n\t"
+				       "adoxq (%4), %0\n\t"
+				       "movq %0, (%4)\n\t"
+				       "movq %1, %2\n\t"
+				       "leaq 8(%3), %3\n\t"
+				       "leaq 8(%4), %4\n\t"
+				       "loop 1b\n\t"
+				       /* Collapse both carry chains
+					* into the final row word
+					*/
+				       "movl $0, %k0\n\t"
+				       "adcxq %0, %2\n\t"
+				       "adoxq %0, %2\n\t"
+				       "addq %2, (%4)\n\t"
+				       "jnc 3f\n\t"
+				       "\n2:\n\t"
+				       "leaq 8(%4), %4\n\t"
+				       "adcq $0, (%4)\n\t"
+				       "jc 2b\n\t"
+				       "\n3:\n\t"
+				       : "=&r" ( discard_lo ),
+					 "=&r" ( discard_hi ),
+					 "=&r" ( discard_carry ),
+					 "=&r" ( discard_S ),
+					 "=&r" ( discard_r ),
+					 "=&c" ( discard_c ),
+					 "+m" ( *result )
+				       : "d" ( multiplicand[i] ),
+					 "3" ( multiplier ),
+					 "4" ( result_elements ),
+					 "5" ( words ) );
+	}
+}
+
+/**
+ * Detect available big integer optimisations
+ *
+ */
+static void x86_bigint_init ( void ) {
+	uint32_t eax;
+	uint32_t ebx;
+	uint32_t ecx;
+	uint32_t edx;
+
+	/* Check for MULX (BMI2) and ADCX/ADOX (ADX) */
+	if ( cpuid_supported ( CPUID_SEF ) != 0 )
+		return;
+	cpuid ( CPUID_SEF, 0, &eax, &ebx, &ecx, &edx );
+	if ( ( ebx & CPUID_SEF_EBX_BMI2 ) && ( ebx & CPUID_SEF_EBX_ADX ) ) {
+		DBG ( "BIGINT using MULX/ADCX/ADOX\n" );
+		bigint_mulx = 1;
+	}
+}
+
+/** Big integer initialisation function */
+struct init_fn x86_bigint_init_fn __init_fn ( INIT_EARLY ) = {
+	.initialise = x86_bigint_init,
+};
+
+#endif /* __x86_64__ */
+
 /**
  * Multiply big integers
  *
@@ -58,6 +178,19 @@ void bigint_multiply_raw ( const uint32_t *multiplicand0,
 	uint32_t discard_d;
 	long index;
 
+#ifdef __x86_64__
+	/* Use MULX/ADCX/ADOX kernel where available.  The element
+	 * count is always even in practice (all supported key sizes
+	 * are multiples of 64 bits), but fall back to the generic
+	 * version if not.
+	 */
+	if ( bigint_mulx && ( ( size % 2 ) == 0 ) ) {
+		bigint_multiply_raw_mulx ( multiplicand0, multiplier0,
+					   result0, size );
+		return;
+	}
+#endif
+
 	/* Zero result */
 	memset ( result, 0, sizeof ( *result ) );
 
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksums
+ *
+ * The SSE4.2 CRC32 instruction implements exactly the CRC32C
+ * polynomial, and processes four bytes per instruction rather than
+ * one bit per iteration of the generic bitwise loop.
+ *
+ */
+
+#include <ipxe/cpuid.h>
+#include <ipxe/crc32c.h>
+
+/**
+ * Check for SSE4.2 CRC32 instruction support
+ *
+ * @ret supported	CRC32 instruction is supported
+ */
+static int crc32c_supported ( void ) {
+	static int supported = -1;
+	uint32_t eax;
+	uint32_t ebx;
+	uint32_t ecx;
+	uint32_t edx;
+
+	/* Determine support, if not yet known */
+	if ( supported < 0 ) {
+		if ( cpuid_supported ( CPUID_FEATURES ) == 0 ) {
+			cpuid ( CPUID_FEATURES, 0, &eax, &ebx, &ecx, &edx );
+			supported =
+				( ( ecx & CPUID_FEATURES_INTEL_ECX_SSE4_2 ) ?
+				  1 : 0 );
+		} else {
+			supported = 0;
+		}
+		DBG ( "CRC32C instruction is%s supported\n",
+		      ( supported ? "" : " not" ) );
+	}
+
+	return supported;
+}
+
+/**
+ * Calculate 32-bit Castagnoli CRC checksum
+ *
+ * @v seed	Initial value
+ * @v data	Data to checksum
+ * @v len	Length of data
+ * @ret crc	Updated CRC checksum value
+ */
+uint32_t crc32c ( uint32_t seed, const void *data, size_t len ) {
+	uint32_t crc = seed;
+	const uint8_t *src = data;
+
+	/* Use generic implementation if instruction is not supported */
+	if ( ! crc32c_supported() )
+		return generic_crc32c ( seed, data, len );
+
+	/* Process whole dwords */
+	while ( len >= sizeof ( uint32_t ) ) {
+		__asm__ ( "crc32l %1, %0"
+			  : "+r" ( crc )
+			  : "m" ( *( ( const uint32_t * ) src ) ) );
+		src += sizeof ( uint32_t );
+		len -= sizeof ( uint32_t );
+	}
+
+	/* Process remaining bytes */
+	while ( len-- ) {
+		__asm__ ( "crc32b %1, %0"
+			  : "+r" ( crc )
+			  : "m" ( *src ) );
+		src++;
+	}
+
+	return crc;
+}
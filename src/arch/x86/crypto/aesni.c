@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * AES algorithm using the AES instruction set (AES-NI)
+ *
+ * The generic AES implementation in crypto/aes.c already expands keys
+ * into exactly the schedules required by the AES instruction set: the
+ * encryption schedule comprises the raw round keys, and the
+ * decryption schedule comprises the InvMixColumns-transformed round
+ * keys in reverse order (as used by the AES-NI "equivalent inverse
+ * cipher").  We can therefore share the key expansion code and
+ * provide only the per-block encryption and decryption operations.
+ *
+ * Note that iPXE is compiled without compiler-generated SSE code
+ * (and, on x86_64, with -mno-sse), so the XMM registers used here do
+ * not need to be preserved.
+ */
+
+#include <ipxe/aes.h>
+#include <ipxe/cpuid.h>
+
+/**
+ * Check for AES instruction set support
+ *
+ * @ret supported	AES instruction set is supported
+ */
+int aes_accel_supported ( void ) {
+	static int supported = -1;
+	struct x86_features features;
+
+	/* Check CPU features, if not already checked */
+	if ( supported < 0 ) {
+		x86_features ( &features );
+		supported = ( ( features.intel.ecx &
+				CPUID_FEATURES_INTEL_ECX_AES ) ? 1 : 0 );
+		DBG ( "AESNI is%s supported\n", ( supported ? "" : " not" ) );
+	}
+
+	return supported;
+}
+
+/**
+ * Encrypt data block using AES instruction set
+ *
+ * @v aes		AES context
+ * @v src		Data to encrypt
+ * @v dst		Buffer for encrypted data
+ */
+void aes_accel_encrypt ( struct aes_context *aes, const void *src,
+			 void *dst ) {
+	union aes_matrix *key = aes->encrypt.key;
+	unsigned long intermediate = ( aes->rounds - 2 );
+
+	__asm__ __volatile__ ( /* Initial round (AddRoundKey) */
+			       "movdqu (%2), %%xmm0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "pxor %%xmm1, %%xmm0\n\t"
+			       /* Intermediate rounds */
+			       "\n1:\n\t"
+			       "add $" _S2 ( AES_BLOCKSIZE ) ", %0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "aesenc %%xmm1, %%xmm0\n\t"
+			       "dec %1\n\t"
+			       "jnz 1b\n\t"
+			       /* Final round */
+			       "add $" _S2 ( AES_BLOCKSIZE ) ", %0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "aesenclast %%xmm1, %%xmm0\n\t"
+			       "movdqu %%xmm0, (%3)\n\t"
+			       : "+r" ( key ), "+r" ( intermediate )
+			       : "r" ( src ), "r" ( dst )
+			       : "memory" );
+}
+
+/**
+ * Decrypt data block using AES instruction set
+ *
+ * @v aes		AES context
+ * @v src		Data to decrypt
+ * @v dst		Buffer for decrypted data
+ */
+void aes_accel_decrypt ( struct aes_context *aes, const void *src,
+			 void *dst ) {
+	union aes_matrix *key = aes->decrypt.key;
+	unsigned long intermediate = ( aes->rounds - 2 );
+
+	__asm__ __volatile__ ( /* Initial round (AddRoundKey) */
+			       "movdqu (%2), %%xmm0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "pxor %%xmm1, %%xmm0\n\t"
+			       /* Intermediate rounds */
+			       "\n1:\n\t"
+			       "add $" _S2 ( AES_BLOCKSIZE ) ", %0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "aesdec %%xmm1, %%xmm0\n\t"
+			       "dec %1\n\t"
+			       "jnz 1b\n\t"
+			       /* Final round */
+			       "add $" _S2 ( AES_BLOCKSIZE ) ", %0\n\t"
+			       "movdqu (%0), %%xmm1\n\t"
+			       "aesdeclast %%xmm1, %%xmm0\n\t"
+			       "movdqu %%xmm0, (%3)\n\t"
+			       : "+r" ( key ), "+r" ( intermediate )
+			       : "r" ( src ), "r" ( dst )
+			       : "memory" );
+}
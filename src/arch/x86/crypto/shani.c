@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * SHA-1 and SHA-256 algorithms using the SHA instruction set (SHA-NI)
+ *
+ * The SHA instructions operate on the digest state packed into XMM
+ * registers (in "ABEF"/"CDGH" order for SHA-256, and in reversed
+ * "ABCD" order with E handled separately for SHA-1), with the message
+ * schedule maintained four rounds at a time via the SHAxxxMSG
+ * instructions.  The register choreography below follows the
+ * canonical flows given in Intel's SHA extensions documentation.
+ *
+ * Note that iPXE is compiled without compiler-generated SSE code
+ * (and, on x86_64, with -mno-sse), so the XMM registers used here do
+ * not need to be preserved.
+ */
+
+#include <ipxe/sha1.h>
+#include <ipxe/sha256.h>
+#include <ipxe/cpuid.h>
+
+/** Byte order conversion shuffle mask (for each 32-bit lane) */
+static const uint8_t sha256_accel_bswap[16] __attribute__ (( aligned ( 16 )))
+	= { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+
+/** Byte order conversion shuffle mask (reversing all 16 bytes)
+ *
+ * The SHA-1 instructions expect the most significant message dword in
+ * the least significant lane, so the byte order conversion reverses
+ * the entire register rather than each 32-bit lane.
+ */
+static const uint8_t sha1_accel_bswap[16] __attribute__ (( aligned ( 16 ) ))
+	= { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+
+/**
+ * Check for SHA instruction set support
+ *
+ * @ret supported	SHA instruction set is supported
+ */
+static int shani_supported ( void ) {
+	static int supported = -1;
+	uint32_t eax;
+	uint32_t ebx;
+	uint32_t ecx;
+	uint32_t edx;
+
+	/* Check CPU features, if not already checked */
+	if ( supported < 0 ) {
+		if ( cpuid_supported ( CPUID_SEF ) == 0 ) {
+			cpuid ( CPUID_SEF, 0, &eax, &ebx, &ecx, &edx );
+			supported = ( ( ebx & CPUID_SEF_EBX_SHA ) ? 1 : 0 );
+		} else {
+			supported = 0;
+		}
+		DBG ( "SHANI is%s supported\n", ( supported ? "" : " not" ) );
+	}
+
+	return supported;
+}
+
+/**
+ * Check for accelerated SHA-1 support
+ *
+ * @ret supported	Accelerated SHA-1 is supported
+ */
+int sha1_accel_supported ( void ) {
+	return shani_supported();
+}
+
+/**
+ * Check for accelerated SHA-256 support
+ *
+ * @ret supported	Accelerated SHA-256 is supported
+ */
+int sha256_accel_supported ( void ) {
+	return shani_supported();
+}
+
+/**
+ * Calculate SHA-1 digest of data block using SHA instruction set
+ *
+ * @v ddd		SHA-1 digest and data block
+ *
+ * The digest and accumulated data remain in big-endian byte order
+ * throughout: byte order conversion is carried out via PSHUFB as the
+ * values pass through the XMM registers.
+ */
+void sha1_accel_digest ( union sha1_digest_data_dwords *ddd ) {
+	uint32_t saved[8] __attribute__ (( aligned ( 16 ) ));
+
+	__asm__ __volatile__ (
+		/* Load a message block (with byte order conversion) */
+		".macro sha1_load i, m0\n\t"
+		"movdqu 20+\\i*16(%0), \\m0\n\t"
+		"pshufb (%1), \\m0\n\t"
+		".endm\n\t"
+		/* Perform four rounds (with round function selector
+		 * \k) using schedule entries \m0, extending the
+		 * schedule into \m1 (without the trailing
+		 * SHA1MSG1/PXOR, which are omitted once the remaining
+		 * schedule no longer requires them)
+		 */
+		".macro sha1_part k, e0, e1, m0, m1\n\t"
+		"sha1nexte \\m0, \\e0\n\t"
+		"movdqa %%xmm1, \\e1\n\t"
+		"sha1msg2 \\m0, \\m1\n\t"
+		"sha1rnds4 $\\k, \\e0, %%xmm1\n\t"
+		".endm\n\t"
+		/* As above, including the schedule updates of \m2 and \m3 */
+		".macro sha1_full k, e0, e1, m0, m1, m2, m3\n\t"
+		"sha1_part \\k, \\e0, \\e1, \\m0, \\m1\n\t"
+		"sha1msg1 \\m0, \\m3\n\t"
+		"pxor \\m0, \\m2\n\t"
+		".endm\n\t"
+		/* Load digest (with byte order conversion) */
+		"movdqu 0(%0), %%xmm1\n\t"
+		"pshufb (%1), %%xmm1\n\t"
+		"movd 16(%0), %%xmm2\n\t"
+		"pshufb (%1), %%xmm2\n\t"
+		"movdqa %%xmm1, (%2)\n\t"
+		"movdqa %%xmm2, 16(%2)\n\t"
+		/* Rounds 0-3 (loading the message block) */
+		"sha1_load 0, %%xmm3\n\t"
+		"paddd %%xmm3, %%xmm2\n\t"
+		"movdqa %%xmm1, %%xmm0\n\t"
+		"sha1rnds4 $0, %%xmm2, %%xmm1\n\t"
+		/* Rounds 4-7 */
+		"sha1_load 1, %%xmm4\n\t"
+		"sha1nexte %%xmm4, %%xmm0\n\t"
+		"movdqa %%xmm1, %%xmm2\n\t"
+		"sha1rnds4 $0, %%xmm0, %%xmm1\n\t"
+		"sha1msg1 %%xmm4, %%xmm3\n\t"
+		/* Rounds 8-11 */
+		"sha1_load 2, %%xmm5\n\t"
+		"sha1nexte %%xmm5, %%xmm2\n\t"
+		"movdqa %%xmm1, %%xmm0\n\t"
+		"sha1rnds4 $0, %%xmm2, %%xmm1\n\t"
+		"sha1msg1 %%xmm5, %%xmm4\n\t"
+		"pxor %%xmm5, %%xmm3\n\t"
+		/* Rounds 12-15 (loading the final message block) */
+		"sha1_load 3, %%xmm6\n\t"
+		"sha1_full 0, %%xmm0, %%xmm2, %%xmm6, %%xmm3, %%xmm4, %%xmm5\n\t"
+		/* Rounds 16-67 (running the full message schedule) */
+		"sha1_full 0, %%xmm2, %%xmm0, %%xmm3, %%xmm4, %%xmm5, %%xmm6\n\t"
+		"sha1_full 1, %%xmm0, %%xmm2, %%xmm4, %%xmm5, %%xmm6, %%xmm3\n\t"
+		"sha1_full 1, %%xmm2, %%xmm0, %%xmm5, %%xmm6, %%xmm3, %%xmm4\n\t"
+		"sha1_full 1, %%xmm0, %%xmm2, %%xmm6, %%xmm3, %%xmm4, %%xmm5\n\t"
+		"sha1_full 1, %%xmm2, %%xmm0, %%xmm3, %%xmm4, %%xmm5, %%xmm6\n\t"
+		"sha1_full 1, %%xmm0, %%xmm2, %%xmm4, %%xmm5, %%xmm6, %%xmm3\n\t"
+		"sha1_full 2, %%xmm2, %%xmm0, %%xmm5, %%xmm6, %%xmm3, %%xmm4\n\t"
+		"sha1_full 2, %%xmm0, %%xmm2, %%xmm6, %%xmm3, %%xmm4, %%xmm5\n\t"
+		"sha1_full 2, %%xmm2, %%xmm0, %%xmm3, %%xmm4, %%xmm5, %%xmm6\n\t"
+		"sha1_full 2, %%xmm0, %%xmm2, %%xmm4, %%xmm5, %%xmm6, %%xmm3\n\t"
+		"sha1_full 2, %%xmm2, %%xmm0, %%xmm5, %%xmm6, %%xmm3, %%xmm4\n\t"
+		"sha1_full 3, %%xmm0, %%xmm2, %%xmm6, %%xmm3, %%xmm4, %%xmm5\n\t"
+		"sha1_full 3, %%xmm2, %%xmm0, %%xmm3, %%xmm4, %%xmm5, %%xmm6\n\t"
+		/* Rounds 68-79 (exhausting the message schedule) */
+		"sha1_part 3, %%xmm0, %%xmm2, %%xmm4, %%xmm5\n\t"
+		"pxor %%xmm4, %%xmm6\n\t"
+		"sha1_part 3, %%xmm2, %%xmm0, %%xmm5, %%xmm6\n\t"
+		"sha1nexte %%xmm6, %%xmm0\n\t"
+		"movdqa %%xmm1, %%xmm2\n\t"
+		"sha1rnds4 $3, %%xmm0, %%xmm1\n\t"
+		/* Add this block's contribution to the digest and
+		 * store (with byte order conversion)
+		 */
+		"sha1nexte 16(%2), %%xmm2\n\t"
+		"paddd (%2), %%xmm1\n\t"
+		"pshufb (%1), %%xmm1\n\t"
+		"movdqu %%xmm1, 0(%0)\n\t"
+		"pshufb (%1), %%xmm2\n\t"
+		"movd %%xmm2, 16(%0)\n\t"
+		".purgem sha1_full\n\t"
+		".purgem sha1_part\n\t"
+		".purgem sha1_load\n\t"
+		: : "r" ( ddd ), "r" ( sha1_accel_bswap ), "r" ( saved )
+		: "memory" );
+}
+
+/**
+ * Calculate SHA-256 digest of data block using SHA instruction set
+ *
+ * @v ddd		SHA-256 digest and data block
+ *
+ * The digest and accumulated data remain in big-endian byte order
+ * throughout: byte order conversion is carried out via PSHUFB as the
+ * values pass through the XMM registers.
+ */
+void sha256_accel_digest ( union sha256_digest_data_dwords *ddd ) {
+	uint32_t saved[8] __attribute__ (( aligned ( 16 ) ));
+
+	__asm__ __volatile__ (
+		/* Load a message block (with byte order conversion
+		 * and round constants added) and perform four rounds
+		 */
+		".macro sha256_load i, m0\n\t"
+		"movdqu 32+\\i*16(%0), \\m0\n\t"
+		"pshufb (%2), \\m0\n\t"
+		"movdqa \\m0, %%xmm0\n\t"
+		"movdqu \\i*16(%1), %%xmm7\n\t"
+		"paddd %%xmm7, %%xmm0\n\t"
+		"sha256rnds2 %%xmm1, %%xmm2\n\t"
+		"pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+		"sha256rnds2 %%xmm2, %%xmm1\n\t"
+		".endm\n\t"
+		/* Perform four rounds using schedule entries \m0,
+		 * extending the schedule into \m1 (without the
+		 * trailing SHA256MSG1, which is omitted once the
+		 * remaining schedule no longer requires it)
+		 */
+		".macro sha256_part i, m0, m1, m3\n\t"
+		"movdqa \\m0, %%xmm0\n\t"
+		"movdqu \\i*16(%1), %%xmm7\n\t"
+		"paddd %%xmm7, %%xmm0\n\t"
+		"sha256rnds2 %%xmm1, %%xmm2\n\t"
+		"movdqa \\m0, %%xmm7\n\t"
+		"palignr $4, \\m3, %%xmm7\n\t"
+		"paddd %%xmm7, \\m1\n\t"
+		"sha256msg2 \\m0, \\m1\n\t"
+		"pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+		"sha256rnds2 %%xmm2, %%xmm1\n\t"
+		".endm\n\t"
+		/* As above, including the schedule update of \m3 */
+		".macro sha256_full i, m0, m1, m3\n\t"
+		"sha256_part \\i, \\m0, \\m1, \\m3\n\t"
+		"sha256msg1 \\m0, \\m3\n\t"
+		".endm\n\t"
+		/* Load digest (with byte order conversion) and
+		 * repack into ABEF/CDGH order
+		 */
+		"movdqu 0(%0), %%xmm1\n\t"
+		"movdqu 16(%0), %%xmm2\n\t"
+		"pshufb (%2), %%xmm1\n\t"
+		"pshufb (%2), %%xmm2\n\t"
+		"pshufd $0xb1, %%xmm1, %%xmm7\n\t"
+		"pshufd $0x1b, %%xmm2, %%xmm2\n\t"
+		"movdqa %%xmm7, %%xmm1\n\t"
+		"palignr $8, %%xmm2, %%xmm1\n\t"
+		"pblendw $0xf0, %%xmm7, %%xmm2\n\t"
+		"movdqu %%xmm1, 0(%3)\n\t"
+		"movdqu %%xmm2, 16(%3)\n\t"
+		/* Rounds 0-15 (loading the message block) */
+		"sha256_load 0, %%xmm3\n\t"
+		"sha256_load 1, %%xmm4\n\t"
+		"sha256msg1 %%xmm4, %%xmm3\n\t"
+		"sha256_load 2, %%xmm5\n\t"
+		"sha256msg1 %%xmm5, %%xmm4\n\t"
+		"movdqu 32+3*16(%0), %%xmm6\n\t"
+		"pshufb (%2), %%xmm6\n\t"
+		"sha256_full 3, %%xmm6, %%xmm3, %%xmm5\n\t"
+		/* Rounds 16-51 (running the full message schedule) */
+		"sha256_full 4, %%xmm3, %%xmm4, %%xmm6\n\t"
+		"sha256_full 5, %%xmm4, %%xmm5, %%xmm3\n\t"
+		"sha256_full 6, %%xmm5, %%xmm6, %%xmm4\n\t"
+		"sha256_full 7, %%xmm6, %%xmm3, %%xmm5\n\t"
+		"sha256_full 8, %%xmm3, %%xmm4, %%xmm6\n\t"
+		"sha256_full 9, %%xmm4, %%xmm5, %%xmm3\n\t"
+		"sha256_full 10, %%xmm5, %%xmm6, %%xmm4\n\t"
+		"sha256_full 11, %%xmm6, %%xmm3, %%xmm5\n\t"
+		"sha256_full 12, %%xmm3, %%xmm4, %%xmm6\n\t"
+		/* Rounds 52-63 (exhausting the message schedule) */
+		"sha256_part 13, %%xmm4, %%xmm5, %%xmm3\n\t"
+		"sha256_part 14, %%xmm5, %%xmm6, %%xmm4\n\t"
+		"movdqa %%xmm6, %%xmm0\n\t"
+		"movdqu 15*16(%1), %%xmm7\n\t"
+		"paddd %%xmm7, %%xmm0\n\t"
+		"sha256rnds2 %%xmm1, %%xmm2\n\t"
+		"pshufd $0x0e, %%xmm0, %%xmm0\n\t"
+		"sha256rnds2 %%xmm2, %%xmm1\n\t"
+		/* Add this block's contribution to the digest,
+		 * repack, and store (with byte order conversion)
+		 */
+		"movdqu 0(%3), %%xmm7\n\t"
+		"paddd %%xmm7, %%xmm1\n\t"
+		"movdqu 16(%3), %%xmm7\n\t"
+		"paddd %%xmm7, %%xmm2\n\t"
+		"pshufd $0x1b, %%xmm1, %%xmm7\n\t"
+		"pshufd $0xb1, %%xmm2, %%xmm2\n\t"
+		"movdqa %%xmm7, %%xmm1\n\t"
+		"pblendw $0xf0, %%xmm2, %%xmm1\n\t"
+		"palignr $8, %%xmm7, %%xmm2\n\t"
+		"pshufb (%2), %%xmm1\n\t"
+		"pshufb (%2), %%xmm2\n\t"
+		"movdqu %%xmm1, 0(%0)\n\t"
+		"movdqu %%xmm2, 16(%0)\n\t"
+		".purgem sha256_full\n\t"
+		".purgem sha256_part\n\t"
+		".purgem sha256_load\n\t"
+		: : "r" ( ddd ), "r" ( sha256_k ),
+		    "r" ( sha256_accel_bswap ), "r" ( saved )
+		: "memory" );
+}
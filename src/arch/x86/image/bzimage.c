@@ -71,6 +71,8 @@ struct bzimage_context {
 	userptr_t pm_kernel;
 	/** Non-real-mode kernel portion file and memory size */
 	size_t pm_sz;
+	/** Non-real-mode kernel portion is executed in place */
+	int pm_in_place;
 	/** Video mode */
 	unsigned int vid_mode;
 	/** Memory limit */
@@ -227,6 +229,10 @@ static void bzimage_update_header ( struct image *image,
 	/* Set video mode */
 	bzimg->bzhdr.vid_mode = bzimg->vid_mode;
 
+	/* Set protected-mode entry point for in-place execution */
+	if ( bzimg->pm_in_place )
+		bzimg->bzhdr.code32_start = user_to_phys ( bzimg->pm_kernel, 0 );
+
 	/* Set initrd address */
 	if ( bzimg->version >= 0x0200 ) {
 		bzimg->bzhdr.ramdisk_image = bzimg->ramdisk_image;
@@ -363,17 +369,42 @@ static inline size_t bzimage_align ( size_t len ) {
 	return ( ( len + INITRD_ALIGN - 1 ) & ~( INITRD_ALIGN - 1 ) );
 }
 
+/**
+ * Calculate length of initrd cpio header
+ *
+ * @v initrd		initrd image
+ * @ret len		Length of cpio header (including name and padding)
+ */
+static size_t bzimage_initrd_header_len ( struct image *initrd ) {
+	char *filename = initrd->cmdline;
+	char *cmdline;
+	size_t name_len;
+
+	/* Prebuilt cpio archives have no constructed header */
+	if ( ! ( filename && filename[0] ) )
+		return 0;
+
+	/* Header is followed by the NUL-terminated name, padded to a
+	 * dword boundary.
+	 */
+	cmdline = strchr ( filename, ' ' );
+	name_len = ( ( cmdline ? ( ( size_t ) ( cmdline - filename ) )
+		       : strlen ( filename ) ) + 1 /* NUL */ );
+	return ( ( sizeof ( struct cpio_header ) + name_len + 0x03 ) & ~0x03 );
+}
+
 /**
  * Load initrd
  *
  * @v image		bzImage image
  * @v initrd		initrd image
  * @v address		Address at which to load, or UNULL
+ * @v in_place		Initrd body is already in place
  * @ret len		Length of loaded image, excluding zero-padding
  */
 static size_t bzimage_load_initrd ( struct image *image,
 				    struct image *initrd,
-				    userptr_t address ) {
+				    userptr_t address, int in_place ) {
 	char *filename = initrd->cmdline;
 	char *cmdline;
 	struct cpio_header cpio;
@@ -400,15 +431,22 @@ static size_t bzimage_load_initrd ( struct image *image,
 			bzimage_parse_cpio_cmdline ( image, &cpio,
 						     ( cmdline + 1 /* ' ' */ ));
 		}
-		offset = ( ( sizeof ( cpio ) + name_len + 0x03 ) & ~0x03 );
+		offset = bzimage_initrd_header_len ( initrd );
 	} else {
 		offset = 0;
 		name_len = 0;
 	}
 
-	/* Copy in initrd image body (and cpio header if applicable) */
+	/* Copy in initrd image body (and cpio header if applicable).
+	 * The body copy is elided if the body already resides at its
+	 * final address.
+	 */
 	if ( address ) {
-		memmove_user ( address, offset, initrd->data, 0, initrd->len );
+		if ( userptr_add ( address, offset ) != initrd->data ) {
+			assert ( ! in_place );
+			memmove_user ( address, offset, initrd->data, 0,
+				       initrd->len );
+		}
 		if ( offset ) {
 			memset_user ( address, 0, 0, offset );
 			copy_to_user ( address, 0, &cpio, sizeof ( cpio ) );
@@ -425,9 +463,13 @@ static size_t bzimage_load_initrd ( struct image *image,
 	}
 	offset += initrd->len;
 
-	/* Zero-pad to next INITRD_ALIGN boundary */
+	/* Zero-pad to next INITRD_ALIGN boundary.  For in-place
+	 * assembly, the gap below the next initrd's cpio header is
+	 * zeroed by the caller instead: padding written here could
+	 * overrun into the next initrd's body.
+	 */
 	pad_len = ( ( -offset ) & ( INITRD_ALIGN - 1 ) );
-	if ( address )
+	if ( address && ( ! in_place ) )
 		memset_user ( address, offset, 0, pad_len );
 
 	return offset;
@@ -455,7 +497,7 @@ static int bzimage_check_initrds ( struct image *image,
 			continue;
 
 		/* Calculate length */
-		len += bzimage_load_initrd ( image, initrd, UNULL );
+		len += bzimage_load_initrd ( image, initrd, UNULL, 0 );
 		len = bzimage_align ( len );
 
 		DBGC ( image, "bzImage %p initrd %p from [%#08lx,%#08lx)%s%s\n",
@@ -503,9 +545,11 @@ static void bzimage_load_initrds ( struct image *image,
 	struct image *highest = NULL;
 	struct image *other;
 	userptr_t top;
+	userptr_t prev;
 	userptr_t dest;
 	size_t offset;
 	size_t len;
+	int in_place;
 
 	/* Reshuffle initrds into desired order */
 	initrd_reshuffle ( userptr_add ( bzimg->pm_kernel, bzimg->pm_sz ) );
@@ -524,10 +568,78 @@ static void bzimage_load_initrds ( struct image *image,
 
 	/* Find highest usable address */
 	top = userptr_add ( highest->data, bzimage_align ( highest->len ) );
+	in_place = 1;
 	if ( user_to_phys ( top, -1 ) > bzimg->mem_limit ) {
 		top = phys_to_user ( ( bzimg->mem_limit + 1 ) &
 				     ~( INITRD_ALIGN - 1 ) );
+		in_place = 0;
+	}
+
+	/* Check whether initrds can be assembled in place.  After
+	 * reshuffling, the initrd bodies already lie in list order at
+	 * INITRD_ALIGN-ed addresses, and the kernel's initramfs parser
+	 * will skip any NUL padding between concatenated cpio
+	 * archives.  Provided that each constructed cpio header fits
+	 * within the gap below its initrd body, the headers can
+	 * therefore simply be written into the gaps, and no initrd
+	 * body need be copied at all.
+	 */
+	if ( in_place ) {
+		prev = userptr_add ( bzimg->pm_kernel, bzimg->pm_sz );
+		for_each_image ( initrd ) {
+			if ( initrd == image )
+				continue;
+			offset = bzimage_initrd_header_len ( initrd );
+			if ( userptr_sub ( userptr_add ( initrd->data, -offset ),
+					   prev ) < 0 ) {
+				in_place = 0;
+				break;
+			}
+			prev = userptr_add ( initrd->data, initrd->len );
+		}
 	}
+
+	/* Assemble initrds in place, if possible.  The gaps between
+	 * successive initrds are zeroed to satisfy the initramfs
+	 * parser; this may include the kernel image's own source data,
+	 * which is no longer needed by this point.
+	 */
+	if ( in_place ) {
+		DBGC ( image, "bzImage %p assembling initrds in place\n",
+		       image );
+		prev = UNULL;
+		for_each_image ( initrd ) {
+
+			/* Skip kernel */
+			if ( initrd == image )
+				continue;
+
+			/* Zero gap between previous initrd and this
+			 * initrd's cpio header (if any)
+			 */
+			offset = bzimage_initrd_header_len ( initrd );
+			dest = userptr_add ( initrd->data, -offset );
+			if ( prev != UNULL ) {
+				memset_user ( prev, 0, 0,
+					      userptr_sub ( dest, prev ) );
+			}
+			prev = userptr_add ( initrd->data, initrd->len );
+
+			/* Write cpio header; the body is already in place */
+			len = bzimage_load_initrd ( image, initrd, dest, 1 );
+
+			/* Record initrd location */
+			if ( ! bzimg->ramdisk_image )
+				bzimg->ramdisk_image = user_to_phys ( dest, 0 );
+			bzimg->ramdisk_size = ( user_to_phys ( dest, len ) -
+						bzimg->ramdisk_image );
+		}
+		DBGC ( image, "bzImage %p initrds at [%#08lx,%#08lx)\n",
+		       image, bzimg->ramdisk_image,
+		       ( bzimg->ramdisk_image + bzimg->ramdisk_size ) );
+		return;
+	}
+
 	DBGC ( image, "bzImage %p loading initrds from %#08lx downwards\n",
 	       image, user_to_phys ( top, -1 ) );
 
@@ -541,13 +653,13 @@ static void bzimage_load_initrds ( struct image *image,
 		for_each_image ( other ) {
 			if ( other == initrd )
 				offset = 0;
-			offset += bzimage_load_initrd ( image, other, UNULL );
+			offset += bzimage_load_initrd ( image, other, UNULL, 0 );
 			offset = bzimage_align ( offset );
 		}
 
 		/* Load initrd at this address */
 		dest = userptr_add ( top, -offset );
-		len = bzimage_load_initrd ( image, initrd, dest );
+		len = bzimage_load_initrd ( image, initrd, dest, 0 );
 
 		/* Record initrd location */
 		if ( ! bzimg->ramdisk_image )
@@ -560,6 +672,66 @@ static void bzimage_load_initrds ( struct image *image,
 	       ( bzimg->ramdisk_image + bzimg->ramdisk_size ) );
 }
 
+/**
+ * Check whether protected-mode kernel can be executed in place
+ *
+ * @v image		bzImage image
+ * @v bzimg		bzImage context
+ *
+ * A relocatable kernel may be entered directly at the protected-mode
+ * payload within the downloaded image, avoiding the bulk copy to its
+ * default load address.
+ */
+static void bzimage_check_in_place ( struct image *image,
+				     struct bzimage_context *bzimg ) {
+	userptr_t pm_kernel = userptr_add ( image->data, bzimg->rm_filesz );
+	physaddr_t start = user_to_phys ( pm_kernel, 0 );
+	struct image *other;
+	size_t align;
+
+	/* Kernel must be relocatable, and must declare its minimum
+	 * load alignment and required initialisation workspace (boot
+	 * protocol 2.10+).
+	 */
+	if ( ( bzimg->version < 0x020a ) ||
+	     ( ! ( bzimg->bzhdr.loadflags & BZI_LOAD_HIGH ) ) ||
+	     ( ! bzimg->bzhdr.relocatable_kernel ) ||
+	     ( bzimg->bzhdr.min_alignment >= 32 ) ||
+	     ( ! bzimg->bzhdr.init_size ) )
+		return;
+
+	/* Payload must satisfy the kernel's minimum load alignment
+	 * (the kernel aligns its own runtime address up to
+	 * kernel_alignment within the init_size workspace).
+	 */
+	align = ( 1UL << bzimg->bzhdr.min_alignment );
+	if ( start & ( align - 1 ) )
+		return;
+
+	/* Initialisation workspace must lie within the external heap,
+	 * which is guaranteed to be usable RAM and is dead by the time
+	 * the kernel starts.
+	 */
+	if ( userptr_sub ( userptr_add ( pm_kernel, bzimg->bzhdr.init_size ),
+			   initrd_top ) > 0 )
+		return;
+
+	/* There must be no initrds: initrd placement treats the
+	 * kernel image's source data as dead, and the initialisation
+	 * workspace could overlap initrds placed above the image.
+	 */
+	for_each_image ( other ) {
+		if ( other != image )
+			return;
+	}
+
+	/* Execute in place */
+	bzimg->pm_kernel = pm_kernel;
+	bzimg->pm_in_place = 1;
+	DBGC ( image, "bzImage %p executing PM kernel in place at [%#08lx,"
+	       "%#08lx)\n", image, start, ( start + bzimg->pm_sz ) );
+}
+
 /**
  * Execute bzImage image
  *
@@ -576,14 +748,20 @@ static int bzimage_exec ( struct image *image ) {
 					   image->data ) ) != 0 )
 		return rc;
 
-	/* Prepare segments */
+	/* Check whether protected-mode kernel can be executed in place */
+	bzimage_check_in_place ( image, &bzimg );
+
+	/* Prepare segments.  The in-place protected-mode kernel needs
+	 * no preparation: it already occupies its (hidden) memory.
+	 */
 	if ( ( rc = prep_segment ( bzimg.rm_kernel, bzimg.rm_filesz,
 				   bzimg.rm_memsz ) ) != 0 ) {
 		DBGC ( image, "bzImage %p could not prepare RM segment: %s\n",
 		       image, strerror ( rc ) );
 		return rc;
 	}
-	if ( ( rc = prep_segment ( bzimg.pm_kernel, bzimg.pm_sz,
+	if ( ( ! bzimg.pm_in_place ) &&
+	     ( rc = prep_segment ( bzimg.pm_kernel, bzimg.pm_sz,
 				   bzimg.pm_sz ) ) != 0 ) {
 		DBGC ( image, "bzImage %p could not prepare PM segment: %s\n",
 		       image, strerror ( rc ) );
@@ -604,8 +782,10 @@ static int bzimage_exec ( struct image *image ) {
 	/* Load segments */
 	memcpy_user ( bzimg.rm_kernel, 0, image->data,
 		      0, bzimg.rm_filesz );
-	memcpy_user ( bzimg.pm_kernel, 0, image->data,
-		      bzimg.rm_filesz, bzimg.pm_sz );
+	if ( ! bzimg.pm_in_place ) {
+		memcpy_user ( bzimg.pm_kernel, 0, image->data,
+			      bzimg.rm_filesz, bzimg.pm_sz );
+	}
 
 	/* Store command line */
 	bzimage_set_cmdline ( image, &bzimg, cmdline );
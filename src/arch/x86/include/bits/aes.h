@@ -0,0 +1,20 @@
+#ifndef _BITS_AES_H
+#define _BITS_AES_H
+
+/** @file
+ *
+ * AES algorithm
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+struct aes_context;
+
+extern int aes_accel_supported ( void );
+extern void aes_accel_encrypt ( struct aes_context *aes, const void *src,
+				void *dst );
+extern void aes_accel_decrypt ( struct aes_context *aes, const void *src,
+				void *dst );
+
+#endif /* _BITS_AES_H */
@@ -0,0 +1,36 @@
+#ifndef _BITS_COROUTINE_H
+#define _BITS_COROUTINE_H
+
+/** @file
+ *
+ * Coroutines
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <setjmp.h>
+
+/**
+ * Prime a jump buffer to begin execution on a new stack
+ *
+ * @v env		Jump buffer
+ * @v stack_top		Top of stack (16-byte aligned)
+ * @v fn		Function to begin executing (which must not return)
+ *
+ * longjmp() discards and repushes a return address at the restored
+ * stack pointer, and so begins execution of @c fn with the stack
+ * pointer one word above @c env->stack.  Bias the stack top by two
+ * words so that the ABI-expected entry alignment (as found
+ * immediately after a call from a 16-byte-aligned stack) holds.
+ */
+static inline void coroutine_prime ( jmp_buf env, void *stack_top,
+				     void ( * fn ) ( void ) ) {
+
+	env->retaddr = ( ( intptr_t ) fn );
+	env->stack = ( ( ( intptr_t ) stack_top ) -
+		       ( 2 * sizeof ( env->stack ) ) );
+}
+
+#endif /* _BITS_COROUTINE_H */
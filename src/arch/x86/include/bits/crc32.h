@@ -0,0 +1,21 @@
+#ifndef _BITS_CRC32_H
+#define _BITS_CRC32_H
+
+/** @file
+ *
+ * CRC32 (little-endian) checksums
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+static inline __attribute__ (( always_inline )) u32
+crc32_le ( u32 seed, const void *data, size_t len ) {
+
+	/* The SSE4.2 CRC32 instruction implements only the Castagnoli
+	 * polynomial; no instruction exists for this polynomial.
+	 */
+	return generic_crc32_le ( seed, data, len );
+}
+
+#endif /* _BITS_CRC32_H */
@@ -0,0 +1,17 @@
+#ifndef _BITS_SHA1_H
+#define _BITS_SHA1_H
+
+/** @file
+ *
+ * SHA-1 algorithm
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+union sha1_digest_data_dwords;
+
+extern int sha1_accel_supported ( void );
+extern void sha1_accel_digest ( union sha1_digest_data_dwords *ddd );
+
+#endif /* _BITS_SHA1_H */
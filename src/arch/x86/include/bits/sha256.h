@@ -0,0 +1,17 @@
+#ifndef _BITS_SHA256_H
+#define _BITS_SHA256_H
+
+/** @file
+ *
+ * SHA-256 algorithm
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+union sha256_digest_data_dwords;
+
+extern int sha256_accel_supported ( void );
+extern void sha256_accel_digest ( union sha256_digest_data_dwords *ddd );
+
+#endif /* _BITS_SHA256_H */
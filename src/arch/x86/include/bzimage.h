@@ -68,10 +68,28 @@ struct bzimage_header {
 	uint32_t kernel_alignment;
 	/** Whether kernel is relocatable or not */
 	uint8_t relocatable_kernel;
-	/** Unused */
-	uint8_t pad2[3];
+	/** Minimum physical addr alignment (as a power of two) */
+	uint8_t min_alignment;
+	/** Boot protocol option flags */
+	uint16_t xloadflags;
 	/** Maximum size of the kernel command line */
 	uint32_t cmdline_size;
+	/** Hardware subarchitecture */
+	uint32_t hardware_subarch;
+	/** Subarchitecture-specific data */
+	uint64_t hardware_subarch_data;
+	/** Offset of kernel payload */
+	uint32_t payload_offset;
+	/** Length of kernel payload */
+	uint32_t payload_length;
+	/** 64-bit physical pointer to linked list of struct setup_data */
+	uint64_t setup_data;
+	/** Preferred loading address */
+	uint64_t pref_address;
+	/** Linear memory required during initialization */
+	uint32_t init_size;
+	/** Offset of handover entry point */
+	uint32_t handover_offset;
 } __attribute__ (( packed ));
 
 /** Offset of bzImage header within kernel image */
@@ -24,6 +24,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define INITRD_MIN_FREE_LEN ( 512 * 1024 )
 
+extern userptr_t initrd_top;
+
 extern void initrd_reshuffle ( userptr_t bottom );
 extern int initrd_reshuffle_check ( size_t len, userptr_t bottom );
 
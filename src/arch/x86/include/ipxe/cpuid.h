@@ -39,9 +39,39 @@ struct x86_features {
 /** Get standard features */
 #define CPUID_FEATURES 0x00000001UL
 
+/** SSE4.2 instruction set is present */
+#define CPUID_FEATURES_INTEL_ECX_SSE4_2 0x00100000UL
+
+/** AES instruction set is present */
+#define CPUID_FEATURES_INTEL_ECX_AES 0x02000000UL
+
+/** RDRAND instruction is present */
+#define CPUID_FEATURES_INTEL_ECX_RDRAND 0x40000000UL
+
 /** Hypervisor is present */
 #define CPUID_FEATURES_INTEL_ECX_HYPERVISOR 0x80000000UL
 
+/** Get structured extended features */
+#define CPUID_SEF 0x00000007UL
+
+/** BMI2 instruction set is present */
+#define CPUID_SEF_EBX_BMI2 0x00000100UL
+
+/** Enhanced REP MOVSB/STOSB is present */
+#define CPUID_SEF_EBX_ERMS 0x00000200UL
+
+/** ADX instruction set is present */
+#define CPUID_SEF_EBX_ADX 0x00080000UL
+
+/** SHA extensions are present */
+#define CPUID_SEF_EBX_SHA 0x20000000UL
+
+/** TSC and core crystal clock ratio */
+#define CPUID_TSC_CRYSTAL 0x00000015UL
+
+/** Processor frequency information */
+#define CPUID_FREQUENCY 0x00000016UL
+
 /** Get largest extended function */
 #define CPUID_AMD_MAX_FN 0x80000000UL
 
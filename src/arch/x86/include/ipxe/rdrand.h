@@ -0,0 +1,54 @@
+#ifndef _IPXE_RDRAND_H
+#define _IPXE_RDRAND_H
+
+/** @file
+ *
+ * RDRAND-based entropy source
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+
+#ifdef ENTROPY_RDRAND
+#define ENTROPY_PREFIX_rdrand
+#else
+#define ENTROPY_PREFIX_rdrand __rdrand_
+#endif
+
+/**
+ * min-entropy per sample
+ *
+ * @ret min_entropy	min-entropy of each sample
+ */
+static inline __always_inline min_entropy_t
+ENTROPY_INLINE ( rdrand, min_entropy_per_sample ) ( void ) {
+
+	/* Samples are individual bytes of the output of the CPU's
+	 * internal DRBG, which is reseeded from a hardware entropy
+	 * source conditioned to full entropy (as described in the
+	 * Intel Digital Random Number Generator Software
+	 * Implementation Guide).  The raw min-entropy is therefore
+	 * effectively 8 bits per sample; we apply a 50% safety margin
+	 * since we have no way to observe the internal conditioning.
+	 */
+	return MIN_ENTROPY ( 4.0 );
+}
+
+extern int rdrand_sample ( noise_sample_t *noise );
+
+/**
+ * Get noise sample
+ *
+ * @ret noise		Noise sample
+ * @ret rc		Return status code
+ */
+static inline __always_inline int
+ENTROPY_INLINE ( rdrand, get_noise ) ( noise_sample_t *noise ) {
+
+	/* Get sample */
+	return rdrand_sample ( noise );
+}
+
+#endif /* _IPXE_RDRAND_H */
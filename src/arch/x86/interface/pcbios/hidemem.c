@@ -29,6 +29,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <fakee820.h>
 #include <ipxe/init.h>
 #include <ipxe/io.h>
+#include <ipxe/segment.h>
 #include <ipxe/hidemem.h>
 
 /** Set to true if you want to test a fake E820 map */
@@ -98,6 +99,9 @@ static void hide_region ( struct hidden_region *region,
 	region->end = ( ( end + ALIGN_HIDDEN - 1 ) & ~( ALIGN_HIDDEN - 1 ) );
 
 	DBG ( "Hiding region [%llx,%llx)\n", region->start, region->end );
+
+	/* Invalidate any cached copy of the memory map */
+	segment_memmap_invalidate();
 }
 
 /**
@@ -110,6 +114,9 @@ void hide_basemem ( void ) {
 	 * nearest page boundary.
 	 */
 	hidemem_base.start = ( get_fbms() * 1024 );
+
+	/* Invalidate any cached copy of the memory map */
+	segment_memmap_invalidate();
 }
 
 /**
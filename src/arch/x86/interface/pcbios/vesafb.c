@@ -493,6 +493,17 @@ static void vesafb_putchar ( int character ) {
 	fbcon_putchar ( &vesafb.fbcon, character );
 }
 
+/**
+ * Print a block of characters to current cursor position
+ *
+ * @v data		Characters
+ * @v len		Length of block
+ */
+static void vesafb_putchars ( const char *data, size_t len ) {
+
+	fbcon_putchars ( &vesafb.fbcon, data, len );
+}
+
 /**
  * Configure console
  *
@@ -535,6 +546,7 @@ static int vesafb_configure ( struct console_configuration *config ) {
 struct console_driver vesafb_console __console_driver = {
 	.usage = CONSOLE_VESAFB,
 	.putchar = vesafb_putchar,
+	.putchars = vesafb_putchars,
 	.configure = vesafb_configure,
 	.disabled = CONSOLE_DISABLED,
 };
@@ -26,4 +26,27 @@ profile_timestamp ( void ) {
 	return ( ( ( ( uint64_t ) edx ) << 32 ) | eax );
 }
 
+/** Architecture provides a fixed-function performance counter
+ *
+ * The counter records retired instructions (architectural
+ * fixed-function counter 0, enabled by profile_pmc_enable()).
+ */
+#define PROFILE_PMC 1
+
+/**
+ * Read fixed-function performance counter
+ *
+ * @ret pmc		Retired instruction count
+ */
+static inline __attribute__ (( always_inline )) uint64_t
+profile_pmc ( void ) {
+	uint32_t eax;
+	uint32_t edx;
+
+	/* Read fixed-function counter 0 (instructions retired) */
+	__asm__ __volatile__ ( "rdpmc" : "=a" ( eax ), "=d" ( edx )
+			       : "c" ( 0x40000000UL ) );
+	return ( ( ( ( uint64_t ) edx ) << 32 ) | eax );
+}
+
 #endif /* _BITS_PROFILE_H */
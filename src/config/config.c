@@ -134,6 +134,9 @@ REQUIRE_OBJECT ( iscsi );
 #ifdef SANBOOT_PROTO_HTTP
 REQUIRE_OBJECT ( httpblock );
 #endif
+#ifdef SANBOOT_PROTO_NVMETCP
+REQUIRE_OBJECT ( nvmetcp );
+#endif
 
 /*
  * Drag in all requested resolvers
@@ -233,6 +236,9 @@ REQUIRE_OBJECT ( pxe_cmd );
 #ifdef LOTEST_CMD
 REQUIRE_OBJECT ( lotest_cmd );
 #endif
+#ifdef NETBENCH_CMD
+REQUIRE_OBJECT ( netbench_cmd );
+#endif
 #ifdef VLAN_CMD
 REQUIRE_OBJECT ( vlan_cmd );
 #endif
@@ -272,15 +278,33 @@ REQUIRE_OBJECT ( console_cmd );
 #ifdef IPSTAT_CMD
 REQUIRE_OBJECT ( ipstat_cmd );
 #endif
+#ifdef TCPSTAT_CMD
+REQUIRE_OBJECT ( tcpstat_cmd );
+#endif
+#ifdef HEAPSTAT_CMD
+REQUIRE_OBJECT ( heapstat_cmd );
+#endif
+#ifdef REFSTAT_CMD
+REQUIRE_OBJECT ( refstat_cmd );
+#endif
 #ifdef PROFSTAT_CMD
 REQUIRE_OBJECT ( profstat_cmd );
 #endif
+#ifdef MILESTONE_CMD
+REQUIRE_OBJECT ( milestone_cmd );
+#endif
 #ifdef NTP_CMD
 REQUIRE_OBJECT ( ntp_cmd );
 #endif
 #ifdef CERT_CMD
 REQUIRE_OBJECT ( cert_cmd );
 #endif
+#ifdef PRECONN_CMD
+REQUIRE_OBJECT ( preconn_cmd );
+#endif
+#ifdef PCAP_CMD
+REQUIRE_OBJECT ( pcap_cmd );
+#endif
 
 /*
  * Drag in miscellaneous objects
@@ -289,6 +313,9 @@ REQUIRE_OBJECT ( cert_cmd );
 #ifdef NULL_TRAP
 REQUIRE_OBJECT ( nulltrap );
 #endif
+#ifdef TELEMETRY
+REQUIRE_OBJECT ( telemetry );
+#endif
 #ifdef GDBSERIAL
 REQUIRE_OBJECT ( gdbidt );
 REQUIRE_OBJECT ( gdbserial );
@@ -299,6 +326,9 @@ REQUIRE_OBJECT ( gdbidt );
 REQUIRE_OBJECT ( gdbudp );
 REQUIRE_OBJECT ( gdbstub_cmd );
 #endif
+#ifdef FNTRACE
+REQUIRE_OBJECT ( fntrace_cmd );
+#endif
 
 /*
  * Drag in objects that are always required, but not dragged in via
@@ -343,6 +373,9 @@ REQUIRE_OBJECT ( vram_settings );
 #ifdef ACPI_SETTINGS
 REQUIRE_OBJECT ( acpi_settings );
 #endif
+#ifdef HEAP_SETTINGS
+REQUIRE_OBJECT ( heap_settings );
+#endif
 
 /*
  * Drag in selected keyboard map
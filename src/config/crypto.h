@@ -12,9 +12,18 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** RSA public-key algorithm */
 #define CRYPTO_PUBKEY_RSA
 
+/** X25519 ephemeral ECDH key exchange */
+#define CRYPTO_CURVE_X25519
+
 /** AES-CBC block cipher */
 #define CRYPTO_CIPHER_AES_CBC
 
+/** AES-GCM authenticated cipher */
+#define CRYPTO_CIPHER_AES_GCM
+
+/** ChaCha20-Poly1305 authenticated cipher */
+#define CRYPTO_CIPHER_CHACHA20_POLY1305
+
 /** MD5 digest algorithm
  *
  * Note that use of MD5 is implicit when using TLSv1.1 or earlier.
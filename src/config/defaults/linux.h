@@ -30,5 +30,6 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #define SANBOOT_PROTO_IB_SRP
 #define SANBOOT_PROTO_FCP
 #define SANBOOT_PROTO_HTTP
+#define SANBOOT_PROTO_NVMETCP
 
 #endif /* CONFIG_DEFAULTS_LINUX_H */
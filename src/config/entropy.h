@@ -11,6 +11,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <config/defaults.h>
 
+//#undef		ENTROPY_RTC
+//#define		ENTROPY_RDRAND
+
 #include <config/local/entropy.h>
 
 #endif /* CONFIG_ENTROPY_H */
@@ -70,6 +70,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#undef	SANBOOT_PROTO_IB_SRP	/* Infiniband SCSI RDMA protocol */
 //#undef	SANBOOT_PROTO_FCP	/* Fibre Channel protocol */
 //#undef	SANBOOT_PROTO_HTTP	/* HTTP SAN protocol */
+//#undef	SANBOOT_PROTO_NVMETCP	/* NVMe over TCP protocol */
 
 /*
  * HTTP extensions
@@ -79,6 +80,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define HTTP_AUTH_DIGEST	/* Digest authentication */
 //#define HTTP_AUTH_NTLM	/* NTLM authentication */
 //#define HTTP_ENC_PEERDIST	/* PeerDist content encoding */
+#define HTTP_ENC_GZIP		/* Gzip content encoding */
 //#define HTTP_HACK_GCE		/* Google Compute Engine hacks */
 
 /*
@@ -140,6 +142,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#define TIME_CMD		/* Time commands */
 //#define DIGEST_CMD		/* Image crypto digest commands */
 //#define LOTEST_CMD		/* Loopback testing commands */
+//#define NETBENCH_CMD		/* Network benchmark command */
 //#define VLAN_CMD		/* VLAN commands */
 //#define PXE_CMD		/* PXE commands */
 //#define REBOOT_CMD		/* Reboot command */
@@ -151,9 +154,15 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#define PING_CMD		/* Ping command */
 //#define CONSOLE_CMD		/* Console command */
 //#define IPSTAT_CMD		/* IP statistics commands */
+//#define TCPSTAT_CMD		/* TCP connection statistics commands */
+//#define HEAPSTAT_CMD		/* Heap statistics commands */
+//#define REFSTAT_CMD		/* Object statistics commands */
 //#define PROFSTAT_CMD		/* Profiling commands */
+//#define MILESTONE_CMD		/* Boot milestone commands */
 //#define NTP_CMD		/* NTP commands */
 //#define CERT_CMD		/* Certificate management commands */
+//#define PRECONN_CMD		/* Connection warm-up command */
+//#define PCAP_CMD		/* Packet capture commands */
 
 /*
  * ROM-specific options
@@ -189,10 +198,32 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #undef	BUILD_ID		/* Include a custom build ID string,
 				 * e.g "test-foo" */
 #undef	NULL_TRAP		/* Attempt to catch NULL function calls */
+#undef	REFCNT_STATS		/* Track live, peak, and total counts of
+				 * reference-counted objects by class,
+				 * for diagnosing slow heap growth.
+				 * View with the "refstat" command */
+#undef	TELEMETRY		/* Export boot milestones, profiler
+				 * results and IP statistics as binary
+				 * TLV records over UDP to the syslog
+				 * server, after configuration and
+				 * before image execution */
+#undef	DRIVER_PROFILING	/* Record per-driver poll-to-delivery
+				 * receive and enqueue-to-completion
+				 * transmit latencies in instrumented
+				 * network drivers, even in builds in
+				 * which profiling is otherwise
+				 * disabled.  View with the "profstat"
+				 * command */
 #undef	GDBSERIAL		/* Remote GDB debugging over serial */
 #undef	GDBUDP			/* Remote GDB debugging over UDP
 				 * (both may be set) */
 //#define EFI_DOWNGRADE_UX	/* Downgrade UEFI user experience */
+#undef	NET_NAP			/* Halt CPU while waiting for network
+				 * activity, using device interrupts as
+				 * a wakeup.  Saves power and frees SMT
+				 * sibling cycles, at some cost in
+				 * latency on devices with unreliable
+				 * interrupt delivery */
 #define	TIVOLI_VMM_WORKAROUND	/* Work around the Tivoli VMM's garbling of SSE
 				 * registers when iPXE traps to it due to
 				 * privileged instructions */
@@ -15,6 +15,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#define	VMWARE_SETTINGS	/* VMware GuestInfo settings */
 //#define	VRAM_SETTINGS	/* Video RAM dump settings */
 //#define	ACPI_SETTINGS	/* ACPI settings */
+//#define	HEAP_SETTINGS	/* Heap memory pressure settings */
 
 #include <config/named.h>
 #include NAMED_CONFIG(settings.h)
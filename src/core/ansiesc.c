@@ -122,3 +122,35 @@ int ansiesc_process ( struct ansiesc_context *ctx, int c ) {
 		return -1;
 	}
 }
+
+/**
+ * Find length of text not forming part of any ANSI escape sequence
+ *
+ * @v ctx		ANSI escape sequence context
+ * @v data		Character data
+ * @v len		Length of character data
+ * @ret len		Length of leading plain text portion
+ *
+ * Returns the length of the leading portion of the character data
+ * that is guaranteed to form no part of any ANSI escape sequence, and
+ * which may therefore be processed in bulk without being passed
+ * through ansiesc_process().  The portion will be empty if the
+ * context is currently within an escape sequence, or if the data
+ * begins with an escape character.
+ */
+size_t ansiesc_span ( struct ansiesc_context *ctx, const char *data,
+		      size_t len ) {
+	size_t span;
+
+	/* No plain text can exist while within an escape sequence */
+	if ( ctx->count )
+		return 0;
+
+	/* Scan ahead to the next escape character, if any */
+	for ( span = 0 ; span < len ; span++ ) {
+		if ( data[span] == ESC )
+			break;
+	}
+
+	return span;
+}
@@ -28,7 +28,6 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <errno.h>
 #include <assert.h>
 #include <ipxe/string.h>
-#include <ipxe/vsprintf.h>
 #include <ipxe/base16.h>
 
 /** @file
@@ -49,18 +48,32 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 size_t hex_encode ( char separator, const void *raw, size_t raw_len,
 		    char *data, size_t len ) {
+	static const char hex_digits[16] = "0123456789abcdef";
 	const uint8_t *bytes = raw;
-	const char delimiter[2] = { separator, '\0' };
 	size_t used = 0;
 	unsigned int i;
 
+	/* Emit digits directly rather than formatting each byte via
+	 * ssnprintf(), which costs a full format string parse per
+	 * byte when formatting large settings blobs.
+	 */
 	if ( len )
 		data[0] = 0; /* Ensure that a terminating NUL exists */
 	for ( i = 0 ; i < raw_len ; i++ ) {
-		used += ssnprintf ( ( data + used ), ( len - used ),
-				    "%s%02x", ( used ? delimiter : "" ),
-				    bytes[i] );
+		if ( used && separator ) {
+			if ( ( used + 1 ) < len )
+				data[used] = separator;
+			used++;
+		}
+		if ( ( used + 1 ) < len )
+			data[used] = hex_digits[ bytes[i] >> 4 ];
+		used++;
+		if ( ( used + 1 ) < len )
+			data[used] = hex_digits[ bytes[i] & 0xf ];
+		used++;
 	}
+	if ( len )
+		data[ ( used < len ) ? used : ( len - 1 ) ] = '\0';
 	return used;
 }
 
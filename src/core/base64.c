@@ -39,6 +39,31 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 static const char base64[64] =
 	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+/** Reverse mapping from characters to 6-bit values
+ *
+ * Invalid characters are marked with BASE64_INVALID.  The table is
+ * generated at first use (and so lives in .bss, costing nothing in
+ * the compressed image), avoiding a strchr() against the alphabet
+ * for every single character: multi-hundred-kB PEM certificate
+ * bundles pass through base64_decode().
+ */
+static uint8_t base64_reverse[256];
+
+/** Invalid character marker */
+#define BASE64_INVALID 0xff
+
+/**
+ * Generate reverse mapping table
+ *
+ */
+static void base64_reverse_generate ( void ) {
+	unsigned int i;
+
+	memset ( base64_reverse, BASE64_INVALID, sizeof ( base64_reverse ) );
+	for ( i = 0 ; i < sizeof ( base64 ) ; i++ )
+		base64_reverse[ ( unsigned char ) base64[i] ] = i;
+}
+
 /**
  * Base64-encode data
  *
@@ -92,7 +117,6 @@ int base64_decode ( const char *encoded, void *data, size_t len ) {
 	const char *in = encoded;
 	uint8_t *out = data;
 	uint8_t in_char;
-	char *match;
 	int in_bits;
 	unsigned int bit = 0;
 	unsigned int pad_count = 0;
@@ -101,6 +125,12 @@ int base64_decode ( const char *encoded, void *data, size_t len ) {
 	/* Zero the output buffer */
 	memset ( data, 0, len );
 
+	/* Generate reverse mapping table, if not already done.  The
+	 * entry for '/' is nonzero in any generated table.
+	 */
+	if ( ! base64_reverse[ ( unsigned char ) '/' ] )
+		base64_reverse_generate();
+
 	/* Decode string */
 	while ( ( in_char = *(in++) ) ) {
 
@@ -126,13 +156,12 @@ int base64_decode ( const char *encoded, void *data, size_t len ) {
 		}
 
 		/* Process normal characters */
-		match = strchr ( base64, in_char );
-		if ( ! match ) {
+		in_bits = base64_reverse[in_char];
+		if ( in_bits == BASE64_INVALID ) {
 			DBG ( "Base64-encoded string \"%s\" contains invalid "
 			      "character '%c'\n", encoded, in_char );
 			return -EINVAL;
 		}
-		in_bits = ( match - base64 );
 
 		/* Add to raw data */
 		in_bits <<= 2;
@@ -116,11 +116,37 @@ static void blktrans_xferbuf_read ( struct xfer_buffer *xferbuf, size_t offset,
 	}
 }
 
+/**
+ * Map block device translator data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @ret map		Mapping of data buffer, or UNULL on error
+ */
+static userptr_t blktrans_xferbuf_map ( struct xfer_buffer *xferbuf,
+					size_t offset ) {
+	struct block_translator *blktrans =
+		container_of ( xferbuf, struct block_translator, xferbuf );
+
+	/* Map buffer, if applicable */
+	if ( blktrans->buffer ) {
+
+		/* Map directly into data buffer */
+		return userptr_add ( blktrans->buffer, offset );
+
+	} else {
+
+		/* No data buffer to map */
+		return UNULL;
+	}
+}
+
 /** Block device translator data transfer buffer operations */
 static struct xfer_buffer_operations blktrans_xferbuf_operations = {
 	.realloc = blktrans_xferbuf_realloc,
 	.write = blktrans_xferbuf_write,
 	.read = blktrans_xferbuf_read,
+	.map = blktrans_xferbuf_map,
 };
 
 /**
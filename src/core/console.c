@@ -1,6 +1,7 @@
 #include "stddef.h"
 #include <ipxe/console.h>
 #include <ipxe/process.h>
+#include <ipxe/timer.h>
 #include <ipxe/nap.h>
 
 /** @file */
@@ -10,6 +11,18 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Current console usage */
 int console_usage = CONSOLE_USAGE_STDOUT;
 
+/** Minimum interval between input availability polls
+ *
+ * Some console drivers (e.g. EFI text input, or a polled serial UART)
+ * perform slow register accesses or firmware calls on every
+ * availability check, and iskey() is typically called once per main
+ * loop iteration while waiting for a download to complete.  Checking
+ * for input at most this often eliminates almost all of these calls
+ * while keeping keypress latency imperceptible.  This is a policy
+ * decision.
+ */
+#define CONSOLE_ISKEY_INTERVAL ( TICKS_PER_SEC / 64 )
+
 /** Console width */
 unsigned int console_width = CONSOLE_DEFAULT_WIDTH;
 
@@ -39,6 +52,57 @@ void putchar ( int character ) {
 	}
 }
 
+/**
+ * Write a block of characters to each console device
+ *
+ * @v data		Characters to be written
+ * @v len		Length of block
+ *
+ * The characters are written out to all enabled console devices.
+ * The console device list is traversed only once for the whole block,
+ * rather than once per character as with putchar().  Devices
+ * providing the console_driver::putchars() method additionally
+ * receive each newline-free run of characters in a single call.
+ */
+void putchars ( const char *data, size_t len ) {
+	struct console_driver *console;
+	const char *character;
+	size_t remaining;
+	size_t run;
+
+	for_each_table_entry ( console, CONSOLES ) {
+		if ( ( console->disabled & CONSOLE_DISABLED_OUTPUT ) ||
+		     ( ! ( console_usage & console->usage ) ) ||
+		     ( ! console->putchar ) )
+			continue;
+		for ( character = data, remaining = len ; remaining ; ) {
+
+			/* Write a run of characters (up to the next
+			 * newline) in a single call, if supported
+			 */
+			if ( console->putchars ) {
+				for ( run = 0 ; run < remaining ; run++ ) {
+					if ( character[run] == '\n' )
+						break;
+				}
+				if ( run ) {
+					console->putchars ( character, run );
+					character += run;
+					remaining -= run;
+					continue;
+				}
+			}
+
+			/* Automatic LF -> CR,LF translation */
+			if ( *character == '\n' )
+				console->putchar ( '\r' );
+			console->putchar ( *character );
+			character++;
+			remaining--;
+		}
+	}
+}
+
 /**
  * Check to see if any input is available on any console
  *
@@ -123,9 +187,29 @@ int getchar ( void ) {
  * device has input available, this call will return true.  If this
  * call returns true, you can then safely call getchar() without
  * blocking.
+ *
+ * To avoid slow per-poll register accesses or firmware calls in tight
+ * loops, the console devices are consulted at most once every
+ * @c CONSOLE_ISKEY_INTERVAL ticks: intervening calls return false
+ * without touching the devices.  Whenever input is found, polling is
+ * immediately re-armed so that pending input is drained without
+ * rate-limiting delays.
  */
 int iskey ( void ) {
-	return has_input() ? 1 : 0;
+	static unsigned long last_poll;
+	unsigned long now = currticks();
+
+	/* Report no input if within the rate-limiting interval */
+	if ( ( now - last_poll ) < CONSOLE_ISKEY_INTERVAL )
+		return 0;
+
+	/* Check consoles for input, re-arming immediately on activity */
+	if ( has_input() )
+		return 1;
+
+	/* Record time of most recent unproductive poll */
+	last_poll = now;
+	return 0;
 }
 
 /**
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Coroutines
+ *
+ * A coroutine executes on its own stack, switched to and from via
+ * setjmp()/longjmp(), and suspends itself whenever it must wait for
+ * an asynchronous operation.  Resumption is driven by the process
+ * scheduler, so a suspended coroutine costs one well-predicted
+ * setjmp()/longjmp() round trip per scheduler pass and nothing more.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <ipxe/coroutine.h>
+
+/** Currently executing coroutine, if any */
+static struct coroutine *coroutine_current;
+
+/**
+ * Begin execution of a coroutine
+ *
+ * This is the function to which coroutine_prime() directs the
+ * primed jump buffer.  It executes on the coroutine's own stack,
+ * and therefore must never return: it instead jumps back to the
+ * context of the final resumer.
+ */
+static __attribute__ (( noreturn )) void coroutine_trampoline ( void ) {
+	struct coroutine *coro = coroutine_current;
+
+	/* Execute coroutine body */
+	coro->entry ( coro );
+
+	/* Mark as completed and return to resumer */
+	coro->done = 1;
+	longjmp ( coro->caller, 1 );
+}
+
+/**
+ * Resume a coroutine
+ *
+ * @v coro		Coroutine
+ * @ret rc		Return status code
+ *
+ * Execute the coroutine (on its own stack) until it next yields or
+ * completes.  The stack is allocated on first resumption and freed
+ * on completion.
+ */
+int coroutine_resume ( struct coroutine *coro ) {
+	struct coroutine *parent;
+	intptr_t top;
+
+	/* Coroutines may not (yet) resume other coroutines */
+	assert ( coroutine_current == NULL );
+
+	/* Do nothing if coroutine has already completed */
+	if ( coro->done )
+		return 0;
+
+	/* Allocate stack and prime initial context, if applicable */
+	if ( ! coro->stack ) {
+		coro->stack = malloc ( COROUTINE_STACK_LEN );
+		if ( ! coro->stack )
+			return -ENOMEM;
+		top = ( ( ( intptr_t ) coro->stack ) + COROUTINE_STACK_LEN );
+		top &= ~( ( intptr_t ) 0xf );
+		coroutine_prime ( coro->ctx, ( ( void * ) top ),
+				  coroutine_trampoline );
+	}
+
+	/* Switch to coroutine context */
+	parent = coroutine_current;
+	coroutine_current = coro;
+	if ( setjmp ( coro->caller ) == 0 )
+		longjmp ( coro->ctx, 1 );
+	coroutine_current = parent;
+
+	/* Free stack, if coroutine has completed */
+	if ( coro->done ) {
+		free ( coro->stack );
+		coro->stack = NULL;
+	}
+
+	return 0;
+}
+
+/**
+ * Yield from the currently executing coroutine
+ *
+ * Suspend the current coroutine and return control to its resumer.
+ * Execution continues from this point on the next resumption.
+ */
+void coroutine_yield ( void ) {
+	struct coroutine *coro = coroutine_current;
+
+	/* Sanity check */
+	assert ( coro != NULL );
+
+	/* Switch back to resumer's context */
+	if ( setjmp ( coro->ctx ) == 0 )
+		longjmp ( coro->caller, 1 );
+}
+
+/**
+ * Single-step a coroutine
+ *
+ * @v coro		Coroutine
+ */
+static void coroutine_step ( struct coroutine *coro ) {
+	int rc;
+
+	/* Resume coroutine, marking as completed on internal errors
+	 * (which can arise only before the coroutine body has begun
+	 * executing).
+	 */
+	if ( ( rc = coroutine_resume ( coro ) ) != 0 ) {
+		DBGC ( coro, "COROUTINE %p could not resume: %s\n",
+		       coro, strerror ( rc ) );
+		coro->done = 1;
+	}
+
+	/* Stop scheduling, if coroutine has completed */
+	if ( coro->done )
+		process_del ( &coro->process );
+}
+
+/** Coroutine process descriptor */
+static struct process_descriptor coroutine_process_desc =
+	PROC_DESC ( struct coroutine, process, coroutine_step );
+
+/**
+ * Start scheduling a coroutine
+ *
+ * @v coro		Coroutine (already initialised)
+ * @v refcnt		Containing object reference count, or NULL
+ *
+ * The coroutine will be resumed via the process scheduler until it
+ * completes.
+ */
+void coroutine_start ( struct coroutine *coro, struct refcnt *refcnt ) {
+	process_init ( &coro->process, &coroutine_process_desc, refcnt );
+}
+
+/**
+ * Handle closure of an awaited operation
+ *
+ * @v await		Awaitable operation
+ * @v rc		Reason for closure
+ */
+static void coroutine_await_close ( struct coroutine_await *await, int rc ) {
+
+	/* Record completion */
+	await->rc = rc;
+	await->done = 1;
+
+	/* Shut down interface */
+	intf_shutdown ( &await->job, rc );
+}
+
+/** Awaitable operation interface operations */
+static struct interface_operation coroutine_await_operations[] = {
+	INTF_OP ( intf_close, struct coroutine_await *,
+		  coroutine_await_close ),
+};
+
+/** Awaitable operation interface descriptor */
+static struct interface_descriptor coroutine_await_desc =
+	INTF_DESC ( struct coroutine_await, job, coroutine_await_operations );
+
+/**
+ * Initialise an awaitable operation
+ *
+ * @v await		Awaitable operation
+ */
+void coroutine_await_init ( struct coroutine_await *await ) {
+
+	intf_init ( &await->job, &coroutine_await_desc, NULL );
+	await->rc = 0;
+	await->done = 0;
+}
+
+/**
+ * Wait (by yielding) for an awaited operation to complete
+ *
+ * @v await		Awaitable operation
+ * @ret rc		Operation status code
+ *
+ * Must be called from within a coroutine.
+ */
+int coroutine_await ( struct coroutine_await *await ) {
+
+	/* Yield until operation completes */
+	while ( ! await->done )
+		coroutine_yield();
+
+	return await->rc;
+}
@@ -28,6 +28,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/tables.h>
 #include <ipxe/init.h>
 #include <ipxe/interface.h>
+#include <ipxe/milestone.h>
 #include <ipxe/device.h>
 
 /**
@@ -88,6 +89,7 @@ static void probe_devices ( void ) {
 		INIT_LIST_HEAD ( &rootdev->dev.children );
 		if ( ( rc = rootdev_probe ( rootdev ) ) != 0 )
 			list_del ( &rootdev->dev.siblings );
+		milestone ( rootdev->dev.name );
 	}
 }
 
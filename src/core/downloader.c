@@ -34,7 +34,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/umalloc.h>
 #include <ipxe/image.h>
 #include <ipxe/xferbuf.h>
+#include <ipxe/crypto.h>
+#include <ipxe/sha256.h>
 #include <ipxe/downloader.h>
+#include <config/general.h>
 
 /** @file
  *
@@ -42,6 +45,13 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Compute downloaded image digests only when something can consume them */
+#ifdef IMAGE_TRUST_CMD
+#define DOWNLOADER_DIGEST 1
+#else
+#define DOWNLOADER_DIGEST 0
+#endif
+
 /** A downloader */
 struct downloader {
 	/** Reference count for this object */
@@ -56,6 +66,13 @@ struct downloader {
 	struct image *image;
 	/** Data transfer buffer */
 	struct xfer_buffer buffer;
+
+	/** Digest is being computed incrementally */
+	int digest_valid;
+	/** Next expected offset for incremental digest */
+	size_t digest_offset;
+	/** Incremental digest context */
+	uint8_t digest_ctx[SHA256_CTX_SIZE];
 };
 
 /**
@@ -88,14 +105,99 @@ static void downloader_finished ( struct downloader *downloader, int rc ) {
 			 downloader->image->name, strerror ( rc ) );
 	}
 
-	/* Update image length */
+	/* Release any unused buffer capacity and update image length */
+	if ( rc == 0 )
+		xferbuf_trim ( &downloader->buffer );
 	downloader->image->len = downloader->buffer.len;
 
+	/* Record digest, if computed over the entire download */
+	if ( DOWNLOADER_DIGEST && ( rc == 0 ) && downloader->digest_valid &&
+	     ( downloader->digest_offset == downloader->buffer.len ) ) {
+		downloader->digest_valid = 0;
+		downloader->image->digest = &sha256_algorithm;
+		digest_final ( &sha256_algorithm, downloader->digest_ctx,
+			       downloader->image->digest_value );
+	}
+
 	/* Shut down interfaces */
 	intf_shutdown ( &downloader->xfer, rc );
 	intf_shutdown ( &downloader->job, rc );
 }
 
+/****************************************************************************
+ *
+ * Data transfer buffer
+ *
+ */
+
+/**
+ * Reallocate download buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v len		New length (or zero to free buffer)
+ * @ret rc		Return status code
+ */
+static int downloader_buffer_realloc ( struct xfer_buffer *xferbuf,
+				       size_t len ) {
+
+	return xferbuf_umalloc_operations.realloc ( xferbuf, len );
+}
+
+/**
+ * Write data to download buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v data		Data to write
+ * @v len		Length of data
+ *
+ * Wraps the underlying umalloc()-based buffer write in order to
+ * compute the image digest incrementally, while the downloaded data
+ * is still cache-hot.  The digest is abandoned if data arrives out of
+ * order (e.g. via multicast or peer-to-peer transfers).
+ */
+static void downloader_buffer_write ( struct xfer_buffer *xferbuf,
+				      size_t offset, const void *data,
+				      size_t len ) {
+	struct downloader *downloader =
+		container_of ( xferbuf, struct downloader, buffer );
+
+	/* Write data to underlying buffer */
+	xferbuf_umalloc_operations.write ( xferbuf, offset, data, len );
+
+	/* Update digest, or abandon it on out-of-order data */
+	if ( DOWNLOADER_DIGEST && downloader->digest_valid ) {
+		if ( offset == downloader->digest_offset ) {
+			digest_update ( &sha256_algorithm,
+					downloader->digest_ctx, data, len );
+			downloader->digest_offset += len;
+		} else {
+			downloader->digest_valid = 0;
+		}
+	}
+}
+
+/**
+ * Read data from download buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v data		Data to read
+ * @v len		Length of data
+ */
+static void downloader_buffer_read ( struct xfer_buffer *xferbuf,
+				     size_t offset, void *data, size_t len ) {
+
+	xferbuf_umalloc_operations.read ( xferbuf, offset, data, len );
+}
+
+/** Download buffer operations */
+static struct xfer_buffer_operations downloader_buffer_operations = {
+	.realloc = downloader_buffer_realloc,
+	.write = downloader_buffer_write,
+	.read = downloader_buffer_read,
+};
+
 /****************************************************************************
  *
  * Job control interface
@@ -270,6 +372,11 @@ int create_downloader ( struct interface *job, struct image *image ) {
 		    &downloader->refcnt );
 	downloader->image = image_get ( image );
 	xferbuf_umalloc_init ( &downloader->buffer, &image->data );
+	downloader->buffer.op = &downloader_buffer_operations;
+	if ( DOWNLOADER_DIGEST ) {
+		digest_init ( &sha256_algorithm, downloader->digest_ctx );
+		downloader->digest_valid = 1;
+	}
 
 	/* Instantiate child objects and attach to our interfaces */
 	if ( ( rc = xfer_open_uri ( &downloader->xfer, image->uri ) ) != 0 )
@@ -146,6 +146,100 @@ static void fbcon_store ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 	copy_to_user ( fbcon->text.start, offset, cell, sizeof ( *cell ) );
 }
 
+/**
+ * Draw character via glyph cache
+ *
+ * @v fbcon		Frame buffer console
+ * @v cell		Text cell
+ * @v offset		Starting offset within frame buffer
+ * @ret rc		Return status code
+ *
+ * Glyphs are cached pre-rendered in framebuffer pixel format for the
+ * current attribute pair, allowing each character row to be drawn
+ * with a single copy to the (usually slow) framebuffer rather than
+ * one write per pixel.
+ */
+static int fbcon_blit ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
+			size_t offset ) {
+	struct fbcon_glyphs *glyphs = &fbcon->glyphs;
+	uint8_t glyph[fbcon->font->height];
+	uint8_t pixels[fbcon->character.len];
+	size_t pixel_len = fbcon->pixel->len;
+	size_t cached;
+	uint32_t background;
+	unsigned int character = cell->character;
+	unsigned int row;
+	unsigned int column;
+	uint8_t bitmask;
+	uint8_t *dest;
+
+	/* Fall back to direct rendering if no cache was allocated, or
+	 * if the character lies outside the cacheable range.
+	 */
+	if ( ! glyphs->start )
+		return -ENOTSUP;
+	if ( character >= FBCON_GLYPHS )
+		return -ENOTSUP;
+
+	/* A transparent background over a picture cannot be
+	 * pre-rendered, since the pixel content is position-dependent.
+	 * With no picture, transparency renders as black.
+	 */
+	background = cell->background;
+	if ( background == FBCON_TRANSPARENT ) {
+		if ( fbcon->picture.start )
+			return -ENOTSUP;
+		background = 0;
+	}
+
+	/* Retag and invalidate the cache when the current attribute
+	 * pair changes.  Serve only cells drawn in the current
+	 * attributes, so that transiently differing cells (such as the
+	 * inverted cursor cell) do not thrash the cache.
+	 */
+	if ( ( cell->foreground != glyphs->foreground ) ||
+	     ( background != glyphs->background ) ) {
+		if ( ( cell->foreground != fbcon->foreground ) ||
+		     ( cell->background != fbcon->background ) )
+			return -ENOTSUP;
+		memset ( glyphs->valid, 0, sizeof ( glyphs->valid ) );
+		glyphs->foreground = cell->foreground;
+		glyphs->background = background;
+	}
+
+	/* Render glyph into cache, if not already present */
+	cached = ( character * fbcon->character.len * fbcon->font->height );
+	if ( ! ( glyphs->valid[ character / 8 ] &
+		 ( 1 << ( character % 8 ) ) ) ) {
+		fbcon->font->glyph ( character, glyph );
+		for ( row = 0 ; row < fbcon->font->height ; row++ ) {
+			dest = pixels;
+			for ( column = FBCON_CHAR_WIDTH, bitmask = glyph[row] ;
+			      column ; column--, bitmask <<= 1 ) {
+				memcpy ( dest, ( ( bitmask & 0x80 ) ?
+						 &cell->foreground :
+						 &background ), pixel_len );
+				dest += pixel_len;
+			}
+			copy_to_user ( glyphs->start,
+				       ( cached +
+					 ( row * fbcon->character.len ) ),
+				       pixels, sizeof ( pixels ) );
+		}
+		glyphs->valid[ character / 8 ] |= ( 1 << ( character % 8 ) );
+	}
+
+	/* Copy pre-rendered character rows to framebuffer */
+	for ( row = 0 ; row < fbcon->font->height ; row++ ) {
+		memcpy_user ( fbcon->start, offset, glyphs->start,
+			      ( cached + ( row * fbcon->character.len ) ),
+			      fbcon->character.len );
+		offset += fbcon->pixel->stride;
+	}
+
+	return 0;
+}
+
 /**
  * Draw character at specified position
  *
@@ -157,6 +251,8 @@ static void fbcon_store ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 static void fbcon_draw ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 			 unsigned int xpos, unsigned int ypos ) {
 	uint8_t glyph[fbcon->font->height];
+	struct fbcon_text_cell displayed;
+	size_t cell_offset;
 	size_t offset;
 	size_t pixel_len;
 	size_t skip_len;
@@ -166,8 +262,19 @@ static void fbcon_draw ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 	int transparent;
 	void *src;
 
-	/* Get font character */
-	fbcon->font->glyph ( cell->character, glyph );
+	/* Do nothing if this cell is already displayed, and record the
+	 * newly displayed cell otherwise.  Redrawing the entire
+	 * character array (e.g. after scrolling) thereby writes to the
+	 * (usually slow) framebuffer only for cells that have changed.
+	 */
+	cell_offset = ( ( ( ypos * fbcon->character.width ) + xpos ) *
+			sizeof ( *cell ) );
+	copy_from_user ( &displayed, fbcon->displayed.start, cell_offset,
+			 sizeof ( displayed ) );
+	if ( memcmp ( cell, &displayed, sizeof ( *cell ) ) == 0 )
+		return;
+	copy_to_user ( fbcon->displayed.start, cell_offset, cell,
+		       sizeof ( *cell ) );
 
 	/* Calculate pixel geometry */
 	offset = ( fbcon->indent +
@@ -176,6 +283,13 @@ static void fbcon_draw ( struct fbcon *fbcon, struct fbcon_text_cell *cell,
 	pixel_len = fbcon->pixel->len;
 	skip_len = ( fbcon->pixel->stride - fbcon->character.len );
 
+	/* Draw from pre-rendered glyph cache, if applicable */
+	if ( fbcon_blit ( fbcon, cell, offset ) == 0 )
+		return;
+
+	/* Get font character */
+	fbcon->font->glyph ( cell->character, glyph );
+
 	/* Check for transparent background colour */
 	transparent = ( cell->background == FBCON_TRANSPARENT );
 
@@ -241,6 +355,8 @@ static void fbcon_redraw ( struct fbcon *fbcon ) {
  */
 static void fbcon_scroll ( struct fbcon *fbcon ) {
 	size_t row_len;
+	size_t blit_len;
+	size_t end;
 
 	/* Sanity check */
 	assert ( fbcon->ypos == fbcon->character.height );
@@ -251,6 +367,28 @@ static void fbcon_scroll ( struct fbcon *fbcon ) {
 		       ( row_len * ( fbcon->character.height - 1 ) ) );
 	fbcon_clear ( fbcon, ( fbcon->character.height - 1 ) );
 
+	/* Scroll up the framebuffer (and the displayed character
+	 * array to match), if no background picture exists.  The
+	 * pixel content of each character row is then position
+	 * independent, and the subsequent redraw need write to the
+	 * framebuffer only for the newly cleared bottom row.  (With a
+	 * background picture, scrolling the framebuffer would scroll
+	 * the fixed background along with the text.)
+	 */
+	if ( ! fbcon->picture.start ) {
+		blit_len = ( fbcon->character.stride *
+			     ( fbcon->character.height - 1 ) );
+		end = ( fbcon->indent + fbcon->character.stride + blit_len );
+		if ( end > fbcon->len )
+			blit_len -= ( end - fbcon->len );
+		memmove_user ( fbcon->start, fbcon->indent, fbcon->start,
+			       ( fbcon->indent + fbcon->character.stride ),
+			       blit_len );
+		memmove_user ( fbcon->displayed.start, 0,
+			       fbcon->displayed.start, row_len,
+			       ( row_len * ( fbcon->character.height - 1 ) ) );
+	}
+
 	/* Update cursor position */
 	fbcon->ypos--;
 
@@ -491,6 +629,69 @@ void fbcon_putchar ( struct fbcon *fbcon, int character ) {
 	fbcon_draw_cursor ( fbcon, fbcon->show_cursor );
 }
 
+/**
+ * Print a block of characters to current cursor position
+ *
+ * @v fbcon		Frame buffer console
+ * @v data		Characters
+ * @v len		Length of block
+ *
+ * Runs of plain printable text are printed in bulk, redrawing the
+ * cursor only once per run rather than once per character.  Escape
+ * sequences and control characters fall back to fbcon_putchar().
+ */
+void fbcon_putchars ( struct fbcon *fbcon, const char *data, size_t len ) {
+	struct fbcon_text_cell cell;
+	size_t span;
+	size_t run;
+	char character;
+
+	while ( len ) {
+
+		/* Find length of printable run: plain text up to the
+		 * next escape sequence or control character.
+		 */
+		span = ansiesc_span ( &fbcon->ctx, data, len );
+		for ( run = 0 ; run < span ; run++ ) {
+			character = data[run];
+			if ( ( character == '\r' ) || ( character == '\n' ) ||
+			     ( character == '\b' ) )
+				break;
+		}
+
+		/* Fall back to single-character processing if no
+		 * printable run exists.
+		 */
+		if ( ! run ) {
+			fbcon_putchar ( fbcon, *(data++) );
+			len--;
+			continue;
+		}
+
+		/* Hide cursor */
+		fbcon_draw_cursor ( fbcon, 0 );
+
+		/* Print run at current cursor position */
+		cell.foreground = ( fbcon->foreground | fbcon->bold );
+		cell.background = fbcon->background;
+		for ( len -= run ; run-- ; data++ ) {
+			cell.character = *data;
+			fbcon_store ( fbcon, &cell, fbcon->xpos, fbcon->ypos );
+			fbcon_draw ( fbcon, &cell, fbcon->xpos, fbcon->ypos );
+			fbcon->xpos++;
+			if ( fbcon->xpos >= fbcon->character.width ) {
+				fbcon->xpos = 0;
+				fbcon->ypos++;
+				if ( fbcon->ypos >= fbcon->character.height )
+					fbcon_scroll ( fbcon );
+			}
+		}
+
+		/* Show cursor */
+		fbcon_draw_cursor ( fbcon, fbcon->show_cursor );
+	}
+}
+
 /**
  * Initialise background picture
  *
@@ -593,6 +794,7 @@ int fbcon_init ( struct fbcon *fbcon, userptr_t start,
 	unsigned int right;
 	unsigned int top;
 	unsigned int bottom;
+	size_t text_len;
 	int rc;
 
 	/* Initialise data structure */
@@ -669,15 +871,33 @@ int fbcon_init ( struct fbcon *fbcon, userptr_t start,
 	fbcon_set_default_background ( fbcon );
 
 	/* Allocate and initialise stored character array */
-	fbcon->text.start = umalloc ( fbcon->character.width *
-				      fbcon->character.height *
-				      sizeof ( struct fbcon_text_cell ) );
+	text_len = ( fbcon->character.width * fbcon->character.height *
+		     sizeof ( struct fbcon_text_cell ) );
+	fbcon->text.start = umalloc ( text_len );
 	if ( ! fbcon->text.start ) {
 		rc = -ENOMEM;
 		goto err_text;
 	}
 	fbcon_clear ( fbcon, 0 );
 
+	/* Allocate displayed character array, initially matching the
+	 * cleared character array (since a blank screen displays every
+	 * cell as a space).
+	 */
+	fbcon->displayed.start = umalloc ( text_len );
+	if ( ! fbcon->displayed.start ) {
+		rc = -ENOMEM;
+		goto err_displayed;
+	}
+	memcpy_user ( fbcon->displayed.start, 0, fbcon->text.start, 0,
+		      text_len );
+
+	/* Allocate glyph cache.  Allocation failure is non-fatal;
+	 * characters will simply always be rendered directly.
+	 */
+	fbcon->glyphs.start = umalloc ( FBCON_GLYPHS * fbcon->character.len *
+					font->height );
+
 	/* Set framebuffer to all black (including margins) */
 	memset_user ( fbcon->start, 0, 0, fbcon->len );
 
@@ -699,6 +919,8 @@ int fbcon_init ( struct fbcon *fbcon, userptr_t start,
 
 	ufree ( fbcon->picture.start );
  err_picture:
+	ufree ( fbcon->displayed.start );
+ err_displayed:
 	ufree ( fbcon->text.start );
  err_text:
  err_margin:
@@ -713,5 +935,7 @@ int fbcon_init ( struct fbcon *fbcon, userptr_t start,
 void fbcon_fini ( struct fbcon *fbcon ) {
 
 	ufree ( fbcon->text.start );
+	ufree ( fbcon->displayed.start );
+	ufree ( fbcon->glyphs.start );
 	ufree ( fbcon->picture.start );
 }
@@ -36,6 +36,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/* The function call flight recorder (fntrace) provides an alternative
+ * implementation of the instrumentation hooks; at most one recorder
+ * can be compiled in.
+ */
+#ifndef FNTRACE
+
 /** Constant for identifying valid trace buffers */
 #define FNREC_MAGIC ( 'f' << 24 | 'n' << 16 | 'r' << 8 | 'e' )
 
@@ -205,3 +211,5 @@ void __cyg_profile_func_exit ( void *called_fn, void *call_site ) {
 		mb();
 	}
 }
+
+#endif /* FNTRACE */
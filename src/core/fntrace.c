@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Function call flight recorder
+ *
+ * Unlike the function trace recorder (fnrec), which coalesces repeat
+ * calls and is designed to survive a reset for crash forensics, this
+ * records every function entry and exit into a ring together with a
+ * timestamp delta, giving a latency trace of the most recent calls.
+ * The ring can be dumped at any point via the "fntrace" command and
+ * post-processed against the symbol table (e.g. with addr2line).
+ *
+ * Enable by building with FNTRACE=1.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <ipxe/profile.h>
+#include <ipxe/fntrace.h>
+
+#ifdef FNTRACE
+
+/** Number of trace ring entries (must be a power of two) */
+#define FNTRACE_NUM_ENTRIES 8192
+
+/** Flag set in @c fn to mark a function exit record
+ *
+ * Function entry points are always at least two-byte aligned, so the
+ * least significant bit of the address is free to distinguish entry
+ * from exit records.
+ */
+#define FNTRACE_EXIT 0x1UL
+
+/** A trace ring entry */
+struct fntrace_entry {
+	/** Called function address, with @c FNTRACE_EXIT flag */
+	unsigned long fn;
+	/** Timestamp delta since the previous record */
+	unsigned long delta;
+};
+
+/** The trace ring */
+static struct fntrace_entry fntrace_ring[FNTRACE_NUM_ENTRIES];
+
+/** Trace ring producer counter */
+static unsigned int fntrace_prod;
+
+/** Timestamp of the most recent record */
+static unsigned long fntrace_last;
+
+/** Recording enabled flag (disabled while dumping) */
+static int fntrace_stopped;
+
+/**
+ * Append a record to the trace ring
+ *
+ * @v fn		Called function address, with @c FNTRACE_EXIT flag
+ */
+static void fntrace_record ( unsigned long fn ) {
+	struct fntrace_entry *entry;
+	unsigned long now;
+
+	if ( fntrace_stopped )
+		return;
+
+	now = profile_timestamp();
+	entry = &fntrace_ring[ fntrace_prod++ & ( FNTRACE_NUM_ENTRIES - 1 ) ];
+	entry->fn = fn;
+	entry->delta = ( now - fntrace_last );
+	fntrace_last = now;
+}
+
+/**
+ * Dump and reset the trace ring
+ *
+ * Records are printed in chronological order as "<address> <+|->
+ * <delta>", where "+" marks a function entry, "-" a function exit,
+ * and the delta is in timestamp ticks since the previous record.
+ */
+void fntrace_dump ( void ) {
+	struct fntrace_entry *entry;
+	unsigned int cons;
+	unsigned int i;
+
+	/* Stop recording so that the dump does not trace itself */
+	fntrace_stopped = 1;
+
+	printf ( "fntrace ring dump:\n" );
+	cons = ( ( fntrace_prod >= FNTRACE_NUM_ENTRIES ) ?
+		 ( fntrace_prod - FNTRACE_NUM_ENTRIES ) : 0 );
+	for ( i = cons ; i != fntrace_prod ; i++ ) {
+		entry = &fntrace_ring[ i & ( FNTRACE_NUM_ENTRIES - 1 ) ];
+		printf ( "%08lx %c %ld\n",
+			 ( entry->fn & ~FNTRACE_EXIT ),
+			 ( ( entry->fn & FNTRACE_EXIT ) ? '-' : '+' ),
+			 entry->delta );
+	}
+
+	/* Reset ring and resume recording */
+	memset ( fntrace_ring, 0, sizeof ( fntrace_ring ) );
+	fntrace_prod = 0;
+	fntrace_last = profile_timestamp();
+	fntrace_stopped = 0;
+}
+
+/*
+ * These functions are called from every C function.  The compiler
+ * inserts these calls when -finstrument-functions is used.
+ */
+void __cyg_profile_func_enter ( void *called_fn,
+				void *call_site __unused ) {
+	fntrace_record ( ( unsigned long ) called_fn );
+}
+
+void __cyg_profile_func_exit ( void *called_fn,
+			       void *call_site __unused ) {
+	fntrace_record ( ( ( unsigned long ) called_fn ) | FNTRACE_EXIT );
+}
+
+#else /* FNTRACE */
+
+/**
+ * Dump and reset the trace ring
+ *
+ */
+void fntrace_dump ( void ) {
+	printf ( "Function tracing not enabled (build with FNTRACE=1)\n" );
+}
+
+#endif /* FNTRACE */
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <string.h>
+#include <errno.h>
+#include <byteswap.h>
+#include <ipxe/init.h>
+#include <ipxe/settings.h>
+#include <ipxe/malloc.h>
+
+/** @file
+ *
+ * Heap settings
+ *
+ * Expose heap high-water and memory pressure forensics through the
+ * settings machinery, so that boot scripts can report memory pressure
+ * without requiring a debug build.
+ */
+
+/** Heap setting tags */
+enum heap_setting_tag {
+	/** Maximum amount of used memory */
+	HEAP_MAXUSED = 1,
+	/** Number of allocations failed due to memory exhaustion */
+	HEAP_FAILS,
+	/** Number of cache discard iterations run under memory pressure */
+	HEAP_DISCARDS,
+	/** Smallest-ever largest free block under memory pressure */
+	HEAP_MINLARGEST,
+};
+
+/** Heap settings scope */
+static const struct settings_scope heap_settings_scope;
+
+/**
+ * Check applicability of heap setting
+ *
+ * @v settings		Settings block
+ * @v setting		Setting
+ * @ret applies		Setting applies within this settings block
+ */
+static int heap_settings_applies ( struct settings *settings __unused,
+				   const struct setting *setting ) {
+
+	return ( setting->scope == &heap_settings_scope );
+}
+
+/**
+ * Fetch value of heap setting
+ *
+ * @v settings		Settings block
+ * @v setting		Setting to fetch
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int heap_settings_fetch ( struct settings *settings,
+				 struct setting *setting,
+				 void *data, size_t len ) {
+	uint64_t result;
+
+	/* Extract result from heap statistics */
+	switch ( setting->tag ) {
+	case HEAP_MAXUSED:
+		result = maxusedmem;
+		break;
+	case HEAP_FAILS:
+		result = heap_fails;
+		break;
+	case HEAP_DISCARDS:
+		result = heap_discards;
+		break;
+	case HEAP_MINLARGEST:
+		result = heap_minlargest;
+		break;
+	default:
+		DBGC ( settings, "HEAP unknown setting tag %#02llx\n",
+		       ( ( unsigned long long ) setting->tag ) );
+		return -ENOENT;
+	}
+
+	/* Return result */
+	result = cpu_to_be64 ( result );
+	if ( len > sizeof ( result ) )
+		len = sizeof ( result );
+	memcpy ( data, &result, len );
+
+	/* Set type if not already specified */
+	if ( ! setting->type )
+		setting->type = &setting_type_int32;
+
+	return sizeof ( result );
+}
+
+/** Heap settings operations */
+static struct settings_operations heap_settings_operations = {
+	.applies = heap_settings_applies,
+	.fetch = heap_settings_fetch,
+};
+
+/** Heap settings */
+static struct settings heap_settings = {
+	.refcnt = NULL,
+	.siblings = LIST_HEAD_INIT ( heap_settings.siblings ),
+	.children = LIST_HEAD_INIT ( heap_settings.children ),
+	.op = &heap_settings_operations,
+	.default_scope = &heap_settings_scope,
+};
+
+/** Initialise heap settings */
+static void heap_settings_init ( void ) {
+	int rc;
+
+	if ( ( rc = register_settings ( &heap_settings, NULL,
+					"heap" ) ) != 0 ) {
+		DBG ( "HEAP could not register settings: %s\n",
+		      strerror ( rc ) );
+		return;
+	}
+}
+
+/** Heap settings initialiser */
+struct init_fn heap_settings_init_fn __init_fn ( INIT_NORMAL ) = {
+	.initialise = heap_settings_init,
+};
+
+/** Heap high-water mark predefined setting */
+const struct setting heaphwm_setting __setting ( SETTING_MISC, heaphwm ) = {
+	.name = "heaphwm",
+	.description = "Maximum heap usage (in bytes)",
+	.tag = HEAP_MAXUSED,
+	.type = &setting_type_int32,
+	.scope = &heap_settings_scope,
+};
+
+/** Heap allocation failure count predefined setting */
+const struct setting heapfails_setting __setting ( SETTING_MISC,
+						   heapfails ) = {
+	.name = "heapfails",
+	.description = "Failed allocations",
+	.tag = HEAP_FAILS,
+	.type = &setting_type_int32,
+	.scope = &heap_settings_scope,
+};
+
+/** Heap discard iteration count predefined setting */
+const struct setting heapdiscards_setting __setting ( SETTING_MISC,
+						      heapdiscards ) = {
+	.name = "heapdiscards",
+	.description = "Cache discard iterations",
+	.tag = HEAP_DISCARDS,
+	.type = &setting_type_int32,
+	.scope = &heap_settings_scope,
+};
+
+/** Heap minimum largest free block predefined setting */
+const struct setting heapminblock_setting __setting ( SETTING_MISC,
+						      heapminblock ) = {
+	.name = "heapminblock",
+	.description = "Worst-case largest free block (in bytes)",
+	.tag = HEAP_MINLARGEST,
+	.type = &setting_type_int32,
+	.scope = &heap_settings_scope,
+};
@@ -32,6 +32,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <libgen.h>
 #include <syslog.h>
 #include <ipxe/list.h>
+#include <ipxe/milestone.h>
+#include <ipxe/telemetry.h>
 #include <ipxe/umalloc.h>
 #include <ipxe/uri.h>
 #include <ipxe/image.h>
@@ -278,6 +280,16 @@ struct image * find_image ( const char *name ) {
 	return NULL;
 }
 
+/**
+ * Export telemetry records
+ *
+ * This is a weak definition, which will be overridden if telemetry
+ * export is present in the build.
+ *
+ * @v event		Export event
+ */
+__weak void telemetry_export ( unsigned int event __unused ) {}
+
 /**
  * Execute image
  *
@@ -325,6 +337,8 @@ int image_exec ( struct image *image ) {
 
 	/* Record boot attempt */
 	syslog ( LOG_NOTICE, "Executing \"%s\"\n", image->name );
+	milestone ( image->name );
+	telemetry_export ( TELEMETRY_EVENT_EXEC );
 
 	/* Try executing the image */
 	if ( ( rc = image->type->exec ( image ) ) != 0 ) {
@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <ipxe/device.h>
 #include <ipxe/console.h>
+#include <ipxe/milestone.h>
 #include <ipxe/init.h>
 
 /** @file
@@ -55,6 +56,9 @@ void initialise ( void ) {
 	/* Call registered initialisation functions */
 	for_each_table_entry ( init_fn, INIT_FNS )
 		init_fn->initialise ();
+
+	/* Record milestone (now that the timer is initialised) */
+	milestone ( "initialise" );
 }
 
 /**
@@ -76,6 +80,7 @@ void startup ( void ) {
 			DBGC ( colour, "INIT startup %s...\n",
 			       startup_fn->name );
 			startup_fn->startup();
+			milestone ( startup_fn->name );
 		}
 	}
 
@@ -26,6 +26,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <strings.h>
 #include <errno.h>
+#include <ipxe/io.h>
 #include <ipxe/malloc.h>
 #include <ipxe/iobuf.h>
 
@@ -35,6 +36,45 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Minimum capacity for a recyclable I/O buffer
+ *
+ * Only buffers large enough to hold a full-length Ethernet frame are
+ * worth recycling; smaller buffers are cheap to allocate directly.
+ */
+#define IOB_CACHE_MIN_LEN 1514
+
+/** Maximum capacity for a recyclable I/O buffer
+ *
+ * Recycling unusually large buffers would risk holding substantial
+ * amounts of memory out of the general allocation pool.
+ */
+#define IOB_CACHE_MAX_LEN 4096
+
+/** Maximum number of I/O buffers in the recycling cache */
+#define IOB_CACHE_MAX 16
+
+/** Recycled free I/O buffers */
+static LIST_HEAD ( iob_cache );
+
+/** Number of recycled free I/O buffers */
+static unsigned int iob_cache_count;
+
+/** Maximum number of pooled detached I/O buffer descriptors
+ *
+ * Detached descriptors are allocated whenever a large buffer (such as
+ * a TCP transmit or receive queue entry) cannot accommodate an inline
+ * descriptor.  Pooling them prevents these tiny allocations from
+ * interleaving with the large data allocations and fragmenting the
+ * heap.
+ */
+#define IOB_DESC_POOL_MAX 32
+
+/** Pooled detached I/O buffer descriptors */
+static LIST_HEAD ( iob_desc_pool );
+
+/** Number of pooled detached I/O buffer descriptors */
+static unsigned int iob_desc_pool_count;
+
 /**
  * Allocate I/O buffer with specified alignment and offset
  *
@@ -101,15 +141,27 @@ struct io_buffer * alloc_iob_raw ( size_t len, size_t align, size_t offset ) {
 		if ( ! data )
 			return NULL;
 
-		/* Allocate memory for descriptor */
-		iobuf = malloc ( sizeof ( *iobuf ) );
-		if ( ! iobuf ) {
-			free_dma ( data, len );
-			return NULL;
+		/* Reuse a pooled descriptor, or allocate memory for a
+		 * new descriptor.
+		 */
+		iobuf = list_first_entry ( &iob_desc_pool, struct io_buffer,
+					   list );
+		if ( iobuf ) {
+			list_del ( &iobuf->list );
+			iob_desc_pool_count--;
+		} else {
+			iobuf = malloc ( sizeof ( *iobuf ) );
+			if ( ! iobuf ) {
+				free_dma ( data, len );
+				return NULL;
+			}
 		}
 	}
 
 	/* Populate descriptor */
+	INIT_LIST_HEAD ( &iobuf->fragments );
+	iobuf->gso_size = 0;
+	iobuf->flags = 0;
 	iobuf->head = iobuf->data = iobuf->tail = data;
 	iobuf->end = ( data + len );
 
@@ -126,11 +178,31 @@ struct io_buffer * alloc_iob_raw ( size_t len, size_t align, size_t offset ) {
  * up to the nearest power of two).
  */
 struct io_buffer * alloc_iob ( size_t len ) {
+	struct io_buffer *iobuf;
+	size_t align;
 
 	/* Pad to minimum length */
 	if ( len < IOB_ZLEN )
 		len = IOB_ZLEN;
 
+	/* Reuse a buffer from the recycling cache, if possible.  The
+	 * buffer must have at least the required capacity and must be
+	 * at least as strictly physically aligned as a freshly
+	 * allocated buffer would be.
+	 */
+	align = ( 1UL << fls ( len - 1 ) );
+	list_for_each_entry ( iobuf, &iob_cache, list ) {
+		if ( ( ( ( size_t ) ( iobuf->end - iobuf->head ) ) >= len ) &&
+		     ( ( virt_to_phys ( iobuf->head ) & ( align - 1 ) ) == 0 )){
+			list_del ( &iobuf->list );
+			iob_cache_count--;
+			iobuf->gso_size = 0;
+			iobuf->flags = 0;
+			iobuf->data = iobuf->tail = iobuf->head;
+			return iobuf;
+		}
+	}
+
 	/* Align buffer on its own size to avoid potential problems
 	 * with boundary-crossing DMA.
 	 */
@@ -143,12 +215,17 @@ struct io_buffer * alloc_iob ( size_t len ) {
  * @v iobuf	I/O buffer
  */
 void free_iob ( struct io_buffer *iobuf ) {
+	struct io_buffer *frag;
 	size_t len;
 
 	/* Allow free_iob(NULL) to be valid */
 	if ( ! iobuf )
 		return;
 
+	/* Free any chained fragments */
+	while ( ( frag = iob_unchain ( iobuf ) ) != NULL )
+		free_iob ( frag );
+
 	/* Sanity checks */
 	assert ( iobuf->head <= iobuf->data );
 	assert ( iobuf->data <= iobuf->tail );
@@ -158,6 +235,19 @@ void free_iob ( struct io_buffer *iobuf ) {
 	len = ( iobuf->end - iobuf->head );
 	if ( iobuf->end == iobuf ) {
 
+		/* Park frame-sized buffers in the recycling cache, if
+		 * there is room, rather than returning them to the
+		 * heap.  Cached buffers are released by the cache
+		 * discarder under memory pressure.
+		 */
+		if ( ( len >= IOB_CACHE_MIN_LEN ) &&
+		     ( len <= IOB_CACHE_MAX_LEN ) &&
+		     ( iob_cache_count < IOB_CACHE_MAX ) ) {
+			list_add ( &iobuf->list, &iob_cache );
+			iob_cache_count++;
+			return;
+		}
+
 		/* Descriptor is inline */
 		free_dma ( iobuf->head, ( len + sizeof ( *iobuf ) ) );
 
@@ -165,10 +255,232 @@ void free_iob ( struct io_buffer *iobuf ) {
 
 		/* Descriptor is detached */
 		free_dma ( iobuf->head, len );
+
+		/* Park descriptor in the pool, if there is room */
+		if ( iob_desc_pool_count < IOB_DESC_POOL_MAX ) {
+			list_add ( &iobuf->list, &iob_desc_pool );
+			iob_desc_pool_count++;
+			return;
+		}
 		free ( iobuf );
 	}
 }
 
+/**
+ * Fill an I/O buffer pool
+ *
+ * @v pool	I/O buffer pool
+ * @v max	Number of free buffers to fill pool up to
+ * @ret rc	Return status code
+ *
+ * Pre-allocates buffers in bulk until the pool holds @c max free
+ * buffers.  On allocation failure, any buffers already allocated
+ * remain in the pool.
+ */
+int iob_pool_fill ( struct iob_pool *pool, unsigned int max ) {
+	struct io_buffer *iobuf;
+
+	while ( pool->count < max ) {
+		iobuf = alloc_iob ( pool->len );
+		if ( ! iobuf )
+			return -ENOMEM;
+		list_add ( &iobuf->list, &pool->free );
+		pool->count++;
+	}
+	return 0;
+}
+
+/**
+ * Get a buffer from an I/O buffer pool
+ *
+ * @v pool	I/O buffer pool
+ * @ret iobuf	I/O buffer, or NULL if none available
+ *
+ * Falls back to a direct allocation if the pool is empty.
+ */
+struct io_buffer * iob_pool_get ( struct iob_pool *pool ) {
+	struct io_buffer *iobuf;
+
+	iobuf = list_first_entry ( &pool->free, struct io_buffer, list );
+	if ( iobuf ) {
+		list_del ( &iobuf->list );
+		pool->count--;
+		return iobuf;
+	}
+	return alloc_iob ( pool->len );
+}
+
+/**
+ * Return a buffer to an I/O buffer pool
+ *
+ * @v pool	I/O buffer pool
+ * @v iobuf	I/O buffer
+ *
+ * The buffer must originally have been obtained from the same pool
+ * (or allocated with the pool's buffer length).
+ */
+void iob_pool_put ( struct iob_pool *pool, struct io_buffer *iobuf ) {
+
+	assert ( ( ( size_t ) ( iobuf->end - iobuf->head ) ) >= pool->len );
+	iobuf->data = iobuf->tail = iobuf->head;
+	list_add ( &iobuf->list, &pool->free );
+	pool->count++;
+}
+
+/**
+ * Drain an I/O buffer pool
+ *
+ * @v pool	I/O buffer pool
+ *
+ * Frees all buffers held in the pool.
+ */
+void iob_pool_drain ( struct iob_pool *pool ) {
+	struct io_buffer *iobuf;
+	struct io_buffer *tmp;
+
+	list_for_each_entry_safe ( iobuf, tmp, &pool->free, list ) {
+		list_del ( &iobuf->list );
+		pool->count--;
+		free_iob ( iobuf );
+	}
+	assert ( pool->count == 0 );
+}
+
+/**
+ * Chain an I/O buffer as a fragment of another I/O buffer
+ *
+ * @v iobuf	I/O buffer
+ * @v frag	I/O buffer to chain as a fragment
+ *
+ * The fragment logically extends the data in @c iobuf without
+ * requiring the data to be copied into a single contiguous buffer.
+ * Ownership of @c frag passes to @c iobuf; it will be freed along
+ * with @c iobuf.
+ */
+void iob_chain ( struct io_buffer *iobuf, struct io_buffer *frag ) {
+
+	/* Fragments may not themselves have fragments */
+	assert ( list_empty ( &frag->fragments ) );
+
+	list_add_tail ( &frag->list, &iobuf->fragments );
+}
+
+/**
+ * Unchain the first fragment of an I/O buffer
+ *
+ * @v iobuf	I/O buffer
+ * @ret frag	Fragment, or NULL if the buffer has no fragments
+ *
+ * Ownership of the fragment returns to the caller.
+ */
+struct io_buffer * iob_unchain ( struct io_buffer *iobuf ) {
+	struct io_buffer *frag;
+
+	frag = list_first_entry ( &iobuf->fragments, struct io_buffer, list );
+	if ( frag )
+		list_del ( &frag->list );
+	return frag;
+}
+
+/**
+ * Calculate total length of data in an I/O buffer, including fragments
+ *
+ * @v iobuf	I/O buffer
+ * @ret len	Total length of data in buffer and chained fragments
+ */
+size_t iob_total_len ( struct io_buffer *iobuf ) {
+	struct io_buffer *frag;
+	size_t len;
+
+	len = iob_len ( iobuf );
+	list_for_each_entry ( frag, &iobuf->fragments, list )
+		len += iob_len ( frag );
+	return len;
+}
+
+/**
+ * Flatten an I/O buffer's fragment chain
+ *
+ * @v iobuf	I/O buffer
+ * @ret flat	Contiguous I/O buffer, or NULL on allocation failure
+ *
+ * For use by consumers that require contiguous data.  If the buffer
+ * has no fragments, it is returned unmodified.  Otherwise, a new
+ * contiguous buffer is allocated and the buffer and its fragments are
+ * copied into it and freed.
+ *
+ * If this call fails, then the original buffer (and its fragments)
+ * will be unmodified.
+ */
+struct io_buffer * iob_defrag ( struct io_buffer *iobuf ) {
+	struct io_buffer *flat;
+	struct io_buffer *frag;
+	size_t len;
+
+	/* Avoid copying if the buffer is already contiguous */
+	if ( list_empty ( &iobuf->fragments ) )
+		return iobuf;
+
+	/* Allocate new I/O buffer */
+	len = iob_total_len ( iobuf );
+	flat = alloc_iob_raw ( len, __alignof__ ( *iobuf ), 0 );
+	if ( ! flat )
+		return NULL;
+
+	/* Copy in data from buffer and fragments */
+	memcpy ( iob_put ( flat, iob_len ( iobuf ) ), iobuf->data,
+		 iob_len ( iobuf ) );
+	list_for_each_entry ( frag, &iobuf->fragments, list ) {
+		memcpy ( iob_put ( flat, iob_len ( frag ) ), frag->data,
+			 iob_len ( frag ) );
+	}
+
+	/* Free original buffer and fragments */
+	free_iob ( iobuf );
+
+	return flat;
+}
+
+/**
+ * Discard all I/O buffers in the recycling cache
+ *
+ * @ret discarded	Number of cached buffers discarded
+ */
+static unsigned int iob_cache_discard ( void ) {
+	struct io_buffer *iobuf;
+	struct io_buffer *tmp;
+	unsigned int discarded = 0;
+
+	/* Discard recycled buffers */
+	list_for_each_entry_safe ( iobuf, tmp, &iob_cache, list ) {
+		list_del ( &iobuf->list );
+		iob_cache_count--;
+		free_dma ( iobuf->head, ( ( iobuf->end - iobuf->head ) +
+					  sizeof ( *iobuf ) ) );
+		discarded++;
+	}
+
+	/* Discard pooled detached descriptors */
+	list_for_each_entry_safe ( iobuf, tmp, &iob_desc_pool, list ) {
+		list_del ( &iobuf->list );
+		iob_desc_pool_count--;
+		free ( iobuf );
+		discarded++;
+	}
+
+	return discarded;
+}
+
+/** I/O buffer recycling cache discarder
+ *
+ * Recycled buffers and pooled descriptors are already effectively
+ * free memory, and must be reclaimed before any real cached data is
+ * sacrificed.
+ */
+struct cache_discarder iob_cache_discarder __cache_discarder ( CACHE_FREE ) = {
+	.discard = iob_cache_discard,
+};
+
 /**
  * Ensure I/O buffer has sufficient headroom
  *
@@ -67,6 +67,7 @@ void empty_line_buffer ( struct line_buffer *linebuf ) {
 	free ( linebuf->data );
 	linebuf->data = NULL;
 	linebuf->len = 0;
+	linebuf->max_len = 0;
 	linebuf->consumed = 0;
 }
 
@@ -92,6 +93,7 @@ int line_buffer ( struct line_buffer *linebuf, const char *data, size_t len ) {
 	const char *eol;
 	size_t consume;
 	size_t new_len;
+	size_t new_max_len;
 	char *new_data;
 	char *lf;
 	char *cr;
@@ -107,14 +109,25 @@ int line_buffer ( struct line_buffer *linebuf, const char *data, size_t len ) {
 	if ( memchr ( data, '\0', consume ) )
 		return -EINVAL;
 
-	/* Reallocate data buffer and copy in new data */
+	/* Grow data buffer if necessary, doubling the allocated
+	 * length so that accumulation remains linear even when data
+	 * arrives in many small fragments.
+	 */
 	new_len = ( linebuf->len + consume );
-	new_data = realloc ( linebuf->data, ( new_len + 1 ) );
-	if ( ! new_data )
-		return -ENOMEM;
-	memcpy ( ( new_data + linebuf->len ), data, consume );
-	new_data[new_len] = '\0';
-	linebuf->data = new_data;
+	if ( new_len >= linebuf->max_len ) {
+		new_max_len = ( linebuf->max_len ? linebuf->max_len : 64 );
+		while ( new_max_len <= new_len )
+			new_max_len *= 2;
+		new_data = realloc ( linebuf->data, new_max_len );
+		if ( ! new_data )
+			return -ENOMEM;
+		linebuf->data = new_data;
+		linebuf->max_len = new_max_len;
+	}
+
+	/* Copy in new data */
+	memcpy ( ( linebuf->data + linebuf->len ), data, consume );
+	linebuf->data[new_len] = '\0';
 	linebuf->len = new_len;
 
 	/* If we have reached end of line, terminate the line */
@@ -90,6 +90,30 @@ struct autosized_block {
 /** List of free memory blocks */
 static LIST_HEAD ( free_blocks );
 
+/** Number of segregated free list size classes
+ *
+ * Each size class caches free blocks of a single size (a multiple of
+ * MIN_MEMBLOCK_SIZE), covering the small object sizes (I/O buffer
+ * metadata, reference-counted objects, etc.) that dominate the packet
+ * receive path.  Requests for larger blocks, or with non-trivial
+ * alignment requirements, fall through to the general free list.
+ */
+#define QUICK_CLASSES 16
+
+/** Maximum number of cached free blocks per size class
+ *
+ * This bounds the amount of memory that can be held outside the
+ * general free list, and hence the amount of coalescing opportunity
+ * that can be lost to the size-class cache.
+ */
+#define QUICK_CLASS_MAX 8
+
+/** Segregated per-size-class free block lists */
+static struct list_head quick_blocks[QUICK_CLASSES];
+
+/** Number of cached free blocks in each size class */
+static unsigned int quick_count[QUICK_CLASSES];
+
 /** Total amount of free memory */
 size_t freemem;
 
@@ -99,6 +123,21 @@ size_t usedmem;
 /** Maximum amount of used memory */
 size_t maxusedmem;
 
+/** Number of allocations failed due to memory exhaustion */
+unsigned int heap_fails;
+
+/** Number of cache discard iterations run under memory pressure */
+unsigned int heap_discards;
+
+/** Smallest-ever largest free block observed under memory pressure
+ *
+ * This is a fragmentation indicator: it records the size of the
+ * largest contiguous free block at the worst memory pressure event
+ * seen so far.  Zero indicates that no memory pressure event has yet
+ * occurred.
+ */
+size_t heap_minlargest;
+
 /**
  * Heap size
  *
@@ -106,9 +145,22 @@ size_t maxusedmem;
  */
 #define HEAP_SIZE ( 512 * 1024 )
 
+/**
+ * Initial heap size
+ *
+ * Only this much of the heap is added to the allocation pool at
+ * startup; the remainder is adopted lazily on first exhaustion.
+ * This keeps the startup path (which runs before any network traffic
+ * can be processed) to the minimum required to get going.
+ */
+#define HEAP_INITIAL_SIZE ( 128 * 1024 )
+
 /** The heap itself */
 static char heap[HEAP_SIZE] __attribute__ (( aligned ( __alignof__(void *) )));
 
+/** Amount of heap not yet added to the allocation pool */
+static size_t heap_deferred;
+
 /**
  * Mark all blocks in free list as defined
  *
@@ -243,10 +295,19 @@ static unsigned int discard_cache ( void ) {
 	struct cache_discarder *discarder;
 	unsigned int discarded;
 
+	/* Discarders are sorted by replacement cost, so the first
+	 * discarder to yield anything is always (one of) the
+	 * cheapest available; caches with a higher replacement cost
+	 * are sacrificed only once all cheaper caches are empty.
+	 */
 	for_each_table_entry ( discarder, CACHE_DISCARDERS ) {
 		discarded = discarder->discard();
-		if ( discarded )
+		if ( discarded ) {
+			DBGC ( &heap, "Discarded %d items (discarder %d)\n",
+			       discarded,
+			       table_index ( CACHE_DISCARDERS, discarder ) );
 			return discarded;
+		}
 	}
 	return 0;
 }
@@ -263,6 +324,55 @@ static void discard_all_cache ( void ) {
 	} while ( discarded );
 }
 
+/**
+ * Adopt any deferred heap region
+ *
+ * @ret adopted		Number of regions adopted
+ *
+ * Only part of the heap is added to the allocation pool at startup;
+ * the remainder is adopted here on first exhaustion.
+ */
+static unsigned int heap_adopt ( void ) {
+	size_t deferred = heap_deferred;
+
+	if ( ! deferred )
+		return 0;
+	heap_deferred = 0;
+	DBGC ( &heap, "Adopting deferred %zdkB of heap\n", ( deferred >> 10 ) );
+	mpopulate ( ( heap + HEAP_SIZE - deferred ), deferred );
+	return 1;
+}
+
+/**
+ * Identify segregated free list size class for a block size
+ *
+ * @v actual_size	Actual block size
+ * @ret qclass		Size class, or QUICK_CLASSES if size is not cacheable
+ */
+static unsigned int quick_class ( size_t actual_size ) {
+	size_t qclass;
+
+	assert ( ( actual_size & ( MIN_MEMBLOCK_SIZE - 1 ) ) == 0 );
+	qclass = ( ( actual_size / MIN_MEMBLOCK_SIZE ) - 1 );
+	return ( ( qclass < QUICK_CLASSES ) ? qclass : QUICK_CLASSES );
+}
+
+/**
+ * Initialise segregated free lists, if not already initialised
+ *
+ * The segregated free lists may be used (and will remain empty)
+ * before the heap itself has been initialised, so initialise lazily
+ * rather than relying on initialisation order.
+ */
+static void quick_init ( void ) {
+	unsigned int i;
+
+	if ( quick_blocks[0].next )
+		return;
+	for ( i = 0 ; i < QUICK_CLASSES ; i++ )
+		INIT_LIST_HEAD ( &quick_blocks[i] );
+}
+
 /**
  * Allocate a memory block
  *
@@ -285,11 +395,14 @@ void * alloc_memblock ( size_t size, size_t align, size_t offset ) {
 	struct memory_block *pre;
 	struct memory_block *post;
 	unsigned int discarded;
+	unsigned int qclass;
+	size_t largest;
 	void *ptr;
 
 	/* Sanity checks */
 	assert ( size != 0 );
 	assert ( ( align == 0 ) || ( ( align & ( align - 1 ) ) == 0 ) );
+	quick_init();
 	valgrind_make_blocks_defined();
 	check_blocks();
 
@@ -312,9 +425,34 @@ void * alloc_memblock ( size_t size, size_t align, size_t offset ) {
 
 	DBGC2 ( &heap, "Allocating %#zx (aligned %#zx+%zx)\n",
 		size, align, offset );
+
+	/* Attempt to reuse a block from the segregated free lists.
+	 * These cache only blocks aligned to MIN_MEMBLOCK_SIZE, so
+	 * may be used only when the alignment constraints reduce to
+	 * the standard minimum alignment.
+	 */
+	qclass = quick_class ( actual_size );
+	if ( ( qclass < QUICK_CLASSES ) &&
+	     ( align_mask == ( MIN_MEMBLOCK_SIZE - 1 ) ) &&
+	     ( ( offset & align_mask ) == 0 ) &&
+	     ( ! list_empty ( &quick_blocks[qclass] ) ) ) {
+		block = list_first_entry ( &quick_blocks[qclass],
+					   struct memory_block, list );
+		list_del ( &block->list );
+		quick_count[qclass]--;
+		DBGC2 ( &heap, "Reused cached [%p,%p)\n", block,
+			( ( ( void * ) block ) + actual_size ) );
+		ptr = block;
+		VALGRIND_MAKE_MEM_UNDEFINED ( ptr, size );
+		goto done;
+	}
+
 	while ( 1 ) {
 		/* Search through blocks for the first one with enough space */
+		largest = 0;
 		list_for_each_entry ( block, &free_blocks, list ) {
+			if ( block->size > largest )
+				largest = block->size;
 			pre_size = ( ( offset - virt_to_phys ( block ) )
 				     & align_mask );
 			if ( ( block->size < pre_size ) ||
@@ -371,17 +509,23 @@ void * alloc_memblock ( size_t size, size_t align, size_t offset ) {
 			goto done;
 		}
 
-		/* Try discarding some cached data to free up memory */
+		/* Adopt any deferred heap region, or try discarding
+		 * some cached data to free up memory.
+		 */
 		DBGC ( &heap, "Attempting discard for %#zx (aligned %#zx+%zx), "
 		       "used %zdkB\n", size, align, offset, ( usedmem >> 10 ) );
+		heap_discards++;
+		if ( ( heap_minlargest == 0 ) || ( largest < heap_minlargest ) )
+			heap_minlargest = largest;
 		valgrind_make_blocks_noaccess();
-		discarded = discard_cache();
+		discarded = ( heap_adopt() || discard_cache() );
 		valgrind_make_blocks_defined();
 		check_blocks();
 		if ( ! discarded ) {
 			/* Nothing available to discard */
 			DBGC ( &heap, "Failed to allocate %#zx (aligned "
 			       "%#zx)\n", size, align );
+			heap_fails++;
 			ptr = NULL;
 			goto done;
 		}
@@ -394,14 +538,14 @@ void * alloc_memblock ( size_t size, size_t align, size_t offset ) {
 }
 
 /**
- * Free a memory block
+ * Free a memory block directly to the general free list
  *
  * @v ptr		Memory allocated by alloc_memblock(), or NULL
  * @v size		Size of the memory
  *
  * If @c ptr is NULL, no action is taken.
  */
-void free_memblock ( void *ptr, size_t size ) {
+static void free_memblock_raw ( void *ptr, size_t size ) {
 	struct memory_block *freeing;
 	struct memory_block *block;
 	struct memory_block *tmp;
@@ -498,6 +642,91 @@ void free_memblock ( void *ptr, size_t size ) {
 	valgrind_make_blocks_noaccess();
 }
 
+/**
+ * Free a memory block
+ *
+ * @v ptr		Memory allocated by alloc_memblock(), or NULL
+ * @v size		Size of the memory
+ *
+ * Small blocks are parked on the segregated free lists for O(1)
+ * reuse by alloc_memblock(), rather than being merged back into the
+ * general free list.  Cached blocks remain accounted as used memory;
+ * the associated cache discarder returns them to the general pool
+ * under memory pressure.
+ *
+ * If @c ptr is NULL, no action is taken.
+ */
+void free_memblock ( void *ptr, size_t size ) {
+	struct memory_block *freeing;
+	size_t actual_size;
+	unsigned int qclass;
+
+	/* Allow for ptr==NULL */
+	if ( ! ptr )
+		return;
+
+	/* Sanity checks */
+	assert ( size != 0 );
+	quick_init();
+
+	/* Park on the relevant segregated free list, if the block is
+	 * of a cacheable size and alignment and there is room in the
+	 * size class.
+	 */
+	actual_size = ( ( size + MIN_MEMBLOCK_SIZE - 1 ) &
+			~( MIN_MEMBLOCK_SIZE - 1 ) );
+	qclass = quick_class ( actual_size );
+	if ( ( qclass < QUICK_CLASSES ) &&
+	     ( quick_count[qclass] < QUICK_CLASS_MAX ) &&
+	     ( ( virt_to_phys ( ptr ) & ( MIN_MEMBLOCK_SIZE - 1 ) ) == 0 ) ) {
+		VALGRIND_MAKE_MEM_NOACCESS ( ptr, size );
+		freeing = ptr;
+		VALGRIND_MAKE_MEM_UNDEFINED ( freeing, sizeof ( *freeing ) );
+		DBGC2 ( &heap, "Caching [%p,%p)\n", freeing,
+			( ( ( void * ) freeing ) + actual_size ) );
+		freeing->size = actual_size;
+		list_add ( &freeing->list, &quick_blocks[qclass] );
+		quick_count[qclass]++;
+		return;
+	}
+
+	/* Return to the general free list */
+	free_memblock_raw ( ptr, size );
+}
+
+/**
+ * Discard cached blocks from the segregated free lists
+ *
+ * @ret discarded	Number of cached blocks discarded
+ */
+static unsigned int quick_discard ( void ) {
+	struct memory_block *block;
+	unsigned int discarded = 0;
+	unsigned int i;
+
+	quick_init();
+	for ( i = 0 ; i < QUICK_CLASSES ; i++ ) {
+		while ( ! list_empty ( &quick_blocks[i] ) ) {
+			block = list_first_entry ( &quick_blocks[i],
+						   struct memory_block, list );
+			list_del ( &block->list );
+			quick_count[i]--;
+			free_memblock_raw ( block, block->size );
+			discarded++;
+		}
+	}
+	return discarded;
+}
+
+/** Segregated free list cache discarder
+ *
+ * Cached free blocks are already effectively free memory, and must
+ * be reclaimed before any real cached data is sacrificed.
+ */
+struct cache_discarder quick_discarder __cache_discarder ( CACHE_FREE ) = {
+	.discard = quick_discard,
+};
+
 /**
  * Reallocate memory
  *
@@ -634,6 +863,43 @@ void * zalloc ( size_t size ) {
 	return data;
 }
 
+/**
+ * Get heap statistics
+ *
+ * @v stats		Heap statistics to fill in
+ *
+ * Provides visibility into heap fragmentation: an allocation may fail
+ * despite an apparently adequate amount of free memory if no single
+ * free block is large enough.
+ */
+void mstats ( struct memory_stats *stats ) {
+	struct memory_block *block;
+	unsigned int i;
+
+	/* Record basic usage counters */
+	memset ( stats, 0, sizeof ( *stats ) );
+	stats->free = freemem;
+	stats->used = usedmem;
+	stats->maxused = maxusedmem;
+
+	/* Scan free list for largest block and block count */
+	valgrind_make_blocks_defined();
+	check_blocks();
+	list_for_each_entry ( block, &free_blocks, list ) {
+		if ( block->size > stats->largest )
+			stats->largest = block->size;
+		stats->blocks++;
+	}
+	valgrind_make_blocks_noaccess();
+
+	/* Count memory held in the segregated free lists */
+	quick_init();
+	for ( i = 0 ; i < QUICK_CLASSES ; i++ ) {
+		stats->cached += ( quick_count[i] *
+				   ( ( i + 1 ) * MIN_MEMBLOCK_SIZE ) );
+	}
+}
+
 /**
  * Add memory to allocation pool
  *
@@ -653,7 +919,7 @@ void mpopulate ( void *start, size_t len ) {
 	len &= ~( MIN_MEMBLOCK_SIZE - 1 );
 
 	/* Add to allocation pool */
-	free_memblock ( start, len );
+	free_memblock_raw ( start, len );
 
 	/* Fix up memory usage statistics */
 	usedmem += len;
@@ -666,7 +932,12 @@ void mpopulate ( void *start, size_t len ) {
 static void init_heap ( void ) {
 	VALGRIND_MAKE_MEM_NOACCESS ( heap, sizeof ( heap ) );
 	VALGRIND_MAKE_MEM_NOACCESS ( &free_blocks, sizeof ( free_blocks ) );
-	mpopulate ( heap, sizeof ( heap ) );
+
+	/* Populate the initial boot arena; the remainder is adopted
+	 * lazily by heap_adopt() on first exhaustion.
+	 */
+	mpopulate ( heap, HEAP_INITIAL_SIZE );
+	heap_deferred = ( HEAP_SIZE - HEAP_INITIAL_SIZE );
 }
 
 /** Memory allocator initialisation function */
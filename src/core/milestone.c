@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Boot-phase milestone timeline
+ *
+ * Boot time is dominated by a handful of phases (device probing,
+ * link-up, configuration, TLS negotiation, image download), and
+ * working out which phase regressed on a given machine requires
+ * timestamps rather than debug output.  Milestones are recorded in a
+ * small fixed-size table at interesting points during boot and may be
+ * dumped on demand as a phase-by-phase breakdown.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <ipxe/timer.h>
+#include <ipxe/profile.h>
+#include <ipxe/milestone.h>
+
+/** Maximum number of recorded milestones */
+#define MILESTONE_MAX 64
+
+/** Milestone table */
+static struct milestone milestones[MILESTONE_MAX];
+
+/** Number of recorded milestones */
+static unsigned int milestone_count;
+
+/**
+ * Convert timer ticks to milliseconds
+ *
+ * @v ticks		Timer ticks
+ * @ret ms		Milliseconds
+ */
+static unsigned long milestone_ms ( unsigned long ticks ) {
+	return ( ( ticks * 1000 ) / TICKS_PER_SEC );
+}
+
+/**
+ * Record a boot milestone
+ *
+ * @v name		Milestone name
+ *
+ * Records the current timestamp against the name.  Recording is
+ * silently dropped once the table is full.
+ */
+void milestone ( const char *name ) {
+	struct milestone *entry;
+
+	if ( milestone_count >= MILESTONE_MAX )
+		return;
+	entry = &milestones[milestone_count++];
+	snprintf ( entry->name, sizeof ( entry->name ), "%s", name );
+	entry->ticks = currticks();
+	entry->cycles = profile_timestamp();
+}
+
+/**
+ * Get recorded milestones
+ *
+ * @v list		Milestone table to fill in
+ * @ret count		Number of recorded milestones
+ */
+unsigned int milestone_list ( struct milestone **list ) {
+	*list = milestones;
+	return milestone_count;
+}
+
+/**
+ * Print milestone timeline
+ *
+ */
+void milestones_show ( void ) {
+	struct milestone *milestone;
+	unsigned long previous;
+	unsigned int i;
+
+	printf ( "%-20s %10s %10s\n", "Milestone", "ms", "delta" );
+	previous = ( milestone_count ? milestones[0].ticks : 0 );
+	for ( i = 0 ; i < milestone_count ; i++ ) {
+		milestone = &milestones[i];
+		printf ( "%-20s %10ld %10ld\n", milestone->name,
+			 milestone_ms ( milestone->ticks ),
+			 milestone_ms ( milestone->ticks - previous ) );
+		previous = milestone->ticks;
+	}
+}
+
+/**
+ * Export milestone timeline to the system log
+ *
+ * Each milestone is emitted as a machine-parseable line of
+ * space-separated key=value fields, so that external tooling can
+ * compare boot phase timings across the fleet.
+ */
+void milestones_export ( void ) {
+	struct milestone *milestone;
+	unsigned long previous;
+	unsigned int i;
+
+	previous = ( milestone_count ? milestones[0].ticks : 0 );
+	for ( i = 0 ; i < milestone_count ; i++ ) {
+		milestone = &milestones[i];
+		log_printf ( "MILESTONE name=%s ms=%ld delta=%ld "
+			     "cycles=%lld",
+			     milestone->name,
+			     milestone_ms ( milestone->ticks ),
+			     milestone_ms ( milestone->ticks - previous ),
+			     milestone->cycles );
+		if ( profile_mhz )
+			log_printf ( " mhz=%ld", profile_mhz );
+		log_printf ( "\n" );
+		previous = milestone->ticks;
+	}
+}
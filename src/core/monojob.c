@@ -31,6 +31,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/keys.h>
 #include <ipxe/job.h>
 #include <ipxe/monojob.h>
+#include <ipxe/netdevice.h>
+#include <ipxe/nap.h>
 #include <ipxe/timer.h>
 
 /** @file
@@ -39,6 +41,18 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Idle period after which the CPU is halted between polls
+ *
+ * If neither the job nor any network device has shown activity for
+ * this long, we assume that we are waiting on a remote party and halt
+ * the CPU until the next timer interrupt instead of busy polling.
+ * This caps wakeup latency at one timer tick, which is negligible
+ * compared to the round-trip time we are evidently waiting out, and
+ * avoids burning power (and thermal headroom, on passively cooled
+ * systems) while doing no useful work.
+ */
+#define MONOJOB_IDLE_TIMEOUT ( TICKS_PER_SEC / 4 )
+
 static int monojob_rc;
 
 static void monojob_close ( struct interface *intf, int rc ) {
@@ -71,6 +85,23 @@ static void monojob_clear ( size_t len ) {
 		putchar ( '\b' );
 }
 
+/**
+ * Count total received packets across all network devices
+ *
+ * @ret total		Total of all devices' receive completion counters
+ *
+ * Used as a cheap proxy for network activity: any change (including
+ * errored completions) indicates that polling is doing useful work.
+ */
+static unsigned int monojob_rx_count ( void ) {
+	struct net_device *netdev;
+	unsigned int total = 0;
+
+	for_each_netdev ( netdev )
+		total += ( netdev->rx_stats.good + netdev->rx_stats.bad );
+	return total;
+}
+
 /**
  * Wait for single foreground job to complete
  *
@@ -82,10 +113,13 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 	struct job_progress progress;
 	unsigned long last_check;
 	unsigned long last_progress;
+	unsigned long last_activity;
 	unsigned long last_display;
 	unsigned long now;
 	unsigned long elapsed;
 	unsigned long completed = 0;
+	unsigned int rx_count;
+	unsigned int old_rx_count;
 	unsigned long scaled_completed;
 	unsigned long scaled_total;
 	unsigned int percentage;
@@ -97,7 +131,9 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 	if ( string )
 		printf ( "%s...", string );
 	monojob_rc = -EINPROGRESS;
-	last_check = last_progress = last_display = currticks();
+	last_check = last_progress = last_activity = last_display =
+		currticks();
+	old_rx_count = monojob_rx_count();
 	while ( monojob_rc == -EINPROGRESS ) {
 
 		/* Allow job to progress */
@@ -106,12 +142,28 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 
 		/* Continue until a timer tick occurs (to minimise
 		 * time wasted checking for progress and keypresses).
+		 * Halt the CPU while waiting: unconditionally if we
+		 * have seen no activity for a while (with the timer
+		 * interrupt as wakeup), otherwise only if
+		 * interrupt-driven waiting is enabled.
 		 */
 		elapsed = ( now - last_check );
-		if ( ! elapsed )
+		if ( ! elapsed ) {
+			if ( ( now - last_activity ) >= MONOJOB_IDLE_TIMEOUT ){
+				cpu_nap();
+			} else {
+				net_nap();
+			}
 			continue;
+		}
 		last_check = now;
 
+		/* Record network receive activity */
+		rx_count = monojob_rx_count();
+		if ( rx_count != old_rx_count )
+			last_activity = now;
+		old_rx_count = rx_count;
+
 		/* Check for keypresses */
 		if ( iskey() ) {
 			key = getchar();
@@ -126,7 +178,7 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 
 		/* Reset timeout if progress has been made */
 		if ( completed != progress.completed )
-			last_progress = now;
+			last_progress = last_activity = now;
 		completed = progress.completed;
 
 		/* Check for timeout, if applicable */
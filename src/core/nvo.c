@@ -28,6 +28,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <string.h>
 #include <errno.h>
 #include <ipxe/dhcp.h>
+#include <ipxe/init.h>
 #include <ipxe/nvs.h>
 #include <ipxe/nvo.h>
 
@@ -37,6 +38,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** List of registered non-volatile options blocks */
+static LIST_HEAD ( nvo_blocks );
+
 /**
  * Calculate checksum over non-volatile stored options
  *
@@ -185,6 +189,9 @@ static int nvo_save ( struct nvo_block *nvo ) {
 		return rc;
 	}
 
+	/* Mark options as clean */
+	nvo->dirty = 0;
+
 	DBGC ( nvo, "NVO %p saved to non-volatile storage\n", nvo );
 	return 0;
 }
@@ -226,9 +233,12 @@ static int nvo_store ( struct settings *settings, const struct setting *setting,
 		return rc;
 	}
 
-	/* Save updated options to NVS */
-	if ( ( rc = nvo_save ( nvo ) ) != 0 )
-		return rc;
+	/* Mark options as dirty.  The write back to non-volatile
+	 * storage is deferred until shutdown (or unregistration),
+	 * since a program cycle is slow and a script will typically
+	 * store several settings in succession.
+	 */
+	nvo->dirty = 1;
 
 	return 0;
 }
@@ -306,9 +316,12 @@ int register_nvo ( struct nvo_block *nvo, struct settings *parent ) {
 					NVO_SETTINGS_NAME ) ) != 0 )
 		goto err_register;
 
+	/* Add to list of registered blocks */
+	list_add_tail ( &nvo->list, &nvo_blocks );
+
 	DBGC ( nvo, "NVO %p registered\n", nvo );
 	return 0;
-	
+
  err_register:
  err_load:
 	nvo_realloc ( nvo, 0 );
@@ -322,7 +335,38 @@ int register_nvo ( struct nvo_block *nvo, struct settings *parent ) {
  * @v nvo		Non-volatile options block
  */
 void unregister_nvo ( struct nvo_block *nvo ) {
+
+	/* Write back any dirty options while the underlying device is
+	 * still accessible.
+	 */
+	if ( nvo->dirty )
+		nvo_save ( nvo );
+
+	list_del ( &nvo->list );
 	unregister_settings ( &nvo->settings );
 	nvo_realloc ( nvo, 0 );
 	DBGC ( nvo, "NVO %p unregistered\n", nvo );
 }
+
+/**
+ * Write back all dirty non-volatile stored options
+ *
+ * @v flags		Shutdown flags
+ */
+static void nvo_shutdown ( int flags __unused ) {
+	struct nvo_block *nvo;
+
+	list_for_each_entry ( nvo, &nvo_blocks, list ) {
+		if ( nvo->dirty )
+			nvo_save ( nvo );
+	}
+}
+
+/** Non-volatile stored options startup function
+ *
+ * Must write back dirty options before devices are shut down.
+ */
+struct startup_fn nvo_startup_fn __startup_fn ( STARTUP_LATE ) = {
+	.name = "nvo",
+	.shutdown = nvo_shutdown,
+};
@@ -34,6 +34,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/open.h>
 #include <ipxe/socket.h>
 #include <ipxe/retry.h>
+#include <ipxe/timer.h>
 #include <ipxe/pinger.h>
 
 /** @file
@@ -53,6 +54,19 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #define EINFO_EPROTO_SEQ __einfo_uniqify ( EINFO_EPROTO, 0x03, \
 					   "Delayed or out-of-sequence reply" )
 
+/** Number of recent requests against which a reply may be matched
+ *
+ * Flood mode may have many requests outstanding at any one time.
+ * Transmission times are recorded for this many of the most recent
+ * sequence numbers, allowing replies to be matched (and round-trip
+ * times calculated) even when the sequence number has since moved on.
+ * This is a policy decision.
+ */
+#define PINGER_WINDOW 64
+
+/** Time allowed for straggling replies after the final flood-mode request */
+#define PINGER_FLOOD_DRAIN ( TICKS_PER_SEC / 4 )
+
 /** A pinger */
 struct pinger {
 	/** Reference count */
@@ -65,7 +79,7 @@ struct pinger {
 
 	/** Timer */
 	struct retry_timer timer;
-	/** Timeout */
+	/** Timeout (zero for flood mode) */
 	unsigned long timeout;
 
 	/** Payload length */
@@ -79,15 +93,19 @@ struct pinger {
 	/** Return status */
 	int rc;
 
+	/** Transmission times of recent requests (in ticks) */
+	unsigned long sent[PINGER_WINDOW];
+
 	/** Callback function
 	 *
 	 * @v src		Source socket address, or NULL
 	 * @v sequence		Sequence number
 	 * @v len		Payload length
+	 * @v rtt		Round-trip time (in ticks), or zero if unknown
 	 * @v rc		Status code
 	 */
 	void ( * callback ) ( struct sockaddr *src, unsigned int sequence,
-			      size_t len, int rc );
+			      size_t len, unsigned long rtt, int rc );
 };
 
 /**
@@ -169,9 +187,13 @@ static void pinger_expired ( struct retry_timer *timer, int over __unused ) {
 	struct io_buffer *iobuf;
 	int rc;
 
-	/* If no response has been received, notify the callback function */
-	if ( pinger->pending && pinger->callback )
-		pinger->callback ( NULL, pinger->sequence, 0, -ETIMEDOUT );
+	/* If no response has been received, notify the callback
+	 * function.  In flood mode, timer expiry paces transmission
+	 * rather than bounding the round-trip time, so unanswered
+	 * requests are accounted for only in the overall statistics.
+	 */
+	if ( pinger->pending && pinger->timeout && pinger->callback )
+		pinger->callback ( NULL, pinger->sequence, 0, 0, -ETIMEDOUT );
 
 	/* Check for termination */
 	if ( pinger->remaining && ( --pinger->remaining == 0 ) ) {
@@ -183,11 +205,22 @@ static void pinger_expired ( struct retry_timer *timer, int over __unused ) {
 	pinger->sequence++;
 
 	/* Restart timer.  Do this before attempting to transmit, in
-	 * case the transmission attempt fails.
+	 * case the transmission attempt fails.  In flood mode, allow
+	 * a grace period for straggling replies after the final
+	 * transmission.
 	 */
-	start_timer_fixed ( &pinger->timer, pinger->timeout );
+	if ( pinger->timeout ) {
+		start_timer_fixed ( &pinger->timer, pinger->timeout );
+	} else {
+		start_timer_fixed ( &pinger->timer,
+				    ( ( pinger->remaining == 1 ) ?
+				      PINGER_FLOOD_DRAIN : 0 ) );
+	}
 	pinger->pending = 1;
 
+	/* Record transmission time */
+	pinger->sent[ pinger->sequence % PINGER_WINDOW ] = currticks();
+
 	/* Allocate I/O buffer */
 	iobuf = xfer_alloc_iob ( &pinger->xfer, pinger->len );
 	if ( ! iobuf ) {
@@ -224,6 +257,8 @@ static int pinger_deliver ( struct pinger *pinger, struct io_buffer *iobuf,
 			    struct xfer_metadata *meta ) {
 	size_t len = iob_len ( iobuf );
 	uint16_t sequence = meta->offset;
+	uint16_t age = ( pinger->sequence - sequence );
+	unsigned long rtt = 0;
 	int terminate = 0;
 	int rc;
 
@@ -231,6 +266,12 @@ static int pinger_deliver ( struct pinger *pinger, struct io_buffer *iobuf,
 	if ( sequence == pinger->sequence )
 		pinger->pending = 0;
 
+	/* Calculate round-trip time, if a transmission time is still
+	 * recorded for this sequence number.
+	 */
+	if ( age < PINGER_WINDOW )
+		rtt = ( currticks() - pinger->sent[ sequence % PINGER_WINDOW ]);
+
 	/* Check for errors */
 	if ( len != pinger->len ) {
 		/* Incorrect length: terminate immediately if we are
@@ -247,9 +288,12 @@ static int pinger_deliver ( struct pinger *pinger, struct io_buffer *iobuf,
 		DBGC ( pinger, "PINGER %p received incorrect data:\n", pinger );
 		DBGC_HDA ( pinger, 0, iobuf->data, iob_len ( iobuf ) );
 		terminate = ( pinger->remaining != 0 );
-	} else if ( sequence != pinger->sequence ) {
-		/* Incorrect sequence number (probably a delayed response):
-		 * report via callback but otherwise ignore.
+	} else if ( ( sequence != pinger->sequence ) &&
+		    ( pinger->timeout || ( age >= PINGER_WINDOW ) ) ) {
+		/* Incorrect sequence number (probably a delayed
+		 * response): report via callback but otherwise
+		 * ignore.  In flood mode, replies to any request
+		 * within the matching window count as successes.
 		 */
 		DBGC ( pinger, "PINGER %p received sequence %d (expected %d)\n",
 		       pinger, sequence, pinger->sequence );
@@ -269,7 +313,7 @@ static int pinger_deliver ( struct pinger *pinger, struct io_buffer *iobuf,
 
 	/* Notify callback function, if applicable */
 	if ( pinger->callback )
-		pinger->callback ( meta->src, sequence, len, rc );
+		pinger->callback ( meta->src, sequence, len, rtt, rc );
 
 	/* Terminate if applicable */
 	if ( terminate )
@@ -303,7 +347,7 @@ static struct interface_descriptor pinger_job_desc =
  *
  * @v job		Job control interface
  * @v hostname		Hostname to ping
- * @v timeout		Timeout (in ticks)
+ * @v timeout		Timeout (in ticks), or zero for flood mode
  * @v len		Payload length
  * @v count		Number of packets to send (or zero for no limit)
  * @v callback		Callback function (or NULL)
@@ -313,14 +357,10 @@ int create_pinger ( struct interface *job, const char *hostname,
 		    unsigned long timeout, size_t len, unsigned int count,
 		    void ( * callback ) ( struct sockaddr *src,
 					  unsigned int sequence, size_t len,
-					  int rc ) ) {
+					  unsigned long rtt, int rc ) ) {
 	struct pinger *pinger;
 	int rc;
 
-	/* Sanity check */
-	if ( ! timeout )
-		return -EINVAL;
-
 	/* Allocate and initialise structure */
 	pinger = zalloc ( sizeof ( *pinger ) );
 	if ( ! pinger )
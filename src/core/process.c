@@ -23,6 +23,7 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <strings.h>
 #include <ipxe/list.h>
 #include <ipxe/init.h>
 #include <ipxe/process.h>
@@ -35,8 +36,15 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * all processes share a single stack and address space.
  */
 
-/** Process run queue */
-static LIST_HEAD ( run_queue );
+/** Process run queues, one per priority class */
+static struct list_head run_queues[PROC_PRIO_MAX] = {
+	[PROC_PRIO_HIGH] = LIST_HEAD_INIT ( run_queues[PROC_PRIO_HIGH] ),
+	[PROC_PRIO_TIMER] = LIST_HEAD_INIT ( run_queues[PROC_PRIO_TIMER] ),
+	[PROC_PRIO_NORMAL] = LIST_HEAD_INIT ( run_queues[PROC_PRIO_NORMAL] ),
+};
+
+/** Scheduler step counter, used to select the priority class to run */
+static unsigned int step_count;
 
 /**
  * Get pointer to object containing process
@@ -48,6 +56,20 @@ void * process_object ( struct process *process ) {
 	return ( ( ( void * ) process ) - process->desc->offset );
 }
 
+/**
+ * Get run queue for process
+ *
+ * @v process		Process
+ * @ret run_queue	Run queue
+ */
+static struct list_head * process_run_queue ( struct process *process ) {
+	unsigned int priority = process->desc->priority;
+
+	if ( priority >= PROC_PRIO_MAX )
+		priority = ( PROC_PRIO_MAX - 1 );
+	return &run_queues[priority];
+}
+
 /**
  * Add process to process list
  *
@@ -61,7 +83,7 @@ void process_add ( struct process *process ) {
 		DBGC ( PROC_COL ( process ), "PROCESS " PROC_FMT
 		       " starting\n", PROC_DBG ( process ) );
 		ref_get ( process->refcnt );
-		list_add_tail ( &process->list, &run_queue );
+		list_add_tail ( &process->list, process_run_queue ( process ) );
 	} else {
 		DBGC ( PROC_COL ( process ), "PROCESS " PROC_FMT
 		       " already started\n", PROC_DBG ( process ) );
@@ -92,22 +114,40 @@ void process_del ( struct process *process ) {
 /**
  * Single-step a single process
  *
- * This executes a single step of the first process in the run queue,
- * and moves the process to the end of the run queue.
+ * This selects a priority class, executes a single step of the first
+ * process in that class's run queue, and moves the process to the end
+ * of its run queue.
  */
 void step ( void ) {
 	struct process *process;
 	struct process_descriptor *desc;
+	unsigned int prio;
 	void *object;
 
-	if ( ( process = list_first_entry ( &run_queue, struct process,
-					    list ) ) ) {
+	/* Select the priority class to run.  Class N is scheduled on
+	 * one in every 2^(N+1) steps, with the lowest class absorbing
+	 * the remainder.  If the selected class's run queue is empty,
+	 * then the step is donated to the highest-priority non-empty
+	 * class.
+	 */
+	prio = ( ffs ( ++step_count ) - 1 );
+	if ( prio >= PROC_PRIO_MAX )
+		prio = ( PROC_PRIO_MAX - 1 );
+	process = list_first_entry ( &run_queues[prio], struct process, list );
+	for ( prio = 0 ; ( ( ! process ) && ( prio < PROC_PRIO_MAX ) ) ;
+	      prio++ ) {
+		process = list_first_entry ( &run_queues[prio],
+					     struct process, list );
+	}
+
+	if ( process ) {
 		ref_get ( process->refcnt ); /* Inhibit destruction mid-step */
 		desc = process->desc;
 		object = process_object ( process );
 		if ( desc->reschedule ) {
 			list_del ( &process->list );
-			list_add_tail ( &process->list, &run_queue );
+			list_add_tail ( &process->list,
+					process_run_queue ( process ) );
 		} else {
 			process_del ( process );
 		}
@@ -48,6 +48,21 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Accumulated time excluded from profiling */
 unsigned long profile_excluded;
 
+/** Timestamp frequency in MHz
+ *
+ * Set by the timer subsystem when the frequency of the
+ * profile_timestamp() source is known, allowing cycle counts to be
+ * converted to wall-clock time.  Zero if the frequency is unknown.
+ */
+unsigned long profile_mhz;
+
+/** Performance counter sampling is enabled
+ *
+ * Set (via profile_pmc_enable()) once the architecture's
+ * fixed-function performance counter has been successfully enabled.
+ */
+int profile_pmc_enabled;
+
 /**
  * Format a hex fraction (for debugging)
  *
@@ -127,6 +142,9 @@ void profile_update ( struct profiler *profiler, unsigned long sample ) {
 	if ( profiler->count < INT_MAX )
 		profiler->count++;
 
+	/* Update histogram, bucketed by order of magnitude */
+	profiler->buckets[ flsl ( sample ) ]++;
+
 	/* Adjust mean sample value scale if necessary.  Skip if
 	 * sample is zero (in which case flsl(sample)-1 would
 	 * underflow): in the case of a zero sample we have no need to
@@ -246,6 +264,21 @@ unsigned long profile_mean ( struct profiler *profiler ) {
 		 >> mean_shift );
 }
 
+/**
+ * Get mean performance counter sample value
+ *
+ * @v profiler		Profiler
+ * @ret mean		Mean performance counter delta per sample
+ */
+unsigned long profile_pmc_mean ( struct profiler *profiler ) {
+
+	/* Avoid division by zero */
+	if ( ! profiler->pmc_count )
+		return 0;
+
+	return ( profiler->pmc_total / profiler->pmc_count );
+}
+
 /**
  * Get sample variance
  *
@@ -276,3 +309,39 @@ unsigned long profile_stddev ( struct profiler *profiler ) {
 
 	return isqrt ( profile_variance ( profiler ) );
 }
+
+/**
+ * Get approximate percentile sample value
+ *
+ * @v profiler		Profiler
+ * @v percentile	Percentile (0-100)
+ * @ret value		Approximate percentile sample value
+ *
+ * The histogram records only binary orders of magnitude, so the
+ * returned value is the upper bound of the bucket containing the
+ * requested percentile, i.e. accurate to within a factor of two.
+ */
+unsigned long profile_percentile ( struct profiler *profiler,
+				   unsigned int percentile ) {
+	unsigned long long threshold;
+	unsigned long long cumulative = 0;
+	unsigned int i;
+
+	/* Calculate number of samples at or below the requested
+	 * percentile, rounding up.
+	 */
+	threshold = ( ( ( ( unsigned long long ) profiler->count ) *
+			percentile + 99 ) / 100 );
+
+	/* Find bucket within which this sample count is reached.
+	 * Bucket zero holds only zero-valued samples; the upper bound
+	 * calculation for other buckets is written to avoid an
+	 * overflowing shift for the final bucket.
+	 */
+	for ( i = 0 ; i < PROFILE_BUCKETS ; i++ ) {
+		cumulative += profiler->buckets[i];
+		if ( cumulative >= threshold )
+			return ( i ? ( ( 2UL << ( i - 1 ) ) - 1 ) : 0 );
+	}
+	return 0;
+}
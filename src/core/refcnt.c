@@ -32,6 +32,78 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+#ifdef REFCNT_STATS
+
+/** Per-class statistics for reference-counted objects */
+struct refcnt_stat refcnt_stats[REFCNT_STAT_MAX];
+
+/**
+ * Find statistics entry for an object class
+ *
+ * @v free		Free method (used as the class identity)
+ * @ret stat		Statistics entry, or NULL if table is full
+ *
+ * An unused entry will be returned if the class has not been seen
+ * before.
+ */
+static struct refcnt_stat *
+refcnt_stat_find ( void ( * free ) ( struct refcnt *refcnt ) ) {
+	struct refcnt_stat *stat;
+	unsigned int i;
+
+	for ( i = 0 ; i < REFCNT_STAT_MAX ; i++ ) {
+		stat = &refcnt_stats[i];
+		if ( ( stat->free == free ) || ( ! stat->name ) )
+			return stat;
+	}
+	return NULL;
+}
+
+/**
+ * Record creation of a reference-counted object
+ *
+ * @v refcnt		Reference counter
+ * @v name		Name of free() method
+ */
+void refcnt_stat_init ( struct refcnt *refcnt, const char *name ) {
+	struct refcnt_stat *stat;
+
+	stat = refcnt_stat_find ( refcnt->free );
+	if ( ! stat )
+		return;
+	if ( ! stat->name ) {
+		stat->name = name;
+		stat->free = refcnt->free;
+	}
+	stat->total++;
+	stat->live++;
+	if ( stat->live > stat->peak )
+		stat->peak = stat->live;
+}
+
+/**
+ * Record destruction of a reference-counted object
+ *
+ * @v refcnt		Reference counter
+ */
+static void refcnt_stat_fini ( struct refcnt *refcnt ) {
+	struct refcnt_stat *stat;
+
+	if ( ! refcnt->free )
+		return;
+	stat = refcnt_stat_find ( refcnt->free );
+	if ( stat && stat->name && stat->live )
+		stat->live--;
+}
+
+#else /* REFCNT_STATS */
+
+static void refcnt_stat_fini ( struct refcnt *refcnt __unused ) {
+	/* Do nothing */
+}
+
+#endif /* REFCNT_STATS */
+
 /**
  * Increment reference count
  *
@@ -80,6 +152,8 @@ void ref_decrement ( struct refcnt *refcnt ) {
 		return;
 	}
 
+	refcnt_stat_fini ( refcnt );
+
 	if ( refcnt->free ) {
 		DBGC ( refcnt, "REFCNT %p being freed via method %p\n",
 		       refcnt, refcnt->free );
@@ -30,6 +30,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
 #include <ipxe/process.h>
+#include <ipxe/retry.h>
+#include <ipxe/timer.h>
 #include <ipxe/socket.h>
 #include <ipxe/resolv.h>
 
@@ -298,6 +300,20 @@ int resolv ( struct interface *resolv, const char *name,
  ***************************************************************************
  */
 
+/** Maximum number of addresses between which to race connections */
+#define NAMED_MAX_ADDRESSES 2
+
+/** Delay before probing a connection to a less-preferred address
+ *
+ * When a name resolves to addresses in more than one address family,
+ * this is the length of time for which the most preferred address is
+ * allowed to establish a connection before a competing connection
+ * attempt is made to the next address.
+ *
+ * This is a policy decision.
+ */
+#define NAMED_RACE_DELAY ( TICKS_PER_SEC / 4 )
+
 /** A named socket */
 struct named_socket {
 	/** Reference counter */
@@ -306,12 +322,28 @@ struct named_socket {
 	struct interface xfer;
 	/** Name resolution interface */
 	struct interface resolv;
+	/** Preferred probe connection interface */
+	struct interface preferred;
+	/** Fallback probe connection interface */
+	struct interface fallback;
+	/** Probe delay timer */
+	struct retry_timer timer;
 	/** Communication semantics (e.g. SOCK_STREAM) */
 	int semantics;
 	/** Stored local socket address, if applicable */
 	struct sockaddr local;
 	/** Stored local socket address exists */
 	int have_local;
+	/** Resolved peer addresses (in order of preference) */
+	struct sockaddr peers[NAMED_MAX_ADDRESSES];
+	/** Number of resolved peer addresses */
+	unsigned int count;
+	/** Number of probe connections attempted */
+	unsigned int attempted;
+	/** Number of probe connections currently running */
+	unsigned int running;
+	/** First recorded probe failure */
+	int rc;
 };
 
 /**
@@ -321,7 +353,13 @@ struct named_socket {
  * @v rc		Reason for termination
  */
 static void named_close ( struct named_socket *named, int rc ) {
+
+	/* Stop probe delay timer */
+	stop_timer ( &named->timer );
+
 	/* Shut down interfaces */
+	intf_shutdown ( &named->preferred, rc );
+	intf_shutdown ( &named->fallback, rc );
 	intf_shutdown ( &named->resolv, rc );
 	intf_shutdown ( &named->xfer, rc );
 }
@@ -349,13 +387,13 @@ static struct interface_descriptor named_xfer_desc =
 			     resolv );
 
 /**
- * Name resolved
+ * Redirect parent interface to a resolved address
  *
  * @v named		Named socket
  * @v sa		Completed socket address
  */
-static void named_resolv_done ( struct named_socket *named,
-				struct sockaddr *sa ) {
+static void named_redirect ( struct named_socket *named,
+			     struct sockaddr *sa ) {
 	int rc;
 
 	/* Nullify data transfer interface */
@@ -379,9 +417,229 @@ static void named_resolv_done ( struct named_socket *named,
 	named_close ( named, rc );
 }
 
+/**
+ * Start next probe connection
+ *
+ * @v named		Named socket
+ * @ret rc		Return status code
+ */
+static int named_probe ( struct named_socket *named ) {
+	struct interface *probe = ( named->attempted ? &named->fallback :
+				    &named->preferred );
+	struct sockaddr *peer = &named->peers[named->attempted];
+	int rc;
+
+	/* Open probe connection to next address */
+	named->attempted++;
+	if ( ( rc = xfer_open_socket ( probe, named->semantics, peer,
+				       ( named->have_local ?
+					 &named->local : NULL ) ) ) != 0 ) {
+		DBGC ( named, "NAMED %p could not probe %s: %s\n", named,
+		       sock_ntoa ( peer ), strerror ( rc ) );
+		if ( named->rc == 0 )
+			named->rc = rc;
+		return rc;
+	}
+	DBGC ( named, "NAMED %p probing connection to %s\n",
+	       named, sock_ntoa ( peer ) );
+	named->running++;
+
+	return 0;
+}
+
+/**
+ * Check for a probe connection becoming established
+ *
+ * @v named		Named socket
+ * @v probe		Probe connection interface
+ * @v peer		Peer address being probed
+ */
+static void named_probe_ready ( struct named_socket *named,
+				struct interface *probe,
+				struct sockaddr *peer ) {
+
+	/* Ignore window changes before the connection is established */
+	if ( ! xfer_window ( probe ) )
+		return;
+
+	/* This probe won the race: redirect parent to its address.
+	 * (This will close both probe connections; the parent will
+	 * then open its own connection to the winning address.)
+	 */
+	DBGC ( named, "NAMED %p %s connected first\n",
+	       named, sock_ntoa ( peer ) );
+	named_redirect ( named, peer );
+}
+
+/**
+ * Handle probe connection failure
+ *
+ * @v named		Named socket
+ * @v probe		Probe connection interface
+ * @v rc		Reason for close
+ */
+static void named_probe_close ( struct named_socket *named,
+				struct interface *probe, int rc ) {
+
+	/* Restart probe interface */
+	intf_restart ( probe, rc );
+
+	/* Record first failure */
+	assert ( named->running > 0 );
+	named->running--;
+	if ( named->rc == 0 )
+		named->rc = ( rc ? rc : -ECONNABORTED );
+	DBGC ( named, "NAMED %p probe failed: %s\n",
+	       named, strerror ( rc ) );
+
+	/* Bring forward the next probe, if not yet attempted */
+	if ( named->attempted < named->count ) {
+		stop_timer ( &named->timer );
+		named_probe ( named );
+	}
+
+	/* Fail if no probes remain */
+	if ( ( named->running == 0 ) && ( named->attempted == named->count ) )
+		named_close ( named, named->rc );
+}
+
+/**
+ * Handle preferred probe connection window change
+ *
+ * @v named		Named socket
+ */
+static void named_preferred_window_changed ( struct named_socket *named ) {
+	named_probe_ready ( named, &named->preferred, &named->peers[0] );
+}
+
+/**
+ * Handle preferred probe connection close
+ *
+ * @v named		Named socket
+ * @v rc		Reason for close
+ */
+static void named_preferred_close ( struct named_socket *named, int rc ) {
+	named_probe_close ( named, &named->preferred, rc );
+}
+
+/**
+ * Handle fallback probe connection window change
+ *
+ * @v named		Named socket
+ */
+static void named_fallback_window_changed ( struct named_socket *named ) {
+	named_probe_ready ( named, &named->fallback, &named->peers[1] );
+}
+
+/**
+ * Handle fallback probe connection close
+ *
+ * @v named		Named socket
+ * @v rc		Reason for close
+ */
+static void named_fallback_close ( struct named_socket *named, int rc ) {
+	named_probe_close ( named, &named->fallback, rc );
+}
+
+/**
+ * Handle probe delay timer expiry
+ *
+ * @v timer		Retry timer
+ * @v over		Failure indicator
+ */
+static void named_expired ( struct retry_timer *timer, int over __unused ) {
+	struct named_socket *named =
+		container_of ( timer, struct named_socket, timer );
+
+	/* Start fallback probe connection */
+	if ( named->attempted < named->count )
+		named_probe ( named );
+
+	/* Fail if no probes remain */
+	if ( named->running == 0 )
+		named_close ( named, named->rc );
+}
+
+/**
+ * Name resolved
+ *
+ * @v named		Named socket
+ * @v sa		Completed socket address
+ */
+static void named_resolv_done ( struct named_socket *named,
+				struct sockaddr *sa ) {
+
+	/* Record address (ignoring any excess addresses) */
+	if ( named->count < NAMED_MAX_ADDRESSES ) {
+		memcpy ( &named->peers[named->count++], sa,
+			 sizeof ( named->peers[0] ) );
+	}
+}
+
+/**
+ * Name resolution completed
+ *
+ * @v named		Named socket
+ * @v rc		Reason for close
+ */
+static void named_resolv_close ( struct named_socket *named, int rc ) {
+
+	/* Fail if resolution failed or produced no addresses */
+	if ( ( rc != 0 ) || ( named->count == 0 ) ) {
+		named_close ( named, ( rc ? rc : -ENOTCONN ) );
+		return;
+	}
+
+	/* Shut down name resolution interface */
+	intf_shutdown ( &named->resolv, 0 );
+
+	/* Redirect immediately if there is no race to be run.  (Only
+	 * stream connections provide a usable establishment signal.)
+	 */
+	if ( ( named->count == 1 ) ||
+	     ( named->semantics != SOCK_STREAM ) ) {
+		named_redirect ( named, &named->peers[0] );
+		return;
+	}
+
+	/* Race connections: probe the most preferred address, and
+	 * give it a head start before probing the next.
+	 */
+	DBGC ( named, "NAMED %p racing connections to %d addresses\n",
+	       named, named->count );
+	if ( named_probe ( named ) != 0 ) {
+		/* Fall straight back to the next address */
+		named_redirect ( named, &named->peers[1] );
+		return;
+	}
+	start_timer_fixed ( &named->timer, NAMED_RACE_DELAY );
+}
+
+/** Named socket opener probe connection interface operations */
+static struct interface_operation named_preferred_op[] = {
+	INTF_OP ( xfer_window_changed, struct named_socket *,
+		  named_preferred_window_changed ),
+	INTF_OP ( intf_close, struct named_socket *, named_preferred_close ),
+};
+
+/** Named socket opener preferred probe interface descriptor */
+static struct interface_descriptor named_preferred_desc =
+	INTF_DESC ( struct named_socket, preferred, named_preferred_op );
+
+/** Named socket opener fallback probe interface operations */
+static struct interface_operation named_fallback_op[] = {
+	INTF_OP ( xfer_window_changed, struct named_socket *,
+		  named_fallback_window_changed ),
+	INTF_OP ( intf_close, struct named_socket *, named_fallback_close ),
+};
+
+/** Named socket opener fallback probe interface descriptor */
+static struct interface_descriptor named_fallback_desc =
+	INTF_DESC ( struct named_socket, fallback, named_fallback_op );
+
 /** Named socket opener resolver interface operations */
 static struct interface_operation named_resolv_op[] = {
-	INTF_OP ( intf_close, struct named_socket *, named_close ),
+	INTF_OP ( intf_close, struct named_socket *, named_resolv_close ),
 	INTF_OP ( resolv_done, struct named_socket *, named_resolv_done ),
 };
 
@@ -412,6 +670,10 @@ int xfer_open_named_socket ( struct interface *xfer, int semantics,
 	ref_init ( &named->refcnt, NULL );
 	intf_init ( &named->xfer, &named_xfer_desc, &named->refcnt );
 	intf_init ( &named->resolv, &named_resolv_desc, &named->refcnt );
+	intf_init ( &named->preferred, &named_preferred_desc,
+		    &named->refcnt );
+	intf_init ( &named->fallback, &named_fallback_desc, &named->refcnt );
+	timer_init ( &named->timer, named_expired, &named->refcnt );
 	named->semantics = semantics;
 	if ( local ) {
 		memcpy ( &named->local, local, sizeof ( named->local ) );
@@ -91,6 +91,8 @@ LIST_HEAD ( san_devices );
 /** Number of times to retry commands */
 static unsigned long san_retries = SAN_DEFAULT_RETRIES;
 
+static void sandev_cache_flush ( struct san_device *sandev );
+
 /**
  * Find SAN device by drive number
  *
@@ -120,6 +122,7 @@ static void sandev_free ( struct refcnt *refcnt ) {
 	assert ( ! timer_running ( &sandev->timer ) );
 	assert ( ! sandev->active );
 	assert ( list_empty ( &sandev->opened ) );
+	sandev_cache_flush ( sandev );
 	for ( i = 0 ; i < sandev->paths ; i++ ) {
 		uri_put ( sandev->path[i].uri );
 		assert ( sandev->path[i].desc == NULL );
@@ -134,6 +137,8 @@ static void sandev_free ( struct refcnt *refcnt ) {
  * @v rc		Reason for close
  */
 static void sandev_command_close ( struct san_device *sandev, int rc ) {
+	struct san_fragment *frag;
+	unsigned int i;
 
 	/* Stop timer */
 	stop_timer ( &sandev->timer );
@@ -141,10 +146,61 @@ static void sandev_command_close ( struct san_device *sandev, int rc ) {
 	/* Restart interface */
 	intf_restart ( &sandev->command, rc );
 
+	/* Abort any incomplete command fragments */
+	for ( i = 0 ; i < SANDEV_MAX_FRAGS ; i++ ) {
+		frag = &sandev->frag[i];
+		if ( frag->rc == -EINPROGRESS ) {
+			frag->rc = rc;
+			intf_restart ( &frag->data, rc );
+		}
+	}
+	sandev->pending = 0;
+
 	/* Record command status */
 	sandev->command_rc = rc;
 }
 
+/**
+ * Close SAN device command fragment
+ *
+ * @v frag		Command fragment
+ * @v rc		Reason for close
+ */
+static void sandev_frag_close ( struct san_fragment *frag, int rc ) {
+	struct san_device *sandev = frag->sandev;
+
+	/* Ignore if fragment has already completed */
+	if ( frag->rc != -EINPROGRESS )
+		return;
+
+	/* Record fragment status */
+	frag->rc = rc;
+	intf_restart ( &frag->data, rc );
+
+	/* Record first fragment error as overall command status */
+	if ( ( rc != 0 ) && ( sandev->command_rc == 0 ) )
+		sandev->command_rc = rc;
+
+	/* Wait (with a fresh timeout) for remaining fragments */
+	assert ( sandev->pending > 0 );
+	if ( --sandev->pending ) {
+		start_timer_fixed ( &sandev->timer, SAN_COMMAND_TIMEOUT );
+		return;
+	}
+
+	/* Complete command when the final fragment completes */
+	sandev_command_close ( sandev, sandev->command_rc );
+}
+
+/** SAN device command fragment interface operations */
+static struct interface_operation sandev_frag_op[] = {
+	INTF_OP ( intf_close, struct san_fragment *, sandev_frag_close ),
+};
+
+/** SAN device command fragment interface descriptor */
+static struct interface_descriptor sandev_frag_desc =
+	INTF_DESC ( struct san_fragment, data, sandev_frag_op );
+
 /**
  * Record SAN device capacity
  *
@@ -443,19 +499,57 @@ union san_command_params {
 static int sandev_command_rw ( struct san_device *sandev,
 			       const union san_command_params *params ) {
 	struct san_path *sanpath = sandev->active;
-	size_t len = ( params->rw.count * sandev->capacity.blksize );
+	struct san_fragment *frag;
+	userptr_t buffer = params->rw.buffer;
+	uint64_t lba = params->rw.lba;
+	unsigned int remaining = params->rw.count;
+	unsigned int count;
+	unsigned int i;
+	size_t len;
 	int rc;
 
-	/* Sanity check */
+	/* Sanity checks */
 	assert ( sanpath != NULL );
+	assert ( sandev->pending == 0 );
 
-	/* Initiate read/write command */
-	if ( ( rc = params->rw.block_rw ( &sanpath->block, &sandev->command,
-					  params->rw.lba, params->rw.count,
-					  params->rw.buffer, len ) ) != 0 ) {
-		DBGC ( sandev, "SAN %#02x.%d could not initiate read/write: "
-		       "%s\n", sandev->drive, sanpath->index, strerror ( rc ) );
-		return rc;
+	/* Reset command status */
+	sandev->command_rc = 0;
+
+	/* Issue concurrent fragments, up to the pipeline limit */
+	for ( i = 0 ; remaining && ( i < SANDEV_MAX_FRAGS ) ; i++ ) {
+		frag = &sandev->frag[i];
+
+		/* Determine fragment length */
+		count = sandev->capacity.max_count;
+		if ( count > remaining )
+			count = remaining;
+		len = ( count * sandev->capacity.blksize );
+
+		/* Initiate fragment read/write */
+		frag->rc = -EINPROGRESS;
+		if ( ( rc = params->rw.block_rw ( &sanpath->block, &frag->data,
+						  lba, count, buffer,
+						  len ) ) != 0 ) {
+			DBGC ( sandev, "SAN %#02x.%d could not initiate "
+			       "read/write: %s\n", sandev->drive,
+			       sanpath->index, strerror ( rc ) );
+			frag->rc = rc;
+
+			/* Fail immediately if nothing was issued;
+			 * otherwise let the issued fragments complete
+			 * and retry the command as a whole.
+			 */
+			if ( sandev->pending == 0 )
+				return rc;
+			sandev->command_rc = rc;
+			break;
+		}
+		sandev->pending++;
+
+		/* Move to next fragment */
+		buffer = userptr_add ( buffer, len );
+		lba += count;
+		remaining -= count;
 	}
 
 	return 0;
@@ -595,11 +689,14 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 	size_t frag_len;
 	int rc;
 
-	/* Initialise command parameters */
+	/* Initialise command parameters.  Each command is issued as
+	 * up to SANDEV_MAX_FRAGS concurrent fragments of at most
+	 * max_count blocks each.
+	 */
 	params.rw.block_rw = block_rw;
 	params.rw.buffer = buffer;
 	params.rw.lba = ( lba << sandev->blksize_shift );
-	params.rw.count = sandev->capacity.max_count;
+	params.rw.count = ( sandev->capacity.max_count * SANDEV_MAX_FRAGS );
 	remaining = ( count << sandev->blksize_shift );
 
 	/* Read/write fragments */
@@ -624,6 +721,199 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 	return 0;
 }
 
+/** Number of blocks per SAN device cache line
+ *
+ * Cache misses are rounded up to at least a full cache line, which
+ * provides read-ahead for sequential accesses.  This is a policy
+ * decision.
+ */
+#define SANDEV_CACHE_BLOCKS 16
+
+/** Maximum read-ahead length (in blocks)
+ *
+ * Sequential runs of cache misses cause the read-ahead length to
+ * ramp up to this limit, coalescing the dozens of adjacent small
+ * reads typically issued by chainloaded OS loaders into a few larger
+ * downstream reads.  This is a policy decision.
+ */
+#define SANDEV_CACHE_MAX_BLOCKS 64
+
+/** Maximum total length of cached data (in bytes)
+ *
+ * Chainloaded OS loaders repeatedly re-read a small set of metadata
+ * blocks (e.g. the MBR and filesystem allocation tables); a modest
+ * amount of cache is sufficient to absorb these repeats without
+ * placing undue pressure on the heap.  This is a policy decision.
+ */
+#define SANDEV_CACHE_MAX_LEN 65536
+
+/** A SAN device cache line */
+struct san_cache_line {
+	/** List of cache lines (most recently used first) */
+	struct list_head list;
+	/** Starting logical block address */
+	uint64_t lba;
+	/** Number of cached blocks */
+	unsigned int count;
+	/** Cached data */
+	void *data;
+	/** Length of cached data buffer */
+	size_t len;
+};
+
+/**
+ * Find cache line containing a logical block
+ *
+ * @v sandev		SAN device
+ * @v lba		Logical block address
+ * @ret line		Cache line, or NULL if not cached
+ */
+static struct san_cache_line * sandev_cache_find ( struct san_device *sandev,
+						   uint64_t lba ) {
+	struct san_cache_line *line;
+
+	list_for_each_entry ( line, &sandev->cache, list ) {
+		if ( ( lba >= line->lba ) &&
+		     ( lba < ( line->lba + line->count ) ) )
+			return line;
+	}
+	return NULL;
+}
+
+/**
+ * Discard cache lines overlapping a logical block range
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ */
+static void sandev_cache_discard ( struct san_device *sandev, uint64_t lba,
+				   unsigned int count ) {
+	struct san_cache_line *line;
+	struct san_cache_line *tmp;
+
+	list_for_each_entry_safe ( line, tmp, &sandev->cache, list ) {
+		if ( ( lba < ( line->lba + line->count ) ) &&
+		     ( line->lba < ( lba + count ) ) ) {
+			list_del ( &line->list );
+			free ( line->data );
+			free ( line );
+		}
+	}
+}
+
+/**
+ * Fill a cache line by reading from the SAN device
+ *
+ * @v sandev		SAN device
+ * @v lba		Logical block address to be cached
+ * @v count		Number of blocks to read (including read-ahead)
+ * @v cached		Cache line to fill in
+ * @ret rc		Return status code
+ */
+static int sandev_cache_fill ( struct san_device *sandev, uint64_t lba,
+			       unsigned int count,
+			       struct san_cache_line **cached ) {
+	struct san_cache_line *line;
+	size_t blksize = sandev_blksize ( sandev );
+	uint64_t blocks = sandev_capacity ( sandev );
+	uint64_t start;
+	size_t used = 0;
+	size_t len;
+	int rc;
+
+	/* Determine the aligned block range to read, clamped to the
+	 * device capacity.
+	 */
+	start = ( lba & ~( ( uint64_t ) ( SANDEV_CACHE_BLOCKS - 1 ) ) );
+	if ( ( start + count ) > blocks )
+		count = ( blocks - start );
+	len = ( blksize * count );
+
+	/* Clamp to the overall cache memory budget (which may be
+	 * exceeded by large-block devices such as CD-ROMs).
+	 */
+	if ( len > SANDEV_CACHE_MAX_LEN ) {
+		count = ( SANDEV_CACHE_MAX_LEN / blksize );
+		len = ( blksize * count );
+	}
+
+	/* Skip the cache entirely if the clamped line cannot cover
+	 * the requested block (e.g. when the device's block size
+	 * exceeds the cache memory budget); the caller will fall back
+	 * to an uncached read.
+	 */
+	if ( lba >= ( start + count ) )
+		return -ENOMEM;
+
+	/* Evict least recently used lines until the cache (including
+	 * the new line) fits within its memory budget.
+	 */
+	list_for_each_entry ( line, &sandev->cache, list )
+		used += line->len;
+	while ( ( ( used + len ) > SANDEV_CACHE_MAX_LEN ) &&
+		( ! list_empty ( &sandev->cache ) ) ) {
+		line = list_last_entry ( &sandev->cache,
+					 struct san_cache_line, list );
+		list_del ( &line->list );
+		used -= line->len;
+		free ( line->data );
+		free ( line );
+	}
+
+	/* Allocate new line */
+	line = zalloc ( sizeof ( *line ) );
+	if ( ! line ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	line->data = malloc ( len );
+	if ( ! line->data ) {
+		rc = -ENOMEM;
+		goto err_alloc_data;
+	}
+	line->len = len;
+	line->lba = start;
+	line->count = count;
+
+	/* Read from device */
+	if ( ( rc = sandev_rw ( sandev, line->lba, line->count,
+				virt_to_user ( line->data ),
+				block_read ) ) != 0 )
+		goto err_read;
+
+	/* Record end of fill for sequential run detection */
+	sandev->next_lba = ( line->lba + line->count );
+
+	/* Add as most recently used */
+	list_add ( &line->list, &sandev->cache );
+	*cached = line;
+	return 0;
+
+ err_read:
+	free ( line->data );
+ err_alloc_data:
+	free ( line );
+ err_alloc:
+	return rc;
+}
+
+/**
+ * Discard all cache lines
+ *
+ * @v sandev		SAN device
+ */
+static void sandev_cache_flush ( struct san_device *sandev ) {
+	struct san_cache_line *line;
+	struct san_cache_line *tmp;
+
+	list_for_each_entry_safe ( line, tmp, &sandev->cache, list ) {
+		list_del ( &line->list );
+		free ( line->data );
+		free ( line );
+	}
+}
+
 /**
  * Read from SAN device
  *
@@ -635,11 +925,74 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
  */
 int sandev_read ( struct san_device *sandev, uint64_t lba,
 		  unsigned int count, userptr_t buffer ) {
+	struct san_cache_line *line;
+	size_t blksize = sandev_blksize ( sandev );
+	size_t offset;
 	int rc;
 
-	/* Read from device */
-	if ( ( rc = sandev_rw ( sandev, lba, count, buffer, block_read ) ) != 0 )
-		return rc;
+	/* Bypass the cache for reads of at least one cache line, to
+	 * avoid polluting the cache with large streaming reads.
+	 */
+	if ( count >= SANDEV_CACHE_BLOCKS ) {
+		if ( ( rc = sandev_rw ( sandev, lba, count, buffer,
+					block_read ) ) != 0 )
+			return rc;
+		sandev->next_lba = ( lba + count );
+		return 0;
+	}
+
+	/* Serve each block from the cache, filling lines on demand */
+	while ( count ) {
+
+		/* Fill a cache line on a cache miss.  Fall back to an
+		 * uncached read if we are out of memory.
+		 */
+		line = sandev_cache_find ( sandev, lba );
+		if ( ! line ) {
+
+			/* Ramp up the read-ahead length while the
+			 * miss pattern remains sequential, coalescing
+			 * runs of adjacent small reads into larger
+			 * downstream reads.
+			 */
+			if ( lba == sandev->next_lba ) {
+				sandev->readahead *= 2;
+				if ( sandev->readahead >
+				     SANDEV_CACHE_MAX_BLOCKS ) {
+					sandev->readahead =
+						SANDEV_CACHE_MAX_BLOCKS;
+				}
+			} else {
+				sandev->readahead = SANDEV_CACHE_BLOCKS;
+			}
+
+			if ( ( rc = sandev_cache_fill ( sandev, lba,
+							sandev->readahead,
+							&line ) ) == -ENOMEM ) {
+				return sandev_rw ( sandev, lba, count, buffer,
+						   block_read );
+			} else if ( rc != 0 ) {
+				return rc;
+			}
+		} else {
+			DBGC2 ( sandev, "SAN %#02x cache hit for block "
+				"%#llx\n", sandev->drive,
+				( ( unsigned long long ) lba ) );
+		}
+
+		/* Mark line as most recently used */
+		list_del ( &line->list );
+		list_add ( &line->list, &sandev->cache );
+
+		/* Copy out cached block */
+		offset = ( ( lba - line->lba ) * blksize );
+		copy_to_user ( buffer, 0, ( line->data + offset ), blksize );
+
+		/* Move to next block */
+		buffer = userptr_add ( buffer, blksize );
+		lba++;
+		count--;
+	}
 
 	return 0;
 }
@@ -657,6 +1010,9 @@ int sandev_write ( struct san_device *sandev, uint64_t lba,
 		   unsigned int count, userptr_t buffer ) {
 	int rc;
 
+	/* Discard any cached blocks that overlap this write */
+	sandev_cache_discard ( sandev, lba, count );
+
 	/* Write to device */
 	if ( ( rc = sandev_rw ( sandev, lba, count, buffer, block_write ) ) != 0 )
 		return rc;
@@ -837,8 +1193,15 @@ struct san_device * alloc_sandev ( struct uri **uris, unsigned int count,
 	ref_init ( &sandev->refcnt, sandev_free );
 	intf_init ( &sandev->command, &sandev_command_desc, &sandev->refcnt );
 	timer_init ( &sandev->timer, sandev_command_expired, &sandev->refcnt );
+	for ( i = 0 ; i < SANDEV_MAX_FRAGS ; i++ ) {
+		sandev->frag[i].sandev = sandev;
+		intf_init ( &sandev->frag[i].data, &sandev_frag_desc,
+			    &sandev->refcnt );
+	}
 	sandev->priv = ( ( ( void * ) sandev ) + size );
 	sandev->paths = count;
+	INIT_LIST_HEAD ( &sandev->cache );
+	sandev->readahead = SANDEV_CACHE_BLOCKS;
 	INIT_LIST_HEAD ( &sandev->opened );
 	INIT_LIST_HEAD ( &sandev->closed );
 	for ( i = 0 ; i < count ; i++ ) {
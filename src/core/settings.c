@@ -43,6 +43,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/base64.h>
 #include <ipxe/pci.h>
 #include <ipxe/init.h>
+#include <ipxe/malloc.h>
 #include <ipxe/version.h>
 #include <ipxe/settings.h>
 
@@ -1456,6 +1457,88 @@ int storen_setting ( struct settings *settings, const struct setting *setting,
  ******************************************************************************
  */
 
+/** Number of predefined setting hash buckets
+ *
+ * This is a policy decision: must be a power of two, and should
+ * comfortably exceed the number of entries in the predefined settings
+ * table divided by a sensible chain length.
+ */
+#define SETTING_INDEX_BUCKETS 64
+
+/** A predefined setting hash index entry */
+struct setting_index_entry {
+	/** Next entry within this hash bucket */
+	struct setting_index_entry *next;
+	/** Predefined setting */
+	struct setting *setting;
+};
+
+/** Predefined setting hash index (keyed by setting name)
+ *
+ * Settings are expanded for every ${...} reference in a script, so
+ * the predefined settings table is indexed by name rather than being
+ * walked linearly for each lookup.  Entries within a bucket preserve
+ * table order.
+ */
+static struct setting_index_entry *setting_index[SETTING_INDEX_BUCKETS];
+
+/** Predefined setting hash index state
+ *
+ * Zero if not yet built, positive if built, negative if unavailable
+ * (in which case lookups fall back to a linear table walk).
+ */
+static int setting_index_state;
+
+/**
+ * Calculate setting hash index bucket
+ *
+ * @v name		Setting name
+ * @ret bucket		Hash bucket index
+ */
+static unsigned int setting_index_bucket ( const char *name ) {
+	unsigned int hash = 5381;
+
+	while ( *name )
+		hash = ( ( ( hash << 5 ) + hash ) ^ *(name++) );
+	return ( hash % SETTING_INDEX_BUCKETS );
+}
+
+/**
+ * Build predefined setting hash index
+ *
+ */
+static void setting_index_build ( void ) {
+	struct setting_index_entry *tails[SETTING_INDEX_BUCKETS];
+	struct setting_index_entry *entry;
+	struct setting *setting;
+	unsigned int bucket;
+
+	/* Allocate index entries (and fall back to linear walks on
+	 * failure, or if the index has already failed to build).
+	 */
+	entry = malloc ( table_num_entries ( SETTINGS ) * sizeof ( *entry ) );
+	if ( ! entry ) {
+		setting_index_state = -1;
+		return;
+	}
+
+	/* Add all predefined settings, preserving table order */
+	memset ( tails, 0, sizeof ( tails ) );
+	for_each_table_entry ( setting, SETTINGS ) {
+		entry->next = NULL;
+		entry->setting = setting;
+		bucket = setting_index_bucket ( setting->name );
+		if ( tails[bucket] ) {
+			tails[bucket]->next = entry;
+		} else {
+			setting_index[bucket] = entry;
+		}
+		tails[bucket] = entry;
+		entry++;
+	}
+	setting_index_state = 1;
+}
+
 /**
  * Find predefined setting
  *
@@ -1463,8 +1546,22 @@ int storen_setting ( struct settings *settings, const struct setting *setting,
  * @ret setting		Setting, or NULL
  */
 struct setting * find_setting ( const char *name ) {
+	struct setting_index_entry *entry;
 	struct setting *setting;
 
+	/* Use hash index, if available */
+	if ( ! setting_index_state )
+		setting_index_build();
+	if ( setting_index_state > 0 ) {
+		for ( entry = setting_index[ setting_index_bucket ( name ) ] ;
+		      entry ; entry = entry->next ) {
+			if ( strcmp ( name, entry->setting->name ) == 0 )
+				return entry->setting;
+		}
+		return NULL;
+	}
+
+	/* Fall back to linear table walk */
 	for_each_table_entry ( setting, SETTINGS ) {
 		if ( strcmp ( name, setting->name ) == 0 )
 			return setting;
@@ -1529,6 +1626,7 @@ int parse_setting_name ( char *name, get_child_settings_t get_child,
 	char *settings_name;
 	char *setting_name;
 	char *type_name;
+	struct setting_index_entry *entry;
 	struct setting *predefined;
 	int rc;
 
@@ -1563,11 +1661,31 @@ int parse_setting_name ( char *name, get_child_settings_t get_child,
 	setting->tag = parse_setting_tag ( setting_name );
 	setting->scope = (*settings)->default_scope;
 	setting->name = setting_name;
-	for_each_table_entry ( predefined, SETTINGS ) {
-		/* Matches a predefined setting; use that setting */
-		if ( setting_cmp ( predefined, setting ) == 0 ) {
-			memcpy ( setting, predefined, sizeof ( *setting ) );
-			break;
+	if ( ! setting_index_state )
+		setting_index_build();
+	if ( ( ! setting->tag ) && ( setting_index_state > 0 ) ) {
+		/* Tagless settings can match a predefined setting only
+		 * by name; use the hash index.
+		 */
+		for ( entry = setting_index[ setting_index_bucket
+					     ( setting_name ) ] ;
+		      entry ; entry = entry->next ) {
+			if ( setting_cmp ( entry->setting, setting ) == 0 ) {
+				memcpy ( setting, entry->setting,
+					 sizeof ( *setting ) );
+				break;
+			}
+		}
+	} else {
+		/* Tagged settings may also match by tag and scope;
+		 * walk the full table.
+		 */
+		for_each_table_entry ( predefined, SETTINGS ) {
+			if ( setting_cmp ( predefined, setting ) == 0 ) {
+				memcpy ( setting, predefined,
+					 sizeof ( *setting ) );
+				break;
+			}
 		}
 	}
 
@@ -2279,6 +2397,9 @@ const struct setting_type setting_type_busdevfn __setting_type = {
  *
  * The expanded string is allocated with malloc() and the caller must
  * eventually free() it.
+ *
+ * Fetched setting values are not themselves subject to further
+ * expansion.
  */
 char * expand_settings ( const char *string ) {
 	struct settings *settings;
@@ -2291,6 +2412,7 @@ char * expand_settings ( const char *string ) {
 	char *tail;
 	char *value;
 	char *tmp;
+	size_t offset = 0;
 	int new_len;
 	int rc;
 
@@ -2304,10 +2426,13 @@ char * expand_settings ( const char *string ) {
 
 		head = expstr;
 
-		/* Locate setting to be expanded */
+		/* Locate setting to be expanded, resuming the scan
+		 * from just after the most recently substituted value
+		 * so that each character is scanned only once.
+		 */
 		start = NULL;
 		end = NULL;
-		for ( tmp = expstr ; *tmp ; tmp++ ) {
+		for ( tmp = ( expstr + offset ) ; *tmp ; tmp++ ) {
 			if ( ( tmp[0] == '$' ) && ( tmp[1] == '{' ) )
 				start = tmp;
 			if ( start && ( tmp[0] == '}' ) ) {
@@ -2338,6 +2463,8 @@ char * expand_settings ( const char *string ) {
 
 		/* Construct expanded string and discard old string */
 		tmp = expstr;
+		offset = ( ( start - expstr ) +
+			   ( value ? strlen ( value ) : 0 ) );
 		new_len = asprintf ( &expstr, "%s%s%s",
 				     head, ( value ? value : "" ), tail );
 		free ( value );
@@ -2603,6 +2730,105 @@ struct builtin_setting unixtime_builtin_setting __builtin_setting = {
 	.fetch = unixtime_fetch,
 };
 
+/**
+ * Fetch free memory setting
+ *
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int memfree_fetch ( void *data, size_t len ) {
+	uint32_t content;
+
+	/* Return total free heap memory */
+	content = htonl ( freemem );
+	if ( len > sizeof ( content ) )
+		len = sizeof ( content );
+	memcpy ( data, &content, len );
+	return sizeof ( content );
+}
+
+/** Free memory setting */
+const struct setting memfree_setting __setting ( SETTING_MISC, memfree ) = {
+	.name = "memfree",
+	.description = "Free heap memory",
+	.type = &setting_type_uint32,
+	.scope = &builtin_scope,
+};
+
+/** Free memory built-in setting */
+struct builtin_setting memfree_builtin_setting __builtin_setting = {
+	.setting = &memfree_setting,
+	.fetch = memfree_fetch,
+};
+
+/**
+ * Fetch largest free memory block setting
+ *
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int memlargest_fetch ( void *data, size_t len ) {
+	struct memory_stats stats;
+	uint32_t content;
+
+	/* Return size of largest free heap block */
+	mstats ( &stats );
+	content = htonl ( stats.largest );
+	if ( len > sizeof ( content ) )
+		len = sizeof ( content );
+	memcpy ( data, &content, len );
+	return sizeof ( content );
+}
+
+/** Largest free memory block setting */
+const struct setting memlargest_setting
+	__setting ( SETTING_MISC, memlargest ) = {
+	.name = "memlargest",
+	.description = "Largest free heap block",
+	.type = &setting_type_uint32,
+	.scope = &builtin_scope,
+};
+
+/** Largest free memory block built-in setting */
+struct builtin_setting memlargest_builtin_setting __builtin_setting = {
+	.setting = &memlargest_setting,
+	.fetch = memlargest_fetch,
+};
+
+/**
+ * Fetch maximum used memory setting
+ *
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int memmax_fetch ( void *data, size_t len ) {
+	uint32_t content;
+
+	/* Return high watermark of used heap memory */
+	content = htonl ( maxusedmem );
+	if ( len > sizeof ( content ) )
+		len = sizeof ( content );
+	memcpy ( data, &content, len );
+	return sizeof ( content );
+}
+
+/** Maximum used memory setting */
+const struct setting memmax_setting __setting ( SETTING_MISC, memmax ) = {
+	.name = "memmax",
+	.description = "Maximum used heap memory",
+	.type = &setting_type_uint32,
+	.scope = &builtin_scope,
+};
+
+/** Maximum used memory built-in setting */
+struct builtin_setting memmax_builtin_setting __builtin_setting = {
+	.setting = &memmax_setting,
+	.fetch = memmax_fetch,
+};
+
 /**
  * Fetch built-in setting
  *
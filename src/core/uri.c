@@ -613,21 +613,28 @@ struct uri * uri_dup ( const struct uri *uri ) {
  */
 char * resolve_path ( const char *base_path,
 		      const char *relative_path ) {
-	char *base_copy;
-	char *base_tmp;
 	char *resolved;
+	char *path;
+	size_t len;
 
 	/* If relative path is absolute, just re-use it */
 	if ( relative_path[0] == '/' )
 		return strdup ( relative_path );
 
-	/* Create modifiable copy of path for dirname() */
-	base_copy = strdup ( base_path );
-	if ( ! base_copy )
+	/* Allocate a single buffer large enough to hold the resolved
+	 * path, and use it both as the modifiable copy of the base
+	 * path for dirname() and as the result.  Allow for dirname()
+	 * potentially returning "." for an empty base path.
+	 */
+	resolved = malloc ( strlen ( base_path ) + 1 /* possible "." */ +
+			    1 /* possible "/" */ +
+			    strlen ( relative_path ) + 1 /* NUL */ );
+	if ( ! resolved )
 		return NULL;
 
 	/* Strip filename portion of base path */
-	base_tmp = dirname ( base_copy );
+	strcpy ( resolved, base_path );
+	path = dirname ( resolved );
 
 	/* Process "./" and "../" elements */
 	while ( *relative_path == '.' ) {
@@ -639,9 +646,9 @@ char * resolve_path ( const char *base_path,
 		} else if ( *relative_path == '.' ) {
 			relative_path++;
 			if ( *relative_path == 0 ) {
-				base_tmp = dirname ( base_tmp );
+				path = dirname ( path );
 			} else if ( *relative_path == '/' ) {
-				base_tmp = dirname ( base_tmp );
+				path = dirname ( path );
 				relative_path++;
 			} else {
 				relative_path -= 2;
@@ -653,12 +660,16 @@ char * resolve_path ( const char *base_path,
 		}
 	}
 
-	/* Create and return new path */
-	if ( asprintf ( &resolved, "%s%s%s", base_tmp,
-			( ( base_tmp[ strlen ( base_tmp ) - 1 ] == '/' ) ?
-			  "" : "/" ), relative_path ) < 0 )
-		resolved = NULL;
-	free ( base_copy );
+	/* Construct new path in situ (allowing for dirname() having
+	 * returned a static string)
+	 */
+	if ( path != resolved )
+		memmove ( resolved, path, ( strlen ( path ) + 1 /* NUL */ ) );
+	len = strlen ( resolved );
+	if ( resolved[ len - 1 ] != '/' )
+		resolved[len++] = '/';
+	strcpy ( ( resolved + len ), relative_path );
+
 	return resolved;
 }
 
@@ -673,7 +684,7 @@ char * resolve_path ( const char *base_path,
  * relative URI (e.g. "../initrds/initrd.gz") and produces a new URI
  * (e.g. "http://ipxe.org/initrds/initrd.gz").
  */
-struct uri * resolve_uri ( const struct uri *base_uri,
+struct uri * resolve_uri ( struct uri *base_uri,
 			   struct uri *relative_uri ) {
 	struct uri tmp_uri;
 	char *tmp_path = NULL;
@@ -683,6 +694,13 @@ struct uri * resolve_uri ( const struct uri *base_uri,
 	if ( uri_is_absolute ( relative_uri ) || ( ! base_uri ) )
 		return uri_get ( relative_uri );
 
+	/* If relative URI contributes no fields, just re-use the base
+	 * URI rather than constructing an identical copy.
+	 */
+	if ( ! ( relative_uri->path || relative_uri->query ||
+		 relative_uri->fragment || relative_uri->params ) )
+		return uri_get ( base_uri );
+
 	/* Mangle URI */
 	memcpy ( &tmp_uri, base_uri, sizeof ( tmp_uri ) );
 	if ( relative_uri->path ) {
@@ -133,19 +133,24 @@ static char * format_hex ( char *end, unsigned long long num, int width,
 static char * format_decimal ( char *end, signed long num, int width,
 			       int flags ) {
 	char *ptr = end;
+	unsigned long unum;
 	int negative = 0;
 	int zpad = ( flags & ZPAD );
 	int pad = ( zpad | ' ' );
 
-	/* Generate the number */
+	/* Generate the number.  Use unsigned arithmetic for the digit
+	 * loop, since the compiler can then replace the division by a
+	 * cheaper multiplication.
+	 */
 	if ( num < 0 ) {
 		negative = 1;
 		num = -num;
 	}
+	unum = num;
 	do {
-		*(--ptr) = '0' + ( num % 10 );
-		num /= 10;
-	} while ( num );
+		*(--ptr) = '0' + ( unum % 10 );
+		unum /= 10;
+	} while ( unum );
 
 	/* Add "-" if necessary */
 	if ( negative && ( ! zpad ) )
@@ -428,15 +433,41 @@ int ssnprintf ( char *buf, ssize_t ssize, const char *fmt, ... ) {
 	return len;
 }
 
+/** Console output batch buffer length
+ *
+ * Output is accumulated into a stack buffer and written to the console
+ * devices in blocks, rather than one character at a time, since
+ * console output (e.g. to a serial port) may be synchronous and slow.
+ * This is a policy decision: the buffer need only be large enough to
+ * hold a typical line of output.
+ */
+#define PRINTF_BATCH_LEN 80
+
+/** Context used by vprintf() */
+struct pputc_context {
+	struct printf_context ctx;
+	/** Batch buffer for console output */
+	char buf[PRINTF_BATCH_LEN];
+};
+
 /**
  * Write character to console
  *
  * @v ctx		Context
  * @v c			Character
+ *
+ * Characters are accumulated into the batch buffer, which is written
+ * out whenever it becomes full.  Any final partial buffer contents
+ * must be written out by the caller.
  */
-static void printf_putchar ( struct printf_context *ctx __unused,
-			     unsigned int c ) {
-	putchar ( c );
+static void printf_pputc ( struct printf_context *ctx, unsigned int c ) {
+	struct pputc_context *pctx =
+		container_of ( ctx, struct pputc_context, ctx );
+	size_t fill = ( ctx->len % sizeof ( pctx->buf ) );
+
+	pctx->buf[fill] = c;
+	if ( fill == ( sizeof ( pctx->buf ) - 1 ) )
+		putchars ( pctx->buf, sizeof ( pctx->buf ) );
 }
 
 /**
@@ -447,11 +478,17 @@ static void printf_putchar ( struct printf_context *ctx __unused,
  * @ret len		Length of formatted string
  */
 int vprintf ( const char *fmt, va_list args ) {
-	struct printf_context ctx;
+	struct pputc_context pctx;
+	size_t len;
 
 	/* Hand off to vcprintf */
-	ctx.handler = printf_putchar;	
-	return vcprintf ( &ctx, fmt, args );	
+	pctx.ctx.handler = printf_pputc;
+	len = vcprintf ( &pctx.ctx, fmt, args );
+
+	/* Write out any final partial buffer contents */
+	putchars ( pctx.buf, ( len % sizeof ( pctx.buf ) ) );
+
+	return len;
 }
 
 /**
@@ -60,6 +60,7 @@ void xferbuf_free ( struct xfer_buffer *xferbuf ) {
 	xferbuf->op->realloc ( xferbuf, 0 );
 	xferbuf->len = 0;
 	xferbuf->pos = 0;
+	xferbuf->cap = 0;
 }
 
 /**
@@ -70,17 +71,39 @@ void xferbuf_free ( struct xfer_buffer *xferbuf ) {
  * @ret rc		Return status code
  */
 static int xferbuf_ensure_size ( struct xfer_buffer *xferbuf, size_t len ) {
+	size_t cap;
 	int rc;
 
 	/* If buffer is already large enough, do nothing */
 	if ( len <= xferbuf->len )
 		return 0;
 
-	/* Extend buffer */
-	if ( ( rc = xferbuf->op->realloc ( xferbuf, len ) ) != 0 ) {
-		DBGC ( xferbuf, "XFERBUF %p could not extend buffer to "
-		       "%zd bytes: %s\n", xferbuf, len, strerror ( rc ) );
-		return rc;
+	/* Extend backing store if necessary.  Grow geometrically:
+	 * reallocating to the exact size on every extension would
+	 * cause downloads of unknown length to copy the whole
+	 * received prefix on every delivery.
+	 */
+	if ( len > xferbuf->cap ) {
+		cap = ( xferbuf->cap + ( xferbuf->cap >> 1 ) );
+		if ( cap < len )
+			cap = len;
+		if ( ( rc = xferbuf->op->realloc ( xferbuf, cap ) ) != 0 ) {
+			DBGC ( xferbuf, "XFERBUF %p could not extend buffer "
+			       "to %zd bytes: %s\n", xferbuf, cap,
+			       strerror ( rc ) );
+			/* Retry with the exact size, in case the
+			 * over-allocation itself was the problem.
+			 */
+			cap = len;
+			if ( ( rc = xferbuf->op->realloc ( xferbuf,
+							   cap ) ) != 0 ) {
+				DBGC ( xferbuf, "XFERBUF %p could not extend "
+				       "buffer to %zd bytes: %s\n", xferbuf,
+				       cap, strerror ( rc ) );
+				return rc;
+			}
+		}
+		xferbuf->cap = cap;
 	}
 	xferbuf->len = len;
 
@@ -109,14 +132,58 @@ int xferbuf_write ( struct xfer_buffer *xferbuf, size_t offset,
 	if ( ( rc = xferbuf_ensure_size ( xferbuf, max_len ) ) != 0 )
 		return rc;
 
-	/* Copy data to buffer */
+	/* Copy data to buffer, unless the data has already been
+	 * written in place via a mapping obtained from xferbuf_map().
+	 */
 	profile_start ( &xferbuf_write_profiler );
-	xferbuf->op->write ( xferbuf, offset, data, len );
+	if ( ( ! xferbuf->op->map ) ||
+	     ( user_to_virt ( xferbuf->op->map ( xferbuf, offset ), 0 ) !=
+	       data ) ) {
+		xferbuf->op->write ( xferbuf, offset, data, len );
+	}
 	profile_stop ( &xferbuf_write_profiler );
 
 	return 0;
 }
 
+/**
+ * Map data transfer buffer for direct access
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @v len		Length of mapped region
+ * @ret map		Mapping of data buffer, or UNULL on error
+ *
+ * Returns a mapping of the buffer contents starting at @c offset and
+ * covering at least @c len bytes, extending the buffer if necessary.
+ * Data written directly through the mapping and subsequently
+ * delivered via xferbuf_deliver() (or xferbuf_write()) at the same
+ * offset will not be copied a second time, allowing received data to
+ * be placed directly into its final location.
+ *
+ * The mapping is valid only until the next call that may reallocate
+ * the buffer.
+ */
+userptr_t xferbuf_map ( struct xfer_buffer *xferbuf, size_t offset,
+			size_t len ) {
+	size_t max_len;
+
+	/* Fail if buffer does not support mapping */
+	if ( ! xferbuf->op->map )
+		return UNULL;
+
+	/* Check for overflow */
+	max_len = ( offset + len );
+	if ( max_len < offset )
+		return UNULL;
+
+	/* Ensure buffer is large enough to contain the mapped region */
+	if ( xferbuf_ensure_size ( xferbuf, max_len ) != 0 )
+		return UNULL;
+
+	return xferbuf->op->map ( xferbuf, offset );
+}
+
 /**
  * Read from data transfer buffer
  *
@@ -141,6 +208,34 @@ int xferbuf_read ( struct xfer_buffer *xferbuf, size_t offset,
 	return 0;
 }
 
+/**
+ * Release unused data transfer buffer capacity
+ *
+ * @v xferbuf		Data transfer buffer
+ * @ret rc		Return status code
+ *
+ * Shrinks the backing store to the current size of the data,
+ * releasing any capacity acquired through geometric over-allocation.
+ * Intended to be called once a transfer is complete.
+ */
+int xferbuf_trim ( struct xfer_buffer *xferbuf ) {
+	int rc;
+
+	/* Do nothing if there is no unused capacity */
+	if ( xferbuf->cap <= xferbuf->len )
+		return 0;
+
+	/* Shrink backing store */
+	if ( ( rc = xferbuf->op->realloc ( xferbuf, xferbuf->len ) ) != 0 ) {
+		DBGC ( xferbuf, "XFERBUF %p could not trim buffer to %zd "
+		       "bytes: %s\n", xferbuf, xferbuf->len, strerror ( rc ) );
+		return rc;
+	}
+	xferbuf->cap = xferbuf->len;
+
+	return 0;
+}
+
 /**
  * Add received data to data transfer buffer
  *
@@ -222,11 +317,25 @@ static void xferbuf_malloc_read ( struct xfer_buffer *xferbuf, size_t offset,
 	memcpy ( data, ( xferbuf->data + offset ), len );
 }
 
+/**
+ * Map malloc()-based data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @ret map		Mapping of data buffer at specified offset
+ */
+static userptr_t xferbuf_malloc_map ( struct xfer_buffer *xferbuf,
+				      size_t offset ) {
+
+	return virt_to_user ( xferbuf->data + offset );
+}
+
 /** malloc()-based data buffer operations */
 struct xfer_buffer_operations xferbuf_malloc_operations = {
 	.realloc = xferbuf_malloc_realloc,
 	.write = xferbuf_malloc_write,
 	.read = xferbuf_malloc_read,
+	.map = xferbuf_malloc_map,
 };
 
 /**
@@ -277,11 +386,59 @@ static void xferbuf_umalloc_read ( struct xfer_buffer *xferbuf, size_t offset,
 	copy_from_user ( data, *udata, offset, len );
 }
 
+/**
+ * Map umalloc()-based data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v offset		Starting offset
+ * @ret map		Mapping of data buffer at specified offset
+ */
+static userptr_t xferbuf_umalloc_map ( struct xfer_buffer *xferbuf,
+				       size_t offset ) {
+	userptr_t *udata = xferbuf->data;
+
+	return userptr_add ( *udata, offset );
+}
+
 /** umalloc()-based data buffer operations */
 struct xfer_buffer_operations xferbuf_umalloc_operations = {
 	.realloc = xferbuf_umalloc_realloc,
 	.write = xferbuf_umalloc_write,
 	.read = xferbuf_umalloc_read,
+	.map = xferbuf_umalloc_map,
+};
+
+/**
+ * Reallocate fixed-size caller-owned data buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v len		New length (or zero to free buffer)
+ * @ret rc		Return status code
+ */
+static int xferbuf_fixed_realloc ( struct xfer_buffer *xferbuf, size_t len ) {
+
+	/* The buffer is owned by the caller and can be neither
+	 * extended nor freed.  Reallocation is attempted only when the
+	 * registered capacity would be exceeded (or on xferbuf_free(),
+	 * for which releasing the backing store is a no-op).
+	 */
+	if ( len > xferbuf->cap )
+		return -ERANGE;
+
+	return 0;
+}
+
+/** Fixed-size caller-owned data buffer operations
+ *
+ * Data is written directly into a buffer provided (and owned) by the
+ * caller, which must be registered via xferbuf_fixed_init().
+ * Transfers exceeding the buffer capacity will fail.
+ */
+struct xfer_buffer_operations xferbuf_fixed_operations = {
+	.realloc = xferbuf_fixed_realloc,
+	.write = xferbuf_malloc_write,
+	.read = xferbuf_malloc_read,
+	.map = xferbuf_malloc_map,
 };
 
 /**
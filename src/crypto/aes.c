@@ -38,6 +38,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/crypto.h>
 #include <ipxe/ecb.h>
 #include <ipxe/cbc.h>
+#include <ipxe/gcm.h>
 #include <ipxe/aes.h>
 
 /** AES strides
@@ -404,6 +405,12 @@ static void aes_encrypt ( void *ctx, const void *src, void *dst, size_t len ) {
 	/* Sanity check */
 	assert ( len == sizeof ( *in ) );
 
+	/* Use accelerated implementation, if supported */
+	if ( aes_accel_supported() ) {
+		aes_accel_encrypt ( aes, src, dst );
+		return;
+	}
+
 	/* Initialise input state */
 	memcpy ( in, src, sizeof ( *in ) );
 
@@ -440,6 +447,12 @@ static void aes_decrypt ( void *ctx, const void *src, void *dst, size_t len ) {
 	/* Sanity check */
 	assert ( len == sizeof ( *in ) );
 
+	/* Use accelerated implementation, if supported */
+	if ( aes_accel_supported() ) {
+		aes_accel_decrypt ( aes, src, dst );
+		return;
+	}
+
 	/* Initialise input state */
 	memcpy ( in, src, sizeof ( *in ) );
 
@@ -783,8 +796,10 @@ static int aes_setkey ( void *ctx, const void *key, size_t keylen ) {
  *
  * @v ctx		Context
  * @v iv		Initialisation vector
+ * @v ivlen		Initialisation vector length
  */
-static void aes_setiv ( void *ctx __unused, const void *iv __unused ) {
+static void aes_setiv ( void *ctx __unused, const void *iv __unused,
+			size_t ivlen __unused ) {
 	/* Nothing to do */
 }
 
@@ -806,3 +821,7 @@ ECB_CIPHER ( aes_ecb, aes_ecb_algorithm,
 /* AES in Cipher Block Chaining mode */
 CBC_CIPHER ( aes_cbc, aes_cbc_algorithm,
 	     aes_algorithm, struct aes_context, AES_BLOCKSIZE );
+
+/* AES in Galois/Counter mode */
+GCM_CIPHER ( aes_gcm, aes_gcm_algorithm,
+	     aes_algorithm, struct aes_context );
@@ -26,6 +26,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <string.h>
 #include <assert.h>
+#include <ipxe/process.h>
 #include <ipxe/profile.h>
 #include <ipxe/bigint.h>
 
@@ -34,6 +35,17 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * Big integer support
  */
 
+/** Number of exponentiation ladder iterations between process steps
+ *
+ * A private-key modular exponentiation can otherwise monopolise the
+ * CPU for hundreds of milliseconds, during which protocol timers
+ * (e.g. EAPOL retransmission timers) are not serviced.
+ */
+#define BIGINT_MOD_EXP_STEP 32
+
+/** Modular exponentiation recursion depth */
+static unsigned int bigint_mod_exp_depth;
+
 /** Modular multiplication overall profiler */
 static struct profiler bigint_mod_multiply_profiler __profiler =
 	{ .name = "bigint_mod_multiply" };
@@ -50,6 +62,10 @@ static struct profiler bigint_mod_multiply_rescale_profiler __profiler =
 static struct profiler bigint_mod_multiply_subtract_profiler __profiler =
 	{ .name = "bigint_mod_multiply.subtract" };
 
+/** Montgomery multiplication profiler */
+static struct profiler bigint_mont_multiply_profiler __profiler =
+	{ .name = "bigint_mont_multiply" };
+
 /**
  * Perform modular multiplication of big integers
  *
@@ -119,6 +135,118 @@ void bigint_mod_multiply_raw ( const bigint_element_t *multiplicand0,
 	profile_stop ( &bigint_mod_multiply_profiler );
 }
 
+/**
+ * Calculate Montgomery reduction constant for modulus
+ *
+ * @v modulus0		Element 0 of big integer odd modulus
+ * @ret inverse		Negated inverse of modulus element 0 modulo 2^width
+ */
+static bigint_element_t
+bigint_mont_inverse ( const bigint_element_t modulus0 ) {
+	bigint_element_t inverse = modulus0;
+	unsigned int i;
+
+	/* An odd number is its own inverse modulo 8, and each Newton
+	 * iteration doubles the number of correct low-order bits:
+	 * five iterations therefore suffice for any element width up
+	 * to 96 bits.
+	 */
+	for ( i = 0 ; i < 5 ; i++ )
+		inverse *= ( 2 - ( modulus0 * inverse ) );
+	assert ( ( ( bigint_element_t ) ( modulus0 * inverse ) ) == 1 );
+
+	return -inverse;
+}
+
+/**
+ * Perform Montgomery multiplication of big integers
+ *
+ * @v multiplicand0	Element 0 of big integer to be multiplied
+ * @v multiplier0	Element 0 of big integer to be multiplied
+ * @v modulus0		Element 0 of big integer odd modulus
+ * @v inverse		Montgomery reduction constant for modulus
+ * @v result0		Element 0 of big integer to hold result
+ * @v size		Number of elements in operands, modulus, and result
+ * @v tmp		Temporary working space
+ *
+ * The result is the product of the multiplicand and multiplier
+ * divided by 2^(size*width), modulo the modulus.  Operands held in
+ * this form (i.e. premultiplied by 2^(size*width) modulo the modulus)
+ * remain in this form under Montgomery multiplication, allowing the
+ * expensive bit-by-bit modular reduction to be replaced by a single
+ * multiplication pass.
+ */
+static void bigint_mont_multiply_raw ( const bigint_element_t *multiplicand0,
+				       const bigint_element_t *multiplier0,
+				       const bigint_element_t *modulus0,
+				       bigint_element_t inverse,
+				       bigint_element_t *result0,
+				       unsigned int size, void *tmp ) {
+	const bigint_t ( size ) __attribute__ (( may_alias )) *multiplicand =
+		( ( const void * ) multiplicand0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *multiplier =
+		( ( const void * ) multiplier0 );
+	const bigint_t ( size ) __attribute__ (( may_alias )) *modulus =
+		( ( const void * ) modulus0 );
+	bigint_t ( size ) __attribute__ (( may_alias )) *result =
+		( ( void * ) result0 );
+	struct {
+		bigint_t ( size * 2 ) product;
+	} *temp = tmp;
+	bigint_dual_element_t product;
+	bigint_element_t *element;
+	bigint_element_t multiple;
+	bigint_element_t carry;
+	bigint_element_t overflow = 0;
+	unsigned int i;
+	unsigned int j;
+
+	/* Start profiling */
+	profile_start ( &bigint_mont_multiply_profiler );
+
+	/* Perform multiplication */
+	bigint_multiply ( multiplicand, multiplier, &temp->product );
+
+	/* Reduce the product one element at a time, by adding the
+	 * multiple of the modulus that zeroes the lowest remaining
+	 * element
+	 */
+	element = temp->product.element;
+	for ( i = 0 ; i < size ; i++, element++ ) {
+		multiple = ( element[0] * inverse );
+		carry = 0;
+		for ( j = 0 ; j < size ; j++ ) {
+			product = ( ( ( ( bigint_dual_element_t ) multiple ) *
+				      modulus->element[j] ) +
+				    element[j] + carry );
+			element[j] = product;
+			carry = ( product >> ( 8 * sizeof ( carry ) ) );
+		}
+		for ( j = size ; ( carry && ( j < ( ( 2 * size ) - i ) ) ) ;
+		      j++ ) {
+			element[j] += carry;
+			carry = ( element[j] < carry );
+		}
+		overflow += carry;
+	}
+	assert ( overflow <= 1 );
+
+	/* Discard the (now zero) low half of the product */
+	memcpy ( result, &temp->product.element[size], sizeof ( *result ) );
+
+	/* The remaining high half is less than twice the modulus, so
+	 * at most a single subtraction is required
+	 */
+	if ( overflow || bigint_is_geq ( result, modulus ) )
+		bigint_subtract ( modulus, result );
+
+	/* Sanity check */
+	assert ( bigint_is_geq ( modulus, result ) );
+
+	/* Stop profiling */
+	profile_stop ( &bigint_mont_multiply_profiler );
+}
+
 /**
  * Perform modular exponentiation of big integers
  *
@@ -129,6 +257,11 @@ void bigint_mod_multiply_raw ( const bigint_element_t *multiplicand0,
  * @v size		Number of elements in base, modulus, and result
  * @v exponent_size	Number of elements in exponent
  * @v tmp		Temporary working space
+ *
+ * Odd moduli (as used by RSA and Diffie-Hellman) are handled using
+ * Montgomery multiplication with a fixed-window exponentiation
+ * ladder; even moduli fall back to the generic (and much slower)
+ * bit-by-bit reduction.
  */
 void bigint_mod_exp_raw ( const bigint_element_t *base0,
 			  const bigint_element_t *modulus0,
@@ -148,21 +281,135 @@ void bigint_mod_exp_raw ( const bigint_element_t *base0,
 	struct {
 		bigint_t ( size ) base;
 		bigint_t ( exponent_size ) exponent;
+		bigint_t ( size ) table[ 1 << BIGINT_MOD_EXP_WINDOW ];
 		uint8_t mod_multiply[mod_multiply_len];
 	} *temp = tmp;
+	const unsigned int width = ( 8 * sizeof ( bigint_element_t ) );
+	bigint_element_t inverse;
+	unsigned int window;
+	unsigned int count;
+	unsigned int bit;
+	int rotation;
+	int i;
 	static const uint8_t start[1] = { 0x01 };
 
+	/* Copy base and exponent (which may overlap the result) */
 	memcpy ( &temp->base, base, sizeof ( temp->base ) );
 	memcpy ( &temp->exponent, exponent, sizeof ( temp->exponent ) );
-	bigint_init ( result, start, sizeof ( start ) );
 
-	while ( ! bigint_is_zero ( &temp->exponent ) ) {
-		if ( bigint_bit_is_set ( &temp->exponent, 0 ) ) {
-			bigint_mod_multiply ( result, &temp->base, modulus,
-					      result, temp->mod_multiply );
+	/* Use generic modular multiplication for even moduli */
+	if ( ! bigint_bit_is_set ( modulus, 0 ) ) {
+		bigint_init ( result, start, sizeof ( start ) );
+		while ( ! bigint_is_zero ( &temp->exponent ) ) {
+			if ( bigint_bit_is_set ( &temp->exponent, 0 ) ) {
+				bigint_mod_multiply ( result, &temp->base,
+						      modulus, result,
+						      temp->mod_multiply );
+			}
+			bigint_ror ( &temp->exponent );
+			bigint_mod_multiply ( &temp->base, &temp->base,
+					      modulus, &temp->base,
+					      temp->mod_multiply );
 		}
-		bigint_ror ( &temp->exponent );
-		bigint_mod_multiply ( &temp->base, &temp->base, modulus,
-				      &temp->base, temp->mod_multiply );
+		return;
 	}
+
+	/* Calculate Montgomery reduction constant */
+	inverse = bigint_mont_inverse ( modulus->element[0] );
+
+	/* Reduce base modulo the modulus */
+	if ( bigint_is_geq ( &temp->base, modulus ) ) {
+		memcpy ( &temp->table[0], modulus,
+			 sizeof ( temp->table[0] ) );
+		rotation = ( bigint_max_set_bit ( &temp->base ) -
+			     bigint_max_set_bit ( &temp->table[0] ) );
+		for ( i = 0 ; i < rotation ; i++ )
+			bigint_rol ( &temp->table[0] );
+		for ( i = 0 ; i <= rotation ; i++ ) {
+			if ( bigint_is_geq ( &temp->base, &temp->table[0] ) )
+				bigint_subtract ( &temp->table[0],
+						  &temp->base );
+			bigint_ror ( &temp->table[0] );
+		}
+	}
+
+	/* Convert base to Montgomery form by modular doubling */
+	for ( bit = 0 ; bit < ( size * width ) ; bit++ ) {
+		i = bigint_bit_is_set ( &temp->base,
+					( ( size * width ) - 1 ) );
+		bigint_rol ( &temp->base );
+		if ( i || bigint_is_geq ( &temp->base, modulus ) )
+			bigint_subtract ( modulus, &temp->base );
+	}
+
+	/* Calculate 2^(size*width) modulo the modulus (i.e. unity in
+	 * Montgomery form), again by modular doubling
+	 */
+	bigint_init ( &temp->table[0], start, sizeof ( start ) );
+	for ( bit = 0 ; bit < ( size * width ) ; bit++ ) {
+		i = bigint_bit_is_set ( &temp->table[0],
+					( ( size * width ) - 1 ) );
+		bigint_rol ( &temp->table[0] );
+		if ( i || bigint_is_geq ( &temp->table[0], modulus ) )
+			bigint_subtract ( modulus, &temp->table[0] );
+	}
+
+	/* Precompute table of small powers of the base */
+	memcpy ( &temp->table[1], &temp->base, sizeof ( temp->table[1] ) );
+	for ( window = 2 ; window < ( 1 << BIGINT_MOD_EXP_WINDOW ) ;
+	      window++ ) {
+		bigint_mont_multiply_raw ( temp->table[ window - 1 ].element,
+					   temp->base.element,
+					   modulus->element, inverse,
+					   temp->table[window].element,
+					   size, temp->mod_multiply );
+	}
+
+	/* Perform exponentiation, consuming the exponent from its
+	 * most significant bit downwards one window at a time
+	 */
+	memcpy ( result, &temp->table[0], sizeof ( *result ) );
+	bit = bigint_max_set_bit ( &temp->exponent );
+	bit = ( ( ( bit + BIGINT_MOD_EXP_WINDOW - 1 ) /
+		  BIGINT_MOD_EXP_WINDOW ) * BIGINT_MOD_EXP_WINDOW );
+	count = 0;
+	bigint_mod_exp_depth++;
+	while ( bit ) {
+		window = 0;
+		for ( i = 0 ; i < BIGINT_MOD_EXP_WINDOW ; i++ ) {
+			bigint_mont_multiply_raw ( result->element,
+						   result->element,
+						   modulus->element, inverse,
+						   result->element, size,
+						   temp->mod_multiply );
+			bit--;
+			window = ( ( window << 1 ) |
+				   ( !! bigint_bit_is_set ( &temp->exponent,
+							    bit ) ) );
+		}
+		if ( window ) {
+			bigint_mont_multiply_raw ( result->element,
+						   temp->table[window].element,
+						   modulus->element, inverse,
+						   result->element, size,
+						   temp->mod_multiply );
+		}
+		/* Allow other processes (e.g. console and timer
+		 * handling) to run periodically, unless this
+		 * exponentiation was itself invoked from within
+		 * another exponentiation's process step.
+		 */
+		if ( ( ( ++count % BIGINT_MOD_EXP_STEP ) == 0 ) &&
+		     ( bigint_mod_exp_depth == 1 ) ) {
+			step();
+		}
+	}
+	bigint_mod_exp_depth--;
+
+	/* Convert result out of Montgomery form */
+	bigint_init ( &temp->base, start, sizeof ( start ) );
+	bigint_mont_multiply_raw ( result->element, temp->base.element,
+				   modulus->element, inverse,
+				   result->element, size,
+				   temp->mod_multiply );
 }
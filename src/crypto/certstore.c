@@ -194,8 +194,12 @@ static unsigned int certstore_discard ( void ) {
 	return 0;
 }
 
-/** Certificate store cache discarder */
-struct cache_discarder certstore_discarder __cache_discarder ( CACHE_NORMAL ) ={
+/** Certificate store cache discarder
+ *
+ * Unreferenced cached certificates can be re-fetched or re-validated
+ * on demand, so they are cheap to discard.
+ */
+struct cache_discarder certstore_discarder __cache_discarder ( CACHE_CHEAP ) = {
 	.discard = certstore_discard,
 };
 
@@ -251,6 +255,108 @@ struct init_fn certstore_init_fn __init_fn ( INIT_LATE ) = {
 	.initialise = certstore_init,
 };
 
+/** Certificate cache setting
+ *
+ * This setting is updated only if it already exists: create it (with
+ * any value) within a non-volatile settings block to allow
+ * cross-signing certificates downloaded during validation to be
+ * reused by subsequent boots without being re-fetched.
+ */
+static struct setting cert_cache_setting __setting ( SETTING_CRYPTO,
+						     cert-cache ) = {
+	.name = "cert-cache",
+	.description = "Certificate cache",
+	.type = &setting_type_hex,
+};
+
+/**
+ * Restore cached certificates, if applicable
+ *
+ */
+static void certstore_restore ( void ) {
+	struct x509_certificate *cert;
+	struct asn1_cursor cursor;
+	void *data;
+	int len;
+	int rc;
+
+	/* Fetch cached certificates, if any */
+	len = fetch_raw_setting_copy ( NULL, &cert_cache_setting, &data );
+	if ( len < 0 )
+		return;
+
+	/* Add each certificate to the store, ignoring any malformed
+	 * remainder.  The store itself holds the only reference to
+	 * each restored certificate, so restored certificates remain
+	 * discardable under memory pressure.
+	 */
+	cursor.data = data;
+	cursor.len = len;
+	while ( cursor.len ) {
+		if ( ( rc = x509_certificate ( cursor.data, cursor.len,
+					       &cert ) ) != 0 ) {
+			DBGC ( &certstore, "CERTSTORE could not parse cached "
+			       "certificate: %s\n", strerror ( rc ) );
+			break;
+		}
+		DBGC ( &certstore, "CERTSTORE restored cached certificate "
+		       "%s\n", x509_name ( cert ) );
+		cert->flags |= X509_FL_CACHEABLE;
+		x509_put ( cert );
+		asn1_skip_any ( &cursor );
+	}
+
+	free ( data );
+}
+
+/**
+ * Persist cacheable certificates, if applicable
+ *
+ */
+void certstore_save ( void ) {
+	struct x509_certificate *cert;
+	struct settings *origin;
+	uint8_t *data;
+	size_t len = 0;
+	size_t offset = 0;
+	int rc;
+
+	/* Persist certificates only if the setting already exists, so
+	 * that consuming non-volatile option space remains an
+	 * explicit opt-in.
+	 */
+	if ( fetch_setting ( NULL, &cert_cache_setting, &origin, NULL,
+			     NULL, 0 ) < 0 )
+		return;
+
+	/* Calculate total length of cacheable certificates */
+	list_for_each_entry ( cert, &certstore.links, store.list ) {
+		if ( cert->flags & X509_FL_CACHEABLE )
+			len += cert->raw.len;
+	}
+	if ( ! len )
+		return;
+
+	/* Concatenate raw certificate data, which is self-delimiting */
+	data = malloc ( len );
+	if ( ! data )
+		return;
+	list_for_each_entry ( cert, &certstore.links, store.list ) {
+		if ( ! ( cert->flags & X509_FL_CACHEABLE ) )
+			continue;
+		memcpy ( ( data + offset ), cert->raw.data, cert->raw.len );
+		offset += cert->raw.len;
+	}
+
+	/* Store in the setting's originating settings block */
+	if ( ( rc = store_setting ( origin, &cert_cache_setting, data,
+				    len ) ) != 0 ) {
+		DBGC ( &certstore, "CERTSTORE could not persist certificates: "
+		       "%s\n", strerror ( rc ) );
+	}
+	free ( data );
+}
+
 /** Additional certificate setting */
 static struct setting cert_setting __setting ( SETTING_CRYPTO, cert ) = {
 	.name = "cert",
@@ -271,6 +377,11 @@ static int certstore_apply_settings ( void ) {
 	int len;
 	int rc;
 
+	/* Restore any cached certificates.  Certificates already
+	 * present in the store will simply be deduplicated.
+	 */
+	certstore_restore();
+
 	/* Record any existing additional certificate */
 	old_cert = cert;
 	cert = NULL;
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ChaCha20 stream cipher
+ *
+ * This algorithm is defined in RFC 8439.  It is a pure word-oriented
+ * ARX (add-rotate-xor) cipher, and therefore runs substantially
+ * faster than a table-based software AES on processors lacking
+ * dedicated AES instructions.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <ipxe/rotate.h>
+#include <ipxe/crypto.h>
+#include <ipxe/chacha20.h>
+
+/**
+ * Perform a ChaCha20 quarter-round
+ *
+ * @v x			State words
+ * @v a			Index of first state word
+ * @v b			Index of second state word
+ * @v c			Index of third state word
+ * @v d			Index of fourth state word
+ */
+#define CHACHA20_QUARTER( x, a, b, c, d ) do {				\
+		x[a] += x[b];  x[d] = rol32 ( ( x[d] ^ x[a] ), 16 );	\
+		x[c] += x[d];  x[b] = rol32 ( ( x[b] ^ x[c] ), 12 );	\
+		x[a] += x[b];  x[d] = rol32 ( ( x[d] ^ x[a] ), 8 );	\
+		x[c] += x[d];  x[b] = rol32 ( ( x[b] ^ x[c] ), 7 );	\
+	} while ( 0 )
+
+/**
+ * Generate next keystream block
+ *
+ * @v context		ChaCha20 context
+ */
+static void chacha20_next ( struct chacha20_context *context ) {
+	uint32_t x[16];
+	unsigned int i;
+
+	/* Start from the input block state */
+	memcpy ( x, context->state, sizeof ( x ) );
+
+	/* Perform ten column and diagonal double rounds */
+	for ( i = 0 ; i < 10 ; i++ ) {
+		CHACHA20_QUARTER ( x, 0, 4, 8, 12 );
+		CHACHA20_QUARTER ( x, 1, 5, 9, 13 );
+		CHACHA20_QUARTER ( x, 2, 6, 10, 14 );
+		CHACHA20_QUARTER ( x, 3, 7, 11, 15 );
+		CHACHA20_QUARTER ( x, 0, 5, 10, 15 );
+		CHACHA20_QUARTER ( x, 1, 6, 11, 12 );
+		CHACHA20_QUARTER ( x, 2, 7, 8, 13 );
+		CHACHA20_QUARTER ( x, 3, 4, 9, 14 );
+	}
+
+	/* Add input block state and serialise keystream */
+	for ( i = 0 ; i < 16 ; i++ ) {
+		context->keystream.word[i] =
+			cpu_to_le32 ( x[i] + context->state[i] );
+	}
+
+	/* Increment block counter and reset keystream offset */
+	context->state[12]++;
+	context->offset = 0;
+}
+
+/**
+ * Set key
+ *
+ * @v ctx		Context
+ * @v key		Key
+ * @v keylen		Key length
+ * @ret rc		Return status code
+ */
+static int chacha20_setkey ( void *ctx, const void *key, size_t keylen ) {
+	struct chacha20_context *context = ctx;
+	const uint32_t *keywords = key;
+	unsigned int i;
+
+	/* Sanity check */
+	if ( keylen != CHACHA20_KEY_LEN )
+		return -EINVAL;
+
+	/* Construct input block state */
+	context->state[0] = 0x61707865UL; /* "expa" */
+	context->state[1] = 0x3320646eUL; /* "nd 3" */
+	context->state[2] = 0x79622d32UL; /* "2-by" */
+	context->state[3] = 0x6b206574UL; /* "te k" */
+	for ( i = 0 ; i < 8 ; i++ )
+		context->state[ 4 + i ] = le32_to_cpu ( keywords[i] );
+	context->state[12] = 0;
+	context->state[13] = 0;
+	context->state[14] = 0;
+	context->state[15] = 0;
+
+	/* Mark current keystream block as consumed */
+	context->offset = sizeof ( context->keystream.byte );
+
+	return 0;
+}
+
+/**
+ * Set initialisation vector
+ *
+ * @v ctx		Context
+ * @v iv		Initialisation vector
+ * @v ivlen		Initialisation vector length
+ *
+ * The initialisation vector may be either a 96-bit nonce (with the
+ * block counter implicitly reset to zero), or a 32-bit little-endian
+ * initial block counter followed by a 96-bit nonce.
+ */
+static void chacha20_setiv ( void *ctx, const void *iv, size_t ivlen ) {
+	struct chacha20_context *context = ctx;
+	const uint32_t *ivwords = iv;
+	size_t counter_len = sizeof ( context->state[12] );
+	unsigned int i;
+
+	/* Record initial block counter, if specified */
+	if ( ivlen == ( counter_len + CHACHA20_NONCE_LEN ) ) {
+		context->state[12] = le32_to_cpu ( *(ivwords++) );
+	} else {
+		assert ( ivlen == CHACHA20_NONCE_LEN );
+		context->state[12] = 0;
+	}
+
+	/* Record nonce */
+	for ( i = 0 ; i < 3 ; i++ )
+		context->state[ 13 + i ] = le32_to_cpu ( ivwords[i] );
+
+	/* Mark current keystream block as consumed */
+	context->offset = sizeof ( context->keystream.byte );
+}
+
+/**
+ * Encrypt or decrypt data
+ *
+ * @v ctx		Context
+ * @v src		Input data
+ * @v dst		Output data
+ * @v len		Length of data
+ */
+static void chacha20_crypt ( void *ctx, const void *src, void *dst,
+			     size_t len ) {
+	struct chacha20_context *context = ctx;
+	const uint8_t *in = src;
+	uint8_t *out = dst;
+
+	/* XOR data with keystream */
+	while ( len-- ) {
+		if ( context->offset == sizeof ( context->keystream.byte ) )
+			chacha20_next ( context );
+		*(out++) = ( *(in++) ^
+			     context->keystream.byte[context->offset++] );
+	}
+}
+
+/** ChaCha20 cipher algorithm */
+struct cipher_algorithm chacha20_algorithm = {
+	.name		= "chacha20",
+	.ctxsize	= sizeof ( struct chacha20_context ),
+	.blocksize	= 1,
+	.setkey		= chacha20_setkey,
+	.setiv		= chacha20_setiv,
+	.encrypt	= chacha20_crypt,
+	.decrypt	= chacha20_crypt,
+};
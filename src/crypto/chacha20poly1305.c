@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ChaCha20-Poly1305 authenticated encryption
+ *
+ * This AEAD construction is defined in RFC 8439.  The Poly1305
+ * one-time key is generated from the first keystream block of each
+ * nonce, data is encrypted starting from the second keystream block,
+ * and the authentication tag covers the additional data and the
+ * ciphertext (each zero-padded to a 16-byte boundary) along with
+ * their lengths.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <ipxe/crypto.h>
+#include <ipxe/chacha20.h>
+#include <ipxe/poly1305.h>
+#include <ipxe/chacha20poly1305.h>
+
+/** Zero padding sufficient for any partial block */
+static const uint8_t chacha20poly1305_zeroes[POLY1305_BLOCK_LEN];
+
+/**
+ * Authenticate zero padding to a block boundary
+ *
+ * @v context		ChaCha20-Poly1305 context
+ * @v len		Accumulated length to be padded
+ */
+static void chacha20poly1305_pad ( struct chacha20poly1305_context *context,
+				   uint64_t len ) {
+	size_t pad_len;
+
+	pad_len = ( ( POLY1305_BLOCK_LEN - len ) & ( POLY1305_BLOCK_LEN - 1 ));
+	poly1305_update ( &context->poly, chacha20poly1305_zeroes, pad_len );
+}
+
+/**
+ * Set key
+ *
+ * @v ctx		Context
+ * @v key		Key
+ * @v keylen		Key length
+ * @ret rc		Return status code
+ */
+static int chacha20poly1305_setkey ( void *ctx, const void *key,
+				     size_t keylen ) {
+	struct chacha20poly1305_context *context = ctx;
+
+	/* Reset nonce and lengths */
+	memset ( context->fixed, 0, sizeof ( context->fixed ) );
+	context->aad_len = 0;
+	context->data_len = 0;
+
+	/* Set underlying cipher key */
+	return cipher_setkey ( &chacha20_algorithm, &context->chacha,
+			       key, keylen );
+}
+
+/**
+ * Set initialisation vector
+ *
+ * @v ctx		Context
+ * @v iv		Initialisation vector
+ * @v ivlen		Initialisation vector length
+ *
+ * A full 96-bit initialisation vector records the implicit portion of
+ * the nonce and begins a new message using that nonce directly.  A
+ * 64-bit initialisation vector (such as a TLS record sequence number)
+ * begins a new message using the recorded implicit nonce XORed with
+ * the 64-bit value in its least significant bytes, as per RFC 7905.
+ */
+static void chacha20poly1305_setiv ( void *ctx, const void *iv,
+				     size_t ivlen ) {
+	struct chacha20poly1305_context *context = ctx;
+	uint8_t nonce[CHACHA20_NONCE_LEN];
+	uint8_t key[CHACHA20_BLOCK_LEN];
+	const uint8_t *explicit = iv;
+	unsigned int i;
+
+	/* Record implicit portion of nonce, if applicable */
+	if ( ivlen == sizeof ( context->fixed ) ) {
+		memcpy ( context->fixed, iv, sizeof ( context->fixed ) );
+		explicit = chacha20poly1305_zeroes;
+		ivlen = 0;
+	}
+
+	/* Construct nonce */
+	assert ( ivlen <= sizeof ( nonce ) );
+	memcpy ( nonce, context->fixed, sizeof ( nonce ) );
+	for ( i = 0 ; i < ivlen ; i++ )
+		nonce[ sizeof ( nonce ) - ivlen + i ] ^= explicit[i];
+
+	/* Initialise cipher with block counter zero */
+	cipher_setiv ( &chacha20_algorithm, &context->chacha, nonce,
+		       sizeof ( nonce ) );
+
+	/* Generate one-time Poly1305 key from the first keystream
+	 * block, leaving the cipher positioned at block counter one.
+	 */
+	memset ( key, 0, sizeof ( key ) );
+	cipher_encrypt ( &chacha20_algorithm, &context->chacha, key, key,
+			 sizeof ( key ) );
+	poly1305_init ( &context->poly, key );
+
+	/* Reset accumulated lengths */
+	context->aad_len = 0;
+	context->data_len = 0;
+}
+
+/**
+ * Encrypt data
+ *
+ * @v ctx		Context
+ * @v src		Data to encrypt
+ * @v dst		Buffer for encrypted data, or NULL to process
+ *			additional authenticated data
+ * @v len		Length of data
+ */
+static void chacha20poly1305_encrypt ( void *ctx, const void *src, void *dst,
+				       size_t len ) {
+	struct chacha20poly1305_context *context = ctx;
+
+	/* Authenticate additional data, if applicable */
+	if ( ! dst ) {
+		assert ( context->data_len == 0 );
+		poly1305_update ( &context->poly, src, len );
+		context->aad_len += len;
+		return;
+	}
+
+	/* Pad additional data on transition to encrypted data */
+	if ( context->data_len == 0 )
+		chacha20poly1305_pad ( context, context->aad_len );
+
+	/* Encrypt data and authenticate ciphertext */
+	cipher_encrypt ( &chacha20_algorithm, &context->chacha, src, dst,
+			 len );
+	poly1305_update ( &context->poly, dst, len );
+	context->data_len += len;
+}
+
+/**
+ * Decrypt data
+ *
+ * @v ctx		Context
+ * @v src		Data to decrypt
+ * @v dst		Buffer for decrypted data, or NULL to process
+ *			additional authenticated data
+ * @v len		Length of data
+ */
+static void chacha20poly1305_decrypt ( void *ctx, const void *src, void *dst,
+				       size_t len ) {
+	struct chacha20poly1305_context *context = ctx;
+
+	/* Authenticate additional data, if applicable */
+	if ( ! dst ) {
+		assert ( context->data_len == 0 );
+		poly1305_update ( &context->poly, src, len );
+		context->aad_len += len;
+		return;
+	}
+
+	/* Pad additional data on transition to encrypted data */
+	if ( context->data_len == 0 )
+		chacha20poly1305_pad ( context, context->aad_len );
+
+	/* Authenticate ciphertext and decrypt data */
+	poly1305_update ( &context->poly, src, len );
+	cipher_decrypt ( &chacha20_algorithm, &context->chacha, src, dst,
+			 len );
+	context->data_len += len;
+}
+
+/**
+ * Generate authentication tag
+ *
+ * @v ctx		Context
+ * @v auth		Authentication tag
+ */
+static void chacha20poly1305_auth ( void *ctx, void *auth ) {
+	struct chacha20poly1305_context *context = ctx;
+	uint64_t lengths[2];
+
+	/* Pad additional data, if no data was encrypted or decrypted */
+	if ( context->data_len == 0 )
+		chacha20poly1305_pad ( context, context->aad_len );
+
+	/* Pad ciphertext and authenticate lengths */
+	chacha20poly1305_pad ( context, context->data_len );
+	lengths[0] = cpu_to_le64 ( context->aad_len );
+	lengths[1] = cpu_to_le64 ( context->data_len );
+	poly1305_update ( &context->poly, lengths, sizeof ( lengths ) );
+
+	/* Generate tag */
+	poly1305_final ( &context->poly, auth );
+}
+
+/** ChaCha20-Poly1305 cipher algorithm */
+struct cipher_algorithm chacha20poly1305_algorithm = {
+	.name		= "chacha20poly1305",
+	.ctxsize	= sizeof ( struct chacha20poly1305_context ),
+	.blocksize	= 1,
+	.authsize	= POLY1305_TAG_LEN,
+	.setkey		= chacha20poly1305_setkey,
+	.setiv		= chacha20poly1305_setiv,
+	.encrypt	= chacha20poly1305_encrypt,
+	.decrypt	= chacha20poly1305_decrypt,
+	.auth		= chacha20poly1305_auth,
+};
@@ -39,6 +39,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/x509.h>
 #include <ipxe/malloc.h>
 #include <ipxe/uaccess.h>
+#include <ipxe/image.h>
+#include <ipxe/process.h>
 #include <ipxe/cms.h>
 
 /* Disambiguate the various error causes */
@@ -527,41 +529,101 @@ int cms_signature ( const void *data, size_t len, struct cms_signature **sig ) {
 	return rc;
 }
 
+/** Number of bytes to digest between scheduler steps
+ *
+ * Digesting a multi-hundred-MB image in a single pass would block
+ * the console, timers, and network for whole seconds.  This is a
+ * policy decision.
+ */
+#define CMS_DIGEST_CHUNK_LEN 131072
+
+/** Maximum supported digest size (SHA-512) */
+#define CMS_DIGEST_CACHE_LEN 64
+
+/** A cached data digest
+ *
+ * Each signerInfo in a multi-signer chain typically uses the same
+ * digest algorithm; caching the calculated value avoids repeated
+ * full passes over the image data.
+ */
+struct cms_digest_cache {
+	/** Digest algorithm, or NULL if nothing cached yet */
+	struct digest_algorithm *digest;
+	/** Digest value */
+	uint8_t value[CMS_DIGEST_CACHE_LEN];
+};
+
 /**
  * Calculate digest of CMS-signed data
  *
  * @v sig		CMS signature
  * @v info		Signer information
- * @v data		Signed data
- * @v len		Length of signed data
+ * @v image		Signed image
+ * @v cache		Digest cache
  * @v out		Digest output
  */
 static void cms_digest ( struct cms_signature *sig,
 			 struct cms_signer_info *info,
-			 userptr_t data, size_t len, void *out ) {
+			 struct image *image,
+			 struct cms_digest_cache *cache, void *out ) {
 	struct digest_algorithm *digest = info->digest;
+	userptr_t data = image->data;
+	size_t len = image->len;
 	uint8_t ctx[ digest->ctxsize ];
 	uint8_t block[ digest->blocksize ];
 	size_t offset = 0;
+	size_t chunk_len;
 	size_t frag_len;
 
+	/* Use digest cached at download time, if applicable */
+	if ( image->digest == digest ) {
+		memcpy ( out, image->digest_value, digest->digestsize );
+		DBGC ( sig, "CMS %p/%p using cached %s digest\n",
+		       sig, info, digest->name );
+		DBGC_HDA ( sig, 0, out, digest->digestsize );
+		return;
+	}
+
+	/* Use digest calculated for a previous signer, if applicable */
+	assert ( digest->digestsize <= sizeof ( cache->value ) );
+	if ( cache->digest == digest ) {
+		memcpy ( out, cache->value, digest->digestsize );
+		DBGC ( sig, "CMS %p/%p reusing %s digest\n",
+		       sig, info, digest->name );
+		DBGC_HDA ( sig, 0, out, digest->digestsize );
+		return;
+	}
+
 	/* Initialise digest */
 	digest_init ( digest, ctx );
 
-	/* Process data one block at a time */
+	/* Process data one chunk at a time, allowing other processes
+	 * (e.g. console and timer handling) to run between chunks.
+	 */
 	while ( len ) {
-		frag_len = len;
-		if ( frag_len > sizeof ( block ) )
-			frag_len = sizeof ( block );
-		copy_from_user ( block, data, offset, frag_len );
-		digest_update ( digest, ctx, block, frag_len );
-		offset += frag_len;
-		len -= frag_len;
+		chunk_len = len;
+		if ( chunk_len > CMS_DIGEST_CHUNK_LEN )
+			chunk_len = CMS_DIGEST_CHUNK_LEN;
+		len -= chunk_len;
+		while ( chunk_len ) {
+			frag_len = chunk_len;
+			if ( frag_len > sizeof ( block ) )
+				frag_len = sizeof ( block );
+			copy_from_user ( block, data, offset, frag_len );
+			digest_update ( digest, ctx, block, frag_len );
+			offset += frag_len;
+			chunk_len -= frag_len;
+		}
+		step();
 	}
 
 	/* Finalise digest */
 	digest_final ( digest, ctx, out );
 
+	/* Record in cache for any subsequent signers */
+	cache->digest = digest;
+	memcpy ( cache->value, out, digest->digestsize );
+
 	DBGC ( sig, "CMS %p/%p digest value:\n", sig, info );
 	DBGC_HDA ( sig, 0, out, digest->digestsize );
 }
@@ -572,14 +634,15 @@ static void cms_digest ( struct cms_signature *sig,
  * @v sig		CMS signature
  * @v info		Signer information
  * @v cert		Corresponding certificate
- * @v data		Signed data
- * @v len		Length of signed data
+ * @v image		Signed image
+ * @v cache		Digest cache
  * @ret rc		Return status code
  */
 static int cms_verify_digest ( struct cms_signature *sig,
 			       struct cms_signer_info *info,
 			       struct x509_certificate *cert,
-			       userptr_t data, size_t len ) {
+			       struct image *image,
+			       struct cms_digest_cache *cache ) {
 	struct digest_algorithm *digest = info->digest;
 	struct pubkey_algorithm *pubkey = info->pubkey;
 	struct x509_public_key *public_key = &cert->subject.public_key;
@@ -588,7 +651,7 @@ static int cms_verify_digest ( struct cms_signature *sig,
 	int rc;
 
 	/* Generate digest */
-	cms_digest ( sig, info, data, len, digest_out );
+	cms_digest ( sig, info, image, cache, digest_out );
 
 	/* Initialise public-key algorithm */
 	if ( ( rc = pubkey_init ( pubkey, ctx, public_key->raw.data,
@@ -618,18 +681,19 @@ static int cms_verify_digest ( struct cms_signature *sig,
  *
  * @v sig		CMS signature
  * @v info		Signer information
- * @v data		Signed data
- * @v len		Length of signed data
+ * @v image		Signed image
  * @v time		Time at which to validate certificates
  * @v store		Certificate store, or NULL to use default
  * @v root		Root certificate list, or NULL to use default
+ * @v cache		Digest cache
  * @ret rc		Return status code
  */
 static int cms_verify_signer_info ( struct cms_signature *sig,
 				    struct cms_signer_info *info,
-				    userptr_t data, size_t len,
+				    struct image *image,
 				    time_t time, struct x509_chain *store,
-				    struct x509_root *root ) {
+				    struct x509_root *root,
+				    struct cms_digest_cache *cache ) {
 	struct x509_certificate *cert;
 	int rc;
 
@@ -660,7 +724,8 @@ static int cms_verify_signer_info ( struct cms_signature *sig,
 	}
 
 	/* Verify digest */
-	if ( ( rc = cms_verify_digest ( sig, info, cert, data, len ) ) != 0 )
+	if ( ( rc = cms_verify_digest ( sig, info, cert, image,
+					cache ) ) != 0 )
 		return rc;
 
 	return 0;
@@ -670,17 +735,17 @@ static int cms_verify_signer_info ( struct cms_signature *sig,
  * Verify CMS signature
  *
  * @v sig		CMS signature
- * @v data		Signed data
- * @v len		Length of signed data
+ * @v image		Signed image
  * @v name		Required common name, or NULL to check all signatures
  * @v time		Time at which to validate certificates
  * @v store		Certificate store, or NULL to use default
  * @v root		Root certificate list, or NULL to use default
  * @ret rc		Return status code
  */
-int cms_verify ( struct cms_signature *sig, userptr_t data, size_t len,
+int cms_verify ( struct cms_signature *sig, struct image *image,
 		 const char *name, time_t time, struct x509_chain *store,
 		 struct x509_root *root ) {
+	struct cms_digest_cache cache = { .digest = NULL };
 	struct cms_signer_info *info;
 	struct x509_certificate *cert;
 	int count = 0;
@@ -691,8 +756,9 @@ int cms_verify ( struct cms_signature *sig, userptr_t data, size_t len,
 		cert = x509_first ( info->chain );
 		if ( name && ( x509_check_name ( cert, name ) != 0 ) )
 			continue;
-		if ( ( rc = cms_verify_signer_info ( sig, info, data, len, time,
-						     store, root ) ) != 0 )
+		if ( ( rc = cms_verify_signer_info ( sig, info, image, time,
+						     store, root,
+						     &cache ) ) != 0 )
 			return rc;
 		count++;
 	}
@@ -21,10 +21,52 @@
 
 FILE_LICENCE ( GPL2_OR_LATER );
 
+#include <byteswap.h>
 #include <ipxe/crc32.h>
 
 #define CRCPOLY		0xedb88320
 
+/** CRC32 lookup tables ("slice-by-8")
+ *
+ * Table N gives the effect of pushing a byte through the CRC register
+ * followed by N further zero bytes, allowing eight input bytes to be
+ * processed in parallel.  The tables are generated on first use: they
+ * therefore live in .bss and (unlike precomputed tables) add nothing
+ * to the compressed image size.
+ */
+static u32 crc32_table[8][256];
+
+/**
+ * Generate CRC32 lookup tables
+ *
+ */
+static void crc32_generate ( void ) {
+	unsigned int i;
+	unsigned int j;
+	u32 mult;
+	u32 crc;
+
+	/* Generate byte lookup table */
+	for ( i = 0 ; i < 256 ; i++ ) {
+		crc = i;
+		for ( j = 0 ; j < 8 ; j++ ) {
+			mult = ( crc & 1 ) ? CRCPOLY : 0;
+			crc = ( crc >> 1 ) ^ mult;
+		}
+		crc32_table[0][i] = crc;
+	}
+
+	/* Extend to cover trailing zero bytes */
+	for ( i = 0 ; i < 256 ; i++ ) {
+		crc = crc32_table[0][i];
+		for ( j = 1 ; j < 8 ; j++ ) {
+			crc = ( ( crc >> 8 ) ^
+				crc32_table[0][ crc & 0xff ] );
+			crc32_table[j][i] = crc;
+		}
+	}
+}
+
 /**
  * Calculate 32-bit little-endian CRC checksum
  *
@@ -36,19 +78,45 @@ FILE_LICENCE ( GPL2_OR_LATER );
  * protocol. To continue a CRC checksum over multiple calls, pass the
  * return value from one call as the @a seed parameter to the next.
  */
-u32 crc32_le ( u32 seed, const void *data, size_t len )
+u32 generic_crc32_le ( u32 seed, const void *data, size_t len )
 {
 	u32 crc = seed;
 	const u8 *src = data;
-	u32 mult;
-	int i;
+	const u32 *word;
+	u32 next;
+
+	/* Generate lookup tables, if not already generated */
+	if ( ! crc32_table[0][1] )
+		crc32_generate();
 
+	/* Process individual bytes up to a word boundary */
+	while ( len && ( ( ( intptr_t ) src ) & ( sizeof ( *word ) - 1 ) ) ) {
+		crc = ( ( crc >> 8 ) ^
+			crc32_table[0][ ( crc ^ *src++ ) & 0xff ] );
+		len--;
+	}
+
+	/* Process eight bytes at a time */
+	word = ( ( const u32 * ) src );
+	while ( len >= ( 2 * sizeof ( *word ) ) ) {
+		crc ^= le32_to_cpu ( *word++ );
+		next = le32_to_cpu ( *word++ );
+		crc = ( crc32_table[7][ ( crc >> 0 ) & 0xff ] ^
+			crc32_table[6][ ( crc >> 8 ) & 0xff ] ^
+			crc32_table[5][ ( crc >> 16 ) & 0xff ] ^
+			crc32_table[4][ ( crc >> 24 ) & 0xff ] ^
+			crc32_table[3][ ( next >> 0 ) & 0xff ] ^
+			crc32_table[2][ ( next >> 8 ) & 0xff ] ^
+			crc32_table[1][ ( next >> 16 ) & 0xff ] ^
+			crc32_table[0][ ( next >> 24 ) & 0xff ] );
+		len -= ( 2 * sizeof ( *word ) );
+	}
+
+	/* Process remaining bytes */
+	src = ( ( const u8 * ) word );
 	while ( len-- ) {
-		crc ^= *src++;
-		for ( i = 0; i < 8; i++ ) {
-			mult = ( crc & 1 ) ? CRCPOLY : 0;
-			crc = ( crc >> 1 ) ^ mult;
-		}
+		crc = ( ( crc >> 8 ) ^
+			crc32_table[0][ ( crc ^ *src++ ) & 0xff ] );
 	}
 
 	return crc;
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksums
+ *
+ * This is the reflected CRC32C as used by (amongst others) iSCSI and
+ * SCTP.  Architectures with suitable CRC instructions provide an
+ * accelerated version via bits/crc32c.h; this is the generic
+ * fallback.
+ */
+
+#include <ipxe/crc32c.h>
+
+/** CRC32C polynomial, reflected */
+#define CRC32C_POLY 0x82f63b78
+
+/**
+ * Calculate 32-bit Castagnoli CRC checksum
+ *
+ * @v seed	Initial value
+ * @v data	Data to checksum
+ * @v len	Length of data
+ * @ret crc	Updated CRC checksum value
+ *
+ * Usually @a seed is initially all one bits, and the result is
+ * inverted before transmission.  To continue a CRC checksum over
+ * multiple calls, pass the return value from one call as the @a seed
+ * parameter to the next.
+ */
+uint32_t generic_crc32c ( uint32_t seed, const void *data, size_t len ) {
+	uint32_t crc = seed;
+	const uint8_t *src = data;
+	uint32_t mult;
+	int i;
+
+	while ( len-- ) {
+		crc ^= *src++;
+		for ( i = 0; i < 8; i++ ) {
+			mult = ( ( crc & 1 ) ? CRC32C_POLY : 0 );
+			crc = ( ( crc >> 1 ) ^ mult );
+		}
+	}
+
+	return crc;
+}
@@ -457,15 +457,31 @@ static void deflate_copy ( struct deflate_chunk *out,
 			   userptr_t start, size_t offset, size_t len ) {
 	size_t out_offset = out->offset;
 	size_t copy_len;
-
-	/* Copy data one byte at a time, to allow for overlap */
+	size_t frag_len;
+
+	/* Copy data in the largest possible non-overlapping
+	 * fragments.  A duplicated string may overlap its own source,
+	 * in which case each fragment is limited to the current
+	 * distance between source and destination.  Since the source
+	 * offset is not advanced, each completed fragment doubles
+	 * this distance: even a run-length encoding (with an initial
+	 * distance of one) therefore quickly reaches fragments large
+	 * enough for memcpy_user() to copy a word at a time.
+	 */
 	if ( out_offset < out->len ) {
 		copy_len = ( out->len - out_offset );
 		if ( copy_len > len )
 			copy_len = len;
-		while ( copy_len-- ) {
-			memcpy_user ( out->data, out_offset++,
-				      start, offset++, 1 );
+		while ( copy_len ) {
+			frag_len = copy_len;
+			if ( ( start == out->data ) &&
+			     ( frag_len > ( out_offset - offset ) ) ) {
+				frag_len = ( out_offset - offset );
+			}
+			memcpy_user ( out->data, out_offset, start, offset,
+				      frag_len );
+			out_offset += frag_len;
+			copy_len -= frag_len;
 		}
 	}
 	out->offset += len;
@@ -501,6 +517,7 @@ int deflate_inflate ( struct deflate *deflate,
 	} else switch ( deflate->format ) {
 		case DEFLATE_RAW:	goto block_header;
 		case DEFLATE_ZLIB:	goto zlib_header;
+		case DEFLATE_GZIP:	goto gzip_magic;
 		default:		assert ( 0 );
 	}
 
@@ -532,6 +549,149 @@ int deflate_inflate ( struct deflate *deflate,
 		goto block_header;
 	}
 
+ gzip_magic: {
+		int magic;
+
+		/* Extract magic */
+		magic = deflate_extract ( deflate, in, GZIP_MAGIC_BITS );
+		if ( magic < 0 ) {
+			deflate->resume = &&gzip_magic;
+			return 0;
+		}
+
+		/* Verify magic */
+		if ( magic != GZIP_MAGIC ) {
+			DBGC ( deflate, "DEFLATE %p invalid GZIP magic %#04x\n",
+			       deflate, magic );
+			return -ENOTSUP;
+		}
+	}
+
+ gzip_cm_flg: {
+		int cm_flg;
+		int cm;
+
+		/* Extract compression method and flags */
+		cm_flg = deflate_extract ( deflate, in, GZIP_CM_FLG_BITS );
+		if ( cm_flg < 0 ) {
+			deflate->resume = &&gzip_cm_flg;
+			return 0;
+		}
+
+		/* Parse compression method and flags.  The flags are
+		 * stashed in the block header storage, which is not
+		 * used until we start processing blocks.
+		 */
+		cm = ( ( cm_flg >> GZIP_CM_LSB ) & GZIP_CM_MASK );
+		deflate->header = ( cm_flg >> GZIP_FLG_LSB );
+		if ( cm != GZIP_CM_DEFLATE ) {
+			DBGC ( deflate, "DEFLATE %p unsupported GZIP "
+			       "compression method %d\n", deflate, cm );
+			return -ENOTSUP;
+		}
+		if ( deflate->header & GZIP_FLG_RESERVED ) {
+			DBGC ( deflate, "DEFLATE %p unsupported GZIP flags "
+			       "%#02x\n", deflate, deflate->header );
+			return -ENOTSUP;
+		}
+
+		/* Prepare to discard modification time, extra flags
+		 * and operating system fields.
+		 */
+		deflate->remaining = GZIP_MTIME_XFL_OS_LEN;
+	}
+
+ gzip_mtime_xfl_os: {
+
+		/* Discard modification time, extra flags and
+		 * operating system fields.
+		 */
+		while ( deflate->remaining ) {
+			if ( deflate_extract ( deflate, in, 8 ) < 0 ) {
+				deflate->resume = &&gzip_mtime_xfl_os;
+				return 0;
+			}
+			deflate->remaining--;
+		}
+
+		/* Skip extra field, if absent */
+		if ( ! ( deflate->header & GZIP_FLG_FEXTRA ) )
+			goto gzip_name;
+	}
+
+ gzip_xlen: {
+		int xlen;
+
+		/* Extract extra field length */
+		xlen = deflate_extract ( deflate, in, GZIP_XLEN_BITS );
+		if ( xlen < 0 ) {
+			deflate->resume = &&gzip_xlen;
+			return 0;
+		}
+
+		/* Prepare to discard extra field */
+		deflate->remaining = xlen;
+	}
+
+ gzip_extra: {
+
+		/* Discard extra field */
+		while ( deflate->remaining ) {
+			if ( deflate_extract ( deflate, in, 8 ) < 0 ) {
+				deflate->resume = &&gzip_extra;
+				return 0;
+			}
+			deflate->remaining--;
+		}
+	}
+
+ gzip_name: {
+		int byte;
+
+		/* Discard file name, if present */
+		if ( deflate->header & GZIP_FLG_FNAME ) {
+			do {
+				byte = deflate_extract ( deflate, in, 8 );
+				if ( byte < 0 ) {
+					deflate->resume = &&gzip_name;
+					return 0;
+				}
+			} while ( byte != 0 );
+			deflate->header &= ~GZIP_FLG_FNAME;
+		}
+	}
+
+ gzip_comment: {
+		int byte;
+
+		/* Discard file comment, if present */
+		if ( deflate->header & GZIP_FLG_FCOMMENT ) {
+			do {
+				byte = deflate_extract ( deflate, in, 8 );
+				if ( byte < 0 ) {
+					deflate->resume = &&gzip_comment;
+					return 0;
+				}
+			} while ( byte != 0 );
+			deflate->header &= ~GZIP_FLG_FCOMMENT;
+		}
+	}
+
+ gzip_fhcrc: {
+
+		/* Discard header CRC, if present */
+		if ( deflate->header & GZIP_FLG_FHCRC ) {
+			if ( deflate_extract ( deflate, in,
+					       GZIP_FHCRC_BITS ) < 0 ) {
+				deflate->resume = &&gzip_fhcrc;
+				return 0;
+			}
+		}
+
+		/* Process first block header */
+		goto block_header;
+	}
+
  block_header: {
 		int header;
 		int bfinal;
@@ -953,6 +1113,7 @@ int deflate_inflate ( struct deflate *deflate,
 		switch ( deflate->format ) {
 		case DEFLATE_RAW:	goto finished;
 		case DEFLATE_ZLIB:	goto zlib_footer;
+		case DEFLATE_GZIP:	goto gzip_footer;
 		default:		assert ( 0 );
 		}
 	}
@@ -982,6 +1143,34 @@ int deflate_inflate ( struct deflate *deflate,
 		goto finished;
 	}
 
+ gzip_footer: {
+
+		/* Discard any bits up to the next byte boundary */
+		deflate_discard_to_byte ( deflate );
+
+		/* Prepare to discard CRC32 and uncompressed size
+		 * fields.  We don't check the values, and so discard
+		 * the footer one byte at a time to avoid the nasty
+		 * corner cases involved in extracting a full 32 bits.
+		 */
+		deflate->remaining = GZIP_FOOTER_LEN;
+	}
+
+ gzip_crc32_isize: {
+
+		/* Discard CRC32 and uncompressed size fields */
+		while ( deflate->remaining ) {
+			if ( deflate_extract ( deflate, in, 8 ) < 0 ) {
+				deflate->resume = &&gzip_crc32_isize;
+				return 0;
+			}
+			deflate->remaining--;
+		}
+
+		/* Finish processing */
+		goto finished;
+	}
+
  finished: {
 		/* Mark as finished and terminate */
 		DBGCP ( deflate, "DEFLATE %p finished\n", deflate );
@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <ipxe/crypto.h>
+#include <ipxe/gcm.h>
+
+/** @file
+ *
+ * Galois/Counter Mode (GCM)
+ *
+ * The GHASH polynomial multiplication is implemented as a
+ * straightforward bitwise shift-and-add, which is the slowest but
+ * smallest approach; it could be replaced at a later date by a
+ * table-driven or carryless-multiplication instruction
+ * implementation without changing the external API.
+ *
+ * Data may be processed incrementally in fragments of arbitrary
+ * length, since both the hash input and the keystream are buffered
+ * across calls.  Additional authenticated data must be processed
+ * (by passing a NULL destination buffer) before any encrypted or
+ * decrypted data.
+ */
+
+/**
+ * Multiply accumulated hash state by hash key
+ *
+ * @v key		Hash key (H)
+ * @v value		Value to be multiplied (updated in place)
+ *
+ * The multiplication takes place in GF(2^128) modulo the GCM
+ * polynomial, with both operands (and the result) treated as
+ * big-endian bit strings.
+ */
+static void gcm_multiply ( const union gcm_block *key,
+			   union gcm_block *value ) {
+	uint64_t mult_hi = be64_to_cpu ( key->qword[0] );
+	uint64_t mult_lo = be64_to_cpu ( key->qword[1] );
+	uint64_t product_hi = 0;
+	uint64_t product_lo = 0;
+	unsigned int carry;
+	unsigned int i;
+
+	/* Perform shift-and-add multiplication, processing the
+	 * multiplier bits most significant first
+	 */
+	for ( i = 0 ; i < ( 8 * GCM_BLOCKSIZE ) ; i++ ) {
+		if ( value->byte[ i / 8 ] & ( 0x80 >> ( i % 8 ) ) ) {
+			product_hi ^= mult_hi;
+			product_lo ^= mult_lo;
+		}
+		carry = ( mult_lo & 0x1 );
+		mult_lo = ( ( mult_lo >> 1 ) | ( mult_hi << 63 ) );
+		mult_hi >>= 1;
+		if ( carry )
+			mult_hi ^= 0xe100000000000000ULL;
+	}
+
+	/* Store result */
+	value->qword[0] = cpu_to_be64 ( product_hi );
+	value->qword[1] = cpu_to_be64 ( product_lo );
+}
+
+/**
+ * Absorb data into accumulated hash state
+ *
+ * @v gcm		GCM context
+ * @v data		Data
+ * @v len		Length of data
+ */
+static void gcm_absorb ( struct gcm_context *gcm, const void *data,
+			 size_t len ) {
+	const uint8_t *byte = data;
+
+	/* Accumulate data into hash state, one block at a time */
+	while ( len-- ) {
+		gcm->state.byte[ gcm->state_offset++ ] ^= *(byte++);
+		if ( gcm->state_offset == GCM_BLOCKSIZE ) {
+			gcm_multiply ( &gcm->key, &gcm->state );
+			gcm->state_offset = 0;
+		}
+	}
+}
+
+/**
+ * Zero-pad any partial block of accumulated hash input
+ *
+ * @v gcm		GCM context
+ */
+static void gcm_absorb_pad ( struct gcm_context *gcm ) {
+
+	/* Consume any partial block (implicitly padded with zeros) */
+	if ( gcm->state_offset ) {
+		gcm_multiply ( &gcm->key, &gcm->state );
+		gcm->state_offset = 0;
+	}
+}
+
+/**
+ * Encrypt or decrypt data
+ *
+ * @v gcm		GCM context
+ * @v raw_ctx		Underlying cipher context
+ * @v src		Input data
+ * @v dst		Output data buffer, or NULL to process additional data
+ * @v len		Length of data
+ * @v raw_cipher	Underlying cipher algorithm
+ * @v decrypting	Input data is ciphertext
+ */
+static void gcm_process ( struct gcm_context *gcm, void *raw_ctx,
+			  const void *src, void *dst, size_t len,
+			  struct cipher_algorithm *raw_cipher,
+			  int decrypting ) {
+	const uint8_t *in = src;
+	uint8_t *out = dst;
+	uint8_t byte;
+
+	/* Process additional authenticated data, if applicable */
+	if ( ! dst ) {
+		assert ( gcm->data_len == 0 );
+		gcm_absorb ( gcm, src, len );
+		gcm->aad_len += len;
+		return;
+	}
+
+	/* Zero-pad additional data on transition to encrypted data */
+	if ( gcm->data_len == 0 )
+		gcm_absorb_pad ( gcm );
+
+	/* Encrypt or decrypt data, absorbing the ciphertext into the
+	 * hash state
+	 */
+	gcm->data_len += len;
+	while ( len-- ) {
+
+		/* Generate a new keystream block if needed */
+		if ( gcm->pad_offset == 0 ) {
+			gcm->counter.word[3] =
+				cpu_to_be32 ( be32_to_cpu ( gcm->counter.word[3]
+							    ) + 1 );
+			cipher_encrypt ( raw_cipher, raw_ctx, &gcm->counter,
+					 &gcm->pad, GCM_BLOCKSIZE );
+		}
+
+		/* Encrypt or decrypt one byte */
+		byte = *(in++);
+		if ( decrypting )
+			gcm_absorb ( gcm, &byte, sizeof ( byte ) );
+		byte ^= gcm->pad.byte[ gcm->pad_offset ];
+		if ( ! decrypting )
+			gcm_absorb ( gcm, &byte, sizeof ( byte ) );
+		*(out++) = byte;
+
+		/* Consume keystream byte */
+		gcm->pad_offset = ( ( gcm->pad_offset + 1 ) % GCM_BLOCKSIZE );
+	}
+}
+
+/**
+ * Set key
+ *
+ * @v gcm		GCM context
+ * @v raw_ctx		Underlying cipher context
+ * @v key		Key
+ * @v keylen		Key length
+ * @v raw_cipher	Underlying cipher algorithm
+ * @ret rc		Return status code
+ */
+int gcm_setkey ( struct gcm_context *gcm, void *raw_ctx,
+		 const void *key, size_t keylen,
+		 struct cipher_algorithm *raw_cipher ) {
+	int rc;
+
+	/* Set underlying cipher key */
+	if ( ( rc = cipher_setkey ( raw_cipher, raw_ctx, key, keylen ) ) != 0 )
+		return rc;
+
+	/* Calculate hash key (H) by encrypting an all-zeros block */
+	memset ( gcm, 0, sizeof ( *gcm ) );
+	cipher_encrypt ( raw_cipher, raw_ctx, &gcm->key, &gcm->key,
+			 sizeof ( gcm->key ) );
+
+	return 0;
+}
+
+/**
+ * Set initialisation vector
+ *
+ * @v gcm		GCM context
+ * @v raw_ctx		Underlying cipher context
+ * @v iv		Initialisation vector
+ * @v ivlen		Initialisation vector length
+ * @v raw_cipher	Underlying cipher algorithm
+ *
+ * A four-byte initialisation vector sets only the implicit portion
+ * of the nonce (as constructed via the TLS key block), and does not
+ * reset the cipher state.  An eight-byte initialisation vector is
+ * combined with the previously set implicit portion to give the full
+ * 96-bit nonce; a twelve-byte initialisation vector is used directly
+ * as the 96-bit nonce.  Other nonce lengths are not supported.
+ */
+void gcm_setiv ( struct gcm_context *gcm, void *raw_ctx __unused,
+		 const void *iv, size_t ivlen,
+		 struct cipher_algorithm *raw_cipher __unused ) {
+
+	/* Record implicit portion of nonce, if applicable */
+	if ( ivlen == sizeof ( gcm->salt ) ) {
+		memcpy ( gcm->salt, iv, sizeof ( gcm->salt ) );
+		return;
+	}
+
+	/* Construct initial counter (J0) from 96-bit nonce */
+	if ( ivlen == ( 12 - sizeof ( gcm->salt ) ) ) {
+		memcpy ( gcm->first.byte, gcm->salt, sizeof ( gcm->salt ) );
+		memcpy ( ( gcm->first.byte + sizeof ( gcm->salt ) ), iv,
+			 ivlen );
+	} else {
+		assert ( ivlen == 12 );
+		memcpy ( gcm->first.byte, iv, 12 );
+	}
+	gcm->first.word[3] = cpu_to_be32 ( 1 );
+
+	/* Reset cipher state */
+	memcpy ( &gcm->counter, &gcm->first, sizeof ( gcm->counter ) );
+	memset ( &gcm->state, 0, sizeof ( gcm->state ) );
+	gcm->pad_offset = 0;
+	gcm->state_offset = 0;
+	gcm->aad_len = 0;
+	gcm->data_len = 0;
+}
+
+/**
+ * Encrypt data
+ *
+ * @v gcm		GCM context
+ * @v raw_ctx		Underlying cipher context
+ * @v src		Data to encrypt
+ * @v dst		Buffer for encrypted data, or NULL to process
+ *			additional authenticated data
+ * @v len		Length of data
+ * @v raw_cipher	Underlying cipher algorithm
+ */
+void gcm_encrypt ( struct gcm_context *gcm, void *raw_ctx,
+		   const void *src, void *dst, size_t len,
+		   struct cipher_algorithm *raw_cipher ) {
+
+	gcm_process ( gcm, raw_ctx, src, dst, len, raw_cipher, 0 );
+}
+
+/**
+ * Decrypt data
+ *
+ * @v gcm		GCM context
+ * @v raw_ctx		Underlying cipher context
+ * @v src		Data to decrypt
+ * @v dst		Buffer for decrypted data, or NULL to process
+ *			additional authenticated data
+ * @v len		Length of data
+ * @v raw_cipher	Underlying cipher algorithm
+ */
+void gcm_decrypt ( struct gcm_context *gcm, void *raw_ctx,
+		   const void *src, void *dst, size_t len,
+		   struct cipher_algorithm *raw_cipher ) {
+
+	gcm_process ( gcm, raw_ctx, src, dst, len, raw_cipher, 1 );
+}
+
+/**
+ * Generate authentication tag
+ *
+ * @v gcm		GCM context
+ * @v raw_ctx		Underlying cipher context
+ * @v auth		Authentication tag
+ * @v raw_cipher	Underlying cipher algorithm
+ */
+void gcm_auth ( struct gcm_context *gcm, void *raw_ctx, void *auth,
+		struct cipher_algorithm *raw_cipher ) {
+	union gcm_block lengths;
+	union gcm_block tag;
+	unsigned int i;
+
+	/* Zero-pad any partial final block */
+	gcm_absorb_pad ( gcm );
+
+	/* Absorb bit lengths of additional data and ciphertext */
+	lengths.qword[0] = cpu_to_be64 ( gcm->aad_len * 8 );
+	lengths.qword[1] = cpu_to_be64 ( gcm->data_len * 8 );
+	gcm_absorb ( gcm, &lengths, sizeof ( lengths ) );
+	assert ( gcm->state_offset == 0 );
+
+	/* Encrypt initial counter and combine with hash state */
+	cipher_encrypt ( raw_cipher, raw_ctx, &gcm->first, &tag,
+			 sizeof ( tag ) );
+	for ( i = 0 ; i < GCM_BLOCKSIZE ; i++ )
+		tag.byte[i] ^= gcm->state.byte[i];
+	memcpy ( auth, &tag, sizeof ( tag ) );
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * HMAC-based key derivation function (HKDF)
+ *
+ * This algorithm is defined in RFC 5869.  It is the key derivation
+ * primitive underlying the TLS 1.3 key schedule.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/crypto.h>
+#include <ipxe/hmac.h>
+#include <ipxe/hkdf.h>
+
+/**
+ * Extract pseudorandom key
+ *
+ * @v digest		Digest algorithm to use
+ * @v salt		Salt, or NULL for no salt
+ * @v salt_len		Length of salt
+ * @v ikm		Input keying material
+ * @v ikm_len		Length of input keying material
+ * @v prk		Pseudorandom key to fill in (of digest size)
+ */
+void hkdf_extract ( struct digest_algorithm *digest, const void *salt,
+		    size_t salt_len, const void *ikm, size_t ikm_len,
+		    void *prk ) {
+	uint8_t hmac_ctx[ hmac_ctxsize ( digest ) ];
+	uint8_t ctx[ digest->ctxsize ];
+
+	/* PRK = HMAC-Hash ( salt, IKM ).  A zero-length key is
+	 * equivalent to RFC 5869's default salt of HashLen zero
+	 * bytes, since HMAC zero-pads its key in either case.
+	 */
+	hmac_precompute ( digest, hmac_ctx, salt, salt_len );
+	hmac_start ( digest, hmac_ctx, ctx );
+	hmac_update ( digest, ctx, ikm, ikm_len );
+	hmac_finish ( digest, hmac_ctx, ctx, prk );
+}
+
+/**
+ * Expand output keying material
+ *
+ * @v digest		Digest algorithm to use
+ * @v prk		Pseudorandom key
+ * @v prk_len		Length of pseudorandom key
+ * @v info		Context information, or NULL for no context
+ * @v info_len		Length of context information
+ * @v okm		Output keying material to fill in
+ * @v okm_len		Length of output keying material
+ * @ret rc		Return status code
+ */
+int hkdf_expand ( struct digest_algorithm *digest, const void *prk,
+		  size_t prk_len, const void *info, size_t info_len,
+		  void *okm, size_t okm_len ) {
+	uint8_t hmac_ctx[ hmac_ctxsize ( digest ) ];
+	uint8_t ctx[ digest->ctxsize ];
+	uint8_t tmp[ digest->digestsize ];
+	uint8_t *out = okm;
+	size_t tmp_len = 0;
+	size_t frag_len;
+	uint8_t counter = 1;
+
+	/* Sanity check on requested length (RFC 5869 section 2.3) */
+	if ( okm_len > ( 255 * digest->digestsize ) )
+		return -ERANGE;
+
+	/* Precompute HMAC key schedule for the pseudorandom key */
+	hmac_precompute ( digest, hmac_ctx, prk, prk_len );
+
+	/* T(N) = HMAC-Hash ( PRK, T(N-1) | info | N ) */
+	while ( okm_len ) {
+		hmac_start ( digest, hmac_ctx, ctx );
+		hmac_update ( digest, ctx, tmp, tmp_len );
+		hmac_update ( digest, ctx, info, info_len );
+		hmac_update ( digest, ctx, &counter, sizeof ( counter ) );
+		hmac_finish ( digest, hmac_ctx, ctx, tmp );
+		tmp_len = sizeof ( tmp );
+		frag_len = okm_len;
+		if ( frag_len > sizeof ( tmp ) )
+			frag_len = sizeof ( tmp );
+		memcpy ( out, tmp, frag_len );
+		out += frag_len;
+		okm_len -= frag_len;
+		counter++;
+	}
+
+	return 0;
+}
@@ -137,3 +137,72 @@ void hmac_final ( struct digest_algorithm *digest, void *digest_ctx,
 	digest_update ( digest, digest_ctx, hmac, digest->digestsize );
 	digest_final ( digest, digest_ctx, hmac );
 }
+
+/**
+ * Precompute HMAC key schedule
+ *
+ * @v digest		Digest algorithm to use
+ * @v hmac_ctx		HMAC key schedule context (of size hmac_ctxsize())
+ * @v key		Key
+ * @v key_len		Length of key
+ *
+ * Precomputes the inner and outer digest states resulting from
+ * hashing the padded key.  The key schedule may be reused via
+ * hmac_start() and hmac_finish() for any number of messages
+ * authenticated under the same key, avoiding the cost of rehashing
+ * the key pads for each message.
+ */
+void hmac_precompute ( struct digest_algorithm *digest, void *hmac_ctx,
+		       const void *key, size_t key_len ) {
+	void *inner = hmac_ctx;
+	void *outer = ( hmac_ctx + digest->ctxsize );
+	unsigned char k_pad[digest->blocksize];
+	uint8_t reduced[digest->digestsize];
+	unsigned int i;
+
+	/* Reduce key if necessary */
+	if ( key_len > sizeof ( k_pad ) ) {
+		digest_init ( digest, inner );
+		digest_update ( digest, inner, key, key_len );
+		digest_final ( digest, inner, reduced );
+		key = reduced;
+		key_len = sizeof ( reduced );
+	}
+
+	/* Precompute inner digest state */
+	memset ( k_pad, 0, sizeof ( k_pad ) );
+	memcpy ( k_pad, key, key_len );
+	for ( i = 0 ; i < sizeof ( k_pad ) ; i++ ) {
+		k_pad[i] ^= 0x36;
+	}
+	digest_init ( digest, inner );
+	digest_update ( digest, inner, k_pad, sizeof ( k_pad ) );
+
+	/* Precompute outer digest state */
+	for ( i = 0 ; i < sizeof ( k_pad ) ; i++ ) {
+		k_pad[i] ^= ( 0x36 ^ 0x5c );
+	}
+	digest_init ( digest, outer );
+	digest_update ( digest, outer, k_pad, sizeof ( k_pad ) );
+}
+
+/**
+ * Finalise HMAC from a precomputed key schedule
+ *
+ * @v digest		Digest algorithm to use
+ * @v hmac_ctx		HMAC key schedule context
+ * @v digest_ctx	Digest context (started via hmac_start())
+ * @v hmac		HMAC digest to fill in
+ */
+void hmac_finish ( struct digest_algorithm *digest, const void *hmac_ctx,
+		   void *digest_ctx, void *hmac ) {
+	const void *outer = ( hmac_ctx + digest->ctxsize );
+
+	/* Finish inner hash */
+	digest_final ( digest, digest_ctx, hmac );
+
+	/* Perform outer hash from precomputed state */
+	memcpy ( digest_ctx, outer, digest->ctxsize );
+	digest_update ( digest, digest_ctx, hmac, digest->digestsize );
+	digest_final ( digest, digest_ctx, hmac );
+}
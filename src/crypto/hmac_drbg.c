@@ -65,6 +65,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * @v hash		Underlying hash algorithm
  * @v state		HMAC_DRBG internal state
+ * @v hmac_ctx		HMAC key schedule for the current key
  * @v data		Provided data
  * @v len		Length of provided data
  * @v single		Single byte used in concatenation
@@ -77,6 +78,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 static void hmac_drbg_update_key ( struct digest_algorithm *hash,
 				   struct hmac_drbg_state *state,
+				   const void *hmac_ctx,
 				   const void *data, size_t len,
 				   const uint8_t single ) {
 	uint8_t context[ hash->ctxsize ];
@@ -92,13 +94,11 @@ static void hmac_drbg_update_key ( struct digest_algorithm *hash,
 	assert ( ( single == 0x00 ) || ( single == 0x01 ) );
 
 	/* K = HMAC ( K, V || single || provided_data ) */
-	hmac_init ( hash, context, state->key, &out_len );
-	assert ( out_len == hash->digestsize );
+	hmac_start ( hash, hmac_ctx, context );
 	hmac_update ( hash, context, state->value, out_len );
 	hmac_update ( hash, context, &single, sizeof ( single ) );
 	hmac_update ( hash, context, data, len );
-	hmac_final ( hash, context, state->key, &out_len, state->key );
-	assert ( out_len == hash->digestsize );
+	hmac_finish ( hash, hmac_ctx, context, state->key );
 
 	DBGC ( state, "HMAC_DRBG_%s %p K = HMAC ( K, V || %#02x || "
 	       "provided_data ) :\n", hash->name, state, single );
@@ -110,9 +110,7 @@ static void hmac_drbg_update_key ( struct digest_algorithm *hash,
  *
  * @v hash		Underlying hash algorithm
  * @v state		HMAC_DRBG internal state
- * @v data		Provided data
- * @v len		Length of provided data
- * @v single		Single byte used in concatenation
+ * @v hmac_ctx		HMAC key schedule for the current key
  *
  * This function carries out the operation
  *
@@ -121,7 +119,8 @@ static void hmac_drbg_update_key ( struct digest_algorithm *hash,
  * as used by hmac_drbg_update() and hmac_drbg_generate()
  */
 static void hmac_drbg_update_value ( struct digest_algorithm *hash,
-				     struct hmac_drbg_state *state ) {
+				     struct hmac_drbg_state *state,
+				     const void *hmac_ctx ) {
 	uint8_t context[ hash->ctxsize ];
 	size_t out_len = hash->digestsize;
 
@@ -130,11 +129,9 @@ static void hmac_drbg_update_value ( struct digest_algorithm *hash,
 	assert ( state != NULL );
 
 	/* V = HMAC ( K, V ) */
-	hmac_init ( hash, context, state->key, &out_len );
-	assert ( out_len == hash->digestsize );
+	hmac_start ( hash, hmac_ctx, context );
 	hmac_update ( hash, context, state->value, out_len );
-	hmac_final ( hash, context, state->key, &out_len, state->value );
-	assert ( out_len == hash->digestsize );
+	hmac_finish ( hash, hmac_ctx, context, state->value );
 
 	DBGC ( state, "HMAC_DRBG_%s %p V = HMAC ( K, V ) :\n",
 	       hash->name, state );
@@ -158,6 +155,7 @@ static void hmac_drbg_update_value ( struct digest_algorithm *hash,
 static void hmac_drbg_update ( struct digest_algorithm *hash,
 			       struct hmac_drbg_state *state,
 			       const void *data, size_t len ) {
+	uint8_t hmac_ctx[ hmac_ctxsize ( hash ) ];
 
 	DBGC ( state, "HMAC_DRBG_%s %p update\n", hash->name, state );
 
@@ -166,21 +164,26 @@ static void hmac_drbg_update ( struct digest_algorithm *hash,
 	assert ( state != NULL );
 	assert ( ( data != NULL ) || ( len == 0 ) );
 
+	/* Precompute key schedule for the current key */
+	hmac_precompute ( hash, hmac_ctx, state->key, hash->digestsize );
+
 	/* 1.  K = HMAC ( K, V || 0x00 || provided_data ) */
-	hmac_drbg_update_key ( hash, state, data, len, 0x00 );
+	hmac_drbg_update_key ( hash, state, hmac_ctx, data, len, 0x00 );
 
 	/* 2.  V = HMAC ( K, V ) */
-	hmac_drbg_update_value ( hash, state );
+	hmac_precompute ( hash, hmac_ctx, state->key, hash->digestsize );
+	hmac_drbg_update_value ( hash, state, hmac_ctx );
 
 	/* 3.  If ( provided_data = Null ), then return K and V */
 	if ( ! len )
 		return;
 
 	/* 4.  K = HMAC ( K, V || 0x01 || provided_data ) */
-	hmac_drbg_update_key ( hash, state, data, len, 0x01 );
+	hmac_drbg_update_key ( hash, state, hmac_ctx, data, len, 0x01 );
 
 	/* 5.  V = HMAC ( K, V ) */
-	hmac_drbg_update_value ( hash, state );
+	hmac_precompute ( hash, hmac_ctx, state->key, hash->digestsize );
+	hmac_drbg_update_value ( hash, state, hmac_ctx );
 
 	/* 6.  Return K and V */
 }
@@ -311,6 +314,7 @@ int hmac_drbg_generate ( struct digest_algorithm *hash,
 			 struct hmac_drbg_state *state,
 			 const void *additional, size_t additional_len,
 			 void *data, size_t len ) {
+	uint8_t hmac_ctx[ hmac_ctxsize ( hash ) ];
 	size_t out_len = hash->digestsize;
 	void *orig_data = data;
 	size_t orig_len = len;
@@ -339,13 +343,18 @@ int hmac_drbg_generate ( struct digest_algorithm *hash,
 	if ( additional_len )
 		hmac_drbg_update ( hash, state, additional, additional_len );
 
+	/* Precompute key schedule; the key does not change within the
+	 * generation loop.
+	 */
+	hmac_precompute ( hash, hmac_ctx, state->key, out_len );
+
 	/* 3.  temp = Null
 	 * 4.  While ( len ( temp ) < requested_number_of_bits ) do:
 	 */
 	while ( len ) {
 
 		/* 4.1  V = HMAC ( Key, V ) */
-		hmac_drbg_update_value ( hash, state );
+		hmac_drbg_update_value ( hash, state, hmac_ctx );
 
 		/* 4.2.  temp = temp || V
 		 * 5.    returned_bits = Leftmost requested_number_of_bits
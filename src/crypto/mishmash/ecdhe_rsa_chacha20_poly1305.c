@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <byteswap.h>
+#include <ipxe/rsa.h>
+#include <ipxe/chacha20poly1305.h>
+#include <ipxe/sha256.h>
+#include <ipxe/tls.h>
+
+/** TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256 cipher suite
+ *
+ * The twelve-byte implicit nonce is XORed with the record sequence
+ * number, as specified by RFC 7905; no explicit nonce appears on the
+ * wire.
+ */
+struct tls_cipher_suite
+tls_ecdhe_rsa_with_chacha20_poly1305_sha256 __tls_cipher_suite (02) = {
+	.exchange = &tls_ecdhe_exchange_algorithm,
+	.code = htons ( TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256 ),
+	.key_len = ( 256 / 8 ),
+	.fixed_iv_len = 12,
+	.record_iv_len = 0,
+	.pubkey = &rsa_algorithm,
+	.cipher = &chacha20poly1305_algorithm,
+	.digest = &sha256_algorithm,
+};
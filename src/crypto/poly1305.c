@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Poly1305 one-time message authentication code
+ *
+ * This algorithm is defined in RFC 8439.  The message is treated as a
+ * polynomial in the (clamped) key half r, evaluated modulo the prime
+ * 2^130-5, with the other key half s added to the final result.
+ *
+ * The 130-bit accumulator is represented as five 26-bit limbs.  The
+ * limbwise products within the modular multiplication are then at
+ * most 52 bits, and so the sums of partial products (including the
+ * deferred carries) fit comfortably within 64 bits.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <byteswap.h>
+#include <ipxe/poly1305.h>
+
+/** Limb mask */
+#define POLY1305_MASK 0x3ffffffUL
+
+/**
+ * Process data block
+ *
+ * @v context		Poly1305 context
+ * @v hibit		Value of bit 128 of the padded block (0 or 1)
+ */
+static void poly1305_block ( struct poly1305_context *context,
+			     uint32_t hibit ) {
+	uint32_t t[4];
+	uint32_t h0, h1, h2, h3, h4;
+	uint32_t r0, r1, r2, r3, r4;
+	uint64_t d0, d1, d2, d3, d4;
+	uint64_t c;
+	unsigned int i;
+
+	/* Split block into 26-bit limbs and add to accumulator, with
+	 * the padding bit above the highest message bit.
+	 */
+	memcpy ( t, context->block, sizeof ( t ) );
+	for ( i = 0 ; i < ( sizeof ( t ) / sizeof ( t[0] ) ) ; i++ )
+		t[i] = le32_to_cpu ( t[i] );
+	h0 = ( context->h[0] + ( t[0] & POLY1305_MASK ) );
+	h1 = ( context->h[1] +
+	       ( ( ( t[0] >> 26 ) | ( t[1] << 6 ) ) & POLY1305_MASK ) );
+	h2 = ( context->h[2] +
+	       ( ( ( t[1] >> 20 ) | ( t[2] << 12 ) ) & POLY1305_MASK ) );
+	h3 = ( context->h[3] +
+	       ( ( ( t[2] >> 14 ) | ( t[3] << 18 ) ) & POLY1305_MASK ) );
+	h4 = ( context->h[4] + ( ( t[3] >> 8 ) | ( hibit << 24 ) ) );
+
+	/* Multiply accumulator by r modulo 2^130-5, folding the limbs
+	 * above 2^130 back down via the identity 2^130 == 5.
+	 */
+	r0 = context->r[0];
+	r1 = context->r[1];
+	r2 = context->r[2];
+	r3 = context->r[3];
+	r4 = context->r[4];
+	d0 = ( ( ( uint64_t ) h0 * r0 ) + ( ( uint64_t ) h1 * ( 5 * r4 ) ) +
+	       ( ( uint64_t ) h2 * ( 5 * r3 ) ) +
+	       ( ( uint64_t ) h3 * ( 5 * r2 ) ) +
+	       ( ( uint64_t ) h4 * ( 5 * r1 ) ) );
+	d1 = ( ( ( uint64_t ) h0 * r1 ) + ( ( uint64_t ) h1 * r0 ) +
+	       ( ( uint64_t ) h2 * ( 5 * r4 ) ) +
+	       ( ( uint64_t ) h3 * ( 5 * r3 ) ) +
+	       ( ( uint64_t ) h4 * ( 5 * r2 ) ) );
+	d2 = ( ( ( uint64_t ) h0 * r2 ) + ( ( uint64_t ) h1 * r1 ) +
+	       ( ( uint64_t ) h2 * r0 ) +
+	       ( ( uint64_t ) h3 * ( 5 * r4 ) ) +
+	       ( ( uint64_t ) h4 * ( 5 * r3 ) ) );
+	d3 = ( ( ( uint64_t ) h0 * r3 ) + ( ( uint64_t ) h1 * r2 ) +
+	       ( ( uint64_t ) h2 * r1 ) + ( ( uint64_t ) h3 * r0 ) +
+	       ( ( uint64_t ) h4 * ( 5 * r4 ) ) );
+	d4 = ( ( ( uint64_t ) h0 * r4 ) + ( ( uint64_t ) h1 * r3 ) +
+	       ( ( uint64_t ) h2 * r2 ) + ( ( uint64_t ) h3 * r1 ) +
+	       ( ( uint64_t ) h4 * r0 ) );
+
+	/* Propagate carries, leaving each limb within 26 bits */
+	c = ( d0 >> 26 );  h0 = ( d0 & POLY1305_MASK );  d1 += c;
+	c = ( d1 >> 26 );  h1 = ( d1 & POLY1305_MASK );  d2 += c;
+	c = ( d2 >> 26 );  h2 = ( d2 & POLY1305_MASK );  d3 += c;
+	c = ( d3 >> 26 );  h3 = ( d3 & POLY1305_MASK );  d4 += c;
+	c = ( d4 >> 26 );  h4 = ( d4 & POLY1305_MASK );
+	h0 += ( 5 * c );
+	c = ( h0 >> 26 );  h0 &= POLY1305_MASK;
+	h1 += c;
+
+	/* Store accumulator */
+	context->h[0] = h0;
+	context->h[1] = h1;
+	context->h[2] = h2;
+	context->h[3] = h3;
+	context->h[4] = h4;
+}
+
+/**
+ * Initialise context
+ *
+ * @v context		Poly1305 context
+ * @v key		One-time key (of length POLY1305_KEY_LEN)
+ */
+void poly1305_init ( struct poly1305_context *context, const void *key ) {
+	uint32_t t[4];
+	unsigned int i;
+
+	/* Split r into 26-bit limbs, clamped as per RFC 8439 */
+	memcpy ( t, key, sizeof ( t ) );
+	for ( i = 0 ; i < ( sizeof ( t ) / sizeof ( t[0] ) ) ; i++ )
+		t[i] = le32_to_cpu ( t[i] );
+	context->r[0] = ( t[0] & 0x3ffffffUL );
+	context->r[1] = ( ( ( t[0] >> 26 ) | ( t[1] << 6 ) ) & 0x3ffff03UL );
+	context->r[2] = ( ( ( t[1] >> 20 ) | ( t[2] << 12 ) ) & 0x3ffc0ffUL );
+	context->r[3] = ( ( ( t[2] >> 14 ) | ( t[3] << 18 ) ) & 0x3f03fffUL );
+	context->r[4] = ( ( t[3] >> 8 ) & 0x00fffffUL );
+
+	/* Record s */
+	memcpy ( context->s, ( key + sizeof ( t ) ), sizeof ( context->s ) );
+	for ( i = 0 ; i < ( sizeof ( context->s ) /
+			    sizeof ( context->s[0] ) ) ; i++ ) {
+		context->s[i] = le32_to_cpu ( context->s[i] );
+	}
+
+	/* Reset accumulator */
+	memset ( context->h, 0, sizeof ( context->h ) );
+	context->offset = 0;
+}
+
+/**
+ * Accumulate data
+ *
+ * @v context		Poly1305 context
+ * @v data		Data
+ * @v len		Length of data
+ */
+void poly1305_update ( struct poly1305_context *context, const void *data,
+		       size_t len ) {
+	size_t frag_len;
+
+	/* Accumulate data a block at a time */
+	while ( len ) {
+		frag_len = ( sizeof ( context->block ) - context->offset );
+		if ( frag_len > len )
+			frag_len = len;
+		memcpy ( ( context->block + context->offset ), data,
+			 frag_len );
+		context->offset += frag_len;
+		data += frag_len;
+		len -= frag_len;
+		if ( context->offset == sizeof ( context->block ) ) {
+			poly1305_block ( context, 1 );
+			context->offset = 0;
+		}
+	}
+}
+
+/**
+ * Generate authentication tag
+ *
+ * @v context		Poly1305 context
+ * @v tag		Authentication tag (of length POLY1305_TAG_LEN)
+ */
+void poly1305_final ( struct poly1305_context *context, void *tag ) {
+	uint32_t h0, h1, h2, h3, h4;
+	uint32_t g0, g1, g2, g3, g4;
+	uint32_t mask;
+	uint32_t c;
+	uint32_t out[4];
+	uint64_t f;
+
+	/* Process any final partial block, padded with a single set
+	 * bit followed by zeroes.
+	 */
+	if ( context->offset ) {
+		context->block[context->offset] = 0x01;
+		memset ( ( context->block + context->offset + 1 ), 0,
+			 ( sizeof ( context->block ) - context->offset - 1 ) );
+		poly1305_block ( context, 0 );
+	}
+
+	/* Fully propagate carries within the accumulator */
+	h0 = context->h[0];
+	h1 = context->h[1];
+	h2 = context->h[2];
+	h3 = context->h[3];
+	h4 = context->h[4];
+	c = ( h1 >> 26 );  h1 &= POLY1305_MASK;  h2 += c;
+	c = ( h2 >> 26 );  h2 &= POLY1305_MASK;  h3 += c;
+	c = ( h3 >> 26 );  h3 &= POLY1305_MASK;  h4 += c;
+	c = ( h4 >> 26 );  h4 &= POLY1305_MASK;  h0 += ( 5 * c );
+	c = ( h0 >> 26 );  h0 &= POLY1305_MASK;  h1 += c;
+
+	/* Compute h-(2^130-5) and select it (in constant time) if it
+	 * does not borrow, to reduce the result to canonical form.
+	 */
+	g0 = ( h0 + 5 );	c = ( g0 >> 26 );  g0 &= POLY1305_MASK;
+	g1 = ( h1 + c );	c = ( g1 >> 26 );  g1 &= POLY1305_MASK;
+	g2 = ( h2 + c );	c = ( g2 >> 26 );  g2 &= POLY1305_MASK;
+	g3 = ( h3 + c );	c = ( g3 >> 26 );  g3 &= POLY1305_MASK;
+	g4 = ( h4 + c - ( 1UL << 26 ) );
+	mask = ( ( g4 >> 31 ) - 1 );
+	h0 = ( ( h0 & ~mask ) | ( g0 & mask ) );
+	h1 = ( ( h1 & ~mask ) | ( g1 & mask ) );
+	h2 = ( ( h2 & ~mask ) | ( g2 & mask ) );
+	h3 = ( ( h3 & ~mask ) | ( g3 & mask ) );
+	h4 = ( ( h4 & ~mask ) | ( g4 & mask ) );
+
+	/* Add s, discarding any carry beyond 128 bits */
+	f = ( ( uint64_t ) ( h0 | ( h1 << 26 ) ) + context->s[0] );
+	out[0] = cpu_to_le32 ( f );
+	f = ( ( uint64_t ) ( ( h1 >> 6 ) | ( h2 << 20 ) ) + context->s[1] +
+	      ( f >> 32 ) );
+	out[1] = cpu_to_le32 ( f );
+	f = ( ( uint64_t ) ( ( h2 >> 12 ) | ( h3 << 14 ) ) + context->s[2] +
+	      ( f >> 32 ) );
+	out[2] = cpu_to_le32 ( f );
+	f = ( ( uint64_t ) ( ( h3 >> 18 ) | ( h4 << 8 ) ) + context->s[3] +
+	      ( f >> 32 ) );
+	out[3] = cpu_to_le32 ( f );
+	memcpy ( tag, out, sizeof ( out ) );
+}
@@ -62,6 +62,72 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** The RBG */
 struct random_bit_generator rbg;
 
+/**
+ * Generate bits using RBG
+ *
+ * @v additional	Additional input
+ * @v additional_len	Length of additional input
+ * @v prediction_resist	Prediction resistance is required
+ * @v data		Output buffer
+ * @v len		Length of output buffer
+ * @ret rc		Return status code
+ *
+ * This is the RBG_Generate function defined in ANS X9.82 Part 4
+ * (April 2011 Draft) Section 9.1.2.2.
+ *
+ * Small requests are satisfied from a buffer of batch-generated bits,
+ * amortising the cost of the underlying HMAC chain and reseed checks
+ * across many requests (e.g. for record IVs or padding bytes).
+ */
+int rbg_generate ( const void *additional, size_t additional_len,
+		   int prediction_resist, void *data, size_t len ) {
+	uint8_t *bytes = data;
+	size_t offset;
+	size_t frag_len;
+	int rc;
+
+	/* Bypass the buffer for requests that include additional
+	 * input or require prediction resistance, since these must be
+	 * passed through to the underlying DRBG, and for requests
+	 * large enough to gain nothing from batching.
+	 */
+	if ( additional_len || prediction_resist ||
+	     ( len >= sizeof ( rbg.buffer ) ) ) {
+		return drbg_generate ( &rbg.state, additional, additional_len,
+				       prediction_resist, data, len );
+	}
+
+	/* Satisfy request from buffered bits */
+	while ( len ) {
+
+		/* Refill buffer, if empty */
+		if ( ! rbg.remaining ) {
+			if ( ( rc = drbg_generate ( &rbg.state, NULL, 0, 0,
+						    rbg.buffer,
+						    sizeof ( rbg.buffer ) ) )
+			     != 0 ) {
+				return rc;
+			}
+			rbg.remaining = sizeof ( rbg.buffer );
+		}
+
+		/* Consume buffered bits, erasing them from the buffer
+		 * to preserve the DRBG's backtracking resistance.
+		 */
+		offset = ( sizeof ( rbg.buffer ) - rbg.remaining );
+		frag_len = rbg.remaining;
+		if ( frag_len > len )
+			frag_len = len;
+		memcpy ( bytes, &rbg.buffer[offset], frag_len );
+		memset ( &rbg.buffer[offset], 0, frag_len );
+		rbg.remaining -= frag_len;
+		bytes += frag_len;
+		len -= frag_len;
+	}
+
+	return 0;
+}
+
 /**
  * Start up RBG
  *
@@ -103,6 +169,10 @@ static int rbg_startup ( void ) {
  */
 static void rbg_shutdown ( void ) {
 
+	/* Discard any buffered bits */
+	memset ( rbg.buffer, 0, sizeof ( rbg.buffer ) );
+	rbg.remaining = 0;
+
 	/* Uninstantiate DRBG */
 	drbg_uninstantiate ( &rbg.state );
 }
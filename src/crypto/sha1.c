@@ -159,6 +159,15 @@ static void sha1_digest ( struct sha1_context *context ) {
 	DBGC_HDA ( context, context->len, &context->ddd.dd.data,
 		   sizeof ( context->ddd.dd.data ) );
 
+	/* Use accelerated implementation, if supported */
+	if ( sha1_accel_supported() ) {
+		sha1_accel_digest ( &context->ddd );
+		DBGC ( context, "SHA1 digested:\n" );
+		DBGC_HDA ( context, 0, &context->ddd.dd.digest,
+			   sizeof ( context->ddd.dd.digest ) );
+		return;
+	}
+
 	/* Convert h[0..4] to host-endian, and initialise a, b, c, d,
 	 * e, and w[0..15]
 	 */
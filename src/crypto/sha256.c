@@ -55,7 +55,7 @@ struct sha256_variables {
 } __attribute__ (( packed ));
 
 /** SHA-256 constants */
-static const uint32_t k[SHA256_ROUNDS] = {
+const uint32_t sha256_k[SHA256_ROUNDS] = {
 	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
 	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
 	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
@@ -157,6 +157,15 @@ static void sha256_digest ( struct sha256_context *context ) {
 	DBGC_HDA ( context, context->len, &context->ddd.dd.data,
 		   sizeof ( context->ddd.dd.data ) );
 
+	/* Use accelerated implementation, if supported */
+	if ( sha256_accel_supported() ) {
+		sha256_accel_digest ( &context->ddd );
+		DBGC ( context, "SHA256 digested:\n" );
+		DBGC_HDA ( context, 0, &context->ddd.dd.digest,
+			   sizeof ( context->ddd.dd.digest ) );
+		return;
+	}
+
 	/* Convert h[0..7] to host-endian, and initialise a, b, c, d,
 	 * e, f, g, h, and w[0..15]
 	 */
@@ -182,7 +191,7 @@ static void sha256_digest ( struct sha256_context *context ) {
 		t2 = ( s0 + maj );
 		s1 = ( ror32 ( *e, 6 ) ^ ror32 ( *e, 11 ) ^ ror32 ( *e, 25 ) );
 		ch = ( ( *e & *f ) ^ ( (~*e) & *g ) );
-		t1 = ( *h + s1 + ch + k[i] + w[i] );
+		t1 = ( *h + s1 + ch + sha256_k[i] + w[i] );
 		*h = *g;
 		*g = *f;
 		*f = *e;
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * X25519 key exchange
+ *
+ * This implementation is based upon the paper "Curve25519: new
+ * Diffie-Hellman speed records" (djb), with the field arithmetic
+ * using a dedicated radix 2^16 representation as popularised by the
+ * public domain TweetNaCl library.  Each field element is held as
+ * sixteen 64-bit limbs of (nominally) 16 bits each, which leaves
+ * sufficient headroom for products of limbs to be accumulated without
+ * overflow and allows reduction modulo 2^255-19 to be deferred.
+ *
+ * This is dramatically faster than performing the modular
+ * exponentiation-style arithmetic via the generic big integer
+ * support, since no generic modular reduction is ever required.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <ipxe/x25519.h>
+
+/** An X25519 field element
+ *
+ * Each element of GF(2^255-19) is represented as sixteen limbs in
+ * radix 2^16, stored in little-endian order.  Limb values may
+ * temporarily exceed 16 bits (and may be negative) between carry
+ * propagations.
+ */
+typedef int64_t x25519_t[16];
+
+/** Constant (A-2)/4 = 121665 used by the Montgomery ladder */
+static const x25519_t x25519_121665 = { 0xdb41, 1 };
+
+/** Canonical base point (u=9) */
+const uint8_t x25519_base[X25519_LEN] = { 9 };
+
+/**
+ * Propagate carries between limbs
+ *
+ * @v value		Field element
+ *
+ * Bring each limb back within (approximately) 16 bits.  Carries out
+ * of the topmost limb wrap around to the lowest limb multiplied by
+ * 38, since 2^256 = 38 modulo 2^255-19.
+ */
+static void x25519_carry ( x25519_t value ) {
+	int64_t carry;
+	unsigned int i;
+
+	for ( i = 0 ; i < 16 ; i++ ) {
+		value[i] += ( 1LL << 16 );
+		carry = ( value[i] >> 16 );
+		value[ ( i + 1 ) * ( i < 15 ) ] +=
+			( carry - 1 + ( 37 * ( carry - 1 ) * ( i == 15 ) ) );
+		value[i] -= ( carry << 16 );
+	}
+}
+
+/**
+ * Swap field elements, in constant time
+ *
+ * @v first		First field element
+ * @v second		Second field element
+ * @v swap		Swap (must be 0 or 1)
+ */
+static void x25519_swap ( x25519_t first, x25519_t second, int64_t swap ) {
+	int64_t mask = ~( swap - 1 );
+	int64_t xor;
+	unsigned int i;
+
+	for ( i = 0 ; i < 16 ; i++ ) {
+		xor = ( mask & ( first[i] ^ second[i] ) );
+		first[i] ^= xor;
+		second[i] ^= xor;
+	}
+}
+
+/**
+ * Add field elements
+ *
+ * @v result		Result
+ * @v addend		Element to be added
+ * @v augend		Element to be added
+ */
+static void x25519_add ( x25519_t result, const x25519_t augend,
+			 const x25519_t addend ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < 16 ; i++ )
+		result[i] = ( augend[i] + addend[i] );
+}
+
+/**
+ * Subtract field elements
+ *
+ * @v result		Result
+ * @v minuend		Element from which to subtract
+ * @v subtrahend	Element to be subtracted
+ */
+static void x25519_subtract ( x25519_t result, const x25519_t minuend,
+			      const x25519_t subtrahend ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < 16 ; i++ )
+		result[i] = ( minuend[i] - subtrahend[i] );
+}
+
+/**
+ * Multiply field elements
+ *
+ * @v result		Result
+ * @v multiplicand	Element to be multiplied
+ * @v multiplier	Element to be multiplied
+ */
+static void x25519_multiply ( x25519_t result, const x25519_t multiplicand,
+			      const x25519_t multiplier ) {
+	int64_t product[31];
+	unsigned int i;
+	unsigned int j;
+
+	/* Calculate 31-limb product via schoolbook multiplication */
+	memset ( product, 0, sizeof ( product ) );
+	for ( i = 0 ; i < 16 ; i++ ) {
+		for ( j = 0 ; j < 16 ; j++ )
+			product[ i + j ] += ( multiplicand[i] * multiplier[j] );
+	}
+
+	/* Fold down the upper limbs, using 2^256 = 38 mod 2^255-19 */
+	for ( i = 0 ; i < 15 ; i++ )
+		product[i] += ( 38 * product[ i + 16 ] );
+	for ( i = 0 ; i < 16 ; i++ )
+		result[i] = product[i];
+	x25519_carry ( result );
+	x25519_carry ( result );
+}
+
+/**
+ * Square field element
+ *
+ * @v result		Result
+ * @v value		Element to be squared
+ */
+static void x25519_square ( x25519_t result, const x25519_t value ) {
+	x25519_multiply ( result, value, value );
+}
+
+/**
+ * Invert field element
+ *
+ * @v result		Result
+ * @v value		Element to be inverted
+ *
+ * The inverse is calculated (per Fermat's little theorem) by raising
+ * to the power p-2 = 2^255-21, which has all bits set apart from bits
+ * 2 and 4.
+ */
+static void x25519_invert ( x25519_t result, const x25519_t value ) {
+	x25519_t running;
+	int i;
+
+	memcpy ( running, value, sizeof ( running ) );
+	for ( i = 253 ; i >= 0 ; i-- ) {
+		x25519_square ( running, running );
+		if ( ( i != 2 ) && ( i != 4 ) )
+			x25519_multiply ( running, running, value );
+	}
+	memcpy ( result, running, sizeof ( x25519_t ) );
+}
+
+/**
+ * Unpack field element
+ *
+ * @v value		Field element to fill in
+ * @v data		Canonical little-endian encoding
+ *
+ * The topmost bit of the encoding is ignored, as specified by RFC
+ * 7748.
+ */
+static void x25519_unpack ( x25519_t value, const uint8_t *data ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < 16 ; i++ ) {
+		value[i] = ( data[ 2 * i ] |
+			     ( ( ( int64_t ) data[ 2 * i + 1 ] ) << 8 ) );
+	}
+	value[15] &= 0x7fff;
+}
+
+/**
+ * Pack field element
+ *
+ * @v data		Canonical little-endian encoding to fill in
+ * @v value		Field element
+ *
+ * The value is fully reduced modulo 2^255-19 (via two constant-time
+ * conditional subtractions of the modulus) before encoding.
+ */
+static void x25519_pack ( uint8_t *data, const x25519_t value ) {
+	x25519_t reduced;
+	x25519_t minus;
+	int64_t borrow;
+	unsigned int i;
+	unsigned int j;
+
+	memcpy ( reduced, value, sizeof ( reduced ) );
+	x25519_carry ( reduced );
+	x25519_carry ( reduced );
+	x25519_carry ( reduced );
+	for ( j = 0 ; j < 2 ; j++ ) {
+		minus[0] = ( reduced[0] - 0xffed );
+		for ( i = 1 ; i < 15 ; i++ ) {
+			minus[i] = ( reduced[i] - 0xffff -
+				     ( ( minus[ i - 1 ] >> 16 ) & 1 ) );
+			minus[ i - 1 ] &= 0xffff;
+		}
+		minus[15] = ( reduced[15] - 0x7fff -
+			      ( ( minus[14] >> 16 ) & 1 ) );
+		borrow = ( ( minus[15] >> 16 ) & 1 );
+		minus[14] &= 0xffff;
+		x25519_swap ( reduced, minus, ( 1 - borrow ) );
+	}
+	for ( i = 0 ; i < 16 ; i++ ) {
+		data[ 2 * i ] = ( reduced[i] & 0xff );
+		data[ 2 * i + 1 ] = ( reduced[i] >> 8 );
+	}
+}
+
+/**
+ * Calculate X25519 key exchange function
+ *
+ * @v scalar		Private scalar (32 bytes)
+ * @v point		Public point u-coordinate (32 bytes)
+ * @v result		Result point u-coordinate (32 bytes) to fill in
+ * @ret rc		Return status code
+ *
+ * The scalar is clamped as specified by RFC 7748 before use, and so
+ * may be any 32 bytes of random data.  An error is returned if the
+ * result is the all-zero value (i.e. if the peer's public point was
+ * of small order), as required by RFC 7748 section 6.1.
+ */
+int x25519 ( const void *scalar, const void *point, void *result ) {
+	uint8_t clamped[X25519_LEN];
+	uint8_t *out = result;
+	x25519_t u;
+	x25519_t a;
+	x25519_t b;
+	x25519_t c;
+	x25519_t d;
+	x25519_t e;
+	x25519_t f;
+	uint8_t nonzero;
+	int64_t bit;
+	unsigned int i;
+	int j;
+
+	/* Clamp scalar as specified by RFC 7748 */
+	memcpy ( clamped, scalar, sizeof ( clamped ) );
+	clamped[0] &= 0xf8;
+	clamped[31] = ( ( clamped[31] & 0x7f ) | 0x40 );
+
+	/* Initialise Montgomery ladder */
+	x25519_unpack ( u, point );
+	memset ( a, 0, sizeof ( a ) );
+	memcpy ( b, u, sizeof ( b ) );
+	memset ( c, 0, sizeof ( c ) );
+	memset ( d, 0, sizeof ( d ) );
+	a[0] = 1;
+	d[0] = 1;
+
+	/* Perform constant-time Montgomery ladder over scalar bits */
+	for ( j = 254 ; j >= 0 ; j-- ) {
+		bit = ( ( clamped[ j >> 3 ] >> ( j & 7 ) ) & 1 );
+		x25519_swap ( a, b, bit );
+		x25519_swap ( c, d, bit );
+		x25519_add ( e, a, c );
+		x25519_subtract ( a, a, c );
+		x25519_add ( c, b, d );
+		x25519_subtract ( b, b, d );
+		x25519_square ( d, e );
+		x25519_square ( f, a );
+		x25519_multiply ( a, c, a );
+		x25519_multiply ( c, b, e );
+		x25519_add ( e, a, c );
+		x25519_subtract ( a, a, c );
+		x25519_square ( b, a );
+		x25519_subtract ( c, d, f );
+		x25519_multiply ( a, c, x25519_121665 );
+		x25519_add ( a, a, d );
+		x25519_multiply ( c, c, a );
+		x25519_multiply ( a, d, f );
+		x25519_multiply ( d, b, u );
+		x25519_square ( b, e );
+		x25519_swap ( a, b, bit );
+		x25519_swap ( c, d, bit );
+	}
+
+	/* Convert back from projective coordinates */
+	x25519_invert ( c, c );
+	x25519_multiply ( a, a, c );
+	x25519_pack ( out, a );
+
+	/* Fail if result is the all-zero value */
+	nonzero = 0;
+	for ( i = 0 ; i < X25519_LEN ; i++ )
+		nonzero |= out[i];
+	if ( ! nonzero )
+		return -EPERM;
+
+	return 0;
+}
@@ -995,8 +995,13 @@ int x509_parse ( struct x509_certificate *cert,
 	int rc;
 
 	/* Record raw certificate */
-	memcpy ( &cursor, raw, sizeof ( cursor ) );
-	memcpy ( &cert->raw, &cursor, sizeof ( cert->raw ) );
+	memcpy ( &cert->raw, raw, sizeof ( cert->raw ) );
+
+	/* Parse certificate from the recorded cursor; all parsed
+	 * fields are non-owning cursors into this same underlying
+	 * buffer.
+	 */
+	memcpy ( &cursor, &cert->raw, sizeof ( cursor ) );
 
 	/* Enter certificate */
 	asn1_enter ( &cursor, ASN1_SEQUENCE );
@@ -1307,8 +1312,8 @@ int x509_check_time ( struct x509_certificate *cert, time_t time ) {
  * The issuing certificate must have already been validated.
  *
  * Validation results are cached: if a certificate has already been
- * successfully validated then @c issuer, @c time, and @c root will be
- * ignored.
+ * successfully validated and is still within its validity period at
+ * @c time then @c issuer and @c root will be ignored.
  */
 int x509_validate ( struct x509_certificate *cert,
 		    struct x509_certificate *issuer,
@@ -1320,9 +1325,19 @@ int x509_validate ( struct x509_certificate *cert,
 	if ( ! root )
 		root = &root_certificates;
 
-	/* Return success if certificate has already been validated */
-	if ( x509_is_valid ( cert ) )
-		return 0;
+	/* Return success if certificate has already been validated
+	 * and is still within its validity period.  Stored
+	 * certificates persist indefinitely (and the stored
+	 * certificate is the cache), so an expired cached result must
+	 * be discarded rather than trusted forever.
+	 */
+	if ( x509_is_valid ( cert ) ) {
+		if ( x509_check_time ( cert, time ) == 0 )
+			return 0;
+		DBGC ( cert, "X509 %p \"%s\" cached validation expired\n",
+		       cert, x509_name ( cert ) );
+		x509_invalidate ( cert );
+	}
 
 	/* Fail if certificate is invalid at specified time */
 	if ( ( rc = x509_check_time ( cert, time ) ) != 0 )
@@ -1363,7 +1378,7 @@ int x509_validate ( struct x509_certificate *cert,
 	}
 
 	/* Fail if OCSP is required */
-	if ( ocsp_required ( cert ) ) {
+	if ( ocsp_required ( cert, time ) ) {
 		DBGC ( cert, "X509 %p \"%s\" requires an OCSP check\n",
 		       cert, x509_name ( cert ) );
 		return -EACCES_OCSP_REQUIRED;
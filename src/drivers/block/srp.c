@@ -112,6 +112,13 @@ struct srp_device {
 	uint32_t memory_handle;
 	/** Login completed successfully */
 	int logged_in;
+	/** Request limit (number of IUs we may currently send)
+	 *
+	 * Initialised by the REQUEST LIMIT DELTA in the login
+	 * response, and subsequently adjusted by the delta in each
+	 * response IU.
+	 */
+	int credits;
 
 	/** List of active commands */
 	struct list_head commands;
@@ -346,9 +353,17 @@ static int srp_login_rsp ( struct srp_device *srpdev,
 	       srpdev, ntohl ( login_rsp->tag.dwords[1] ) );
 	DBGC_HDA ( srpdev, 0, data, len );
 
+	/* Record initial request limit */
+	srpdev->credits = ntohl ( login_rsp->request_limit_delta );
+	if ( srpdev->credits <= 0 ) {
+		DBGC ( srpdev, "SRP %p zero request limit\n", srpdev );
+		return -EPROTO;
+	}
+
 	/* Mark as logged in */
 	srpdev->logged_in = 1;
-	DBGC ( srpdev, "SRP %p logged in\n", srpdev );
+	DBGC ( srpdev, "SRP %p logged in with %d credits\n",
+	       srpdev, srpdev->credits );
 
 	/* Notify of window change */
 	xfer_window_changed ( &srpdev->scsi );
@@ -409,6 +424,13 @@ static int srp_cmd ( struct srp_device *srpdev,
 		return -EBUSY;
 	}
 
+	/* Check request limit */
+	if ( srpdev->credits <= 0 ) {
+		DBGC ( srpdev, "SRP %p tag %08x out of credits\n",
+		       srpdev, tag );
+		return -EBUSY;
+	}
+
 	/* Allocate I/O buffer */
 	iobuf = xfer_alloc_iob ( &srpdev->socket, SRP_MAX_I_T_IU_LEN );
 	if ( ! iobuf )
@@ -453,6 +475,9 @@ static int srp_cmd ( struct srp_device *srpdev,
 		return rc;
 	}
 
+	/* Consume request limit credit */
+	srpdev->credits--;
+
 	return 0;
 }
 
@@ -493,6 +518,9 @@ static int srp_rsp ( struct srp_device *srpdev,
 		( ( rsp->valid & SRP_RSP_VALID_SNSVALID ) ? " sns" : "" ),
 		( ( rsp->valid & SRP_RSP_VALID_RSPVALID ) ? " rsp" : "" ) );
 
+	/* Apply request limit delta */
+	srpdev->credits += ( ( int32_t ) ntohl ( rsp->request_limit_delta ) );
+
 	/* Identify command by tag */
 	srpcmd = srp_find_tag ( srpdev, ntohl ( rsp->tag.dwords[1] ) );
 	if ( ! srpcmd ) {
@@ -530,6 +558,11 @@ static int srp_rsp ( struct srp_device *srpdev,
 	/* Drop temporary command reference */
 	srpcmd_put ( srpcmd );
 
+	/* Notify of window change; replenished credits may allow
+	 * queued commands to be issued.
+	 */
+	xfer_window_changed ( &srpdev->scsi );
+
 	return 0;
 }
 
@@ -674,7 +707,8 @@ static int srpdev_deliver ( struct srp_device *srpdev,
  * @ret len		Length of window
  */
 static size_t srpdev_window ( struct srp_device *srpdev ) {
-	return ( srpdev->logged_in ? ~( ( size_t ) 0 ) : 0 );
+	return ( ( srpdev->logged_in && ( srpdev->credits > 0 ) ) ?
+		 ~( ( size_t ) 0 ) : 0 );
 }
 
 /** SRP device socket interface operations */
@@ -126,12 +126,24 @@ void vring_kick(struct virtio_pci_modern_device *vdev, unsigned int ioaddr,
                 struct vring_virtqueue *vq, int num_added)
 {
    struct vring *vr = &vq->vring;
+   u16 old, new;
+   int notify;
 
    wmb();
-   vr->avail->idx += num_added;
+   old = vr->avail->idx;
+   new = (u16)(old + num_added);
+   vr->avail->idx = new;
 
    mb();
-   if (!(vr->used->flags & VRING_USED_F_NO_NOTIFY)) {
+   if (vq->event_idx) {
+           /* Notify only if the device has not yet seen an avail
+            * index beyond its published event index.
+            */
+           notify = vring_need_event(vring_avail_event(vr), new, old);
+   } else {
+           notify = !(vr->used->flags & VRING_USED_F_NO_NOTIFY);
+   }
+   if (notify) {
            if (vdev) {
                    /* virtio 1.0 */
                    vpm_notify(vdev, vq);
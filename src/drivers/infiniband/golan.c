@@ -1818,6 +1818,7 @@ static void golan_poll_cq(struct ib_device *ibdev,
 	unsigned int		i;
 	int			rc = 0;
 	unsigned int		cqe_idx_mask;
+	unsigned long		first_idx = cq->next_idx;
 	struct golan_cqe64	*cqe64;
 	struct golan_completion_queue *golan_cq = ib_cq_get_drvdata(cq);
 	struct golan		*golan	= ib_get_drvdata(ibdev);
@@ -1846,10 +1847,11 @@ static void golan_poll_cq(struct ib_device *ibdev,
 
 		/* Update completion queue's index */
 		cq->next_idx++;
+	}
 
-		/* Update doorbell record */
+	/* Update doorbell record to cover all consumed entries */
+	if (cq->next_idx != first_idx)
 		*(golan_cq->doorbell_record) = cpu_to_be32(cq->next_idx & 0xffffff);
-	}
 }
 
 static const char *golan_eqe_type_str(u8 type)
@@ -2058,9 +2060,12 @@ static void golan_poll_eq(struct ib_device *ibdev)
 		}
 
 		++eq->cons_index;
-		golan_eq_update_ci(eq, GOLAN_EQ_UNARMED);
 		++counter;
 	}
+
+	/* Update consumer index once to cover all consumed events */
+	if (counter)
+		golan_eq_update_ci(eq, GOLAN_EQ_UNARMED);
 }
 
 /**
@@ -1825,6 +1825,7 @@ static void hermon_poll_cq ( struct ib_device *ibdev,
 	struct hermon *hermon = ib_get_drvdata ( ibdev );
 	struct hermon_completion_queue *hermon_cq = ib_cq_get_drvdata ( cq );
 	union hermonprm_completion_entry *cqe;
+	unsigned long first_idx = cq->next_idx;
 	unsigned int cqe_idx_mask;
 	int rc;
 
@@ -1848,8 +1849,10 @@ static void hermon_poll_cq ( struct ib_device *ibdev,
 
 		/* Update completion queue's index */
 		cq->next_idx++;
+	}
 
-		/* Update doorbell record */
+	/* Update doorbell record to cover all consumed entries */
+	if ( cq->next_idx != first_idx ) {
 		MLX_FILL_1 ( hermon_cq->doorbell, 0, update_ci,
 			     ( cq->next_idx & 0x00ffffffUL ) );
 	}
@@ -2029,6 +2032,7 @@ static void hermon_poll_eq ( struct ib_device *ibdev ) {
 	struct hermon_event_queue *hermon_eq = &hermon->eq;
 	union hermonprm_event_entry *eqe;
 	union hermonprm_doorbell_register db_reg;
+	unsigned long first_idx = hermon_eq->next_idx;
 	unsigned int eqe_idx_mask;
 	unsigned int event_type;
 
@@ -2072,8 +2076,10 @@ static void hermon_poll_eq ( struct ib_device *ibdev ) {
 
 		/* Update event queue's index */
 		hermon_eq->next_idx++;
+	}
 
-		/* Ring doorbell */
+	/* Ring doorbell once to cover all consumed events */
+	if ( hermon_eq->next_idx != first_idx ) {
 		MLX_FILL_1 ( &db_reg.event, 0,
 			     ci, ( hermon_eq->next_idx & 0x00ffffffUL ) );
 		writel ( db_reg.dword[0], hermon_eq->doorbell );
@@ -62,14 +62,17 @@ static struct profiler axge_out_profiler __profiler =
  *
  * Experimentation shows that setting the "timer" value to zero seems
  * to prevent the device from ever coalescing multiple packets into a
- * single bulk IN transfer.  This allows us to get away with using a
- * 2kB receive I/O buffer and a zerocopy receive path.
+ * single bulk IN transfer, while a non-zero value allows coalescing
+ * up to approximately "size" kilobytes per transfer.  Coalescing
+ * substantially reduces the per-transfer overhead at high packet
+ * rates, at the cost of requiring larger receive I/O buffers and a
+ * copying receive path for all but the last packet in each aggregate.
  */
 static struct axge_bulk_in_control axge_bicr = {
 	.ctrl = 7,
-	.timer = cpu_to_le16 ( 0 ),
-	.size = 0,
-	.ifg = 0,
+	.timer = cpu_to_le16 ( 0x004f ),
+	.size = ( ( AXGE_IN_MTU - AXGE_IN_SLACK ) / 1024 ),
+	.ifg = 0xff,
 };
 
 /******************************************************************************
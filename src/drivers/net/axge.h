@@ -154,15 +154,30 @@ struct axge_device {
 
 /** Bulk IN maximum fill level
  *
+ * Must be deep enough to keep the device streaming between polls:
+ * shallower fill levels leave a USB 3.0 link idle and cap throughput
+ * well below wire speed.  With multi-packet aggregates each buffer
+ * covers several received packets, so the pipeline need not be as
+ * deep (in buffers) as it would be for single-packet transfers.
  * This is a policy decision.
  */
 #define AXGE_IN_MAX_FILL 8
 
 /** Bulk IN buffer size
  *
- * This is a policy decision.
+ * Must be large enough to hold a maximal coalesced aggregate,
+ * including its per-packet padding, descriptors and footer.  This is
+ * a policy decision.
+ */
+#define AXGE_IN_MTU 8192
+
+/** Bulk IN buffer slack space
+ *
+ * Space within each bulk IN buffer reserved (when configuring the
+ * device's aggregation limit) for per-packet padding, descriptors
+ * and the footer of a maximal coalesced aggregate.
  */
-#define AXGE_IN_MTU 2048
+#define AXGE_IN_SLACK 1024
 
 /** Amount of space to reserve at start of bulk IN buffers
  *
@@ -34,6 +34,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/iobuf.h>
 #include <ipxe/malloc.h>
 #include <ipxe/pci.h>
+#include <ipxe/drvprof.h>
 #include "ena.h"
 
 /** @file
@@ -42,6 +43,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Latency profiler */
+DRIVER_PROFILER ( ena_drvprof, "ena" );
+
 /**
  * Get direction name (for debugging)
  *
@@ -335,6 +339,7 @@ static int ena_create_sq ( struct ena_nic *ena, struct ena_sq *sq,
 			   struct ena_cq *cq ) {
 	union ena_aq_req *req;
 	union ena_acq_rsp *rsp;
+	unsigned int policy;
 	int rc;
 
 	/* Allocate submission queue entries */
@@ -345,33 +350,50 @@ static int ena_create_sq ( struct ena_nic *ena, struct ena_sq *sq,
 	}
 	memset ( sq->sqe.raw, 0, sq->len );
 
+	/* Use a low-latency (device memory) transmit queue if the
+	 * device exposes LLQ memory, falling back to a host memory
+	 * queue if the device declines.
+	 */
+	policy = ( ( ( sq->direction == ENA_SQ_TX ) && ena->mem ) ?
+		   ENA_SQ_DEVICE_MEMORY : ENA_SQ_HOST_MEMORY );
+ retry:
 	/* Construct request */
 	req = ena_admin_req ( ena );
 	req->header.opcode = ENA_CREATE_SQ;
 	req->create_sq.direction = sq->direction;
-	req->create_sq.policy = cpu_to_le16 ( ENA_SQ_HOST_MEMORY |
-					      ENA_SQ_CONTIGUOUS );
+	req->create_sq.policy = cpu_to_le16 ( policy | ENA_SQ_CONTIGUOUS );
 	req->create_sq.cq_id = cpu_to_le16 ( cq->id );
 	req->create_sq.count = cpu_to_le16 ( sq->count );
 	req->create_sq.address = cpu_to_le64 ( virt_to_bus ( sq->sqe.raw ) );
 
 	/* Issue request */
-	if ( ( rc = ena_admin ( ena, req, &rsp ) ) != 0 )
+	if ( ( rc = ena_admin ( ena, req, &rsp ) ) != 0 ) {
+		if ( policy == ENA_SQ_DEVICE_MEMORY ) {
+			DBGC ( ena, "ENA %p %s SQ LLQ declined; using host "
+			       "memory\n", ena,
+			       ena_direction ( sq->direction ) );
+			policy = ENA_SQ_HOST_MEMORY;
+			goto retry;
+		}
 		goto err_admin;
+	}
 
 	/* Parse response */
 	sq->id = le16_to_cpu ( rsp->create_sq.id );
 	sq->doorbell = le32_to_cpu ( rsp->create_sq.doorbell );
+	sq->llq = ( ( policy == ENA_SQ_DEVICE_MEMORY ) ?
+		    ( ena->mem + le32_to_cpu ( rsp->create_sq.llq_desc ) ) :
+		    NULL );
 
 	/* Reset producer counter and phase */
 	sq->prod = 0;
 	sq->phase = ENA_SQE_PHASE;
 
-	DBGC ( ena, "ENA %p %s SQ%d at [%08lx,%08lx) db +%04x CQ%d\n",
+	DBGC ( ena, "ENA %p %s SQ%d at [%08lx,%08lx)%s db +%04x CQ%d\n",
 	       ena, ena_direction ( sq->direction ), sq->id,
 	       virt_to_phys ( sq->sqe.raw ),
 	       ( virt_to_phys ( sq->sqe.raw ) + sq->len ),
-	       sq->doorbell, cq->id );
+	       ( sq->llq ? " LLQ" : "" ), sq->doorbell, cq->id );
 	return 0;
 
  err_admin:
@@ -777,6 +799,16 @@ static int ena_transmit ( struct net_device *netdev, struct io_buffer *iobuf ) {
 		       ena->tx.sq.phase );
 	wmb();
 
+	/* Push descriptor directly to device memory, if using LLQ.
+	 * The subsequent doorbell write flushes any write-combining
+	 * buffers.
+	 */
+	if ( ena->tx.sq.llq ) {
+		memcpy ( ( ena->tx.sq.llq + ( index * sizeof ( *sqe ) ) ),
+			 sqe, sizeof ( *sqe ) );
+		wmb();
+	}
+
 	/* Increment producer counter */
 	ena->tx.sq.prod++;
 	if ( ( ena->tx.sq.prod % ENA_TX_COUNT ) == 0 )
@@ -788,6 +820,7 @@ static int ena_transmit ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	DBGC2 ( ena, "ENA %p TX %d at [%08llx,%08llx)\n", ena, sqe->id,
 		( ( unsigned long long ) address ),
 		( ( unsigned long long ) address + len ) );
+	drvprof_tx ( &ena_drvprof );
 	return 0;
 }
 
@@ -820,6 +853,7 @@ static void ena_poll_tx ( struct net_device *netdev ) {
 			ena->tx.cq.phase ^= ENA_CQE_PHASE;
 
 		/* Complete transmit */
+		drvprof_tx_complete ( &ena_drvprof );
 		netdev_tx_complete_next ( netdev );
 	}
 }
@@ -862,6 +896,7 @@ static void ena_poll_rx ( struct net_device *netdev ) {
 		DBGC2 ( ena, "ENA %p RX %d complete (length %zd)\n",
 			ena, le16_to_cpu ( cqe->id ), len );
 		netdev_rx ( netdev, iobuf );
+		drvprof_rx ( &ena_drvprof );
 	}
 }
 
@@ -872,6 +907,9 @@ static void ena_poll_rx ( struct net_device *netdev ) {
  */
 static void ena_poll ( struct net_device *netdev ) {
 
+	/* Record poll entry */
+	drvprof_poll ( &ena_drvprof );
+
 	/* Poll for transmit completions */
 	ena_poll_tx ( netdev );
 
@@ -906,6 +944,7 @@ static struct net_device_operations ena_operations = {
 static int ena_probe ( struct pci_device *pci ) {
 	struct net_device *netdev;
 	struct ena_nic *ena;
+	unsigned long membase;
 	int rc;
 
 	/* Allocate and initialise net device */
@@ -939,6 +978,13 @@ static int ena_probe ( struct pci_device *pci ) {
 		goto err_ioremap;
 	}
 
+	/* Map low-latency queue memory BAR, if present.  Absence is
+	 * harmless: submission queues will use host memory.
+	 */
+	membase = pci_bar_start ( pci, PCI_BASE_ADDRESS_2 );
+	if ( membase )
+		ena->mem = ioremap ( membase, ENA_LLQ_BAR_SIZE );
+
 	/* Reset the NIC */
 	if ( ( rc = ena_reset ( ena ) ) != 0 )
 		goto err_reset;
@@ -969,6 +1015,8 @@ static int ena_probe ( struct pci_device *pci ) {
  err_create_admin:
 	ena_reset ( ena );
  err_reset:
+	if ( ena->mem )
+		iounmap ( ena->mem );
 	iounmap ( ena->regs );
  err_ioremap:
 	netdev_nullify ( netdev );
@@ -996,6 +1044,8 @@ static void ena_remove ( struct pci_device *pci ) {
 	ena_reset ( ena );
 
 	/* Free network device */
+	if ( ena->mem )
+		iounmap ( ena->mem );
 	iounmap ( ena->regs );
 	netdev_nullify ( netdev );
 	netdev_put ( netdev );
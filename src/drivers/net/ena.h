@@ -15,6 +15,13 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** BAR size */
 #define ENA_BAR_SIZE 16384
 
+/** LLQ memory BAR size
+ *
+ * This is a policy decision: we map only enough device memory to push
+ * descriptors for our (small) transmit queue.
+ */
+#define ENA_LLQ_BAR_SIZE 16384
+
 /** Queue alignment */
 #define ENA_ALIGN 4096
 
@@ -24,11 +31,21 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Number of admin completion queue entries */
 #define ENA_ACQ_COUNT 2
 
-/** Number of transmit queue entries */
-#define ENA_TX_COUNT 16
+/** Number of transmit queue entries
+ *
+ * May be overridden at build time.
+ */
+#ifndef ENA_TX_COUNT
+#define ENA_TX_COUNT 32
+#endif
 
-/** Number of receive queue entries */
-#define ENA_RX_COUNT 16
+/** Number of receive queue entries
+ *
+ * May be overridden at build time.
+ */
+#ifndef ENA_RX_COUNT
+#define ENA_RX_COUNT 32
+#endif
 
 /** Base address low register offset */
 #define ENA_BASE_LO 0x0
@@ -170,6 +187,8 @@ struct ena_create_sq_req {
 enum ena_sq_policy {
 	/** Use host memory */
 	ENA_SQ_HOST_MEMORY = 0x0001,
+	/** Use device memory (low-latency queue) */
+	ENA_SQ_DEVICE_MEMORY = 0x0003,
 	/** Memory is contiguous */
 	ENA_SQ_CONTIGUOUS = 0x0100,
 };
@@ -484,6 +503,11 @@ struct ena_sq {
 	} sqe;
 	/** Doorbell register offset */
 	unsigned int doorbell;
+	/** Low-latency queue descriptor ring (if using device memory)
+	 *
+	 * NULL if the queue uses host memory.
+	 */
+	void *llq;
 	/** Total length of entries */
 	size_t len;
 	/** Producer counter */
@@ -573,6 +597,8 @@ struct ena_qp {
 struct ena_nic {
 	/** Registers */
 	void *regs;
+	/** Low-latency queue memory BAR (if present) */
+	void *mem;
 	/** Admin queue */
 	struct ena_aq aq;
 	/** Admin completion queue */
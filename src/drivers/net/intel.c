@@ -35,6 +35,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/malloc.h>
 #include <ipxe/pci.h>
 #include <ipxe/profile.h>
+#include <ipxe/drvprof.h>
 #include "intel.h"
 
 /** @file
@@ -55,6 +56,9 @@ static struct profiler intel_vm_refill_profiler __profiler =
 static struct profiler intel_vm_poll_profiler __profiler =
 	{ .name = "intel.vm_poll" };
 
+/** Latency profiler */
+DRIVER_PROFILER ( intel_drvprof, "intel" );
+
 /******************************************************************************
  *
  * EEPROM interface
@@ -572,18 +576,24 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	physaddr_t address;
 	unsigned int refilled = 0;
 
-	/* Refill ring */
-	while ( ( intel->rx.prod - intel->rx.cons ) < INTEL_RX_FILL ) {
-
-		/* Allocate I/O buffer */
-		iobuf = alloc_iob ( INTEL_RX_MAX_LEN );
+	/* Refill ring to half its depth, leaving room for the card to
+	 * write further received packets.
+	 */
+	while ( ( intel->rx.prod - intel->rx.cons ) < ( intel->rx.count / 2 ) ) {
+
+		/* Get I/O buffer from pool, or allocate directly if
+		 * the pool has not been initialised.
+		 */
+		iobuf = ( intel->rx_pool.len ?
+			  iob_pool_get ( &intel->rx_pool ) :
+			  alloc_iob ( INTEL_RX_MAX_LEN ) );
 		if ( ! iobuf ) {
 			/* Wait for next refill */
 			break;
 		}
 
 		/* Get next receive descriptor */
-		rx_idx = ( intel->rx.prod++ % INTEL_NUM_RX_DESC );
+		rx_idx = ( intel->rx.prod++ % intel->rx.count );
 		rx = &intel->rx.desc[rx_idx];
 
 		/* Populate receive descriptor */
@@ -603,7 +613,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	/* Push descriptors to card, if applicable */
 	if ( refilled ) {
 		wmb();
-		rx_tail = ( intel->rx.prod % INTEL_NUM_RX_DESC );
+		rx_tail = ( intel->rx.prod % intel->rx.count );
 		profile_start ( &intel_vm_refill_profiler );
 		writel ( rx_tail, intel->regs + intel->rx.reg + INTEL_xDT );
 		profile_stop ( &intel_vm_refill_profiler );
@@ -619,7 +629,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 void intel_empty_rx ( struct intel_nic *intel ) {
 	unsigned int i;
 
-	for ( i = 0 ; i < INTEL_NUM_RX_DESC ; i++ ) {
+	for ( i = 0 ; i < intel->rx.count ; i++ ) {
 		if ( intel->rx_iobuf[i] )
 			free_iob ( intel->rx_iobuf[i] );
 		intel->rx_iobuf[i] = NULL;
@@ -681,7 +691,9 @@ static int intel_open ( struct net_device *netdev ) {
 		  INTEL_RCTL_BAM | INTEL_RCTL_BSIZE_2048 | INTEL_RCTL_SECRC );
 	writel ( rctl, intel->regs + INTEL_RCTL );
 
-	/* Fill receive ring */
+	/* Pre-allocate receive buffers in bulk and fill receive ring */
+	iob_pool_init ( &intel->rx_pool, INTEL_RX_MAX_LEN );
+	iob_pool_fill ( &intel->rx_pool, ( intel->rx.count / 2 ) );
 	intel_refill_rx ( intel );
 
 	/* Update link state */
@@ -723,6 +735,9 @@ static void intel_close ( struct net_device *netdev ) {
 	/* Discard any unused receive buffers */
 	intel_empty_rx ( intel );
 
+	/* Drain receive buffer pool */
+	iob_pool_drain ( &intel->rx_pool );
+
 	/* Destroy transmit descriptor ring */
 	intel_destroy_ring ( intel, &intel->tx );
 
@@ -746,12 +761,12 @@ int intel_transmit ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	size_t len;
 
 	/* Get next transmit descriptor */
-	if ( ( intel->tx.prod - intel->tx.cons ) >= INTEL_TX_FILL ) {
+	if ( ( intel->tx.prod - intel->tx.cons ) >= ( intel->tx.count - 1 ) ) {
 		DBGC ( intel, "INTEL %p out of transmit descriptors\n", intel );
 		return -ENOBUFS;
 	}
-	tx_idx = ( intel->tx.prod++ % INTEL_NUM_TX_DESC );
-	tx_tail = ( intel->tx.prod % INTEL_NUM_TX_DESC );
+	tx_idx = ( intel->tx.prod++ % intel->tx.count );
+	tx_tail = ( intel->tx.prod % intel->tx.count );
 	tx = &intel->tx.desc[tx_idx];
 
 	/* Populate transmit descriptor */
@@ -769,6 +784,7 @@ int intel_transmit ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	DBGC2 ( intel, "INTEL %p TX %d is [%llx,%llx)\n", intel, tx_idx,
 		( ( unsigned long long ) address ),
 		( ( unsigned long long ) address + len ) );
+	drvprof_tx ( &intel_drvprof );
 
 	return 0;
 }
@@ -787,7 +803,7 @@ void intel_poll_tx ( struct net_device *netdev ) {
 	while ( intel->tx.cons != intel->tx.prod ) {
 
 		/* Get next transmit descriptor */
-		tx_idx = ( intel->tx.cons % INTEL_NUM_TX_DESC );
+		tx_idx = ( intel->tx.cons % intel->tx.count );
 		tx = &intel->tx.desc[tx_idx];
 
 		/* Stop if descriptor is still in use */
@@ -797,6 +813,7 @@ void intel_poll_tx ( struct net_device *netdev ) {
 		DBGC2 ( intel, "INTEL %p TX %d complete\n", intel, tx_idx );
 
 		/* Complete TX descriptor */
+		drvprof_tx_complete ( &intel_drvprof );
 		netdev_tx_complete_next ( netdev );
 		intel->tx.cons++;
 	}
@@ -818,7 +835,7 @@ void intel_poll_rx ( struct net_device *netdev ) {
 	while ( intel->rx.cons != intel->rx.prod ) {
 
 		/* Get next receive descriptor */
-		rx_idx = ( intel->rx.cons % INTEL_NUM_RX_DESC );
+		rx_idx = ( intel->rx.cons % intel->rx.count );
 		rx = &intel->rx.desc[rx_idx];
 
 		/* Stop if descriptor is still in use */
@@ -841,6 +858,7 @@ void intel_poll_rx ( struct net_device *netdev ) {
 			DBGC2 ( intel, "INTEL %p RX %d complete (length %zd)\n",
 				intel, rx_idx, len );
 			netdev_rx ( netdev, iobuf );
+			drvprof_rx ( &intel_drvprof );
 		}
 		intel->rx.cons++;
 	}
@@ -855,6 +873,9 @@ static void intel_poll ( struct net_device *netdev ) {
 	struct intel_nic *intel = netdev->priv;
 	uint32_t icr;
 
+	/* Record poll entry */
+	drvprof_poll ( &intel_drvprof );
+
 	/* Check for and acknowledge interrupts */
 	profile_start ( &intel_vm_poll_profiler );
 	icr = readl ( intel->regs + INTEL_ICR );
@@ -910,6 +931,47 @@ static void intel_irq ( struct net_device *netdev, int enable ) {
 	}
 }
 
+/**
+ * Update receive filter
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+static int intel_filter ( struct net_device *netdev ) {
+	struct intel_nic *intel = netdev->priv;
+	uint32_t mta[ INTEL_MTA_COUNT / 32 ];
+	uint32_t rctl;
+	unsigned int vector;
+	unsigned int i;
+	uint8_t *mac;
+
+	/* Construct multicast table array.  The filter vector
+	 * comprises bits 47:36 of the destination address (with the
+	 * default multicast offset of zero).
+	 */
+	memset ( mta, 0, sizeof ( mta ) );
+	for ( i = 0 ; i < netdev->mcast_count ; i++ ) {
+		mac = netdev->mcast[i].ll_addr;
+		vector = ( ( mac[4] >> 4 ) | ( mac[5] << 4 ) );
+		mta[ vector / 32 ] |= ( 1UL << ( vector % 32 ) );
+	}
+	for ( i = 0 ; i < ( INTEL_MTA_COUNT / 32 ) ; i++ )
+		writel ( mta[i], intel->regs + INTEL_MTA + ( i * 4 ) );
+
+	/* Receive only matching unicasts and filtered multicasts,
+	 * unless the multicast filter list has overflowed.
+	 */
+	rctl = readl ( intel->regs + INTEL_RCTL );
+	rctl &= ~( INTEL_RCTL_UPE | INTEL_RCTL_MPE );
+	if ( netdev->state & NETDEV_MCAST_OVERFLOW )
+		rctl |= INTEL_RCTL_MPE;
+	writel ( rctl, intel->regs + INTEL_RCTL );
+	DBGC ( intel, "INTEL %p filtering %d multicast addresses\n",
+	       intel, netdev->mcast_count );
+
+	return 0;
+}
+
 /** Intel network device operations */
 static struct net_device_operations intel_operations = {
 	.open		= intel_open,
@@ -917,6 +979,7 @@ static struct net_device_operations intel_operations = {
 	.transmit	= intel_transmit,
 	.poll		= intel_poll,
 	.irq		= intel_irq,
+	.filter		= intel_filter,
 };
 
 /******************************************************************************
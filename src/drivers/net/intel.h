@@ -11,6 +11,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <ipxe/if_ether.h>
+#include <ipxe/iobuf.h>
 #include <ipxe/nvs.h>
 
 /** Intel BAR size */
@@ -144,11 +145,14 @@ struct intel_descriptor {
  *
  * Minimum value is 8, since the descriptor ring length must be a
  * multiple of 128.
+ *
+ * This is a policy decision.  A deeper ring allows the card to absorb
+ * longer receive bursts while iPXE is busy elsewhere, at the cost of
+ * heap space.  May be overridden at build time.
  */
+#ifndef INTEL_NUM_RX_DESC
 #define INTEL_NUM_RX_DESC 16
-
-/** Receive descriptor ring fill level */
-#define INTEL_RX_FILL 8
+#endif
 
 /** Receive buffer length */
 #define INTEL_RX_MAX_LEN 2048
@@ -160,11 +164,12 @@ struct intel_descriptor {
  *
  * Descriptor ring length must be a multiple of 16.  ICH8/9/10
  * requires a minimum of 16 TX descriptors.
+ *
+ * May be overridden at build time.
  */
+#ifndef INTEL_NUM_TX_DESC
 #define INTEL_NUM_TX_DESC 16
-
-/** Transmit descriptor ring maximum fill level */
-#define INTEL_TX_FILL ( INTEL_NUM_TX_DESC - 1 )
+#endif
 
 /** Receive/Transmit Descriptor Base Address Low (offset) */
 #define INTEL_xDBAL 0x00
@@ -188,6 +193,12 @@ struct intel_descriptor {
 /** Maximum time to wait for queue disable, in milliseconds */
 #define INTEL_DISABLE_MAX_WAIT_MS 100
 
+/** Multicast Table Array */
+#define INTEL_MTA 0x05200UL
+
+/** Number of multicast table array entries */
+#define INTEL_MTA_COUNT 128
+
 /** Receive Address Low */
 #define INTEL_RAL0 0x05400UL
 
@@ -217,6 +228,12 @@ struct intel_ring {
 	/** Consumer index */
 	unsigned int cons;
 
+	/** Number of descriptors
+	 *
+	 * For receive rings, this must not exceed INTEL_NUM_RX_DESC,
+	 * since the I/O buffer tracking array is statically sized.
+	 */
+	unsigned int count;
 	/** Register block */
 	unsigned int reg;
 	/** Length (in bytes) */
@@ -245,6 +262,7 @@ intel_init_ring ( struct intel_ring *ring, unsigned int count, unsigned int reg,
 		  void ( * describe ) ( struct intel_descriptor *desc,
 					physaddr_t addr, size_t len ) ) {
 
+	ring->count = count;
 	ring->len = ( count * sizeof ( ring->desc[0] ) );
 	ring->reg = reg;
 	ring->describe = describe;
@@ -300,6 +318,13 @@ struct intel_nic {
 	struct intel_ring rx;
 	/** Receive I/O buffers */
 	struct io_buffer *rx_iobuf[INTEL_NUM_RX_DESC];
+	/** Receive I/O buffer pool
+	 *
+	 * Used only if initialised (i.e. if the pool buffer length is
+	 * non-zero); the ring refill falls back to direct allocation
+	 * otherwise.
+	 */
+	struct iob_pool rx_pool;
 };
 
 /** Driver flags */
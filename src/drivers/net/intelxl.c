@@ -37,6 +37,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/malloc.h>
 #include <ipxe/pci.h>
 #include <ipxe/version.h>
+#include <ipxe/drvprof.h>
 #include "intelxl.h"
 
 /** @file
@@ -45,6 +46,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Latency profiler */
+DRIVER_PROFILER ( intelxl_drvprof, "intelxl" );
+
 /******************************************************************************
  *
  * Device reset
@@ -1495,6 +1499,7 @@ int intelxl_transmit ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	DBGC2 ( intelxl, "INTELXL %p TX %d is [%llx,%llx)\n", intelxl, tx_idx,
 		( ( unsigned long long ) address ),
 		( ( unsigned long long ) address + len ) );
+	drvprof_tx ( &intelxl_drvprof );
 	return 0;
 }
 
@@ -1522,6 +1527,7 @@ static void intelxl_poll_tx ( struct net_device *netdev ) {
 			intelxl, tx_idx );
 
 		/* Complete TX descriptor */
+		drvprof_tx_complete ( &intelxl_drvprof );
 		netdev_tx_complete_next ( netdev );
 		intelxl->tx.cons++;
 	}
@@ -1574,6 +1580,7 @@ static void intelxl_poll_rx ( struct net_device *netdev ) {
 			DBGC2 ( intelxl, "INTELXL %p RX %d complete (length "
 				"%zd)\n", intelxl, rx_idx, len );
 			vlan_netdev_rx ( netdev, tag, iobuf );
+			drvprof_rx ( &intelxl_drvprof );
 		}
 		intelxl->rx.cons++;
 	}
@@ -1587,6 +1594,9 @@ static void intelxl_poll_rx ( struct net_device *netdev ) {
 void intelxl_poll ( struct net_device *netdev ) {
 	struct intelxl_nic *intelxl = netdev->priv;
 
+	/* Record poll entry */
+	drvprof_poll ( &intelxl_drvprof );
+
 	/* Poll for completed packets */
 	intelxl_poll_tx ( netdev );
 
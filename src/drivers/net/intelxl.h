@@ -906,23 +906,33 @@ intelxl_init_ring ( struct intelxl_ring *ring, unsigned int count, size_t len,
  *
  * Chosen to exceed the receive ring fill level, in order to avoid
  * running out of transmit descriptors when sending TCP ACKs.
+ *
+ * May be overridden at build time.
  */
+#ifndef INTELXL_TX_NUM_DESC
 #define INTELXL_TX_NUM_DESC 64
+#endif
 
 /** Transmit descriptor ring maximum fill level */
 #define INTELXL_TX_FILL ( INTELXL_TX_NUM_DESC - 1 )
 
 /** Number of receive descriptors
  *
- * Must be a multiple of 32.
+ * Must be a multiple of 32.  Deep enough to absorb a burst of
+ * full-throughput bulk data without dropping interleaved control
+ * packets (e.g. ARP or DHCP responses) between polls.
+ *
+ * May be overridden at build time.
  */
-#define INTELXL_RX_NUM_DESC 32
+#ifndef INTELXL_RX_NUM_DESC
+#define INTELXL_RX_NUM_DESC 64
+#endif
 
 /** Receive descriptor ring fill level
  *
  * Must be a multiple of 8 and greater than 8.
  */
-#define INTELXL_RX_FILL 16
+#define INTELXL_RX_FILL ( INTELXL_RX_NUM_DESC / 2 )
 
 /******************************************************************************
  *
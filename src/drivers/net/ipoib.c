@@ -67,8 +67,13 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Number of IPoIB send work queue entries */
 #define IPOIB_NUM_SEND_WQES 8
 
-/** Number of IPoIB receive work queue entries */
-#define IPOIB_NUM_RECV_WQES 4
+/** Number of IPoIB receive work queue entries
+ *
+ * Sustained downloads are bounded by per-packet processing cost, so
+ * keep enough receives posted to ride out bursts while the CPU
+ * catches up.
+ */
+#define IPOIB_NUM_RECV_WQES 8
 
 /** Number of IPoIB completion entries */
 #define IPOIB_NUM_CQES 16
@@ -28,7 +28,7 @@ static int legacy_transmit ( struct net_device *netdev, struct io_buffer *iobuf
 	struct ethhdr *ethhdr;
 
 	DBG ( "Transmitting %zd bytes\n", iob_len ( iobuf ) );
-	iob_pad ( iobuf, ETH_ZLEN );
+	iob_pad_align ( iobuf, ETH_ZLEN );
 	ethhdr = iobuf->data;
 	iob_pull ( iobuf, sizeof ( *ethhdr ) );
 	nic->nic_op->transmit ( nic, ( const char * ) ethhdr->h_dest,
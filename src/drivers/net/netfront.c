@@ -290,6 +290,22 @@ netfront_send_event ( struct netfront_nic *netfront ) {
 	return 0;
 }
 
+/**
+ * Send any pending event notification
+ *
+ * @v netfront		Netfront device
+ */
+static void netfront_notify ( struct netfront_nic *netfront ) {
+
+	/* Do nothing unless a notification is pending */
+	if ( ! netfront->notify )
+		return;
+	netfront->notify = 0;
+
+	/* Send event */
+	netfront_send_event ( netfront );
+}
+
 /**
  * Destroy event channel
  *
@@ -544,12 +560,16 @@ static void netfront_refill_rx ( struct net_device *netdev ) {
 
 	}
 
-	/* Push new descriptors and notify backend if applicable */
+	/* Push new descriptors and record any required notification.
+	 * Sending the notification itself is a hypercall, and so is
+	 * deferred to the end of the poll so that it can be coalesced
+	 * with any transmit notification.
+	 */
 	if ( refilled ) {
 		RING_PUSH_REQUESTS_AND_CHECK_NOTIFY ( &netfront->rx_fring,
 						      notify );
 		if ( notify )
-			netfront_send_event ( netfront );
+			netfront->notify = 1;
 	}
 }
 
@@ -617,8 +637,11 @@ static int netfront_open ( struct net_device *netdev ) {
 		goto err_backend_wait;
 	}
 
-	/* Refill receive descriptor ring */
+	/* Refill receive descriptor ring and notify backend
+	 * immediately, since no poll has yet been scheduled.
+	 */
 	netfront_refill_rx ( netdev );
+	netfront_notify ( netfront );
 
 	/* Set link up */
 	netdev_link_up ( netdev );
@@ -730,10 +753,16 @@ static int netfront_transmit ( struct net_device *netdev,
 	/* Consume descriptor */
 	netfront->tx_fring.req_prod_pvt++;
 
-	/* Push new descriptor and notify backend if applicable */
+	/* Push new descriptor and record any required notification.
+	 * The descriptor itself is made visible to the backend
+	 * immediately (via a shared memory write), but the event
+	 * channel notification is a hypercall and so is deferred to
+	 * the end of the next poll, allowing notifications for
+	 * multiple packets to be coalesced.
+	 */
 	RING_PUSH_REQUESTS_AND_CHECK_NOTIFY ( &netfront->tx_fring, notify );
 	if ( notify )
-		netfront_send_event ( netfront );
+		netfront->notify = 1;
 
 	return 0;
 }
@@ -823,6 +852,7 @@ static void netfront_poll_rx ( struct net_device *netdev ) {
  * @v netdev		Network device
  */
 static void netfront_poll ( struct net_device *netdev ) {
+	struct netfront_nic *netfront = netdev->priv;
 
 	/* Poll for TX completions */
 	netfront_poll_tx ( netdev );
@@ -832,6 +862,9 @@ static void netfront_poll ( struct net_device *netdev ) {
 
 	/* Refill RX descriptor ring */
 	netfront_refill_rx ( netdev );
+
+	/* Send any pending notification */
+	netfront_notify ( netfront );
 }
 
 /** Network device operations */
@@ -167,6 +167,13 @@ struct netfront_nic {
 
 	/** Event channel */
 	struct evtchn_send event;
+	/** Pending event notification flag
+	 *
+	 * Event channel notifications are hypercalls, and so are
+	 * coalesced: at most one event is sent per poll, covering
+	 * both newly pushed transmit and receive requests.
+	 */
+	int notify;
 };
 
 /** Transmit shared ring field */
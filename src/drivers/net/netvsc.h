@@ -34,9 +34,18 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 /** RX data buffer length
  *
- * This is a policy decision.
+ * This is a policy decision.  The receive data buffer bounds the
+ * amount of received data that the host may have in flight to us:
+ * the host batches multiple received frames into each VMBus transfer
+ * page packet, and drops frames for which no buffer space is
+ * available.  The buffer must therefore be deep enough to absorb a
+ * burst of full-throughput bulk data between polls.
+ *
+ * May be overridden at build time.
  */
-#define NETVSC_RX_BUF_LEN ( 16 * PAGE_SIZE )
+#ifndef NETVSC_RX_BUF_LEN
+#define NETVSC_RX_BUF_LEN ( 64 * PAGE_SIZE )
+#endif
 
 /** Base transaction ID
  *
@@ -33,6 +33,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/netdevice.h>
 #include <ipxe/ethernet.h>
 #include <ipxe/if_ether.h>
+#include <ipxe/vlan.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/malloc.h>
 #include <ipxe/pci.h>
@@ -40,6 +41,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/threewire.h>
 #include <ipxe/bitbash.h>
 #include <ipxe/mii.h>
+#include <ipxe/drvprof.h>
 #include "realtek.h"
 
 /** @file
@@ -52,6 +54,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *    http://www.datasheetarchive.com/indexdl/Datasheet-028/DSA00494723.pdf
  */
 
+/** Latency profiler */
+DRIVER_PROFILER ( realtek_drvprof, "realtek" );
+
 /******************************************************************************
  *
  * Debugging
@@ -686,6 +691,7 @@ static int realtek_open ( struct net_device *netdev ) {
 	struct realtek_nic *rtl = netdev->priv;
 	uint32_t tcr;
 	uint32_t rcr;
+	uint16_t cpcr;
 	int rc;
 
 	/* Create transmit descriptor ring */
@@ -724,6 +730,18 @@ static int realtek_open ( struct net_device *netdev ) {
 		 RTL_RCR_AM | RTL_RCR_APM | RTL_RCR_AAP );
 	writel ( rcr, rtl->regs + RTL_RCR );
 
+	/* Enable receive checksum validation and VLAN de-tagging, if
+	 * applicable.  The hardware validates IP, TCP and UDP
+	 * checksums and strips VLAN tags into the receive descriptor,
+	 * allowing the network stack to skip software verification.
+	 */
+	if ( ! rtl->legacy ) {
+		cpcr = readw ( rtl->regs + RTL_CPCR );
+		cpcr |= ( RTL_CPCR_VLAN | RTL_CPCR_CHKSUM );
+		writew ( cpcr, rtl->regs + RTL_CPCR );
+		netdev->features |= NETDEV_FEAT_RX_CSUM;
+	}
+
 	/* Fill receive ring */
 	realtek_refill_rx ( rtl );
 
@@ -796,7 +814,7 @@ static int realtek_transmit ( struct net_device *netdev,
 	if ( rtl->legacy ) {
 
 		/* Pad and align packet */
-		iob_pad ( iobuf, ETH_ZLEN );
+		iob_pad_align ( iobuf, ETH_ZLEN );
 		address = virt_to_bus ( iobuf->data );
 
 		/* Check that card can support address */
@@ -833,6 +851,7 @@ static int realtek_transmit ( struct net_device *netdev,
 		( ( unsigned long long ) virt_to_bus ( iobuf->data ) ),
 		( ( ( unsigned long long ) virt_to_bus ( iobuf->data ) ) +
 		  iob_len ( iobuf ) ) );
+	drvprof_tx ( &realtek_drvprof );
 
 	return 0;
 }
@@ -873,6 +892,7 @@ static void realtek_poll_tx ( struct net_device *netdev ) {
 
 		/* Complete TX descriptor */
 		rtl->tx.cons++;
+		drvprof_tx_complete ( &realtek_drvprof );
 		netdev_tx_complete_next ( netdev );
 	}
 }
@@ -913,6 +933,7 @@ static void realtek_legacy_poll_rx ( struct net_device *netdev ) {
 
 			/* Hand off to network stack */
 			netdev_rx ( netdev, iobuf );
+			drvprof_rx ( &realtek_drvprof );
 
 		} else {
 
@@ -933,6 +954,29 @@ static void realtek_legacy_poll_rx ( struct net_device *netdev ) {
 	}
 }
 
+/**
+ * Check hardware receive checksum validation result
+ *
+ * @v rx		Receive descriptor
+ * @ret csum_ok		Transport checksum has been validated
+ */
+static int realtek_rx_csum_ok ( struct realtek_descriptor *rx ) {
+	unsigned int flags = le16_to_cpu ( rx->flags );
+	unsigned int pid = ( flags & ( RTL_DESC_PID1 | RTL_DESC_PID0 ) );
+
+	/* IP header checksum must be valid */
+	if ( flags & RTL_DESC_IPF )
+		return 0;
+
+	/* TCP or UDP checksum must be present and valid */
+	if ( pid == RTL_DESC_PID0 )
+		return ( ! ( le16_to_cpu ( rx->length ) & RTL_DESC_TCPF ) );
+	if ( pid == RTL_DESC_PID1 )
+		return ( ! ( le16_to_cpu ( rx->length ) & RTL_DESC_UDPF ) );
+
+	return 0;
+}
+
 /**
  * Poll for received packets
  *
@@ -943,6 +987,7 @@ static void realtek_poll_rx ( struct net_device *netdev ) {
 	struct realtek_descriptor *rx;
 	struct io_buffer *iobuf;
 	unsigned int rx_idx;
+	unsigned int tag;
 	size_t len;
 
 	/* Poll receive buffer if in legacy mode */
@@ -977,7 +1022,20 @@ static void realtek_poll_rx ( struct net_device *netdev ) {
 		} else {
 			DBGC2 ( rtl, "REALTEK %p RX %d complete (length "
 				"%zd)\n", rtl, rx_idx, len );
-			netdev_rx ( netdev, iobuf );
+
+			/* Mark checksum as validated, if applicable */
+			if ( realtek_rx_csum_ok ( rx ) )
+				iobuf->flags |= IOB_FL_CSUM_OK;
+
+			/* Hand off, reapplying any stripped VLAN tag */
+			if ( rx->vlan & cpu_to_le32 ( RTL_DESC_TAVA ) ) {
+				tag = bswap_16 ( le32_to_cpu ( rx->vlan ) &
+						 RTL_DESC_VLAN_MASK );
+				vlan_netdev_rx ( netdev, tag, iobuf );
+			} else {
+				netdev_rx ( netdev, iobuf );
+			}
+			drvprof_rx ( &realtek_drvprof );
 		}
 		rtl->rx.cons++;
 	}
@@ -992,6 +1050,9 @@ static void realtek_poll ( struct net_device *netdev ) {
 	struct realtek_nic *rtl = netdev->priv;
 	uint16_t isr;
 
+	/* Record poll entry */
+	drvprof_poll ( &realtek_drvprof );
+
 	/* Check for and acknowledge interrupts */
 	isr = readw ( rtl->regs + RTL_ISR );
 	if ( ! isr )
@@ -1030,6 +1091,73 @@ static void realtek_irq ( struct net_device *netdev, int enable ) {
 	writew ( imr, rtl->regs + RTL_IMR );
 }
 
+/**
+ * Calculate multicast hash
+ *
+ * @v ll_addr		Link-layer multicast address
+ * @ret crc		CRC-32 (most-significant-bit-first polynomial)
+ */
+static uint32_t realtek_mc_hash ( const uint8_t *ll_addr ) {
+	uint32_t crc = 0xffffffffUL;
+	unsigned int i;
+	unsigned int j;
+
+	for ( i = 0 ; i < ETH_ALEN ; i++ ) {
+		crc ^= ( ( ( uint32_t ) ll_addr[i] ) << 24 );
+		for ( j = 0 ; j < 8 ; j++ ) {
+			if ( crc & 0x80000000UL ) {
+				crc = ( ( crc << 1 ) ^ 0x04c11db7UL );
+			} else {
+				crc <<= 1;
+			}
+		}
+	}
+	return crc;
+}
+
+/**
+ * Update receive filter
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+static int realtek_filter ( struct net_device *netdev ) {
+	struct realtek_nic *rtl = netdev->priv;
+	uint32_t mar[2];
+	uint32_t rcr;
+	unsigned int bit;
+	unsigned int i;
+
+	/* Construct multicast hash filter.  The hash bit ordering
+	 * varies between the later PCIe family members; restrict
+	 * selective filtering to the original RTL8139, where the
+	 * layout is known, and accept all multicasts elsewhere.
+	 */
+	if ( rtl->legacy &&
+	     ( ! ( netdev->state & NETDEV_MCAST_OVERFLOW ) ) ) {
+		mar[0] = 0;
+		mar[1] = 0;
+		for ( i = 0 ; i < netdev->mcast_count ; i++ ) {
+			bit = ( realtek_mc_hash ( netdev->mcast[i].ll_addr )
+				>> 26 );
+			mar[ bit / 32 ] |= ( 1UL << ( bit % 32 ) );
+		}
+	} else {
+		mar[0] = 0xffffffffUL;
+		mar[1] = 0xffffffffUL;
+	}
+	writel ( mar[0], rtl->regs + RTL_MAR0 );
+	writel ( mar[1], rtl->regs + RTL_MAR4 );
+
+	/* Stop accepting non-matching unicast packets */
+	rcr = readl ( rtl->regs + RTL_RCR );
+	writel ( ( rcr & ~RTL_RCR_AAP ), rtl->regs + RTL_RCR );
+	DBGC ( rtl, "REALTEK %p filtering %d multicast addresses\n",
+	       rtl, netdev->mcast_count );
+
+	return 0;
+}
+
 /** Realtek network device operations */
 static struct net_device_operations realtek_operations = {
 	.open		= realtek_open,
@@ -1037,6 +1165,7 @@ static struct net_device_operations realtek_operations = {
 	.transmit	= realtek_transmit,
 	.poll		= realtek_poll,
 	.irq		= realtek_irq,
+	.filter		= realtek_filter,
 };
 
 /******************************************************************************
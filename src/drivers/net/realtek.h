@@ -23,8 +23,8 @@ struct realtek_descriptor {
 	uint16_t length;
 	/** Flags */
 	uint16_t flags;
-	/** Reserved */
-	uint32_t reserved;
+	/** VLAN tag control */
+	uint32_t vlan;
 	/** Buffer address */
 	uint64_t address;
 } __attribute__ (( packed ));
@@ -44,8 +44,32 @@ enum realtek_descriptor_flags {
 	RTL_DESC_LS = 0x1000,
 	/** Receive error summary */
 	RTL_DESC_RES = 0x0020,
+	/** Receive protocol identifier bit 1 */
+	RTL_DESC_PID1 = 0x0004,
+	/** Receive protocol identifier bit 0 */
+	RTL_DESC_PID0 = 0x0002,
+	/** Receive IP header checksum failed */
+	RTL_DESC_IPF = 0x0001,
 };
 
+/** Packet descriptor length field flags */
+enum realtek_descriptor_length_flags {
+	/** Receive UDP checksum failed */
+	RTL_DESC_UDPF = 0x8000,
+	/** Receive TCP checksum failed */
+	RTL_DESC_TCPF = 0x4000,
+};
+
+/** Receive VLAN tag is present */
+#define RTL_DESC_TAVA 0x00010000UL
+
+/** Receive VLAN tag mask
+ *
+ * The stripped tag is stored byte-swapped within the little-endian
+ * VLAN tag control field.
+ */
+#define RTL_DESC_VLAN_MASK 0x0000ffffUL
+
 /** Descriptor ring alignment */
 #define RTL_RING_ALIGN 256
 
@@ -228,6 +252,8 @@ enum realtek_legacy_status {
 
 /** C+ Command Register (word) */
 #define RTL_CPCR 0xe0
+#define RTL_CPCR_VLAN		0x0040	/**< Receive VLAN de-tagging enable */
+#define RTL_CPCR_CHKSUM		0x0020	/**< Receive checksum offload enable */
 #define RTL_CPCR_DAC		0x0010	/**< PCI Dual Address Cycle Enable */
 #define RTL_CPCR_MULRW		0x0008	/**< PCI Multiple Read/Write Enable */
 #define RTL_CPCR_CPRX		0x0002	/**< C+ receive enable */
@@ -478,7 +478,7 @@ static int rhine_transmit ( struct net_device *netdev,
 	desc = &rhn->tx.desc[tx_idx];
 
 	/* Pad and align packet */
-	iob_pad ( iobuf, ETH_ZLEN );
+	iob_pad_align ( iobuf, ETH_ZLEN );
 	address = virt_to_bus ( iobuf->data );
 
 	/* Populate transmit descriptor */
@@ -24,15 +24,21 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include <byteswap.h>
 #include <ipxe/list.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/netdevice.h>
 #include <ipxe/pci.h>
 #include <ipxe/if_ether.h>
 #include <ipxe/ethernet.h>
+#include <ipxe/ip.h>
+#include <ipxe/tcp.h>
+#include <ipxe/tcpip.h>
 #include <ipxe/virtio-pci.h>
 #include <ipxe/virtio-ring.h>
+#include <ipxe/drvprof.h>
 #include "virtio-net.h"
 
 /*
@@ -80,6 +86,9 @@ enum {
 /** Max number of pending rx packets */
 #define NUM_RX_BUF 8
 
+/** Latency profiler */
+DRIVER_PROFILER ( virtnet_drvprof, "virtnet" );
+
 struct virtnet_nic {
 	/** Base pio register address */
 	unsigned long ioaddr;
@@ -99,10 +108,74 @@ struct virtnet_nic {
 	/** Pending rx packet count */
 	unsigned int rx_num_iobufs;
 
+	/** Mergeable receive buffers have been negotiated
+	 *
+	 * The device then writes the (12 byte) virtio net header to
+	 * the start of each receive buffer itself, and may spread a
+	 * single packet across multiple receive buffers.
+	 */
+	int mrg_rxbuf;
+
 	/** Virtio net dummy packet headers */
 	struct virtio_net_hdr_modern empty_header[QUEUE_NB];
+
+	/** Per-packet TX headers for segmentation offload
+	 *
+	 * Allocated (indexed by TX descriptor) only when the device
+	 * has negotiated checksum and TSOv4 offloads.
+	 */
+	struct virtio_net_hdr_modern *tx_headers;
 };
 
+/** Construct a per-packet header for checksum/segmentation offload
+ *
+ * @v netdev		Network device
+ * @v iobuf		I/O buffer holding a TCPv4 packet
+ * @ret header		Virtio net header to use for this packet
+ *
+ * The device expects the transport checksum field of an offloaded
+ * packet to be seeded with the checksum of the pseudo-header alone,
+ * so any checksum already present is replaced.
+ */
+static struct virtio_net_hdr_modern *
+virtnet_offload_header ( struct net_device *netdev,
+			 struct io_buffer *iobuf ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+	struct vring_virtqueue *vq = &virtnet->virtqueue[TX_INDEX];
+	struct virtio_net_hdr_modern *header =
+		&virtnet->tx_headers[vq->free_head];
+	struct iphdr *iphdr = ( iobuf->data + ETH_HLEN );
+	size_t ip_hlen = ( ( iphdr->verhdrlen & 0x0f ) * 4 );
+	struct tcp_header *tcphdr = ( ( ( void * ) iphdr ) + ip_hlen );
+	struct ipv4_pseudo_header pshdr;
+
+	/* Reseed the transport checksum with the pseudo-header
+	 * checksum alone.
+	 */
+	pshdr.src = iphdr->src;
+	pshdr.dest = iphdr->dest;
+	pshdr.zero_padding = 0;
+	pshdr.protocol = iphdr->protocol;
+	pshdr.len = htons ( ntohs ( iphdr->len ) - ip_hlen );
+	tcphdr->csum = ~tcpip_chksum ( &pshdr, sizeof ( pshdr ) );
+
+	/* Describe the required offloads to the device */
+	memset ( header, 0, sizeof ( *header ) );
+	header->legacy.flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+	header->legacy.csum_start = cpu_to_le16 ( ETH_HLEN + ip_hlen );
+	header->legacy.csum_offset =
+		cpu_to_le16 ( offsetof ( struct tcp_header, csum ) );
+	if ( iobuf->gso_size ) {
+		header->legacy.gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		header->legacy.hdr_len =
+			cpu_to_le16 ( ETH_HLEN + ip_hlen +
+				      ( ( tcphdr->hlen & 0xf0 ) >> 2 ) );
+		header->legacy.gso_size = cpu_to_le16 ( iobuf->gso_size );
+	}
+
+	return header;
+}
+
 /** Add an iobuf to a virtqueue
  *
  * @v netdev		Network device
@@ -115,31 +188,54 @@ static void virtnet_enqueue_iob ( struct net_device *netdev,
 				  int vq_idx, struct io_buffer *iobuf ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	struct vring_virtqueue *vq = &virtnet->virtqueue[vq_idx];
-	struct virtio_net_hdr_modern *header = &virtnet->empty_header[vq_idx];
+	struct virtio_net_hdr_modern *header;
 	unsigned int out = ( vq_idx == TX_INDEX ) ? 2 : 0;
 	unsigned int in = ( vq_idx == TX_INDEX ) ? 0 : 2;
-	size_t header_len = ( virtnet->virtio_version ?
-			      sizeof ( *header ) : sizeof ( header->legacy ) );
-	struct vring_list list[] = {
-		{
-			/* Share a single zeroed virtio net header between all
-			 * packets in a ring.  This works because this driver
-			 * does not use any advanced features so none of the
-			 * header fields get used.
-			 *
-			 * Some host implementations (notably Google Compute
-			 * Platform) are known to unconditionally write back
-			 * to header->flags for received packets.  Work around
-			 * this by using separate RX and TX headers.
-			 */
-			.addr = ( char* ) header,
-			.length = header_len,
-		},
-		{
-			.addr = ( char* ) iobuf->data,
-			.length = iob_len ( iobuf ),
-		},
-	};
+	size_t header_len;
+	struct vring_list list[2];
+
+	if ( ( vq_idx == RX_INDEX ) && virtnet->mrg_rxbuf ) {
+		/* With mergeable receive buffers the device writes the
+		 * virtio net header into the buffer itself, so receive
+		 * buffers are posted as a single descriptor.
+		 */
+		list[0].addr = ( char * ) iobuf->data;
+		list[0].length = iob_len ( iobuf );
+
+		DBGC2 ( virtnet, "VIRTIO-NET %p enqueuing iobuf %p on vq %d\n",
+			virtnet, iobuf, vq_idx );
+
+		vring_add_buf ( vq, list, 0, 1, iobuf, 0 );
+		vring_kick ( virtnet->virtio_version ? &virtnet->vdev : NULL,
+			     virtnet->ioaddr, vq, 1 );
+		return;
+	}
+
+	if ( ( vq_idx == TX_INDEX ) &&
+	     ( iobuf->gso_size || ( iobuf->flags & IOB_FL_CSUM_PARTIAL ) ) ) {
+		/* Use a per-packet header to describe the offloads
+		 * required for this packet.
+		 */
+		header = virtnet_offload_header ( netdev, iobuf );
+	} else {
+		/* Share a single zeroed virtio net header between all
+		 * packets in a ring.  This works because this driver
+		 * does not use any advanced features so none of the
+		 * header fields get used.
+		 *
+		 * Some host implementations (notably Google Compute
+		 * Platform) are known to unconditionally write back
+		 * to header->flags for received packets.  Work around
+		 * this by using separate RX and TX headers.
+		 */
+		header = &virtnet->empty_header[vq_idx];
+	}
+	header_len = ( virtnet->virtio_version ?
+		       sizeof ( *header ) : sizeof ( header->legacy ) );
+	list[0].addr = ( char * ) header;
+	list[0].length = header_len;
+	list[1].addr = ( char * ) iobuf->data;
+	list[1].length = iob_len ( iobuf );
 
 	DBGC2 ( virtnet, "VIRTIO-NET %p enqueuing iobuf %p on vq %d\n",
 		virtnet, iobuf, vq_idx );
@@ -157,6 +253,10 @@ static void virtnet_refill_rx_virtqueue ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	size_t len = ( netdev->max_pkt_len + 4 /* VLAN */ );
 
+	/* Leave room for the in-buffer virtio net header */
+	if ( virtnet->mrg_rxbuf )
+		len += sizeof ( struct virtio_net_hdr_modern );
+
 	while ( virtnet->rx_num_iobufs < NUM_RX_BUF ) {
 		struct io_buffer *iobuf;
 
@@ -176,6 +276,37 @@ static void virtnet_refill_rx_virtqueue ( struct net_device *netdev ) {
 	}
 }
 
+/** Enable checksum and segmentation offloads, if negotiated
+ *
+ * @v netdev		Network device
+ * @v csum		Device has accepted checksum offload
+ * @v tso		Device has accepted TSOv4 offload
+ *
+ * Must be called after the virtqueues have been initialised.
+ */
+static void virtnet_enable_offloads ( struct net_device *netdev,
+				      int csum, int tso ) {
+	struct virtnet_nic *virtnet = netdev->priv;
+	unsigned int num = virtnet->virtqueue[TX_INDEX].vring.num;
+
+	if ( ! csum )
+		return;
+
+	/* Allocate per-packet TX headers, indexed by TX descriptor.
+	 * The offloads are simply not advertised if the allocation
+	 * fails.
+	 */
+	virtnet->tx_headers = zalloc ( num * sizeof ( *virtnet->tx_headers ));
+	if ( ! virtnet->tx_headers )
+		return;
+
+	netdev->features |= NETDEV_FEAT_TX_CSUM;
+	if ( tso )
+		netdev->features |= NETDEV_FEAT_TX_TSO;
+	DBGC ( virtnet, "VIRTIO-NET %p using TX checksum offload%s\n",
+	       virtnet, ( tso ? " and TSOv4" : "" ) );
+}
+
 /** Helper to free all virtqueue memory
  *
  * @v netdev		Network device
@@ -184,6 +315,10 @@ static void virtnet_free_virtqueues ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	int i;
 
+	netdev->features &= ~( NETDEV_FEAT_TX_TSO | NETDEV_FEAT_TX_CSUM );
+	free ( virtnet->tx_headers );
+	virtnet->tx_headers = NULL;
+
 	for ( i = 0; i < QUEUE_NB; i++ ) {
 		virtio_pci_unmap_capability ( &virtnet->virtqueue[i].notification );
 		vp_free_vq ( &virtnet->virtqueue[i] );
@@ -223,6 +358,24 @@ static int virtnet_open_legacy ( struct net_device *netdev ) {
 		}
 	}
 
+	/* Negotiate features before any buffers are posted */
+	features = vp_get_features ( ioaddr );
+	vp_set_features ( ioaddr, features & ( ( 1 << VIRTIO_NET_F_MAC ) |
+					       ( 1 << VIRTIO_NET_F_MTU ) |
+					       ( 1 << VIRTIO_NET_F_CSUM ) |
+					       ( 1 << VIRTIO_NET_F_HOST_TSO4 ) |
+					       ( 1 << VIRTIO_NET_F_MRG_RXBUF ) |
+					       ( 1 << VIRTIO_RING_F_EVENT_IDX ) ) );
+	virtnet_enable_offloads ( netdev,
+				  ( features & ( 1 << VIRTIO_NET_F_CSUM ) ),
+				  ( features &
+				    ( 1 << VIRTIO_NET_F_HOST_TSO4 ) ) );
+	virtnet->mrg_rxbuf = !! ( features & ( 1 << VIRTIO_NET_F_MRG_RXBUF ) );
+	for ( i = 0; i < QUEUE_NB; i++ ) {
+		virtnet->virtqueue[i].event_idx =
+			!! ( features & ( 1 << VIRTIO_RING_F_EVENT_IDX ) );
+	}
+
 	/* Initialize rx packets */
 	INIT_LIST_HEAD ( &virtnet->rx_iobufs );
 	virtnet->rx_num_iobufs = 0;
@@ -232,9 +385,6 @@ static int virtnet_open_legacy ( struct net_device *netdev ) {
 	netdev_irq ( netdev, 0 );
 
 	/* Driver is ready */
-	features = vp_get_features ( ioaddr );
-	vp_set_features ( ioaddr, features & ( ( 1 << VIRTIO_NET_F_MAC ) |
-					       ( 1 << VIRTIO_NET_F_MTU ) ) );
 	vp_set_status ( ioaddr, VIRTIO_CONFIG_S_DRIVER | VIRTIO_CONFIG_S_DRIVER_OK );
 	return 0;
 }
@@ -248,6 +398,7 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 	u64 features;
 	u8 status;
+	int i;
 
 	/* Negotiate features */
 	features = vpm_get_features ( &virtnet->vdev );
@@ -258,6 +409,10 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 	vpm_set_features ( &virtnet->vdev, features & (
 		( 1ULL << VIRTIO_NET_F_MAC ) |
 		( 1ULL << VIRTIO_NET_F_MTU ) |
+		( 1ULL << VIRTIO_NET_F_CSUM ) |
+		( 1ULL << VIRTIO_NET_F_HOST_TSO4 ) |
+		( 1ULL << VIRTIO_NET_F_MRG_RXBUF ) |
+		( 1ULL << VIRTIO_RING_F_EVENT_IDX ) |
 		( 1ULL << VIRTIO_F_VERSION_1 ) |
 		( 1ULL << VIRTIO_F_ANY_LAYOUT ) |
 		( 1ULL << VIRTIO_F_IOMMU_PLATFORM ) ) );
@@ -287,6 +442,18 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
 		vpm_add_status ( &virtnet->vdev, VIRTIO_CONFIG_S_FAILED );
 		return -ENOENT;
 	}
+	virtnet->mrg_rxbuf = !! ( features & ( 1ULL << VIRTIO_NET_F_MRG_RXBUF ) );
+	for ( i = 0; i < QUEUE_NB; i++ ) {
+		virtnet->virtqueue[i].event_idx =
+			!! ( features & ( 1ULL << VIRTIO_RING_F_EVENT_IDX ) );
+	}
+
+	/* Enable checksum and segmentation offloads, if negotiated */
+	virtnet_enable_offloads ( netdev,
+				  !! ( features &
+				       ( 1ULL << VIRTIO_NET_F_CSUM ) ),
+				  !! ( features &
+				       ( 1ULL << VIRTIO_NET_F_HOST_TSO4 ) ) );
 
 	/* Disable interrupts before starting */
 	netdev_irq ( netdev, 0 );
@@ -350,6 +517,7 @@ static void virtnet_close ( struct net_device *netdev ) {
 static int virtnet_transmit ( struct net_device *netdev,
 			      struct io_buffer *iobuf ) {
 	virtnet_enqueue_iob ( netdev, TX_INDEX, iobuf );
+	drvprof_tx ( &virtnet_drvprof );
 	return 0;
 }
 
@@ -367,6 +535,7 @@ static void virtnet_process_tx_packets ( struct net_device *netdev ) {
 		DBGC2 ( virtnet, "VIRTIO-NET %p tx complete iobuf %p\n",
 			virtnet, iobuf );
 
+		drvprof_tx_complete ( &virtnet_drvprof );
 		netdev_tx_complete ( netdev, iobuf );
 	}
 }
@@ -382,6 +551,8 @@ static void virtnet_process_rx_packets ( struct net_device *netdev ) {
 	while ( vring_more_used ( rx_vq ) ) {
 		unsigned int len;
 		struct io_buffer *iobuf = vring_get_buf ( rx_vq, &len );
+		struct virtio_net_hdr_modern *header;
+		unsigned int merged;
 
 		/* Release ownership of iobuf */
 		list_del ( &iobuf->list );
@@ -389,13 +560,38 @@ static void virtnet_process_rx_packets ( struct net_device *netdev ) {
 
 		/* Update iobuf length */
 		iob_unput ( iobuf, iob_len ( iobuf ) );
-		iob_put ( iobuf, len - sizeof ( struct virtio_net_hdr ) );
+		if ( virtnet->mrg_rxbuf ) {
+			/* Strip the in-buffer header, and append the
+			 * contents of any continuation buffers.  The
+			 * merged packet is guaranteed to fit since each
+			 * receive buffer is sized for a full packet.
+			 */
+			iob_put ( iobuf, len );
+			header = iobuf->data;
+			merged = le16_to_cpu ( header->num_buffers );
+			iob_pull ( iobuf, sizeof ( *header ) );
+			while ( ( merged > 1 ) && vring_more_used ( rx_vq ) ) {
+				unsigned int frag_len;
+				struct io_buffer *frag =
+					vring_get_buf ( rx_vq, &frag_len );
+
+				list_del ( &frag->list );
+				virtnet->rx_num_iobufs--;
+				memcpy ( iob_put ( iobuf, frag_len ),
+					 frag->data, frag_len );
+				free_iob ( frag );
+				merged--;
+			}
+		} else {
+			iob_put ( iobuf, len - sizeof ( struct virtio_net_hdr ) );
+		}
 
 		DBGC2 ( virtnet, "VIRTIO-NET %p rx complete iobuf %p len %zd\n",
 			virtnet, iobuf, iob_len ( iobuf ) );
 
 		/* Pass completed packet to the network stack */
 		netdev_rx ( netdev, iobuf );
+		drvprof_rx ( &virtnet_drvprof );
 	}
 
 	virtnet_refill_rx_virtqueue ( netdev );
@@ -408,6 +604,9 @@ static void virtnet_process_rx_packets ( struct net_device *netdev ) {
 static void virtnet_poll ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
 
+	/* Record poll entry */
+	drvprof_poll ( &virtnet_drvprof );
+
 	/* Acknowledge interrupt.  This is necessary for UNDI operation and
 	 * interrupts that are raised despite VRING_AVAIL_F_NO_INTERRUPT being
 	 * set (that flag is just a hint and the hypervisor does not have to
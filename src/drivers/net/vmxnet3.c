@@ -122,15 +122,35 @@ static int vmxnet3_transmit ( struct net_device *netdev,
 	tx_desc->flags[0] = ( generation | cpu_to_le32 ( iob_len ( iobuf ) ) );
 	tx_desc->flags[1] = cpu_to_le32 ( VMXNET3_TXF_CQ | VMXNET3_TXF_EOP );
 
-	/* Hand over descriptor to NIC */
+	/* Hand over descriptor to NIC.  The doorbell write is a VM
+	 * exit, so it is deferred to the end of the current poll in
+	 * order to coalesce it across a batch of packets.
+	 */
 	wmb();
+	vmxnet->tx_pending++;
+
+	return 0;
+}
+
+/**
+ * Ring transmit doorbell for any pending packets
+ *
+ * @v netdev		Network device
+ */
+static void vmxnet3_doorbell_tx ( struct net_device *netdev ) {
+	struct vmxnet3_nic *vmxnet = netdev_priv ( netdev );
+
+	/* Do nothing if no packets are pending */
+	if ( ! vmxnet->tx_pending )
+		return;
+	vmxnet->tx_pending = 0;
+
+	/* Ring doorbell once for the whole batch */
 	profile_start ( &vmxnet3_vm_tx_profiler );
 	writel ( ( vmxnet->count.tx_prod % VMXNET3_NUM_TX_DESC ),
 		 ( vmxnet->pt + VMXNET3_PT_TXPROD ) );
 	profile_stop ( &vmxnet3_vm_tx_profiler );
 	profile_exclude ( &vmxnet3_vm_tx_profiler );
-
-	return 0;
 }
 
 /**
@@ -415,6 +435,7 @@ static void vmxnet3_poll ( struct net_device *netdev ) {
 	vmxnet3_poll_tx ( netdev );
 	vmxnet3_poll_rx ( netdev );
 	vmxnet3_refill_rx ( netdev );
+	vmxnet3_doorbell_tx ( netdev );
 }
 
 /**
@@ -515,6 +536,7 @@ static int vmxnet3_open ( struct net_device *netdev ) {
 
 	/* Zero counters */
 	memset ( &vmxnet->count, 0, sizeof ( vmxnet->count ) );
+	vmxnet->tx_pending = 0;
 
 	/* Set MAC address */
 	vmxnet3_set_ll_addr ( vmxnet, &netdev->ll_addr );
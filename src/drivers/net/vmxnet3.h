@@ -478,6 +478,12 @@ struct vmxnet3_nic {
 	struct vmxnet3_dma *dma;
 	/** Producer and consumer counters */
 	struct vmxnet3_counters count;
+	/** Number of transmit descriptors awaiting a doorbell
+	 *
+	 * Doorbell writes are VM exits, so they are coalesced: the
+	 * accumulated batch is pushed once per poll.
+	 */
+	unsigned int tx_pending;
 	/** Transmit I/O buffers */
 	struct io_buffer *tx_iobuf[VMXNET3_NUM_TX_DESC];
 	/** Receive I/O buffers */
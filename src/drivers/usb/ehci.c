@@ -543,10 +543,11 @@ static int ehci_reset ( struct ehci_device *ehci ) {
  *
  * @v ehci		EHCI device
  * @v ring		Transfer descriptor ring
+ * @v count		Number of transfer descriptors (must be a power of two)
  * @ret rc		Return status code
  */
 static int ehci_ring_alloc ( struct ehci_device *ehci,
-			     struct ehci_ring *ring ) {
+			     struct ehci_ring *ring, unsigned int count ) {
 	struct ehci_transfer_descriptor *desc;
 	struct ehci_transfer_descriptor *next;
 	unsigned int i;
@@ -556,9 +557,11 @@ static int ehci_ring_alloc ( struct ehci_device *ehci,
 
 	/* Initialise structure */
 	memset ( ring, 0, sizeof ( *ring ) );
+	assert ( ( count & ( count - 1 ) ) == 0 );
+	ring->count = count;
 
 	/* Allocate I/O buffers */
-	ring->iobuf = zalloc ( EHCI_RING_COUNT * sizeof ( ring->iobuf[0] ) );
+	ring->iobuf = zalloc ( count * sizeof ( ring->iobuf[0] ) );
 	if ( ! ring->iobuf ) {
 		rc = -ENOMEM;
 		goto err_alloc_iobuf;
@@ -578,7 +581,7 @@ static int ehci_ring_alloc ( struct ehci_device *ehci,
 	memset ( ring->head, 0, sizeof ( *ring->head ) );
 
 	/* Allocate transfer descriptors */
-	len = ( EHCI_RING_COUNT * sizeof ( ring->desc[0] ) );
+	len = ( count * sizeof ( ring->desc[0] ) );
 	ring->desc = malloc_dma ( len, sizeof ( ring->desc[0] ) );
 	if ( ! ring->desc ) {
 		rc = -ENOMEM;
@@ -587,14 +590,14 @@ static int ehci_ring_alloc ( struct ehci_device *ehci,
 	memset ( ring->desc, 0, len );
 
 	/* Initialise transfer descriptors */
-	for ( i = 0 ; i < EHCI_RING_COUNT ; i++ ) {
+	for ( i = 0 ; i < count ; i++ ) {
 		desc = &ring->desc[i];
 		if ( ( rc = ehci_ctrl_reachable ( ehci, desc ) ) != 0 ) {
 			DBGC ( ehci, "EHCI %s descriptor unreachable\n",
 			       ehci->name );
 			goto err_unreachable_desc;
 		}
-		next = &ring->desc[ ( i + 1 ) % EHCI_RING_COUNT ];
+		next = &ring->desc[ ( i + 1 ) % count ];
 		link = virt_to_phys ( next );
 		desc->next = cpu_to_le32 ( link );
 		desc->alt = cpu_to_le32 ( link );
@@ -627,11 +630,11 @@ static void ehci_ring_free ( struct ehci_ring *ring ) {
 
 	/* Sanity checks */
 	assert ( ehci_ring_fill ( ring ) == 0 );
-	for ( i = 0 ; i < EHCI_RING_COUNT ; i++ )
+	for ( i = 0 ; i < ring->count ; i++ )
 		assert ( ring->iobuf[i] == NULL );
 
 	/* Free transfer descriptors */
-	free_dma ( ring->desc, ( EHCI_RING_COUNT * sizeof ( ring->desc[0] ) ) );
+	free_dma ( ring->desc, ( ring->count * sizeof ( ring->desc[0] ) ) );
 
 	/* Free queue head */
 	free_dma ( ring->head, sizeof ( *ring->head ) );
@@ -685,7 +688,7 @@ static int ehci_enqueue ( struct ehci_device *ehci, struct ehci_ring *ring,
 	for ( ; count ; ring->prod++, xfer++ ) {
 
 		/* Populate descriptor header */
-		index = ( ring->prod % EHCI_RING_COUNT );
+		index = ( ring->prod % ring->count );
 		desc = &ring->desc[index];
 		toggle = ( xfer->flags & EHCI_FL_TOGGLE );
 		assert ( xfer->len <= EHCI_LEN_MASK );
@@ -743,7 +746,7 @@ static int ehci_enqueue ( struct ehci_device *ehci, struct ehci_ring *ring,
 static struct io_buffer * ehci_dequeue ( struct ehci_ring *ring ) {
 	struct ehci_transfer_descriptor *desc;
 	struct io_buffer *iobuf;
-	unsigned int index = ( ring->cons % EHCI_RING_COUNT );
+	unsigned int index = ( ring->cons % ring->count );
 
 	/* Sanity check */
 	assert ( ehci_ring_fill ( ring ) > 0 );
@@ -1118,6 +1121,7 @@ static int ehci_endpoint_open ( struct usb_endpoint *ep ) {
 	struct usb_device *usb = ep->usb;
 	struct ehci_device *ehci = usb_get_hostdata ( usb );
 	struct ehci_endpoint *endpoint;
+	unsigned int count;
 	int rc;
 
 	/* Allocate and initialise structure */
@@ -1130,8 +1134,21 @@ static int ehci_endpoint_open ( struct usb_endpoint *ep ) {
 	endpoint->ep = ep;
 	usb_endpoint_set_hostdata ( ep, endpoint );
 
+	/* Size descriptor ring to accommodate at least twice the
+	 * endpoint's maximum fill level, if specified, rounded up to a
+	 * power of two.
+	 */
+	count = EHCI_RING_COUNT;
+	if ( ep->max ) {
+		count = ( 1 << fls ( ( ep->max * 2 ) - 1 ) );
+		if ( count < EHCI_RING_COUNT )
+			count = EHCI_RING_COUNT;
+		if ( count > EHCI_RING_COUNT_MAX )
+			count = EHCI_RING_COUNT_MAX;
+	}
+
 	/* Initialise descriptor ring */
-	if ( ( rc = ehci_ring_alloc ( ehci, &endpoint->ring ) ) != 0 )
+	if ( ( rc = ehci_ring_alloc ( ehci, &endpoint->ring, count ) ) != 0 )
 		goto err_ring_alloc;
 
 	/* Update queue characteristics and capabilities */
@@ -1214,7 +1231,7 @@ static int ehci_endpoint_reset ( struct usb_endpoint *ep ) {
 	cache->len = 0;
 
 	/* Prepare to restart at next unconsumed descriptor */
-	link = virt_to_phys ( &ring->desc[ ring->cons % EHCI_RING_COUNT ] );
+	link = virt_to_phys ( &ring->desc[ ring->cons % ring->count ] );
 	cache->next = cpu_to_le32 ( link );
 
 	/* Restart ring */
@@ -1387,7 +1404,7 @@ static void ehci_endpoint_poll ( struct ehci_endpoint *endpoint ) {
 
 		/* Stop if we reach an uncompleted descriptor */
 		rmb();
-		index = ( ring->cons % EHCI_RING_COUNT );
+		index = ( ring->cons % ring->count );
 		desc = &ring->desc[index];
 		status = desc->status;
 		if ( status & EHCI_STATUS_ACTIVE )
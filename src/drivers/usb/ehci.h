@@ -372,6 +372,9 @@ struct ehci_ring {
 	/** Consumer counter */
 	unsigned int cons;
 
+	/** Number of transfer descriptors (must be a power of two) */
+	unsigned int count;
+
 	/** Residual untransferred data */
 	size_t residual;
 
@@ -384,12 +387,18 @@ struct ehci_ring {
 	struct ehci_transfer_descriptor *desc;
 };
 
-/** Number of transfer descriptors in a ring
+/** Minimum number of transfer descriptors in a ring
  *
  * This is a policy decision.
  */
 #define EHCI_RING_COUNT 64
 
+/** Maximum number of transfer descriptors in a ring
+ *
+ * This is a policy decision.
+ */
+#define EHCI_RING_COUNT_MAX 256
+
 /**
  * Calculate space used in transfer descriptor ring
  *
@@ -401,7 +410,7 @@ ehci_ring_fill ( struct ehci_ring *ring ) {
 	unsigned int fill;
 
 	fill = ( ring->prod - ring->cons );
-	assert ( fill <= EHCI_RING_COUNT );
+	assert ( fill <= ring->count );
 	return fill;
 }
 
@@ -415,7 +424,7 @@ static inline __attribute__ (( always_inline )) unsigned int
 ehci_ring_remaining ( struct ehci_ring *ring ) {
 	unsigned int fill = ehci_ring_fill ( ring );
 
-	return ( EHCI_RING_COUNT - fill );
+	return ( ring->count - fill );
 }
 
 /** Time to delay after enabling power to a port
@@ -2343,12 +2343,26 @@ static int xhci_endpoint_open ( struct usb_endpoint *ep ) {
 	unsigned int ctx;
 	unsigned int type;
 	unsigned int interval;
+	unsigned int shift;
 	int rc;
 
 	/* Calculate context index */
 	ctx = XHCI_CTX ( ep->address );
 	assert ( slot->endpoint[ctx] == NULL );
 
+	/* Calculate transfer ring size, such that the ring can
+	 * accommodate at least twice the endpoint's maximum fill
+	 * level (allowing for transfers that span multiple TRBs).
+	 */
+	shift = XHCI_TRANSFER_TRBS_LOG2;
+	if ( ep->max ) {
+		shift = fls ( ( ep->max * 2 ) - 1 );
+		if ( shift < XHCI_TRANSFER_TRBS_LOG2 )
+			shift = XHCI_TRANSFER_TRBS_LOG2;
+		if ( shift > XHCI_TRANSFER_TRBS_LOG2_MAX )
+			shift = XHCI_TRANSFER_TRBS_LOG2_MAX;
+	}
+
 	/* Calculate endpoint type */
 	type = XHCI_EP_TYPE ( ep->attributes & USB_ENDPOINT_ATTR_TYPE_MASK );
 	if ( type == XHCI_EP_TYPE ( USB_ENDPOINT_ATTR_CONTROL ) )
@@ -2381,8 +2395,7 @@ static int xhci_endpoint_open ( struct usb_endpoint *ep ) {
 			      xhci_device_context_offset ( xhci, ctx ) );
 
 	/* Allocate transfer ring */
-	if ( ( rc = xhci_ring_alloc ( xhci, &endpoint->ring,
-				      XHCI_TRANSFER_TRBS_LOG2,
+	if ( ( rc = xhci_ring_alloc ( xhci, &endpoint->ring, shift,
 				      slot->id, ctx, 0 ) ) != 0 )
 		goto err_ring_alloc;
 
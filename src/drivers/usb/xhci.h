@@ -965,12 +965,19 @@ xhci_ring_consumed ( struct xhci_trb_ring *ring ) {
  */
 #define XHCI_EVENT_TRBS_LOG2 6
 
-/** Number of TRBs in a transfer ring
+/** Minimum number of TRBs in a transfer ring
  *
  * This is a policy decision.
  */
 #define XHCI_TRANSFER_TRBS_LOG2 6
 
+/** Maximum number of TRBs in a transfer ring
+ *
+ * Bounds the ring size calculated from an endpoint's maximum fill
+ * level.  This is a policy decision.
+ */
+#define XHCI_TRANSFER_TRBS_LOG2_MAX 9
+
 /** Maximum time to wait for BIOS to release ownership
  *
  * This is a policy decision.
@@ -156,10 +156,16 @@ static int ifclose_exec ( int argc, char **argv ) {
 }
 
 /** "ifstat" options */
-struct ifstat_options {};
+struct ifstat_options {
+	/** Show traffic rate history */
+	int history;
+};
 
 /** "ifstat" option list */
-static struct option_descriptor ifstat_opts[] = {};
+static struct option_descriptor ifstat_opts[] = {
+	OPTION_DESC ( "history", 'H', no_argument,
+		      struct ifstat_options, history, parse_flag ),
+};
 
 /**
  * "ifstat" payload
@@ -169,8 +175,12 @@ static struct option_descriptor ifstat_opts[] = {};
  * @ret rc		Return status code
  */
 static int ifstat_payload ( struct net_device *netdev,
-			    struct ifstat_options *opts __unused ) {
-	ifstat ( netdev );
+			    struct ifstat_options *opts ) {
+	if ( opts->history ) {
+		ifstat_history ( netdev );
+	} else {
+		ifstat ( netdev );
+	}
 	return 0;
 }
 
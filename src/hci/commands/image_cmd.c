@@ -50,6 +50,8 @@ struct imgsingle_options {
 	int replace;
 	/** Free image after execution */
 	int autofree;
+	/** Download in the background */
+	int background;
 };
 
 /** "img{single}" option list */
@@ -125,9 +127,14 @@ static int imgsingle_exec ( int argc, char **argv,
 
 	/* Acquire the image */
 	if ( name_uri ) {
-		if ( ( rc = desc->acquire ( name_uri, opts.timeout,
-					    &image ) ) != 0 )
+		if ( opts.background ) {
+			if ( ( rc = imgdownload_bg_string ( name_uri,
+							    &image ) ) != 0 )
+				goto err_acquire;
+		} else if ( ( rc = desc->acquire ( name_uri, opts.timeout,
+						   &image ) ) != 0 ) {
 			goto err_acquire;
+		}
 	} else {
 		image = image_find_selected();
 		if ( ! image ) {
@@ -184,9 +191,21 @@ static int imgsingle_exec ( int argc, char **argv,
 	return rc;
 }
 
+/** "imgfetch" option list */
+static struct option_descriptor imgfetch_opts[] = {
+	OPTION_DESC ( "name", 'n', required_argument,
+		      struct imgsingle_options, name, parse_string ),
+	OPTION_DESC ( "timeout", 't', required_argument,
+		      struct imgsingle_options, timeout, parse_timeout ),
+	OPTION_DESC ( "autofree", 'a', no_argument,
+		      struct imgsingle_options, autofree, parse_flag ),
+	OPTION_DESC ( "background", 'b', no_argument,
+		      struct imgsingle_options, background, parse_flag ),
+};
+
 /** "imgfetch" command descriptor */
 static struct command_descriptor imgfetch_cmd =
-	COMMAND_DESC ( struct imgsingle_options, opts.imgsingle,
+	COMMAND_DESC ( struct imgsingle_options, imgfetch_opts,
 		       1, MAX_ARGUMENTS, "<uri> [<arguments>...]" );
 
 /** "imgfetch" family command descriptor */
@@ -392,6 +411,41 @@ static int imgfree_exec ( int argc, char **argv ) {
 	return imgmulti_exec ( argc, argv, unregister_image );
 }
 
+/** "imgwait" options */
+struct imgwait_options {
+	/** Timeout */
+	unsigned long timeout;
+};
+
+/** "imgwait" option list */
+static struct option_descriptor imgwait_opts[] = {
+	OPTION_DESC ( "timeout", 't', required_argument,
+		      struct imgwait_options, timeout, parse_timeout ),
+};
+
+/** "imgwait" command descriptor */
+static struct command_descriptor imgwait_cmd =
+	COMMAND_DESC ( struct imgwait_options, imgwait_opts, 0, 0, NULL );
+
+/**
+ * The "imgwait" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int imgwait_exec ( int argc, char **argv ) {
+	struct imgwait_options opts;
+	int rc;
+
+	/* Parse options */
+	if ( ( rc = parse_options ( argc, argv, &imgwait_cmd, &opts ) ) != 0 )
+		return rc;
+
+	/* Wait for all background downloads to complete */
+	return imgwait ( opts.timeout );
+}
+
 /** Image management commands */
 struct command image_commands[] __command = {
 	{
@@ -442,4 +496,8 @@ struct command image_commands[] __command = {
 		.name = "imgfree",
 		.exec = imgfree_exec,
 	},
+	{
+		.name = "imgwait",
+		.exec = imgwait_exec,
+	},
 };
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <getopt.h>
+#include <ipxe/command.h>
+#include <ipxe/parseopt.h>
+#include <ipxe/milestone.h>
+
+/** @file
+ *
+ * Boot milestone commands
+ *
+ */
+
+/** "milestones" options */
+struct milestones_options {
+	/** Export to system log */
+	int export;
+};
+
+/** "milestones" option list */
+static struct option_descriptor milestones_opts[] = {
+	OPTION_DESC ( "export", 'e', no_argument,
+		      struct milestones_options, export, parse_flag ),
+};
+
+/** "milestones" command descriptor */
+static struct command_descriptor milestones_cmd =
+	COMMAND_DESC ( struct milestones_options, milestones_opts, 0, 0,
+		       NULL );
+
+/**
+ * The "milestones" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int milestones_exec ( int argc, char **argv ) {
+	struct milestones_options opts;
+	int rc;
+
+	/* Parse options */
+	if ( ( rc = parse_options ( argc, argv, &milestones_cmd,
+				    &opts ) ) != 0 )
+		return rc;
+
+	if ( opts.export ) {
+		milestones_export();
+	} else {
+		milestones_show();
+	}
+
+	return 0;
+}
+
+/** Boot milestone commands */
+struct command milestone_commands[] __command = {
+	{
+		.name = "milestones",
+		.exec = milestones_exec,
+	},
+};
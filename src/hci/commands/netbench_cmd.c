@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <ipxe/command.h>
+#include <ipxe/parseopt.h>
+#include <ipxe/timer.h>
+#include <usr/netbench.h>
+
+/** @file
+ *
+ * Network benchmark command
+ *
+ */
+
+/** Default port number */
+#define NETBENCH_DEFAULT_PORT 5001
+
+/** Default payload length
+ *
+ * Chosen to fill a standard Ethernet frame without fragmentation
+ * (1500 MTU minus IPv4 and UDP headers).
+ */
+#define NETBENCH_DEFAULT_LEN 1472
+
+/** Default benchmark duration */
+#define NETBENCH_DEFAULT_DURATION ( 10 * TICKS_PER_SEC )
+
+/** "netbench" options */
+struct netbench_options {
+	/** Port number */
+	unsigned int port;
+	/** Payload length */
+	unsigned int length;
+	/** Benchmark duration (in ticks) */
+	unsigned long duration;
+	/** Act as receive sink */
+	int rx;
+	/** Use TCP bulk transfer */
+	int tcp;
+};
+
+/** "netbench" option list */
+static struct option_descriptor netbench_opts[] = {
+	OPTION_DESC ( "port", 'p', required_argument,
+		      struct netbench_options, port, parse_integer ),
+	OPTION_DESC ( "length", 'l', required_argument,
+		      struct netbench_options, length, parse_integer ),
+	OPTION_DESC ( "duration", 'd', required_argument,
+		      struct netbench_options, duration, parse_timeout ),
+	OPTION_DESC ( "rx", 'r', no_argument,
+		      struct netbench_options, rx, parse_flag ),
+	OPTION_DESC ( "tcp", 't', no_argument,
+		      struct netbench_options, tcp, parse_flag ),
+};
+
+/** "netbench" command descriptor */
+static struct command_descriptor netbench_cmd =
+	COMMAND_DESC ( struct netbench_options, netbench_opts, 0, 1,
+		       "[--rx] [--tcp] [<host>]" );
+
+/**
+ * The "netbench" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int netbench_exec ( int argc, char **argv ) {
+	struct netbench_options opts;
+	const char *hostname;
+	int mode;
+	int rc;
+
+	/* Initialise options */
+	memset ( &opts, 0, sizeof ( opts ) );
+	opts.port = NETBENCH_DEFAULT_PORT;
+	opts.length = NETBENCH_DEFAULT_LEN;
+	opts.duration = NETBENCH_DEFAULT_DURATION;
+
+	/* Parse options */
+	if ( ( rc = reparse_options ( argc, argv, &netbench_cmd,
+				      &opts ) ) != 0 )
+		return rc;
+
+	/* Parse hostname, if present */
+	hostname = ( ( optind < argc ) ? argv[optind] : NULL );
+
+	/* Identify mode; transmit modes require a destination host */
+	if ( opts.rx ) {
+		mode = NETBENCH_UDP_RX;
+	} else if ( ! hostname ) {
+		return -EINVAL;
+	} else {
+		mode = ( opts.tcp ? NETBENCH_TCP_TX : NETBENCH_UDP_TX );
+	}
+
+	/* Run benchmark */
+	if ( ( rc = netbench ( mode, hostname, opts.port, opts.length,
+			       opts.duration ) ) != 0 )
+		return rc;
+
+	return 0;
+}
+
+/** Network benchmark command */
+struct command netbench_command __command = {
+	.name = "netbench",
+	.exec = netbench_exec,
+};
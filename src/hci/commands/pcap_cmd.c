@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Packet capture command
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <ipxe/command.h>
+#include <ipxe/parseopt.h>
+#include <ipxe/image.h>
+#include <ipxe/netdevice.h>
+#include <ipxe/pcap.h>
+
+/** "pcap" options */
+struct pcap_options {
+	/** Capture ring size (in bytes) */
+	unsigned int size;
+	/** Snap length per frame */
+	unsigned int snap;
+	/** Disarm capture */
+	int off;
+	/** Export image name */
+	char *export;
+	/** Replay image name */
+	char *replay;
+	/** Replay network device */
+	struct net_device *netdev;
+};
+
+/** "pcap" option list */
+static struct option_descriptor pcap_opts[] = {
+	OPTION_DESC ( "size", 'l', required_argument,
+		      struct pcap_options, size, parse_integer ),
+	OPTION_DESC ( "snap", 's', required_argument,
+		      struct pcap_options, snap, parse_integer ),
+	OPTION_DESC ( "off", 'o', no_argument,
+		      struct pcap_options, off, parse_flag ),
+	OPTION_DESC ( "export", 'x', required_argument,
+		      struct pcap_options, export, parse_string ),
+	OPTION_DESC ( "replay", 'r', required_argument,
+		      struct pcap_options, replay, parse_string ),
+	OPTION_DESC ( "interface", 'i', required_argument,
+		      struct pcap_options, netdev, parse_netdev ),
+};
+
+/** "pcap" command descriptor */
+static struct command_descriptor pcap_cmd =
+	COMMAND_DESC ( struct pcap_options, pcap_opts, 0, 0, NULL );
+
+/**
+ * "pcap" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int pcap_exec ( int argc, char **argv ) {
+	struct pcap_options opts;
+	struct image *image;
+	int rc;
+
+	/* Parse options */
+	if ( ( rc = parse_options ( argc, argv, &pcap_cmd, &opts ) ) != 0 )
+		return rc;
+
+	/* Replay capture, if applicable */
+	if ( opts.replay ) {
+		image = find_image ( opts.replay );
+		if ( ! image ) {
+			printf ( "\"%s\": no such image\n", opts.replay );
+			return -ENOENT;
+		}
+		if ( ! opts.netdev )
+			opts.netdev = last_opened_netdev();
+		if ( ! opts.netdev ) {
+			printf ( "No network device\n" );
+			return -ENODEV;
+		}
+		if ( ( rc = pcap_replay ( image, opts.netdev ) ) != 0 ) {
+			printf ( "Could not replay capture: %s\n",
+				 strerror ( rc ) );
+			return rc;
+		}
+		return 0;
+	}
+
+	/* Export capture, if applicable */
+	if ( opts.export ) {
+		if ( ( rc = pcap_export ( opts.export ) ) != 0 ) {
+			printf ( "Could not export capture: %s\n",
+				 strerror ( rc ) );
+			return rc;
+		}
+		return 0;
+	}
+
+	/* Disarm capture, if applicable */
+	if ( opts.off ) {
+		pcap_disarm();
+		return 0;
+	}
+
+	/* Otherwise, (re)arm capture */
+	if ( ! opts.size )
+		opts.size = PCAP_DEFAULT_LEN;
+	if ( ! opts.snap )
+		opts.snap = PCAP_DEFAULT_SNAP;
+	if ( ( rc = pcap_arm ( opts.size, opts.snap ) ) != 0 ) {
+		printf ( "Could not arm capture: %s\n", strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
+
+/** Packet capture command */
+struct command pcap_commands[] __command = {
+	{
+		.name = "pcap",
+		.exec = pcap_exec,
+	},
+};
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <ipxe/command.h>
+#include <ipxe/parseopt.h>
+#include <ipxe/uri.h>
+#include <ipxe/http.h>
+
+/** @file
+ *
+ * Preconnect command
+ *
+ */
+
+/** Default number of connections to open */
+#define PRECONN_DEFAULT_COUNT 1
+
+/** "preconn" options */
+struct preconn_options {
+	/** Number of connections to open */
+	unsigned int count;
+};
+
+/** "preconn" option list */
+static struct option_descriptor preconn_opts[] = {
+	OPTION_DESC ( "count", 'c', required_argument,
+		      struct preconn_options, count, parse_integer ),
+};
+
+/** "preconn" command descriptor */
+static struct command_descriptor preconn_cmd =
+	COMMAND_DESC ( struct preconn_options, preconn_opts, 1, 1, "<uri>" );
+
+/**
+ * The "preconn" command
+ *
+ * Opens and handshakes pooled connections to an HTTP(S) origin in
+ * the background, so that subsequent fetches from the same origin
+ * start without paying connection setup latency.
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int preconn_exec ( int argc, char **argv ) {
+	struct preconn_options opts;
+	struct uri *uri;
+	int rc;
+
+	/* Initialise options */
+	memset ( &opts, 0, sizeof ( opts ) );
+	opts.count = PRECONN_DEFAULT_COUNT;
+
+	/* Parse options */
+	if ( ( rc = parse_options ( argc, argv, &preconn_cmd, &opts ) ) != 0 )
+		goto err_parse_options;
+
+	/* Parse URI */
+	uri = parse_uri ( argv[optind] );
+	if ( ! uri ) {
+		rc = -ENOMEM;
+		goto err_parse_uri;
+	}
+
+	/* Initiate connections */
+	if ( ( rc = http_preconnect ( uri, opts.count ) ) != 0 )
+		goto err_preconnect;
+
+ err_preconnect:
+	uri_put ( uri );
+ err_parse_uri:
+ err_parse_options:
+	return rc;
+}
+
+/** Preconnect command */
+struct command preconn_commands[] __command = {
+	{
+		.name = "preconn",
+		.exec = preconn_exec,
+	},
+};
@@ -24,9 +24,11 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdio.h>
+#include <string.h>
 #include <getopt.h>
 #include <ipxe/command.h>
 #include <ipxe/parseopt.h>
+#include <ipxe/profile.h>
 #include <usr/profstat.h>
 
 /** @file
@@ -36,10 +38,20 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 
 /** "profstat" options */
-struct profstat_options {};
+struct profstat_options {
+	/** Export to system log */
+	int export;
+	/** Enable performance counter sampling */
+	int pmc;
+};
 
 /** "profstat" option list */
-static struct option_descriptor profstat_opts[] = {};
+static struct option_descriptor profstat_opts[] = {
+	OPTION_DESC ( "export", 'e', no_argument,
+		      struct profstat_options, export, parse_flag ),
+	OPTION_DESC ( "pmc", 'p', no_argument,
+		      struct profstat_options, pmc, parse_flag ),
+};
 
 /** "profstat" command descriptor */
 static struct command_descriptor profstat_cmd =
@@ -60,7 +72,21 @@ static int profstat_exec ( int argc, char **argv ) {
 	if ( ( rc = parse_options ( argc, argv, &profstat_cmd, &opts ) ) != 0 )
 		return rc;
 
-	profstat();
+	/* Enable performance counter sampling, if applicable and
+	 * supported by this architecture.
+	 */
+	if ( opts.pmc && PROFILE_PMC &&
+	     ( ( rc = profile_pmc_enable() ) != 0 ) ) {
+		printf ( "Could not enable performance counter: %s\n",
+			 strerror ( rc ) );
+		return rc;
+	}
+
+	if ( opts.export ) {
+		profstat_export();
+	} else {
+		profstat();
+	}
 
 	return 0;
 }
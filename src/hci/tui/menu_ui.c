@@ -143,6 +143,50 @@ static void draw_menu_item ( struct menu_ui *ui, unsigned int index ) {
 	move ( ( MENU_ROW + row_offset ), MENU_COL );
 }
 
+/**
+ * Draw timeout indicator on the selected menu item
+ *
+ * @v ui		Menu user interface
+ *
+ * Re-emits only the countdown field within the selected row, rather
+ * than the whole row, so that a timer tick over a slow console (e.g.
+ * serial) transmits just a handful of characters.
+ */
+static void draw_menu_timeout ( struct menu_ui *ui ) {
+	unsigned int row_offset;
+	char timeout_buf[6]; /* "(xxx)" + NUL */
+	char field[ sizeof ( timeout_buf ) ];
+	size_t timeout_len;
+
+	/* Construct right-aligned countdown field.  The field is
+	 * blank when no timeout remains, erasing any previous
+	 * indicator.
+	 */
+	memset ( field, ' ', ( sizeof ( field ) - 1 ) );
+	field[ sizeof ( field ) - 1 ] = '\0';
+	if ( ui->timeout != 0 ) {
+		timeout_len =
+			snprintf ( timeout_buf, sizeof ( timeout_buf ), "(%ld)",
+				   ( ( ui->timeout + TICKS_PER_SEC - 1 ) /
+				     TICKS_PER_SEC ) );
+		memcpy ( &field[ sizeof ( field ) - 1 - timeout_len ],
+			 timeout_buf, timeout_len );
+	}
+
+	/* Draw field using the selected item's attributes */
+	row_offset = ( ui->scroll.current - ui->scroll.first );
+	color_set ( CPAIR_SELECT, NULL );
+	attron ( A_BOLD );
+	mvprintw ( ( MENU_ROW + row_offset ),
+		   ( MENU_COL + MENU_COLS - MENU_PAD -
+		     ( sizeof ( field ) - 1 ) ), "%s", field );
+	color_set ( CPAIR_NORMAL, NULL );
+	attroff ( A_BOLD );
+
+	/* Move cursor back to start of row */
+	move ( ( MENU_ROW + row_offset ), MENU_COL );
+}
+
 /**
  * Draw the current block of menu items
  *
@@ -243,12 +287,20 @@ static int menu_loop ( struct menu_ui *ui, struct menu_item **selected ) {
 				break;
 		}
 
-		/* Redraw selection if necessary */
-		if ( ( ui->scroll.current != previous ) || ( timeout != 0 ) ) {
-			draw_menu_item ( ui, previous );
-			if ( jump_scroll ( &ui->scroll ) )
+		/* Redraw changed rows only.  A change of selection
+		 * redraws the old and new selections (or the whole
+		 * block, if scrolling occurred); a timer tick alone
+		 * updates just the countdown field.
+		 */
+		if ( ui->scroll.current != previous ) {
+			if ( jump_scroll ( &ui->scroll ) ) {
 				draw_menu_items ( ui );
-			draw_menu_item ( ui, ui->scroll.current );
+			} else {
+				draw_menu_item ( ui, previous );
+				draw_menu_item ( ui, ui->scroll.current );
+			}
+		} else if ( timeout != 0 ) {
+			draw_menu_timeout ( ui );
 		}
 
 		/* Record selection */
@@ -197,6 +197,15 @@ int elf_segments ( struct image *image, Elf_Ehdr *ehdr,
  * @ret entry		Entry point
  * @ret max		Maximum used address
  * @ret rc		Return status code
+ *
+ * Loading is deliberately deferred until boot time, rather than
+ * streaming segments into their load addresses as the file downloads:
+ * the image format is not even probed until the download completes,
+ * the downloaded image may never be selected for booting, and the
+ * physical load addresses are dictated by (unverified) program
+ * headers and may overlap memory that is still in use.  The deferred
+ * load costs only a single memcpy() per PT_LOAD segment, with just
+ * the bss portion zeroed separately.
  */
 int elf_load ( struct image *image, physaddr_t *entry, physaddr_t *max ) {
 	static const uint8_t e_ident[] = {
@@ -9,8 +9,13 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <byteswap.h>
 #include <ipxe/image.h>
 #include <ipxe/uaccess.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/deflate.h>
 #include <ipxe/init.h>
 
 /* Raw image data for all embedded images */
@@ -40,6 +45,77 @@ static struct image embedded_images[] = {
 	EMBED_ALL
 };
 
+#ifdef EMBED_COMPRESSED
+
+/**
+ * Decompress embedded image
+ *
+ * @v image		Embedded image
+ * @ret rc		Return status code
+ *
+ * Compressed embedded images (as produced by util/zembed.pl) comprise
+ * a 4-byte little-endian uncompressed length followed by a raw
+ * DEFLATE stream.
+ */
+static int embedded_decompress ( struct image *image ) {
+	struct deflate *deflate;
+	struct deflate_chunk in;
+	struct deflate_chunk out;
+	uint32_t len;
+	userptr_t data;
+	int rc;
+
+	/* Parse uncompressed length */
+	if ( image->len < sizeof ( len ) ) {
+		rc = -EINVAL;
+		goto err_len;
+	}
+	copy_from_user ( &len, image->data, 0, sizeof ( len ) );
+	len = le32_to_cpu ( len );
+
+	/* Allocate buffer for uncompressed image */
+	data = umalloc ( len );
+	if ( ! data ) {
+		rc = -ENOMEM;
+		goto err_umalloc;
+	}
+
+	/* Decompress image */
+	deflate = zalloc ( sizeof ( *deflate ) );
+	if ( ! deflate ) {
+		rc = -ENOMEM;
+		goto err_deflate;
+	}
+	deflate_init ( deflate, DEFLATE_RAW );
+	deflate_chunk_init ( &in, image->data, sizeof ( len ), image->len );
+	deflate_chunk_init ( &out, data, 0, len );
+	if ( ( rc = deflate_inflate ( deflate, &in, &out ) ) != 0 )
+		goto err_inflate;
+	if ( ! deflate_finished ( deflate ) ) {
+		rc = -EINVAL;
+		goto err_inflate;
+	}
+	free ( deflate );
+
+	/* Replace image data.  The embedded image structure is
+	 * static, so the decompressed buffer is never freed.
+	 */
+	image->data = data;
+	image->len = len;
+
+	return 0;
+
+ err_inflate:
+	free ( deflate );
+ err_deflate:
+	ufree ( data );
+ err_umalloc:
+ err_len:
+	return rc;
+}
+
+#endif /* EMBED_COMPRESSED */
+
 /**
  * Register all embedded images
  */
@@ -66,6 +142,15 @@ static void embedded_init ( void ) {
 		data = ( ( void * ) image->data );
 		image->data = virt_to_user ( data );
 
+#ifdef EMBED_COMPRESSED
+		/* Decompress image */
+		if ( ( rc = embedded_decompress ( image ) ) != 0 ) {
+			DBG ( "Could not decompress embedded image \"%s\": "
+			      "%s\n", image->name, strerror ( rc ) );
+			return;
+		}
+#endif
+
 		DBG ( "Embedded image \"%s\": %zd bytes at %p\n",
 		      image->name, image->len, data );
 
@@ -352,71 +352,71 @@ static int png_image_data ( struct image *image, struct png_context *png,
 }
 
 /**
- * Unfilter byte using the "None" filter
+ * Unfilter scanline using the "None" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v row		Scanline data (excluding filter byte)
+ * @v prev		Unfiltered previous scanline data
+ * @v len		Scanline length (excluding filter byte)
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_none ( unsigned int current,
-					unsigned int left __unused,
-					unsigned int above __unused,
-					unsigned int above_left __unused ) {
+static void png_unfilter_none ( uint8_t *row __unused,
+				const uint8_t *prev __unused,
+				size_t len __unused,
+				size_t pixel_len __unused ) {
 
-	return current;
+	/* Nothing to do */
 }
 
 /**
- * Unfilter byte using the "Sub" filter
+ * Unfilter scanline using the "Sub" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v row		Scanline data (excluding filter byte)
+ * @v prev		Unfiltered previous scanline data
+ * @v len		Scanline length (excluding filter byte)
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_sub ( unsigned int current,
-				       unsigned int left,
-				       unsigned int above __unused,
-				       unsigned int above_left __unused ) {
+static void png_unfilter_sub ( uint8_t *row, const uint8_t *prev __unused,
+			       size_t len, size_t pixel_len ) {
+	size_t byte;
 
-	return ( current + left );
+	for ( byte = pixel_len ; byte < len ; byte++ )
+		row[byte] += row[ byte - pixel_len ];
 }
 
 /**
- * Unfilter byte using the "Up" filter
+ * Unfilter scanline using the "Up" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v row		Scanline data (excluding filter byte)
+ * @v prev		Unfiltered previous scanline data
+ * @v len		Scanline length (excluding filter byte)
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_up ( unsigned int current,
-				      unsigned int left __unused,
-				      unsigned int above,
-				      unsigned int above_left __unused ) {
+static void png_unfilter_up ( uint8_t *row, const uint8_t *prev,
+			      size_t len, size_t pixel_len __unused ) {
+	size_t byte;
 
-	return ( current + above );
+	for ( byte = 0 ; byte < len ; byte++ )
+		row[byte] += prev[byte];
 }
 
 /**
- * Unfilter byte using the "Average" filter
+ * Unfilter scanline using the "Average" filter
  *
- * @v current		Filtered current byte
- * @v left		Unfiltered left byte
- * @v above		Unfiltered above byte
- * @v above_left	Unfiltered above-left byte
- * @ret current		Unfiltered current byte
+ * @v row		Scanline data (excluding filter byte)
+ * @v prev		Unfiltered previous scanline data
+ * @v len		Scanline length (excluding filter byte)
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_average ( unsigned int current,
-					   unsigned int left,
-					   unsigned int above,
-					   unsigned int above_left __unused ) {
-
-	return ( current + ( ( above + left ) >> 1 ) );
+static void png_unfilter_average ( uint8_t *row, const uint8_t *prev,
+				   size_t len, size_t pixel_len ) {
+	unsigned int left;
+	size_t byte;
+
+	for ( byte = 0 ; byte < len ; byte++ ) {
+		left = ( ( byte >= pixel_len ) ?
+			 row[ byte - pixel_len ] : 0 );
+		row[byte] += ( ( left + prev[byte] ) >> 1 );
+	}
 }
 
 /**
@@ -449,37 +449,44 @@ static unsigned int png_paeth_predictor ( unsigned int a, unsigned int b,
 }
 
 /**
- * Unfilter byte using the "Paeth" filter
+ * Unfilter scanline using the "Paeth" filter
  *
- * @v current		Filtered current byte
- * @v above_left	Unfiltered above-left byte
- * @v above		Unfiltered above byte
- * @v left		Unfiltered left byte
- * @ret current		Unfiltered current byte
+ * @v row		Scanline data (excluding filter byte)
+ * @v prev		Unfiltered previous scanline data
+ * @v len		Scanline length (excluding filter byte)
+ * @v pixel_len		Pixel length
  */
-static unsigned int png_unfilter_paeth ( unsigned int current,
-					 unsigned int left,
-					 unsigned int above,
-					 unsigned int above_left ) {
-
-	return ( current + png_paeth_predictor ( left, above, above_left ) );
+static void png_unfilter_paeth ( uint8_t *row, const uint8_t *prev,
+				 size_t len, size_t pixel_len ) {
+	unsigned int left;
+	unsigned int above_left;
+	size_t byte;
+
+	for ( byte = 0 ; byte < len ; byte++ ) {
+		if ( byte >= pixel_len ) {
+			left = row[ byte - pixel_len ];
+			above_left = prev[ byte - pixel_len ];
+		} else {
+			left = 0;
+			above_left = 0;
+		}
+		row[byte] += png_paeth_predictor ( left, prev[byte],
+						   above_left );
+	}
 }
 
 /** A PNG filter */
 struct png_filter {
 	/**
-	 * Unfilter byte
+	 * Unfilter scanline
 	 *
-	 * @v current		Filtered current byte
-	 * @v left		Unfiltered left byte
-	 * @v above		Unfiltered above byte
-	 * @v above_left	Unfiltered above-left byte
-	 * @ret current		Unfiltered current byte
+	 * @v row		Scanline data (excluding filter byte)
+	 * @v prev		Unfiltered previous scanline data
+	 * @v len		Scanline length (excluding filter byte)
+	 * @v pixel_len		Pixel length
 	 */
-	unsigned int ( * unfilter ) ( unsigned int current,
-				      unsigned int left,
-				      unsigned int above,
-				      unsigned int above_left );
+	void ( * unfilter ) ( uint8_t *row, const uint8_t *prev, size_t len,
+			      size_t pixel_len );
 };
 
 /** PNG filter types */
@@ -507,19 +514,26 @@ static int png_unfilter_pass ( struct image *image, struct png_context *png,
 	size_t offset = png->raw.offset;
 	size_t pixel_len = png_pixel_len ( png );
 	size_t scanline_len = png_scanline_len ( png, interlace );
+	size_t row_len = ( scanline_len - 1 /* filter byte */ );
 	struct png_filter *filter;
 	unsigned int scanline;
-	unsigned int byte;
 	uint8_t filter_type;
-	uint8_t left;
-	uint8_t above;
-	uint8_t above_left;
-	uint8_t current;
-
-	/* On the first scanline of a pass, above bytes are assumed to
-	 * be zero.
+	uint8_t *rows;
+	uint8_t *row;
+	uint8_t *prev;
+	uint8_t *tmp;
+
+	/* Allocate scanline buffers.  Unfiltering a whole scanline at
+	 * a time requires only two bulk copies per scanline, rather
+	 * than several accesses per byte.  On the first scanline of a
+	 * pass, all above bytes are taken to be zero; this is provided
+	 * by the zeroed initial previous scanline.
 	 */
-	above = 0;
+	rows = zalloc ( 2 * row_len );
+	if ( ! rows )
+		return -ENOMEM;
+	prev = rows;
+	row = ( rows + row_len );
 
 	/* Iterate over each scanline in turn */
 	for ( scanline = 0 ; scanline < interlace->height ; scanline++ ) {
@@ -531,6 +545,7 @@ static int png_unfilter_pass ( struct image *image, struct png_context *png,
 				      sizeof ( png_filters[0] ) ) ) {
 			DBGC ( image, "PNG %s unknown filter type %d\n",
 			       image->name, filter_type );
+			free ( rows );
 			return -ENOTSUP;
 		}
 		filter = &png_filters[filter_type];
@@ -538,43 +553,21 @@ static int png_unfilter_pass ( struct image *image, struct png_context *png,
 		DBGC2 ( image, "PNG %s pass %d scanline %d filter type %d\n",
 			image->name, interlace->pass, scanline, filter_type );
 
-		/* At the start of a line, both above-left and left
-		 * bytes are taken to be zero.
-		 */
-		left = 0;
-		above_left = 0;
+		/* Unfilter scanline */
+		copy_from_user ( row, png->raw.data, offset, row_len );
+		filter->unfilter ( row, prev, row_len, pixel_len );
+		copy_to_user ( png->raw.data, offset, row, row_len );
+		offset += row_len;
 
-		/* Iterate over each byte (not pixel) in turn */
-		for ( byte = 0 ; byte < ( scanline_len - 1 ) ; byte++ ) {
-
-			/* Extract predictor bytes, if applicable */
-			if ( byte >= pixel_len ) {
-				copy_from_user ( &left, png->raw.data,
-						 ( offset - pixel_len ),
-						 sizeof ( left ) );
-			}
-			if ( scanline > 0 ) {
-				copy_from_user ( &above, png->raw.data,
-						 ( offset - scanline_len ),
-						 sizeof ( above ) );
-			}
-			if ( ( scanline > 0 ) && ( byte >= pixel_len ) ) {
-				copy_from_user ( &above_left, png->raw.data,
-						 ( offset - scanline_len -
-						   pixel_len ),
-						 sizeof ( above_left ) );
-			}
-
-			/* Unfilter current byte */
-			copy_from_user ( &current, png->raw.data,
-					 offset, sizeof ( current ) );
-			current = filter->unfilter ( current, left, above,
-						     above_left );
-			copy_to_user ( png->raw.data, offset++,
-				       &current, sizeof ( current ) );
-		}
+		/* Current scanline becomes the previous scanline */
+		tmp = prev;
+		prev = row;
+		row = tmp;
 	}
 
+	/* Free scanline buffers */
+	free ( rows );
+
 	/* Update offset */
 	png->raw.offset = offset;
 
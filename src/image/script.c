@@ -50,6 +50,30 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 static size_t script_offset;
 
+/** A script label */
+struct script_label {
+	/** Label name */
+	char *label;
+	/** Offset of the labelled line within the script */
+	size_t offset;
+};
+
+/** A script label index */
+struct script_label_index {
+	/** Labels */
+	struct script_label *labels;
+	/** Number of labels */
+	unsigned int count;
+};
+
+/** Label index for the current script
+ *
+ * This is a global (saved and restored across nested script
+ * execution, as with the script offset) in order to allow goto_exec()
+ * to look up labels without rescanning the script.
+ */
+static struct script_label_index *script_labels;
+
 /**
  * Process script lines
  *
@@ -164,6 +188,57 @@ static int terminate_on_exit_or_failure ( int rc ) {
 		 ( rc != 0 ) );
 }
 
+/**
+ * Terminate script processing on failure
+ *
+ * @v rc		Line processing status
+ * @ret terminate	Terminate script processing
+ */
+static int terminate_on_failure ( int rc ) {
+
+	return ( rc != 0 );
+}
+
+/**
+ * Add script line to label index
+ *
+ * @v image		Script
+ * @v offset		Offset within script
+ * @v label		Label, or NULL
+ * @v command		Command
+ * @ret rc		Return status code
+ */
+static int script_index_line ( struct image *image, size_t offset,
+			       const char *label,
+			       const char *command __unused ) {
+	struct script_label *labels;
+	struct script_label *entry;
+	char *name;
+
+	/* Ignore lines without labels */
+	if ( ! label )
+		return 0;
+
+	/* Append label to index */
+	name = strdup ( label );
+	if ( ! name )
+		return -ENOMEM;
+	labels = realloc ( script_labels->labels,
+			   ( ( script_labels->count + 1 ) *
+			     sizeof ( *labels ) ) );
+	if ( ! labels ) {
+		free ( name );
+		return -ENOMEM;
+	}
+	script_labels->labels = labels;
+	entry = &labels[ script_labels->count++ ];
+	entry->label = name;
+	entry->offset = offset;
+	DBGC2 ( image, "[%04zx] indexed label :%s\n", offset, label );
+
+	return 0;
+}
+
 /**
  * Execute script line
  *
@@ -194,7 +269,10 @@ static int script_exec_line ( struct image *image, size_t offset,
  * @ret rc		Return status code
  */
 static int script_exec ( struct image *image ) {
+	struct script_label_index index;
+	struct script_label_index *saved_labels;
 	size_t saved_offset;
+	unsigned int i;
 	int rc;
 
 	/* Temporarily de-register image, so that a "boot" command
@@ -204,13 +282,28 @@ static int script_exec ( struct image *image ) {
 
 	/* Preserve state of any currently-running script */
 	saved_offset = script_offset;
+	saved_labels = script_labels;
+
+	/* Build label index.  Failure to build a complete index is not
+	 * fatal, since goto_exec() will fall back to scanning the
+	 * script for any label missing from the index.
+	 */
+	memset ( &index, 0, sizeof ( index ) );
+	script_labels = &index;
+	process_script ( image, script_index_line, terminate_on_failure );
 
 	/* Process script */
 	rc = process_script ( image, script_exec_line,
 			      terminate_on_exit_or_failure );
 
+	/* Free label index */
+	for ( i = 0 ; i < index.count ; i++ )
+		free ( index.labels[i].label );
+	free ( index.labels );
+
 	/* Restore saved state */
 	script_offset = saved_offset;
+	script_labels = saved_labels;
 
 	/* Re-register image (unless we have been replaced) */
 	if ( ! image->replacement )
@@ -321,7 +414,9 @@ static int terminate_on_label_found ( int rc ) {
  */
 static int goto_exec ( int argc, char **argv ) {
 	struct goto_options opts;
+	struct script_label *entry;
 	size_t saved_offset;
+	unsigned int i;
 	int rc;
 
 	/* Parse options */
@@ -338,7 +433,21 @@ static int goto_exec ( int argc, char **argv ) {
 	/* Parse label */
 	goto_label = argv[optind];
 
-	/* Find label */
+	/* Look up label in index, if available */
+	if ( script_labels ) {
+		for ( i = 0 ; i < script_labels->count ; i++ ) {
+			entry = &script_labels->labels[i];
+			if ( strcmp ( goto_label, entry->label ) == 0 ) {
+				script_offset = entry->offset;
+				DBGC ( current_image, "[%04zx] Gone to :%s\n",
+				       script_offset, goto_label );
+				shell_stop ( SHELL_STOP_COMMAND );
+				return 0;
+			}
+		}
+	}
+
+	/* Find label by scanning script */
 	saved_offset = script_offset;
 	if ( ( rc = process_script ( current_image, goto_find_label,
 				     terminate_on_label_found ) ) != 0 ) {
@@ -49,6 +49,145 @@ struct errortab segment_errors[] __errortab = {
 	__einfo_errortab ( EINFO_ERANGE_SEGMENT ),
 };
 
+/** Maximum number of claimed segment regions to record */
+#define SEGMENT_CLAIMS 8
+
+/** Cached copy of the system memory map, sorted by start address */
+static struct memory_map segment_memmap;
+
+/** Cached memory map is valid */
+static int segment_memmap_valid;
+
+/** Regions claimed by previously prepared segments */
+static struct memory_region segment_claims[SEGMENT_CLAIMS];
+
+/** Number of claimed regions */
+static unsigned int segment_claim_count;
+
+/**
+ * Invalidate cached memory map
+ *
+ * Must be called whenever the system memory map may have changed
+ * (e.g. when a region is edited out of the map to protect it from
+ * being overwritten).
+ */
+void segment_memmap_invalidate ( void ) {
+	segment_memmap_valid = 0;
+	segment_claim_count = 0;
+}
+
+/**
+ * Refresh cached memory map
+ *
+ * Fetching the memory map may be expensive (e.g. a series of
+ * real-mode INT 15 calls on a BIOS platform), so fetch it once and
+ * sort it for binary searching, rather than rescanning a fresh map
+ * for every segment of a multi-segment image.
+ */
+static void segment_memmap_refresh ( void ) {
+	struct memory_region *regions = segment_memmap.regions;
+	struct memory_region tmp;
+	unsigned int i;
+	unsigned int j;
+
+	/* Get a fresh memory map.  This allows us to automatically
+	 * avoid treading on any regions that Etherboot is currently
+	 * editing out of the memory map.
+	 */
+	get_memmap ( &segment_memmap );
+
+	/* Sort regions by start address (usually already sorted) */
+	for ( i = 1 ; i < segment_memmap.count ; i++ ) {
+		for ( j = i ; j > 0 ; j-- ) {
+			if ( regions[ j - 1 ].start <= regions[j].start )
+				break;
+			tmp = regions[ j - 1 ];
+			regions[ j - 1 ] = regions[j];
+			regions[j] = tmp;
+		}
+	}
+
+	/* Mark cached map as valid and forget stale claims */
+	segment_memmap_valid = 1;
+	segment_claim_count = 0;
+}
+
+/**
+ * Check that region lies within usable memory
+ *
+ * @v start		Region start address
+ * @v end		Region end address
+ * @ret usable		Region lies within a single usable memory region
+ */
+static int segment_usable ( physaddr_t start, physaddr_t end ) {
+	struct memory_region *region;
+	unsigned int low = 0;
+	unsigned int high = segment_memmap.count;
+	unsigned int mid;
+
+	/* Binary search for last region starting at or below start */
+	while ( low < high ) {
+		mid = ( ( low + high ) / 2 );
+		if ( segment_memmap.regions[mid].start <= start ) {
+			low = ( mid + 1 );
+		} else {
+			high = mid;
+		}
+	}
+	if ( low == 0 )
+		return 0;
+	region = &segment_memmap.regions[ low - 1 ];
+	return ( end <= region->end );
+}
+
+/**
+ * Check that region lies within an already-claimed segment
+ *
+ * @v start		Region start address
+ * @v end		Region end address
+ * @ret claimed		Region lies within a claimed segment region
+ */
+static int segment_claimed ( physaddr_t start, physaddr_t end ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < segment_claim_count ; i++ ) {
+		if ( ( start >= segment_claims[i].start ) &&
+		     ( end <= segment_claims[i].end ) )
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * Record claimed segment region
+ *
+ * @v start		Region start address
+ * @v end		Region end address
+ *
+ * The claim registry is a fast-path cache: adjacent or overlapping
+ * claims (e.g. consecutive ELF program headers) are merged, and
+ * claims are silently dropped if the registry is full.
+ */
+static void segment_claim ( physaddr_t start, physaddr_t end ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < segment_claim_count ; i++ ) {
+		if ( ( start <= segment_claims[i].end ) &&
+		     ( end >= segment_claims[i].start ) ) {
+			if ( start < segment_claims[i].start )
+				segment_claims[i].start = start;
+			if ( end > segment_claims[i].end )
+				segment_claims[i].end = end;
+			return;
+		}
+	}
+	if ( segment_claim_count < SEGMENT_CLAIMS ) {
+		segment_claims[segment_claim_count].start = start;
+		segment_claims[segment_claim_count].end = end;
+		segment_claim_count++;
+	}
+}
+
 /**
  * Prepare segment for loading
  *
@@ -58,11 +197,10 @@ struct errortab segment_errors[] __errortab = {
  * @ret rc		Return status code
  */
 int prep_segment ( userptr_t segment, size_t filesz, size_t memsz ) {
-	struct memory_map memmap;
 	physaddr_t start = user_to_phys ( segment, 0 );
 	physaddr_t mid = user_to_phys ( segment, filesz );
 	physaddr_t end = user_to_phys ( segment, memsz );
-	unsigned int i;
+	int refreshed = 0;
 
 	DBG ( "Preparing segment [%lx,%lx,%lx)\n", start, mid, end );
 
@@ -72,20 +210,29 @@ int prep_segment ( userptr_t segment, size_t filesz, size_t memsz ) {
 		return -EINVAL;
 	}
 
-	/* Get a fresh memory map.  This allows us to automatically
-	 * avoid treading on any regions that Etherboot is currently
-	 * editing out of the memory map.
-	 */
-	get_memmap ( &memmap );
+	/* Build cached memory map, if not already valid */
+	if ( ! segment_memmap_valid ) {
+		segment_memmap_refresh();
+		refreshed = 1;
+	}
 
-	/* Look for a suitable memory region */
-	for ( i = 0 ; i < memmap.count ; i++ ) {
-		if ( ( start >= memmap.regions[i].start ) &&
-		     ( end <= memmap.regions[i].end ) ) {
+	/* Look for a suitable memory region, refetching the memory
+	 * map once on failure in case the cached copy has become
+	 * stale in the conservative direction (i.e. omits memory that
+	 * has since become usable).
+	 */
+	while ( 1 ) {
+		if ( segment_claimed ( start, end ) ||
+		     segment_usable ( start, end ) ) {
 			/* Found valid region: zero bss and return */
+			segment_claim ( start, end );
 			memset_user ( segment, filesz, 0, ( memsz - filesz ) );
 			return 0;
 		}
+		if ( refreshed )
+			break;
+		segment_memmap_refresh();
+		refreshed = 1;
 	}
 
 	/* No suitable memory region found */
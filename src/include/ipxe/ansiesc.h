@@ -28,6 +28,8 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <stddef.h>
+
 struct ansiesc_context;
 
 /** A handler for an escape sequence */
@@ -133,5 +135,7 @@ struct ansiesc_context {
 /** @} */
 
 extern int ansiesc_process ( struct ansiesc_context *ctx, int c );
+extern size_t ansiesc_span ( struct ansiesc_context *ctx, const char *data,
+			     size_t len );
 
 #endif /* _IPXE_ANSIESC_H */
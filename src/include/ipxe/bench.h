@@ -0,0 +1,36 @@
+#ifndef _IPXE_BENCH_H
+#define _IPXE_BENCH_H
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Micro-benchmark infrastructure
+ *
+ */
+
+#include <stddef.h>
+#include <ipxe/tables.h>
+#include <ipxe/profile.h>
+
+/** A benchmark set */
+struct self_benchmark {
+	/** Benchmark set name */
+	const char *name;
+	/** Run benchmarks */
+	void ( * exec ) ( void );
+};
+
+/** Benchmark table */
+#define BENCHMARKS __table ( struct self_benchmark, "benchmarks" )
+
+/** Declare a benchmark set */
+#define __benchmark __table_entry ( BENCHMARKS, 01 )
+
+/** Number of samples per benchmark */
+#define BENCH_COUNT 32
+
+extern void bench_report ( const char *name, size_t len,
+			   struct profiler *profiler );
+
+#endif /* _IPXE_BENCH_H */
@@ -238,6 +238,14 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 			     size, exponent_size, tmp );		\
 	} while ( 0 )
 
+/** Modular exponentiation window size
+ *
+ * A larger window reduces the number of multiplications required per
+ * exponent bit, at the cost of a larger precomputed table of powers
+ * (and hence a larger temporary working space).
+ */
+#define BIGINT_MOD_EXP_WINDOW 4
+
 /**
  * Calculate temporary working space required for moduluar exponentiation
  *
@@ -253,6 +261,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 	sizeof ( struct {						\
 		bigint_t ( size ) temp_base;				\
 		bigint_t ( exponent_size ) temp_exponent;		\
+		bigint_t ( size ) temp_table[ 1 << BIGINT_MOD_EXP_WINDOW ];\
 		uint8_t mod_multiply[mod_multiply_len];			\
 	} ); } )
 
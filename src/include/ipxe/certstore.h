@@ -18,5 +18,6 @@ extern struct x509_certificate * certstore_find ( struct asn1_cursor *raw );
 extern struct x509_certificate * certstore_find_key ( struct asn1_cursor *key );
 extern void certstore_add ( struct x509_certificate *cert );
 extern void certstore_del ( struct x509_certificate *cert );
+extern void certstore_save ( void );
 
 #endif /* _IPXE_CERTSTORE_H */
@@ -0,0 +1,48 @@
+#ifndef _IPXE_CHACHA20_H
+#define _IPXE_CHACHA20_H
+
+/** @file
+ *
+ * ChaCha20 stream cipher
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/crypto.h>
+
+/** ChaCha20 key length */
+#define CHACHA20_KEY_LEN 32
+
+/** ChaCha20 nonce length */
+#define CHACHA20_NONCE_LEN 12
+
+/** ChaCha20 keystream block length */
+#define CHACHA20_BLOCK_LEN 64
+
+/** A ChaCha20 keystream block */
+union chacha20_block {
+	/** Viewed as an array of bytes */
+	uint8_t byte[CHACHA20_BLOCK_LEN];
+	/** Viewed as an array of 32-bit words */
+	uint32_t word[ CHACHA20_BLOCK_LEN / sizeof ( uint32_t ) ];
+};
+
+/** A ChaCha20 context */
+struct chacha20_context {
+	/** Input block state
+	 *
+	 * Comprises the four fixed constant words, the eight key
+	 * words, the block counter word, and the three nonce words.
+	 */
+	uint32_t state[16];
+	/** Current keystream block */
+	union chacha20_block keystream;
+	/** Offset within current keystream block */
+	size_t offset;
+};
+
+extern struct cipher_algorithm chacha20_algorithm;
+
+#endif /* _IPXE_CHACHA20_H */
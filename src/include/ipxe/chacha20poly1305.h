@@ -0,0 +1,33 @@
+#ifndef _IPXE_CHACHA20POLY1305_H
+#define _IPXE_CHACHA20POLY1305_H
+
+/** @file
+ *
+ * ChaCha20-Poly1305 authenticated encryption
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/crypto.h>
+#include <ipxe/chacha20.h>
+#include <ipxe/poly1305.h>
+
+/** A ChaCha20-Poly1305 context */
+struct chacha20poly1305_context {
+	/** ChaCha20 cipher context */
+	struct chacha20_context chacha;
+	/** Poly1305 authenticator context */
+	struct poly1305_context poly;
+	/** Implicit portion of nonce */
+	uint8_t fixed[CHACHA20_NONCE_LEN];
+	/** Accumulated length of additional authenticated data */
+	uint64_t aad_len;
+	/** Accumulated length of encrypted or decrypted data */
+	uint64_t data_len;
+};
+
+extern struct cipher_algorithm chacha20poly1305_algorithm;
+
+#endif /* _IPXE_CHACHA20POLY1305_H */
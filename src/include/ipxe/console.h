@@ -66,6 +66,18 @@ struct console_driver {
 	 * @v character		Character to be written
 	 */
 	void ( * putchar ) ( int character );
+	/**
+	 * Write a block of characters to the console
+	 *
+	 * @v data		Characters to be written
+	 * @v len		Length of block
+	 *
+	 * This is an optional method, used to write a block of
+	 * characters (guaranteed to contain no newlines) in a single
+	 * call.  Consoles that do not provide this method will
+	 * receive each character via putchar().
+	 */
+	void ( * putchars ) ( const char *data, size_t len );
 	/**
 	 * Read a character from the console
 	 *
@@ -0,0 +1,97 @@
+#ifndef _IPXE_COROUTINE_H
+#define _IPXE_COROUTINE_H
+
+/** @file
+ *
+ * Coroutines
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <setjmp.h>
+#include <ipxe/interface.h>
+#include <ipxe/process.h>
+#include <ipxe/refcnt.h>
+#include <bits/coroutine.h>
+
+/** Coroutine stack size
+ *
+ * This is a policy decision: it must be large enough to accommodate
+ * the deepest call chain made by any coroutine body (including debug
+ * message formatting).
+ */
+#define COROUTINE_STACK_LEN 8192
+
+/** A coroutine
+ *
+ * A coroutine executes on its own stack and may suspend itself at
+ * any point via coroutine_yield(), allowing code with multiple
+ * asynchronous steps to be written as a straight-line function
+ * rather than as an explicit state machine.
+ */
+struct coroutine {
+	/** Process used to schedule resumption */
+	struct process process;
+	/** Entry point */
+	void ( * entry ) ( struct coroutine *coro );
+	/** Stack (allocated on first resumption) */
+	void *stack;
+	/** Coroutine context (valid while suspended) */
+	jmp_buf ctx;
+	/** Resumer's context (valid while coroutine is running) */
+	jmp_buf caller;
+	/** Coroutine has completed */
+	int done;
+};
+
+/**
+ * Initialise coroutine
+ *
+ * @v coro		Coroutine
+ * @v entry		Entry point
+ */
+static inline __attribute__ (( always_inline )) void
+coroutine_init ( struct coroutine *coro,
+		 void ( * entry ) ( struct coroutine *coro ) ) {
+	coro->entry = entry;
+	coro->stack = NULL;
+	coro->done = 0;
+}
+
+/**
+ * Check if coroutine has completed
+ *
+ * @v coro		Coroutine
+ * @ret done		Coroutine has completed
+ */
+static inline __attribute__ (( always_inline )) int
+coroutine_done ( struct coroutine *coro ) {
+	return coro->done;
+}
+
+/** A coroutine awaitable operation
+ *
+ * This provides a job control interface that may be passed to any
+ * asynchronous operation, together with a record of that operation's
+ * completion.  It is typically placed on the coroutine's own stack;
+ * the coroutine must therefore not return before the operation has
+ * completed (i.e. before coroutine_await() has returned).
+ */
+struct coroutine_await {
+	/** Job control interface */
+	struct interface job;
+	/** Completion status */
+	int rc;
+	/** Operation has completed */
+	int done;
+};
+
+extern int coroutine_resume ( struct coroutine *coro );
+extern void coroutine_yield ( void );
+extern void coroutine_start ( struct coroutine *coro,
+			      struct refcnt *refcnt );
+extern void coroutine_await_init ( struct coroutine_await *await );
+extern int coroutine_await ( struct coroutine_await *await );
+
+#endif /* _IPXE_COROUTINE_H */
@@ -1,10 +1,18 @@
 #ifndef _IPXE_CRC32_H
 #define _IPXE_CRC32_H
 
+/** @file
+ *
+ * CRC32 (little-endian) checksums
+ *
+ */
+
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 
-u32 crc32_le ( u32 seed, const void *data, size_t len );
+extern u32 generic_crc32_le ( u32 seed, const void *data, size_t len );
+
+#include <bits/crc32.h>
 
 #endif
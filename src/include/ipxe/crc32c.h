@@ -0,0 +1,20 @@
+#ifndef _IPXE_CRC32C_H
+#define _IPXE_CRC32C_H
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksums
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <stddef.h>
+
+extern uint32_t generic_crc32c ( uint32_t seed, const void *data,
+				 size_t len );
+
+#include <bits/crc32c.h>
+
+#endif /* _IPXE_CRC32C_H */
@@ -19,6 +19,8 @@ enum deflate_format {
 	DEFLATE_RAW,
 	/** ZLIB header and footer */
 	DEFLATE_ZLIB,
+	/** GZIP header and footer */
+	DEFLATE_GZIP,
 };
 
 /** Block header length (in bits) */
@@ -74,9 +76,12 @@ enum deflate_format {
 
 /** Quick lookup length for a Huffman symbol (in bits)
  *
- * This is a policy decision.
+ * This is a policy decision.  Symbols no longer than this many bits
+ * are decoded with a single table lookup.  Ten bits cover almost all
+ * symbols found in typical dynamic Huffman alphabets, at a cost of a
+ * 1kB lookup table per alphabet.
  */
-#define DEFLATE_HUFFMAN_QL_BITS 7
+#define DEFLATE_HUFFMAN_QL_BITS 10
 
 /** Quick lookup shift */
 #define DEFLATE_HUFFMAN_QL_SHIFT ( 16 - DEFLATE_HUFFMAN_QL_BITS )
@@ -111,6 +116,56 @@ enum deflate_format {
 /** ZLIB ADLER32 length (in bits) */
 #define ZLIB_ADLER32_BITS 32
 
+/** GZIP magic length (in bits) */
+#define GZIP_MAGIC_BITS 16
+
+/** GZIP magic value */
+#define GZIP_MAGIC 0x8b1f
+
+/** GZIP compression method and flags length (in bits) */
+#define GZIP_CM_FLG_BITS 16
+
+/** GZIP compression method LSB */
+#define GZIP_CM_LSB 0
+
+/** GZIP compression method mask */
+#define GZIP_CM_MASK 0xff
+
+/** GZIP compression method: DEFLATE */
+#define GZIP_CM_DEFLATE 8
+
+/** GZIP flags LSB */
+#define GZIP_FLG_LSB 8
+
+/** GZIP header CRC flag */
+#define GZIP_FLG_FHCRC 0x02
+
+/** GZIP extra field flag */
+#define GZIP_FLG_FEXTRA 0x04
+
+/** GZIP file name flag */
+#define GZIP_FLG_FNAME 0x08
+
+/** GZIP file comment flag */
+#define GZIP_FLG_FCOMMENT 0x10
+
+/** GZIP reserved flags mask */
+#define GZIP_FLG_RESERVED 0xe0
+
+/** GZIP modification time, extra flags and operating system length
+ * (in bytes)
+ */
+#define GZIP_MTIME_XFL_OS_LEN 6
+
+/** GZIP extra field length length (in bits) */
+#define GZIP_XLEN_BITS 16
+
+/** GZIP header CRC length (in bits) */
+#define GZIP_FHCRC_BITS 16
+
+/** GZIP CRC32 and uncompressed size length (in bytes) */
+#define GZIP_FOOTER_LEN 8
+
 /** A Huffman-coded set of symbols of a given length */
 struct deflate_huf_symbols {
 	/** Length of Huffman-coded symbols */
@@ -33,6 +33,8 @@ extern int dhcpopt_store ( struct dhcp_options *options, unsigned int tag,
 			   const void *data, size_t len );
 extern int dhcpopt_fetch ( struct dhcp_options *options, unsigned int tag,
 			   void *data, size_t len );
+extern int dhcpopt_copy ( struct dhcp_options *source,
+			  struct dhcp_options *dest );
 extern void dhcpopt_init ( struct dhcp_options *options,
 			   void *data, size_t alloc_len,
 			   int ( * realloc ) ( struct dhcp_options *options,
@@ -65,7 +65,10 @@ extern int dhcppkt_store ( struct dhcp_packet *dhcppkt, unsigned int tag,
 			   const void *data, size_t len );
 extern int dhcppkt_fetch ( struct dhcp_packet *dhcppkt, unsigned int tag,
 			   void *data, size_t len );
-extern void dhcppkt_init ( struct dhcp_packet *dhcppkt, 
+extern int dhcppkt_copy ( struct dhcp_packet *source,
+			  struct dhcp_packet *dest );
+extern struct dhcp_packet * dhcppkt_from_settings ( struct settings *settings );
+extern void dhcppkt_init ( struct dhcp_packet *dhcppkt,
 			   struct dhcphdr *data, size_t len );
 
 #endif /* _IPXE_DHCPPKT_H */
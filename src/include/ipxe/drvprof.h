@@ -0,0 +1,142 @@
+#ifndef _IPXE_DRVPROF_H
+#define _IPXE_DRVPROF_H
+
+/** @file
+ *
+ * Network driver latency profiling
+ *
+ * Provides standardized instrumentation points for measuring the
+ * latency from poll entry to packet delivery (via netdev_rx()) and
+ * from packet enqueue (via the driver transmit method) to transmit
+ * completion, on a per-driver basis.
+ *
+ * Enable by defining DRIVER_PROFILING in config/general.h; results
+ * appear in the "profstat" output as "<driver>.rxlat" and
+ * "<driver>.txlat".  Unlike the generic profilers, these
+ * instrumentation points are active even in builds in which profiling
+ * is otherwise disabled.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <config/general.h>
+#include <ipxe/profile.h>
+
+#ifdef DRIVER_PROFILING
+#define DRVPROF 1
+#else
+#define DRVPROF 0
+#endif
+
+/** Number of in-flight transmit timestamps
+ *
+ * Must be a power of two, and at least as large as the largest
+ * hardware transmit ring in any instrumented driver.
+ */
+#define DRVPROF_TX_RING 256
+
+/** A network driver latency profiler */
+struct driver_profiler {
+	/** Poll-to-delivery receive latency profiler */
+	struct profiler *rx;
+	/** Enqueue-to-completion transmit latency profiler */
+	struct profiler *tx;
+	/** Timestamp of current poll entry */
+	unsigned long polled;
+	/** In-flight transmit timestamps */
+	unsigned long txstamp[DRVPROF_TX_RING];
+	/** Transmit timestamp producer counter */
+	unsigned int txprod;
+	/** Transmit timestamp consumer counter */
+	unsigned int txcons;
+};
+
+/** Declare a driver latency profiler */
+#if DRVPROF
+#define __drvprof __table_entry ( PROFILERS, 01 )
+#else
+#define __drvprof
+#endif
+
+/** Define a driver latency profiler */
+#define DRIVER_PROFILER( _var, _name )					\
+	static struct profiler _var ## _rx __drvprof =			\
+		{ .name = _name ".rxlat" };				\
+	static struct profiler _var ## _tx __drvprof =			\
+		{ .name = _name ".txlat" };				\
+	static struct driver_profiler _var = {				\
+		.rx = & _var ## _rx,					\
+		.tx = & _var ## _tx,					\
+	}
+
+/**
+ * Record poll entry
+ *
+ * @v drvprof		Driver latency profiler
+ */
+static inline __attribute__ (( always_inline )) void
+drvprof_poll ( struct driver_profiler *drvprof ) {
+
+	if ( DRVPROF )
+		drvprof->polled = profile_timestamp();
+}
+
+/**
+ * Record packet delivery to the network stack
+ *
+ * @v drvprof		Driver latency profiler
+ *
+ * Records the latency from the current poll entry to delivery of the
+ * received packet.
+ */
+static inline __attribute__ (( always_inline )) void
+drvprof_rx ( struct driver_profiler *drvprof ) {
+
+	if ( DRVPROF ) {
+		profile_update ( drvprof->rx, ( profile_timestamp() -
+						drvprof->polled ) );
+	}
+}
+
+/**
+ * Record packet enqueued for transmission
+ *
+ * @v drvprof		Driver latency profiler
+ */
+static inline __attribute__ (( always_inline )) void
+drvprof_tx ( struct driver_profiler *drvprof ) {
+	unsigned int index;
+
+	if ( DRVPROF ) {
+		index = ( drvprof->txprod++ % DRVPROF_TX_RING );
+		drvprof->txstamp[index] = profile_timestamp();
+	}
+}
+
+/**
+ * Record transmit completion
+ *
+ * @v drvprof		Driver latency profiler
+ *
+ * Records the latency from enqueue to completion of the
+ * oldest outstanding transmitted packet.  Transmit completions are
+ * assumed to be delivered in order, as is the case for all currently
+ * instrumented drivers.
+ */
+static inline __attribute__ (( always_inline )) void
+drvprof_tx_complete ( struct driver_profiler *drvprof ) {
+	unsigned int index;
+
+	if ( DRVPROF ) {
+		/* Ignore spurious completions (e.g. for packets
+		 * enqueued before profiling started).
+		 */
+		if ( drvprof->txcons == drvprof->txprod )
+			return;
+		index = ( drvprof->txcons++ % DRVPROF_TX_RING );
+		profile_update ( drvprof->tx, ( profile_timestamp() -
+						drvprof->txstamp[index] ) );
+	}
+}
+
+#endif /* _IPXE_DRVPROF_H */
@@ -134,16 +134,69 @@ EFI_STATUS
   IN IPXE_DOWNLOAD_PROTOCOL *This
   );
 
+/**
+ * Callback function that is invoked when a direct-to-buffer download is
+ * finished downloading, or when a connection unexpectedly closes or times out.
+ *
+ * The finish callback is also called when a download is aborted by the Abort
+ * function.
+ *
+ * @v Context		Context provided to the StartBuffer function
+ * @v Status		Reason for termination: EFI_SUCCESS when the entire
+ * 			file was transferred successfully, or an error
+ * 			otherwise
+ * @v FileSize		Length of the downloaded file in bytes
+ */
+typedef
+void
+(EFIAPI *IPXE_DOWNLOAD_BUFFER_FINISH_CALLBACK)(
+  IN VOID *Context,
+  IN EFI_STATUS Status,
+  IN UINTN FileSize
+  );
+
+/**
+ * Start downloading a file directly into a caller-provided buffer.
+ *
+ * Downloaded data is written directly into the buffer at its final file
+ * offset, with no intermediate data callbacks.  The download will be
+ * aborted if the file exceeds the buffer size.
+ *
+ * @v This		iPXE Download Protocol instance
+ * @v Url		URL to download from
+ * @v Buffer		Destination buffer
+ * @v BufferSize	Size of destination buffer in bytes
+ * @v FinishCallback	Callback that will be invoked when the download ends
+ * @v Context		Context passed to the Finish callback
+ * @v File		Token that can be used to abort the download
+ * @ret Status		EFI status code
+ */
+typedef
+EFI_STATUS
+(EFIAPI *IPXE_DOWNLOAD_START_BUFFER)(
+  IN IPXE_DOWNLOAD_PROTOCOL *This,
+  IN CHAR8 *Url,
+  IN VOID *Buffer,
+  IN UINTN BufferSize,
+  IN IPXE_DOWNLOAD_BUFFER_FINISH_CALLBACK FinishCallback,
+  IN VOID *Context,
+  OUT IPXE_DOWNLOAD_FILE *File
+  );
+
 /**
  * The iPXE Download Protocol.
  *
  * iPXE will attach a iPXE Download Protocol to the DeviceHandle in the Loaded
  * Image Protocol of all child EFI applications.
+ *
+ * Members may be appended to this structure, but existing members will
+ * never be reordered or removed.
  */
 struct _IPXE_DOWNLOAD_PROTOCOL {
    IPXE_DOWNLOAD_START Start;
    IPXE_DOWNLOAD_ABORT Abort;
    IPXE_DOWNLOAD_POLL Poll;
+   IPXE_DOWNLOAD_START_BUFFER StartBuffer;
 };
 
 #define IPXE_DOWNLOAD_PROTOCOL_GUID \
@@ -108,6 +108,26 @@ struct fbcon_picture {
 	userptr_t start;
 };
 
+/** Number of cacheable glyphs */
+#define FBCON_GLYPHS 256
+
+/** A frame buffer glyph cache
+ *
+ * Holds glyphs pre-rendered in framebuffer pixel format for a single
+ * foreground/background attribute pair, built lazily as characters
+ * are drawn.
+ */
+struct fbcon_glyphs {
+	/** Pre-rendered glyph data */
+	userptr_t start;
+	/** Foreground colour */
+	uint32_t foreground;
+	/** Background colour (as rendered) */
+	uint32_t background;
+	/** Bitmap of valid glyphs */
+	uint8_t valid[ FBCON_GLYPHS / 8 ];
+};
+
 /** A frame buffer console */
 struct fbcon {
 	/** Start address */
@@ -140,8 +160,17 @@ struct fbcon {
 	struct ansiesc_context ctx;
 	/** Text array */
 	struct fbcon_text text;
+	/** Displayed text array
+	 *
+	 * Records the cell most recently drawn at each position,
+	 * allowing redraws (e.g. after scrolling) to touch only those
+	 * framebuffer regions whose contents have actually changed.
+	 */
+	struct fbcon_text displayed;
 	/** Background picture */
 	struct fbcon_picture picture;
+	/** Glyph cache */
+	struct fbcon_glyphs glyphs;
 	/** Display cursor */
 	int show_cursor;
 };
@@ -153,5 +182,7 @@ extern int fbcon_init ( struct fbcon *fbcon, userptr_t start,
 			struct console_configuration *config );
 extern void fbcon_fini ( struct fbcon *fbcon );
 extern void fbcon_putchar ( struct fbcon *fbcon, int character );
+extern void fbcon_putchars ( struct fbcon *fbcon, const char *data,
+			     size_t len );
 
 #endif /* _IPXE_FBCON_H */
@@ -0,0 +1,14 @@
+#ifndef _IPXE_FNTRACE_H
+#define _IPXE_FNTRACE_H
+
+/** @file
+ *
+ * Function call flight recorder
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+extern void fntrace_dump ( void );
+
+#endif /* _IPXE_FNTRACE_H */
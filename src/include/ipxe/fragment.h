@@ -17,14 +17,50 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Fragment reassembly timeout */
 #define FRAGMENT_TIMEOUT ( TICKS_PER_SEC / 2 )
 
+/** Maximum length of the fragmentable portion of a reassembled packet */
+#define FRAGMENT_MAX_LEN 65536
+
+/** Maximum number of concurrent reassembly buffers (per reassembler) */
+#define FRAGMENT_MAX_BUFFERS 8
+
+/** Maximum number of hole descriptors (per reassembly buffer) */
+#define FRAGMENT_MAX_HOLES 16
+
+/** Hole upper bound used before the final fragment has been seen */
+#define FRAGMENT_EOF ( ( size_t ) -1 )
+
+/** A reassembly hole descriptor
+ *
+ * Describes a contiguous region of the fragmentable portion which
+ * has not yet been received (a "hole descriptor" per RFC 815).
+ */
+struct fragment_hole {
+	/** List of holes, sorted by offset */
+	struct list_head list;
+	/** Offset of first byte of hole */
+	size_t first;
+	/** Offset of first byte beyond hole, or @c FRAGMENT_EOF */
+	size_t last;
+};
+
 /** A fragment reassembly buffer */
 struct fragment {
-	/* List of fragment reassembly buffers */
+	/* List of fragment reassembly buffers
+	 *
+	 * Maintained in order of most recent activity, to allow the
+	 * least recently active buffer to be evicted.
+	 */
 	struct list_head list;
 	/** Reassembled packet */
 	struct io_buffer *iobuf;
 	/** Length of non-fragmentable portion of reassembled packet */
 	size_t hdrlen;
+	/** Total length of fragmentable portion (0 if not yet known) */
+	size_t len;
+	/** List of unreceived regions */
+	struct list_head holes;
+	/** Number of hole descriptors */
+	unsigned int nholes;
 	/** Reassembly timer */
 	struct retry_timer timer;
 	/** Fragment reassembler */
@@ -0,0 +1,128 @@
+#ifndef _IPXE_GCM_H
+#define _IPXE_GCM_H
+
+/** @file
+ *
+ * Galois/Counter Mode (GCM)
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/crypto.h>
+
+/** A GCM block */
+union gcm_block {
+	/** Viewed as an array of bytes */
+	uint8_t byte[16];
+	/** Viewed as an array of 32-bit words */
+	uint32_t word[4];
+	/** Viewed as an array of 64-bit words */
+	uint64_t qword[2];
+} __attribute__ (( packed ));
+
+/** GCM block size */
+#define GCM_BLOCKSIZE sizeof ( union gcm_block )
+
+/** GCM authentication tag size */
+#define GCM_TAGSIZE sizeof ( union gcm_block )
+
+/** GCM context */
+struct gcm_context {
+	/** Hash key (H) */
+	union gcm_block key;
+	/** Initial counter (J0) */
+	union gcm_block first;
+	/** Current counter */
+	union gcm_block counter;
+	/** Accumulated hash state (X) */
+	union gcm_block state;
+	/** Current keystream block */
+	union gcm_block pad;
+	/** Implicit portion of nonce */
+	uint8_t salt[4];
+	/** Offset within current keystream block */
+	size_t pad_offset;
+	/** Offset within current hash input block */
+	size_t state_offset;
+	/** Accumulated length of additional authenticated data */
+	uint64_t aad_len;
+	/** Accumulated length of encrypted or decrypted data */
+	uint64_t data_len;
+};
+
+extern int gcm_setkey ( struct gcm_context *gcm, void *raw_ctx,
+			const void *key, size_t keylen,
+			struct cipher_algorithm *raw_cipher );
+extern void gcm_setiv ( struct gcm_context *gcm, void *raw_ctx,
+			const void *iv, size_t ivlen,
+			struct cipher_algorithm *raw_cipher );
+extern void gcm_encrypt ( struct gcm_context *gcm, void *raw_ctx,
+			  const void *src, void *dst, size_t len,
+			  struct cipher_algorithm *raw_cipher );
+extern void gcm_decrypt ( struct gcm_context *gcm, void *raw_ctx,
+			  const void *src, void *dst, size_t len,
+			  struct cipher_algorithm *raw_cipher );
+extern void gcm_auth ( struct gcm_context *gcm, void *raw_ctx, void *auth,
+		       struct cipher_algorithm *raw_cipher );
+
+/**
+ * Create a Galois/Counter mode of behaviour of an existing cipher
+ *
+ * @v _gcm_name		Name for the new GCM cipher
+ * @v _gcm_cipher	New cipher algorithm
+ * @v _raw_cipher	Underlying cipher algorithm
+ * @v _raw_context	Context structure for the underlying cipher
+ */
+#define GCM_CIPHER( _gcm_name, _gcm_cipher, _raw_cipher, _raw_context )	\
+struct _gcm_name ## _context {						\
+	_raw_context raw_ctx;						\
+	struct gcm_context gcm_ctx;					\
+};									\
+static int _gcm_name ## _setkey ( void *ctx, const void *key,		\
+				  size_t keylen ) {			\
+	struct _gcm_name ## _context * _gcm_name ## _ctx = ctx;		\
+	return gcm_setkey ( &_gcm_name ## _ctx->gcm_ctx,		\
+			    &_gcm_name ## _ctx->raw_ctx, key, keylen,	\
+			    &_raw_cipher );				\
+}									\
+static void _gcm_name ## _setiv ( void *ctx, const void *iv,		\
+				  size_t ivlen ) {			\
+	struct _gcm_name ## _context * _gcm_name ## _ctx = ctx;		\
+	gcm_setiv ( &_gcm_name ## _ctx->gcm_ctx,			\
+		    &_gcm_name ## _ctx->raw_ctx, iv, ivlen,		\
+		    &_raw_cipher );					\
+}									\
+static void _gcm_name ## _encrypt ( void *ctx, const void *src,		\
+				    void *dst, size_t len ) {		\
+	struct _gcm_name ## _context * _gcm_name ## _ctx = ctx;		\
+	gcm_encrypt ( &_gcm_name ## _ctx->gcm_ctx,			\
+		      &_gcm_name ## _ctx->raw_ctx, src, dst, len,	\
+		      &_raw_cipher );					\
+}									\
+static void _gcm_name ## _decrypt ( void *ctx, const void *src,		\
+				    void *dst, size_t len ) {		\
+	struct _gcm_name ## _context * _gcm_name ## _ctx = ctx;		\
+	gcm_decrypt ( &_gcm_name ## _ctx->gcm_ctx,			\
+		      &_gcm_name ## _ctx->raw_ctx, src, dst, len,	\
+		      &_raw_cipher );					\
+}									\
+static void _gcm_name ## _auth ( void *ctx, void *auth ) {		\
+	struct _gcm_name ## _context * _gcm_name ## _ctx = ctx;		\
+	gcm_auth ( &_gcm_name ## _ctx->gcm_ctx,				\
+		   &_gcm_name ## _ctx->raw_ctx, auth, &_raw_cipher );	\
+}									\
+struct cipher_algorithm _gcm_cipher = {					\
+	.name		= #_gcm_name,					\
+	.ctxsize	= sizeof ( struct _gcm_name ## _context ),	\
+	.blocksize	= 1,						\
+	.authsize	= GCM_TAGSIZE,					\
+	.setkey		= _gcm_name ## _setkey,				\
+	.setiv		= _gcm_name ## _setiv,				\
+	.encrypt	= _gcm_name ## _encrypt,			\
+	.decrypt	= _gcm_name ## _decrypt,			\
+	.auth		= _gcm_name ## _auth,				\
+};
+
+#endif /* _IPXE_GCM_H */
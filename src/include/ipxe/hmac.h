@@ -8,8 +8,34 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <string.h>
 #include <ipxe/crypto.h>
 
+/**
+ * Calculate HMAC key schedule context size
+ *
+ * @v digest		Digest algorithm to use
+ * @ret len		Context size
+ *
+ * The key schedule context holds the precomputed inner and outer
+ * digest states for a given key.
+ */
+static inline size_t hmac_ctxsize ( struct digest_algorithm *digest ) {
+	return ( 2 * digest->ctxsize );
+}
+
+/**
+ * Start HMAC from a precomputed key schedule
+ *
+ * @v digest		Digest algorithm to use
+ * @v hmac_ctx		HMAC key schedule context
+ * @v digest_ctx	Digest context to initialise
+ */
+static inline void hmac_start ( struct digest_algorithm *digest,
+				const void *hmac_ctx, void *digest_ctx ) {
+	memcpy ( digest_ctx, hmac_ctx, digest->ctxsize );
+}
+
 /**
  * Update HMAC
  *
@@ -28,5 +54,10 @@ extern void hmac_init ( struct digest_algorithm *digest, void *digest_ctx,
 			void *key, size_t *key_len );
 extern void hmac_final ( struct digest_algorithm *digest, void *digest_ctx,
 			 void *key, size_t *key_len, void *hmac );
+extern void hmac_precompute ( struct digest_algorithm *digest, void *hmac_ctx,
+			      const void *key, size_t key_len );
+extern void hmac_finish ( struct digest_algorithm *digest,
+			  const void *hmac_ctx, void *digest_ctx,
+			  void *hmac );
 
 #endif /* _IPXE_HMAC_H */
@@ -19,6 +19,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/pool.h>
 #include <ipxe/tables.h>
 #include <ipxe/ntlm.h>
+#include <ipxe/settings.h>
 
 struct http_transaction;
 
@@ -445,6 +446,10 @@ struct http_transaction {
 	size_t len;
 	/** Chunk length remaining */
 	size_t remaining;
+	/** Offset of current response within overall transfer */
+	size_t offset;
+	/** Number of resume attempts used */
+	unsigned int resumes;
 };
 
 /******************************************************************************
@@ -558,9 +563,17 @@ struct http_authentication {
 
 extern char * http_token ( char **line, char **value );
 extern int http_connect ( struct interface *xfer, struct uri *uri );
+extern int http_preconnect ( struct uri *uri, unsigned int count );
 extern int http_open ( struct interface *xfer, struct http_method *method,
 		       struct uri *uri, struct http_request_range *range,
 		       struct http_request_content *content );
 extern int http_open_uri ( struct interface *xfer, struct uri *uri );
+extern int http_open_striped ( struct interface *xfer, struct uri *uri,
+			       unsigned int count );
+
+extern const struct setting http_stripes_setting __setting ( SETTING_MISC,
+							     http-stripes );
+extern const struct setting http_resumes_setting __setting ( SETTING_MISC,
+							     http-resumes );
 
 #endif /* _IPXE_HTTP_H */
@@ -221,6 +221,13 @@ FILE_LICENCE(GPL2_OR_LATER);
 /** Subtype value for data frames containing no data */
 #define  IEEE80211_STYPE_NODATA       0x0040
 
+/** Subtype value for QoS data frames
+ *
+ * These carry a two-byte QoS Control field immediately after the
+ * regular frame header.
+ */
+#define  IEEE80211_STYPE_QOS_DATA     0x0080
+
 
 /** 802.11 Frame Control field: To Data System flag
  *
@@ -345,6 +352,37 @@ struct ieee80211_llc_snap_header
  */
 #define IEEE80211_LLC_CTRL	0x03
 
+/** 802.11 QoS Control field: Traffic Identifier mask */
+#define IEEE80211_QOS_TID	0x000F
+
+/** 802.11 QoS Control field: A-MSDU present flag
+ *
+ * When set, the frame body holds a sequence of aggregated MSDU
+ * subframes instead of a single LLC/SNAP-encapsulated packet.
+ */
+#define IEEE80211_QOS_AMSDU	0x0080
+
+/** Subframe header within an A-MSDU aggregate
+ *
+ * Each subframe starts with this Ethernet-like header and is padded
+ * to a multiple of four bytes, except for the last subframe in the
+ * aggregate.
+ */
+struct ieee80211_amsdu_subframe
+{
+	/** Destination MAC address */
+	u8 da[ETH_ALEN];
+
+	/** Source MAC address */
+	u8 sa[ETH_ALEN];
+
+	/** Length of subframe payload, in network byte order */
+	u16 len;
+
+	/** Beginning of subframe payload (LLC/SNAP header and data) */
+	u8 data[0];
+} __attribute__((packed));
+
 
 /** 16-byte RTS frame format, with abbreviated header */
 struct ieee80211_rts
@@ -1156,6 +1194,102 @@ struct ieee80211_auth
 /** Shared Key authentication algorithm */
 #define IEEE80211_AUTH_SHARED_KEY   1
 
+/** Action frame category value for block-ack management */
+#define IEEE80211_CATEG_BLOCK_ACK	3
+
+/** Block-ack action value: request to set up a block-ack session */
+#define IEEE80211_ACTION_ADDBA_REQUEST	0
+
+/** Block-ack action value: reply to a block-ack session request */
+#define IEEE80211_ACTION_ADDBA_RESPONSE	1
+
+/** Block-ack action value: tear down a block-ack session */
+#define IEEE80211_ACTION_DELBA		2
+
+/** Block Ack Parameter Set field: A-MSDU permitted flag */
+#define IEEE80211_ADDBA_AMSDU		0x0001
+
+/** Block Ack Parameter Set field: immediate (not delayed) block-ack */
+#define IEEE80211_ADDBA_IMMEDIATE	0x0002
+
+/** Block Ack Parameter Set field: traffic identifier mask */
+#define IEEE80211_ADDBA_TID		0x003C
+
+/** Block Ack Parameter Set field: traffic identifier shift */
+#define IEEE80211_ADDBA_TID_SHIFT	2
+
+/** Block Ack Parameter Set field: reorder buffer size mask */
+#define IEEE80211_ADDBA_BUFSIZE		0xFFC0
+
+/** Block Ack Parameter Set field: reorder buffer size shift */
+#define IEEE80211_ADDBA_BUFSIZE_SHIFT	6
+
+/** DELBA Parameter Set field: traffic identifier mask */
+#define IEEE80211_DELBA_TID		0xF000
+
+/** DELBA Parameter Set field: traffic identifier shift */
+#define IEEE80211_DELBA_TID_SHIFT	12
+
+/** ADDBA request action frame data */
+struct ieee80211_addba_request
+{
+	/** Action frame category (IEEE80211_CATEG_BLOCK_ACK) */
+	u8 category;
+
+	/** Action code (IEEE80211_ACTION_ADDBA_REQUEST) */
+	u8 action;
+
+	/** Dialog token, echoed in the response */
+	u8 dialog;
+
+	/** Block Ack Parameter Set field */
+	u16 params;
+
+	/** Session timeout in time units, or 0 for no timeout */
+	u16 timeout;
+
+	/** Sequence Control value of the first aggregated frame */
+	u16 start_seq;
+} __attribute__((packed));
+
+/** ADDBA response action frame data */
+struct ieee80211_addba_response
+{
+	/** Action frame category (IEEE80211_CATEG_BLOCK_ACK) */
+	u8 category;
+
+	/** Action code (IEEE80211_ACTION_ADDBA_RESPONSE) */
+	u8 action;
+
+	/** Dialog token copied from the request */
+	u8 dialog;
+
+	/** Status code (0 accepts the session) */
+	u16 status;
+
+	/** Block Ack Parameter Set field, as granted */
+	u16 params;
+
+	/** Session timeout in time units, or 0 for no timeout */
+	u16 timeout;
+} __attribute__((packed));
+
+/** DELBA action frame data */
+struct ieee80211_delba
+{
+	/** Action frame category (IEEE80211_CATEG_BLOCK_ACK) */
+	u8 category;
+
+	/** Action code (IEEE80211_ACTION_DELBA) */
+	u8 action;
+
+	/** DELBA Parameter Set field */
+	u16 params;
+
+	/** Reason code, as for disassociation */
+	u16 reason;
+} __attribute__((packed));
+
 /** @} */
 
 #endif
@@ -19,6 +19,10 @@ struct uri;
 struct pixel_buffer;
 struct asn1_cursor;
 struct image_type;
+struct digest_algorithm;
+
+/** Maximum length of a cached image digest (SHA-512) */
+#define IMAGE_DIGEST_LEN 64
 
 /** An executable image */
 struct image {
@@ -45,6 +49,18 @@ struct image {
 	/** Image type, if known */
 	struct image_type *type;
 
+	/** Cached data digest algorithm, or NULL if no digest cached
+	 *
+	 * A digest of the raw file image may be computed
+	 * opportunistically (e.g. incrementally during download,
+	 * while the data is still cache-hot) and cached for later
+	 * consumers such as signature verification, avoiding an extra
+	 * sequential pass over the image data.
+	 */
+	struct digest_algorithm *digest;
+	/** Cached data digest value */
+	uint8_t digest_value[IMAGE_DIGEST_LEN];
+
 	/** Replacement image
 	 *
 	 * An image wishing to replace itself with another image (in a
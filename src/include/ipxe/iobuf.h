@@ -22,6 +22,24 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define IOB_ZLEN 128
 
+/** Checksums have been verified by the network device
+ *
+ * Set on received packets whose network and transport checksums have
+ * already been verified in hardware; the protocol stack may skip
+ * software verification.
+ */
+#define IOB_FL_CSUM_OK 0x0001
+
+/** Transport checksum must be completed by the network device
+ *
+ * Set on transmitted packets whose transport checksum field has not
+ * been filled in by the protocol stack; the transmitting network
+ * device is responsible for generating the checksum.  May be set
+ * only when the device has advertised the NETDEV_FEAT_TX_CSUM
+ * feature.
+ */
+#define IOB_FL_CSUM_PARTIAL 0x0002
+
 /**
  * A persistent I/O buffer
  *
@@ -38,6 +56,37 @@ struct io_buffer {
 	 */
 	struct list_head list;
 
+	/** List of fragment buffers
+	 *
+	 * A buffer may have further I/O buffers chained to it as
+	 * fragments, representing a single logical block of data held
+	 * in multiple non-contiguous buffers.  Fragments logically
+	 * follow the data in the buffer to which they are chained,
+	 * are owned by that buffer, and are freed along with it.
+	 * Fragments may not themselves have fragments.
+	 *
+	 * Consumers that require contiguous data must flatten the
+	 * chain using iob_defrag().
+	 */
+	struct list_head fragments;
+
+	/** Segmentation offload size
+	 *
+	 * If non-zero, then the buffer holds a single oversized TCP
+	 * segment, and the transmitting network device is responsible
+	 * for splitting the payload into frames each carrying at most
+	 * this many bytes.  May be set only when the network device
+	 * has advertised the NETDEV_FEAT_TX_TSO feature.
+	 */
+	size_t gso_size;
+
+	/** Flags
+	 *
+	 * This is the bitwise-OR of zero or more IOB_FL_XXX
+	 * constants.
+	 */
+	unsigned int flags;
+
 	/** Start of the buffer */
 	void *head;
 	/** Start of data */
@@ -185,6 +234,9 @@ static inline size_t iob_tailroom ( struct io_buffer *iobuf ) {
  */
 static inline void iob_populate ( struct io_buffer *iobuf,
 				  void *data, size_t len, size_t max_len ) {
+	INIT_LIST_HEAD ( &iobuf->fragments );
+	iobuf->gso_size = 0;
+	iobuf->flags = 0;
 	iobuf->head = iobuf->data = data;
 	iobuf->tail = ( data + len );
 	iobuf->end = ( data + max_len );
@@ -210,11 +262,49 @@ static inline void iob_populate ( struct io_buffer *iobuf,
 	(iobuf) = NULL;					\
 	__iobuf; } )
 
+/** A pool of I/O buffers
+ *
+ * A pool holds a free list of identically sized (and hence
+ * identically aligned) I/O buffers, which can be populated in bulk.
+ * It is intended for network device receive rings: buffers are
+ * pre-allocated at open() time so that ring refill in the poll loop
+ * is a pointer pop rather than a heap allocation.
+ */
+struct iob_pool {
+	/** Free buffers */
+	struct list_head free;
+	/** Length of each buffer */
+	size_t len;
+	/** Number of free buffers */
+	unsigned int count;
+};
+
+/**
+ * Initialise an I/O buffer pool
+ *
+ * @v pool	I/O buffer pool
+ * @v len	Length of each buffer
+ */
+static inline void iob_pool_init ( struct iob_pool *pool, size_t len ) {
+	INIT_LIST_HEAD ( &pool->free );
+	pool->len = len;
+	pool->count = 0;
+}
+
 extern struct io_buffer * __malloc alloc_iob_raw ( size_t len, size_t align,
 						   size_t offset );
 extern struct io_buffer * __malloc alloc_iob ( size_t len );
 extern void free_iob ( struct io_buffer *iobuf );
+extern int iob_pool_fill ( struct iob_pool *pool, unsigned int max );
+extern struct io_buffer * iob_pool_get ( struct iob_pool *pool );
+extern void iob_pool_put ( struct iob_pool *pool, struct io_buffer *iobuf );
+extern void iob_pool_drain ( struct iob_pool *pool );
+extern void iob_chain ( struct io_buffer *iobuf, struct io_buffer *frag );
+extern struct io_buffer * iob_unchain ( struct io_buffer *iobuf );
+extern size_t iob_total_len ( struct io_buffer *iobuf );
+extern struct io_buffer * iob_defrag ( struct io_buffer *iobuf );
 extern void iob_pad ( struct io_buffer *iobuf, size_t min_len );
+extern void iob_pad_align ( struct io_buffer *iobuf, size_t min_len );
 extern int iob_ensure_headroom ( struct io_buffer *iobuf, size_t len );
 extern struct io_buffer * iob_concatenate ( struct list_head *list );
 extern struct io_buffer * iob_split ( struct io_buffer *iobuf, size_t len );
@@ -196,6 +196,8 @@ struct ipv6_miniroute {
 	unsigned int scope;
 	/** Flags */
 	unsigned int flags;
+	/** Solicited-node multicast link-layer address */
+	uint8_t ll_mcast[MAX_LL_ADDR_LEN];
 };
 
 /** IPv6 address/routing table entry flags */
@@ -204,6 +206,8 @@ enum ipv6_miniroute_flags {
 	IPV6_HAS_ADDRESS = 0x0001,
 	/** Routing table entry router address is valid */
 	IPV6_HAS_ROUTER = 0x0002,
+	/** Solicited-node multicast group has been joined */
+	IPV6_HAS_GROUP = 0x0004,
 };
 
 /**
@@ -254,6 +258,16 @@ static inline void ipv6_solicited_node ( struct in6_addr *addr,
 	memcpy ( &addr->s6_addr[13], &unicast->s6_addr[13], 3 );
 }
 
+/**
+ * Construct all-nodes multicast address
+ *
+ * @v addr		Zeroed address to construct
+ */
+static inline void ipv6_all_nodes ( struct in6_addr *addr ) {
+	addr->s6_addr16[0] = htons ( 0xff02 );
+	addr->s6_addr[15] = 1;
+}
+
 /**
  * Construct all-routers multicast address
  *
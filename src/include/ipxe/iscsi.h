@@ -10,6 +10,7 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
+#include <ipxe/list.h>
 #include <ipxe/socket.h>
 #include <ipxe/scsi.h>
 #include <ipxe/chap.h>
@@ -515,8 +516,12 @@ enum iscsi_tx_state {
 	ISCSI_TX_BHS,
 	/** Sending the additional header segment */
 	ISCSI_TX_AHS,
+	/** Sending the header digest */
+	ISCSI_TX_HEADER_DIGEST,
 	/** Sending the data segment */
 	ISCSI_TX_DATA,
+	/** Sending the data digest */
+	ISCSI_TX_DATA_DIGEST,
 };
 
 /** State of an iSCSI RX engine */
@@ -525,10 +530,71 @@ enum iscsi_rx_state {
 	ISCSI_RX_BHS = 0,
 	/** Receiving the additional header segment */
 	ISCSI_RX_AHS,
+	/** Receiving the header digest */
+	ISCSI_RX_HEADER_DIGEST,
 	/** Receiving the data segment */
 	ISCSI_RX_DATA,
 	/** Receiving the data segment padding */
 	ISCSI_RX_DATA_PADDING,
+	/** Receiving the data digest */
+	ISCSI_RX_DATA_DIGEST,
+};
+
+/** Length of an iSCSI header or data digest */
+#define ISCSI_DIGEST_LEN 4
+
+/** Maximum number of commands an iSCSI session will accept at once
+ *
+ * This is the queue depth we offer to the SCSI layer.  Commands
+ * beyond the first are queued for transmission while earlier PDUs
+ * are still on the wire, and responses are matched back to commands
+ * by initiator task tag.
+ */
+#define ISCSI_MAX_COMMANDS 4
+
+/** An iSCSI command
+ *
+ * The session may have multiple commands in flight simultaneously;
+ * each gets its own task tag and its own interface to the SCSI
+ * layer.
+ */
+struct iscsi_command {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** iSCSI session */
+	struct iscsi_session *iscsi;
+	/** List of outstanding commands within the session */
+	struct list_head list;
+	/** SCSI command interface */
+	struct interface data;
+
+	/** SCSI command */
+	struct scsi_cmd command;
+	/** Initiator task tag */
+	uint32_t itt;
+	/** Command PDU has been (or is being) transmitted */
+	int started;
+	/** An R2T is awaiting service by the TX engine */
+	int r2t_pending;
+
+	/** Target transfer tag
+	 *
+	 * This is the tag attached to a sequence of data-out PDUs in
+	 * response to an R2T.
+	 */
+	uint32_t ttt;
+	/** Transfer offset
+	 *
+	 * This is the offset for an in-progress sequence of data-out
+	 * PDUs in response to an R2T.
+	 */
+	uint32_t transfer_offset;
+	/** Transfer length
+	 *
+	 * This is the length for an in-progress sequence of data-out
+	 * PDUs in response to an R2T.
+	 */
+	uint32_t transfer_len;
 };
 
 /** An iSCSI session */
@@ -538,8 +604,6 @@ struct iscsi_session {
 
 	/** SCSI command-issuing interface */
 	struct interface control;
-	/** SCSI command interface */
-	struct interface data;
 	/** Transport-layer socket */
 	struct interface socket;
 
@@ -585,34 +649,18 @@ struct iscsi_session {
 	uint16_t isid_iana_qual;
 	/** Initiator task tag
 	 *
-	 * This is the tag of the current command.  It is incremented
-	 * whenever a new command is started.
+	 * This is the tag used for login request PDUs.  Commands
+	 * carry their own tags in struct iscsi_command.
 	 */
 	uint32_t itt;
-	/** Target transfer tag
-	 *
-	 * This is the tag attached to a sequence of data-out PDUs in
-	 * response to an R2T.
-	 */
-	uint32_t ttt;
-	/** Transfer offset
-	 *
-	 * This is the offset for an in-progress sequence of data-out
-	 * PDUs in response to an R2T.
-	 */
-	uint32_t transfer_offset;
-	/** Transfer length
-	 *
-	 * This is the length for an in-progress sequence of data-out
-	 * PDUs in response to an R2T.
-	 */
-	uint32_t transfer_len;
 	/** Command sequence number
 	 *
-	 * This is the sequence number of the current command, used to
-	 * fill out the CmdSN field in iSCSI request PDUs.  It is
-	 * updated with the value of the ExpCmdSN field whenever we
-	 * receive an iSCSI response PDU containing such a field.
+	 * This is the sequence number to be used for the next command
+	 * PDU, used to fill out the CmdSN field in iSCSI request
+	 * PDUs.  It is incremented whenever a command PDU is
+	 * transmitted, and resynchronised with the value of the
+	 * ExpCmdSN field whenever a response PDU arrives while no
+	 * commands are outstanding.
 	 */
 	uint32_t cmdsn;
 	/** Status sequence number
@@ -624,10 +672,17 @@ struct iscsi_session {
 	 */
 	uint32_t statsn;
 	
+	/** Header digest (CRC32C) negotiated for this connection */
+	int header_digest;
+	/** Data digest (CRC32C) negotiated for this connection */
+	int data_digest;
+
 	/** Basic header segment for current TX PDU */
 	union iscsi_bhs tx_bhs;
 	/** State of the TX engine */
 	enum iscsi_tx_state tx_state;
+	/** Data digest of the current TX PDU, in wire format */
+	uint32_t tx_digest;
 	/** TX process */
 	struct process process;
 
@@ -639,11 +694,17 @@ struct iscsi_session {
 	size_t rx_offset;
 	/** Length of the current RX state */
 	size_t rx_len;
+	/** Running digest of the current RX PDU */
+	uint32_t rx_digest;
+	/** Received digest of the current RX PDU, in wire format */
+	uint32_t rx_digest_wire;
 	/** Buffer for received data (not always used) */
 	void *rx_buffer;
 
-	/** Current SCSI command, if any */
-	struct scsi_cmd *command;
+	/** List of outstanding commands */
+	struct list_head commands;
+	/** Command on whose behalf the TX engine is transmitting, if any */
+	struct iscsi_command *tx_command;
 
 	/** Target socket address (for boot firmware table) */
 	struct sockaddr target_sockaddr;
@@ -18,6 +18,8 @@ struct line_buffer {
 	char *data;
 	/** Length of buffered data */
 	size_t len;
+	/** Allocated length of data buffer */
+	size_t max_len;
 	/** Most recently consumed length */
 	size_t consumed;
 };
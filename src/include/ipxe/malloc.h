@@ -24,10 +24,30 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 extern size_t freemem;
 extern size_t usedmem;
 extern size_t maxusedmem;
+extern unsigned int heap_fails;
+extern unsigned int heap_discards;
+extern size_t heap_minlargest;
+
+/** Heap statistics */
+struct memory_stats {
+	/** Total amount of free memory */
+	size_t free;
+	/** Total amount of used memory */
+	size_t used;
+	/** Maximum amount of used memory */
+	size_t maxused;
+	/** Size of largest free block */
+	size_t largest;
+	/** Amount of memory held in the segregated free lists */
+	size_t cached;
+	/** Number of blocks in the general free list */
+	unsigned int blocks;
+};
 
 extern void * __malloc alloc_memblock ( size_t size, size_t align,
 					size_t offset );
 extern void free_memblock ( void *ptr, size_t size );
+extern void mstats ( struct memory_stats *stats );
 extern void mpopulate ( void *start, size_t len );
 extern void mdumpfree ( void );
 
@@ -93,10 +113,20 @@ struct cache_discarder {
 	unsigned int ( * discard ) ( void );
 };
 
-/** Cache discarder table */
+/** Cache discarder table
+ *
+ * Entries are sorted by replacement cost.  The discard scheduler in
+ * the memory allocator works through this table in order, and so
+ * always evicts the cheapest-to-replace cached items first; caches
+ * with a higher replacement cost are touched only once all cheaper
+ * caches have been emptied.
+ */
 #define CACHE_DISCARDERS __table ( struct cache_discarder, "cache_discarders" )
 
-/** Declare a cache discarder */
+/** Declare a cache discarder
+ *
+ * @v cost		Cache discarder cost (a @c CACHE_XXX value)
+ */
 #define __cache_discarder( cost ) __table_entry ( CACHE_DISCARDERS, cost )
 
 /** @defgroup cache_cost Cache discarder costs
@@ -104,9 +134,10 @@ struct cache_discarder {
  * @{
  */
 
-#define CACHE_CHEAP	01	/**< Items with a low replacement cost */
-#define CACHE_NORMAL	02	/**< Items with a normal replacement cost */
-#define CACHE_EXPENSIVE	03	/**< Items with a high replacement cost */
+#define CACHE_FREE	01	/**< Items that are already effectively free */
+#define CACHE_CHEAP	02	/**< Items with a low replacement cost */
+#define CACHE_NORMAL	03	/**< Items with a normal replacement cost */
+#define CACHE_EXPENSIVE	04	/**< Items with a high replacement cost */
 
 /** @} */
 
@@ -0,0 +1,27 @@
+#ifndef _IPXE_MILESTONE_H
+#define _IPXE_MILESTONE_H
+
+/** @file
+ *
+ * Boot-phase milestone timeline
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** A boot milestone */
+struct milestone {
+	/** Milestone name */
+	char name[20];
+	/** Timestamp (in timer ticks) */
+	unsigned long ticks;
+	/** Timestamp (in profiling cycles) */
+	unsigned long long cycles;
+};
+
+extern void milestone ( const char *name );
+extern unsigned int milestone_list ( struct milestone **list );
+extern void milestones_show ( void );
+extern void milestones_export ( void );
+
+#endif /* _IPXE_MILESTONE_H */
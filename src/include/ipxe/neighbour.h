@@ -33,12 +33,29 @@ struct neighbour_discovery {
 			       const void *net_dest, const void *net_source );
 };
 
+/** Number of neighbour cache hash buckets */
+#define NEIGHBOUR_NUM_BUCKETS 32
+
+/** Maximum number of neighbour cache entries
+ *
+ * This is a policy decision, and may be overridden at build time.
+ */
+#ifndef NEIGHBOUR_MAX_ENTRIES
+#define NEIGHBOUR_MAX_ENTRIES 64
+#endif
+
 /** A neighbour cache entry */
 struct neighbour {
 	/** Reference count */
 	struct refcnt refcnt;
-	/** List of neighbour cache entries */
+	/** List of neighbour cache entries
+	 *
+	 * Maintained in order of most recent use, to allow the least
+	 * recently used entry to be replaced.
+	 */
 	struct list_head list;
+	/** List of neighbour cache entries in the same hash bucket */
+	struct list_head bucket;
 
 	/** Network device */
 	struct net_device *netdev;
@@ -283,6 +283,24 @@ enum net80211_crypto_alg {
  */
 #define NET80211_NR_CONCURRENT_FRAGS 3
 
+/** Number of frames in the block-ack reorder window
+ *
+ * This is the reorder buffer size we advertise when accepting an
+ * ADDBA request, and hence the largest A-MPDU the AP may send us.
+ * It must be a power of two.
+ */
+#define NET80211_BACK_WINDOW	16
+
+/** The number of block-ack sessions we can maintain at once
+ *
+ * Sessions are per traffic identifier; bulk data transfer uses only
+ * best-effort traffic, so we need very few.
+ */
+#define NET80211_NR_BACK	2
+
+/** Seconds we'll hold out-of-order frames awaiting a reorder hole */
+#define NET80211_BACK_TIMEOUT	1
+
 /** Maximum TX power to allow (dBm), if we don't get a regulatory hint */
 #define NET80211_REG_TXPOWER	20
 
@@ -545,6 +563,36 @@ struct net80211_frag_cache
 	struct io_buffer *iob[16];
 };
 
+/** State for one block-ack (A-MPDU reorder) session
+ *
+ * The AP negotiates one session per traffic identifier before
+ * sending aggregated frames. Frames received ahead of a hole in the
+ * sequence space are held here, indexed by sequence number modulo
+ * the window size, and released in order once the hole is filled or
+ * the window moves past it.
+ */
+struct net80211_back_cache
+{
+	/** Whether this session is active */
+	u8 in_use;
+
+	/** Traffic identifier this session covers */
+	u8 tid;
+
+	/** Next expected sequence number */
+	u16 expected;
+
+	/** Number of frames currently held */
+	int held;
+
+	/** Timestamp from point at which first held frame arrived */
+	u32 hold_ticks;
+
+	/** Held out-of-order frames, indexed by sequence number
+	 * modulo NET80211_BACK_WINDOW */
+	struct io_buffer *iob[NET80211_BACK_WINDOW];
+};
+
 
 /** Interface to an 802.11 security handshaking protocol
  *
@@ -993,6 +1041,9 @@ struct net80211_device
 	/** Fragment reassembly state */
 	struct net80211_frag_cache frags[NET80211_NR_CONCURRENT_FRAGS];
 
+	/** Block-ack (A-MPDU reorder) sessions */
+	struct net80211_back_cache back[NET80211_NR_BACK];
+
 	/** The sequence number of the last packet we sent */
 	u16 last_tx_seqnr;
 
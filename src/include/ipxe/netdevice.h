@@ -57,6 +57,20 @@ struct device;
 /** Maximum combined length of a link-layer and network-layer header */
 #define MAX_LL_NET_HEADER_LEN ( MAX_LL_HEADER_LEN + MAX_NET_HEADER_LEN )
 
+/** Maximum number of received packets processed per network device
+ * in a single poll
+ *
+ * This is a policy decision.  Bounding the number of packets
+ * processed per poll prevents a burst on one device from starving
+ * other devices, and returns control to driver polling (and hence
+ * hardware ring refilling) before the rings can run dry.  Remaining
+ * packets stay on the device's receive queue until the next poll.
+ * May be overridden at build time.
+ */
+#ifndef NET_RX_BUDGET
+#define NET_RX_BUDGET 8
+#endif
+
 /**
  * A network-layer protocol
  *
@@ -270,6 +284,23 @@ struct net_device_operations {
 	 * supported.
 	 */
 	void ( * irq ) ( struct net_device *netdev, int enable );
+	/** Update receive filter
+	 *
+	 * @v netdev	Network device
+	 * @ret rc	Return status code
+	 *
+	 * This method should program the hardware receive filters to
+	 * accept packets addressed to the current link-layer address,
+	 * to the link-layer broadcast address, and to any address in
+	 * the multicast filter list.  If the @c NETDEV_MCAST_OVERFLOW
+	 * flag is set then the filter list is incomplete and all
+	 * multicast packets must be accepted.
+	 *
+	 * This method may be NULL, in which case the device will
+	 * receive (at least) all multicast packets, as per the
+	 * original promiscuous behaviour.
+	 */
+	int ( * filter ) ( struct net_device *netdev );
 };
 
 /** Network device error */
@@ -289,10 +320,48 @@ struct net_device_stats {
 	unsigned int good;
 	/** Count of error completions */
 	unsigned int bad;
+	/** Count of bytes successfully transferred */
+	unsigned long long bytes;
 	/** Error breakdowns */
 	struct net_device_error errors[NETDEV_MAX_UNIQUE_ERRORS];
 };
 
+/** Number of one-second rate history windows */
+#define NETDEV_HISTORY_WINDOWS 8
+
+/** A rate history window */
+struct net_device_history_window {
+	/** Bytes successfully transmitted */
+	unsigned long tx_bytes;
+	/** Bytes successfully received */
+	unsigned long rx_bytes;
+	/** Packets successfully transmitted */
+	unsigned int tx_good;
+	/** Packets successfully received */
+	unsigned int rx_good;
+};
+
+/** A network device rate history
+ *
+ * Holds a short ring of one-second traffic windows, sampled by a
+ * periodic timer, so that a slow download leaves evidence of when
+ * traffic stopped flowing.
+ */
+struct net_device_history {
+	/** History ring (most recent window at @c index) */
+	struct net_device_history_window windows[NETDEV_HISTORY_WINDOWS];
+	/** Most recent window index */
+	unsigned int index;
+	/** Cumulative transmitted bytes at last sample */
+	unsigned long long tx_bytes;
+	/** Cumulative received bytes at last sample */
+	unsigned long long rx_bytes;
+	/** Cumulative transmitted packets at last sample */
+	unsigned int tx_good;
+	/** Cumulative received packets at last sample */
+	unsigned int rx_good;
+};
+
 /** A network device configuration */
 struct net_device_configuration {
 	/** Network device */
@@ -335,6 +404,26 @@ struct net_device_configurator {
 /** Maximum length of a network device name */
 #define NETDEV_NAME_LEN 12
 
+/** Maximum number of multicast filter list entries
+ *
+ * This is a policy decision.  If the list overflows, the device
+ * degrades gracefully to accepting all multicast packets.
+ */
+#define NETDEV_MCAST_MAX 8
+
+/** A network device multicast filter list entry */
+struct net_device_mcast {
+	/** Link-layer multicast address */
+	uint8_t ll_addr[MAX_LL_ADDR_LEN];
+	/** Usage count
+	 *
+	 * Several users (e.g. multiple IPv6 addresses sharing a
+	 * solicited-node group) may register the same link-layer
+	 * address.
+	 */
+	unsigned int count;
+};
+
 /**
  * A network device
  *
@@ -407,6 +496,13 @@ struct net_device {
 	 * link-layer headers) configured for the link.
 	 */
 	size_t mtu;
+	/** Hardware offload features
+	 *
+	 * This is the bitwise-OR of zero or more NETDEV_FEAT_XXX
+	 * constants, set by the driver to indicate offloads that the
+	 * hardware is able to perform.
+	 */
+	unsigned int features;
 	/** TX packet queue */
 	struct list_head tx_queue;
 	/** Deferred TX packet queue */
@@ -417,6 +513,19 @@ struct net_device {
 	struct net_device_stats tx_stats;
 	/** RX statistics */
 	struct net_device_stats rx_stats;
+	/** Traffic rate history */
+	struct net_device_history history;
+
+	/** Multicast filter list
+	 *
+	 * This is the list of link-layer multicast addresses that the
+	 * device is required to receive, as registered via
+	 * netdev_mcast_add().  It persists across device closure, so
+	 * that reopening the device restores the filters.
+	 */
+	struct net_device_mcast mcast[NETDEV_MCAST_MAX];
+	/** Number of multicast filter list entries */
+	unsigned int mcast_count;
 
 	/** Configuration settings applicable to this device */
 	struct generic_settings settings;
@@ -445,6 +554,35 @@ struct net_device {
  */
 #define NETDEV_IRQ_UNSUPPORTED 0x0008
 
+/** Network device multicast filter list has overflowed
+ *
+ * The multicast filter list is incomplete and the device must accept
+ * all multicast packets.
+ */
+#define NETDEV_MCAST_OVERFLOW 0x0010
+
+/** Network device can perform TCP segmentation offload
+ *
+ * The device accepts a single oversized TCP segment (marked with a
+ * non-zero I/O buffer segmentation offload size) and splits it into
+ * individual frames for transmission.
+ */
+#define NETDEV_FEAT_TX_TSO 0x0001
+
+/** Network device can generate transport checksums on transmission
+ *
+ * The device completes the transport checksum of any transmitted
+ * packet marked with the IOB_FL_CSUM_PARTIAL flag.
+ */
+#define NETDEV_FEAT_TX_CSUM 0x0002
+
+/** Network device verifies checksums on reception
+ *
+ * The device sets the IOB_FL_CSUM_OK flag on received packets whose
+ * network and transport checksums it has verified in hardware.
+ */
+#define NETDEV_FEAT_RX_CSUM 0x0004
+
 /** Link-layer protocol table */
 #define LL_PROTOCOLS __table ( struct ll_protocol, "ll_protocols" )
 
@@ -689,6 +827,11 @@ netdev_rx_frozen ( struct net_device *netdev ) {
 
 extern void netdev_rx_freeze ( struct net_device *netdev );
 extern void netdev_rx_unfreeze ( struct net_device *netdev );
+extern int netdev_filter ( struct net_device *netdev );
+extern void netdev_mcast_add ( struct net_device *netdev,
+			       const void *ll_addr );
+extern void netdev_mcast_del ( struct net_device *netdev,
+			       const void *ll_addr );
 extern void netdev_link_err ( struct net_device *netdev, int rc );
 extern void netdev_link_down ( struct net_device *netdev );
 extern void netdev_link_block ( struct net_device *netdev,
@@ -727,6 +870,7 @@ extern int net_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 		    uint16_t net_proto, const void *ll_dest,
 		    const void *ll_source, unsigned int flags );
 extern void net_poll ( void );
+extern void net_nap ( void );
 extern struct net_device_configurator *
 find_netdev_configurator ( const char *name );
 extern int netdev_configure ( struct net_device *netdev,
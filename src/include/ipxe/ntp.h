@@ -88,10 +88,29 @@ struct ntp_header {
 
 /** NTP fraction of a second magic value
  *
- * This is a policy decision.
+ * This is a policy decision.  The low-order bits are XORed with the
+ * burst request index, allowing each response to be paired with the
+ * individual request that elicited it.
  */
 #define NTP_FRACTION_MAGIC 0x69505845UL
 
+/** Number of requests sent in each NTP burst
+ *
+ * A single sample suffers badly from asymmetric paths, and a single
+ * lost reply stalls the boot on a retransmission timeout.  A short
+ * burst allows the lowest-delay sample to be selected, and tolerates
+ * individual packet loss without waiting out a retry cycle.
+ *
+ * This is a policy decision.
+ */
+#define NTP_BURST_COUNT 4
+
+/** Interval between NTP burst requests
+ *
+ * This is a policy decision.
+ */
+#define NTP_BURST_INTERVAL ( TICKS_PER_SEC / 8 )
+
 /** NTP minimum retransmission timeout
  *
  * This is a policy decision.
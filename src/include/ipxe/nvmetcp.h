@@ -0,0 +1,519 @@
+#ifndef _IPXE_NVMETCP_H
+#define _IPXE_NVMETCP_H
+
+/** @file
+ *
+ * NVMe over TCP protocol
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/interface.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/list.h>
+#include <ipxe/blockdev.h>
+#include <ipxe/uaccess.h>
+#include <ipxe/uri.h>
+
+/** Default NVMe/TCP port */
+#define NVMETCP_PORT 4420
+
+/** NVMe/TCP PDU common header */
+struct nvmetcp_header {
+	/** PDU type */
+	uint8_t type;
+	/** Flags */
+	uint8_t flags;
+	/** Header length */
+	uint8_t hlen;
+	/** Data offset (if data is present) */
+	uint8_t pdo;
+	/** Total PDU length */
+	uint32_t plen;
+} __attribute__ (( packed ));
+
+/** NVMe/TCP PDU types */
+enum nvmetcp_pdu_type {
+	/** Initialise connection request */
+	NVMETCP_ICREQ = 0x00,
+	/** Initialise connection response */
+	NVMETCP_ICRESP = 0x01,
+	/** Host to controller termination request */
+	NVMETCP_H2C_TERM = 0x02,
+	/** Controller to host termination request */
+	NVMETCP_C2H_TERM = 0x03,
+	/** Command capsule */
+	NVMETCP_CMD = 0x04,
+	/** Response capsule */
+	NVMETCP_RSP = 0x05,
+	/** Host to controller data */
+	NVMETCP_H2C_DATA = 0x06,
+	/** Controller to host data */
+	NVMETCP_C2H_DATA = 0x07,
+	/** Ready to transfer */
+	NVMETCP_R2T = 0x09,
+};
+
+/** PDU header digest is present */
+#define NVMETCP_FLAG_HDGST 0x01
+
+/** PDU data digest is present */
+#define NVMETCP_FLAG_DDGST 0x02
+
+/** PDU is last data PDU for this transfer */
+#define NVMETCP_FLAG_DATA_LAST 0x04
+
+/** Data transfer completes the command successfully */
+#define NVMETCP_FLAG_DATA_SUCCESS 0x08
+
+/** Length of a PDU digest */
+#define NVMETCP_DIGEST_LEN 4
+
+/** NVMe/TCP initialise connection request */
+struct nvmetcp_icreq {
+	/** Common header */
+	struct nvmetcp_header header;
+	/** PDU format version */
+	uint16_t pfv;
+	/** Host PDU data alignment (as a power of two, minus two) */
+	uint8_t hpda;
+	/** Digests enabled */
+	uint8_t dgst;
+	/** Maximum number of outstanding R2Ts per command, minus one */
+	uint32_t maxr2t;
+	/** Reserved */
+	uint8_t reserved[112];
+} __attribute__ (( packed ));
+
+/** NVMe/TCP initialise connection response */
+struct nvmetcp_icresp {
+	/** Common header */
+	struct nvmetcp_header header;
+	/** PDU format version */
+	uint16_t pfv;
+	/** Controller PDU data alignment (as a power of two, minus two) */
+	uint8_t cpda;
+	/** Digests enabled */
+	uint8_t dgst;
+	/** Maximum length of a host-to-controller data PDU */
+	uint32_t maxh2cdata;
+	/** Reserved */
+	uint8_t reserved[112];
+} __attribute__ (( packed ));
+
+/** Header digest enabled */
+#define NVMETCP_DGST_HDGST 0x01
+
+/** Data digest enabled */
+#define NVMETCP_DGST_DDGST 0x02
+
+/** An NVMe submission queue entry */
+struct nvme_sqe {
+	/** Opcode */
+	uint8_t opcode;
+	/** Flags */
+	uint8_t flags;
+	/** Command identifier */
+	uint16_t cid;
+	/** Namespace identifier */
+	uint32_t nsid;
+	/** Reserved */
+	uint8_t reserved_a[8];
+	/** Metadata pointer */
+	uint64_t mptr;
+	/** Data pointer (SGL descriptor 1) */
+	uint8_t dptr[16];
+	/** Command dwords 10-15 */
+	uint32_t cdw10;
+	uint32_t cdw11;
+	uint32_t cdw12;
+	uint32_t cdw13;
+	uint32_t cdw14;
+	uint32_t cdw15;
+} __attribute__ (( packed ));
+
+/** An NVMe over Fabrics submission queue entry */
+struct nvme_fabrics_sqe {
+	/** Opcode */
+	uint8_t opcode;
+	/** Flags */
+	uint8_t flags;
+	/** Command identifier */
+	uint16_t cid;
+	/** Fabrics command type */
+	uint8_t fctype;
+	/** Reserved */
+	uint8_t reserved_a[19];
+	/** Data pointer (SGL descriptor 1) */
+	uint8_t dptr[16];
+	/** Fabrics command type specific */
+	union {
+		/** Connect */
+		struct {
+			/** Record format */
+			uint16_t recfmt;
+			/** Queue identifier */
+			uint16_t qid;
+			/** Submission queue size, minus one */
+			uint16_t sqsize;
+			/** Connect attributes */
+			uint8_t cattr;
+			/** Reserved */
+			uint8_t reserved_a;
+			/** Keep-alive timeout (in milliseconds) */
+			uint32_t kato;
+			/** Reserved */
+			uint8_t reserved_b[12];
+		} __attribute__ (( packed )) connect;
+		/** Property get/set */
+		struct {
+			/** Attributes (property size) */
+			uint8_t attrib;
+			/** Reserved */
+			uint8_t reserved_a[3];
+			/** Property offset */
+			uint32_t ofst;
+			/** Property value (for set) */
+			uint64_t value;
+			/** Reserved */
+			uint8_t reserved_b[8];
+		} __attribute__ (( packed )) property;
+	} spec;
+} __attribute__ (( packed ));
+
+/** An NVMe submission queue entry of either format */
+union nvmetcp_sqe {
+	/** Standard command */
+	struct nvme_sqe nvme;
+	/** Fabrics command */
+	struct nvme_fabrics_sqe fabrics;
+};
+
+/** SQE flags value indicating that SGLs are used */
+#define NVME_SQE_FLAG_SGL 0x40
+
+/** NVMe opcodes */
+enum nvme_opcode {
+	/** Write */
+	NVME_OP_WRITE = 0x01,
+	/** Read */
+	NVME_OP_READ = 0x02,
+	/** Identify (admin) */
+	NVME_OP_IDENTIFY = 0x06,
+	/** Fabrics command */
+	NVME_OP_FABRICS = 0x7f,
+};
+
+/** NVMe over Fabrics command types */
+enum nvme_fabrics_type {
+	/** Property set */
+	NVME_FABRICS_PROPERTY_SET = 0x00,
+	/** Connect */
+	NVME_FABRICS_CONNECT = 0x01,
+	/** Property get */
+	NVME_FABRICS_PROPERTY_GET = 0x04,
+};
+
+/** Controller configuration property offset */
+#define NVME_PROPERTY_CC 0x14
+
+/** Controller configuration value (enabled, 64-byte SQEs, 16-byte CQEs) */
+#define NVME_CC_ENABLE 0x00460001UL
+
+/** Controller status property offset */
+#define NVME_PROPERTY_CSTS 0x1c
+
+/** Controller status ready flag */
+#define NVME_CSTS_RDY 0x00000001UL
+
+/** Identify namespace CNS value */
+#define NVME_IDENTIFY_NS 0x00
+
+/** Dynamic controller ID (any available controller) */
+#define NVME_CNTLID_DYNAMIC 0xffff
+
+/** An NVMe over Fabrics connect data block */
+struct nvme_connect_data {
+	/** Host identifier */
+	uint8_t hostid[16];
+	/** Controller ID */
+	uint16_t cntlid;
+	/** Reserved */
+	uint8_t reserved_a[238];
+	/** Subsystem NQN */
+	char subnqn[256];
+	/** Host NQN */
+	char hostnqn[256];
+	/** Reserved */
+	uint8_t reserved_b[256];
+} __attribute__ (( packed ));
+
+/** An NVMe completion queue entry */
+struct nvme_cqe {
+	/** Command specific (or property value low dword) */
+	uint32_t dw0;
+	/** Reserved (or property value high dword) */
+	uint32_t dw1;
+	/** Submission queue head pointer */
+	uint16_t sqhd;
+	/** Submission queue identifier */
+	uint16_t sqid;
+	/** Command identifier */
+	uint16_t cid;
+	/** Status (including phase bit) */
+	uint16_t status;
+} __attribute__ (( packed ));
+
+/** An NVMe LBA format descriptor */
+struct nvme_lbaf {
+	/** Metadata size */
+	uint16_t ms;
+	/** LBA data size (as a power of two) */
+	uint8_t lbads;
+	/** Relative performance */
+	uint8_t rp;
+} __attribute__ (( packed ));
+
+/** An NVMe identify namespace data structure */
+struct nvme_identify_ns {
+	/** Namespace size (in logical blocks) */
+	uint64_t nsze;
+	/** Namespace capacity */
+	uint64_t ncap;
+	/** Namespace utilisation */
+	uint64_t nuse;
+	/** Namespace features */
+	uint8_t nsfeat;
+	/** Number of LBA formats, minus one */
+	uint8_t nlbaf;
+	/** Formatted LBA size */
+	uint8_t flbas;
+	/** Unparsed fields */
+	uint8_t reserved_a[101];
+	/** LBA format descriptors */
+	struct nvme_lbaf lbaf[16];
+	/** Unparsed fields */
+	uint8_t reserved_b[3904];
+} __attribute__ (( packed ));
+
+/** NVMe/TCP command capsule PDU length (header plus SQE) */
+#define NVMETCP_CMD_LEN ( sizeof ( struct nvmetcp_header ) +	\
+			  sizeof ( union nvmetcp_sqe ) )
+
+/** NVMe/TCP data transfer PDU header */
+struct nvmetcp_data {
+	/** Common header */
+	struct nvmetcp_header header;
+	/** Command capsule CID */
+	uint16_t cccid;
+	/** Transfer tag (reserved for controller-to-host data) */
+	uint16_t ttag;
+	/** Data offset */
+	uint32_t datao;
+	/** Data length */
+	uint32_t datal;
+	/** Reserved */
+	uint8_t reserved[4];
+} __attribute__ (( packed ));
+
+/** NVMe/TCP ready-to-transfer PDU */
+struct nvmetcp_r2t {
+	/** Common header */
+	struct nvmetcp_header header;
+	/** Command capsule CID */
+	uint16_t cccid;
+	/** Transfer tag */
+	uint16_t ttag;
+	/** Requested data offset */
+	uint32_t r2to;
+	/** Requested data length */
+	uint32_t r2tl;
+	/** Reserved */
+	uint8_t reserved[4];
+} __attribute__ (( packed ));
+
+/** Any NVMe/TCP PDU header */
+union nvmetcp_pdu {
+	/** Common header */
+	struct nvmetcp_header header;
+	/** Initialise connection response */
+	struct nvmetcp_icresp icresp;
+	/** Response capsule (header plus CQE) */
+	struct {
+		/** Common header */
+		struct nvmetcp_header header;
+		/** Completion queue entry */
+		struct nvme_cqe cqe;
+	} __attribute__ (( packed )) rsp;
+	/** Data transfer header */
+	struct nvmetcp_data data;
+	/** Ready to transfer */
+	struct nvmetcp_r2t r2t;
+};
+
+/** An NVMe/TCP queue (one TCP connection) */
+struct nvmetcp_queue {
+	/** Containing session */
+	struct nvmetcp_session *nvmetcp;
+	/** Socket interface */
+	struct interface socket;
+	/** Queue ID */
+	uint16_t qid;
+	/** Initialise connection request has been sent */
+	int icreq_sent;
+	/** Header digests enabled */
+	int hdgst;
+	/** Data digests enabled */
+	int ddgst;
+	/** Controller PDU data alignment (in bytes) */
+	size_t cpda;
+	/** Maximum length of a host-to-controller data PDU */
+	size_t maxh2cdata;
+	/** Command identifier counter */
+	uint16_t cid;
+
+	/** RX state */
+	unsigned int rx_state;
+	/** Byte offset within current RX state */
+	size_t rx_offset;
+	/** Buffer for received PDU headers */
+	union nvmetcp_pdu rx_pdu;
+	/** Received digest */
+	uint32_t rx_dgst;
+	/** Running data digest */
+	uint32_t rx_crc;
+	/** Length of padding before received data */
+	size_t rx_pad;
+	/** Length of received data */
+	size_t rx_len;
+	/** Destination for received data (or UNULL to discard) */
+	userptr_t rx_dest;
+	/** Maximum permitted received data length */
+	size_t rx_dest_len;
+};
+
+/** NVMe/TCP queue RX states */
+enum nvmetcp_rx_state {
+	/** Common header */
+	NVMETCP_RX_CH = 0,
+	/** Remainder of PDU header */
+	NVMETCP_RX_HEADER,
+	/** Header digest */
+	NVMETCP_RX_HDGST,
+	/** Padding before data */
+	NVMETCP_RX_PAD,
+	/** Data */
+	NVMETCP_RX_DATA,
+	/** Data digest */
+	NVMETCP_RX_DDGST,
+};
+
+/** An NVMe/TCP session */
+struct nvmetcp_session {
+	/** Reference counter */
+	struct refcnt refcnt;
+	/** Block control interface */
+	struct interface block;
+	/** Admin queue */
+	struct nvmetcp_queue admin;
+	/** I/O queue */
+	struct nvmetcp_queue io;
+
+	/** Target URI */
+	struct uri *uri;
+	/** Subsystem NQN */
+	char *subnqn;
+	/** Host NQN */
+	char hostnqn[64];
+	/** Host identifier */
+	uint8_t hostid[16];
+	/** Namespace identifier */
+	uint32_t nsid;
+
+	/** Session status */
+	unsigned int status;
+	/** Controller ID (valid after admin connect) */
+	uint16_t cntlid;
+	/** CID of current admin command */
+	uint16_t admin_cid;
+	/** Number of controller readiness polls remaining */
+	unsigned int ready_polls;
+	/** Identify namespace data (valid during identification) */
+	struct nvme_identify_ns *identify;
+	/** Device capacity */
+	struct block_device_capacity capacity;
+
+	/** List of commands */
+	struct list_head commands;
+};
+
+/** NVMe/TCP session states */
+enum nvmetcp_status {
+	/** Waiting for admin queue initialise connection response */
+	NVMETCP_STATUS_ADMIN_ICREQ = 0,
+	/** Waiting for admin queue connect response */
+	NVMETCP_STATUS_ADMIN_CONNECT,
+	/** Waiting for controller enable response */
+	NVMETCP_STATUS_ENABLE,
+	/** Waiting for controller readiness */
+	NVMETCP_STATUS_READY_WAIT,
+	/** Waiting for namespace identification */
+	NVMETCP_STATUS_IDENTIFY,
+	/** Waiting for I/O queue initialise connection response */
+	NVMETCP_STATUS_IO_ICREQ,
+	/** Waiting for I/O queue connect response */
+	NVMETCP_STATUS_IO_CONNECT,
+	/** Session is ready for I/O commands */
+	NVMETCP_STATUS_READY,
+};
+
+/** An NVMe/TCP command */
+struct nvmetcp_command {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Session */
+	struct nvmetcp_session *nvmetcp;
+	/** List of commands */
+	struct list_head list;
+	/** Block data interface */
+	struct interface block;
+
+	/** Opcode */
+	uint8_t opcode;
+	/** Command identifier */
+	uint16_t cid;
+	/** Command has been issued */
+	int issued;
+	/** Starting logical block address */
+	uint64_t lba;
+	/** Number of blocks */
+	unsigned int count;
+	/** Data buffer */
+	userptr_t buffer;
+	/** Length of data buffer */
+	size_t len;
+};
+
+/** Pseudo-opcode for reporting device capacity */
+#define NVMETCP_OP_READ_CAPACITY 0xff
+
+/** Maximum number of outstanding I/O commands */
+#define NVMETCP_MAX_COMMANDS 4
+
+/** I/O submission queue size (minus one) */
+#define NVMETCP_SQSIZE 31
+
+/** Maximum length of a single host-to-controller data PDU that we
+ * will construct, irrespective of the advertised MAXH2CDATA
+ */
+#define NVMETCP_MAX_H2CDATA_LEN 16384
+
+/** Maximum number of controller readiness polls */
+#define NVMETCP_MAX_READY_POLLS 256
+
+/** Maximum number of blocks per single transfer */
+#define NVMETCP_MAX_BLOCK_COUNT 64
+
+#endif /* _IPXE_NVMETCP_H */
@@ -10,6 +10,7 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
+#include <ipxe/list.h>
 #include <ipxe/dhcpopts.h>
 #include <ipxe/settings.h>
 
@@ -22,8 +23,12 @@ struct refcnt;
 struct nvo_block {
 	/** Settings block */
 	struct settings settings;
+	/** List of registered non-volatile options blocks */
+	struct list_head list;
 	/** Underlying non-volatile storage device */
 	struct nvs_device *nvs;
+	/** Options modified since last write to non-volatile storage */
+	int dirty;
 	/** Address within NVS device */
 	unsigned int address;
 	/** Length of options data */
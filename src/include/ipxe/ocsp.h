@@ -123,19 +123,25 @@ ocsp_put ( struct ocsp_check *ocsp ) {
  * Check if X.509 certificate requires an OCSP check
  *
  * @v cert		X.509 certificate
+ * @v time		Time at which to check certificate
  * @ret ocsp_required	An OCSP check is required
  */
-static inline int ocsp_required ( struct x509_certificate *cert ) {
+static inline int ocsp_required ( struct x509_certificate *cert,
+				  time_t time ) {
 
 	/* An OCSP check is never required if OCSP checks are disabled */
 	if ( ! OCSP_ENABLED )
 		return 0;
 
-	/* An OCSP check is required if an OCSP URI exists but the
-	 * OCSP status is not (yet) good.
+	/* An OCSP check is required if an OCSP URI exists but no good
+	 * OCSP status valid at the specified time has been cached.
+	 * Cached statuses expire at the response's nextUpdate time
+	 * (allowing for some margin of error).
 	 */
 	return ( cert->extensions.auth_info.ocsp.uri.len &&
-		 ( ! cert->extensions.auth_info.ocsp.good ) );
+		 ( ( ! cert->extensions.auth_info.ocsp.good ) ||
+		   ( cert->extensions.auth_info.ocsp.next_update <
+		     ( time - TIMESTAMP_ERROR_MARGIN ) ) ) );
 }
 
 extern int ocsp_check ( struct x509_certificate *cert,
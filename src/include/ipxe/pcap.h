@@ -0,0 +1,108 @@
+#ifndef _IPXE_PCAP_H
+#define _IPXE_PCAP_H
+
+/** @file
+ *
+ * Packet capture
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <config/general.h>
+#include <ipxe/iobuf.h>
+
+#ifdef PCAP_CMD
+#define PCAP_ENABLED 1
+#else
+#define PCAP_ENABLED 0
+#endif
+
+/** Pcap file magic number (native byte order) */
+#define PCAP_MAGIC 0xa1b2c3d4UL
+
+/** Pcap format major version */
+#define PCAP_MAJOR 2
+
+/** Pcap format minor version */
+#define PCAP_MINOR 4
+
+/** Pcap link type for Ethernet frames */
+#define PCAP_LINKTYPE_ETHERNET 1
+
+/** Default capture ring size
+ *
+ * This is a policy decision.
+ */
+#define PCAP_DEFAULT_LEN 65536
+
+/** Default captured ("snap") length per frame
+ *
+ * This is a policy decision: enough to cover link-layer, IP, and
+ * TCP headers plus a little payload.
+ */
+#define PCAP_DEFAULT_SNAP 128
+
+/** A pcap file header
+ *
+ * Fields are in native byte order; the magic number allows readers to
+ * detect the byte order in use.
+ */
+struct pcap_file_header {
+	/** Magic number (PCAP_MAGIC) */
+	uint32_t magic;
+	/** Major version (PCAP_MAJOR) */
+	uint16_t major;
+	/** Minor version (PCAP_MINOR) */
+	uint16_t minor;
+	/** Timezone offset (always zero) */
+	int32_t thiszone;
+	/** Timestamp accuracy (always zero) */
+	uint32_t sigfigs;
+	/** Maximum captured length per frame */
+	uint32_t snaplen;
+	/** Link type (PCAP_LINKTYPE_ETHERNET) */
+	uint32_t network;
+} __attribute__ (( packed ));
+
+/** A pcap per-packet header */
+struct pcap_packet_header {
+	/** Timestamp (seconds) */
+	uint32_t ts_sec;
+	/** Timestamp (microseconds) */
+	uint32_t ts_usec;
+	/** Captured frame length */
+	uint32_t incl_len;
+	/** Original frame length */
+	uint32_t orig_len;
+} __attribute__ (( packed ));
+
+struct image;
+struct net_device;
+
+extern int pcap_armed;
+
+extern void pcap_record ( struct io_buffer *iobuf );
+extern int pcap_arm ( size_t len, size_t snap );
+extern void pcap_disarm ( void );
+extern int pcap_export ( const char *name );
+extern int pcap_replay ( struct image *image, struct net_device *netdev );
+
+/**
+ * Capture packet, if applicable
+ *
+ * @v iobuf		I/O buffer
+ *
+ * Compiles to nothing when packet capture is not included in the
+ * build, and to a single well-predicted branch when no capture is
+ * armed.
+ */
+static inline __attribute__ (( always_inline )) void
+pcap_capture ( struct io_buffer *iobuf ) {
+
+	if ( PCAP_ENABLED && pcap_armed )
+		pcap_record ( iobuf );
+}
+
+#endif /* _IPXE_PCAP_H */
@@ -341,14 +341,49 @@ struct peerdist_info {
 	struct peerdist_range trim;
 	/** Number of segments within the content information */
 	unsigned int segments;
+
+	/** Cached segment cursor
+	 *
+	 * Locating a segment description requires walking the list of
+	 * variable-length segment (and, for version 1, block)
+	 * descriptions from the start of the content information.
+	 * Cache the position of the most recently located segment so
+	 * that the sequential lookups issued during a download do not
+	 * rescan all preceding descriptions for each segment.
+	 */
+	struct {
+		/** Segment index to which the cursor refers */
+		unsigned int index;
+		/** Raw data offset (version-specific), or zero if
+		 * the cursor is invalid
+		 */
+		size_t offset;
+		/** Number of segments remaining within the current
+		 * chunk (version 2 only)
+		 */
+		unsigned int remaining;
+		/** Accumulated length of all preceding segments
+		 * (version 2 only)
+		 */
+		size_t len;
+	} cursor;
 };
 
 /** A content information segment */
 struct peerdist_info_segment {
 	/** Content information */
-	const struct peerdist_info *info;
+	struct peerdist_info *info;
 	/** Segment index */
 	unsigned int index;
+	/** Block description raw data offset (version-specific)
+	 *
+	 * This is the offset of this segment's block description
+	 * within the raw content information, where applicable.  It
+	 * is recorded when the segment is parsed, so that individual
+	 * block lookups do not need to rescan the block description
+	 * list.
+	 */
+	size_t offset;
 
 	/** Content range
 	 *
@@ -437,7 +472,7 @@ extern struct digest_algorithm sha512_trunc_algorithm;
 
 extern int peerdist_info ( userptr_t data, size_t len,
 			   struct peerdist_info *info );
-extern int peerdist_info_segment ( const struct peerdist_info *info,
+extern int peerdist_info_segment ( struct peerdist_info *info,
 				   struct peerdist_info_segment *segment,
 				   unsigned int index );
 extern int peerdist_info_block ( const struct peerdist_info_segment *segment,
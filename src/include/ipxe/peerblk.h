@@ -111,6 +111,8 @@ struct peerdist_block {
 	struct peerdisc_client discovery;
 	/** Current position in discovered peer list */
 	struct peerdisc_peer *peer;
+	/** Peer against which the current attempt is accounted, if any */
+	struct peerdisc_peer *loaded;
 	/** Block download queue */
 	struct peerdist_block_queue *queue;
 	/** List of queued block downloads */
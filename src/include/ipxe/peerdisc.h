@@ -71,6 +71,8 @@ struct peerdisc_segment {
 struct peerdisc_peer {
 	/** List of peers */
 	struct list_head list;
+	/** Number of block downloads currently attempting this peer */
+	unsigned int depth;
 	/** Peer location */
 	char location[0];
 };
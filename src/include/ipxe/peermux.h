@@ -18,8 +18,17 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/xferbuf.h>
 #include <ipxe/pccrc.h>
 
-/** Maximum number of concurrent block downloads */
-#define PEERMUX_MAX_BLOCKS 32
+/** Maximum number of concurrent block downloads
+ *
+ * Enough in-flight blocks must exist to cover the
+ * bandwidth-delay product of the content servers and to keep
+ * fetching while already-received blocks are being decrypted and
+ * verified; per-peer load is bounded separately by the block
+ * download scheduler.
+ *
+ * This is a policy decision.
+ */
+#define PEERMUX_MAX_BLOCKS 64
 
 /** PeerDist download content information cache */
 struct peerdist_info_cache {
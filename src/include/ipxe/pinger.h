@@ -19,6 +19,7 @@ extern int create_pinger ( struct interface *job, const char *hostname,
 			   void ( * callback ) ( struct sockaddr *peer,
 						 unsigned int sequence,
 						 size_t len,
+						 unsigned long rtt,
 						 int rc ) );
 
 #endif /* _IPXE_PINGER_H */
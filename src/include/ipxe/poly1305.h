@@ -0,0 +1,49 @@
+#ifndef _IPXE_POLY1305_H
+#define _IPXE_POLY1305_H
+
+/** @file
+ *
+ * Poly1305 one-time message authentication code
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Poly1305 key length */
+#define POLY1305_KEY_LEN 32
+
+/** Poly1305 authentication tag length */
+#define POLY1305_TAG_LEN 16
+
+/** Poly1305 block length */
+#define POLY1305_BLOCK_LEN 16
+
+/** A Poly1305 context
+ *
+ * The accumulator and multiplier are held as five 26-bit limbs, so
+ * that the 64-bit products within the modular multiplication cannot
+ * overflow even after limbwise addition of partial products.
+ */
+struct poly1305_context {
+	/** Multiplier (r), clamped */
+	uint32_t r[5];
+	/** Final addend (s) */
+	uint32_t s[4];
+	/** Accumulator (h) */
+	uint32_t h[5];
+	/** Data block */
+	uint8_t block[POLY1305_BLOCK_LEN];
+	/** Offset within data block */
+	size_t offset;
+};
+
+extern void poly1305_init ( struct poly1305_context *context,
+			    const void *key );
+extern void poly1305_update ( struct poly1305_context *context,
+			      const void *data, size_t len );
+extern void poly1305_final ( struct poly1305_context *context, void *tag );
+
+#endif /* _IPXE_POLY1305_H */
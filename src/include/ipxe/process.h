@@ -13,6 +13,25 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/refcnt.h>
 #include <ipxe/tables.h>
 
+/** Process priority classes
+ *
+ * Higher-priority (lower-numbered) classes receive a larger share of
+ * scheduler steps: class N is scheduled on one in every 2^(N+1)
+ * steps, with the lowest class absorbing the remainder and any empty
+ * class donating its steps to the highest-priority non-empty class.
+ * A class can therefore never be starved entirely.
+ */
+enum process_priority {
+	/** Latency-sensitive work (e.g. network receive polling) */
+	PROC_PRIO_HIGH = 0,
+	/** Timer-driven work (e.g. retransmission timers) */
+	PROC_PRIO_TIMER,
+	/** Bulk work (the default) */
+	PROC_PRIO_NORMAL,
+	/** Number of priority classes */
+	PROC_PRIO_MAX
+};
+
 /** A process */
 struct process {
 	/** List of processes */
@@ -43,6 +62,8 @@ struct process_descriptor {
 	void ( * step ) ( void *object );
 	/** Automatically reschedule the process */
 	int reschedule;
+	/** Process priority class */
+	unsigned int priority;
 };
 
 /**
@@ -79,11 +100,24 @@ struct process_descriptor {
  * @v step		Process' step() method
  * @ret desc		Object interface descriptor
  */
-#define PROC_DESC( object_type, process, _step ) {			      \
+#define PROC_DESC( object_type, process, _step )			      \
+	PROC_DESC_PRIO ( object_type, process, _step, PROC_PRIO_NORMAL )
+
+/**
+ * Define a process descriptor with a specified priority class
+ *
+ * @v object_type	Containing object data type
+ * @v process		Process name (i.e. field within object data type)
+ * @v step		Process' step() method
+ * @v priority		Process priority class
+ * @ret desc		Object interface descriptor
+ */
+#define PROC_DESC_PRIO( object_type, process, _step, _priority ) {	      \
 		.name = #_step,						      \
 		.offset = process_offset ( object_type, process ),	      \
 		.step = PROC_STEP ( object_type, _step ),		      \
 		.reschedule = 1,					      \
+		.priority = (_priority),				      \
 	}
 
 /**
@@ -99,6 +133,7 @@ struct process_descriptor {
 		.offset = process_offset ( object_type, process ),	      \
 		.step = PROC_STEP ( object_type, _step ),		      \
 		.reschedule = 0,					      \
+		.priority = PROC_PRIO_NORMAL,				      \
 	}
 
 /**
@@ -109,11 +144,23 @@ struct process_descriptor {
  * @v step		Process' step() method
  * @ret desc		Object interface descriptor
  */
-#define PROC_DESC_PURE( _step ) {					      \
+#define PROC_DESC_PURE( _step )					      	      \
+	PROC_DESC_PURE_PRIO ( _step, PROC_PRIO_NORMAL )
+
+/**
+ * Define a process descriptor for a pure process with a specified
+ * priority class
+ *
+ * @v step		Process' step() method
+ * @v priority		Process priority class
+ * @ret desc		Object interface descriptor
+ */
+#define PROC_DESC_PURE_PRIO( _step, _priority ) {			      \
 		.name = #_step,						      \
 		.offset = 0,						      \
 		.step = PROC_STEP ( struct process, _step ),		      \
 		.reschedule = 1,					      \
+		.priority = (_priority),				      \
 	}
 
 extern void * __attribute__ (( pure ))
@@ -191,7 +238,14 @@ process_running ( struct process *process ) {
  *
  */
 #define PERMANENT_PROCESS( name, step )					      \
-static struct process_descriptor name ## _desc = PROC_DESC_PURE ( step );     \
+	PERMANENT_PROCESS_PRIO ( name, step, PROC_PRIO_NORMAL )
+
+/** Define a permanent process with a specified priority class
+ *
+ */
+#define PERMANENT_PROCESS_PRIO( name, step, priority )			      \
+static struct process_descriptor name ## _desc =			      \
+	PROC_DESC_PURE_PRIO ( step, priority );				      \
 struct process name __permanent_process = PROC_INIT ( name, & name ## _desc );
 
 /**
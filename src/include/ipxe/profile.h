@@ -20,6 +20,31 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #endif
 #endif
 
+#ifndef PROFILE_PMC
+
+/** Architecture provides a fixed-function performance counter */
+#define PROFILE_PMC 0
+
+/**
+ * Read fixed-function performance counter
+ *
+ * @ret pmc		Performance counter value
+ */
+static inline __attribute__ (( always_inline )) uint64_t
+profile_pmc ( void ) {
+	return 0;
+}
+
+#endif /* PROFILE_PMC */
+
+/** Number of histogram buckets
+ *
+ * Samples are bucketed by binary order of magnitude: bucket N holds
+ * samples whose most significant set bit is bit (N-1), with bucket 0
+ * holding zero-valued samples.
+ */
+#define PROFILE_BUCKETS ( ( 8 * sizeof ( unsigned long ) ) + 1 )
+
 /**
  * A data structure for storing profiling information
  */
@@ -48,6 +73,14 @@ struct profiler {
 	 * (i.e. one less than would be returned by flsll(raw_accvar)).
 	 */
 	unsigned int accvar_msb;
+	/** Histogram of sample values, bucketed by order of magnitude */
+	unsigned int buckets[PROFILE_BUCKETS];
+	/** Performance counter value at start */
+	unsigned long pmc_started;
+	/** Accumulated performance counter samples */
+	unsigned long long pmc_total;
+	/** Number of performance counter samples */
+	unsigned int pmc_count;
 };
 
 /** Profiler table */
@@ -61,11 +94,17 @@ struct profiler {
 #endif
 
 extern unsigned long profile_excluded;
+extern unsigned long profile_mhz;
+extern int profile_pmc_enabled;
 
+extern int profile_pmc_enable ( void );
+extern unsigned long profile_pmc_mean ( struct profiler *profiler );
 extern void profile_update ( struct profiler *profiler, unsigned long sample );
 extern unsigned long profile_mean ( struct profiler *profiler );
 extern unsigned long profile_variance ( struct profiler *profiler );
 extern unsigned long profile_stddev ( struct profiler *profiler );
+extern unsigned long profile_percentile ( struct profiler *profiler,
+					  unsigned int percentile );
 
 /**
  * Get start time
@@ -131,6 +170,10 @@ profile_start_at ( struct profiler *profiler, unsigned long started ) {
 	/* If profiling is active then record start timestamp */
 	if ( PROFILING )
 		profiler->started = ( started - profile_excluded );
+
+	/* Record performance counter value, if enabled */
+	if ( PROFILING && PROFILE_PMC && profile_pmc_enabled )
+		profiler->pmc_started = profile_pmc();
 }
 
 /**
@@ -147,6 +190,13 @@ profile_stop_at ( struct profiler *profiler, unsigned long stopped ) {
 		profiler->stopped = ( stopped - profile_excluded );
 		profile_update ( profiler, profile_elapsed ( profiler ) );
 	}
+
+	/* Accumulate performance counter delta, if enabled */
+	if ( PROFILING && PROFILE_PMC && profile_pmc_enabled ) {
+		profiler->pmc_total += ( ( ( unsigned long ) profile_pmc() ) -
+					 profiler->pmc_started );
+		profiler->pmc_count++;
+	}
 }
 
 /**
@@ -11,6 +11,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stddef.h>
 #include <assert.h>
+#include <config/general.h>
 
 /**
  * A reference counter
@@ -43,6 +44,33 @@ struct refcnt {
 	void ( * free ) ( struct refcnt *refcnt );
 };
 
+/** Statistics for one class of reference-counted object
+ *
+ * Object classes are identified by their free() method, which is
+ * unique to each type of reference-counted object.  Objects relying
+ * on the default free() (i.e. with a NULL free() method) cannot be
+ * distinguished from each other and are not tracked.
+ */
+struct refcnt_stat {
+	/** Name of free() method, or NULL if entry is unused */
+	const char *name;
+	/** Free method (used as the class identity) */
+	void ( * free ) ( struct refcnt *refcnt );
+	/** Current number of live objects */
+	unsigned int live;
+	/** Peak number of simultaneously live objects */
+	unsigned int peak;
+	/** Total number of objects ever created */
+	unsigned int total;
+};
+
+/** Maximum number of tracked reference-counted object classes */
+#define REFCNT_STAT_MAX 32
+
+extern struct refcnt_stat refcnt_stats[REFCNT_STAT_MAX];
+
+extern void refcnt_stat_init ( struct refcnt *refcnt, const char *name );
+
 /**
  * Initialise a reference counter
  *
@@ -61,6 +89,16 @@ ref_init ( struct refcnt *refcnt,
  * @v refcnt		Reference counter
  * @v free		Free containing object
  */
+#ifdef REFCNT_STATS
+#define ref_init( refcnt, free ) do {					\
+	if ( __builtin_constant_p ( (free) ) && ( (free) == NULL ) ) {	\
+		/* Default-freed objects cannot be tracked */		\
+	} else {							\
+		ref_init ( (refcnt), (free) );				\
+		refcnt_stat_init ( (refcnt), #free );			\
+	}								\
+	} while ( 0 )
+#else
 #define ref_init( refcnt, free ) do {					\
 	if ( __builtin_constant_p ( (free) ) && ( (free) == NULL ) ) {	\
 		/* Skip common case of no initialisation required */	\
@@ -68,6 +106,7 @@ ref_init ( struct refcnt *refcnt,
 		ref_init ( (refcnt), (free) );				\
 	}								\
 	} while ( 0 )
+#endif
 
 /**
  * Initialise a static reference counter
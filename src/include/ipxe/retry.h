@@ -17,9 +17,37 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Default maximum timeout value (in ticks) */
 #define DEFAULT_MAX_TIMEOUT ( 10 * TICKS_PER_SEC )
 
+/** A retry timer profile
+ *
+ * Provides a named per-protocol timeout policy, allowing e.g. LAN
+ * control-plane protocols to retry aggressively without altering the
+ * behaviour of timers (such as the TCP retransmission timer) that
+ * rely on the default policy.
+ */
+struct retry_profile {
+	/** Minimum timeout value (in ticks), or zero to use default */
+	unsigned long min;
+	/** Maximum timeout value (in ticks), or zero to use default */
+	unsigned long max;
+	/** Log2 of the backoff multiplier applied on each expiry
+	 *
+	 * A value of zero disables backoff entirely.
+	 */
+	unsigned int backoff;
+	/** Jitter mask (in ticks), or zero for no jitter
+	 *
+	 * A random value between zero and the mask (which must be one
+	 * less than a power of two) is added to the timeout each time
+	 * the timer is started, to desynchronise retransmissions from
+	 * multiple clients (e.g. a rack of machines booting after a
+	 * power failure).
+	 */
+	unsigned long jitter;
+};
+
 /** A retry timer */
 struct retry_timer {
-	/** List of active timers */
+	/** Timing wheel bucket list */
 	struct list_head list;
 	/** Timer is currently running */
 	unsigned int running;
@@ -51,6 +79,8 @@ struct retry_timer {
 	 * timeout has already exceeded @c max_timeout.
 	 */
 	void ( * expired ) ( struct retry_timer *timer, int over );
+	/** Timer profile, or NULL to use the default profile */
+	const struct retry_profile *profile;
 	/** Reference counter
 	 *
 	 * If this interface is not part of a reference-counted
@@ -125,4 +155,21 @@ set_timer_limits ( struct retry_timer *timer, unsigned long min,
 	timer->max = max;
 }
 
+/**
+ * Set timer profile
+ *
+ * @v timer		Retry timer
+ * @v profile		Retry timer profile, or NULL to use the default
+ *
+ * Note that any limits set via set_timer_limits() take precedence
+ * over the profile's own minimum and maximum timeouts.
+ */
+static inline __attribute__ (( always_inline )) void
+set_timer_profile ( struct retry_timer *timer,
+		    const struct retry_profile *profile ) {
+	timer->profile = profile;
+}
+
+extern const struct retry_profile retry_profile_lan;
+
 #endif /* _IPXE_RETRY_H */
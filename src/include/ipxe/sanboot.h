@@ -43,6 +43,25 @@ struct san_path {
 	struct acpi_descriptor *desc;
 };
 
+/** Maximum number of concurrent fragments per read/write command
+ *
+ * A single read/write command is issued to the underlying block
+ * device as up to this many concurrent fragments, allowing SAN
+ * protocols that support multiple outstanding commands to pipeline
+ * the transfer.  This is a policy decision.
+ */
+#define SANDEV_MAX_FRAGS 4
+
+/** A SAN device read/write command fragment */
+struct san_fragment {
+	/** Data interface */
+	struct interface data;
+	/** Containing SAN device */
+	struct san_device *sandev;
+	/** Fragment status */
+	int rc;
+};
+
 /** A SAN device */
 struct san_device {
 	/** Reference count */
@@ -61,6 +80,21 @@ struct san_device {
 	struct retry_timer timer;
 	/** Command status */
 	int command_rc;
+	/** Read/write command fragments */
+	struct san_fragment frag[SANDEV_MAX_FRAGS];
+	/** Number of fragments still in progress */
+	unsigned int pending;
+
+	/** Block cache lines (most recently used first) */
+	struct list_head cache;
+	/** Expected next sequential logical block address
+	 *
+	 * This is the block immediately following the most recent
+	 * downstream read, and is used to detect sequential runs.
+	 */
+	uint64_t next_lba;
+	/** Current read-ahead length (in blocks) */
+	unsigned int readahead;
 
 	/** Raw block device capacity */
 	struct block_device_capacity capacity;
@@ -12,6 +12,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <ipxe/uaccess.h>
 
+extern void segment_memmap_invalidate ( void );
 extern int prep_segment ( userptr_t segment, size_t filesz, size_t memsz );
 
 #endif /* _IPXE_SEGMENT_H */
@@ -54,6 +54,8 @@ union sha1_digest_data_dwords {
 			sizeof ( uint32_t ) ];
 };
 
+#include <bits/sha1.h>
+
 /** An SHA-1 context */
 struct sha1_context {
 	/** Amount of accumulated data */
@@ -57,6 +57,8 @@ union sha256_digest_data_dwords {
 			sizeof ( uint32_t ) ];
 };
 
+#include <bits/sha256.h>
+
 /** An SHA-256 context */
 struct sha256_context {
 	/** Amount of accumulated data */
@@ -76,6 +78,7 @@ struct sha256_context {
 /** SHA-224 digest size */
 #define SHA224_DIGEST_SIZE ( SHA256_DIGEST_SIZE * 224 / 256 )
 
+extern const uint32_t sha256_k[SHA256_ROUNDS];
 extern void sha256_family_init ( struct sha256_context *context,
 				 const struct sha256_digest *init,
 				 size_t digestsize );
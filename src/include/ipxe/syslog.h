@@ -10,6 +10,7 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <syslog.h>
+#include <ipxe/settings.h>
 
 /** Syslog server port */
 #define SYSLOG_PORT 514
@@ -35,6 +36,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Syslog priority */
 #define SYSLOG_PRIORITY( facility, severity ) ( 8 * (facility) + (severity) )
 
+extern const struct setting syslog_setting __setting ( SETTING_MISC, syslog );
+extern const struct setting syslog6_setting __setting ( SETTING_MISC, syslog6 );
+
 extern int syslog_send ( struct interface *xfer, unsigned int severity,
 			 const char *message, const char *terminator );
 
@@ -351,9 +351,15 @@ struct tcp_options {
  * bandwidth), since in the event of a lost packet the window size
  * represents the maximum amount that will need to be retransmitted.
  *
- * We therefore choose a maximum window size of 256kB.
+ * A window of 256kB is insufficient to fill a 10Gbps pipe even at a
+ * 2ms RTT.  Since the advertised window is additionally budgeted
+ * against the amount of free memory at the time that it is expanded,
+ * a large static maximum no longer risks committing more data to the
+ * receive path than the heap could absorb.  We therefore choose a
+ * maximum window size of 4MB, and rely on the free memory budget to
+ * constrain the window on memory-limited systems.
  */
-#define TCP_MAX_WINDOW_SIZE	( 256 * 1024 )
+#define TCP_MAX_WINDOW_SIZE	( 4 * 1024 * 1024 )
 
 /**
  * Path MTU
@@ -372,12 +378,47 @@ struct tcp_options {
 #define TCP_PATH_MTU							\
 	( 1280 - 40 /* IPv6 */ - 20 /* TCP */ - 12 /* TCP timestamp */ )
 
+/** TCP segmentation offload maximum payload length
+ *
+ * When the transmitting network device is capable of TCP
+ * segmentation offload, we hand it a single oversized segment and
+ * let the device split the payload into individual frames, reducing
+ * the number of times that the transmit path must be traversed.
+ *
+ * The length is limited to keep the transient allocation of the
+ * oversized transmit buffer within reach of the heap.
+ */
+#define TCP_TSO_MAX_LEN ( 16 * 1024 )
+
 /** TCP maximum segment lifetime
  *
  * Currently set to 2 minutes, as per RFC 793.
  */
 #define TCP_MSL ( 2 * 60 * TICKS_PER_SEC )
 
+/** TCP duplicate ACK threshold for fast retransmission
+ *
+ * A lost segment is inferred after this many consecutive ACKs that
+ * acknowledge no new data are received while data remains in flight,
+ * as per RFC 5681.
+ */
+#define TCP_FAST_RETRANS_DUP_ACKS 3
+
+/** TCP initial congestion window (in segments)
+ *
+ * This is the initial window permitted by RFC 3390, and limits the
+ * burst that a newly opened connection may inject into a network
+ * about which it knows nothing.
+ */
+#define TCP_INIT_CWND 3
+
+/** TCP minimum slow start threshold (in segments)
+ *
+ * The slow start threshold is never reduced below this many
+ * segments, as per RFC 5681.
+ */
+#define TCP_MIN_SSTHRESH 2
+
 /**
  * TCP keepalive period
  *
@@ -386,6 +427,16 @@ struct tcp_options {
  */
 #define TCP_KEEPALIVE_DELAY ( 15 * TICKS_PER_SEC )
 
+/**
+ * TCP delayed ACK timeout
+ *
+ * A pure ACK for a lone in-order data segment is delayed by this
+ * period, in the expectation that a further segment will arrive and
+ * allow both to be acknowledged at once.  RFC 1122 requires the
+ * delay to be less than 0.5 seconds.
+ */
+#define TCP_DELACK_DELAY ( TICKS_PER_SEC / 10 )
+
 /**
  * TCP maximum header length
  *
@@ -433,6 +484,44 @@ static inline int tcp_in_window ( uint32_t seq, uint32_t start,
  */
 #define TCP_FINISH_TIMEOUT ( 1 * TICKS_PER_SEC )
 
+/** Per-connection TCP statistics snapshot
+ *
+ * Used to report connection self-diagnosis data (e.g. via the
+ * "tcpstat" command) without exposing the connection structure
+ * itself.
+ */
+struct tcp_stats {
+	/** Local port */
+	unsigned int local_port;
+	/** Smoothed round-trip time (in ticks) */
+	unsigned long srtt;
+	/** Round-trip time variance (in ticks) */
+	unsigned long rttvar;
+	/** Number of round-trip time samples */
+	unsigned int rtt_count;
+	/** Sequence space currently in flight */
+	uint32_t in_flight;
+	/** Peer's advertised receive window */
+	uint32_t snd_win;
+	/** Congestion window */
+	uint32_t snd_cwnd;
+	/** Number of retransmissions */
+	unsigned int retransmits;
+	/** Number of transmit window stalls */
+	unsigned int stalls;
+	/** Total time stalled on a zero transmit window (in ticks) */
+	unsigned long zero_win_time;
+	/** Total time blocked by the local data-transfer interface
+	 * (in ticks)
+	 */
+	unsigned long xfer_block_time;
+};
+
 extern struct tcpip_protocol tcp_protocol __tcpip_protocol;
 
+extern void tcp_rate_sample ( void );
+extern int tcp_rate_window ( unsigned int age, unsigned int *retransmits,
+			     unsigned int *stalls );
+extern int tcp_stats ( unsigned int index, struct tcp_stats *stats );
+
 #endif /* _IPXE_TCP_H */
@@ -0,0 +1,127 @@
+#ifndef _IPXE_TELEMETRY_H
+#define _IPXE_TELEMETRY_H
+
+/** @file
+ *
+ * Binary telemetry export
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+
+/** Telemetry server port
+ *
+ * This is a policy decision.  The telemetry server shares the syslog
+ * server address, but listens on a dedicated port since datagrams are
+ * binary rather than syslog text lines.
+ */
+#define TELEMETRY_PORT 5514
+
+/** Telemetry datagram magic marker ( "iPXT" ) */
+#define TELEMETRY_MAGIC 0x69505854UL
+
+/** Telemetry format version */
+#define TELEMETRY_VERSION 1
+
+/** Maximum telemetry datagram length
+ *
+ * Chosen to fit within a single unfragmented Ethernet frame.
+ */
+#define TELEMETRY_MTU 1400
+
+/** A telemetry datagram header
+ *
+ * All multi-byte fields are in network byte order.
+ */
+struct telemetry_header {
+	/** Magic marker (TELEMETRY_MAGIC) */
+	uint32_t magic;
+	/** Format version (TELEMETRY_VERSION) */
+	uint8_t version;
+	/** Export event (one of enum telemetry_event) */
+	uint8_t event;
+	/** Total datagram length (including this header) */
+	uint16_t len;
+} __attribute__ (( packed ));
+
+/** A telemetry record header
+ *
+ * Records are concatenated after the datagram header.  Unknown record
+ * types may be skipped using the length field.
+ */
+struct telemetry_record {
+	/** Record type (one of enum telemetry_type) */
+	uint8_t type;
+	/** Reserved (must be zero) */
+	uint8_t reserved;
+	/** Payload length (excluding this header) */
+	uint16_t len;
+	/** Payload */
+	uint8_t data[0];
+} __attribute__ (( packed ));
+
+/** Telemetry record types */
+enum telemetry_type {
+	/** Boot milestone */
+	TELEMETRY_MILESTONE = 0x01,
+	/** Profiler result */
+	TELEMETRY_PROFILER = 0x02,
+	/** IP system statistics */
+	TELEMETRY_IPSTAT = 0x03,
+};
+
+/** Telemetry export events */
+enum telemetry_event {
+	/** Network configuration completed (e.g. DHCP) */
+	TELEMETRY_EVENT_CONFIG = 0x01,
+	/** About to execute an image */
+	TELEMETRY_EVENT_EXEC = 0x02,
+};
+
+/** A boot milestone record payload */
+struct telemetry_milestone {
+	/** Milestone name (NUL-padded) */
+	char name[20];
+	/** Timestamp (in milliseconds since power-on) */
+	uint32_t ms;
+} __attribute__ (( packed ));
+
+/** A profiler result record payload */
+struct telemetry_profiler {
+	/** Number of samples */
+	uint32_t count;
+	/** Mean sample value (in profiler timestamp units) */
+	uint32_t mean;
+	/** Sample standard deviation (in profiler timestamp units) */
+	uint32_t stddev;
+	/** Profiler name (NUL-terminated, variable length) */
+	char name[0];
+} __attribute__ (( packed ));
+
+/** An IP system statistics record payload */
+struct telemetry_ipstat {
+	/** IP version */
+	uint8_t version;
+	/** Reserved (must be zero) */
+	uint8_t reserved[3];
+	/** ipSystemStatsInReceives */
+	uint32_t in_receives;
+	/** ipSystemStatsInOctets */
+	uint32_t in_octets;
+	/** ipSystemStatsInHdrErrors */
+	uint32_t in_hdr_errors;
+	/** ipSystemStatsInDelivers */
+	uint32_t in_delivers;
+	/** ipSystemStatsOutRequests */
+	uint32_t out_requests;
+	/** ipSystemStatsOutTransmits */
+	uint32_t out_transmits;
+	/** ipSystemStatsOutOctets */
+	uint32_t out_octets;
+} __attribute__ (( packed ));
+
+extern void telemetry_export ( unsigned int event );
+
+#endif /* _IPXE_TELEMETRY_H */
@@ -71,6 +71,7 @@ struct tls_header {
 #define TLS_CERTIFICATE_VERIFY 15
 #define TLS_CLIENT_KEY_EXCHANGE 16
 #define TLS_FINISHED 20
+#define TLS_CERTIFICATE_STATUS 22
 
 /* TLS alert levels */
 #define TLS_ALERT_WARNING 1
@@ -83,6 +84,9 @@ struct tls_header {
 #define TLS_RSA_WITH_AES_256_CBC_SHA 0x0035
 #define TLS_RSA_WITH_AES_128_CBC_SHA256 0x003c
 #define TLS_RSA_WITH_AES_256_CBC_SHA256 0x003d
+#define TLS_RSA_WITH_AES_128_GCM_SHA256 0x009c
+#define TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256 0xc02f
+#define TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256 0xcca8
 
 /* TLS hash algorithm identifiers */
 #define TLS_MD5_ALGORITHM 1
@@ -106,6 +110,14 @@ struct tls_header {
 #define TLS_MAX_FRAGMENT_LENGTH_2048 3
 #define TLS_MAX_FRAGMENT_LENGTH_4096 4
 
+/* TLS certificate status request extension */
+#define TLS_STATUS_REQUEST 5
+#define TLS_STATUS_TYPE_OCSP 1
+
+/* TLS supported elliptic curves extension */
+#define TLS_ELLIPTIC_CURVES 10
+#define TLS_NAMED_CURVE_X25519 29
+
 /* TLS signature algorithms extension */
 #define TLS_SIGNATURE_ALGORITHMS 13
 
@@ -139,8 +151,31 @@ enum tls_tx_pending {
 	TLS_TX_FINISHED = 0x0020,
 };
 
+/* TLS ephemeral ECDH curve type (named curve) */
+#define TLS_NAMED_CURVE_TYPE 3
+
+struct tls_connection;
+
+/** A TLS key exchange algorithm */
+struct tls_key_exchange_algorithm {
+	/** Algorithm name */
+	const char *name;
+	/**
+	 * Transmit Client Key Exchange record
+	 *
+	 * @v tls		TLS connection
+	 * @ret rc		Return status code
+	 *
+	 * The key exchange mechanism must generate the master secret
+	 * before transmitting the Client Key Exchange record.
+	 */
+	int ( * exchange ) ( struct tls_connection *tls );
+};
+
 /** A TLS cipher suite */
 struct tls_cipher_suite {
+	/** Key exchange algorithm */
+	struct tls_key_exchange_algorithm *exchange;
 	/** Public-key encryption algorithm */
 	struct pubkey_algorithm *pubkey;
 	/** Bulk encryption cipher algorithm */
@@ -151,6 +186,10 @@ struct tls_cipher_suite {
 	uint16_t key_len;
 	/** Numeric code (in network-endian order) */
 	uint16_t code;
+	/** Length of fixed (implicit) portion of an AEAD nonce */
+	uint8_t fixed_iv_len;
+	/** Length of per-record (explicit) portion of an AEAD nonce */
+	uint8_t record_iv_len;
 };
 
 /** TLS cipher suite table */
@@ -295,6 +334,8 @@ struct tls_connection {
 
 	/** Protocol version */
 	uint16_t version;
+	/** Protocol version offered in most recent Client Hello */
+	uint16_t client_version;
 	/** Current TX cipher specification */
 	struct tls_cipherspec tx_cipherspec;
 	/** Next TX cipher specification */
@@ -303,8 +344,6 @@ struct tls_connection {
 	struct tls_cipherspec rx_cipherspec;
 	/** Next RX cipher specification */
 	struct tls_cipherspec rx_cipherspec_pending;
-	/** Premaster secret */
-	struct tls_pre_master_secret pre_master_secret;
 	/** Master secret */
 	uint8_t master_secret[48];
 	/** Server random bytes */
@@ -326,8 +365,19 @@ struct tls_connection {
 	/** Verification data */
 	struct tls_verify_data verify;
 
+	/** Server Key Exchange record (if any) */
+	void *server_key;
+	/** Length of Server Key Exchange record */
+	size_t server_key_len;
+
 	/** Server certificate chain */
 	struct x509_chain *chain;
+	/** Digest of server Certificate message contents */
+	uint8_t chain_digest[SHA256_DIGEST_SIZE];
+	/** Stapled OCSP response */
+	void *staple;
+	/** Length of stapled OCSP response */
+	size_t staple_len;
 	/** Certificate validator */
 	struct interface validator;
 
@@ -378,6 +428,9 @@ struct tls_connection {
 /** RX I/O buffer alignment */
 #define TLS_RX_ALIGN 16
 
+extern struct tls_key_exchange_algorithm tls_pubkey_exchange_algorithm;
+extern struct tls_key_exchange_algorithm tls_ecdhe_exchange_algorithm;
+
 extern int add_tls ( struct interface *xfer, const char *name,
 		     struct interface **next );
 
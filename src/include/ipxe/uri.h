@@ -204,7 +204,7 @@ extern unsigned int uri_port ( const struct uri *uri,
 extern struct uri * uri_dup ( const struct uri *uri );
 extern char * resolve_path ( const char *base_path,
 			     const char *relative_path );
-extern struct uri * resolve_uri ( const struct uri *base_uri,
+extern struct uri * resolve_uri ( struct uri *base_uri,
 				  struct uri *relative_uri );
 extern struct uri * pxe_uri ( struct sockaddr *sa_server,
 			      const char *filename );
@@ -18,6 +18,8 @@
 /* Virtio feature flags used to negotiate device and driver features. */
 /* Can the device handle any descriptor layout? */
 #define VIRTIO_F_ANY_LAYOUT             27
+/* The ring supports avail_event/used_event notification suppression. */
+#define VIRTIO_RING_F_EVENT_IDX         29
 /* v1.0 compliant. */
 #define VIRTIO_F_VERSION_1              32
 #define VIRTIO_F_IOMMU_PLATFORM         33
@@ -66,17 +68,43 @@ struct vring {
    struct vring_used *used;
 };
 
+/* The additional u16 at the end of each ring holds the used_event and
+ * avail_event indices used for VIRTIO_RING_F_EVENT_IDX notification
+ * suppression.
+ */
 #define vring_size(num) \
    (((((sizeof(struct vring_desc) * num) + \
-      (sizeof(struct vring_avail) + sizeof(u16) * num)) \
+      (sizeof(struct vring_avail) + sizeof(u16) * (num + 1))) \
          + PAGE_MASK) & ~PAGE_MASK) + \
-         (sizeof(struct vring_used) + sizeof(struct vring_used_elem) * num))
+         (sizeof(struct vring_used) + \
+          sizeof(struct vring_used_elem) * num + sizeof(u16)))
+
+/* Driver-written index of the most recently processed used entry;
+ * with VIRTIO_RING_F_EVENT_IDX the device interrupts only when the
+ * used index passes this value.
+ */
+#define vring_used_event(vr)  ((vr)->avail->ring[(vr)->num])
+
+/* Device-written index; the driver need notify only when the avail
+ * index passes this value.
+ */
+#define vring_avail_event(vr) (*(u16 *)&(vr)->used->ring[(vr)->num])
+
+/* Would the device (or driver) writing new_idx, having last seen
+ * old_idx, cross the event index?
+ */
+static inline int vring_need_event(u16 event_idx, u16 new_idx, u16 old_idx)
+{
+   return (u16)(new_idx - event_idx - 1) < (u16)(new_idx - old_idx);
+}
 
 struct vring_virtqueue {
    unsigned char *queue;
    struct vring vring;
    u16 free_head;
    u16 last_used_idx;
+   /* VIRTIO_RING_F_EVENT_IDX has been negotiated */
+   int event_idx;
    void **vdata;
    /* PCI */
    int queue_index;
@@ -117,11 +145,19 @@ static inline void vring_init(struct vring *vr,
 
 static inline void vring_enable_cb(struct vring_virtqueue *vq)
 {
+   if (vq->event_idx)
+           vring_used_event(&vq->vring) = vq->last_used_idx;
    vq->vring.avail->flags &= ~VRING_AVAIL_F_NO_INTERRUPT;
 }
 
 static inline void vring_disable_cb(struct vring_virtqueue *vq)
 {
+   /* With VIRTIO_RING_F_EVENT_IDX the device ignores the interrupt
+    * suppression flag, so push the used event index far into the
+    * future as well.
+    */
+   if (vq->event_idx)
+           vring_used_event(&vq->vring) = (u16)(vq->last_used_idx - 1);
    vq->vring.avail->flags |= VRING_AVAIL_F_NO_INTERRUPT;
 }
 
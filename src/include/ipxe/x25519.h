@@ -0,0 +1,21 @@
+#ifndef _IPXE_X25519_H
+#define _IPXE_X25519_H
+
+/** @file
+ *
+ * X25519 key exchange
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+
+/** Length of an X25519 scalar, point, or shared secret */
+#define X25519_LEN 32
+
+extern const uint8_t x25519_base[X25519_LEN];
+
+extern int x25519 ( const void *scalar, const void *point, void *result );
+
+#endif /* _IPXE_X25519_H */
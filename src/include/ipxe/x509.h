@@ -130,6 +130,8 @@ struct x509_ocsp_responder {
 	struct asn1_cursor uri;
 	/** OCSP status is good */
 	int good;
+	/** Expiry time of cached OCSP status */
+	time_t next_update;
 };
 
 /** X.509 certificate authority information access */
@@ -224,6 +226,8 @@ enum x509_flags {
 	X509_FL_PERMANENT = 0x0002,
 	/** Certificate was added explicitly at run time */
 	X509_FL_EXPLICIT = 0x0004,
+	/** Certificate is eligible for the persistent certificate cache */
+	X509_FL_CACHEABLE = 0x0008,
 };
 
 /**
@@ -23,6 +23,13 @@ struct xfer_buffer {
 	size_t len;
 	/** Current offset within data */
 	size_t pos;
+	/** Allocated capacity of data
+	 *
+	 * The backing store is grown geometrically, and so may be
+	 * larger than the current size of data.  Unused capacity can
+	 * be released with xferbuf_trim().
+	 */
+	size_t cap;
 	/** Data transfer buffer operations */
 	struct xfer_buffer_operations *op;
 };
@@ -62,10 +69,22 @@ struct xfer_buffer_operations {
 	 */
 	void ( * read ) ( struct xfer_buffer *xferbuf, size_t offset,
 			  void *data, size_t len );
+	/** Map data buffer
+	 *
+	 * @v xferbuf		Data transfer buffer
+	 * @v offset		Starting offset
+	 * @ret map		Mapping of data buffer at specified offset
+	 *
+	 * This call is simply a wrapper for the appropriate address
+	 * conversion: the caller is responsible for ensuring that the
+	 * mapped region does not exceed the buffer length.
+	 */
+	userptr_t ( * map ) ( struct xfer_buffer *xferbuf, size_t offset );
 };
 
 extern struct xfer_buffer_operations xferbuf_malloc_operations;
 extern struct xfer_buffer_operations xferbuf_umalloc_operations;
+extern struct xfer_buffer_operations xferbuf_fixed_operations;
 
 /**
  * Initialise malloc()-based data transfer buffer
@@ -89,11 +108,30 @@ xferbuf_umalloc_init ( struct xfer_buffer *xferbuf, userptr_t *data ) {
 	xferbuf->op = &xferbuf_umalloc_operations;
 }
 
+/**
+ * Initialise fixed-size caller-owned data transfer buffer
+ *
+ * @v xferbuf		Data transfer buffer
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ */
+static inline __attribute__ (( always_inline )) void
+xferbuf_fixed_init ( struct xfer_buffer *xferbuf, void *data, size_t len ) {
+	xferbuf->data = data;
+	xferbuf->len = 0;
+	xferbuf->pos = 0;
+	xferbuf->cap = len;
+	xferbuf->op = &xferbuf_fixed_operations;
+}
+
 extern void xferbuf_free ( struct xfer_buffer *xferbuf );
 extern int xferbuf_write ( struct xfer_buffer *xferbuf, size_t offset,
 			   const void *data, size_t len );
 extern int xferbuf_read ( struct xfer_buffer *xferbuf, size_t offset,
 			  void *data, size_t len );
+extern userptr_t xferbuf_map ( struct xfer_buffer *xferbuf, size_t offset,
+			       size_t len );
+extern int xferbuf_trim ( struct xfer_buffer *xferbuf );
 extern int xferbuf_deliver ( struct xfer_buffer *xferbuf,
 			     struct io_buffer *iobuf,
 			     struct xfer_metadata *meta );
@@ -8,6 +8,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 extern void putchar ( int character );
 
+extern void putchars ( const char *data, size_t len );
+
 extern int getchar ( void );
 
 extern int __attribute__ (( format ( printf, 1, 2 ) ))
@@ -17,6 +17,7 @@ extern int ifconf ( struct net_device *netdev,
 		    struct net_device_configurator *configurator );
 extern void ifclose ( struct net_device *netdev );
 extern void ifstat ( struct net_device *netdev );
+extern void ifstat_history ( struct net_device *netdev );
 extern int iflinkwait ( struct net_device *netdev, unsigned long timeout );
 
 #endif /* _USR_IFMGMT_H */
@@ -15,6 +15,9 @@ extern int imgdownload ( struct uri *uri, unsigned long timeout,
 			 struct image **image );
 extern int imgdownload_string ( const char *uri_string, unsigned long timeout,
 				struct image **image );
+extern int imgdownload_bg_string ( const char *uri_string,
+				   struct image **image );
+extern int imgwait ( unsigned long timeout );
 extern int imgacquire ( const char *name, unsigned long timeout,
 			struct image **image );
 extern void imgstat ( struct image *image );
@@ -0,0 +1,27 @@
+#ifndef _USR_NETBENCH_H
+#define _USR_NETBENCH_H
+
+/** @file
+ *
+ * Network benchmarking
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stddef.h>
+
+/** Network benchmark modes */
+enum netbench_mode {
+	/** Transmit UDP datagrams at the maximum achievable rate */
+	NETBENCH_UDP_TX = 0,
+	/** Receive UDP datagrams and account for sequence gaps */
+	NETBENCH_UDP_RX,
+	/** Transmit a bulk TCP stream */
+	NETBENCH_TCP_TX,
+};
+
+extern int netbench ( int mode, const char *hostname, unsigned int port,
+		      size_t len, unsigned long duration );
+
+#endif /* _USR_NETBENCH_H */
@@ -0,0 +1,14 @@
+#ifndef _USR_REFSTAT_H
+#define _USR_REFSTAT_H
+
+/** @file
+ *
+ * Reference-counted object statistics
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+extern void refstat ( void );
+
+#endif /* _USR_REFSTAT_H */
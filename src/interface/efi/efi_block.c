@@ -49,6 +49,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/acpi.h>
 #include <ipxe/efi/efi.h>
 #include <ipxe/efi/Protocol/BlockIo.h>
+#include <ipxe/efi/Protocol/BlockIo2.h>
 #include <ipxe/efi/Protocol/SimpleFileSystem.h>
 #include <ipxe/efi/Protocol/AcpiTable.h>
 #include <ipxe/efi/efi_driver.h>
@@ -91,6 +92,8 @@ struct efi_block_data {
 	EFI_BLOCK_IO_MEDIA media;
 	/** Block I/O protocol */
 	EFI_BLOCK_IO_PROTOCOL block_io;
+	/** Block I/O version 2 protocol */
+	EFI_BLOCK_IO2_PROTOCOL block_io2;
 	/** Device path protocol */
 	EFI_DEVICE_PATH_PROTOCOL *path;
 };
@@ -224,6 +227,128 @@ efi_block_io_flush ( EFI_BLOCK_IO_PROTOCOL *block_io ) {
 	return 0;
 }
 
+/**
+ * Signal completion token for EFI block device operation
+ *
+ * @v token		Operation token, or NULL
+ *
+ * The SAN device supports only a single outstanding command, and so
+ * all operations are carried out synchronously: by the time the token
+ * is signalled, the operation has already completed successfully.
+ */
+static void efi_block_io2_signal ( EFI_BLOCK_IO2_TOKEN *token ) {
+	EFI_BOOT_SERVICES *bs = efi_systab->BootServices;
+
+	/* Do nothing unless the caller requested a non-blocking operation */
+	if ( ( ! token ) || ( ! token->Event ) )
+		return;
+
+	/* Record transaction status and signal completion event */
+	token->TransactionStatus = 0;
+	bs->SignalEvent ( token->Event );
+}
+
+/**
+ * Reset EFI block device (via version 2 protocol)
+ *
+ * @v block_io2		Block I/O version 2 protocol
+ * @v verify		Perform extended verification
+ * @ret efirc		EFI status code
+ */
+static EFI_STATUS EFIAPI
+efi_block_io2_reset ( EFI_BLOCK_IO2_PROTOCOL *block_io2,
+		      BOOLEAN verify ) {
+	struct efi_block_data *block =
+		container_of ( block_io2, struct efi_block_data, block_io2 );
+
+	return efi_block_io_reset ( &block->block_io, verify );
+}
+
+/**
+ * Read from EFI block device (via version 2 protocol)
+ *
+ * @v block_io2		Block I/O version 2 protocol
+ * @v media		Media identifier
+ * @v lba		Starting LBA
+ * @v token		Operation token
+ * @v len		Size of buffer
+ * @v data		Data buffer
+ * @ret efirc		EFI status code
+ */
+static EFI_STATUS EFIAPI
+efi_block_io2_read ( EFI_BLOCK_IO2_PROTOCOL *block_io2, UINT32 media,
+		     EFI_LBA lba, EFI_BLOCK_IO2_TOKEN *token, UINTN len,
+		     VOID *data ) {
+	struct efi_block_data *block =
+		container_of ( block_io2, struct efi_block_data, block_io2 );
+	EFI_STATUS efirc;
+
+	/* Read from block device.  If the operation fails, return the
+	 * error directly and leave the token unsignalled (as required
+	 * by the UEFI specification).
+	 */
+	if ( ( efirc = efi_block_io_read ( &block->block_io, media, lba,
+					   len, data ) ) != 0 )
+		return efirc;
+
+	/* Signal completion, if applicable */
+	efi_block_io2_signal ( token );
+
+	return 0;
+}
+
+/**
+ * Write to EFI block device (via version 2 protocol)
+ *
+ * @v block_io2		Block I/O version 2 protocol
+ * @v media		Media identifier
+ * @v lba		Starting LBA
+ * @v token		Operation token
+ * @v len		Size of buffer
+ * @v data		Data buffer
+ * @ret efirc		EFI status code
+ */
+static EFI_STATUS EFIAPI
+efi_block_io2_write ( EFI_BLOCK_IO2_PROTOCOL *block_io2, UINT32 media,
+		      EFI_LBA lba, EFI_BLOCK_IO2_TOKEN *token, UINTN len,
+		      VOID *data ) {
+	struct efi_block_data *block =
+		container_of ( block_io2, struct efi_block_data, block_io2 );
+	EFI_STATUS efirc;
+
+	/* Write to block device */
+	if ( ( efirc = efi_block_io_write ( &block->block_io, media, lba,
+					    len, data ) ) != 0 )
+		return efirc;
+
+	/* Signal completion, if applicable */
+	efi_block_io2_signal ( token );
+
+	return 0;
+}
+
+/**
+ * Flush data to EFI block device (via version 2 protocol)
+ *
+ * @v block_io2		Block I/O version 2 protocol
+ * @v token		Operation token
+ * @ret efirc		EFI status code
+ */
+static EFI_STATUS EFIAPI
+efi_block_io2_flush ( EFI_BLOCK_IO2_PROTOCOL *block_io2,
+		      EFI_BLOCK_IO2_TOKEN *token ) {
+	struct efi_block_data *block =
+		container_of ( block_io2, struct efi_block_data, block_io2 );
+	struct san_device *sandev = block->sandev;
+
+	DBGC2 ( sandev, "EFIBLK %#02x flush (ex)\n", sandev->drive );
+
+	/* Nothing to do, other than signal completion */
+	efi_block_io2_signal ( token );
+
+	return 0;
+}
+
 /**
  * Connect all possible drivers to EFI block device
  *
@@ -311,6 +436,11 @@ static int efi_block_hook ( unsigned int drive, struct uri **uris,
 	block->block_io.ReadBlocks = efi_block_io_read;
 	block->block_io.WriteBlocks = efi_block_io_write;
 	block->block_io.FlushBlocks = efi_block_io_flush;
+	block->block_io2.Media = &block->media;
+	block->block_io2.Reset = efi_block_io2_reset;
+	block->block_io2.ReadBlocksEx = efi_block_io2_read;
+	block->block_io2.WriteBlocksEx = efi_block_io2_write;
+	block->block_io2.FlushBlocksEx = efi_block_io2_flush;
 	uri_buf = ( ( ( void * ) block ) + sizeof ( *block ) );
 	block->path = ( ( ( void * ) uri_buf ) + uri_len + 1 /* NUL */ );
 
@@ -349,6 +479,7 @@ static int efi_block_hook ( unsigned int drive, struct uri **uris,
 	if ( ( efirc = bs->InstallMultipleProtocolInterfaces (
 			&block->handle,
 			&efi_block_io_protocol_guid, &block->block_io,
+			&efi_block_io2_protocol_guid, &block->block_io2,
 			&efi_device_path_protocol_guid, block->path,
 			NULL ) ) != 0 ) {
 		rc = -EEFI ( efirc );
@@ -365,6 +496,7 @@ static int efi_block_hook ( unsigned int drive, struct uri **uris,
 	bs->UninstallMultipleProtocolInterfaces (
 			block->handle,
 			&efi_block_io_protocol_guid, &block->block_io,
+			&efi_block_io2_protocol_guid, &block->block_io2,
 			&efi_device_path_protocol_guid, block->path, NULL );
  err_install:
 	unregister_sandev ( sandev );
@@ -398,6 +530,7 @@ static void efi_block_unhook ( unsigned int drive ) {
 	bs->UninstallMultipleProtocolInterfaces (
 			block->handle,
 			&efi_block_io_protocol_guid, &block->block_io,
+			&efi_block_io2_protocol_guid, &block->block_io2,
 			&efi_device_path_protocol_guid, block->path, NULL );
 
 	/* Unregister SAN device */
@@ -63,6 +63,42 @@ FILE_LICENCE ( GPL2_OR_LATER );
 /** Current character attribute */
 static unsigned int efi_attr = ATTR_DEFAULT;
 
+/** Most recently applied character attribute, or negative if unknown */
+static int efi_attr_applied = -1;
+
+/** Buffered output pending a call to OutputString()
+ *
+ * Calls to OutputString() can be remarkably slow (of the order of
+ * milliseconds per call on some serial-over-LAN implementations), so
+ * runs of printable characters are buffered and emitted in a single
+ * call.  The buffer is flushed whenever a control character or escape
+ * sequence is processed (to preserve ordering of cursor movements,
+ * attribute changes, and screen clears), whenever the buffer fills,
+ * and before checking for or reading input (so that unterminated
+ * prompts and progress indicators appear promptly).
+ */
+static wchar_t efi_wbuf[ 80 + 1 /* wNUL */ ];
+
+/** Number of characters currently in output buffer */
+static unsigned int efi_wbuf_used;
+
+/**
+ * Flush any buffered output to EFI console
+ *
+ */
+static void efi_flush ( void ) {
+	EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *conout = efi_systab->ConOut;
+
+	/* Do nothing unless characters are buffered */
+	if ( ! efi_wbuf_used )
+		return;
+
+	/* Print buffered characters */
+	efi_wbuf[efi_wbuf_used] = L'\0';
+	efi_wbuf_used = 0;
+	conout->OutputString ( conout, efi_wbuf );
+}
+
 /** Console control protocol */
 static EFI_CONSOLE_CONTROL_PROTOCOL *conctrl;
 EFI_REQUEST_PROTOCOL ( EFI_CONSOLE_CONTROL_PROTOCOL, &conctrl );
@@ -149,6 +185,14 @@ static void efi_handle_sgr ( struct ansiesc_context *ctx __unused,
 		}
 	}
 
+	/* Skip redundant attribute changes: SGR sequences are
+	 * frequently emitted to reassert an attribute that is already
+	 * in effect, and SetAttribute() can be slow on some consoles.
+	 */
+	if ( ( ( int ) efi_attr ) == efi_attr_applied )
+		return;
+	efi_attr_applied = efi_attr;
+
 	conout->SetAttribute ( conout, efi_attr );
 }
 
@@ -206,11 +250,28 @@ static void efi_putchar ( int character ) {
 	EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL *conout = efi_systab->ConOut;
 	wchar_t wstr[] = { character, 0 };
 
+	/* Flush any buffered output before processing a control
+	 * character or escape sequence, so that cursor movements,
+	 * attribute changes, and screen clears take effect in order.
+	 */
+	if ( ( character < 0x20 ) || ( character > 0x7e ) )
+		efi_flush();
+
 	/* Intercept ANSI escape sequences */
 	character = ansiesc_process ( &efi_ansiesc_ctx, character );
 	if ( character < 0 )
 		return;
 
+	/* Buffer printable characters, flushing when the buffer fills */
+	if ( ( character >= 0x20 ) && ( character <= 0x7e ) ) {
+		efi_wbuf[efi_wbuf_used++] = character;
+		if ( efi_wbuf_used >= ( ( sizeof ( efi_wbuf ) /
+					  sizeof ( efi_wbuf[0] ) ) - 1 ) )
+			efi_flush();
+		return;
+	}
+
+	/* Print control characters (e.g. newlines) immediately */
 	conout->OutputString ( conout, wstr );
 }
 
@@ -283,6 +344,9 @@ static int efi_getchar ( void ) {
 	EFI_STATUS efirc;
 	int rc;
 
+	/* Flush any buffered output, so that prompts are visible */
+	efi_flush();
+
 	/* If we are mid-sequence, pass out the next byte */
 	if ( *ansi_input )
 		return *(ansi_input++);
@@ -321,6 +385,12 @@ static int efi_iskey ( void ) {
 	EFI_SIMPLE_TEXT_INPUT_PROTOCOL *conin = efi_systab->ConIn;
 	EFI_STATUS efirc;
 
+	/* Flush any buffered output.  Callers (such as the job
+	 * progress monitor) poll for input at least every timer tick,
+	 * which bounds the latency of unterminated output lines.
+	 */
+	efi_flush();
+
 	/* If we are mid-sequence, we are always ready */
 	if ( *ansi_input )
 		return 1;
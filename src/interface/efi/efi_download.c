@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #include <ipxe/process.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/xfer.h>
+#include <ipxe/xferbuf.h>
 #include <ipxe/efi/efi.h>
 #include <ipxe/efi/efi_snp.h>
 #include <ipxe/efi/efi_download.h>
@@ -41,12 +42,18 @@ struct efi_download_file {
 	/** Current file position */
 	size_t pos;
 
-	/** Data callback */
+	/** Data callback, or NULL if downloading direct to buffer */
 	IPXE_DOWNLOAD_DATA_CALLBACK data_callback;
 
 	/** Finish callback */
 	IPXE_DOWNLOAD_FINISH_CALLBACK finish_callback;
 
+	/** Caller-provided destination buffer (direct-to-buffer mode) */
+	struct xfer_buffer buffer;
+
+	/** Finish callback (direct-to-buffer mode) */
+	IPXE_DOWNLOAD_BUFFER_FINISH_CALLBACK buffer_finish_callback;
+
 	/** Callback context */
 	void *context;
 };
@@ -61,7 +68,12 @@ struct efi_download_file {
  */
 static void efi_download_close ( struct efi_download_file *file, int rc ) {
 
-	file->finish_callback ( file->context, EFIRC ( rc ) );
+	if ( file->finish_callback ) {
+		file->finish_callback ( file->context, EFIRC ( rc ) );
+	} else if ( file->buffer_finish_callback ) {
+		file->buffer_finish_callback ( file->context, EFIRC ( rc ),
+					       file->buffer.len );
+	}
 
 	intf_shutdown ( &file->xfer, rc );
 
@@ -83,6 +95,13 @@ static int efi_download_deliver_iob ( struct efi_download_file *file,
 	size_t len = iob_len ( iobuf );
 	int rc;
 
+	/* Write data directly into the destination buffer at its
+	 * final offset, if downloading direct to buffer.
+	 */
+	if ( ! file->data_callback )
+		return xferbuf_deliver ( &file->buffer, iob_disown ( iobuf ),
+					 meta );
+
 	/* Calculate new buffer position */
 	if ( meta->flags & XFER_FL_ABS_OFFSET )
 		file->pos = 0;
@@ -106,9 +125,29 @@ static int efi_download_deliver_iob ( struct efi_download_file *file,
 	return rc;
 }
 
+/**
+ * Get underlying data transfer buffer
+ *
+ * @v file		Data transfer file
+ * @ret xferbuf		Data transfer buffer, or NULL on error
+ */
+static struct xfer_buffer *
+efi_download_buffer ( struct efi_download_file *file ) {
+
+	/* Expose the destination buffer only in direct-to-buffer
+	 * mode, allowing the download source to write received data
+	 * directly into its final location where supported.
+	 */
+	if ( file->data_callback )
+		return NULL;
+
+	return &file->buffer;
+}
+
 /** Data transfer interface operations */
 static struct interface_operation efi_xfer_operations[] = {
 	INTF_OP ( xfer_deliver, struct efi_download_file *, efi_download_deliver_iob ),
+	INTF_OP ( xfer_buffer, struct efi_download_file *, efi_download_buffer ),
 	INTF_OP ( intf_close, struct efi_download_file *, efi_download_close ),
 };
 
@@ -138,7 +177,7 @@ efi_download_start ( IPXE_DOWNLOAD_PROTOCOL *This __unused,
 	struct efi_download_file *file;
 	int rc;
 
-	file = malloc ( sizeof ( struct efi_download_file ) );
+	file = zalloc ( sizeof ( struct efi_download_file ) );
 	if ( file == NULL ) {
 		return EFI_OUT_OF_RESOURCES;
 	}
@@ -159,6 +198,53 @@ efi_download_start ( IPXE_DOWNLOAD_PROTOCOL *This __unused,
 	return EFI_SUCCESS;
 }
 
+/**
+ * Start downloading a file directly into a caller-provided buffer.
+ *
+ * Downloaded data is written directly into the buffer at its final
+ * file offset, with no intermediate data callbacks.  The download
+ * will be aborted if the file exceeds the buffer size.
+ *
+ * @v This		iPXE Download Protocol instance
+ * @v Url		URL to download from
+ * @v Buffer		Destination buffer
+ * @v BufferSize	Size of destination buffer in bytes
+ * @v FinishCallback	Callback that will be invoked when the download ends
+ * @v Context		Context passed to the Finish callback
+ * @v File		Token that can be used to abort the download
+ * @ret Status		EFI status code
+ */
+static EFI_STATUS EFIAPI
+efi_download_start_buffer ( IPXE_DOWNLOAD_PROTOCOL *This __unused,
+			    CHAR8 *Url,
+			    VOID *Buffer,
+			    UINTN BufferSize,
+			    IPXE_DOWNLOAD_BUFFER_FINISH_CALLBACK FinishCallback,
+			    VOID *Context,
+			    IPXE_DOWNLOAD_FILE *File ) {
+	struct efi_download_file *file;
+	int rc;
+
+	file = zalloc ( sizeof ( struct efi_download_file ) );
+	if ( file == NULL ) {
+		return EFI_OUT_OF_RESOURCES;
+	}
+	xferbuf_fixed_init ( &file->buffer, Buffer, BufferSize );
+
+	intf_init ( &file->xfer, &efi_download_file_xfer_desc, NULL );
+	rc = xfer_open ( &file->xfer, LOCATION_URI_STRING, Url );
+	if ( rc ) {
+		free ( file );
+		return EFIRC ( rc );
+	}
+
+	efi_snp_claim();
+	file->buffer_finish_callback = FinishCallback;
+	file->context = Context;
+	*File = file;
+	return EFI_SUCCESS;
+}
+
 /**
  * Forcibly abort downloading a file that is currently in progress.
  *
@@ -196,7 +282,8 @@ efi_download_poll ( IPXE_DOWNLOAD_PROTOCOL *This __unused ) {
 static IPXE_DOWNLOAD_PROTOCOL ipxe_download_protocol_interface = {
 	.Start = efi_download_start,
 	.Abort = efi_download_abort,
-	.Poll = efi_download_poll
+	.Poll = efi_download_poll,
+	.StartBuffer = efi_download_start_buffer
 };
 
 /**
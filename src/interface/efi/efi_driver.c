@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #include <string.h>
 #include <errno.h>
 #include <ipxe/version.h>
+#include <ipxe/timer.h>
 #include <ipxe/efi/efi.h>
 #include <ipxe/efi/Protocol/DriverBinding.h>
 #include <ipxe/efi/Protocol/ComponentName2.h>
@@ -422,6 +423,9 @@ static int efi_driver_connect ( EFI_HANDLE device ) {
 	EFI_BOOT_SERVICES *bs = efi_systab->BootServices;
 	EFI_HANDLE drivers[2] =
 		{ efi_driver_binding.DriverBindingHandle, NULL };
+	unsigned long started;
+	unsigned long disconnected;
+	unsigned long connected;
 	EFI_STATUS efirc;
 	int rc;
 
@@ -432,6 +436,12 @@ static int efi_driver_connect ( EFI_HANDLE device ) {
 		return 0;
 	}
 
+	/* Record timings per handle, since Disconnect/ConnectController
+	 * on some firmware implementations can each take tens of
+	 * milliseconds, and slow paths are otherwise invisible.
+	 */
+	started = currticks();
+
 	/* Disconnect any existing drivers */
 	DBGC2 ( device, "EFIDRV %s before disconnecting:\n",
 		efi_handle_name ( device ) );
@@ -448,6 +458,7 @@ static int efi_driver_connect ( EFI_HANDLE device ) {
 		/* Ignore the error and attempt to connect our drivers */
 	}
 	efi_driver_disconnecting = 0;
+	disconnected = currticks();
 	DBGC2 ( device, "EFIDRV %s after disconnecting:\n",
 		efi_handle_name ( device ) );
 	DBGC2_EFI_PROTOCOLS ( device, device );
@@ -458,10 +469,17 @@ static int efi_driver_connect ( EFI_HANDLE device ) {
 	if ( ( efirc = bs->ConnectController ( device, drivers, NULL,
 					       FALSE ) ) != 0 ) {
 		rc = -EEFI ( efirc );
-		DBGC ( device, "EFIDRV %s could not connect new drivers: "
-		       "%s\n", efi_handle_name ( device ), strerror ( rc ) );
+		DBGC ( device, "EFIDRV %s could not connect new drivers after "
+		       "%ldms: %s\n", efi_handle_name ( device ),
+		       ( ( ( currticks() - started ) * 1000 ) /
+			 TICKS_PER_SEC ), strerror ( rc ) );
 		return rc;
 	}
+	connected = currticks();
+	DBGC ( device, "EFIDRV %s connected new drivers in %ldms "
+	       "(disconnection took %ldms)\n", efi_handle_name ( device ),
+	       ( ( ( connected - started ) * 1000 ) / TICKS_PER_SEC ),
+	       ( ( ( disconnected - started ) * 1000 ) / TICKS_PER_SEC ) );
 	DBGC2 ( device, "EFIDRV %s after connecting:\n",
 		efi_handle_name ( device ) );
 	DBGC2_EFI_PROTOCOLS ( device, device );
@@ -549,9 +567,16 @@ static int efi_driver_handles ( int ( * method ) ( EFI_HANDLE handle ) ) {
  * @ret rc		Return status code
  */
 int efi_driver_connect_all ( void ) {
+	unsigned long started;
+	int rc;
 
 	DBGC ( &efi_driver_binding, "EFIDRV connecting our drivers\n" );
-	return efi_driver_handles ( efi_driver_connect );
+	started = currticks();
+	rc = efi_driver_handles ( efi_driver_connect );
+	DBGC ( &efi_driver_binding, "EFIDRV connected our drivers in %ldms\n",
+	       ( ( ( currticks() - started ) * 1000 ) / TICKS_PER_SEC ) );
+
+	return rc;
 }
 
 /**
@@ -25,7 +25,6 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <errno.h>
 #include <ipxe/entropy.h>
-#include <ipxe/crc32.h>
 #include <ipxe/profile.h>
 #include <ipxe/efi/efi.h>
 #include <ipxe/efi/Protocol/Rng.h>
@@ -179,7 +178,8 @@ static int efi_get_noise_ticks ( noise_sample_t *noise ) {
  * @ret rc		Return status code
  */
 static int efi_get_noise_rng ( noise_sample_t *noise ) {
-	uint8_t buf[EFI_ENTROPY_RNG_LEN];
+	static uint8_t buf[EFI_ENTROPY_RNG_LEN];
+	static unsigned int remaining;
 	EFI_STATUS efirc;
 	int rc;
 
@@ -187,21 +187,33 @@ static int efi_get_noise_rng ( noise_sample_t *noise ) {
 	if ( ! efirng )
 		return -ENOTSUP;
 
-	/* Get the minimum allowed number of random bytes */
-	if ( ( efirc = efirng->GetRNG ( efirng, NULL, EFI_ENTROPY_RNG_LEN,
-					buf ) ) != 0 ) {
-		rc = -EEFI ( efirc );
-		DBGC ( &tick, "ENTROPY could not read from RNG: %s\n",
-		       strerror ( rc ) );
-		return rc;
+	/* Refill buffer with the minimum allowed number of random
+	 * bytes, if empty.  Calls to GetRNG() can be slow (the backing
+	 * DRBG may choose to reseed from a hardware entropy source on
+	 * any call), and so the seeding time is dominated by the
+	 * number of GetRNG() calls.  Fetch the minimum allowed number
+	 * of bytes once and portion it out over multiple noise
+	 * samples, rather than making one call per sample.
+	 */
+	if ( ! remaining ) {
+		if ( ( efirc = efirng->GetRNG ( efirng, NULL, sizeof ( buf ),
+						buf ) ) != 0 ) {
+			rc = -EEFI ( efirc );
+			DBGC ( &tick, "ENTROPY could not read from RNG: %s\n",
+			       strerror ( rc ) );
+			return rc;
+		}
+		remaining = sizeof ( buf );
 	}
 
-	/* Reduce random bytes to a single noise sample.  This seems
-	 * like overkill, but we have no way of knowing how much
-	 * entropy is actually present in the bytes returned by the
-	 * RNG protocol.
+	/* Consume one byte of random data per noise sample.  We have
+	 * no way of knowing how much entropy is actually present in
+	 * the bytes returned by the RNG protocol, but since we credit
+	 * far less than one bit of min-entropy per raw byte this
+	 * remains extremely conservative even for a very poor RNG.
 	 */
-	*noise = crc32_le ( 0, buf, sizeof ( buf ) );
+	*noise = buf[ sizeof ( buf ) - remaining ];
+	remaining--;
 
 	return 0;
 }
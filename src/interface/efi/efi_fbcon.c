@@ -526,6 +526,17 @@ static void efifb_putchar ( int character ) {
 	fbcon_putchar ( &efifb.fbcon, character );
 }
 
+/**
+ * Print a block of characters to current cursor position
+ *
+ * @v data		Characters
+ * @v len		Length of block
+ */
+static void efifb_putchars ( const char *data, size_t len ) {
+
+	fbcon_putchars ( &efifb.fbcon, data, len );
+}
+
 /**
  * Configure console
  *
@@ -568,6 +579,7 @@ static int efifb_configure ( struct console_configuration *config ) {
 struct console_driver efifb_console __console_driver = {
 	.usage = CONSOLE_EFIFB,
 	.putchar = efifb_putchar,
+	.putchars = efifb_putchars,
 	.configure = efifb_configure,
 	.disabled = CONSOLE_DISABLED,
 };
@@ -302,13 +302,17 @@ static EFI_STATUS EFIAPI efi_file_read ( EFI_FILE_PROTOCOL *this,
 	if ( ! file->image )
 		return efi_file_read_dir ( file, len, data );
 
-	/* Read from the file */
+	/* Read directly from the backing image in a single copy.  Note
+	 * that callers such as shim may issue very large numbers of
+	 * small sequential reads: this path must remain cheap, which is
+	 * why the per-read debug message is relegated to DBGC2.
+	 */
 	remaining = ( file->image->len - file->pos );
 	if ( *len > remaining )
 		*len = remaining;
-	DBGC ( file, "EFIFILE %s read [%#08zx,%#08zx)\n",
-	       efi_file_name ( file ), file->pos,
-	       ( ( size_t ) ( file->pos + *len ) ) );
+	DBGC2 ( file, "EFIFILE %s read [%#08zx,%#08zx)\n",
+		efi_file_name ( file ), file->pos,
+		( ( size_t ) ( file->pos + *len ) ) );
 	copy_from_user ( data, file->image->data, file->pos, *len );
 	file->pos += *len;
 	return 0;
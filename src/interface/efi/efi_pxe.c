@@ -302,48 +302,6 @@ static int efi_pxe_ip_filter ( struct efi_pxe *pxe, EFI_IP_ADDRESS *ip ) {
 	return 0;
 }
 
-/******************************************************************************
- *
- * Data transfer buffer
- *
- ******************************************************************************
- */
-
-/**
- * Reallocate PXE data transfer buffer
- *
- * @v xferbuf		Data transfer buffer
- * @v len		New length (or zero to free buffer)
- * @ret rc		Return status code
- */
-static int efi_pxe_buf_realloc ( struct xfer_buffer *xferbuf __unused,
-				 size_t len __unused ) {
-
-	/* Can never reallocate: return EFI_BUFFER_TOO_SMALL */
-	return -ERANGE;
-}
-
-/**
- * Write data to PXE data transfer buffer
- *
- * @v xferbuf		Data transfer buffer
- * @v offset		Starting offset
- * @v data		Data to copy
- * @v len		Length of data
- */
-static void efi_pxe_buf_write ( struct xfer_buffer *xferbuf, size_t offset,
-				const void *data, size_t len ) {
-
-	/* Copy data to buffer */
-	memcpy ( ( xferbuf->data + offset ), data, len );
-}
-
-/** PXE data transfer buffer operations */
-static struct xfer_buffer_operations efi_pxe_buf_operations = {
-	.realloc = efi_pxe_buf_realloc,
-	.write = efi_pxe_buf_write,
-};
-
 /******************************************************************************
  *
  * (M)TFTP download interface
@@ -403,9 +361,25 @@ static int efi_pxe_tftp_deliver ( struct efi_pxe *pxe,
 	return rc;
 }
 
+/**
+ * Get underlying data transfer buffer
+ *
+ * @v pxe		PXE base code
+ * @ret xferbuf		Data transfer buffer
+ *
+ * Exposing the destination buffer allows download sources capable of
+ * direct placement (such as HTTP) to write received data directly
+ * into the caller's buffer at its final offset.
+ */
+static struct xfer_buffer * efi_pxe_tftp_buffer ( struct efi_pxe *pxe ) {
+
+	return &pxe->buf;
+}
+
 /** PXE file data transfer interface operations */
 static struct interface_operation efi_pxe_tftp_operations[] = {
 	INTF_OP ( xfer_deliver, struct efi_pxe *, efi_pxe_tftp_deliver ),
+	INTF_OP ( xfer_buffer, struct efi_pxe *, efi_pxe_tftp_buffer ),
 	INTF_OP ( xfer_window, struct efi_pxe *, efi_pxe_tftp_window ),
 	INTF_OP ( intf_close, struct efi_pxe *, efi_pxe_tftp_close ),
 };
@@ -963,9 +937,11 @@ efi_pxe_mtftp ( EFI_PXE_BASE_CODE_PROTOCOL *base,
 	 */
 	pxe->blksize = ( ( callback && blksize ) ? *blksize : -1UL );
 
-	/* Initialise data transfer buffer */
-	pxe->buf.data = data;
-	pxe->buf.len = *len;
+	/* Initialise data transfer buffer.  A download that would
+	 * overrun the buffer fails with -ERANGE, which maps to
+	 * EFI_BUFFER_TOO_SMALL.
+	 */
+	xferbuf_fixed_init ( &pxe->buf, data, *len );
 
 	/* Open download */
 	if ( ( rc = efi_pxe_tftp_open ( pxe, ip,
@@ -1608,7 +1584,6 @@ int efi_pxe_install ( EFI_HANDLE handle, struct net_device *netdev ) {
 	pxe->base.Mode = &pxe->mode;
 	memcpy ( &pxe->apple, &efi_apple_net_boot_protocol,
 		 sizeof ( pxe->apple ) );
-	pxe->buf.op = &efi_pxe_buf_operations;
 	intf_init ( &pxe->tftp, &efi_pxe_tftp_desc, &pxe->refcnt );
 	intf_init ( &pxe->udp, &efi_pxe_udp_desc, &pxe->refcnt );
 	INIT_LIST_HEAD ( &pxe->queue );
@@ -782,8 +782,14 @@ efi_snp_receive ( EFI_SIMPLE_NETWORK_PROTOCOL *snp,
 	/* Raise TPL */
 	saved_tpl = bs->RaiseTPL ( TPL_CALLBACK );
 
-	/* Poll the network device */
-	efi_snp_poll ( snpdev );
+	/* Poll the network device, unless packets are already waiting.
+	 * Consumers typically poll via GetStatus() before each call to
+	 * Receive(), and may drain several packets per status check:
+	 * repolling the device for each dequeued packet would roughly
+	 * double the per-packet cost.
+	 */
+	if ( list_empty ( &snpdev->rx ) )
+		efi_snp_poll ( snpdev );
 
 	/* Check for an available packet */
 	iobuf = list_first_entry ( &snpdev->rx, struct io_buffer, list );
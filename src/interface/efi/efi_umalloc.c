@@ -38,6 +38,83 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Equivalent of NOWHERE for user pointers */
 #define UNOWHERE ( ~UNULL )
 
+/**
+ * Attempt to resize external memory block in place
+ *
+ * @v ptr		Memory previously allocated by umalloc()
+ * @v new_size		Requested size
+ * @ret rc		Return status code
+ *
+ * Downloads of initially unknown total size grow their buffer
+ * repeatedly, and each grow-by-copy both doubles the transient memory
+ * footprint and costs a large memcpy().  Since the growing buffer is
+ * usually the most recent large allocation, the pages immediately
+ * following it are usually still free: claim them with an explicit
+ * AllocateAddress request, extending the block with zero copies.
+ */
+static int efi_uresize ( userptr_t ptr, size_t new_size ) {
+	EFI_BOOT_SERVICES *bs = efi_systab->BootServices;
+	EFI_PHYSICAL_ADDRESS phys_addr;
+	unsigned int new_pages, old_pages;
+	size_t old_size;
+	EFI_STATUS efirc;
+	int rc;
+
+	/* Calculate old and new page counts */
+	copy_from_user ( &old_size, ptr, -EFI_PAGE_SIZE, sizeof ( old_size ) );
+	old_pages = ( EFI_SIZE_TO_PAGES ( old_size ) + 1 );
+	new_pages = ( EFI_SIZE_TO_PAGES ( new_size ) + 1 );
+
+	if ( new_pages > old_pages ) {
+
+		/* Attempt to claim the pages immediately following
+		 * the existing block.
+		 */
+		phys_addr = ( user_to_phys ( ptr, -EFI_PAGE_SIZE ) +
+			      ( ( ( EFI_PHYSICAL_ADDRESS ) old_pages ) *
+				EFI_PAGE_SIZE ) );
+		if ( ( efirc = bs->AllocatePages ( AllocateAddress,
+						   EfiBootServicesData,
+						   ( new_pages - old_pages ),
+						   &phys_addr ) ) != 0 ) {
+			rc = -EEFI ( efirc );
+			DBG2 ( "EFI could not extend %d pages at %llx: %s\n",
+			       old_pages, ( phys_addr - ( ( ( uint64_t )
+							   old_pages ) *
+							 EFI_PAGE_SIZE ) ),
+			       strerror ( rc ) );
+			return rc;
+		}
+		DBG ( "EFI extended %d pages to %d pages at %llx\n", old_pages,
+		      new_pages, user_to_phys ( ptr, -EFI_PAGE_SIZE ) );
+
+	} else if ( new_pages < old_pages ) {
+
+		/* Free trailing pages */
+		phys_addr = ( user_to_phys ( ptr, -EFI_PAGE_SIZE ) +
+			      ( ( ( EFI_PHYSICAL_ADDRESS ) new_pages ) *
+				EFI_PAGE_SIZE ) );
+		if ( ( efirc = bs->FreePages ( phys_addr,
+					       ( old_pages -
+						 new_pages ) ) ) != 0 ) {
+			rc = -EEFI ( efirc );
+			DBG ( "EFI could not free %d pages at %llx: %s\n",
+			      ( old_pages - new_pages ), phys_addr,
+			      strerror ( rc ) );
+			/* Not fatal; we have leaked memory but the
+			 * shrunken block remains usable.
+			 */
+		}
+		DBG ( "EFI shrunk %d pages to %d pages at %llx\n", old_pages,
+		      new_pages, user_to_phys ( ptr, -EFI_PAGE_SIZE ) );
+	}
+
+	/* Record new size */
+	copy_to_user ( ptr, -EFI_PAGE_SIZE, &new_size, sizeof ( new_size ) );
+
+	return 0;
+}
+
 /**
  * Reallocate external memory
  *
@@ -57,6 +134,13 @@ static userptr_t efi_urealloc ( userptr_t old_ptr, size_t new_size ) {
 	EFI_STATUS efirc;
 	int rc;
 
+	/* Attempt to resize any existing block in place, avoiding the
+	 * copy entirely.
+	 */
+	if ( old_ptr && ( old_ptr != UNOWHERE ) && new_size &&
+	     ( efi_uresize ( old_ptr, new_size ) == 0 ) )
+		return old_ptr;
+
 	/* Allocate new memory if necessary.  If allocation fails,
 	 * return without touching the old block.
 	 */
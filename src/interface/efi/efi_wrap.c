@@ -33,6 +33,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <ipxe/profile.h>
+#include <usr/profstat.h>
 #include <ipxe/efi/efi.h>
 #include <ipxe/efi/Protocol/LoadedImage.h>
 #include <ipxe/efi/efi_wrap.h>
@@ -46,6 +48,80 @@ static EFI_BOOT_SERVICES efi_bs_wrapper;
 /** Colour for debug messages */
 #define colour &efi_systab_wrapper
 
+/* Per-service profilers, active only when built with PROFILING=1 */
+
+/** InstallProtocolInterface() profiler */
+static struct profiler efi_InstallProtocolInterface_profiler __profiler =
+	{ .name = "efiwrap.InstallProtocolInterface" };
+
+/** ReinstallProtocolInterface() profiler */
+static struct profiler efi_ReinstallProtocolInterface_profiler __profiler =
+	{ .name = "efiwrap.ReinstallProtocolInterface" };
+
+/** UninstallProtocolInterface() profiler */
+static struct profiler efi_UninstallProtocolInterface_profiler __profiler =
+	{ .name = "efiwrap.UninstallProtocolInterface" };
+
+/** HandleProtocol() profiler */
+static struct profiler efi_HandleProtocol_profiler __profiler =
+	{ .name = "efiwrap.HandleProtocol" };
+
+/** LocateHandle() profiler */
+static struct profiler efi_LocateHandle_profiler __profiler =
+	{ .name = "efiwrap.LocateHandle" };
+
+/** LocateDevicePath() profiler */
+static struct profiler efi_LocateDevicePath_profiler __profiler =
+	{ .name = "efiwrap.LocateDevicePath" };
+
+/** LoadImage() profiler */
+static struct profiler efi_LoadImage_profiler __profiler =
+	{ .name = "efiwrap.LoadImage" };
+
+/** StartImage() profiler */
+static struct profiler efi_StartImage_profiler __profiler =
+	{ .name = "efiwrap.StartImage" };
+
+/** Exit() profiler */
+static struct profiler efi_Exit_profiler __profiler =
+	{ .name = "efiwrap.Exit" };
+
+/** UnloadImage() profiler */
+static struct profiler efi_UnloadImage_profiler __profiler =
+	{ .name = "efiwrap.UnloadImage" };
+
+/** ExitBootServices() profiler */
+static struct profiler efi_ExitBootServices_profiler __profiler =
+	{ .name = "efiwrap.ExitBootServices" };
+
+/** ConnectController() profiler */
+static struct profiler efi_ConnectController_profiler __profiler =
+	{ .name = "efiwrap.ConnectController" };
+
+/** DisconnectController() profiler */
+static struct profiler efi_DisconnectController_profiler __profiler =
+	{ .name = "efiwrap.DisconnectController" };
+
+/** OpenProtocol() profiler */
+static struct profiler efi_OpenProtocol_profiler __profiler =
+	{ .name = "efiwrap.OpenProtocol" };
+
+/** CloseProtocol() profiler */
+static struct profiler efi_CloseProtocol_profiler __profiler =
+	{ .name = "efiwrap.CloseProtocol" };
+
+/** ProtocolsPerHandle() profiler */
+static struct profiler efi_ProtocolsPerHandle_profiler __profiler =
+	{ .name = "efiwrap.ProtocolsPerHandle" };
+
+/** LocateHandleBuffer() profiler */
+static struct profiler efi_LocateHandleBuffer_profiler __profiler =
+	{ .name = "efiwrap.LocateHandleBuffer" };
+
+/** LocateProtocol() profiler */
+static struct profiler efi_LocateProtocol_profiler __profiler =
+	{ .name = "efiwrap.LocateProtocol" };
+
 /**
  * Convert EFI status code to text
  *
@@ -126,8 +202,10 @@ efi_install_protocol_interface_wrapper ( EFI_HANDLE *handle, EFI_GUID *protocol,
 	DBGC ( colour, "InstallProtocolInterface ( %s, %s, %d, %p ) ",
 	       efi_handle_name ( *handle ), efi_guid_ntoa ( protocol ),
 	       interface_type, interface );
+	profile_start ( &efi_InstallProtocolInterface_profiler );
 	efirc = bs->InstallProtocolInterface ( handle, protocol, interface_type,
 					       interface );
+	profile_stop ( &efi_InstallProtocolInterface_profiler );
 	DBGC ( colour, "= %s ( %s ) -> %p\n",
 	       efi_status ( efirc ), efi_handle_name ( *handle ), retaddr );
 	return efirc;
@@ -149,8 +227,10 @@ efi_reinstall_protocol_interface_wrapper ( EFI_HANDLE handle,
 	DBGC ( colour, "ReinstallProtocolInterface ( %s, %s, %p, %p ) ",
 	       efi_handle_name ( handle ), efi_guid_ntoa ( protocol ),
 	       old_interface, new_interface );
+	profile_start ( &efi_ReinstallProtocolInterface_profiler );
 	efirc = bs->ReinstallProtocolInterface ( handle, protocol,
 						 old_interface, new_interface );
+	profile_stop ( &efi_ReinstallProtocolInterface_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -170,7 +250,9 @@ efi_uninstall_protocol_interface_wrapper ( EFI_HANDLE handle,
 	DBGC ( colour, "UninstallProtocolInterface ( %s, %s, %p ) ",
 	       efi_handle_name ( handle ), efi_guid_ntoa ( protocol ),
 	       interface );
+	profile_start ( &efi_UninstallProtocolInterface_profiler );
 	efirc = bs->UninstallProtocolInterface ( handle, protocol, interface );
+	profile_stop ( &efi_UninstallProtocolInterface_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -188,7 +270,9 @@ efi_handle_protocol_wrapper ( EFI_HANDLE handle, EFI_GUID *protocol,
 
 	DBGC ( colour, "HandleProtocol ( %s, %s ) ",
 	       efi_handle_name ( handle ), efi_guid_ntoa ( protocol ) );
+	profile_start ( &efi_HandleProtocol_profiler );
 	efirc = bs->HandleProtocol ( handle, protocol, interface );
+	profile_stop ( &efi_HandleProtocol_profiler );
 	DBGC ( colour, "= %s ( %p ) -> %p\n",
 	       efi_status ( efirc ), *interface, retaddr );
 	return efirc;
@@ -211,8 +295,10 @@ efi_locate_handle_wrapper ( EFI_LOCATE_SEARCH_TYPE search_type,
 	       efi_locate_search_type_name ( search_type ),
 	       efi_guid_ntoa ( protocol ), search_key,
 	       ( ( size_t ) *buffer_size ) );
+	profile_start ( &efi_LocateHandle_profiler );
 	efirc = bs->LocateHandle ( search_type, protocol, search_key,
 				   buffer_size, buffer );
+	profile_stop ( &efi_LocateHandle_profiler );
 	DBGC ( colour, "= %s ( %zd", efi_status ( efirc ),
 	       ( ( size_t ) *buffer_size ) );
 	if ( efirc == 0 ) {
@@ -241,7 +327,9 @@ efi_locate_device_path_wrapper ( EFI_GUID *protocol,
 
 	DBGC ( colour, "LocateDevicePath ( %s, %s ) ",
 	       efi_guid_ntoa ( protocol ), efi_devpath_text ( *device_path ) );
+	profile_start ( &efi_LocateDevicePath_profiler );
 	efirc = bs->LocateDevicePath ( protocol, device_path, device );
+	profile_stop ( &efi_LocateDevicePath_profiler );
 	DBGC ( colour, "= %s ( %s, ",
 	       efi_status ( efirc ), efi_devpath_text ( *device_path ) );
 	DBGC ( colour, "%s ) -> %p\n", efi_handle_name ( *device ), retaddr );
@@ -266,8 +354,10 @@ efi_load_image_wrapper ( BOOLEAN boot_policy, EFI_HANDLE parent_image_handle,
 	DBGC ( colour, "%s, %p, %#llx ) ",
 	       efi_devpath_text ( device_path ), source_buffer,
 	       ( ( unsigned long long ) source_size ) );
+	profile_start ( &efi_LoadImage_profiler );
 	efirc = bs->LoadImage ( boot_policy, parent_image_handle, device_path,
 				source_buffer, source_size, image_handle );
+	profile_stop ( &efi_LoadImage_profiler );
 	DBGC ( colour, "= %s ( ", efi_status ( efirc ) );
 	if ( efirc == 0 )
 		DBGC ( colour, "%s ", efi_handle_name ( *image_handle ) );
@@ -292,7 +382,9 @@ efi_start_image_wrapper ( EFI_HANDLE image_handle, UINTN *exit_data_size,
 	EFI_STATUS efirc;
 
 	DBGC ( colour, "StartImage ( %s ) ", efi_handle_name ( image_handle ) );
+	profile_start ( &efi_StartImage_profiler );
 	efirc = bs->StartImage ( image_handle, exit_data_size, exit_data );
+	profile_stop ( &efi_StartImage_profiler );
 	DBGC ( colour, "= %s", efi_status ( efirc ) );
 	if ( ( efirc != 0 ) && exit_data && *exit_data_size )
 		DBGC ( colour, " ( \"%ls\" )", *exit_data );
@@ -320,8 +412,15 @@ efi_exit_wrapper ( EFI_HANDLE image_handle, EFI_STATUS exit_status,
 	if ( ( exit_status != 0 ) && exit_data && exit_data_size )
 		DBGC ( colour, ", \"%ls\"", exit_data );
 	DBGC ( colour, " ) " );
+
+	/* Dump accumulated boot services call statistics */
+	if ( PROFILING )
+		profstat();
+
+	profile_start ( &efi_Exit_profiler );
 	efirc = bs->Exit ( image_handle, exit_status, exit_data_size,
 			   exit_data );
+	profile_stop ( &efi_Exit_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -338,7 +437,9 @@ efi_unload_image_wrapper ( EFI_HANDLE image_handle ) {
 
 	DBGC ( colour, "UnloadImage ( %s ) ",
 	       efi_handle_name ( image_handle ) );
+	profile_start ( &efi_UnloadImage_profiler );
 	efirc = bs->UnloadImage ( image_handle );
+	profile_stop ( &efi_UnloadImage_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -356,7 +457,16 @@ efi_exit_boot_services_wrapper ( EFI_HANDLE image_handle, UINTN map_key ) {
 	DBGC ( colour, "ExitBootServices ( %s, %#llx ) ",
 	       efi_handle_name ( image_handle ),
 	       ( ( unsigned long long ) map_key ) );
+
+	/* Dump accumulated boot services call statistics while the
+	 * console can still be used.
+	 */
+	if ( PROFILING )
+		profstat();
+
+	profile_start ( &efi_ExitBootServices_profiler );
 	efirc = bs->ExitBootServices ( image_handle, map_key );
+	profile_stop ( &efi_ExitBootServices_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -386,8 +496,10 @@ efi_connect_controller_wrapper ( EFI_HANDLE controller_handle,
 	}
 	DBGC ( colour, " }, %s, %s ) ", efi_devpath_text ( remaining_path ),
 	       efi_boolean ( recursive ) );
+	profile_start ( &efi_ConnectController_profiler );
 	efirc = bs->ConnectController ( controller_handle, driver_image_handle,
 					remaining_path, recursive );
+	profile_stop ( &efi_ConnectController_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -408,9 +520,11 @@ efi_disconnect_controller_wrapper ( EFI_HANDLE controller_handle,
 	       efi_handle_name ( controller_handle ) );
 	DBGC ( colour, ", %s", efi_handle_name ( driver_image_handle ) );
 	DBGC ( colour, ", %s ) ", efi_handle_name ( child_handle ) );
+	profile_start ( &efi_DisconnectController_profiler );
 	efirc = bs->DisconnectController ( controller_handle,
 					   driver_image_handle,
 					   child_handle );
+	profile_stop ( &efi_DisconnectController_profiler );
 	DBGC ( colour, "= %s -> %p\n", efi_status ( efirc ), retaddr );
 	return efirc;
 }
@@ -432,8 +546,10 @@ efi_open_protocol_wrapper ( EFI_HANDLE handle, EFI_GUID *protocol,
 	DBGC ( colour, "%s, ", efi_handle_name ( agent_handle ) );
 	DBGC ( colour, "%s, %s ) ", efi_handle_name ( controller_handle ),
 	       efi_open_attributes_name ( attributes ) );
+	profile_start ( &efi_OpenProtocol_profiler );
 	efirc = bs->OpenProtocol ( handle, protocol, interface, agent_handle,
 				   controller_handle, attributes );
+	profile_stop ( &efi_OpenProtocol_profiler );
 	DBGC ( colour, "= %s ( %p ) -> %p\n",
 	       efi_status ( efirc ), *interface, retaddr );
 	return efirc;
@@ -455,8 +571,10 @@ efi_close_protocol_wrapper ( EFI_HANDLE handle, EFI_GUID *protocol,
 	       efi_handle_name ( handle ), efi_guid_ntoa ( protocol ) );
 	DBGC ( colour, "%s, ", efi_handle_name ( agent_handle ) );
 	DBGC ( colour, "%s ) ", efi_handle_name ( controller_handle ) );
+	profile_start ( &efi_CloseProtocol_profiler );
 	efirc = bs->CloseProtocol ( handle, protocol, agent_handle,
 				    controller_handle );
+	profile_stop ( &efi_CloseProtocol_profiler );
 	DBGC ( colour, "= %s -> %p\n",
 	       efi_status ( efirc ), retaddr );
 	return efirc;
@@ -477,8 +595,10 @@ efi_protocols_per_handle_wrapper ( EFI_HANDLE handle,
 
 	DBGC ( colour, "ProtocolsPerHandle ( %s ) ",
 	       efi_handle_name ( handle ) );
+	profile_start ( &efi_ProtocolsPerHandle_profiler );
 	efirc = bs->ProtocolsPerHandle ( handle, protocol_buffer,
 					 protocol_buffer_count );
+	profile_stop ( &efi_ProtocolsPerHandle_profiler );
 	DBGC ( colour, "= %s", efi_status ( efirc ) );
 	if ( efirc == 0 ) {
 		DBGC ( colour, " ( {" );
@@ -508,8 +628,10 @@ efi_locate_handle_buffer_wrapper ( EFI_LOCATE_SEARCH_TYPE search_type,
 	DBGC ( colour, "LocateHandleBuffer ( %s, %s, %p ) ",
 	       efi_locate_search_type_name ( search_type ),
 	       efi_guid_ntoa ( protocol ), search_key );
+	profile_start ( &efi_LocateHandleBuffer_profiler );
 	efirc = bs->LocateHandleBuffer ( search_type, protocol, search_key,
 					 no_handles, buffer );
+	profile_stop ( &efi_LocateHandleBuffer_profiler );
 	DBGC ( colour, "= %s", efi_status ( efirc ) );
 	if ( efirc == 0 ) {
 		DBGC ( colour, " ( %d, {", ( ( unsigned int ) *no_handles ) );
@@ -536,7 +658,9 @@ efi_locate_protocol_wrapper ( EFI_GUID *protocol, VOID *registration,
 
 	DBGC ( colour, "LocateProtocol ( %s, %p ) ",
 	       efi_guid_ntoa ( protocol ), registration );
+	profile_start ( &efi_LocateProtocol_profiler );
 	efirc = bs->LocateProtocol ( protocol, registration, interface );
+	profile_stop ( &efi_LocateProtocol_profiler );
 	DBGC ( colour, "= %s ( %p ) -> %p\n",
 	       efi_status ( efirc ), *interface, retaddr );
 	return efirc;
@@ -556,8 +680,12 @@ efi_locate_protocol_wrapper ( EFI_GUID *protocol, VOID *registration,
 	EFI_STATUS efirc;
 	int rc;
 
-	/* Do nothing unless debugging is enabled */
-	if ( ! DBG_LOG )
+	/* Do nothing unless debugging or profiling is enabled.  When
+	 * built with PROFILING=1 but without DEBUG=efi_wrap, the
+	 * wrappers collect call counts and cycle statistics without
+	 * producing any log output to perturb timing.
+	 */
+	if ( ! ( DBG_LOG || PROFILING ) )
 		return;
 
 	/* Populate table wrappers */
@@ -183,6 +183,25 @@ static void net80211_rx_frag ( struct net80211_device *dev,
 			       struct io_buffer *iob, int signal );
 /** @} */
 
+/**
+ * @defgroup net80211_back 802.11 block-ack and aggregation functions
+ * @{
+ */
+static struct net80211_back_cache *
+net80211_find_back ( struct net80211_device *dev, unsigned int tid );
+static void net80211_free_back ( struct net80211_back_cache *back );
+static void net80211_flush_back ( struct net80211_device *dev,
+				  struct net80211_back_cache *back );
+static int net80211_handle_action ( struct net80211_device *dev,
+				    struct io_buffer *iob );
+static void net80211_rx_amsdu ( struct net80211_device *dev,
+				struct io_buffer *iob );
+static void net80211_rx_deliver ( struct net80211_device *dev,
+				  struct io_buffer *iob );
+static void net80211_rx_qos ( struct net80211_device *dev,
+			      struct io_buffer *iob );
+/** @} */
+
 /**
  * @defgroup net80211_settings 802.11 settings handlers
  * @{
@@ -283,10 +302,15 @@ static int net80211_netdev_open ( struct net_device *netdev )
 static void net80211_netdev_close ( struct net_device *netdev )
 {
 	struct net80211_device *dev = netdev->priv;
+	int i;
 
 	if ( dev->state & NET80211_WORKING )
 		process_del ( &dev->proc_assoc );
 
+	/* Discard any block-ack sessions and held frames */
+	for ( i = 0; i < NET80211_NR_BACK; i++ )
+		net80211_free_back ( &dev->back[i] );
+
 	/* Send disassociation frame to AP, to be polite */
 	if ( dev->state & NET80211_ASSOCIATED )
 		net80211_send_disassoc ( dev, IEEE80211_REASON_LEAVING, 0 );
@@ -2485,6 +2509,9 @@ static void net80211_handle_mgmt ( struct net80211_device *dev,
 		/* fall through */
 	case IEEE80211_STYPE_PROBE_RESP:
 	case IEEE80211_STYPE_ACTION:
+		if ( stype == IEEE80211_STYPE_ACTION &&
+		     net80211_handle_action ( dev, iob ) )
+			break;
 		if ( dev->keep_mgmt ) {
 			struct net80211_rx_info *rxinf;
 			rxinf = zalloc ( sizeof ( *rxinf ) );
@@ -2676,6 +2703,383 @@ static void net80211_rx_frag ( struct net80211_device *dev,
 	}
 }
 
+/**
+ * Find block-ack session for traffic identifier
+ *
+ * @v dev	802.11 device
+ * @v tid	Traffic identifier
+ * @ret back	Block-ack session, or NULL if none exists
+ */
+static struct net80211_back_cache *
+net80211_find_back ( struct net80211_device *dev, unsigned int tid )
+{
+	int i;
+
+	for ( i = 0; i < NET80211_NR_BACK; i++ ) {
+		if ( dev->back[i].in_use && dev->back[i].tid == tid )
+			return &dev->back[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * Free buffers held by block-ack session
+ *
+ * @v back	Block-ack session
+ *
+ * This discards any held frames without delivering them, and marks
+ * the session as unused. It is used when tearing the device down;
+ * when a session ends normally, use net80211_flush_back() first so
+ * that held frames are not lost.
+ */
+static void net80211_free_back ( struct net80211_back_cache *back )
+{
+	int i;
+
+	for ( i = 0; i < NET80211_BACK_WINDOW; i++ ) {
+		if ( back->iob[i] ) {
+			free_iob ( back->iob[i] );
+			back->iob[i] = NULL;
+		}
+	}
+	back->held = 0;
+	back->in_use = 0;
+}
+
+/**
+ * Release all frames held by block-ack session
+ *
+ * @v dev	802.11 device
+ * @v back	Block-ack session
+ *
+ * This delivers every held frame in sequence order, skipping over
+ * any holes, and advances the expected sequence number past the last
+ * frame delivered. It is used when a reorder hole has stalled for
+ * too long (the missing frame is presumed lost) and when a session
+ * is torn down.
+ */
+static void net80211_flush_back ( struct net80211_device *dev,
+				  struct net80211_back_cache *back )
+{
+	u16 seq;
+	int slot;
+	int i;
+
+	for ( i = 0; i < NET80211_BACK_WINDOW && back->held; i++ ) {
+		seq = ( ( back->expected + i ) & 0xfff );
+		slot = ( seq % NET80211_BACK_WINDOW );
+		if ( back->iob[slot] ) {
+			net80211_rx_deliver ( dev, back->iob[slot] );
+			back->iob[slot] = NULL;
+			back->held--;
+			back->expected = ( ( seq + 1 ) & 0xfff );
+		}
+	}
+}
+
+/**
+ * Send ADDBA response action frame
+ *
+ * @v dev	802.11 device
+ * @v dialog	Dialog token copied from the request
+ * @v status	Status code (0 to accept the session)
+ * @v params	Block Ack Parameter Set field, as granted
+ * @ret rc	Return status code
+ */
+static int net80211_send_addba_resp ( struct net80211_device *dev,
+				      u8 dialog, u16 status, u16 params )
+{
+	struct io_buffer *iob = alloc_iob ( 64 );
+	struct ieee80211_addba_response *resp;
+
+	if ( ! iob )
+		return -ENOMEM;
+
+	iob_reserve ( iob, IEEE80211_TYP_FRAME_HEADER_LEN );
+	resp = iob_put ( iob, sizeof ( *resp ) );
+	resp->category = IEEE80211_CATEG_BLOCK_ACK;
+	resp->action = IEEE80211_ACTION_ADDBA_RESPONSE;
+	resp->dialog = dialog;
+	resp->status = status;
+	resp->params = params;
+	resp->timeout = 0;
+
+	return net80211_tx_mgmt ( dev, IEEE80211_STYPE_ACTION, dev->bssid,
+				  iob );
+}
+
+/**
+ * Handle receipt of 802.11 block-ack action frame
+ *
+ * @v dev	802.11 device
+ * @v iob	I/O buffer
+ * @ret handled	TRUE if the frame was consumed by block-ack handling
+ *
+ * We never originate block-ack sessions, since we transmit far too
+ * little for aggregation to help, but we accept sessions the AP
+ * requests so that it may send us receive aggregates. The caller
+ * retains ownership of the I/O buffer.
+ */
+static int net80211_handle_action ( struct net80211_device *dev,
+				    struct io_buffer *iob )
+{
+	struct ieee80211_frame *hdr = iob->data;
+	struct ieee80211_addba_request *req;
+	struct ieee80211_delba *delba;
+	struct net80211_back_cache *back;
+	size_t data_len = ( iob_len ( iob ) - IEEE80211_TYP_FRAME_HEADER_LEN );
+	unsigned int tid;
+	u16 params;
+	int i;
+
+	if ( data_len < 2 || hdr->data[0] != IEEE80211_CATEG_BLOCK_ACK )
+		return 0;
+
+	/* Ignore requests from anyone other than our AP */
+	if ( memcmp ( hdr->addr2, dev->bssid, ETH_ALEN ) != 0 )
+		return 1;
+
+	switch ( hdr->data[1] ) {
+	case IEEE80211_ACTION_ADDBA_REQUEST:
+		if ( data_len < sizeof ( *req ) )
+			break;
+		req = ( struct ieee80211_addba_request * ) hdr->data;
+		tid = ( ( req->params & IEEE80211_ADDBA_TID ) >>
+			IEEE80211_ADDBA_TID_SHIFT );
+
+		/* Find the existing session for this TID, or a free slot */
+		back = net80211_find_back ( dev, tid );
+		if ( ! back ) {
+			for ( i = 0; i < NET80211_NR_BACK; i++ ) {
+				if ( ! dev->back[i].in_use ) {
+					back = &dev->back[i];
+					break;
+				}
+			}
+		}
+		if ( ! back ) {
+			net80211_send_addba_resp ( dev, req->dialog,
+						   IEEE80211_STATUS_QOS_NO_ROOM,
+						   req->params );
+			break;
+		}
+
+		/* (Re)start the session at the requested point */
+		net80211_free_back ( back );
+		back->in_use = 1;
+		back->tid = tid;
+		back->expected = IEEE80211_SEQNR ( req->start_seq );
+
+		DBGC ( dev, "802.11 %p block-ack session for TID %d starts "
+		       "at %d\n", dev, tid, back->expected );
+
+		params = ( ( req->params & IEEE80211_ADDBA_AMSDU ) |
+			   IEEE80211_ADDBA_IMMEDIATE |
+			   ( tid << IEEE80211_ADDBA_TID_SHIFT ) |
+			   ( NET80211_BACK_WINDOW <<
+			     IEEE80211_ADDBA_BUFSIZE_SHIFT ) );
+		net80211_send_addba_resp ( dev, req->dialog, 0, params );
+		break;
+
+	case IEEE80211_ACTION_DELBA:
+		if ( data_len < sizeof ( *delba ) )
+			break;
+		delba = ( struct ieee80211_delba * ) hdr->data;
+		tid = ( ( delba->params & IEEE80211_DELBA_TID ) >>
+			IEEE80211_DELBA_TID_SHIFT );
+		back = net80211_find_back ( dev, tid );
+		if ( back ) {
+			DBGC ( dev, "802.11 %p block-ack session for TID %d "
+			       "torn down (reason %d)\n", dev, tid,
+			       delba->reason );
+			net80211_flush_back ( dev, back );
+			back->in_use = 0;
+		}
+		break;
+
+	case IEEE80211_ACTION_ADDBA_RESPONSE:
+		/* We never send ADDBA requests, so shouldn't see these */
+		break;
+
+	default:
+		DBGC ( dev, "802.11 %p received unimplemented block-ack "
+		       "action %d\n", dev, hdr->data[1] );
+		break;
+	}
+
+	return 1;
+}
+
+/**
+ * De-aggregate received 802.11 A-MSDU frame
+ *
+ * @v dev	802.11 device
+ * @v iob	I/O buffer containing aggregate, with plain data header
+ *
+ * Each aggregated MSDU is rewrapped in a copy of the original frame
+ * header, using the true destination and source addresses from its
+ * subframe header, and delivered as though it had been received by
+ * itself.
+ */
+static void net80211_rx_amsdu ( struct net80211_device *dev,
+				struct io_buffer *iob )
+{
+	struct ieee80211_frame *hdr = iob->data;
+	struct ieee80211_amsdu_subframe *sub;
+	struct ieee80211_frame *subhdr;
+	struct io_buffer *niob;
+	size_t len;
+
+	iob_pull ( iob, IEEE80211_TYP_FRAME_HEADER_LEN );
+
+	while ( iob_len ( iob ) >= sizeof ( *sub ) ) {
+		sub = iob->data;
+		len = ntohs ( sub->len );
+		if ( ( sizeof ( *sub ) + len ) > iob_len ( iob ) ) {
+			DBGC ( dev, "802.11 %p truncated A-MSDU subframe "
+			       "(%zd of %zd bytes)\n", dev, iob_len ( iob ),
+			       sizeof ( *sub ) + len );
+			break;
+		}
+
+		niob = alloc_iob ( IEEE80211_TYP_FRAME_HEADER_LEN + len );
+		if ( ! niob )
+			break;
+
+		subhdr = iob_put ( niob, IEEE80211_TYP_FRAME_HEADER_LEN );
+		memcpy ( subhdr, hdr, IEEE80211_TYP_FRAME_HEADER_LEN );
+		memcpy ( subhdr->addr1, sub->da, ETH_ALEN );
+		memcpy ( subhdr->addr3, sub->sa, ETH_ALEN );
+		memcpy ( iob_put ( niob, len ), sub->data, len );
+
+		if ( dev->state & NET80211_ASSOCIATED )
+			netdev_rx ( dev->netdev, niob );
+		else
+			free_iob ( niob );
+
+		/* Subframes are padded to four-byte boundaries, except
+		   for the last in the aggregate. */
+		len = ( ( sizeof ( *sub ) + len + 3 ) & ~3 );
+		if ( len > iob_len ( iob ) )
+			len = iob_len ( iob );
+		iob_pull ( iob, len );
+	}
+
+	free_iob ( iob );
+}
+
+/**
+ * Deliver received 802.11 data frame to wrapping network device
+ *
+ * @v dev	802.11 device
+ * @v iob	I/O buffer
+ *
+ * This strips any QoS Control field, turning the frame into an
+ * ordinary data frame so that the link-layer code needs no special
+ * cases, de-aggregates A-MSDU aggregates, and hands the resulting
+ * frames onward if we are associated.
+ */
+static void net80211_rx_deliver ( struct net80211_device *dev,
+				  struct io_buffer *iob )
+{
+	struct ieee80211_frame *hdr = iob->data;
+	u16 qos = 0;
+
+	if ( ( hdr->fc & IEEE80211_FC_SUBTYPE ) == IEEE80211_STYPE_QOS_DATA ) {
+		qos = *( ( u16 * ) hdr->data );
+		memmove ( iob->data + 2, iob->data,
+			  IEEE80211_TYP_FRAME_HEADER_LEN );
+		hdr = iob_pull ( iob, 2 );
+		hdr->fc = ( ( hdr->fc & ~IEEE80211_FC_SUBTYPE ) |
+			    IEEE80211_STYPE_DATA );
+	}
+
+	if ( qos & IEEE80211_QOS_AMSDU ) {
+		net80211_rx_amsdu ( dev, iob );
+		return;
+	}
+
+	if ( dev->state & NET80211_ASSOCIATED )
+		netdev_rx ( dev->netdev, iob );
+	else
+		free_iob ( iob );
+}
+
+/**
+ * Handle receipt of 802.11 QoS data frame
+ *
+ * @v dev	802.11 device
+ * @v iob	I/O buffer
+ *
+ * Frames belonging to a negotiated block-ack session are run through
+ * the reorder buffer, so that the MSDUs of an A-MPDU whose middle
+ * subframes needed retransmission are still delivered in order;
+ * anything else is delivered directly.
+ */
+static void net80211_rx_qos ( struct net80211_device *dev,
+			      struct io_buffer *iob )
+{
+	struct ieee80211_frame *hdr = iob->data;
+	u16 qos = *( ( u16 * ) hdr->data );
+	u16 seq = IEEE80211_SEQNR ( hdr->seq );
+	struct net80211_back_cache *back;
+	u16 delta;
+	int slot;
+
+	/* Without a block-ack session, no reordering can occur */
+	back = net80211_find_back ( dev, qos & IEEE80211_QOS_TID );
+	if ( ! back ) {
+		net80211_rx_deliver ( dev, iob );
+		return;
+	}
+
+	/* Release held frames if a reorder hole has stalled too long;
+	 * the missing frame has presumably been dropped by the AP. */
+	if ( back->held && ( currticks() - back->hold_ticks >
+			     NET80211_BACK_TIMEOUT * TICKS_PER_SEC ) ) {
+		DBGC2 ( dev, "802.11 %p block-ack reorder stall at %d\n",
+			dev, back->expected );
+		net80211_flush_back ( dev, back );
+	}
+
+	delta = ( ( seq - back->expected ) & 0xfff );
+	if ( delta == 0 ) {
+		/* In-order frame; deliver it and whatever it unblocks */
+		net80211_rx_deliver ( dev, iob );
+		back->expected = ( ( seq + 1 ) & 0xfff );
+		while ( back->held ) {
+			slot = ( back->expected % NET80211_BACK_WINDOW );
+			if ( ! back->iob[slot] )
+				break;
+			net80211_rx_deliver ( dev, back->iob[slot] );
+			back->iob[slot] = NULL;
+			back->held--;
+			back->expected = ( ( back->expected + 1 ) & 0xfff );
+		}
+	} else if ( delta < NET80211_BACK_WINDOW ) {
+		/* Ahead of a hole; hold it until the hole is filled */
+		slot = ( seq % NET80211_BACK_WINDOW );
+		if ( back->iob[slot] ) {
+			free_iob ( iob );	/* duplicate */
+			return;
+		}
+		if ( ! back->held )
+			back->hold_ticks = currticks();
+		back->iob[slot] = iob;
+		back->held++;
+	} else if ( delta < 0x800 ) {
+		/* The window has moved beyond us; release everything
+		   held and restart at the new position. */
+		net80211_flush_back ( dev, back );
+		net80211_rx_deliver ( dev, iob );
+		back->expected = ( ( seq + 1 ) & 0xfff );
+	} else {
+		/* Behind the window: an old frame or duplicate */
+		free_iob ( iob );
+	}
+}
+
 /**
  * Handle receipt of 802.11 frame
  *
@@ -2750,9 +3154,22 @@ void net80211_rx ( struct net80211_device *dev, struct io_buffer *iob,
 		return;
 	}
 
+	/* QoS data frames are subject to A-MPDU reordering and A-MSDU
+	   de-aggregation. */
+	if ( ( hdr->fc & IEEE80211_FC_SUBTYPE ) == IEEE80211_STYPE_QOS_DATA ) {
+		if ( iob_len ( iob ) <
+		     ( IEEE80211_TYP_FRAME_HEADER_LEN + 2 ) )
+			goto drop;
+		if ( dev->rctl )
+			rc80211_update_rx ( dev, hdr->fc & IEEE80211_FC_RETRY,
+					    rate );
+		net80211_rx_qos ( dev, iob );
+		return;
+	}
+
 	/* Data frames get dropped or sent to the net_device. */
 	if ( ( hdr->fc & IEEE80211_FC_SUBTYPE ) != IEEE80211_STYPE_DATA )
-		goto drop;	/* drop QoS, CFP, or null data packets */
+		goto drop;	/* drop CFP or null data packets */
 
 	/* Update rate-control algorithm */
 	if ( dev->rctl )
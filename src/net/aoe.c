@@ -88,6 +88,13 @@ struct aoe_device {
 	/** Saved timeout value */
 	unsigned long timeout;
 
+	/** Maximum number of outstanding commands
+	 *
+	 * This is the buffer count advertised by the target in its
+	 * Query Config response.
+	 */
+	unsigned int bufcnt;
+
 	/** Configuration command interface */
 	struct interface config;
 	/** Device is configued */
@@ -248,6 +255,9 @@ static void aoecmd_close ( struct aoe_command *aoecmd, int rc ) {
 
 	/* Shut down interfaces */
 	intf_shutdown ( &aoecmd->ata, rc );
+
+	/* Notify ATA layer that a command slot may now be free */
+	xfer_window_changed ( &aoedev->ata );
 }
 
 /**
@@ -554,6 +564,14 @@ static int aoecmd_cfg_rsp ( struct aoe_command *aoecmd, const void *data,
 	       aoedev_name ( aoedev ), aoecmd->tag, ntohs ( aoecfg->bufcnt ),
 	       aoecfg->fwver, aoecfg->scnt );
 
+	/* Record maximum number of outstanding commands.  Badly
+	 * behaved targets may advertise no buffers at all; assume
+	 * that such targets can handle one command at a time.
+	 */
+	aoedev->bufcnt = ntohs ( aoecfg->bufcnt );
+	if ( ! aoedev->bufcnt )
+		aoedev->bufcnt = 1;
+
 	/* Record target MAC address */
 	memcpy ( aoedev->target, ll_source, ll_protocol->ll_addr_len );
 	DBGC ( aoedev, "AoE %s has MAC address %s\n",
@@ -758,7 +776,21 @@ static void aoedev_close ( struct aoe_device *aoedev, int rc ) {
  * @ret len		Length of window
  */
 static size_t aoedev_window ( struct aoe_device *aoedev ) {
-	return ( aoedev->configured ? ~( ( size_t ) 0 ) : 0 );
+	struct aoe_command *aoecmd;
+	unsigned int outstanding = 0;
+
+	/* Refuse commands until configuration has completed */
+	if ( ! aoedev->configured )
+		return 0;
+
+	/* Count commands outstanding on this device */
+	list_for_each_entry ( aoecmd, &aoe_commands, list ) {
+		if ( aoecmd->aoedev == aoedev )
+			outstanding++;
+	}
+
+	/* Allow commands up to the target's advertised buffer count */
+	return ( ( outstanding < aoedev->bufcnt ) ? ~( ( size_t ) 0 ) : 0 );
 }
 
 /**
@@ -409,6 +409,51 @@ int dhcpopt_fetch ( struct dhcp_options *options, unsigned int tag,
 	return option_len;
 }
 
+/**
+ * Copy DHCP options block
+ *
+ * @v source		Source DHCP options block
+ * @v dest		Destination DHCP options block
+ * @ret rc		Return status code
+ *
+ * Copies each top-level option verbatim into the destination block.
+ * Encapsulated option blocks are copied wholesale (as single options)
+ * rather than being reserialized option by option, and so are
+ * preserved exactly as found in the source block.
+ */
+int dhcpopt_copy ( struct dhcp_options *source, struct dhcp_options *dest ) {
+	struct dhcp_option *option;
+	int offset = 0;
+	ssize_t remaining = source->used_len;
+	unsigned int option_len;
+	int rc;
+
+	while ( remaining ) {
+		/* Calculate length of this option.  Abort processing
+		 * if the length is malformed (i.e. takes us beyond
+		 * the end of the data block).
+		 */
+		option = dhcp_option ( source, offset );
+		option_len = dhcp_option_len ( option );
+		remaining -= option_len;
+		if ( remaining < 0 )
+			break;
+		offset += option_len;
+		/* Check for explicit end marker */
+		if ( option->tag == DHCP_END )
+			break;
+		/* Skip padding */
+		if ( option->tag == DHCP_PAD )
+			continue;
+		/* Copy option verbatim */
+		if ( ( rc = dhcpopt_store ( dest, option->tag, option->data,
+					    option->len ) ) != 0 )
+			return rc;
+	}
+
+	return 0;
+}
+
 /**
  * Recalculate length of DHCP options block
  *
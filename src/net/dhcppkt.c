@@ -216,6 +216,42 @@ int dhcppkt_fetch ( struct dhcp_packet *dhcppkt, unsigned int tag,
 	return dhcpopt_fetch ( &dhcppkt->options, tag, data, len );
 }
 
+/**
+ * Copy contents of DHCP packet
+ *
+ * @v source		Source DHCP packet
+ * @v dest		Destination DHCP packet
+ * @ret rc		Return status code
+ *
+ * Copies the dedicated fields and the options block from the source
+ * packet.  The options block is copied verbatim (via dhcpopt_copy()),
+ * preserving the exact encoding of the source packet, including the
+ * contents of any encapsulated option blocks.
+ */
+int dhcppkt_copy ( struct dhcp_packet *source, struct dhcp_packet *dest ) {
+	struct dhcp_packet_field *field;
+	void *field_data;
+	size_t used_len;
+	unsigned int i;
+	int rc;
+
+	/* Copy populated dedicated fields */
+	for ( i = 0 ; i < ( sizeof ( dhcp_packet_fields ) /
+			    sizeof ( dhcp_packet_fields[0] ) ) ; i++ ) {
+		field = &dhcp_packet_fields[i];
+		field_data = dhcp_packet_field ( source->dhcphdr, field );
+		used_len = field->used_len ( field_data, field->len );
+		if ( ! used_len )
+			continue;
+		if ( ( rc = dhcppkt_store ( dest, field->tag, field_data,
+					    used_len ) ) != 0 )
+			return rc;
+	}
+
+	/* Copy options block verbatim */
+	return dhcpopt_copy ( &source->options, &dest->options );
+}
+
 /****************************************************************************
  *
  * DHCP packet settings interface
@@ -281,6 +317,20 @@ static struct settings_operations dhcppkt_settings_operations = {
 	.fetch = dhcppkt_settings_fetch,
 };
 
+/**
+ * Get DHCP packet containing settings block
+ *
+ * @v settings		Settings block, or NULL
+ * @ret dhcppkt		DHCP packet, or NULL if not backed by a DHCP packet
+ */
+struct dhcp_packet * dhcppkt_from_settings ( struct settings *settings ) {
+
+	if ( ( ! settings ) ||
+	     ( settings->op != &dhcppkt_settings_operations ) )
+		return NULL;
+	return container_of ( settings, struct dhcp_packet, settings );
+}
+
 /****************************************************************************
  *
  * Constructor
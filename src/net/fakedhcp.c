@@ -93,6 +93,17 @@ static int copy_encap_settings ( struct dhcp_packet *dest,
  */
 static int copy_settings ( struct dhcp_packet *dest,
 			   struct settings *source ) {
+	struct dhcp_packet *dhcppkt;
+
+	/* If the source settings block is itself backed by a DHCP
+	 * packet (e.g. a recorded ProxyDHCP offer or boot server
+	 * ACK), copy its contents wholesale.  This preserves the
+	 * option block exactly as received, and avoids serializing
+	 * every possible setting individually.
+	 */
+	if ( ( dhcppkt = dhcppkt_from_settings ( source ) ) != NULL )
+		return dhcppkt_copy ( dhcppkt, dest );
+
 	return copy_encap_settings ( dest, source, 0 );
 }
 
@@ -136,6 +147,8 @@ int create_fakedhcpdiscover ( struct net_device *netdev,
 int create_fakedhcpack ( struct net_device *netdev,
 			 void *data, size_t max_len ) {
 	struct dhcp_packet dhcppkt;
+	struct settings *settings;
+	struct dhcp_packet *lease;
 	int rc;
 
 	/* Create base DHCPACK packet */
@@ -146,6 +159,25 @@ int create_fakedhcpack ( struct net_device *netdev,
 		return rc;
 	}
 
+	/* If we hold a lease for this device (whether acquired by our
+	 * own DHCP session or inherited as a cached DHCPACK when
+	 * chainloaded), replay its contents wholesale.  This
+	 * preserves the option block exactly as received; any options
+	 * subsequently modified via the settings interface are stored
+	 * back into the lease packet itself, and so are also
+	 * preserved.
+	 */
+	settings = find_child_settings ( netdev_settings ( netdev ),
+					 DHCP_SETTINGS_NAME );
+	if ( ( lease = dhcppkt_from_settings ( settings ) ) != NULL ) {
+		if ( ( rc = dhcppkt_copy ( lease, &dhcppkt ) ) != 0 ) {
+			DBG ( "Could not copy DHCPACK lease: %s\n",
+			      strerror ( rc ) );
+			return rc;
+		}
+		return 0;
+	}
+
 	/* Merge in globally-scoped settings, then netdev-specific
 	 * settings.  Do it in this order so that netdev-specific
 	 * settings take precedence regardless of stated priorities.
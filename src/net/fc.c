@@ -351,6 +351,20 @@ static unsigned int fc_new_seq_id ( void ) {
 	return (++seq_id);
 }
 
+/** Maximum number of free exchange structures to retain for reuse
+ *
+ * Each SCSI command uses a short-lived exchange, so retaining a small
+ * pool of structures avoids continual heap churn during data
+ * transfers.
+ */
+#define FC_XCHG_POOL_MAX 8
+
+/** Pool of free exchange structures awaiting reuse */
+static LIST_HEAD ( fc_xchg_pool );
+
+/** Number of exchange structures currently in the free pool */
+static unsigned int fc_xchg_pool_count;
+
 /**
  * Free Fibre Channel exchange
  *
@@ -364,7 +378,14 @@ static void fc_xchg_free ( struct refcnt *refcnt ) {
 	assert ( list_empty ( &xchg->list ) );
 
 	fc_port_put ( xchg->port );
-	free ( xchg );
+
+	/* Return structure to the free pool, if space remains */
+	if ( fc_xchg_pool_count < FC_XCHG_POOL_MAX ) {
+		list_add ( &xchg->list, &fc_xchg_pool );
+		fc_xchg_pool_count++;
+	} else {
+		free ( xchg );
+	}
 }
 
 /**
@@ -697,10 +718,19 @@ static struct fc_exchange * fc_xchg_create ( struct fc_port *port,
 					     unsigned int type ) {
 	struct fc_exchange *xchg;
 
-	/* Allocate and initialise structure */
-	xchg = zalloc ( sizeof ( *xchg ) );
-	if ( ! xchg )
-		return NULL;
+	/* Reuse a structure from the free pool if possible,
+	 * otherwise allocate a fresh one.
+	 */
+	xchg = list_first_entry ( &fc_xchg_pool, struct fc_exchange, list );
+	if ( xchg ) {
+		list_del ( &xchg->list );
+		fc_xchg_pool_count--;
+		memset ( xchg, 0, sizeof ( *xchg ) );
+	} else {
+		xchg = zalloc ( sizeof ( *xchg ) );
+		if ( ! xchg )
+			return NULL;
+	}
 	ref_init ( &xchg->refcnt, fc_xchg_free );
 	intf_init ( &xchg->ulp, &fc_xchg_ulp_desc, &xchg->refcnt );
 	timer_init ( &xchg->timer, fc_xchg_expired, &xchg->refcnt );
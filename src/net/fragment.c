@@ -26,6 +26,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <ipxe/retry.h>
 #include <ipxe/timer.h>
 #include <ipxe/ipstat.h>
@@ -35,8 +36,37 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * Fragment reassembly
  *
+ * Fragments may arrive in any order.  Each reassembly buffer tracks
+ * the regions not yet received using a sorted list of hole
+ * descriptors (per RFC 815); reassembly is complete when the total
+ * length is known and no holes remain.
+ *
+ * Memory consumption is bounded: the fragmentable portion may not
+ * exceed @c FRAGMENT_MAX_LEN, each buffer may use at most @c
+ * FRAGMENT_MAX_HOLES hole descriptors, and at most @c
+ * FRAGMENT_MAX_BUFFERS buffers may exist concurrently, with the
+ * least recently active buffer being evicted to make room.
  */
 
+/**
+ * Free fragment reassembly buffer
+ *
+ * @v fragment		Fragment reassembly buffer
+ */
+static void fragment_free ( struct fragment *fragment ) {
+	struct fragment_hole *hole;
+	struct fragment_hole *tmp;
+
+	list_for_each_entry_safe ( hole, tmp, &fragment->holes, list ) {
+		list_del ( &hole->list );
+		free ( hole );
+	}
+	stop_timer ( &fragment->timer );
+	free_iob ( fragment->iobuf );
+	list_del ( &fragment->list );
+	free ( fragment );
+}
+
 /**
  * Expire fragment reassembly buffer
  *
@@ -48,10 +78,8 @@ static void fragment_expired ( struct retry_timer *timer, int fail __unused ) {
 		container_of ( timer, struct fragment, timer );
 
 	DBGC ( fragment, "FRAG %p expired\n", fragment );
-	free_iob ( fragment->iobuf );
-	list_del ( &fragment->list );
 	fragment->fragments->stats->reasm_fails++;
-	free ( fragment );
+	fragment_free ( fragment );
 }
 
 /**
@@ -74,6 +102,140 @@ static struct fragment * fragment_find ( struct fragment_reassembler *fragments,
 	return NULL;
 }
 
+/**
+ * Add a hole descriptor
+ *
+ * @v fragment		Fragment reassembly buffer
+ * @v first		Offset of first byte of hole
+ * @v last		Offset of first byte beyond hole, or @c FRAGMENT_EOF
+ * @ret rc		Return status code
+ *
+ * The hole is appended to the hole list, which must preserve its
+ * sorted order.
+ */
+static int fragment_add_hole ( struct fragment *fragment, size_t first,
+			       size_t last ) {
+	struct fragment_hole *hole;
+
+	if ( fragment->nholes >= FRAGMENT_MAX_HOLES )
+		return -ENOBUFS;
+	hole = malloc ( sizeof ( *hole ) );
+	if ( ! hole )
+		return -ENOMEM;
+	hole->first = first;
+	hole->last = last;
+	list_add_tail ( &hole->list, &fragment->holes );
+	fragment->nholes++;
+	return 0;
+}
+
+/**
+ * Fill holes covered by a received fragment
+ *
+ * @v fragment		Fragment reassembly buffer
+ * @v first		Offset of first byte of received fragment
+ * @v last		Offset of first byte beyond received fragment
+ * @ret rc		Return status code
+ *
+ * This is the hole list update from RFC 815: each hole overlapped by
+ * the received fragment is deleted, shrunk, or split as applicable.
+ */
+static int fragment_fill ( struct fragment *fragment, size_t first,
+			   size_t last ) {
+	struct fragment_hole *hole;
+	struct fragment_hole *tmp;
+	struct fragment_hole *split;
+
+	list_for_each_entry_safe ( hole, tmp, &fragment->holes, list ) {
+		if ( ( last <= hole->first ) || ( first >= hole->last ) )
+			continue;
+		if ( ( first <= hole->first ) && ( last >= hole->last ) ) {
+			/* Hole completely filled */
+			list_del ( &hole->list );
+			free ( hole );
+			fragment->nholes--;
+		} else if ( first <= hole->first ) {
+			/* Start of hole filled */
+			hole->first = last;
+		} else if ( last >= hole->last ) {
+			/* End of hole filled */
+			hole->last = first;
+		} else {
+			/* Middle of hole filled; split into two holes */
+			if ( fragment->nholes >= FRAGMENT_MAX_HOLES )
+				return -ENOBUFS;
+			split = malloc ( sizeof ( *split ) );
+			if ( ! split )
+				return -ENOMEM;
+			split->first = last;
+			split->last = hole->last;
+			hole->last = first;
+			list_add ( &split->list, &hole->list );
+			fragment->nholes++;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Discard holes beyond the total length
+ *
+ * @v fragment		Fragment reassembly buffer
+ * @v len		Total length of fragmentable portion
+ *
+ * Called when the final fragment arrives and the total length
+ * becomes known; in particular, this bounds the previously unbounded
+ * final hole.
+ */
+static void fragment_truncate ( struct fragment *fragment, size_t len ) {
+	struct fragment_hole *hole;
+	struct fragment_hole *tmp;
+
+	list_for_each_entry_safe ( hole, tmp, &fragment->holes, list ) {
+		if ( hole->first >= len ) {
+			list_del ( &hole->list );
+			free ( hole );
+			fragment->nholes--;
+		} else if ( hole->last > len ) {
+			hole->last = len;
+		}
+	}
+}
+
+/**
+ * Extend fragment reassembly buffer
+ *
+ * @v fragment		Fragment reassembly buffer
+ * @v extent		Required length of fragmentable portion
+ * @ret rc		Return status code
+ *
+ * Content beyond the previous length is uninitialised; the hole list
+ * records which regions hold valid data.  Preserve I/O buffer
+ * headroom to allow for code which modifies and resends the buffer
+ * (e.g. ICMP echo responses).
+ */
+static int fragment_extend ( struct fragment *fragment, size_t extent ) {
+	struct io_buffer *iobuf;
+	size_t old_len = iob_len ( fragment->iobuf );
+	size_t new_len = ( fragment->hdrlen + extent );
+
+	if ( new_len <= old_len )
+		return 0;
+
+	iobuf = alloc_iob ( iob_headroom ( fragment->iobuf ) + new_len );
+	if ( ! iobuf ) {
+		DBGC ( fragment, "FRAG %p could not extend reassembly "
+		       "buffer to %zd bytes\n", fragment, new_len );
+		return -ENOMEM;
+	}
+	iob_reserve ( iobuf, iob_headroom ( fragment->iobuf ) );
+	memcpy ( iob_put ( iobuf, old_len ), fragment->iobuf->data, old_len );
+	iob_put ( iobuf, ( new_len - old_len ) );
+	free_iob ( fragment->iobuf );
+	fragment->iobuf = iobuf;
+	return 0;
+}
+
 /**
  * Reassemble packet
  *
@@ -89,10 +251,13 @@ struct io_buffer * fragment_reassemble ( struct fragment_reassembler *fragments,
 					 struct io_buffer *iobuf,
 					 size_t *hdrlen ) {
 	struct fragment *fragment;
-	struct io_buffer *new_iobuf;
-	size_t new_len;
+	struct fragment *evictee;
+	struct io_buffer *reassembled;
+	unsigned int count;
 	size_t offset;
-	size_t expected_offset;
+	size_t len;
+	size_t last;
+	size_t excess;
 	int more_frags;
 
 	/* Update statistics */
@@ -101,82 +266,144 @@ struct io_buffer * fragment_reassemble ( struct fragment_reassembler *fragments,
 	/* Find matching fragment reassembly buffer, if any */
 	fragment = fragment_find ( fragments, iobuf, *hdrlen );
 
-	/* Drop out-of-order fragments */
+	/* Extract fragment geometry */
 	offset = fragments->fragment_offset ( iobuf, *hdrlen );
-	expected_offset = ( fragment ? ( iob_len ( fragment->iobuf ) -
-					 fragment->hdrlen ) : 0 );
-	if ( offset != expected_offset ) {
-		DBGC ( fragment, "FRAG %p dropping out-of-sequence fragment "
-		       "[%zd,%zd), expected [%zd,...)\n", fragment, offset,
-		       ( offset + iob_len ( iobuf ) - *hdrlen ),
-		       expected_offset );
+	len = ( iob_len ( iobuf ) - *hdrlen );
+	last = ( offset + len );
+	more_frags = fragments->more_fragments ( iobuf, *hdrlen );
+	DBGC ( fragment, "FRAG %p [%zd,%zd)%s\n", fragment, offset, last,
+	       ( more_frags ? "" : " final" ) );
+
+	/* Enforce upper bound on reassembled length */
+	if ( last > FRAGMENT_MAX_LEN ) {
+		DBGC ( fragment, "FRAG %p fragment [%zd,%zd) exceeds length "
+		       "limit\n", fragment, offset, last );
 		goto drop;
 	}
 
-	/* Create or extend fragment reassembly buffer as applicable */
+	/* Create fragment reassembly buffer, if applicable */
 	if ( ! fragment ) {
 
+		/* Evict least recently active reassembly buffer, if
+		 * we have reached the limit on concurrent buffers.
+		 */
+		count = 0;
+		list_for_each_entry ( evictee, &fragments->list, list )
+			count++;
+		if ( count >= FRAGMENT_MAX_BUFFERS ) {
+			evictee = list_last_entry ( &fragments->list,
+						    struct fragment, list );
+			DBGC ( evictee, "FRAG %p evicted\n", evictee );
+			fragments->stats->reasm_fails++;
+			fragment_free ( evictee );
+		}
+
 		/* Create new fragment reassembly buffer */
 		fragment = zalloc ( sizeof ( *fragment ) );
 		if ( ! fragment )
 			goto drop;
 		list_add ( &fragment->list, &fragments->list );
-		fragment->iobuf = iobuf;
+		INIT_LIST_HEAD ( &fragment->holes );
 		fragment->hdrlen = *hdrlen;
 		timer_init ( &fragment->timer, fragment_expired, NULL );
 		fragment->fragments = fragments;
-		DBGC ( fragment, "FRAG %p [0,%zd)\n", fragment,
-		       ( iob_len ( iobuf ) - *hdrlen ) );
 
-	} else {
-
-		/* Check if this is the final fragment */
-		more_frags = fragments->more_fragments ( iobuf, *hdrlen );
-		DBGC ( fragment, "FRAG %p [%zd,%zd)%s\n", fragment,
-		       offset, ( offset + iob_len ( iobuf ) - *hdrlen ),
-		       ( more_frags ? "" : " complete" ) );
+		/* Create reassembly buffer covering this fragment */
+		fragment->iobuf = alloc_iob ( iob_headroom ( iobuf ) +
+					      *hdrlen + last );
+		if ( ! fragment->iobuf )
+			goto drop_free;
+		iob_reserve ( fragment->iobuf, iob_headroom ( iobuf ) );
+		iob_put ( fragment->iobuf, ( *hdrlen + last ) );
 
-		/* Extend fragment reassembly buffer.  Preserve I/O
-		 * buffer headroom to allow for code which modifies
-		 * and resends the buffer (e.g. ICMP echo responses).
+		/* Seed the non-fragmentable portion from this
+		 * fragment so that is_fragment() can match subsequent
+		 * fragments; the fragment at offset zero will
+		 * overwrite it with the authoritative header.
 		 */
-		iob_pull ( iobuf, *hdrlen );
-		new_len = ( iob_headroom ( fragment->iobuf ) +
-			    iob_len ( fragment->iobuf ) + iob_len ( iobuf ) );
-		new_iobuf = alloc_iob ( new_len );
-		if ( ! new_iobuf ) {
-			DBGC ( fragment, "FRAG %p could not extend reassembly "
-			       "buffer to %zd bytes\n", fragment, new_len );
+		memcpy ( fragment->iobuf->data, iobuf->data, *hdrlen );
+
+		/* Create hole descriptors for the uncovered regions */
+		if ( offset &&
+		     ( fragment_add_hole ( fragment, 0, offset ) != 0 ) )
+			goto drop_free;
+		if ( more_frags &&
+		     ( fragment_add_hole ( fragment, last,
+					   FRAGMENT_EOF ) != 0 ) )
+			goto drop_free;
+
+	} else {
+
+		/* Require a consistent non-fragmentable portion */
+		if ( *hdrlen != fragment->hdrlen ) {
+			DBGC ( fragment, "FRAG %p mismatched header length "
+			       "(%zd, expected %zd)\n", fragment, *hdrlen,
+			       fragment->hdrlen );
 			goto drop;
 		}
-		iob_reserve ( new_iobuf, iob_headroom ( fragment->iobuf ) );
-		memcpy ( iob_put ( new_iobuf, iob_len ( fragment->iobuf ) ),
-			 fragment->iobuf->data, iob_len ( fragment->iobuf ) );
-		memcpy ( iob_put ( new_iobuf, iob_len ( iobuf ) ),
-			 iobuf->data, iob_len ( iobuf ) );
-		free_iob ( fragment->iobuf );
-		fragment->iobuf = new_iobuf;
-		free_iob ( iobuf );
 
-		/* Stop fragment reassembly timer */
-		stop_timer ( &fragment->timer );
-
-		/* If this is the final fragment, return it */
-		if ( ! more_frags ) {
-			iobuf = fragment->iobuf;
-			*hdrlen = fragment->hdrlen;
-			list_del ( &fragment->list );
-			free ( fragment );
-			fragments->stats->reasm_oks++;
-			return iobuf;
+		/* Drop fragments extending beyond a known total length */
+		if ( fragment->len && ( last > fragment->len ) ) {
+			DBGC ( fragment, "FRAG %p fragment [%zd,%zd) exceeds "
+			       "total length %zd\n", fragment, offset, last,
+			       fragment->len );
+			goto drop;
 		}
+
+		/* Extend reassembly buffer, if applicable */
+		if ( fragment_extend ( fragment, last ) != 0 )
+			goto drop;
+	}
+
+	/* Copy fragment into reassembly buffer.  The non-fragmentable
+	 * portion is taken from the fragment at offset zero.
+	 */
+	if ( offset ) {
+		memcpy ( ( fragment->iobuf->data + fragment->hdrlen + offset ),
+			 ( iobuf->data + *hdrlen ), len );
+	} else {
+		memcpy ( fragment->iobuf->data, iobuf->data,
+			 ( *hdrlen + len ) );
+	}
+
+	/* Update hole list */
+	if ( fragment_fill ( fragment, offset, last ) != 0 )
+		goto drop;
+
+	/* Record total length when the final fragment arrives */
+	if ( ! more_frags ) {
+		fragment->len = last;
+		fragment_truncate ( fragment, last );
+	}
+
+	/* Mark buffer as most recently active */
+	list_del ( &fragment->list );
+	list_add ( &fragment->list, &fragments->list );
+
+	/* If reassembly is complete, return the reassembled packet */
+	if ( fragment->len && list_empty ( &fragment->holes ) ) {
+		DBGC ( fragment, "FRAG %p complete [0,%zd)\n", fragment,
+		       fragment->len );
+		reassembled = fragment->iobuf;
+		excess = ( iob_len ( reassembled ) -
+			   ( fragment->hdrlen + fragment->len ) );
+		iob_unput ( reassembled, excess );
+		*hdrlen = fragment->hdrlen;
+		fragment->iobuf = NULL;
+		fragment_free ( fragment );
+		free_iob ( iobuf );
+		fragments->stats->reasm_oks++;
+		return reassembled;
 	}
 
 	/* (Re)start fragment reassembly timer */
 	start_timer_fixed ( &fragment->timer, FRAGMENT_TIMEOUT );
 
+	free_iob ( iobuf );
 	return NULL;
 
+ drop_free:
+	fragment_free ( fragment );
  drop:
 	fragments->stats->reasm_fails++;
 	free_iob ( iobuf );
@@ -39,10 +39,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * @v iobuf		I/O buffer
  * @v min_len		Minimum length
  *
- * This function pads and aligns I/O buffers, for devices that
- * aren't capable of padding in hardware, or that require specific
- * alignment in TX buffers.  The packet data will end up aligned to a
- * multiple of @c IOB_ALIGN.
+ * This function pads I/O buffers, for devices that aren't capable of
+ * padding in hardware.  Since alloc_iob() rounds allocations up to @c
+ * IOB_ZLEN, spare space for the padding always exists within the
+ * buffer; padding is a memset of reserved tail bytes, with the packet
+ * data moved only in the rare case that the spare space lies before
+ * the data rather than after it.
  *
  * @c min_len must not exceed @v IOB_ZLEN.
  */
@@ -54,10 +56,51 @@ void iob_pad ( struct io_buffer *iobuf, size_t min_len ) {
 
 	assert ( min_len <= IOB_ZLEN );
 
+	/* Calculate padding length */
+	pad_len = ( min_len - iob_len ( iobuf ) );
+	if ( pad_len <= 0 )
+		return;
+
+	/* Move packet data to start of I/O buffer if (and only if)
+	 * the existing tailroom cannot accommodate the padding
+	 */
+	if ( ( ( size_t ) pad_len ) > iob_tailroom ( iobuf ) ) {
+		data = iobuf->data;
+		len = iob_len ( iobuf );
+		headroom = iob_headroom ( iobuf );
+		iob_push ( iobuf, headroom );
+		memmove ( iobuf->data, data, len );
+		iob_unput ( iobuf, headroom );
+	}
+
+	/* Pad to minimum packet length */
+	memset ( iob_put ( iobuf, pad_len ), 0, pad_len );
+}
+
+/**
+ * Pad and align I/O buffer
+ *
+ * @v iobuf		I/O buffer
+ * @v min_len		Minimum length
+ *
+ * As iob_pad(), but unconditionally moves the packet data to the
+ * start of the I/O buffer, for devices that require specific
+ * alignment in TX buffers.  The packet data will end up with the
+ * alignment of the I/O buffer itself.
+ *
+ * @c min_len must not exceed @v IOB_ZLEN.
+ */
+void iob_pad_align ( struct io_buffer *iobuf, size_t min_len ) {
+	void *data;
+	size_t len;
+	size_t headroom;
+	signed int pad_len;
+
+	assert ( min_len <= IOB_ZLEN );
+
 	/* Move packet data to start of I/O buffer.  This will both
-	 * align the data (since I/O buffers are aligned to
-	 * IOB_ALIGN) and give us sufficient space for the
-	 * zero-padding
+	 * align the data (since I/O buffers are aligned on their own
+	 * size) and give us sufficient space for the zero-padding
 	 */
 	data = iobuf->data;
 	len = iob_len ( iobuf );
@@ -56,6 +56,30 @@ static uint8_t next_ident_high = 0;
 /** List of IPv4 miniroutes */
 struct list_head ipv4_miniroutes = LIST_HEAD_INIT ( ipv4_miniroutes );
 
+/** An IPv4 route cache entry */
+struct ipv4_route_cache {
+	/** Original destination address */
+	struct in_addr dest;
+	/** Scope ID (for link-local or multicast destinations) */
+	unsigned int scope_id;
+	/** Routing table entry, or NULL if entry is invalid */
+	struct ipv4_miniroute *miniroute;
+	/** Next hop address */
+	struct in_addr next_hop;
+};
+
+/** Number of route cache entries */
+#define IPV4_ROUTE_CACHE_SIZE 4
+
+/** Route cache, direct-mapped by destination address
+ *
+ * Steady-state transmission is dominated by a handful of
+ * destinations (e.g. the download server and the DNS server), so a
+ * small cache of recent routing decisions allows most transmitted
+ * packets to skip the routing table walk.
+ */
+static struct ipv4_route_cache ipv4_route_cache[IPV4_ROUTE_CACHE_SIZE];
+
 /** IPv4 statistics */
 static struct ip_statistics ipv4_stats;
 
@@ -72,6 +96,15 @@ static struct profiler ipv4_tx_profiler __profiler = { .name = "ipv4.tx" };
 /** Receive profiler */
 static struct profiler ipv4_rx_profiler __profiler = { .name = "ipv4.rx" };
 
+/**
+ * Invalidate the route cache
+ *
+ * Called whenever the routing table changes.
+ */
+static void ipv4_route_flush ( void ) {
+	memset ( ipv4_route_cache, 0, sizeof ( ipv4_route_cache ) );
+}
+
 /**
  * Add IPv4 minirouting table entry
  *
@@ -114,6 +147,9 @@ static int add_ipv4_miniroute ( struct net_device *netdev,
 		list_add ( &miniroute->list, &ipv4_miniroutes );
 	}
 
+	/* Invalidate cached routing decisions */
+	ipv4_route_flush();
+
 	return 0;
 }
 
@@ -134,6 +170,9 @@ static void del_ipv4_miniroute ( struct ipv4_miniroute *miniroute ) {
 	netdev_put ( miniroute->netdev );
 	list_del ( &miniroute->list );
 	free ( miniroute );
+
+	/* Invalidate cached routing decisions */
+	ipv4_route_flush();
 }
 
 /**
@@ -150,8 +189,27 @@ static void del_ipv4_miniroute ( struct ipv4_miniroute *miniroute ) {
 static struct ipv4_miniroute * ipv4_route ( unsigned int scope_id,
 					    struct in_addr *dest ) {
 	struct ipv4_miniroute *miniroute;
+	struct ipv4_route_cache *cache;
+	struct in_addr orig_dest;
+	uint32_t fold;
+
+	/* Check route cache.  A cached decision remains usable only
+	 * while its network device remains open; the cache is flushed
+	 * on any routing table change.
+	 */
+	fold = ( dest->s_addr ^ ( dest->s_addr >> 16 ) );
+	cache = &ipv4_route_cache[ ( fold ^ ( fold >> 8 ) ) %
+				   IPV4_ROUTE_CACHE_SIZE ];
+	if ( cache->miniroute &&
+	     ( cache->dest.s_addr == dest->s_addr ) &&
+	     ( cache->scope_id == scope_id ) &&
+	     netdev_is_open ( cache->miniroute->netdev ) ) {
+		*dest = cache->next_hop;
+		return cache->miniroute;
+	}
 
 	/* Find first usable route in routing table */
+	orig_dest = *dest;
 	list_for_each_entry ( miniroute, &ipv4_miniroutes, list ) {
 
 		/* Skip closed network devices */
@@ -164,7 +222,7 @@ static struct ipv4_miniroute * ipv4_route ( unsigned int scope_id,
 			 * matches this network device, then use this route.
 			 */
 			if ( miniroute->netdev->index == scope_id )
-				return miniroute;
+				goto found;
 
 		} else {
 
@@ -173,7 +231,7 @@ static struct ipv4_miniroute * ipv4_route ( unsigned int scope_id,
 			 */
 			if ( ( ( dest->s_addr ^ miniroute->address.s_addr )
 			       & miniroute->netmask.s_addr ) == 0 )
-				return miniroute;
+				goto found;
 
 			/* If destination is an off-link global
 			 * address, and we have a default gateway,
@@ -181,12 +239,20 @@ static struct ipv4_miniroute * ipv4_route ( unsigned int scope_id,
 			 */
 			if ( miniroute->gateway.s_addr ) {
 				*dest = miniroute->gateway;
-				return miniroute;
+				goto found;
 			}
 		}
 	}
 
 	return NULL;
+
+ found:
+	/* Record routing decision in cache */
+	cache->dest = orig_dest;
+	cache->scope_id = scope_id;
+	cache->next_hop = *dest;
+	cache->miniroute = miniroute;
+	return miniroute;
 }
 
 /**
@@ -523,7 +589,8 @@ static int ipv4_rx ( struct io_buffer *iobuf,
 		       "(packet is %zd bytes)\n", hdrlen, iob_len ( iobuf ) );
 		goto err_header;
 	}
-	if ( ( csum = tcpip_chksum ( iphdr, hdrlen ) ) != 0 ) {
+	if ( ( ! ( iobuf->flags & IOB_FL_CSUM_OK ) ) &&
+	     ( ( csum = tcpip_chksum ( iphdr, hdrlen ) ) != 0 ) ) {
 		DBGC ( iphdr->src, "IPv4 checksum incorrect (is %04x "
 		       "including checksum field, should be 0000)\n", csum );
 		goto err_header;
@@ -658,8 +725,25 @@ int inet_aton ( const char *string, struct in_addr *in ) {
 char * inet_ntoa ( struct in_addr in ) {
 	static char buf[16]; /* "xxx.xxx.xxx.xxx" */
 	uint8_t *bytes = ( uint8_t * ) &in;
-	
-	sprintf ( buf, "%d.%d.%d.%d", bytes[0], bytes[1], bytes[2], bytes[3] );
+	char *out = buf;
+	unsigned int value;
+	unsigned int i;
+
+	/* Emit digits directly rather than via sprintf(), which costs
+	 * a full format string parse on each of the many calls made
+	 * while expanding settings and transcribing addresses.
+	 */
+	for ( i = 0 ; i < sizeof ( in ) ; i++ ) {
+		if ( i )
+			*(out++) = '.';
+		value = bytes[i];
+		if ( value >= 100 )
+			*(out++) = ( '0' + ( value / 100 ) );
+		if ( value >= 10 )
+			*(out++) = ( '0' + ( ( value / 10 ) % 10 ) );
+		*(out++) = ( '0' + ( value % 10 ) );
+	}
+	*out = '\0';
 	return buf;
 }
 
@@ -59,6 +59,30 @@ FILE_LICENCE ( GPL2_OR_LATER );
 /** List of IPv6 miniroutes */
 struct list_head ipv6_miniroutes = LIST_HEAD_INIT ( ipv6_miniroutes );
 
+/** An IPv6 routing decision cache entry */
+struct ipv6_route_cache {
+	/** Original destination address */
+	struct in6_addr dest;
+	/** Scope ID (for link-local or multicast destinations) */
+	unsigned int scope_id;
+	/** Routing table entry, or NULL if entry is invalid */
+	struct ipv6_miniroute *miniroute;
+	/** Next hop address */
+	struct in6_addr next_hop;
+};
+
+/** Number of IPv6 routing decision cache entries
+ *
+ * This is a policy decision, matching the IPv4 routing cache.  Boot
+ * traffic talks to a very small set of destinations; a small
+ * direct-mapped cache suffices to skip the scope and prefix-matching
+ * walk on almost every transmitted packet.
+ */
+#define IPV6_ROUTE_CACHE_SIZE 4
+
+/** IPv6 routing decision cache */
+static struct ipv6_route_cache ipv6_route_cache[IPV6_ROUTE_CACHE_SIZE];
+
 /** IPv6 statistics */
 static struct ip_statistics ipv6_stats;
 
@@ -69,6 +93,16 @@ ipv6_statistics_family __ip_statistics_family ( IP_STATISTICS_IPV6 ) = {
 	.stats = &ipv6_stats,
 };
 
+/**
+ * Flush IPv6 routing decision cache
+ *
+ * Called whenever the routing table changes, since any cached
+ * decision may have been invalidated.
+ */
+static void ipv6_route_flush ( void ) {
+	memset ( ipv6_route_cache, 0, sizeof ( ipv6_route_cache ) );
+}
+
 /**
  * Determine debugging colour for IPv6 debug messages
  *
@@ -216,7 +250,10 @@ static struct ipv6_miniroute * ipv6_miniroute ( struct net_device *netdev,
  */
 int ipv6_add_miniroute ( struct net_device *netdev, struct in6_addr *address,
 			 unsigned int prefix_len, struct in6_addr *router ) {
+	struct ll_protocol *ll_protocol = netdev->ll_protocol;
 	struct ipv6_miniroute *miniroute;
+	struct in6_addr solicited;
+	uint8_t ll_mcast[MAX_LL_ADDR_LEN];
 	uint8_t *prefix_mask;
 	unsigned int remaining;
 	unsigned int i;
@@ -270,6 +307,32 @@ int ipv6_add_miniroute ( struct net_device *netdev, struct in6_addr *address,
 	if ( miniroute->prefix_len == IPV6_MAX_PREFIX_LEN )
 		miniroute->flags |= IPV6_HAS_ADDRESS;
 
+	/* Update solicited-node multicast group membership, so that
+	 * hardware receive filters will accept neighbour
+	 * solicitations for this address.
+	 */
+	if ( miniroute->flags & IPV6_HAS_ADDRESS ) {
+		memset ( &solicited, 0, sizeof ( solicited ) );
+		ipv6_solicited_node ( &solicited, &miniroute->address );
+		if ( ll_protocol->mc_hash ( AF_INET6, &solicited,
+					    ll_mcast ) == 0 ) {
+			if ( ( miniroute->flags & IPV6_HAS_GROUP ) &&
+			     ( memcmp ( miniroute->ll_mcast, ll_mcast,
+					ll_protocol->ll_addr_len ) != 0 ) ) {
+				netdev_mcast_del ( netdev,
+						   miniroute->ll_mcast );
+				miniroute->flags &= ~IPV6_HAS_GROUP;
+			}
+			if ( ! ( miniroute->flags & IPV6_HAS_GROUP ) ) {
+				memcpy ( miniroute->ll_mcast, ll_mcast,
+					 ll_protocol->ll_addr_len );
+				netdev_mcast_add ( netdev,
+						   miniroute->ll_mcast );
+				miniroute->flags |= IPV6_HAS_GROUP;
+			}
+		}
+	}
+
 	/* Update scope */
 	miniroute->scope = ipv6_scope ( &miniroute->address );
 
@@ -280,6 +343,9 @@ int ipv6_add_miniroute ( struct net_device *netdev, struct in6_addr *address,
 		miniroute->flags |= IPV6_HAS_ROUTER;
 	}
 
+	/* Flush routing decision cache */
+	ipv6_route_flush();
+
 	ipv6_dump_miniroute ( miniroute );
 	return 0;
 }
@@ -291,9 +357,16 @@ int ipv6_add_miniroute ( struct net_device *netdev, struct in6_addr *address,
  */
 void ipv6_del_miniroute ( struct ipv6_miniroute *miniroute ) {
 
+	/* Leave solicited-node multicast group, if joined */
+	if ( miniroute->flags & IPV6_HAS_GROUP )
+		netdev_mcast_del ( miniroute->netdev, miniroute->ll_mcast );
+
 	netdev_put ( miniroute->netdev );
 	list_del ( &miniroute->list );
 	free ( miniroute );
+
+	/* Flush routing decision cache */
+	ipv6_route_flush();
 }
 
 /**
@@ -308,12 +381,33 @@ struct ipv6_miniroute * ipv6_route ( unsigned int scope_id,
 				     struct in6_addr **dest ) {
 	struct ipv6_miniroute *miniroute;
 	struct ipv6_miniroute *chosen = NULL;
+	struct ipv6_route_cache *cache;
+	struct in6_addr *orig_dest;
+	uint32_t fold;
 	unsigned int best = 0;
 	unsigned int match_len;
 	unsigned int score;
 	unsigned int scope;
 
+	/* Check routing decision cache.  A cached decision remains
+	 * usable only while its network device remains open; the
+	 * cache is flushed on any routing table change.
+	 */
+	fold = ( (*dest)->s6_addr32[0] ^ (*dest)->s6_addr32[1] ^
+		 (*dest)->s6_addr32[2] ^ (*dest)->s6_addr32[3] );
+	fold ^= ( fold >> 16 );
+	cache = &ipv6_route_cache[ ( fold ^ ( fold >> 8 ) ) %
+				   IPV6_ROUTE_CACHE_SIZE ];
+	if ( cache->miniroute &&
+	     ( memcmp ( &cache->dest, *dest, sizeof ( cache->dest ) ) == 0 ) &&
+	     ( cache->scope_id == scope_id ) &&
+	     netdev_is_open ( cache->miniroute->netdev ) ) {
+		*dest = &cache->next_hop;
+		return cache->miniroute;
+	}
+
 	/* Calculate destination address scope */
+	orig_dest = *dest;
 	scope = ipv6_scope ( *dest );
 
 	/* Find first usable route in routing table */
@@ -341,8 +435,10 @@ struct ipv6_miniroute * ipv6_route ( unsigned int scope_id,
 		match_len = ipv6_match_len ( miniroute, *dest );
 
 		/* If destination is on-link, then use this route */
-		if ( match_len >= miniroute->prefix_len )
-			return miniroute;
+		if ( match_len >= miniroute->prefix_len ) {
+			chosen = miniroute;
+			goto found;
+		}
 
 		/* If destination is unicast, then skip off-link
 		 * entries with no router.
@@ -364,14 +460,21 @@ struct ipv6_miniroute * ipv6_route ( unsigned int scope_id,
 		}
 	}
 
-	/* Return chosen route, if any */
-	if ( chosen ) {
-		if ( ! IN6_IS_ADDR_MULTICAST ( *dest ) )
-			*dest = &chosen->router;
-		return chosen;
-	}
+	/* Give up if no route was chosen */
+	if ( ! chosen )
+		return NULL;
 
-	return NULL;
+	/* Use router as next hop, if applicable */
+	if ( ! IN6_IS_ADDR_MULTICAST ( *dest ) )
+		*dest = &chosen->router;
+
+ found:
+	/* Record routing decision in cache */
+	memcpy ( &cache->dest, orig_dest, sizeof ( cache->dest ) );
+	cache->scope_id = scope_id;
+	memcpy ( &cache->next_hop, *dest, sizeof ( cache->next_hop ) );
+	cache->miniroute = chosen;
+	return chosen;
 }
 
 /**
@@ -892,6 +995,7 @@ int inet6_aton ( const char *string, struct in6_addr *in ) {
  * RFC5952 defines the canonical format for IPv6 textual representation.
  */
 char * inet6_ntoa ( const struct in6_addr *in ) {
+	static const char hex_digits[16] = "0123456789abcdef";
 	static char buf[41]; /* ":xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxxx:xxxx" */
 	char *out = buf;
 	char *longest_start = NULL;
@@ -899,10 +1003,14 @@ char * inet6_ntoa ( const struct in6_addr *in ) {
 	int longest_len = 1;
 	int len = 0;
 	char *dest;
+	unsigned int shift;
 	unsigned int i;
 	uint16_t value;
 
-	/* Format address, keeping track of longest run of zeros */
+	/* Format address word-wise, emitting digits directly rather
+	 * than via sprintf(), and keeping track of longest run of
+	 * zeros.
+	 */
 	for ( i = 0 ; i < ( sizeof ( in->s6_addr16 ) /
 			    sizeof ( in->s6_addr16[0] ) ) ; i++ ) {
 		value = ntohs ( in->s6_addr16[i] );
@@ -916,8 +1024,14 @@ char * inet6_ntoa ( const struct in6_addr *in ) {
 		} else {
 			len = 0;
 		}
-		out += sprintf ( out, ":%x", value );
+		*(out++) = ':';
+		for ( shift = 12 ; shift ; shift -= 4 ) {
+			if ( value >> shift )
+				*(out++) = hex_digits[ ( value >> shift ) & 0xf ];
+		}
+		*(out++) = hex_digits[ value & 0xf ];
 	}
+	*out = '\0';
 
 	/* Abbreviate longest run of zeros, if applicable */
 	if ( longest_start ) {
@@ -1253,10 +1367,37 @@ static int ipv6_register_settings ( struct net_device *netdev ) {
 	return rc;
 }
 
+/**
+ * Probe IPv6 network device
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+static int ipv6_probe ( struct net_device *netdev ) {
+	struct in6_addr all_nodes;
+	uint8_t ll_mcast[MAX_LL_ADDR_LEN];
+	int rc;
+
+	/* Join the all-nodes multicast group, so that hardware
+	 * receive filters will accept router advertisements.
+	 */
+	memset ( &all_nodes, 0, sizeof ( all_nodes ) );
+	ipv6_all_nodes ( &all_nodes );
+	if ( netdev->ll_protocol->mc_hash ( AF_INET6, &all_nodes,
+					    ll_mcast ) == 0 )
+		netdev_mcast_add ( netdev, ll_mcast );
+
+	/* Register link-local address settings */
+	if ( ( rc = ipv6_register_settings ( netdev ) ) != 0 )
+		return rc;
+
+	return 0;
+}
+
 /** IPv6 network device driver */
 struct net_driver ipv6_driver __net_driver = {
 	.name = "IPv6",
-	.probe = ipv6_register_settings,
+	.probe = ipv6_probe,
 };
 
 /**
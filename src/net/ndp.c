@@ -1251,3 +1251,28 @@ struct net_device_configurator ipv6_configurator __net_device_configurator = {
 	.name = "ipv6",
 	.start = start_ipv6conf,
 };
+
+/**
+ * Handle network device state change
+ *
+ * @v netdev		Network device
+ */
+static void ndp_notify ( struct net_device *netdev ) {
+
+	/* Transmit a speculative router solicitation as soon as any
+	 * link comes up, so that the router advertisement has
+	 * (ideally) already been processed by the time the IPv6
+	 * configurator starts, and so that solicitations on multiple
+	 * network devices proceed in parallel rather than waiting for
+	 * each device's configurator to run in turn.  Errors are
+	 * harmless, since the configurator will retransmit.
+	 */
+	if ( netdev_is_open ( netdev ) && netdev_link_ok ( netdev ) )
+		ndp_tx_router_solicitation ( netdev );
+}
+
+/** NDP network device driver */
+struct net_driver ndp_driver __net_driver = {
+	.name = "NDP",
+	.notify = ndp_notify,
+};
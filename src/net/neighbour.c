@@ -51,7 +51,47 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** The neighbour cache */
 struct list_head neighbours = LIST_HEAD_INIT ( neighbours );
 
+/** Neighbour cache hash buckets */
+static struct list_head neighbour_buckets[NEIGHBOUR_NUM_BUCKETS];
+
+/** Neighbour cache hash buckets have been initialised */
+static int neighbour_buckets_initialised;
+
+/** Number of neighbour cache entries */
+static unsigned int neighbour_count;
+
 static void neighbour_expired ( struct retry_timer *timer, int over );
+static void neighbour_destroy ( struct neighbour *neighbour, int rc );
+
+/**
+ * Get hash bucket for neighbour cache entry
+ *
+ * @v netdev		Network device
+ * @v net_protocol	Network-layer protocol
+ * @v net_dest		Destination network-layer address
+ * @ret bucket		Hash bucket
+ */
+static struct list_head *
+neighbour_bucket ( struct net_device *netdev,
+		   struct net_protocol *net_protocol, const void *net_dest ) {
+	const uint8_t *bytes = net_dest;
+	unsigned int hash;
+	unsigned int i;
+
+	/* Initialise buckets, if not already done */
+	if ( ! neighbour_buckets_initialised ) {
+		for ( i = 0 ; i < NEIGHBOUR_NUM_BUCKETS ; i++ )
+			INIT_LIST_HEAD ( &neighbour_buckets[i] );
+		neighbour_buckets_initialised = 1;
+	}
+
+	/* Hash device, protocol, and destination address */
+	hash = ( ( ( unsigned long ) netdev ) ^
+		 ( ( unsigned long ) net_protocol ) );
+	for ( i = 0 ; i < net_protocol->net_addr_len ; i++ )
+		hash = ( ( hash * 31 ) + bytes[i] );
+	return &neighbour_buckets[ hash % NEIGHBOUR_NUM_BUCKETS ];
+}
 
 /**
  * Free neighbour cache entry
@@ -84,6 +124,15 @@ static struct neighbour * neighbour_create ( struct net_device *netdev,
 					     struct net_protocol *net_protocol,
 					     const void *net_dest ) {
 	struct neighbour *neighbour;
+	struct neighbour *victim;
+
+	/* Replace least recently used entry if the cache is full */
+	if ( neighbour_count >= NEIGHBOUR_MAX_ENTRIES ) {
+		victim = list_last_entry ( &neighbours, struct neighbour,
+					   list );
+		if ( victim )
+			neighbour_destroy ( victim, -ENOBUFS );
+	}
 
 	/* Allocate and initialise entry */
 	neighbour = zalloc ( sizeof ( *neighbour ) );
@@ -101,6 +150,9 @@ static struct neighbour * neighbour_create ( struct net_device *netdev,
 
 	/* Transfer ownership to cache */
 	list_add ( &neighbour->list, &neighbours );
+	list_add ( &neighbour->bucket,
+		   neighbour_bucket ( netdev, net_protocol, net_dest ) );
+	neighbour_count++;
 
 	DBGC ( neighbour, "NEIGHBOUR %s %s %s created\n", netdev->name,
 	       net_protocol->name, net_protocol->ntoa ( net_dest ) );
@@ -119,14 +171,16 @@ static struct neighbour * neighbour_find ( struct net_device *netdev,
 					   struct net_protocol *net_protocol,
 					   const void *net_dest ) {
 	struct neighbour *neighbour;
+	struct list_head *bucket;
 
-	list_for_each_entry ( neighbour, &neighbours, list ) {
+	bucket = neighbour_bucket ( netdev, net_protocol, net_dest );
+	list_for_each_entry ( neighbour, bucket, bucket ) {
 		if ( ( neighbour->netdev == netdev ) &&
 		     ( neighbour->net_protocol == net_protocol ) &&
 		     ( memcmp ( neighbour->net_dest, net_dest,
 				net_protocol->net_addr_len ) == 0 ) ) {
 
-			/* Move to start of cache */
+			/* Mark as most recently used */
 			list_del ( &neighbour->list );
 			list_add ( &neighbour->list, &neighbours );
 
@@ -223,6 +277,8 @@ static void neighbour_destroy ( struct neighbour *neighbour, int rc ) {
 
 	/* Take ownership from cache */
 	list_del ( &neighbour->list );
+	list_del ( &neighbour->bucket );
+	neighbour_count--;
 
 	/* Stop timer */
 	stop_timer ( &neighbour->timer );
@@ -41,6 +41,11 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/profile.h>
 #include <ipxe/fault.h>
 #include <ipxe/vlan.h>
+#include <ipxe/nap.h>
+#include <ipxe/retry.h>
+#include <ipxe/timer.h>
+#include <ipxe/tcp.h>
+#include <ipxe/pcap.h>
 #include <ipxe/netdevice.h>
 
 /** @file
@@ -307,6 +312,9 @@ int netdev_tx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	if ( ( rc = inject_fault ( NETDEV_DISCARD_RATE ) ) != 0 )
 		goto err;
 
+	/* Capture packet, if applicable */
+	pcap_capture ( iobuf );
+
 	/* Transmit packet */
 	if ( ( rc = netdev->op->transmit ( netdev, iobuf ) ) != 0 )
 		goto err;
@@ -369,8 +377,10 @@ void netdev_tx_defer ( struct net_device *netdev, struct io_buffer *iobuf ) {
 void netdev_tx_err ( struct net_device *netdev,
 		     struct io_buffer *iobuf, int rc ) {
 
-	/* Update statistics counter */
+	/* Update statistics counters */
 	netdev_record_stat ( &netdev->tx_stats, rc );
+	if ( ( rc == 0 ) && iobuf )
+		netdev->tx_stats.bytes += iob_len ( iobuf );
 	if ( rc == 0 ) {
 		DBGC2 ( netdev, "NETDEV %s transmission %p complete\n",
 			netdev->name, iobuf );
@@ -479,11 +489,15 @@ void netdev_rx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 		return;
 	}
 
+	/* Capture packet, if applicable */
+	pcap_capture ( iobuf );
+
 	/* Enqueue packet */
 	list_add_tail ( &iobuf->list, &netdev->rx_queue );
 
-	/* Update statistics counter */
+	/* Update statistics counters */
 	netdev_record_stat ( &netdev->rx_stats, 0 );
+	netdev->rx_stats.bytes += iob_len ( iobuf );
 }
 
 /**
@@ -655,6 +669,57 @@ struct net_device * alloc_netdev ( size_t priv_len ) {
 	return netdev;
 }
 
+/**
+ * Sample TCP transmission rate counters
+ *
+ * This is a weak definition, which will be overridden if the TCP
+ * protocol is present in the build.
+ */
+__weak void tcp_rate_sample ( void ) {}
+
+/**
+ * Sample traffic rate history windows
+ *
+ * @v timer		Rate history sampling timer
+ * @v over		Failure indicator
+ */
+static void netdev_history_expired ( struct retry_timer *timer,
+				     int over __unused ) {
+	struct net_device *netdev;
+	struct net_device_history *history;
+	struct net_device_history_window *window;
+
+	/* Record deltas since previous sample for each network device */
+	for_each_netdev ( netdev ) {
+		history = &netdev->history;
+		history->index = ( ( history->index + 1 ) %
+				   NETDEV_HISTORY_WINDOWS );
+		window = &history->windows[ history->index ];
+		window->tx_bytes = ( netdev->tx_stats.bytes -
+				     history->tx_bytes );
+		window->rx_bytes = ( netdev->rx_stats.bytes -
+				     history->rx_bytes );
+		window->tx_good = ( netdev->tx_stats.good -
+				    history->tx_good );
+		window->rx_good = ( netdev->rx_stats.good -
+				    history->rx_good );
+		history->tx_bytes = netdev->tx_stats.bytes;
+		history->rx_bytes = netdev->rx_stats.bytes;
+		history->tx_good = netdev->tx_stats.good;
+		history->rx_good = netdev->rx_stats.good;
+	}
+
+	/* Sample TCP transmission rate counters, if present */
+	tcp_rate_sample();
+
+	/* Restart sampling timer */
+	start_timer_fixed ( timer, TICKS_PER_SEC );
+}
+
+/** Rate history sampling timer */
+static struct retry_timer netdev_history_timer =
+	TIMER_INIT ( netdev_history_expired );
+
 /**
  * Register network device
  *
@@ -724,6 +789,10 @@ int register_netdev ( struct net_device *netdev ) {
 	       netdev->name, netdev->dev->name,
 	       netdev_addr ( netdev ) );
 
+	/* Start rate history sampling */
+	if ( ! timer_running ( &netdev_history_timer ) )
+		start_timer_fixed ( &netdev_history_timer, TICKS_PER_SEC );
+
 	/* Register per-netdev configuration settings */
 	if ( ( rc = register_settings ( netdev_settings ( netdev ),
 					NULL, netdev->name ) ) != 0 ) {
@@ -758,6 +827,128 @@ int register_netdev ( struct net_device *netdev ) {
 	return rc;
 }
 
+/**
+ * Update hardware receive filters
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ *
+ * Reprograms the hardware receive filters (if supported by the
+ * driver) to match the current link-layer address and multicast
+ * filter list.  A failure to update the filters is not fatal: the
+ * device is simply left receiving a superset of the required packets.
+ */
+int netdev_filter ( struct net_device *netdev ) {
+	int rc;
+
+	/* Do nothing unless the device is open and supports filtering */
+	if ( ! ( netdev->state & NETDEV_OPEN ) )
+		return 0;
+	if ( ! netdev->op->filter )
+		return 0;
+
+	/* Update hardware filters */
+	if ( ( rc = netdev->op->filter ( netdev ) ) != 0 ) {
+		DBGC ( netdev, "NETDEV %s could not update receive filters: "
+		       "%s\n", netdev->name, strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Find multicast filter list entry
+ *
+ * @v netdev		Network device
+ * @v ll_addr		Link-layer multicast address
+ * @ret mcast		Multicast filter list entry, or NULL if not found
+ */
+static struct net_device_mcast *
+netdev_mcast_find ( struct net_device *netdev, const void *ll_addr ) {
+	struct net_device_mcast *mcast;
+	unsigned int i;
+
+	for ( i = 0 ; i < netdev->mcast_count ; i++ ) {
+		mcast = &netdev->mcast[i];
+		if ( memcmp ( mcast->ll_addr, ll_addr,
+			      netdev->ll_protocol->ll_addr_len ) == 0 )
+			return mcast;
+	}
+	return NULL;
+}
+
+/**
+ * Add address to multicast filter list
+ *
+ * @v netdev		Network device
+ * @v ll_addr		Link-layer multicast address
+ *
+ * Adding an address can never cause packet loss and so is always
+ * permitted to succeed: if the filter list is full, the device
+ * degrades to accepting all multicast packets.
+ */
+void netdev_mcast_add ( struct net_device *netdev, const void *ll_addr ) {
+	struct net_device_mcast *mcast;
+
+	/* Increment usage count on any existing entry */
+	mcast = netdev_mcast_find ( netdev, ll_addr );
+	if ( mcast ) {
+		mcast->count++;
+		return;
+	}
+
+	/* Degrade to accepting all multicasts if the list is full */
+	if ( netdev->mcast_count == NETDEV_MCAST_MAX ) {
+		DBGC ( netdev, "NETDEV %s multicast filter list overflow\n",
+		       netdev->name );
+		netdev->state |= NETDEV_MCAST_OVERFLOW;
+		netdev_filter ( netdev );
+		return;
+	}
+
+	/* Create new entry */
+	mcast = &netdev->mcast[ netdev->mcast_count++ ];
+	memcpy ( mcast->ll_addr, ll_addr,
+		 netdev->ll_protocol->ll_addr_len );
+	mcast->count = 1;
+	DBGC ( netdev, "NETDEV %s filtering multicast %s\n", netdev->name,
+	       netdev->ll_protocol->ntoa ( mcast->ll_addr ) );
+
+	/* Update hardware filters */
+	netdev_filter ( netdev );
+}
+
+/**
+ * Remove address from multicast filter list
+ *
+ * @v netdev		Network device
+ * @v ll_addr		Link-layer multicast address
+ */
+void netdev_mcast_del ( struct net_device *netdev, const void *ll_addr ) {
+	struct net_device_mcast *mcast;
+
+	/* Ignore addresses not in the list (e.g. addresses added
+	 * after the list overflowed).
+	 */
+	mcast = netdev_mcast_find ( netdev, ll_addr );
+	if ( ! mcast )
+		return;
+
+	/* Do nothing if address is still in use */
+	if ( --mcast->count )
+		return;
+
+	/* Remove entry, replacing it with the last entry in the list */
+	DBGC ( netdev, "NETDEV %s no longer filtering multicast %s\n",
+	       netdev->name, netdev->ll_protocol->ntoa ( mcast->ll_addr ) );
+	memcpy ( mcast, &netdev->mcast[ --netdev->mcast_count ],
+		 sizeof ( *mcast ) );
+
+	/* Update hardware filters */
+	netdev_filter ( netdev );
+}
+
 /**
  * Open network device
  *
@@ -780,6 +971,9 @@ int netdev_open ( struct net_device *netdev ) {
 	if ( ( rc = netdev->op->open ( netdev ) ) != 0 )
 		goto err;
 
+	/* Apply hardware receive filters, if supported */
+	netdev_filter ( netdev );
+
 	/* Add to head of open devices list */
 	list_add ( &netdev->open_list, &open_net_devices );
 
@@ -862,9 +1056,13 @@ void unregister_netdev ( struct net_device *netdev ) {
 	list_del ( &netdev->list );
 	netdev_put ( netdev );
 
-	/* Reset network device index if no devices remain */
-	if ( list_empty ( &net_devices ) )
+	/* Reset network device index and stop rate history
+	 * sampling if no devices remain
+	 */
+	if ( list_empty ( &net_devices ) ) {
 		netdev_index = 0;
+		stop_timer ( &netdev_history_timer );
+	}
 }
 
 /** Enable or disable interrupts
@@ -1028,13 +1226,24 @@ int net_tx ( struct io_buffer *iobuf, struct net_device *netdev,
 int net_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 	     uint16_t net_proto, const void *ll_dest, const void *ll_source,
 	     unsigned int flags ) {
+	static struct net_protocol *net_cache;
 	struct net_protocol *net_protocol;
 
+	/* Check most recently used protocol first; received packets
+	 * typically arrive in runs of the same protocol.
+	 */
+	if ( net_cache && ( net_cache->net_proto == net_proto ) ) {
+		return net_cache->rx ( iobuf, netdev, ll_dest, ll_source,
+				       flags );
+	}
+
 	/* Hand off to network-layer protocol, if any */
 	for_each_table_entry ( net_protocol, NET_PROTOCOLS ) {
-		if ( net_protocol->net_proto == net_proto )
+		if ( net_protocol->net_proto == net_proto ) {
+			net_cache = net_protocol;
 			return net_protocol->rx ( iobuf, netdev, ll_dest,
 						  ll_source, flags );
+		}
 	}
 
 	DBGC ( netdev, "NETDEV %s unknown network protocol %04x\n",
@@ -1046,8 +1255,8 @@ int net_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 /**
  * Poll the network stack
  *
- * This polls all interfaces for received packets, and processes
- * packets from the RX queue.
+ * This polls all interfaces for received packets, and processes up to
+ * NET_RX_BUDGET packets per device from the RX queue.
  */
 void net_poll ( void ) {
 	struct net_device *netdev;
@@ -1056,6 +1265,7 @@ void net_poll ( void ) {
 	const void *ll_dest;
 	const void *ll_source;
 	uint16_t net_proto;
+	unsigned int budget;
 	unsigned int flags;
 	int rc;
 
@@ -1076,8 +1286,9 @@ void net_poll ( void ) {
 		if ( netdev_rx_frozen ( netdev ) )
 			continue;
 
-		/* Process all received packets */
-		while ( ( iobuf = netdev_rx_dequeue ( netdev ) ) ) {
+		/* Process received packets, up to the poll budget */
+		budget = NET_RX_BUDGET;
+		while ( budget-- && ( iobuf = netdev_rx_dequeue ( netdev ) ) ) {
 
 			DBGC2 ( netdev, "NETDEV %s processing %p (%p+%zx)\n",
 				netdev->name, iobuf, iobuf->data,
@@ -1106,6 +1317,52 @@ void net_poll ( void ) {
 	}
 }
 
+/**
+ * Wait for network activity
+ *
+ * If interrupt-driven waiting is enabled (via NET_NAP), enable
+ * interrupts on all open network devices and halt the CPU until an
+ * interrupt (network or timer) occurs, instead of busy polling.  The
+ * data path remains polled: interrupts are used only as a wakeup.
+ *
+ * A packet arriving between the caller's last poll and the halt will
+ * leave the interrupt line asserted and so wakes the CPU immediately;
+ * in the worst case the platform timer tick bounds the sleep.
+ */
+void net_nap ( void ) {
+#ifdef NET_NAP
+	struct net_device *netdev;
+
+	/* Refuse to sleep if any open device cannot generate
+	 * interrupts, or if something else (e.g. a loaded UNDI stack)
+	 * is already managing interrupts.
+	 */
+	list_for_each_entry ( netdev, &net_devices, list ) {
+		if ( ! netdev_is_open ( netdev ) )
+			continue;
+		if ( ! netdev_irq_supported ( netdev ) )
+			return;
+		if ( netdev_irq_enabled ( netdev ) )
+			return;
+	}
+
+	/* Enable interrupts on all open devices */
+	list_for_each_entry ( netdev, &net_devices, list ) {
+		if ( netdev_is_open ( netdev ) )
+			netdev_irq ( netdev, 1 );
+	}
+
+	/* Halt the CPU until the next interrupt */
+	cpu_nap();
+
+	/* Disable interrupts again */
+	list_for_each_entry ( netdev, &net_devices, list ) {
+		if ( netdev_is_open ( netdev ) )
+			netdev_irq ( netdev, 0 );
+	}
+#endif /* NET_NAP */
+}
+
 /**
  * Single-step the network stack
  *
@@ -1157,8 +1414,12 @@ __weak void vlan_netdev_rx_err ( struct net_device *netdev,
 	netdev_rx_err ( netdev, iobuf, rc );
 }
 
-/** Networking stack process */
-PERMANENT_PROCESS ( net_process, net_step );
+/** Networking stack process
+ *
+ * Runs at high priority, since draining device receive rings promptly
+ * matters more than any bulk background work.
+ */
+PERMANENT_PROCESS_PRIO ( net_process, net_step, PROC_PRIO_HIGH );
 
 /**
  * Discard some cached network device data
@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Packet capture
+ *
+ * Transmitted and received frames are teed (headers only, up to a
+ * configurable snap length) into a preallocated ring of fixed-size
+ * slots.  The hooks in the network device core compile down to a
+ * single well-predicted test of @c pcap_armed, so an armed-but-idle
+ * or disarmed capture costs essentially nothing on the datapath: no
+ * allocation, no copy, no I/O.
+ *
+ * The ring may be exported at any time as a file in classic pcap
+ * format, registered as an executable image so that it can be
+ * inspected or uploaded using the standard image machinery.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/timer.h>
+#include <ipxe/uaccess.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/image.h>
+#include <ipxe/netdevice.h>
+#include <ipxe/pcap.h>
+
+/** A captured frame */
+struct pcap_entry {
+	/** Capture timestamp (in ticks) */
+	unsigned long ticks;
+	/** Captured length */
+	uint16_t incl_len;
+	/** Original frame length (saturated) */
+	uint16_t orig_len;
+	/** Captured data (up to the snap length) */
+	uint8_t data[0];
+};
+
+/** Capture is armed
+ *
+ * Tested inline on the datapath; see pcap_capture().
+ */
+int pcap_armed;
+
+/** Capture ring */
+static uint8_t *pcap_ring;
+
+/** Snap length */
+static size_t pcap_snap;
+
+/** Length of a single ring slot */
+static size_t pcap_slot_len;
+
+/** Number of ring slots */
+static unsigned int pcap_slots;
+
+/** Ring producer counter (wraps; total frames captured) */
+static unsigned int pcap_prod;
+
+/**
+ * Get capture ring entry
+ *
+ * @v index		Producer counter value
+ * @ret entry		Ring entry
+ */
+static struct pcap_entry * pcap_entry ( unsigned int index ) {
+
+	return ( ( struct pcap_entry * )
+		 ( pcap_ring + ( ( index % pcap_slots ) * pcap_slot_len ) ) );
+}
+
+/**
+ * Record frame in capture ring
+ *
+ * @v iobuf		I/O buffer containing complete link-layer frame
+ *
+ * Called (indirectly) from the transmit and receive datapaths; must
+ * not allocate, block, or transmit.
+ */
+void pcap_record ( struct io_buffer *iobuf ) {
+	struct pcap_entry *entry = pcap_entry ( pcap_prod );
+	size_t len = iob_len ( iobuf );
+
+	entry->ticks = currticks();
+	entry->orig_len = ( ( len > 0xffff ) ? 0xffff : len );
+	if ( len > pcap_snap )
+		len = pcap_snap;
+	entry->incl_len = len;
+	memcpy ( entry->data, iobuf->data, len );
+	pcap_prod++;
+}
+
+/**
+ * Disarm capture and free capture ring
+ *
+ */
+void pcap_disarm ( void ) {
+
+	pcap_armed = 0;
+	free ( pcap_ring );
+	pcap_ring = NULL;
+	DBG ( "PCAP disarmed after %d frames\n", pcap_prod );
+}
+
+/**
+ * Arm capture
+ *
+ * @v len		Total capture ring size (in bytes)
+ * @v snap		Snap length per frame
+ * @ret rc		Return status code
+ *
+ * Any existing capture ring (and its contents) is discarded.
+ */
+int pcap_arm ( size_t len, size_t snap ) {
+
+	/* Discard any existing capture */
+	pcap_disarm();
+
+	/* Calculate ring geometry */
+	pcap_snap = snap;
+	pcap_slot_len = ( sizeof ( struct pcap_entry ) + snap );
+	pcap_slots = ( len / pcap_slot_len );
+	if ( ! pcap_slots )
+		return -EINVAL;
+
+	/* Allocate capture ring */
+	pcap_ring = malloc ( pcap_slots * pcap_slot_len );
+	if ( ! pcap_ring )
+		return -ENOMEM;
+
+	/* Arm capture */
+	pcap_prod = 0;
+	pcap_armed = 1;
+	DBG ( "PCAP armed: %d slots of %zd bytes (snap %zd)\n",
+	      pcap_slots, pcap_slot_len, pcap_snap );
+
+	return 0;
+}
+
+/**
+ * Export capture ring as a pcap image
+ *
+ * @v name		Image name
+ * @ret rc		Return status code
+ *
+ * Builds a classic pcap file from the currently captured frames
+ * (oldest first) and registers it as an image, from where it can be
+ * inspected or uploaded.  Capture continues; the image is a snapshot.
+ */
+int pcap_export ( const char *name ) {
+	struct pcap_file_header file;
+	struct pcap_packet_header packet;
+	struct pcap_entry *entry;
+	struct image *image;
+	userptr_t data;
+	unsigned int count;
+	unsigned int first;
+	unsigned int i;
+	size_t total;
+	size_t offset;
+	int rc;
+
+	/* Fail if no capture ring exists */
+	if ( ! pcap_ring ) {
+		rc = -ENOENT;
+		goto err_ring;
+	}
+
+	/* Identify captured frames and total file length */
+	count = ( ( pcap_prod < pcap_slots ) ? pcap_prod : pcap_slots );
+	first = ( pcap_prod - count );
+	total = sizeof ( file );
+	for ( i = 0 ; i < count ; i++ )
+		total += ( sizeof ( packet ) +
+			   pcap_entry ( first + i )->incl_len );
+
+	/* Allocate image */
+	image = alloc_image ( NULL );
+	if ( ! image ) {
+		rc = -ENOMEM;
+		goto err_alloc_image;
+	}
+	if ( ( rc = image_set_name ( image, name ) ) != 0 )
+		goto err_set_name;
+
+	/* Allocate image data buffer */
+	data = umalloc ( total );
+	if ( ! data ) {
+		rc = -ENOMEM;
+		goto err_umalloc;
+	}
+
+	/* Construct file header */
+	memset ( &file, 0, sizeof ( file ) );
+	file.magic = PCAP_MAGIC;
+	file.major = PCAP_MAJOR;
+	file.minor = PCAP_MINOR;
+	file.snaplen = pcap_snap;
+	file.network = PCAP_LINKTYPE_ETHERNET;
+	copy_to_user ( data, 0, &file, sizeof ( file ) );
+	offset = sizeof ( file );
+
+	/* Construct per-packet records, oldest first */
+	for ( i = 0 ; i < count ; i++ ) {
+		entry = pcap_entry ( first + i );
+		packet.ts_sec = ( entry->ticks / TICKS_PER_SEC );
+		packet.ts_usec = ( ( ( entry->ticks % TICKS_PER_SEC ) *
+				     1000000UL ) / TICKS_PER_SEC );
+		packet.incl_len = entry->incl_len;
+		packet.orig_len = entry->orig_len;
+		copy_to_user ( data, offset, &packet, sizeof ( packet ) );
+		offset += sizeof ( packet );
+		copy_to_user ( data, offset, entry->data, entry->incl_len );
+		offset += entry->incl_len;
+	}
+	assert ( offset == total );
+
+	/* Register image */
+	image->data = data;
+	image->len = total;
+	if ( ( rc = register_image ( image ) ) != 0 )
+		goto err_register;
+	DBG ( "PCAP exported %d frames (%zd bytes) as \"%s\"\n",
+	      count, total, image->name );
+
+	/* Drop our reference; the image is owned by the image list */
+	image_put ( image );
+
+	return 0;
+
+ err_register:
+ err_umalloc:
+ err_set_name:
+	image_put ( image );
+ err_alloc_image:
+ err_ring:
+	return rc;
+}
+
+/**
+ * Replay a pcap image into a network device's receive path
+ *
+ * @v image		Image containing a classic pcap file
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ *
+ * Injects each captured frame into the network device's receive
+ * queue, exactly as though it had arrived from the wire, polling the
+ * network stack after each frame.  Frames are replayed back-to-back
+ * regardless of their original timestamps: the intent is a
+ * deterministic, CPU-bound run of the protocol engines over a
+ * recorded frame stream (e.g. for profiling tcp.rx against a
+ * production trace), not a faithful reproduction of its timing.
+ */
+int pcap_replay ( struct image *image, struct net_device *netdev ) {
+	struct pcap_file_header file;
+	struct pcap_packet_header packet;
+	struct io_buffer *iobuf;
+	unsigned int count = 0;
+	size_t offset;
+
+	/* Parse and check file header */
+	if ( image->len < sizeof ( file ) )
+		return -EINVAL;
+	copy_from_user ( &file, image->data, 0, sizeof ( file ) );
+	if ( file.magic != PCAP_MAGIC )
+		return -EINVAL;
+	if ( file.network != PCAP_LINKTYPE_ETHERNET )
+		return -ENOTSUP;
+
+	/* Replay frames */
+	offset = sizeof ( file );
+	while ( ( offset + sizeof ( packet ) ) <= image->len ) {
+		copy_from_user ( &packet, image->data, offset,
+				 sizeof ( packet ) );
+		offset += sizeof ( packet );
+		if ( packet.incl_len > ( image->len - offset ) )
+			return -EINVAL;
+		iobuf = alloc_iob ( packet.incl_len );
+		if ( ! iobuf )
+			return -ENOMEM;
+		copy_from_user ( iob_put ( iobuf, packet.incl_len ),
+				 image->data, offset, packet.incl_len );
+		offset += packet.incl_len;
+		netdev_rx ( netdev, iob_disown ( iobuf ) );
+		net_poll();
+		count++;
+	}
+	DBG ( "PCAP replayed %d frames from \"%s\" via %s\n",
+	      count, image->name, netdev->name );
+
+	return 0;
+}
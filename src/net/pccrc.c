@@ -167,40 +167,47 @@ static int peerdist_info_v1_blocks ( const struct peerdist_info *info,
  * @v index		Segment index
  * @ret offset		Block description offset, or negative error
  */
-static ssize_t peerdist_info_v1_block_offset ( const struct peerdist_info *info,
+static ssize_t peerdist_info_v1_block_offset ( struct peerdist_info *info,
 					       unsigned int index ) {
 	size_t digestsize = info->digestsize;
-	unsigned int i;
-	size_t offset;
 	int blocks;
 	int rc;
 
 	/* Sanity check */
 	assert ( index < info->segments );
 
-	/* Calculate offset of first block description */
-	offset = ( sizeof ( struct peerdist_info_v1 ) +
-		   ( info->segments *
-		     sizeof ( peerdist_info_v1_segment_t ( digestsize ) ) ) );
+	/* Start from the cached cursor position, unless it is invalid
+	 * or lies beyond the requested segment.
+	 */
+	if ( ( info->cursor.offset == 0 ) || ( info->cursor.index > index ) ) {
+		info->cursor.index = 0;
+		info->cursor.offset =
+			( sizeof ( struct peerdist_info_v1 ) +
+			  ( info->segments *
+			    sizeof ( peerdist_info_v1_segment_t ( digestsize ))));
+	}
 
 	/* Iterate over block descriptions until we find this segment */
-	for ( i = 0 ; i < index ; i++ ) {
+	for ( ; info->cursor.index < index ; info->cursor.index++ ) {
 
 		/* Get number of blocks */
-		blocks = peerdist_info_v1_blocks ( info, offset );
+		blocks = peerdist_info_v1_blocks ( info, info->cursor.offset );
 		if ( blocks < 0 ) {
 			rc = blocks;
 			DBGC ( info, "PCCRC %p segment %d could not get number "
-			       "of blocks: %s\n", info, i, strerror ( rc ) );
+			       "of blocks: %s\n", info, info->cursor.index,
+			       strerror ( rc ) );
+			info->cursor.offset = 0;
 			return rc;
 		}
 
 		/* Move to next block description */
-		offset += sizeof ( peerdist_info_v1_block_t ( digestsize,
-							      blocks ) );
+		info->cursor.offset +=
+			sizeof ( peerdist_info_v1_block_t ( digestsize,
+							    blocks ) );
 	}
 
-	return offset;
+	return info->cursor.offset;
 }
 
 /**
@@ -290,7 +297,7 @@ static int peerdist_info_v1 ( struct peerdist_info *info ) {
  * @ret rc		Return status code
  */
 static int peerdist_info_v1_segment ( struct peerdist_info_segment *segment ) {
-	const struct peerdist_info *info = segment->info;
+	struct peerdist_info *info = segment->info;
 	size_t digestsize = info->digestsize;
 	peerdist_info_v1_segment_t ( digestsize ) raw;
 	ssize_t raw_offset;
@@ -327,6 +334,7 @@ static int peerdist_info_v1_segment ( struct peerdist_info_segment *segment ) {
 		rc = raw_offset;
 		return rc;
 	}
+	segment->offset = raw_offset;
 
 	/* Get number of blocks */
 	blocks = peerdist_info_v1_blocks ( info, raw_offset );
@@ -355,7 +363,7 @@ static int peerdist_info_v1_block ( struct peerdist_info_block *block ) {
 	const struct peerdist_info *info = segment->info;
 	size_t digestsize = info->digestsize;
 	peerdist_info_v1_block_t ( digestsize, segment->blocks ) raw;
-	ssize_t raw_offset;
+	size_t raw_offset;
 	int rc;
 
 	/* Sanity checks */
@@ -370,15 +378,11 @@ static int peerdist_info_v1_block ( struct peerdist_info_block *block ) {
 	if ( block->range.end > segment->range.end )
 		block->range.end = segment->range.end;
 
-	/* Locate block description */
-	raw_offset = peerdist_info_v1_block_offset ( info, segment->index );
-	if ( raw_offset < 0 ) {
-		rc = raw_offset;
-		return rc;
-	}
-
-	/* Get block hash */
-	raw_offset += offsetof ( typeof ( raw ), hash[block->index] );
+	/* Get block hash, using the block description offset recorded
+	 * when the segment was parsed.
+	 */
+	raw_offset = ( segment->offset +
+		       offsetof ( typeof ( raw ), hash[block->index] ) );
 	if ( ( rc = peerdist_info_get ( info, block->hash, raw_offset,
 					digestsize ) ) != 0 ) {
 		DBGC ( info, "PCCRC %p segment %d block %d could not get "
@@ -576,7 +580,7 @@ static int peerdist_info_v2 ( struct peerdist_info *info ) {
  * @ret rc		Return status code
  */
 static int peerdist_info_v2_segment ( struct peerdist_info_segment *segment ) {
-	const struct peerdist_info *info = segment->info;
+	struct peerdist_info *info = segment->info;
 	size_t digestsize = info->digestsize;
 	peerdist_info_v2_segment_t ( digestsize ) raw;
 	struct peerdist_info_v2_cursor cursor;
@@ -587,9 +591,22 @@ static int peerdist_info_v2_segment ( struct peerdist_info_segment *segment ) {
 	/* Sanity checks */
 	assert ( segment->index < info->segments );
 
+	/* Resume from the cached cursor position, unless it is
+	 * invalid or lies beyond the target segment.
+	 */
+	if ( info->cursor.offset &&
+	     ( info->cursor.index <= segment->index ) ) {
+		cursor.offset = info->cursor.offset;
+		cursor.remaining = info->cursor.remaining;
+		cursor.len = info->cursor.len;
+		index = info->cursor.index;
+	} else {
+		peerdist_info_v2_cursor_init ( &cursor );
+		index = 0;
+	}
+
 	/* Iterate over all segments before the target segment */
-	for ( peerdist_info_v2_cursor_init ( &cursor ), index = 0 ;
-	      index < segment->index ; index++ ) {
+	for ( ; index < segment->index ; index++ ) {
 
 		/* Update segment cursor */
 		if ( ( rc = peerdist_info_v2_cursor_next ( info,
@@ -601,6 +618,12 @@ static int peerdist_info_v2_segment ( struct peerdist_info_segment *segment ) {
 		}
 	}
 
+	/* Update cached cursor */
+	info->cursor.index = index;
+	info->cursor.offset = cursor.offset;
+	info->cursor.remaining = cursor.remaining;
+	info->cursor.len = cursor.len;
+
 	/* Get raw description */
 	if ( ( rc = peerdist_info_get ( info, &raw, cursor.offset,
 					sizeof ( raw ) ) ) != 0 ) {
@@ -723,7 +746,7 @@ int peerdist_info ( userptr_t data, size_t len, struct peerdist_info *info ) {
  * @v index		Segment index
  * @ret rc		Return status code
  */
-int peerdist_info_segment ( const struct peerdist_info *info,
+int peerdist_info_segment ( struct peerdist_info *info,
 			    struct peerdist_info_segment *segment,
 			    unsigned int index ) {
 	int rc;
@@ -43,10 +43,27 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 
 /** PeerDist decryption chunksize
+ *
+ * Larger chunks reduce the per-chunk overhead of decryption and
+ * verification, allowing completed blocks to be finished (and their
+ * multiplexer slots recycled) more quickly, while still yielding to
+ * the network stack frequently enough to keep concurrent block
+ * fetches progressing.
  *
  * This is a policy decision.
  */
-#define PEERBLK_DECRYPT_CHUNKSIZE 2048
+#define PEERBLK_DECRYPT_CHUNKSIZE 16384
+
+/** PeerDist maximum queue depth per peer
+ *
+ * Prefer to spread concurrent retrieval protocol downloads across the
+ * discovered peers rather than queueing every block against the first
+ * peer in the list.  A peer already serving this many blocks will be
+ * passed over if any less heavily loaded peer is available.
+ *
+ * This is a policy decision.
+ */
+#define PEERBLK_PEER_MAX_DEPTH 4
 
 /** PeerDist maximum number of concurrent raw block downloads
  *
@@ -175,6 +192,13 @@ static void peerblk_reset ( struct peerdist_block *peerblk, int rc ) {
 	intf_restart ( &peerblk->raw, rc );
 	intf_restart ( &peerblk->retrieval, rc );
 
+	/* Release peer queue depth, if applicable */
+	if ( peerblk->loaded ) {
+		assert ( peerblk->loaded->depth > 0 );
+		peerblk->loaded->depth--;
+		peerblk->loaded = NULL;
+	}
+
 	/* Remove from download queue, if applicable */
 	if ( peerblk->queue )
 		peerblk_dequeue ( peerblk );
@@ -1033,7 +1057,8 @@ static int peerblk_parse_iv ( struct peerdist_block *peerblk, size_t buf_len,
 	}
 
 	/* Set initialisation vector */
-	cipher_setiv ( peerblk->cipher, peerblk->cipherctx, msg->msg.iv.data );
+	cipher_setiv ( peerblk->cipher, peerblk->cipherctx, msg->msg.iv.data,
+		       blksize );
 
 	return 0;
 }
@@ -1279,8 +1304,11 @@ static void peerblk_expired ( struct retry_timer *timer, int over __unused ) {
 		container_of ( timer, struct peerdist_block, timer );
 	struct peerdisc_segment *segment = peerblk->discovery.segment;
 	struct peerdisc_peer *head;
+	struct peerdisc_peer *start;
 	unsigned long now = peerblk_timestamp();
 	const char *location;
+	unsigned int pass;
+	int busy;
 	int rc;
 
 	/* Profile discovery timeout, if applicable */
@@ -1326,19 +1354,41 @@ static void peerblk_expired ( struct retry_timer *timer, int over __unused ) {
 	if ( peerblk->peer == NULL )
 		peerblk->peer = head;
 
-	/* Attempt retrieval protocol download from next usable peer */
-	list_for_each_entry_continue ( peerblk->peer, &segment->peers, list ) {
-
-		/* Attempt retrieval protocol download from this peer */
-		location = peerblk->peer->location;
-		if ( ( rc = peerblk_retrieval_open ( peerblk,
-						     location ) ) != 0 ) {
-			/* Non-fatal: continue to try next peer */
-			continue;
+	/* Attempt retrieval protocol download from the next usable
+	 * peer.  Make a first pass considering only peers with spare
+	 * queue depth (to spread concurrent block downloads across
+	 * the discovered peers), then a second pass considering the
+	 * remaining, more heavily loaded peers.
+	 */
+	start = peerblk->peer;
+	for ( pass = 0 ; pass < 2 ; pass++ ) {
+		peerblk->peer = start;
+		list_for_each_entry_continue ( peerblk->peer, &segment->peers,
+					       list ) {
+
+			/* Defer heavily loaded peers to the second pass */
+			busy = ( peerblk->peer->depth >=
+				 PEERBLK_PEER_MAX_DEPTH );
+			if ( busy != ( int ) pass )
+				continue;
+
+			/* Attempt retrieval protocol download from
+			 * this peer
+			 */
+			location = peerblk->peer->location;
+			if ( ( rc = peerblk_retrieval_open ( peerblk,
+							     location ) ) !=0 ){
+				/* Non-fatal: continue to try next peer */
+				continue;
+			}
+
+			/* Record queue depth against this peer */
+			peerblk->peer->depth++;
+			peerblk->loaded = peerblk->peer;
+
+			/* Peer download started */
+			return;
 		}
-
-		/* Peer download started */
-		return;
 	}
 
 	/* Add to raw download queue */
@@ -24,6 +24,7 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <ipxe/timer.h>
 #include <ipxe/list.h>
 #include <ipxe/process.h>
@@ -39,7 +40,11 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * This implementation of the timer is designed to satisfy RFC 2988
  * and therefore be usable as a TCP retransmission timer.
- * 
+ *
+ * Running timers are kept in a pair of timing wheels (plus an
+ * overflow list), indexed by expiry time, so that starting, stopping
+ * and polling timers all remain cheap as the number of running timers
+ * grows.
  */
 
 /* The theoretical minimum that the algorithm in stop_timer() can
@@ -48,8 +53,161 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define MIN_TIMEOUT 7
 
-/** List of running timers */
-static LIST_HEAD ( timers );
+/** Default retry timer profile
+ *
+ * Binary exponential backoff between the default timeout limits,
+ * with no jitter.  This matches the historic behaviour of all retry
+ * timers, and remains suitable for use as a TCP retransmission timer.
+ */
+static const struct retry_profile retry_profile_default = {
+	.min = DEFAULT_MIN_TIMEOUT,
+	.max = DEFAULT_MAX_TIMEOUT,
+	.backoff = 1,
+};
+
+/** LAN control-plane retry profile
+ *
+ * Intended for link-local control-plane protocols (e.g. DHCP), for
+ * which a lost packet costs only a cheap broadcast retransmission: a
+ * short minimum timeout gives aggressive early retries, and jitter
+ * desynchronises retransmissions from many clients booting
+ * simultaneously.
+ */
+const struct retry_profile retry_profile_lan = {
+	.min = ( TICKS_PER_SEC / 20 ),
+	.max = ( 8 * TICKS_PER_SEC ),
+	.backoff = 1,
+	.jitter = ( ( TICKS_PER_SEC / 16 ) - 1 ),
+};
+
+/**
+ * Get profile for timer
+ *
+ * @v timer		Retry timer
+ * @ret profile		Retry timer profile
+ */
+static const struct retry_profile *
+timer_profile ( struct retry_timer *timer ) {
+
+	return ( timer->profile ? timer->profile : &retry_profile_default );
+}
+
+/** Log2 of the number of buckets in each timing wheel
+ *
+ * This is a policy decision.  64 buckets at the chosen granularities
+ * cover half a second in the short-term wheel and half a minute in
+ * the long-term wheel, which comfortably spans the default timeout
+ * range.
+ */
+#define TIMER_WHEEL_ORDER 6
+
+/** Number of buckets in each timing wheel */
+#define TIMER_WHEEL_BUCKETS ( 1 << TIMER_WHEEL_ORDER )
+
+/** Log2 of the number of ticks per short-term wheel bucket */
+#define TIMER_WHEEL_SHIFT 3
+
+/** Log2 of the number of ticks per long-term wheel bucket */
+#define TIMER_WHEEL_LONG_SHIFT ( TIMER_WHEEL_SHIFT + TIMER_WHEEL_ORDER )
+
+/** Number of ticks covered by the short-term wheel */
+#define TIMER_WHEEL_SPAN ( 1UL << TIMER_WHEEL_LONG_SHIFT )
+
+/** Number of ticks covered by the long-term wheel */
+#define TIMER_WHEEL_LONG_SPAN ( TIMER_WHEEL_SPAN << TIMER_WHEEL_ORDER )
+
+/** Short-term timing wheel */
+static struct list_head short_wheel[TIMER_WHEEL_BUCKETS];
+
+/** Long-term timing wheel */
+static struct list_head long_wheel[TIMER_WHEEL_BUCKETS];
+
+/** Timers expiring beyond the span of the long-term wheel */
+static LIST_HEAD ( distant_timers );
+
+/** Time up to which the timing wheels have been advanced */
+static unsigned long wheel_time;
+
+/** Timing wheels have been initialised */
+static int wheel_initialised;
+
+/**
+ * Initialise the timing wheels
+ *
+ */
+static void timer_wheel_init ( void ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < TIMER_WHEEL_BUCKETS ; i++ ) {
+		INIT_LIST_HEAD ( &short_wheel[i] );
+		INIT_LIST_HEAD ( &long_wheel[i] );
+	}
+	wheel_time = currticks();
+	wheel_initialised = 1;
+}
+
+/**
+ * Insert timer into appropriate timing wheel bucket
+ *
+ * @v timer		Retry timer
+ *
+ * Buckets are indexed by absolute expiry time, so a timer is
+ * guaranteed to be in the bucket being swept when its expiry time
+ * arrives.  Timers expiring beyond the span of the long-term wheel
+ * are held on an overflow list and migrated into the wheels as their
+ * expiry time approaches.
+ */
+static void timer_insert ( struct retry_timer *timer ) {
+	unsigned long expires = ( timer->start + timer->timeout );
+	unsigned long remaining = ( expires - wheel_time );
+	struct list_head *bucket;
+
+	/* Treat already-expired timers as expiring immediately */
+	if ( ( ( signed long ) remaining ) < 0 ) {
+		expires = wheel_time;
+		remaining = 0;
+	}
+
+	/* Select bucket according to time remaining */
+	if ( remaining < TIMER_WHEEL_SPAN ) {
+		bucket = &short_wheel[ ( expires >> TIMER_WHEEL_SHIFT ) &
+				       ( TIMER_WHEEL_BUCKETS - 1 ) ];
+	} else if ( remaining < TIMER_WHEEL_LONG_SPAN ) {
+		bucket = &long_wheel[ ( expires >> TIMER_WHEEL_LONG_SHIFT ) &
+				      ( TIMER_WHEEL_BUCKETS - 1 ) ];
+	} else {
+		bucket = &distant_timers;
+	}
+	list_add ( &timer->list, bucket );
+}
+
+/**
+ * Cascade timers into finer-grained timing wheel buckets
+ *
+ * Called whenever the wheels advance into a new long-term bucket.
+ * Timers in that bucket, and any distant timers that now fall within
+ * the span of the long-term wheel, are re-inserted into the
+ * appropriate buckets.
+ */
+static void timer_cascade ( void ) {
+	struct retry_timer *timer;
+	struct retry_timer *tmp;
+	struct list_head *bucket;
+	struct list_head list;
+
+	/* Gather up timers to be re-inserted */
+	INIT_LIST_HEAD ( &list );
+	bucket = &long_wheel[ ( wheel_time >> TIMER_WHEEL_LONG_SHIFT ) &
+			      ( TIMER_WHEEL_BUCKETS - 1 ) ];
+	list_splice_init ( bucket, &list );
+	list_splice_init ( &distant_timers, &list );
+
+	/* Re-insert each timer */
+	list_for_each_entry_safe ( timer, tmp, &list, list ) {
+		list_del ( &timer->list );
+		timer_insert ( timer );
+	}
+}
 
 /**
  * Start timer with a specified timeout
@@ -63,9 +221,16 @@ static LIST_HEAD ( timers );
  */
 void start_timer_fixed ( struct retry_timer *timer, unsigned long timeout ) {
 
-	/* Add to list of running timers (if applicable) */
-	if ( ! timer->running ) {
-		list_add ( &timer->list, &timers );
+	/* Initialise timing wheels, if applicable */
+	if ( ! wheel_initialised )
+		timer_wheel_init();
+
+	/* Remove from current bucket (if already running), or mark as
+	 * running (if not).
+	 */
+	if ( timer->running ) {
+		list_del ( &timer->list );
+	} else {
 		ref_get ( timer->refcnt );
 		timer->running = 1;
 	}
@@ -76,6 +241,9 @@ void start_timer_fixed ( struct retry_timer *timer, unsigned long timeout ) {
 	/* Record timeout */
 	timer->timeout = timeout;
 
+	/* Add to bucket corresponding to expiry time */
+	timer_insert ( timer );
+
 	DBGC2 ( timer, "Timer %p started at time %ld (expires at %ld)\n",
 		timer, timer->start, ( timer->start + timer->timeout ) );
 }
@@ -91,11 +259,15 @@ void start_timer_fixed ( struct retry_timer *timer, unsigned long timeout ) {
  * timer's callback function will be called.
  */
 void start_timer ( struct retry_timer *timer ) {
+	const struct retry_profile *profile = timer_profile ( timer );
 	unsigned long timeout = timer->timeout;
 	unsigned long min;
 
-	/* Calculate minimum timeout */
-	min = ( timer->min ? timer->min : DEFAULT_MIN_TIMEOUT );
+	/* Calculate minimum timeout.  Limits set via
+	 * set_timer_limits() take precedence over the profile.
+	 */
+	min = ( timer->min ? timer->min :
+		( profile->min ? profile->min : DEFAULT_MIN_TIMEOUT ) );
 	if ( min < MIN_TIMEOUT )
 		min = MIN_TIMEOUT;
 
@@ -103,6 +275,10 @@ void start_timer ( struct retry_timer *timer ) {
 	if ( timeout < min )
 		timeout = min;
 
+	/* Add random jitter, if applicable */
+	if ( profile->jitter )
+		timeout += ( random() & profile->jitter );
+
 	/* Start timer with this timeout */
 	start_timer_fixed ( timer, timeout );
 }
@@ -164,10 +340,17 @@ void stop_timer ( struct retry_timer *timer ) {
  * @v timer		Retry timer
  */
 static void timer_expired ( struct retry_timer *timer ) {
+	const struct retry_profile *profile = timer_profile ( timer );
 	struct refcnt *refcnt = timer->refcnt;
-	unsigned long max = ( timer->max ? timer->max : DEFAULT_MAX_TIMEOUT );
+	unsigned long max;
 	int fail;
 
+	/* Calculate maximum timeout.  Limits set via
+	 * set_timer_limits() take precedence over the profile.
+	 */
+	max = ( timer->max ? timer->max :
+		( profile->max ? profile->max : DEFAULT_MAX_TIMEOUT ) );
+
 	/* Stop timer without performing RTT calculations */
 	DBGC2 ( timer, "Timer %p stopped at time %ld on expiry\n",
 		timer, currticks() );
@@ -177,7 +360,7 @@ static void timer_expired ( struct retry_timer *timer ) {
 	timer->count++;
 
 	/* Back off the timeout value */
-	timer->timeout <<= 1;
+	timer->timeout <<= profile->backoff;
 	if ( ( fail = ( timer->timeout > max ) ) )
 		timer->timeout = max;
 	DBGC ( timer, "Timer %p timeout backed off to %ld\n",
@@ -196,20 +379,45 @@ static void timer_expired ( struct retry_timer *timer ) {
  */
 void retry_poll ( void ) {
 	struct retry_timer *timer;
+	struct list_head *bucket;
 	unsigned long now = currticks();
-	unsigned long used;
+	unsigned long next;
 
-	/* Process at most one timer expiry.  We cannot process
-	 * multiple expiries in one pass, because one timer expiring
-	 * may end up triggering another timer's deletion from the
-	 * list.
+	/* Initialise timing wheels, if applicable */
+	if ( ! wheel_initialised )
+		timer_wheel_init();
+
+	/* Advance the wheels up to the current time, processing at
+	 * most one timer expiry.  We cannot process multiple expiries
+	 * in one pass, because one timer expiring may end up
+	 * triggering another timer's deletion from its bucket.
 	 */
-	list_for_each_entry ( timer, &timers, list ) {
-		used = ( now - timer->start );
-		if ( used >= timer->timeout ) {
-			timer_expired ( timer );
-			break;
+	while ( 1 ) {
+
+		/* Scan current short-term bucket for an expired timer */
+		bucket = &short_wheel[ ( wheel_time >> TIMER_WHEEL_SHIFT ) &
+				       ( TIMER_WHEEL_BUCKETS - 1 ) ];
+		list_for_each_entry ( timer, bucket, list ) {
+			if ( ( now - timer->start ) >= timer->timeout ) {
+				timer_expired ( timer );
+				return;
+			}
 		}
+
+		/* Stop advancing once the current bucket covers the
+		 * current time.
+		 */
+		next = ( ( wheel_time | ( ( 1UL << TIMER_WHEEL_SHIFT ) - 1 ) )
+			 + 1 );
+		if ( ( ( signed long ) ( now - next ) ) < 0 )
+			break;
+		wheel_time = next;
+
+		/* Cascade timers into finer-grained buckets whenever
+		 * we advance into a new long-term bucket.
+		 */
+		if ( ( wheel_time & ( TIMER_WHEEL_SPAN - 1 ) ) == 0 )
+			timer_cascade();
 	}
 }
 
@@ -222,5 +430,9 @@ static void retry_step ( struct process *process __unused ) {
 	retry_poll();
 }
 
-/** Retry timer process */
-PERMANENT_PROCESS ( retry_process, retry_step );
+/** Retry timer process
+ *
+ * Runs at timer priority, so that retransmission timers expire
+ * promptly even under bulk load.
+ */
+PERMANENT_PROCESS_PRIO ( retry_process, retry_step, PROC_PRIO_TIMER );
@@ -71,6 +71,33 @@ struct tcp_connection {
 	 * Equivalent to SND.WND in RFC 793 terminology
 	 */
 	uint32_t snd_win;
+	/** Duplicate ACK count
+	 *
+	 * Number of consecutive received ACKs that acknowledged no
+	 * new data while data remained in flight.  Used to trigger
+	 * fast retransmission.
+	 */
+	unsigned int dup_acks;
+	/** Delayed acknowledgement count
+	 *
+	 * Number of received in-order data segments for which the
+	 * acknowledgement has been deferred.
+	 */
+	unsigned int delayed;
+	/** Congestion window
+	 *
+	 * Equivalent to cwnd in RFC 5681 terminology.  Limits the
+	 * amount of data that we may have in flight, independently of
+	 * the peer's receive window.
+	 */
+	uint32_t snd_cwnd;
+	/** Slow start threshold
+	 *
+	 * Equivalent to ssthresh in RFC 5681 terminology.  The
+	 * congestion window grows exponentially while below this
+	 * threshold and linearly above it.
+	 */
+	uint32_t snd_ssthresh;
 	/** Current acknowledgement number
 	 *
 	 * Equivalent to RCV.NXT in RFC 793 terminology.
@@ -114,11 +141,36 @@ struct tcp_connection {
 	struct process process;
 	/** Retransmission timer */
 	struct retry_timer timer;
+	/** Delayed acknowledgement timer */
+	struct retry_timer delack;
 	/** Keepalive timer */
 	struct retry_timer keepalive;
 	/** Shutdown (TIME_WAIT) timer */
 	struct retry_timer wait;
 
+	/** Number of retransmissions */
+	unsigned int retransmits;
+	/** Number of transmit window stalls */
+	unsigned int stalls;
+	/** Smoothed round-trip time (in ticks, scaled by 8)
+	 *
+	 * Maintained as per RFC 6298, using the scaled-integer
+	 * representation to avoid losing precision on short paths.
+	 */
+	uint32_t srtt;
+	/** Round-trip time variance (in ticks, scaled by 4) */
+	uint32_t rttvar;
+	/** Number of round-trip time samples taken */
+	unsigned int rtt_count;
+	/** Time at which current transmit window stall began */
+	unsigned long stall_start;
+	/** Total time stalled on a zero transmit window (in ticks) */
+	unsigned long zero_win_time;
+	/** Time at which the data-transfer interface began blocking */
+	unsigned long xfer_block_start;
+	/** Total time blocked by the data-transfer interface (in ticks) */
+	unsigned long xfer_block_time;
+
 	/** Pending operations for SYN and FIN */
 	struct pending_operation pending_flags;
 	/** Pending operations for transmit queue */
@@ -135,6 +187,14 @@ enum tcp_flags {
 	TCP_ACK_PENDING = 0x0004,
 	/** TCP selective acknowledgement is enabled */
 	TCP_SACK_ENABLED = 0x0008,
+	/** TCP segmentation offload is enabled */
+	TCP_TSO_ENABLED = 0x0010,
+	/** TCP transmit checksum offload is enabled */
+	TCP_CSUM_OFFLOAD = 0x0020,
+	/** TCP transmission is stalled on a closed window */
+	TCP_STALLED = 0x0040,
+	/** TCP reception is blocked by the data-transfer interface */
+	TCP_XFER_BLOCKED = 0x0080,
 };
 
 /** TCP internal header
@@ -176,10 +236,116 @@ static struct profiler tcp_rx_profiler __profiler = { .name = "tcp.rx" };
 /** Data transfer profiler */
 static struct profiler tcp_xfer_profiler __profiler = { .name = "tcp.xfer" };
 
+/** Number of one-second TCP rate history windows */
+#define TCP_RATE_WINDOWS 8
+
+/** A TCP rate history window */
+struct tcp_rate_window {
+	/** Number of retransmissions within this window */
+	unsigned int retransmits;
+	/** Number of transmit window stalls within this window */
+	unsigned int stalls;
+};
+
+/** TCP rate history windows (across all connections) */
+static struct tcp_rate_window tcp_rate_windows[TCP_RATE_WINDOWS];
+
+/** Most recently sampled TCP rate history window */
+static unsigned int tcp_rate_index;
+
+/** Total number of retransmissions (across all connections) */
+static unsigned int tcp_retransmits;
+
+/** Total number of transmit window stalls (across all connections) */
+static unsigned int tcp_stalls;
+
+/** Total number of retransmissions as of the previous sample */
+static unsigned int tcp_retransmits_sampled;
+
+/** Total number of transmit window stalls as of the previous sample */
+static unsigned int tcp_stalls_sampled;
+
+/**
+ * Sample TCP transmission rate counters
+ *
+ * Called once per second (by the network device rate history sampling
+ * timer) to record deltas in the whole-stack retransmission and stall
+ * counters into the rate history windows.
+ */
+void tcp_rate_sample ( void ) {
+	struct tcp_rate_window *window;
+
+	tcp_rate_index = ( ( tcp_rate_index + 1 ) % TCP_RATE_WINDOWS );
+	window = &tcp_rate_windows[tcp_rate_index];
+	window->retransmits = ( tcp_retransmits - tcp_retransmits_sampled );
+	window->stalls = ( tcp_stalls - tcp_stalls_sampled );
+	tcp_retransmits_sampled = tcp_retransmits;
+	tcp_stalls_sampled = tcp_stalls;
+}
+
+/**
+ * Get TCP rate history window
+ *
+ * @v age		Window age in seconds (0 = most recent)
+ * @v retransmits	Number of retransmissions to fill in
+ * @v stalls		Number of transmit window stalls to fill in
+ * @ret rc		Return status code
+ */
+int tcp_rate_window ( unsigned int age, unsigned int *retransmits,
+		      unsigned int *stalls ) {
+	struct tcp_rate_window *window;
+
+	if ( age >= TCP_RATE_WINDOWS )
+		return -ERANGE;
+	window = &tcp_rate_windows[ ( tcp_rate_index + TCP_RATE_WINDOWS -
+				      age ) % TCP_RATE_WINDOWS ];
+	*retransmits = window->retransmits;
+	*stalls = window->stalls;
+	return 0;
+}
+
+/**
+ * Get per-connection TCP statistics snapshot
+ *
+ * @v index		Connection index
+ * @v stats		Statistics snapshot to fill in
+ * @ret rc		Return status code
+ */
+int tcp_stats ( unsigned int index, struct tcp_stats *stats ) {
+	struct tcp_connection *tcp;
+	unsigned long now = currticks();
+
+	list_for_each_entry ( tcp, &tcp_conns, list ) {
+		if ( index-- )
+			continue;
+		memset ( stats, 0, sizeof ( *stats ) );
+		stats->local_port = tcp->local_port;
+		stats->srtt = ( tcp->srtt >> 3 );
+		stats->rttvar = ( tcp->rttvar >> 2 );
+		stats->rtt_count = tcp->rtt_count;
+		stats->in_flight = tcp->snd_sent;
+		stats->snd_win = tcp->snd_win;
+		stats->snd_cwnd = tcp->snd_cwnd;
+		stats->retransmits = tcp->retransmits;
+		stats->stalls = tcp->stalls;
+		stats->zero_win_time = tcp->zero_win_time;
+		if ( tcp->flags & TCP_STALLED )
+			stats->zero_win_time += ( now - tcp->stall_start );
+		stats->xfer_block_time = tcp->xfer_block_time;
+		if ( tcp->flags & TCP_XFER_BLOCKED ) {
+			stats->xfer_block_time +=
+				( now - tcp->xfer_block_start );
+		}
+		return 0;
+	}
+	return -ENOENT;
+}
+
 /* Forward declarations */
 static struct process_descriptor tcp_process_desc;
 static struct interface_descriptor tcp_xfer_desc;
 static void tcp_expired ( struct retry_timer *timer, int over );
+static void tcp_delack_expired ( struct retry_timer *timer, int over );
 static void tcp_keepalive_expired ( struct retry_timer *timer, int over );
 static void tcp_wait_expired ( struct retry_timer *timer, int over );
 static struct tcp_connection * tcp_demux ( unsigned int local_port );
@@ -275,6 +441,7 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	struct sockaddr_tcpip *st_peer = ( struct sockaddr_tcpip * ) peer;
 	struct sockaddr_tcpip *st_local = ( struct sockaddr_tcpip * ) local;
 	struct tcp_connection *tcp;
+	struct net_device *netdev;
 	size_t mtu;
 	int port;
 	int rc;
@@ -288,6 +455,7 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	intf_init ( &tcp->xfer, &tcp_xfer_desc, &tcp->refcnt );
 	process_init_stopped ( &tcp->process, &tcp_process_desc, &tcp->refcnt );
 	timer_init ( &tcp->timer, tcp_expired, &tcp->refcnt );
+	timer_init ( &tcp->delack, tcp_delack_expired, &tcp->refcnt );
 	timer_init ( &tcp->keepalive, tcp_keepalive_expired, &tcp->refcnt );
 	timer_init ( &tcp->wait, tcp_wait_expired, &tcp->refcnt );
 	tcp->prev_tcp_state = TCP_CLOSED;
@@ -308,6 +476,30 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 	}
 	tcp->mss = ( mtu - sizeof ( struct tcp_header ) );
 
+	/* Initialise congestion state: start in slow start with a
+	 * conservative initial window, as per RFC 3390.
+	 */
+	tcp->snd_cwnd = ( TCP_INIT_CWND * tcp->mss );
+	tcp->snd_ssthresh = TCP_MAX_WINDOW_SIZE;
+
+	/* Use segmentation and checksum offloads, if supported by the
+	 * network device.  Restricted to IPv4 peers, since offloaded
+	 * segments are described to the device as TCPv4.
+	 */
+	netdev = tcpip_netdev ( &tcp->peer );
+	if ( netdev && ( tcp->peer.st_family == AF_INET ) ) {
+		if ( netdev->features & NETDEV_FEAT_TX_TSO ) {
+			tcp->flags |= TCP_TSO_ENABLED;
+			DBGC ( tcp, "TCP %p using TSO via %s\n",
+			       tcp, netdev->name );
+		}
+		if ( netdev->features & NETDEV_FEAT_TX_CSUM ) {
+			tcp->flags |= TCP_CSUM_OFFLOAD;
+			DBGC ( tcp, "TCP %p using TX checksum offload via "
+			       "%s\n", tcp, netdev->name );
+		}
+	}
+
 	/* Bind to local port */
 	port = tcpip_bind ( st_local, tcp_port_available );
 	if ( port < 0 ) {
@@ -385,6 +577,7 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
 		/* Remove from list and drop reference */
 		process_del ( &tcp->process );
 		stop_timer ( &tcp->timer );
+		stop_timer ( &tcp->delack );
 		stop_timer ( &tcp->keepalive );
 		stop_timer ( &tcp->wait );
 		list_del ( &tcp->list );
@@ -431,15 +624,24 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
  */
 static size_t tcp_xmit_win ( struct tcp_connection *tcp ) {
 	size_t len;
+	size_t max;
 
 	/* Not ready if we're not in a suitable connection state */
 	if ( ! TCP_CAN_SEND_DATA ( tcp->tcp_state ) )
 		return 0;
 
-	/* Length is the minimum of the receiver's window and the path MTU */
+	/* Length is the minimum of the receiver's window, our
+	 * congestion window, and the path MTU (or the maximum
+	 * offloadable segment length, if the network device can
+	 * perform segmentation for us).
+	 */
 	len = tcp->snd_win;
-	if ( len > TCP_PATH_MTU )
-		len = TCP_PATH_MTU;
+	if ( len > tcp->snd_cwnd )
+		len = tcp->snd_cwnd;
+	max = ( ( tcp->flags & TCP_TSO_ENABLED ) ?
+		TCP_TSO_MAX_LEN : TCP_PATH_MTU );
+	if ( len > max )
+		len = max;
 
 	return len;
 }
@@ -621,6 +823,7 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	unsigned int i;
 	size_t len = 0;
 	size_t sack_len;
+	size_t max_seg;
 	uint32_t seq_len;
 	uint32_t max_rcv_win;
 	uint32_t max_representable_win;
@@ -641,6 +844,25 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 					     NULL, 0 );
 	}
 	seq_len = len;
+
+	/* Record transitions into and out of the window-stalled state
+	 * (i.e. data queued for transmission but a transmit window of
+	 * zero).  The congestion window never closes completely, so
+	 * time spent in this state is attributable to the peer's
+	 * advertised receive window.
+	 */
+	if ( ( len == 0 ) && TCP_CAN_SEND_DATA ( tcp->tcp_state ) &&
+	     ( ! list_empty ( &tcp->tx_queue ) ) ) {
+		if ( ! ( tcp->flags & TCP_STALLED ) ) {
+			tcp->flags |= TCP_STALLED;
+			tcp->stalls++;
+			tcp_stalls++;
+			tcp->stall_start = currticks();
+		}
+	} else if ( tcp->flags & TCP_STALLED ) {
+		tcp->flags &= ~TCP_STALLED;
+		tcp->zero_win_time += ( currticks() - tcp->stall_start );
+	}
 	flags = TCP_FLAGS_SENDING ( tcp->tcp_state );
 	if ( flags & ( TCP_SYN | TCP_FIN ) ) {
 		/* SYN or FIN consume one byte, and we can never send both */
@@ -674,10 +896,36 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	/* Fill data payload from transmit queue */
 	tcp_process_tx_queue ( tcp, len, iobuf, 0 );
 
-	/* Expand receive window if possible */
+	/* Expand receive window if possible.  The advertised window
+	 * is budgeted against the amount of currently free memory,
+	 * since out-of-order data within the window may have to be
+	 * queued in heap-allocated I/O buffers.  We never retract an
+	 * already-advertised window (as per RFC 1122); under memory
+	 * pressure we simply cease to re-expand the window as received
+	 * data consumes it.
+	 */
 	max_rcv_win = xfer_window ( &tcp->xfer );
+
+	/* Record transitions into and out of the locally-blocked
+	 * state (i.e. the data-transfer interface refusing to accept
+	 * any received data, and hence preventing further expansion
+	 * of our advertised window).
+	 */
+	if ( max_rcv_win == 0 ) {
+		if ( ! ( tcp->flags & TCP_XFER_BLOCKED ) ) {
+			tcp->flags |= TCP_XFER_BLOCKED;
+			tcp->xfer_block_start = currticks();
+		}
+	} else if ( tcp->flags & TCP_XFER_BLOCKED ) {
+		tcp->flags &= ~TCP_XFER_BLOCKED;
+		tcp->xfer_block_time +=
+			( currticks() - tcp->xfer_block_start );
+	}
+
 	if ( max_rcv_win > TCP_MAX_WINDOW_SIZE )
 		max_rcv_win = TCP_MAX_WINDOW_SIZE;
+	if ( max_rcv_win > ( freemem / 2 ) )
+		max_rcv_win = ( freemem / 2 );
 	max_representable_win = ( 0xffff << tcp->rcv_win_scale );
 	if ( max_rcv_win > max_representable_win )
 		max_rcv_win = max_representable_win;
@@ -736,7 +984,22 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	tcphdr->hlen = ( ( payload - iobuf->data ) << 2 );
 	tcphdr->flags = flags;
 	tcphdr->win = htons ( tcp->rcv_win >> tcp->rcv_win_scale );
-	tcphdr->csum = tcpip_chksum ( iobuf->data, iob_len ( iobuf ) );
+	if ( tcp->flags & TCP_CSUM_OFFLOAD ) {
+		iobuf->flags |= IOB_FL_CSUM_PARTIAL;
+	} else {
+		tcphdr->csum = tcpip_chksum ( iobuf->data, iob_len ( iobuf ) );
+	}
+
+	/* Mark oversized segments for device-side segmentation,
+	 * allowing room within each emitted frame for the replicated
+	 * TCP header and options.
+	 */
+	max_seg = ( tcp->mss + sizeof ( *tcphdr ) -
+		    ( payload - iobuf->data ) );
+	if ( len > max_seg ) {
+		assert ( tcp->flags & TCP_TSO_ENABLED );
+		iobuf->gso_size = max_seg;
+	}
 
 	/* Dump header */
 	DBGC2 ( tcp, "TCP %p TX %d->%d %08x..%08x           %08x %4zd",
@@ -746,17 +1009,23 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	tcp_dump_flags ( tcp, tcphdr->flags );
 	DBGC2 ( tcp, "\n" );
 
-	/* Transmit packet */
+	/* Transmit packet.  When the transport checksum is generated
+	 * by the device, there is no partial checksum for the network
+	 * layer to fold the pseudo-header into.
+	 */
 	if ( ( rc = tcpip_tx ( iobuf, &tcp_protocol, NULL, &tcp->peer, NULL,
-			       &tcphdr->csum ) ) != 0 ) {
+			       ( ( tcp->flags & TCP_CSUM_OFFLOAD ) ?
+				 NULL : &tcphdr->csum ) ) ) != 0 ) {
 		DBGC ( tcp, "TCP %p could not transmit %08x..%08x %08x: %s\n",
 		       tcp, tcp->snd_seq, ( tcp->snd_seq + tcp->snd_sent ),
 		       tcp->rcv_ack, strerror ( rc ) );
 		return;
 	}
 
-	/* Clear ACK-pending flag */
+	/* Clear ACK-pending flag and any deferred acknowledgement */
 	tcp->flags &= ~TCP_ACK_PENDING;
+	tcp->delayed = 0;
+	stop_timer ( &tcp->delack );
 
 	profile_stop ( &tcp_tx_profiler );
 }
@@ -805,11 +1074,45 @@ static void tcp_expired ( struct retry_timer *timer, int over ) {
 		tcp_dump_state ( tcp );
 		tcp_close ( tcp, -ETIMEDOUT );
 	} else {
-		/* Otherwise, retransmit the packet */
+		/* A retransmission timeout is a strong congestion
+		 * signal: record half the outstanding data as the new
+		 * slow start threshold and collapse the congestion
+		 * window to a single segment, as per RFC 5681.  The
+		 * timer's exponential backoff provides the pacing of
+		 * the retransmissions themselves.
+		 */
+		tcp->snd_ssthresh = ( tcp->snd_sent / 2 );
+		if ( tcp->snd_ssthresh < ( TCP_MIN_SSTHRESH * tcp->mss ) )
+			tcp->snd_ssthresh = ( TCP_MIN_SSTHRESH * tcp->mss );
+		tcp->snd_cwnd = tcp->mss;
+
+		/* Record the retransmission */
+		tcp->retransmits++;
+		tcp_retransmits++;
+
+		/* Retransmit the packet */
 		tcp_xmit ( tcp );
 	}
 }
 
+/**
+ * Delayed acknowledgement timer expired
+ *
+ * @v timer		Delayed acknowledgement timer
+ * @v over		Failure indicator
+ */
+static void tcp_delack_expired ( struct retry_timer *timer,
+				 int over __unused ) {
+	struct tcp_connection *tcp =
+		container_of ( timer, struct tcp_connection, delack );
+
+	DBGC2 ( tcp, "TCP %p transmitting delayed ACK\n", tcp );
+
+	/* Transmit the deferred acknowledgement */
+	tcp->flags |= TCP_ACK_PENDING;
+	tcp_xmit ( tcp );
+}
+
 /**
  * Keepalive timer expired
  *
@@ -1150,8 +1453,52 @@ static int tcp_rx_ack ( struct tcp_connection *tcp, uint32_t ack,
 	 * duplicate ACK is received and we still have data in our
 	 * transmit queue.)
 	 */
-	if ( ack_len == 0 )
+	if ( ack_len == 0 ) {
+		/* Infer a lost segment from repeated duplicate ACKs,
+		 * and retransmit immediately rather than waiting for
+		 * the retransmission timer to expire, as per RFC
+		 * 5681.  Since we keep at most one unacknowledged
+		 * segment in flight, retransmitting from SND.UNA
+		 * retransmits exactly the missing segment.
+		 */
+		if ( tcp->snd_sent &&
+		     ( ++tcp->dup_acks >= TCP_FAST_RETRANS_DUP_ACKS ) ) {
+			DBGC ( tcp, "TCP %p fast retransmitting %08x..%08x "
+			       "after %d duplicate ACKs\n", tcp, tcp->snd_seq,
+			       ( tcp->snd_seq + tcp->snd_sent ),
+			       tcp->dup_acks );
+			tcp->dup_acks = 0;
+			/* Halve the congestion window (multiplicative
+			 * decrease), as per RFC 5681.
+			 */
+			tcp->snd_ssthresh = ( tcp->snd_sent / 2 );
+			if ( tcp->snd_ssthresh <
+			     ( TCP_MIN_SSTHRESH * tcp->mss ) ) {
+				tcp->snd_ssthresh =
+					( TCP_MIN_SSTHRESH * tcp->mss );
+			}
+			tcp->snd_cwnd = tcp->snd_ssthresh;
+			stop_timer ( &tcp->timer );
+			tcp_xmit ( tcp );
+		}
 		return 0;
+	}
+
+	/* Reset duplicate ACK count */
+	tcp->dup_acks = 0;
+
+	/* Grow the congestion window: exponentially while in slow
+	 * start, linearly (roughly one segment per round trip) once
+	 * above the slow start threshold, as per RFC 5681.
+	 */
+	if ( tcp->snd_cwnd < tcp->snd_ssthresh ) {
+		tcp->snd_cwnd += ( ( ack_len < tcp->mss ) ?
+				   ack_len : tcp->mss );
+	} else {
+		tcp->snd_cwnd += ( ( tcp->mss * tcp->mss ) / tcp->snd_cwnd );
+	}
+	if ( tcp->snd_cwnd > TCP_MAX_WINDOW_SIZE )
+		tcp->snd_cwnd = TCP_MAX_WINDOW_SIZE;
 
 	/* Stop the retransmission timer */
 	stop_timer ( &tcp->timer );
@@ -1323,19 +1670,50 @@ static void tcp_rx_enqueue ( struct tcp_connection *tcp, uint32_t seq,
 		return;
 	}
 
+	/* Find the insertion point, scanning backwards from the tail
+	 * since segments most commonly arrive in ascending sequence
+	 * order; this keeps the insertion cost flat as the receive
+	 * window (and hence the potential queue length) grows.
+	 */
+	list_for_each_entry_reverse ( queued, &tcp->rx_queue, list ) {
+		tcpqhdr = queued->data;
+		if ( tcp_cmp ( seq, tcpqhdr->seq ) >= 0 ) {
+			/* Discard the packet immediately if it is
+			 * wholly contained within an already-queued
+			 * segment.
+			 */
+			if ( tcp_cmp ( nxt, tcpqhdr->nxt ) <= 0 ) {
+				free_iob ( iobuf );
+				return;
+			}
+			break;
+		}
+	}
+
 	/* Add internal header */
 	tcpqhdr = iob_push ( iobuf, sizeof ( *tcpqhdr ) );
 	tcpqhdr->seq = seq;
 	tcpqhdr->nxt = nxt;
 	tcpqhdr->flags = flags;
 
-	/* Add to RX queue */
-	list_for_each_entry ( queued, &tcp->rx_queue, list ) {
+	/* Add to RX queue.  If the backwards scan found no earlier
+	 * segment then @c queued will be the list head itself, and
+	 * the packet is correctly inserted at the front.
+	 */
+	list_add ( &iobuf->list, &queued->list );
+
+	/* Discard any subsequent queued segments that are wholly
+	 * contained within this packet, to keep the queue short
+	 * under heavy reordering or retransmission.
+	 */
+	while ( ( queued = list_next_entry ( iobuf, &tcp->rx_queue,
+					     list ) ) != NULL ) {
 		tcpqhdr = queued->data;
-		if ( tcp_cmp ( seq, tcpqhdr->seq ) < 0 )
+		if ( tcp_cmp ( tcpqhdr->nxt, nxt ) > 0 )
 			break;
+		list_del ( &queued->list );
+		free_iob ( queued );
 	}
-	list_add_tail ( &iobuf->list, &queued->list );
 }
 
 /**
@@ -1382,6 +1760,40 @@ static void tcp_process_rx_queue ( struct tcp_connection *tcp ) {
 	}
 }
 
+/**
+ * Record round-trip time sample
+ *
+ * @v tcp		TCP connection
+ * @v rtt		Round-trip time sample (in ticks)
+ *
+ * Smoothing is as per RFC 6298, maintaining SRTT scaled by 8 and
+ * RTTVAR scaled by 4 to avoid losing precision on short paths.
+ */
+static void tcp_rtt_sample ( struct tcp_connection *tcp, int32_t rtt ) {
+	int32_t err;
+
+	/* Discard implausible samples (e.g. from a peer echoing a
+	 * timestamp that we never sent).
+	 */
+	if ( ( rtt < 0 ) || ( rtt > ( int32_t ) ( 60 * TICKS_PER_SEC ) ) )
+		return;
+
+	if ( tcp->rtt_count == 0 ) {
+		/* First sample initialises the estimators directly */
+		tcp->srtt = ( rtt << 3 );
+		tcp->rttvar = ( rtt << 1 );
+	} else {
+		/* SRTT <- 7/8 SRTT + 1/8 RTT (scaled by 8) */
+		err = ( rtt - ( tcp->srtt >> 3 ) );
+		tcp->srtt += err;
+		/* RTTVAR <- 3/4 RTTVAR + 1/4 |SRTT - RTT| (scaled by 4) */
+		if ( err < 0 )
+			err = -err;
+		tcp->rttvar += ( err - ( tcp->rttvar >> 2 ) );
+	}
+	tcp->rtt_count++;
+}
+
 /**
  * Process received packet
  *
@@ -1406,6 +1818,7 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	uint32_t ack;
 	uint16_t raw_win;
 	uint32_t win;
+	uint32_t old_snd_seq;
 	unsigned int flags;
 	size_t len;
 	uint32_t seq_len;
@@ -1435,13 +1848,15 @@ static int tcp_rx ( struct io_buffer *iobuf,
 		rc = -EINVAL;
 		goto discard;
 	}
-	csum = tcpip_continue_chksum ( pshdr_csum, iobuf->data,
-				       iob_len ( iobuf ) );
-	if ( csum != 0 ) {
-		DBG ( "TCP checksum incorrect (is %04x including checksum "
-		      "field, should be 0000)\n", csum );
-		rc = -EINVAL;
-		goto discard;
+	if ( ! ( iobuf->flags & IOB_FL_CSUM_OK ) ) {
+		csum = tcpip_continue_chksum ( pshdr_csum, iobuf->data,
+					       iob_len ( iobuf ) );
+		if ( csum != 0 ) {
+			DBG ( "TCP checksum incorrect (is %04x including "
+			      "checksum field, should be 0000)\n", csum );
+			rc = -EINVAL;
+			goto discard;
+		}
 	}
 	
 	/* Parse parameters from header and strip header */
@@ -1478,11 +1893,26 @@ static int tcp_rx ( struct io_buffer *iobuf,
 
 	/* Handle ACK, if present */
 	if ( flags & TCP_ACK ) {
+		old_snd_seq = tcp->snd_seq;
 		win = ( raw_win << tcp->snd_win_scale );
 		if ( ( rc = tcp_rx_ack ( tcp, ack, win ) ) != 0 ) {
 			tcp_xmit_reset ( tcp, st_src, tcphdr );
 			goto discard;
 		}
+
+		/* Sample round-trip time when new data is
+		 * acknowledged with an echoed timestamp.  Our
+		 * transmitted timestamp values are raw currticks()
+		 * values, so the echo yields the round-trip time
+		 * directly, and an echo from a retransmitted segment
+		 * identifies the transmission that actually elicited
+		 * the acknowledgement.
+		 */
+		if ( options.tsopt && ( tcp->snd_seq != old_snd_seq ) ) {
+			tcp_rtt_sample ( tcp, ( ( ( int32_t ) currticks() ) -
+						( ( int32_t ) ntohl (
+						    options.tsopt->tsecr ) ) ));
+		}
 	}
 
 	/* Force an ACK if this packet is out of order */
@@ -1515,12 +1945,23 @@ static int tcp_rx ( struct io_buffer *iobuf,
 	/* Schedule transmission of ACK (and any pending data).  If we
 	 * have received any out-of-order packets (i.e. if the receive
 	 * queue remains non-empty after processing) then send the ACK
-	 * immediately in order to trigger Fast Retransmission.
+	 * immediately in order to trigger Fast Retransmission.  A
+	 * pure ACK for a lone in-order data segment (without PSH) is
+	 * instead deferred briefly, so that bulk transfers generate
+	 * at most one ACK per two received segments, as per RFC 1122.
 	 */
-	if ( list_empty ( &tcp->rx_queue ) ) {
-		process_add ( &tcp->process );
-	} else {
+	if ( ! list_empty ( &tcp->rx_queue ) ) {
 		tcp_xmit_sack ( tcp, seq );
+	} else if ( len && ( ! tcp->delayed ) &&
+		    ( tcp->rcv_ack == ( seq + len ) ) &&
+		    ( tcp->tcp_state == TCP_ESTABLISHED ) &&
+		    ( ! ( flags & ( TCP_PSH | TCP_FIN ) ) ) &&
+		    list_empty ( &tcp->tx_queue ) ) {
+		tcp->delayed++;
+		tcp->flags &= ~TCP_ACK_PENDING;
+		start_timer_fixed ( &tcp->delack, TCP_DELACK_DELAY );
+	} else {
+		process_add ( &tcp->process );
 	}
 
 	/* If this packet was the last we expect to receive, set up
@@ -1692,6 +2133,7 @@ static void tcp_xfer_close ( struct tcp_connection *tcp, int rc ) {
 static int tcp_xfer_deliver ( struct tcp_connection *tcp,
 			      struct io_buffer *iobuf,
 			      struct xfer_metadata *meta __unused ) {
+	struct io_buffer *frag;
 
 	/* Enqueue packet */
 	list_add_tail ( &iobuf->list, &tcp->tx_queue );
@@ -1699,6 +2141,15 @@ static int tcp_xfer_deliver ( struct tcp_connection *tcp,
 	/* Each enqueued packet is a pending operation */
 	pending_get ( &tcp->pending_data );
 
+	/* Unchain any fragments into individual transmit queue
+	 * entries, so that chained buffers can be delivered without
+	 * first being flattened into a single contiguous buffer.
+	 */
+	while ( ( frag = iob_unchain ( iobuf ) ) != NULL ) {
+		list_add_tail ( &frag->list, &tcp->tx_queue );
+		pending_get ( &tcp->pending_data );
+	}
+
 	/* Transmit data, if possible */
 	tcp_xmit ( tcp );
 
@@ -31,15 +31,277 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
 #include <ipxe/uaccess.h>
 #include <ipxe/blocktrans.h>
 #include <ipxe/blockdev.h>
 #include <ipxe/acpi.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/process.h>
+#include <ipxe/uri.h>
 #include <ipxe/http.h>
 
 /** Block size used for HTTP block device requests */
 #define HTTP_BLKSIZE 512
 
+/** Length of each readahead request
+ *
+ * Chainloaded bootloaders read sectors one at a time, and issuing
+ * one Range request per sector makes every read cost a full round
+ * trip.  When a sequential read pattern is detected, the next range
+ * is fetched ahead of time over a further pooled connection, so
+ * subsequent reads are served from memory.
+ */
+#define HTTP_BLOCK_READAHEAD_LEN ( 64 * 1024 )
+
+/** Fragment length used when replaying cached data */
+#define HTTP_BLOCK_REPLAY_FRAG_LEN 4096
+
+/** An HTTP block device readahead cache */
+struct http_block_readahead {
+	/** Data transfer interface to HTTP transaction */
+	struct interface xfer;
+	/** Request URI of cached data */
+	struct uri *uri;
+	/** Starting offset of cached range */
+	size_t start;
+	/** Requested length */
+	size_t len;
+	/** Data transfer buffer holding received data */
+	struct xfer_buffer xferbuf;
+	/** Readahead request is in progress */
+	int busy;
+	/** Cached data is usable */
+	int valid;
+};
+
+/** End of most recent block read, used to detect sequential reads */
+static size_t http_block_last_end;
+
+/**
+ * Handle received readahead data
+ *
+ * @v readahead		Readahead cache
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_block_readahead_deliver ( struct http_block_readahead
+						  *readahead,
+					  struct io_buffer *iobuf,
+					  struct xfer_metadata *meta ) {
+
+	return xferbuf_deliver ( &readahead->xferbuf, iob_disown ( iobuf ),
+				 meta );
+}
+
+/**
+ * Handle completed readahead request
+ *
+ * @v readahead		Readahead cache
+ * @v rc		Reason for completion
+ */
+static void http_block_readahead_close ( struct http_block_readahead
+						 *readahead, int rc ) {
+
+	/* Detach from the completed transaction */
+	intf_restart ( &readahead->xfer, rc );
+	readahead->busy = 0;
+
+	/* Mark cached data as usable, or discard it on error.  A
+	 * short read (at the end of the file) is still usable.
+	 */
+	if ( ( rc == 0 ) && readahead->xferbuf.len ) {
+		readahead->valid = 1;
+		DBGC2 ( readahead, "HTTPBLOCK readahead cached %#zx+%#zx\n",
+			readahead->start, readahead->xferbuf.len );
+	} else {
+		xferbuf_free ( &readahead->xferbuf );
+		DBGC ( readahead, "HTTPBLOCK readahead of %#zx failed: %s\n",
+		       readahead->start, strerror ( rc ) );
+	}
+}
+
+/** Readahead cache interface operations */
+static struct interface_operation http_block_readahead_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_block_readahead *,
+		  http_block_readahead_deliver ),
+	INTF_OP ( intf_close, struct http_block_readahead *,
+		  http_block_readahead_close ),
+};
+
+/** Readahead cache interface descriptor */
+static struct interface_descriptor http_block_readahead_desc =
+	INTF_DESC ( struct http_block_readahead, xfer,
+		    http_block_readahead_operations );
+
+/** The readahead cache */
+static struct http_block_readahead http_block_readahead = {
+	.xfer = INTF_INIT ( http_block_readahead_desc ),
+	.xferbuf = { .op = &xferbuf_malloc_operations },
+};
+
+/**
+ * Start fetching a range into the readahead cache
+ *
+ * @v http		HTTP transaction
+ * @v start		Starting offset
+ */
+static void http_block_readahead_start ( struct http_transaction *http,
+					 size_t start ) {
+	struct http_block_readahead *readahead = &http_block_readahead;
+	struct http_request_range range;
+	int rc;
+
+	/* Do nothing if a readahead is already in progress, or if the
+	 * requested range is already cached.
+	 */
+	if ( readahead->busy )
+		return;
+	if ( readahead->valid && ( readahead->uri == http->uri ) &&
+	     ( readahead->start == start ) )
+		return;
+
+	/* Discard any previously cached data */
+	xferbuf_free ( &readahead->xferbuf );
+	readahead->valid = 0;
+	uri_put ( readahead->uri );
+	readahead->uri = uri_get ( http->uri );
+	readahead->start = start;
+	readahead->len = HTTP_BLOCK_READAHEAD_LEN;
+
+	/* Start a range request to fetch the readahead range */
+	range.start = start;
+	range.len = readahead->len;
+	if ( ( rc = http_open ( &readahead->xfer, &http_get, readahead->uri,
+				&range, NULL ) ) != 0 ) {
+		DBGC ( readahead, "HTTPBLOCK could not start readahead of "
+		       "%#zx: %s\n", start, strerror ( rc ) );
+		return;
+	}
+	readahead->busy = 1;
+}
+
+/** A cached data replay */
+struct http_block_replay {
+	/** Reference count for this object */
+	struct refcnt refcnt;
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Replay process */
+	struct process process;
+	/** Length of data */
+	size_t len;
+};
+
+/**
+ * Replay cached data
+ *
+ * @v replay		Cached data replay
+ */
+static void http_block_replay_step ( struct http_block_replay *replay ) {
+	const uint8_t *data = ( ( const void * ) ( replay + 1 ) );
+	struct io_buffer *iobuf;
+	size_t offset = 0;
+	size_t frag;
+	int rc;
+
+	/* Deliver data in fragments, then close cleanly */
+	while ( offset < replay->len ) {
+		frag = ( replay->len - offset );
+		if ( frag > HTTP_BLOCK_REPLAY_FRAG_LEN )
+			frag = HTTP_BLOCK_REPLAY_FRAG_LEN;
+		iobuf = xfer_alloc_iob ( &replay->xfer, frag );
+		if ( ! iobuf ) {
+			intf_shutdown ( &replay->xfer, -ENOMEM );
+			return;
+		}
+		memcpy ( iob_put ( iobuf, frag ), ( data + offset ), frag );
+		if ( ( rc = xfer_deliver_iob ( &replay->xfer,
+					       iob_disown ( iobuf ) ) ) != 0 ){
+			intf_shutdown ( &replay->xfer, rc );
+			return;
+		}
+		offset += frag;
+	}
+	intf_shutdown ( &replay->xfer, 0 );
+}
+
+/** Cached data replay interface operations */
+static struct interface_operation http_block_replay_operations[] = {};
+
+/** Cached data replay interface descriptor */
+static struct interface_descriptor http_block_replay_desc =
+	INTF_DESC ( struct http_block_replay, xfer,
+		    http_block_replay_operations );
+
+/** Cached data replay process descriptor */
+static struct process_descriptor http_block_replay_process_desc =
+	PROC_DESC_ONCE ( struct http_block_replay, process,
+			 http_block_replay_step );
+
+/**
+ * Serve a block read from the readahead cache
+ *
+ * @v http		HTTP transaction
+ * @v data		Data interface
+ * @v offset		Offset within cached data
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int http_block_replay ( struct http_transaction *http,
+			       struct interface *data, size_t offset,
+			       userptr_t buffer, size_t len ) {
+	struct http_block_readahead *readahead = &http_block_readahead;
+	struct http_block_replay *replay;
+	int rc;
+
+	/* Allocate and initialise structure, copying the cached data
+	 * so that it remains stable even if the cache is replaced
+	 * before the replay process runs.
+	 */
+	replay = zalloc ( sizeof ( *replay ) + len );
+	if ( ! replay ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	ref_init ( &replay->refcnt, NULL );
+	intf_init ( &replay->xfer, &http_block_replay_desc, &replay->refcnt );
+	process_init ( &replay->process, &http_block_replay_process_desc,
+		       &replay->refcnt );
+	replay->len = len;
+	if ( ( rc = xferbuf_read ( &readahead->xferbuf, offset,
+				   ( replay + 1 ), len ) ) != 0 )
+		goto err_read;
+
+	/* Attach to data interface and insert block device translator */
+	intf_plug_plug ( &replay->xfer, data );
+	if ( ( rc = block_translate ( data, buffer, len ) ) != 0 ) {
+		DBGC ( http, "HTTP %p could not insert block translator: %s\n",
+		       http, strerror ( rc ) );
+		goto err_translate;
+	}
+
+	/* Mortalise self and return */
+	ref_put ( &replay->refcnt );
+	DBGC2 ( http, "HTTP %p serving %#zx+%#zx from readahead cache\n",
+		http, ( readahead->start + offset ), len );
+	return 0;
+
+ err_translate:
+	intf_restart ( data, rc );
+ err_read:
+	process_del ( &replay->process );
+	intf_shutdown ( &replay->xfer, rc );
+	ref_put ( &replay->refcnt );
+ err_alloc:
+	return rc;
+}
+
 /**
  * Read from block device
  *
@@ -54,14 +316,39 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 int http_block_read ( struct http_transaction *http, struct interface *data,
 		      uint64_t lba, unsigned int count, userptr_t buffer,
 		      size_t len ) {
+	struct http_block_readahead *readahead = &http_block_readahead;
 	struct http_request_range range;
+	size_t offset = ( lba * HTTP_BLKSIZE );
+	int sequential;
 	int rc;
 
 	/* Sanity check */
 	assert ( len == ( count * HTTP_BLKSIZE ) );
 
+	/* Record whether this read continues a sequential pattern */
+	sequential = ( offset == http_block_last_end );
+	http_block_last_end = ( offset + len );
+
+	/* Serve from the readahead cache, if possible */
+	if ( readahead->valid && ( readahead->uri == http->uri ) &&
+	     ( offset >= readahead->start ) &&
+	     ( ( offset + len ) <=
+	       ( readahead->start + readahead->xferbuf.len ) ) &&
+	     ( ( rc = http_block_replay ( http, data,
+					  ( offset - readahead->start ),
+					  buffer, len ) ) == 0 ) ) {
+
+		/* Fetch the next range once the cached range has
+		 * been fully consumed.
+		 */
+		if ( ( offset + len ) == ( readahead->start + readahead->len ))
+			http_block_readahead_start ( http, ( readahead->start +
+							     readahead->len ));
+		return 0;
+	}
+
 	/* Construct request range descriptor */
-	range.start = ( lba * HTTP_BLKSIZE );
+	range.start = offset;
 	range.len = len;
 
 	/* Start a range request to retrieve the block(s) */
@@ -76,6 +363,12 @@ int http_block_read ( struct http_transaction *http, struct interface *data,
 		goto err_translate;
 	}
 
+	/* Begin fetching the following range ahead of time, if the
+	 * read pattern is sequential.
+	 */
+	if ( sequential )
+		http_block_readahead_start ( http, ( offset + len ) );
+
 	return 0;
 
  err_translate:
@@ -322,3 +322,113 @@ int http_connect ( struct interface *xfer, struct uri *uri ) {
  err_alloc:
 	return rc;
 }
+
+/** An HTTP preconnection
+ *
+ * This is a transient object which warms up a single pooled
+ * connection: it opens the connection, waits for the transport (and
+ * any TLS filter) to become ready, and then releases the connection
+ * into the pool for reuse by a subsequent request.
+ */
+struct http_preconn {
+	/** Reference count for this object */
+	struct refcnt refcnt;
+	/** Data transfer interface to HTTP connection */
+	struct interface conn;
+};
+
+/**
+ * Handle preconnection window change
+ *
+ * @v preconn		HTTP preconnection
+ */
+static void http_preconn_window_changed ( struct http_preconn *preconn ) {
+
+	/* A non-zero window indicates that the transport (including
+	 * any TLS handshake) is ready to carry a request.  Release
+	 * the connection into the pool by marking it as recyclable
+	 * and closing it cleanly.
+	 */
+	if ( xfer_window ( &preconn->conn ) ) {
+		DBGC2 ( preconn, "HTTPPRECONN %p handshake complete\n",
+			preconn );
+		pool_recycle ( &preconn->conn );
+		intf_shutdown ( &preconn->conn, 0 );
+	}
+}
+
+/**
+ * Close HTTP preconnection
+ *
+ * @v preconn		HTTP preconnection
+ * @v rc		Reason for close
+ */
+static void http_preconn_close ( struct http_preconn *preconn, int rc ) {
+
+	if ( rc != 0 ) {
+		DBGC ( preconn, "HTTPPRECONN %p failed: %s\n",
+		       preconn, strerror ( rc ) );
+	}
+	intf_shutdown ( &preconn->conn, rc );
+}
+
+/** HTTP preconnection interface operations */
+static struct interface_operation http_preconn_operations[] = {
+	INTF_OP ( xfer_window_changed, struct http_preconn *,
+		  http_preconn_window_changed ),
+	INTF_OP ( intf_close, struct http_preconn *, http_preconn_close ),
+};
+
+/** HTTP preconnection interface descriptor */
+static struct interface_descriptor http_preconn_desc =
+	INTF_DESC ( struct http_preconn, conn, http_preconn_operations );
+
+/**
+ * Warm up pooled connections to an HTTP server
+ *
+ * @v uri		Connection URI
+ * @v count		Number of connections to open
+ * @ret rc		Return status code
+ *
+ * Opens and handshakes pooled connections in the background, so that
+ * subsequent requests to the same origin can start without paying
+ * the TCP (and TLS) connection setup latency.  Returns once the
+ * connection attempts have been initiated; the handshakes proceed
+ * concurrently with any further work.
+ */
+int http_preconnect ( struct uri *uri, unsigned int count ) {
+	struct http_preconn *preconn;
+	unsigned int i;
+	int rc;
+
+	for ( i = 0 ; i < count ; i++ ) {
+
+		/* Allocate and initialise structure */
+		preconn = zalloc ( sizeof ( *preconn ) );
+		if ( ! preconn )
+			return -ENOMEM;
+		ref_init ( &preconn->refcnt, NULL );
+		intf_init ( &preconn->conn, &http_preconn_desc,
+			    &preconn->refcnt );
+
+		/* Open connection */
+		if ( ( rc = http_connect ( &preconn->conn, uri ) ) != 0 ) {
+			DBGC ( preconn, "HTTPPRECONN %p could not connect: "
+			       "%s\n", preconn, strerror ( rc ) );
+			ref_put ( &preconn->refcnt );
+			return rc;
+		}
+		DBGC2 ( preconn, "HTTPPRECONN %p connecting to %s\n",
+			preconn, uri->host );
+
+		/* If the connection is already usable (e.g. reused
+		 * from the pool), then release it back immediately.
+		 */
+		http_preconn_window_changed ( preconn );
+
+		/* Mortalise self */
+		ref_put ( &preconn->refcnt );
+	}
+
+	return 0;
+}
@@ -105,6 +105,17 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Retry delay used when we cannot understand the Retry-After header */
 #define HTTP_RETRY_SECONDS 5
 
+/** Default number of times to resume an interrupted transfer */
+#define HTTP_RESUME_MAX 3
+
+/** HTTP resume attempts setting */
+const struct setting http_resumes_setting __setting ( SETTING_MISC,
+						      http-resumes ) = {
+	.name = "http-resumes",
+	.description = "HTTP resume attempts",
+	.type = &setting_type_uint8,
+};
+
 /** Receive profiler */
 static struct profiler http_rx_profiler __profiler = { .name = "http.rx" };
 
@@ -329,6 +340,74 @@ static void http_reopen ( struct http_transaction *http ) {
 	http_close ( http, rc );
 }
 
+/**
+ * Attempt to resume an interrupted HTTP transfer
+ *
+ * @v http		HTTP transaction
+ * @v rc		Reason for interruption
+ * @ret rc		Return status code
+ *
+ * If the connection is lost partway through receiving a response
+ * body, then we may be able to avoid refetching the already received
+ * content by reissuing the request with a range covering only the
+ * remaining content.
+ */
+static int http_resume ( struct http_transaction *http, int rc ) {
+	unsigned long max;
+
+	/* Allow the default resume attempt budget to be overridden */
+	if ( fetch_uint_setting ( NULL, &http_resumes_setting, &max ) < 0 )
+		max = HTTP_RESUME_MAX;
+
+	/* Resume only idempotent requests */
+	if ( http->request.method != &http_get )
+		return rc;
+
+	/* Resume only successful responses with a known content
+	 * length, since we would otherwise be unable to detect a
+	 * server that ignores the requested range.
+	 */
+	if ( http->response.rc != 0 )
+		return rc;
+	if ( ! ( http->response.flags & HTTP_RESPONSE_CONTENT_LEN ) )
+		return rc;
+
+	/* Resume only unencoded content, since a content encoding
+	 * filter would not survive reissuing the request.
+	 */
+	if ( http->response.content.encoding )
+		return rc;
+
+	/* Resume only if some of the content remains to be received
+	 * and some progress has been made (to guarantee eventual
+	 * termination).
+	 */
+	if ( ( http->len == 0 ) ||
+	     ( http->len >= http->response.content.len ) )
+		return rc;
+
+	/* Fail if the resume attempt budget is exhausted */
+	if ( http->resumes >= max )
+		return rc;
+	http->resumes++;
+
+	/* Narrow the request range to the remaining content */
+	http->request.range.start += http->len;
+	http->request.range.len = ( http->response.content.len - http->len );
+
+	/* Record the resume offset and reset the received length */
+	http->offset += http->len;
+	http->len = 0;
+
+	DBGC ( http, "HTTP %p resuming at offset %zd (attempt %d): %s\n",
+	       http, http->offset, http->resumes, strerror ( rc ) );
+
+	/* Reissue request on a fresh connection */
+	http_reopen ( http );
+
+	return 0;
+}
+
 /**
  * Handle retry timer expiry
  *
@@ -1470,6 +1549,19 @@ static int http_rx_headers ( struct http_transaction *http,
 	if ( ( rc = http_parse_headers ( http ) ) != 0 )
 		return rc;
 
+	/* Fail if a resumed transfer's response does not cover
+	 * exactly the remaining content, since the server may have
+	 * ignored the requested range and restarted from the
+	 * beginning.
+	 */
+	if ( http->offset && ( http->response.rc == 0 ) &&
+	     ( ( ! ( http->response.flags & HTTP_RESPONSE_CONTENT_LEN ) ) ||
+	       ( http->response.content.len != http->request.range.len ) ) ) {
+		DBGC ( http, "HTTP %p resumed with unexpected content "
+		       "length\n", http );
+		return -EIO_CONTENT_LENGTH;
+	}
+
 	/* Initialise content encoding, if applicable */
 	if ( ( content = http->response.content.encoding ) &&
 	     ( ( rc = content->init ( http ) ) != 0 ) ) {
@@ -1480,8 +1572,9 @@ static int http_rx_headers ( struct http_transaction *http,
 
 	/* Presize receive buffer, if we have a content length */
 	if ( http->response.content.len ) {
-		xfer_seek ( &http->transfer, http->response.content.len );
-		xfer_seek ( &http->transfer, 0 );
+		xfer_seek ( &http->transfer, ( http->offset +
+					       http->response.content.len ) );
+		xfer_seek ( &http->transfer, http->offset );
 	}
 
 	/* Complete transfer if this is a HEAD request */
@@ -1610,6 +1703,9 @@ static void http_close_transfer_identity ( struct http_transaction *http,
 	return;
 
  err:
+	/* Attempt to resume the transfer, if applicable */
+	if ( http_resume ( http, rc ) == 0 )
+		return;
 	http_close ( http, rc );
 }
 
@@ -1896,6 +1992,12 @@ static size_t http_params ( struct parameters *params, char *buf, size_t len ) {
  * @ret rc		Return status code
  */
 static int http_open_get_uri ( struct interface *xfer, struct uri *uri ) {
+	unsigned long stripes = 0;
+
+	/* Use the striped download engine, if configured */
+	fetch_uint_setting ( NULL, &http_stripes_setting, &stripes );
+	if ( stripes >= 2 )
+		return http_open_striped ( xfer, uri, stripes );
 
 	return http_open ( xfer, &http_get, uri, NULL, NULL );
 }
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/**
+ * @file
+ *
+ * Hyper Text Transfer Protocol (HTTP) gzip content encoding
+ *
+ * Compressible boot files (kernels, initrds, scripts) typically
+ * shrink by a factor of two to three under gzip, which translates
+ * directly into saved transfer time on slow links.  We advertise
+ * "Accept-Encoding: gzip", buffer the (smaller) compressed body as
+ * it arrives, and decompress it once the transfer completes.
+ *
+ * The DEFLATE decompressor requires its complete output history to
+ * be present in the output buffer (in order to resolve LZ77 back
+ * references), and so cannot stream into fixed-size chunks.  We
+ * therefore decompress in two passes: a first pass with a zero-sized
+ * output buffer to determine the decompressed length, and a second
+ * pass writing directly into a mapping of the recipient's data
+ * transfer buffer.  This limits gzip encoding to recipients that
+ * provide such a buffer (which covers all image downloads), as
+ * enforced by the supported() check.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/xfer.h>
+#include <ipxe/xferbuf.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/uaccess.h>
+#include <ipxe/deflate.h>
+#include <ipxe/http.h>
+
+/** A gzip content decoder */
+struct http_gzip {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Decompressed data interface */
+	struct interface xfer;
+	/** Compressed data interface */
+	struct interface raw;
+	/** Compressed data buffer */
+	struct xfer_buffer buffer;
+	/** Decompressor */
+	struct deflate deflate;
+};
+
+/**
+ * Free gzip content decoder
+ *
+ * @v refcnt		Reference count
+ */
+static void http_gzip_free ( struct refcnt *refcnt ) {
+	struct http_gzip *gzip =
+		container_of ( refcnt, struct http_gzip, refcnt );
+
+	xferbuf_free ( &gzip->buffer );
+	free ( gzip );
+}
+
+/**
+ * Close gzip content decoder
+ *
+ * @v gzip		Gzip content decoder
+ * @v rc		Reason for close
+ */
+static void http_gzip_close ( struct http_gzip *gzip, int rc ) {
+
+	/* Shut down interfaces */
+	intf_shutdown ( &gzip->xfer, rc );
+	intf_shutdown ( &gzip->raw, rc );
+}
+
+/**
+ * Receive compressed data
+ *
+ * @v gzip		Gzip content decoder
+ * @v iobuf		I/O buffer
+ * @v meta		Transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_gzip_deliver ( struct http_gzip *gzip,
+			       struct io_buffer *iobuf,
+			       struct xfer_metadata *meta ) {
+
+	/* Add to compressed data buffer */
+	return xferbuf_deliver ( &gzip->buffer, iob_disown ( iobuf ), meta );
+}
+
+/**
+ * Decompress buffered compressed data
+ *
+ * @v gzip		Gzip content decoder
+ * @ret rc		Return status code
+ */
+static int http_gzip_inflate ( struct http_gzip *gzip ) {
+	struct xfer_buffer *xferbuf;
+	struct deflate_chunk in;
+	struct deflate_chunk out;
+	userptr_t map;
+	size_t len;
+	int rc;
+
+	/* Perform a first pass with a zero-sized output buffer to
+	 * determine the decompressed length.
+	 */
+	deflate_init ( &gzip->deflate, DEFLATE_GZIP );
+	deflate_chunk_init ( &in, virt_to_user ( gzip->buffer.data ), 0,
+			     gzip->buffer.len );
+	deflate_chunk_init ( &out, UNULL, 0, 0 );
+	if ( ( rc = deflate_inflate ( &gzip->deflate, &in, &out ) ) != 0 ) {
+		DBGC ( gzip, "GZIP %p could not decompress: %s\n",
+		       gzip, strerror ( rc ) );
+		return rc;
+	}
+	if ( ! deflate_finished ( &gzip->deflate ) ) {
+		DBGC ( gzip, "GZIP %p truncated compressed data\n", gzip );
+		return -EIO;
+	}
+	len = out.offset;
+	DBGC ( gzip, "GZIP %p decompressing %zd bytes to %zd bytes\n",
+	       gzip, gzip->buffer.len, len );
+
+	/* Map recipient's data transfer buffer */
+	xferbuf = xfer_buffer ( &gzip->xfer );
+	if ( ! xferbuf ) {
+		DBGC ( gzip, "GZIP %p has no recipient data transfer "
+		       "buffer\n", gzip );
+		return -ENOTSUP;
+	}
+	map = xferbuf_map ( xferbuf, 0, len );
+	if ( ! map ) {
+		DBGC ( gzip, "GZIP %p could not map %zd bytes\n", gzip, len );
+		return -ENOMEM;
+	}
+
+	/* Perform a second pass, decompressing directly into the
+	 * recipient's data transfer buffer.
+	 */
+	deflate_init ( &gzip->deflate, DEFLATE_GZIP );
+	deflate_chunk_init ( &in, virt_to_user ( gzip->buffer.data ), 0,
+			     gzip->buffer.len );
+	deflate_chunk_init ( &out, map, 0, len );
+	if ( ( rc = deflate_inflate ( &gzip->deflate, &in, &out ) ) != 0 ) {
+		DBGC ( gzip, "GZIP %p could not decompress: %s\n",
+		       gzip, strerror ( rc ) );
+		return rc;
+	}
+	assert ( deflate_finished ( &gzip->deflate ) );
+	assert ( out.offset == len );
+
+	/* Free compressed data buffer */
+	xferbuf_free ( &gzip->buffer );
+
+	/* Update recipient's position to reflect the delivered data */
+	xfer_seek ( &gzip->xfer, len );
+
+	return 0;
+}
+
+/**
+ * Handle end of compressed data
+ *
+ * @v gzip		Gzip content decoder
+ * @v rc		Reason for close
+ */
+static void http_gzip_raw_close ( struct http_gzip *gzip, int rc ) {
+
+	/* Decompress buffered data, if transfer was successful */
+	if ( rc == 0 )
+		rc = http_gzip_inflate ( gzip );
+
+	/* Terminate transaction */
+	http_gzip_close ( gzip, rc );
+}
+
+/** Decompressed data interface operations */
+static struct interface_operation http_gzip_xfer_operations[] = {
+	INTF_OP ( intf_close, struct http_gzip *, http_gzip_close ),
+};
+
+/** Decompressed data interface descriptor */
+static struct interface_descriptor http_gzip_xfer_desc =
+	INTF_DESC_PASSTHRU ( struct http_gzip, xfer,
+			     http_gzip_xfer_operations, raw );
+
+/** Compressed data interface operations */
+static struct interface_operation http_gzip_raw_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_gzip *, http_gzip_deliver ),
+	INTF_OP ( intf_close, struct http_gzip *, http_gzip_raw_close ),
+};
+
+/** Compressed data interface descriptor */
+static struct interface_descriptor http_gzip_raw_desc =
+	INTF_DESC_PASSTHRU ( struct http_gzip, raw,
+			     http_gzip_raw_operations, xfer );
+
+/**
+ * Check whether or not to support gzip encoding for this request
+ *
+ * @v http		HTTP transaction
+ * @ret supported	Gzip encoding is supported for this request
+ */
+static int http_gzip_supported ( struct http_transaction *http ) {
+
+	/* Do not advertise gzip encoding for range requests, since
+	 * ranges apply to the compressed representation and would no
+	 * longer match the caller's expectations.
+	 */
+	if ( http->request.range.len )
+		return 0;
+
+	/* Support gzip encoding only if we can directly access an
+	 * underlying data transfer buffer, since the decompressor
+	 * requires a single contiguous output buffer.
+	 */
+	return ( xfer_buffer ( &http->xfer ) != NULL );
+}
+
+/**
+ * Initialise gzip content encoding
+ *
+ * @v http		HTTP transaction
+ * @ret rc		Return status code
+ */
+static int http_gzip_init ( struct http_transaction *http ) {
+	struct http_gzip *gzip;
+
+	/* Allocate and initialise structure */
+	gzip = zalloc ( sizeof ( *gzip ) );
+	if ( ! gzip )
+		return -ENOMEM;
+	ref_init ( &gzip->refcnt, http_gzip_free );
+	intf_init ( &gzip->xfer, &http_gzip_xfer_desc, &gzip->refcnt );
+	intf_init ( &gzip->raw, &http_gzip_raw_desc, &gzip->refcnt );
+	xferbuf_malloc_init ( &gzip->buffer );
+
+	/* Attach to content and transfer interfaces, mortalise self,
+	 * and return.
+	 */
+	intf_plug_plug ( &gzip->xfer, &http->content );
+	intf_plug_plug ( &gzip->raw, &http->transfer );
+	ref_put ( &gzip->refcnt );
+	return 0;
+}
+
+/** Gzip HTTP content encoding */
+struct http_content_encoding gzip_encoding __http_content_encoding = {
+	.name = "gzip",
+	.supported = http_gzip_supported,
+	.init = http_gzip_init,
+};
@@ -0,0 +1,459 @@
+/*
+ * Copyright (C) 2026 iPXE project.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/**
+ * @file
+ *
+ * Hyper Text Transfer Protocol (HTTP) striped downloads
+ *
+ * A single TCP connection is often unable to exploit the full
+ * bandwidth of a content server.  The striped download engine splits
+ * a download into fixed-size chunks fetched via Range requests over
+ * several parallel connections, and delivers the received data to
+ * the parent at its absolute offset so that the parent's data
+ * transfer buffer performs the reassembly.
+ *
+ * The total content length is not known in advance: the end of the
+ * file is detected when a chunk completes with fewer bytes than
+ * requested.  A chunk that lies exactly at the end of the file will
+ * instead fail outright (with a range error from the server); such a
+ * failure is treated as a tentative end-of-file marker and is
+ * confirmed or refuted once all other chunks have completed.
+ *
+ * Servers that ignore Range requests are not usable for striping,
+ * since each connection would return the entire file; this is
+ * detected and treated as an error.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/xfer.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/job.h>
+#include <ipxe/uri.h>
+#include <ipxe/settings.h>
+#include <ipxe/http.h>
+
+/** Length of each striped download chunk */
+#define HTTP_STRIPE_CHUNK_LEN ( 512 * 1024 )
+
+/** Maximum number of striped download connections */
+#define HTTP_STRIPE_MAX 8
+
+struct http_striper;
+
+/** A striped download connection */
+struct http_stripe {
+	/** HTTP striper */
+	struct http_striper *striper;
+	/** Data transfer interface to HTTP transaction */
+	struct interface xfer;
+	/** Chunk starting offset */
+	size_t start;
+	/** Requested chunk length */
+	size_t len;
+	/** Received length */
+	size_t received;
+	/** Chunk request is in progress */
+	int busy;
+};
+
+/** A striped download */
+struct http_striper {
+	/** Reference count for this object */
+	struct refcnt refcnt;
+	/** Data transfer interface to parent */
+	struct interface xfer;
+
+	/** Request URI */
+	struct uri *uri;
+	/** Striped connections */
+	struct http_stripe stripe[HTTP_STRIPE_MAX];
+	/** Number of striped connections */
+	unsigned int count;
+
+	/** Next unassigned chunk offset */
+	size_t next;
+	/** Total received length */
+	size_t received;
+	/** First data has been received */
+	int started;
+	/** End of file has been detected */
+	int eof;
+	/** Total content length (valid only when end of file detected) */
+	size_t total;
+	/** Tentative end-of-file offset (valid only when @c
+	 * candidate_rc is non-zero)
+	 */
+	size_t candidate;
+	/** Status code of tentative end-of-file chunk failure */
+	int candidate_rc;
+};
+
+/**
+ * Free striped download object
+ *
+ * @v refcnt		Striper reference counter
+ */
+static void http_striper_free ( struct refcnt *refcnt ) {
+	struct http_striper *striper =
+		container_of ( refcnt, struct http_striper, refcnt );
+
+	uri_put ( striper->uri );
+	free ( striper );
+}
+
+/**
+ * Terminate striped download
+ *
+ * @v striper		Striped download
+ * @v rc		Reason for termination
+ */
+static void http_striper_finished ( struct http_striper *striper, int rc ) {
+	unsigned int i;
+
+	DBGC ( striper, "HTTPSTRIPE %p finished: %s\n",
+	       striper, strerror ( rc ) );
+
+	/* Shut down all interfaces */
+	for ( i = 0 ; i < striper->count ; i++ )
+		intf_shutdown ( &striper->stripe[i].xfer, rc );
+	intf_shutdown ( &striper->xfer, rc );
+}
+
+/**
+ * Start fetching the next chunk on an idle connection
+ *
+ * @v stripe		Striped download connection
+ * @ret rc		Return status code
+ */
+static int http_stripe_open ( struct http_stripe *stripe ) {
+	struct http_striper *striper = stripe->striper;
+	struct http_request_range range;
+	int rc;
+
+	/* Sanity check */
+	assert ( ! stripe->busy );
+
+	/* Construct request range descriptor */
+	range.start = striper->next;
+	range.len = HTTP_STRIPE_CHUNK_LEN;
+
+	/* Start a range request to retrieve the chunk */
+	if ( ( rc = http_open ( &stripe->xfer, &http_get, striper->uri,
+				&range, NULL ) ) != 0 ) {
+		DBGC ( striper, "HTTPSTRIPE %p could not open chunk at "
+		       "%#zx: %s\n", striper, range.start, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Claim the chunk */
+	stripe->start = range.start;
+	stripe->len = range.len;
+	stripe->received = 0;
+	stripe->busy = 1;
+	striper->next += range.len;
+
+	DBGC2 ( striper, "HTTPSTRIPE %p fetching %#zx+%#zx\n",
+		striper, stripe->start, stripe->len );
+	return 0;
+}
+
+/**
+ * Assign chunks to all idle connections
+ *
+ * @v striper		Striped download
+ */
+static void http_striper_assign ( struct http_striper *striper ) {
+	struct http_stripe *stripe;
+	unsigned int i;
+	int rc;
+
+	/* Do not assign chunks until the first data has been
+	 * received, or after (even a tentative) end of file.
+	 */
+	if ( ( ! striper->started ) || striper->eof || striper->candidate_rc )
+		return;
+
+	/* Assign the next chunk to each idle connection */
+	for ( i = 0 ; i < striper->count ; i++ ) {
+		stripe = &striper->stripe[i];
+		if ( stripe->busy )
+			continue;
+		if ( ( rc = http_stripe_open ( stripe ) ) != 0 ) {
+			http_striper_finished ( striper, rc );
+			return;
+		}
+	}
+}
+
+/**
+ * Check whether any chunk requests are in progress
+ *
+ * @v striper		Striped download
+ * @ret busy		Chunk requests are in progress
+ */
+static int http_striper_busy ( struct http_striper *striper ) {
+	unsigned int i;
+
+	for ( i = 0 ; i < striper->count ; i++ ) {
+		if ( striper->stripe[i].busy )
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * Handle received chunk data
+ *
+ * @v stripe		Striped download connection
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int http_stripe_deliver ( struct http_stripe *stripe,
+				 struct io_buffer *iobuf,
+				 struct xfer_metadata *meta __unused ) {
+	struct http_striper *striper = stripe->striper;
+	struct xfer_metadata abs_meta;
+	size_t len = iob_len ( iobuf );
+	int rc;
+
+	/* Fail if the server delivers more than the requested range,
+	 * since it is then ignoring Range requests and every
+	 * connection would return the entire file.
+	 */
+	if ( ( stripe->received + len ) > stripe->len ) {
+		DBGC ( striper, "HTTPSTRIPE %p server ignores range "
+		       "requests\n", striper );
+		free_iob ( iobuf );
+		rc = -EPROTO;
+		goto err;
+	}
+
+	/* Deliver to parent at this chunk's absolute position */
+	memset ( &abs_meta, 0, sizeof ( abs_meta ) );
+	abs_meta.flags = XFER_FL_ABS_OFFSET;
+	abs_meta.offset = ( stripe->start + stripe->received );
+	if ( ( rc = xfer_deliver ( &striper->xfer, iob_disown ( iobuf ),
+				   &abs_meta ) ) != 0 )
+		goto err;
+
+	/* Update progress */
+	stripe->received += len;
+	striper->received += len;
+
+	/* Open the remaining connections once the first data has
+	 * been received.
+	 */
+	if ( ! striper->started ) {
+		striper->started = 1;
+		http_striper_assign ( striper );
+	}
+
+	return 0;
+
+ err:
+	http_striper_finished ( striper, rc );
+	return rc;
+}
+
+/**
+ * Handle completed chunk request
+ *
+ * @v stripe		Striped download connection
+ * @v rc		Reason for completion
+ */
+static void http_stripe_close ( struct http_stripe *stripe, int rc ) {
+	struct http_striper *striper = stripe->striper;
+	size_t end = ( stripe->start + stripe->received );
+
+	/* Detach from the completed transaction */
+	intf_restart ( &stripe->xfer, rc );
+	stripe->busy = 0;
+
+	if ( rc == 0 ) {
+
+		/* A clean short chunk marks the end of the file */
+		if ( stripe->received < stripe->len ) {
+			if ( ( ! striper->eof ) || ( end < striper->total ) )
+				striper->total = end;
+			striper->eof = 1;
+			DBGC ( striper, "HTTPSTRIPE %p end of file at %#zx\n",
+			       striper, striper->total );
+		}
+
+	} else if ( striper->eof && ( stripe->received == 0 ) &&
+		    ( stripe->start >= striper->total ) ) {
+
+		/* Ignore failure of a chunk beyond the end of file */
+
+	} else if ( ( ! striper->eof ) && ( stripe->received == 0 ) &&
+		    ( stripe->start > 0 ) ) {
+
+		/* A chunk starting exactly at the end of the file
+		 * fails outright; record a tentative end of file to
+		 * be confirmed once all other chunks have completed.
+		 */
+		if ( ( ! striper->candidate_rc ) ||
+		     ( stripe->start < striper->candidate ) ) {
+			striper->candidate = stripe->start;
+			striper->candidate_rc = rc;
+		}
+		DBGC ( striper, "HTTPSTRIPE %p tentative end of file at "
+		       "%#zx: %s\n", striper, striper->candidate,
+		       strerror ( rc ) );
+
+	} else {
+
+		/* Propagate genuine failures */
+		http_striper_finished ( striper, rc );
+		return;
+	}
+
+	/* Assign further chunks, if applicable */
+	http_striper_assign ( striper );
+
+	/* Check for overall completion */
+	if ( ! http_striper_busy ( striper ) ) {
+		if ( striper->eof && ( striper->received == striper->total ) ){
+			http_striper_finished ( striper, 0 );
+		} else if ( striper->candidate_rc &&
+			    ( striper->received == striper->candidate ) ) {
+			/* All data up to the tentative end of file
+			 * was received; the failed chunk really did
+			 * lie beyond the end of the file.
+			 */
+			striper->eof = 1;
+			striper->total = striper->candidate;
+			http_striper_finished ( striper, 0 );
+		} else {
+			http_striper_finished ( striper,
+						( striper->candidate_rc ?
+						  striper->candidate_rc :
+						  -EIO ) );
+		}
+	}
+}
+
+/** Striped download connection interface operations */
+static struct interface_operation http_stripe_operations[] = {
+	INTF_OP ( xfer_deliver, struct http_stripe *, http_stripe_deliver ),
+	INTF_OP ( intf_close, struct http_stripe *, http_stripe_close ),
+};
+
+/** Striped download connection interface descriptor */
+static struct interface_descriptor http_stripe_desc =
+	INTF_DESC ( struct http_stripe, xfer, http_stripe_operations );
+
+/**
+ * Report progress of striped download
+ *
+ * @v striper		Striped download
+ * @v progress		Progress report to fill in
+ * @ret ongoing_rc	Ongoing job status code (if known)
+ */
+static int http_striper_progress ( struct http_striper *striper,
+				   struct job_progress *progress ) {
+
+	progress->completed = striper->received;
+	progress->total = ( striper->eof ? striper->total : 0 );
+	return 0;
+}
+
+/** Striped download data transfer interface operations */
+static struct interface_operation http_striper_operations[] = {
+	INTF_OP ( job_progress, struct http_striper *,
+		  http_striper_progress ),
+	INTF_OP ( intf_close, struct http_striper *, http_striper_finished ),
+};
+
+/** Striped download data transfer interface descriptor */
+static struct interface_descriptor http_striper_xfer_desc =
+	INTF_DESC ( struct http_striper, xfer, http_striper_operations );
+
+/**
+ * Open striped HTTP download
+ *
+ * @v xfer		Data transfer interface
+ * @v uri		Request URI
+ * @v count		Number of parallel connections
+ * @ret rc		Return status code
+ */
+int http_open_striped ( struct interface *xfer, struct uri *uri,
+			unsigned int count ) {
+	struct http_striper *striper;
+	unsigned int i;
+	int rc;
+
+	/* Clamp number of connections */
+	if ( count > HTTP_STRIPE_MAX )
+		count = HTTP_STRIPE_MAX;
+
+	/* Allocate and initialise structure */
+	striper = zalloc ( sizeof ( *striper ) );
+	if ( ! striper )
+		return -ENOMEM;
+	ref_init ( &striper->refcnt, http_striper_free );
+	intf_init ( &striper->xfer, &http_striper_xfer_desc,
+		    &striper->refcnt );
+	striper->uri = uri_get ( uri );
+	striper->count = count;
+	for ( i = 0 ; i < count ; i++ ) {
+		striper->stripe[i].striper = striper;
+		intf_init ( &striper->stripe[i].xfer, &http_stripe_desc,
+			    &striper->refcnt );
+	}
+
+	DBGC ( striper, "HTTPSTRIPE %p using %d connections\n",
+	       striper, count );
+
+	/* Start fetching the first chunk.  The remaining connections
+	 * are opened once the first data arrives, to avoid an error
+	 * storm when the file is smaller than a single chunk.
+	 */
+	if ( ( rc = http_stripe_open ( &striper->stripe[0] ) ) != 0 )
+		goto err;
+
+	/* Attach parent interface, mortalise self, and return */
+	intf_plug_plug ( &striper->xfer, xfer );
+	ref_put ( &striper->refcnt );
+	return 0;
+
+ err:
+	ref_put ( &striper->refcnt );
+	return rc;
+}
+
+/** HTTP striped download connection count setting */
+const struct setting http_stripes_setting __setting ( SETTING_MISC,
+						      http-stripes ) = {
+	.name = "http-stripes",
+	.description = "HTTP striped download connections",
+	.type = &setting_type_uint8,
+};
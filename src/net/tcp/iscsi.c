@@ -45,6 +45,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/features.h>
 #include <ipxe/base16.h>
 #include <ipxe/base64.h>
+#include <ipxe/crc32c.h>
 #include <ipxe/ibft.h>
 #include <ipxe/iscsi.h>
 
@@ -141,11 +142,19 @@ FEATURE ( FEATURE_PROTOCOL, "iSCSI", DHCP_EB_FEATURE_ISCSI, 1 );
 	__einfo_error ( EINFO_EPROTO_VALUE_REJECTED )
 #define EINFO_EPROTO_VALUE_REJECTED					\
 	__einfo_uniqify ( EINFO_EPROTO, 0x06, "Parameter rejected" )
+#define EPROTO_INVALID_DIGEST						\
+	__einfo_error ( EINFO_EPROTO_INVALID_DIGEST )
+#define EINFO_EPROTO_INVALID_DIGEST					\
+	__einfo_uniqify ( EINFO_EPROTO, 0x07, "Invalid digest" )
 
 static void iscsi_start_tx ( struct iscsi_session *iscsi );
 static void iscsi_start_login ( struct iscsi_session *iscsi );
 static void iscsi_start_data_out ( struct iscsi_session *iscsi,
 				   unsigned int datasn );
+static void iscsi_start_next ( struct iscsi_session *iscsi );
+static void iscsi_command_done ( struct iscsi_command *iscsicmd, int rc,
+				 struct scsi_rsp *rsp );
+static struct interface_descriptor iscsi_command_desc;
 
 /**
  * Finish receiving PDU data into buffer
@@ -205,7 +214,6 @@ static void iscsi_free ( struct refcnt *refcnt ) {
 	free ( iscsi->target_password );
 	chap_finish ( &iscsi->chap );
 	iscsi_rx_buffered_data_done ( iscsi );
-	free ( iscsi->command );
 	free ( iscsi );
 }
 
@@ -216,6 +224,7 @@ static void iscsi_free ( struct refcnt *refcnt ) {
  * @v rc		Reason for close
  */
 static void iscsi_close ( struct iscsi_session *iscsi, int rc ) {
+	struct iscsi_command *iscsicmd;
 
 	/* A TCP graceful close is still an error from our point of view */
 	if ( rc == 0 )
@@ -227,19 +236,44 @@ static void iscsi_close ( struct iscsi_session *iscsi, int rc ) {
 	process_del ( &iscsi->process );
 
 	/* Shut down interfaces */
-	intfs_shutdown ( rc, &iscsi->socket, &iscsi->control, &iscsi->data,
-			 NULL );
+	intfs_shutdown ( rc, &iscsi->socket, &iscsi->control, NULL );
+
+	/* Fail all outstanding commands */
+	while ( ( iscsicmd = list_first_entry ( &iscsi->commands,
+						struct iscsi_command,
+						list ) ) != NULL ) {
+		iscsi_command_done ( iscsicmd, rc, NULL );
+	}
 }
 
 /**
  * Assign new iSCSI initiator task tag
  *
- * @v iscsi		iSCSI session
+ * @ret itt		New initiator task tag
  */
-static void iscsi_new_itt ( struct iscsi_session *iscsi ) {
+static uint32_t iscsi_new_itt ( void ) {
 	static uint16_t itt_idx;
 
-	iscsi->itt = ( ISCSI_TAG_MAGIC | (++itt_idx) );
+	return ( ISCSI_TAG_MAGIC | (++itt_idx) );
+}
+
+/**
+ * Find iSCSI command by initiator task tag
+ *
+ * @v iscsi		iSCSI session
+ * @v itt		Initiator task tag
+ * @ret iscsicmd	iSCSI command, or NULL if not found
+ */
+static struct iscsi_command * iscsi_find_itt ( struct iscsi_session *iscsi,
+					       uint32_t itt ) {
+	struct iscsi_command *iscsicmd;
+
+	list_for_each_entry ( iscsicmd, &iscsi->commands, list ) {
+		if ( iscsicmd->itt == itt )
+			return iscsicmd;
+	}
+
+	return NULL;
 }
 
 /**
@@ -278,7 +312,7 @@ static int iscsi_open_connection ( struct iscsi_session *iscsi ) {
 	iscsi->isid_iana_qual = ( random() & 0xffff );
 
 	/* Assign fresh initiator task tag */
-	iscsi_new_itt ( iscsi );
+	iscsi->itt = iscsi_new_itt();
 
 	/* Initiate login */
 	iscsi_start_login ( iscsi );
@@ -296,6 +330,7 @@ static int iscsi_open_connection ( struct iscsi_session *iscsi ) {
  * ready to attempt a fresh login.
  */
 static void iscsi_close_connection ( struct iscsi_session *iscsi, int rc ) {
+	struct iscsi_command *iscsicmd;
 
 	/* Close all data transfer interfaces */
 	intf_restart ( &iscsi->socket, rc );
@@ -307,6 +342,19 @@ static void iscsi_close_connection ( struct iscsi_session *iscsi, int rc ) {
 	iscsi->tx_state = ISCSI_TX_IDLE;
 	iscsi->rx_state = ISCSI_RX_BHS;
 	iscsi->rx_offset = 0;
+	iscsi->tx_command = NULL;
+
+	/* Digests are renegotiated on each fresh login */
+	iscsi->header_digest = 0;
+	iscsi->data_digest = 0;
+
+	/* Mark any outstanding commands as needing to be reissued
+	 * once a fresh login completes.
+	 */
+	list_for_each_entry ( iscsicmd, &iscsi->commands, list ) {
+		iscsicmd->started = 0;
+		iscsicmd->r2t_pending = 0;
+	}
 
 	/* Free any temporary dynamically allocated memory */
 	chap_finish ( &iscsi->chap );
@@ -314,39 +362,40 @@ static void iscsi_close_connection ( struct iscsi_session *iscsi, int rc ) {
 }
 
 /**
- * Mark iSCSI SCSI operation as complete
+ * Mark iSCSI SCSI command as complete
  *
- * @v iscsi		iSCSI session
+ * @v iscsicmd		iSCSI command
  * @v rc		Return status code
  * @v rsp		SCSI response, if any
  *
- * Note that iscsi_scsi_done() will not close the connection, and must
- * therefore be called only when the internal state machines are in an
- * appropriate state, otherwise bad things may happen on the next call
- * to iscsi_scsi_command().  The general rule is to call
- * iscsi_scsi_done() only at the end of receiving a PDU; at this point
- * the TX and RX engines should both be idle.
+ * Note that iscsi_command_done() will not close the connection.
  */
-static void iscsi_scsi_done ( struct iscsi_session *iscsi, int rc,
-			      struct scsi_rsp *rsp ) {
-	uint32_t itt = iscsi->itt;
+static void iscsi_command_done ( struct iscsi_command *iscsicmd, int rc,
+				 struct scsi_rsp *rsp ) {
+	struct iscsi_session *iscsi = iscsicmd->iscsi;
 
-	assert ( iscsi->tx_state == ISCSI_TX_IDLE );
+	DBGC2 ( iscsi, "iSCSI %p tag %08x completed: %s\n",
+		iscsi, iscsicmd->itt, strerror ( rc ) );
+
+	/* Remove from list of outstanding commands */
+	list_del ( &iscsicmd->list );
 
-	/* Clear command */
-	free ( iscsi->command );
-	iscsi->command = NULL;
+	/* Stop transmitting on behalf of this command */
+	if ( iscsi->tx_command == iscsicmd )
+		iscsi->tx_command = NULL;
 
 	/* Send SCSI response, if any */
 	if ( rsp )
-		scsi_response ( &iscsi->data, rsp );
+		scsi_response ( &iscsicmd->data, rsp );
 
-	/* Close SCSI command, if this is still the same command.  (It
-	 * is possible that the command interface has already been
-	 * closed as a result of the SCSI response we sent.)
-	 */
-	if ( iscsi->itt == itt )
-		intf_restart ( &iscsi->data, rc );
+	/* Shut down SCSI command interface */
+	intf_shutdown ( &iscsicmd->data, rc );
+
+	/* Notify SCSI layer that a command slot may now be free */
+	xfer_window_changed ( &iscsi->control );
+
+	/* Drop list's reference to command */
+	ref_put ( &iscsicmd->refcnt );
 }
 
 /****************************************************************************
@@ -367,33 +416,37 @@ static void iscsi_scsi_done ( struct iscsi_session *iscsi, int rc,
  */
 static void iscsi_start_command ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_scsi_command *command = &iscsi->tx_bhs.scsi_command;
+	struct iscsi_command *iscsicmd = iscsi->tx_command;
+	struct scsi_cmd *scsicmd = &iscsicmd->command;
 
-	assert ( ! ( iscsi->command->data_in && iscsi->command->data_out ) );
+	assert ( ! ( scsicmd->data_in && scsicmd->data_out ) );
 
 	/* Construct BHS and initiate transmission */
 	iscsi_start_tx ( iscsi );
 	command->opcode = ISCSI_OPCODE_SCSI_COMMAND;
 	command->flags = ( ISCSI_FLAG_FINAL |
 			   ISCSI_COMMAND_ATTR_SIMPLE );
-	if ( iscsi->command->data_in )
+	if ( scsicmd->data_in )
 		command->flags |= ISCSI_COMMAND_FLAG_READ;
-	if ( iscsi->command->data_out )
+	if ( scsicmd->data_out )
 		command->flags |= ISCSI_COMMAND_FLAG_WRITE;
 	/* lengths left as zero */
-	memcpy ( &command->lun, &iscsi->command->lun,
-		 sizeof ( command->lun ) );
-	command->itt = htonl ( iscsi->itt );
-	command->exp_len = htonl ( iscsi->command->data_in_len |
-				   iscsi->command->data_out_len );
+	memcpy ( &command->lun, &scsicmd->lun, sizeof ( command->lun ) );
+	command->itt = htonl ( iscsicmd->itt );
+	command->exp_len = htonl ( scsicmd->data_in_len |
+				   scsicmd->data_out_len );
 	command->cmdsn = htonl ( iscsi->cmdsn );
 	command->expstatsn = htonl ( iscsi->statsn + 1 );
-	memcpy ( &command->cdb, &iscsi->command->cdb, sizeof ( command->cdb ));
-	DBGC2 ( iscsi, "iSCSI %p start " SCSI_CDB_FORMAT " %s %#zx\n",
-		iscsi, SCSI_CDB_DATA ( command->cdb ),
-		( iscsi->command->data_in ? "in" : "out" ),
-		( iscsi->command->data_in ?
-		  iscsi->command->data_in_len :
-		  iscsi->command->data_out_len ) );
+	memcpy ( &command->cdb, &scsicmd->cdb, sizeof ( command->cdb ) );
+	DBGC2 ( iscsi, "iSCSI %p tag %08x start " SCSI_CDB_FORMAT " %s "
+		"%#zx\n", iscsi, iscsicmd->itt,
+		SCSI_CDB_DATA ( command->cdb ),
+		( scsicmd->data_in ? "in" : "out" ),
+		( scsicmd->data_in ?
+		  scsicmd->data_in_len : scsicmd->data_out_len ) );
+
+	/* Consume command sequence number */
+	iscsi->cmdsn++;
 }
 
 /**
@@ -410,6 +463,7 @@ static int iscsi_rx_scsi_response ( struct iscsi_session *iscsi,
 				    size_t remaining ) {
 	struct iscsi_bhs_scsi_response *response
 		= &iscsi->rx_bhs.scsi_response;
+	struct iscsi_command *iscsicmd;
 	struct scsi_rsp rsp;
 	uint32_t residual_count;
 	size_t data_len;
@@ -444,8 +498,16 @@ static int iscsi_rx_scsi_response ( struct iscsi_session *iscsi,
 	if ( response->response != ISCSI_RESPONSE_COMMAND_COMPLETE )
 		return -EIO;
 
+	/* Locate matching command */
+	iscsicmd = iscsi_find_itt ( iscsi, ntohl ( response->itt ) );
+	if ( ! iscsicmd ) {
+		DBGC ( iscsi, "iSCSI %p response for unknown tag %08x\n",
+		       iscsi, ntohl ( response->itt ) );
+		return 0;
+	}
+
 	/* Mark as completed */
-	iscsi_scsi_done ( iscsi, 0, &rsp );
+	iscsi_command_done ( iscsicmd, 0, &rsp );
 	return 0;
 }
 
@@ -462,14 +524,22 @@ static int iscsi_rx_data_in ( struct iscsi_session *iscsi,
 			      const void *data, size_t len,
 			      size_t remaining ) {
 	struct iscsi_bhs_data_in *data_in = &iscsi->rx_bhs.data_in;
+	struct iscsi_command *iscsicmd;
 	unsigned long offset;
 
+	/* Locate matching command */
+	iscsicmd = iscsi_find_itt ( iscsi, ntohl ( data_in->itt ) );
+	if ( ! iscsicmd ) {
+		DBGC ( iscsi, "iSCSI %p data-in for unknown tag %08x\n",
+		       iscsi, ntohl ( data_in->itt ) );
+		return 0;
+	}
+
 	/* Copy data to data-in buffer */
 	offset = ntohl ( data_in->offset ) + iscsi->rx_offset;
-	assert ( iscsi->command != NULL );
-	assert ( iscsi->command->data_in );
-	assert ( ( offset + len ) <= iscsi->command->data_in_len );
-	copy_to_user ( iscsi->command->data_in, offset, data, len );
+	assert ( iscsicmd->command.data_in );
+	assert ( ( offset + len ) <= iscsicmd->command.data_in_len );
+	copy_to_user ( iscsicmd->command.data_in, offset, data, len );
 
 	/* Wait for whole SCSI response to arrive */
 	if ( remaining )
@@ -477,10 +547,10 @@ static int iscsi_rx_data_in ( struct iscsi_session *iscsi,
 
 	/* Mark as completed if status is present */
 	if ( data_in->flags & ISCSI_DATA_FLAG_STATUS ) {
-		assert ( ( offset + len ) == iscsi->command->data_in_len );
+		assert ( ( offset + len ) == iscsicmd->command.data_in_len );
 		assert ( data_in->flags & ISCSI_FLAG_FINAL );
 		/* iSCSI cannot return an error status via a data-in */
-		iscsi_scsi_done ( iscsi, 0, NULL );
+		iscsi_command_done ( iscsicmd, 0, NULL );
 	}
 
 	return 0;
@@ -499,12 +569,28 @@ static int iscsi_rx_r2t ( struct iscsi_session *iscsi,
 			  const void *data __unused, size_t len __unused,
 			  size_t remaining __unused ) {
 	struct iscsi_bhs_r2t *r2t = &iscsi->rx_bhs.r2t;
+	struct iscsi_command *iscsicmd;
 
-	/* Record transfer parameters and trigger first data-out */
-	iscsi->ttt = ntohl ( r2t->ttt );
-	iscsi->transfer_offset = ntohl ( r2t->offset );
-	iscsi->transfer_len = ntohl ( r2t->len );
-	iscsi_start_data_out ( iscsi, 0 );
+	/* Locate matching command */
+	iscsicmd = iscsi_find_itt ( iscsi, ntohl ( r2t->itt ) );
+	if ( ! iscsicmd ) {
+		DBGC ( iscsi, "iSCSI %p R2T for unknown tag %08x\n",
+		       iscsi, ntohl ( r2t->itt ) );
+		return 0;
+	}
+
+	/* Record transfer parameters */
+	iscsicmd->ttt = ntohl ( r2t->ttt );
+	iscsicmd->transfer_offset = ntohl ( r2t->offset );
+	iscsicmd->transfer_len = ntohl ( r2t->len );
+
+	/* Trigger first data-out now if possible, otherwise queue */
+	if ( iscsi->tx_state == ISCSI_TX_IDLE ) {
+		iscsi->tx_command = iscsicmd;
+		iscsi_start_data_out ( iscsi, 0 );
+	} else {
+		iscsicmd->r2t_pending = 1;
+	}
 
 	return 0;
 }
@@ -519,6 +605,7 @@ static int iscsi_rx_r2t ( struct iscsi_session *iscsi,
 static void iscsi_start_data_out ( struct iscsi_session *iscsi,
 				   unsigned int datasn ) {
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+	struct iscsi_command *iscsicmd = iscsi->tx_command;
 	unsigned long offset;
 	unsigned long remaining;
 	unsigned long len;
@@ -527,7 +614,7 @@ static void iscsi_start_data_out ( struct iscsi_session *iscsi,
 	 * need to worry about the target's MaxRecvDataSegmentLength.
 	 */
 	offset = datasn * 512;
-	remaining = iscsi->transfer_len - offset;
+	remaining = iscsicmd->transfer_len - offset;
 	len = remaining;
 	if ( len > 512 )
 		len = 512;
@@ -538,14 +625,14 @@ static void iscsi_start_data_out ( struct iscsi_session *iscsi,
 	if ( len == remaining )
 		data_out->flags = ( ISCSI_FLAG_FINAL );
 	ISCSI_SET_LENGTHS ( data_out->lengths, 0, len );
-	data_out->lun = iscsi->command->lun;
-	data_out->itt = htonl ( iscsi->itt );
-	data_out->ttt = htonl ( iscsi->ttt );
+	data_out->lun = iscsicmd->command.lun;
+	data_out->itt = htonl ( iscsicmd->itt );
+	data_out->ttt = htonl ( iscsicmd->ttt );
 	data_out->expstatsn = htonl ( iscsi->statsn + 1 );
 	data_out->datasn = htonl ( datasn );
-	data_out->offset = htonl ( iscsi->transfer_offset + offset );
-	DBGC ( iscsi, "iSCSI %p start data out DataSN %#x len %#lx\n",
-	       iscsi, datasn, len );
+	data_out->offset = htonl ( iscsicmd->transfer_offset + offset );
+	DBGC ( iscsi, "iSCSI %p tag %08x start data out DataSN %#x len "
+	       "%#lx\n", iscsi, iscsicmd->itt, datasn, len );
 }
 
 /**
@@ -557,11 +644,53 @@ static void iscsi_start_data_out ( struct iscsi_session *iscsi,
 static void iscsi_data_out_done ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
 
-	/* If we haven't reached the end of the sequence, start
+	/* If we haven't reached the end of the sequence (and the
+	 * command has not been completed in the meantime), start
 	 * sending the next data-out PDU.
 	 */
-	if ( ! ( data_out->flags & ISCSI_FLAG_FINAL ) )
+	if ( ( ! ( data_out->flags & ISCSI_FLAG_FINAL ) ) &&
+	     ( iscsi->tx_command != NULL ) ) {
 		iscsi_start_data_out ( iscsi, ntohl ( data_out->datasn ) + 1 );
+	}
+}
+
+/**
+ * Start transmission on behalf of the next queued command, if any
+ *
+ * @v iscsi		iSCSI session
+ *
+ * Services any pending R2T data-out sequences first, then issues any
+ * commands which have not yet been transmitted.
+ */
+static void iscsi_start_next ( struct iscsi_session *iscsi ) {
+	struct iscsi_command *iscsicmd;
+
+	assert ( iscsi->tx_state == ISCSI_TX_IDLE );
+
+	/* Commands may be transmitted only in the full feature phase */
+	if ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) !=
+	     ISCSI_STATUS_FULL_FEATURE_PHASE )
+		return;
+
+	/* Service pending R2Ts first */
+	list_for_each_entry ( iscsicmd, &iscsi->commands, list ) {
+		if ( iscsicmd->r2t_pending ) {
+			iscsicmd->r2t_pending = 0;
+			iscsi->tx_command = iscsicmd;
+			iscsi_start_data_out ( iscsi, 0 );
+			return;
+		}
+	}
+
+	/* Issue any commands not yet transmitted */
+	list_for_each_entry ( iscsicmd, &iscsi->commands, list ) {
+		if ( ! iscsicmd->started ) {
+			iscsicmd->started = 1;
+			iscsi->tx_command = iscsicmd;
+			iscsi_start_command ( iscsi );
+			return;
+		}
+	}
 }
 
 /**
@@ -572,6 +701,7 @@ static void iscsi_data_out_done ( struct iscsi_session *iscsi ) {
  */
 static int iscsi_tx_data_out ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+	struct iscsi_command *iscsicmd = iscsi->tx_command;
 	struct io_buffer *iobuf;
 	unsigned long offset;
 	size_t len;
@@ -581,18 +711,26 @@ static int iscsi_tx_data_out ( struct iscsi_session *iscsi ) {
 	len = ISCSI_DATA_LEN ( data_out->lengths );
 	pad_len = ISCSI_DATA_PAD_LEN ( data_out->lengths );
 
-	assert ( iscsi->command != NULL );
-	assert ( iscsi->command->data_out );
-	assert ( ( offset + len ) <= iscsi->command->data_out_len );
+	assert ( iscsicmd != NULL );
+	assert ( iscsicmd->command.data_out );
+	assert ( ( offset + len ) <= iscsicmd->command.data_out_len );
 
 	iobuf = xfer_alloc_iob ( &iscsi->socket, ( len + pad_len ) );
 	if ( ! iobuf )
 		return -ENOMEM;
-	
+
 	copy_from_user ( iob_put ( iobuf, len ),
-			 iscsi->command->data_out, offset, len );
+			 iscsicmd->command.data_out, offset, len );
 	memset ( iob_put ( iobuf, pad_len ), 0, pad_len );
 
+	/* Calculate data digest (covering data and padding), if enabled */
+	if ( iscsi->data_digest ) {
+		iscsi->tx_digest =
+			cpu_to_le32 ( ~crc32c ( ~( ( uint32_t ) 0 ),
+						iobuf->data,
+						iob_len ( iobuf ) ) );
+	}
+
 	return xfer_deliver_iob ( &iscsi->socket, iobuf );
 }
 
@@ -642,8 +780,8 @@ static int iscsi_rx_nop_in ( struct iscsi_session *iscsi,
  * These are the initial set of strings sent in the first login
  * request PDU.  We want the following settings:
  *
- *     HeaderDigest=None
- *     DataDigest=None
+ *     HeaderDigest=None,CRC32C [6]
+ *     DataDigest=None,CRC32C [6]
  *     MaxConnections=1 (irrelevant; we make only one connection anyway) [4]
  *     InitialR2T=Yes [1]
  *     ImmediateData=No (irrelevant; we never send immediate data) [4]
@@ -679,6 +817,9 @@ static int iscsi_rx_nop_in ( struct iscsi_session *iscsi,
  * force InitialR2T=Yes and ImmediateData=No, but some targets
  * (notably LIO as of kernel 4.11) fail unless it is specified, so we
  * explicitly specify the default value.
+ *
+ * [6] We prefer to avoid the overhead of digests, but offer CRC32C
+ * so that targets which mandate digest protection can still be used.
  */
 static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 					       void *data, size_t len ) {
@@ -730,8 +871,8 @@ static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 
 	if ( iscsi->status & ISCSI_STATUS_STRINGS_OPERATIONAL ) {
 		used += ssnprintf ( data + used, len - used,
-				    "HeaderDigest=None%c"
-				    "DataDigest=None%c"
+				    "HeaderDigest=None,CRC32C%c"
+				    "DataDigest=None,CRC32C%c"
 				    "MaxConnections=1%c"
 				    "InitialR2T=Yes%c"
 				    "ImmediateData=No%c"
@@ -1097,6 +1238,42 @@ static int iscsi_handle_chap_r_value ( struct iscsi_session *iscsi,
 	return 0;
 }
 
+/**
+ * Handle iSCSI HeaderDigest text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		HeaderDigest value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_headerdigest_value ( struct iscsi_session *iscsi,
+					     const char *value ) {
+
+	/* Anything other than an agreed CRC32C means no digest */
+	iscsi->header_digest = ( strcmp ( value, "CRC32C" ) == 0 );
+	DBGC ( iscsi, "iSCSI %p header digest %s\n",
+	       iscsi, ( iscsi->header_digest ? "CRC32C" : "disabled" ) );
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI DataDigest text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		DataDigest value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_datadigest_value ( struct iscsi_session *iscsi,
+					   const char *value ) {
+
+	/* Anything other than an agreed CRC32C means no digest */
+	iscsi->data_digest = ( strcmp ( value, "CRC32C" ) == 0 );
+	DBGC ( iscsi, "iSCSI %p data digest %s\n",
+	       iscsi, ( iscsi->data_digest ? "CRC32C" : "disabled" ) );
+
+	return 0;
+}
+
 /** An iSCSI text string that we want to handle */
 struct iscsi_string_type {
 	/** String key
@@ -1123,6 +1300,8 @@ static struct iscsi_string_type iscsi_string_types[] = {
 	{ "CHAP_C", iscsi_handle_chap_c_value },
 	{ "CHAP_N", iscsi_handle_chap_n_value },
 	{ "CHAP_R", iscsi_handle_chap_r_value },
+	{ "HeaderDigest", iscsi_handle_headerdigest_value },
+	{ "DataDigest", iscsi_handle_datadigest_value },
 	{ NULL, NULL }
 };
 
@@ -1332,6 +1511,10 @@ static int iscsi_rx_login_response ( struct iscsi_session *iscsi,
 	DBGC ( iscsi, "iSCSI %p entering full feature phase\n", iscsi );
 	xfer_window_changed ( &iscsi->control );
 
+	/* Reissue any commands outstanding from before a reconnection */
+	if ( iscsi->tx_state == ISCSI_TX_IDLE )
+		iscsi_start_next ( iscsi );
+
 	return 0;
 }
 
@@ -1402,6 +1585,51 @@ static int iscsi_tx_bhs ( struct iscsi_session *iscsi ) {
 				  sizeof ( iscsi->tx_bhs ) );
 }
 
+/**
+ * Check whether or not digests apply to a PDU
+ *
+ * @v opcode		PDU opcode
+ * @ret digested	Digests apply to this PDU
+ *
+ * Digests are negotiated during the login phase but never protect
+ * login PDUs themselves.
+ */
+static int iscsi_pdu_digested ( unsigned int opcode ) {
+	opcode &= ISCSI_OPCODE_MASK;
+	return ( ( opcode != ISCSI_OPCODE_LOGIN_REQUEST ) &&
+		 ( opcode != ISCSI_OPCODE_LOGIN_RESPONSE ) );
+}
+
+/**
+ * Transmit header digest of an iSCSI PDU
+ *
+ * @v iscsi		iSCSI session
+ * @ret rc		Return status code
+ */
+static int iscsi_tx_header_digest ( struct iscsi_session *iscsi ) {
+	uint32_t digest;
+
+	/* We never send an AHS, so the digest covers only the BHS */
+	digest = cpu_to_le32 ( ~crc32c ( ~( ( uint32_t ) 0 ), &iscsi->tx_bhs,
+					 sizeof ( iscsi->tx_bhs ) ) );
+	return xfer_deliver_raw ( &iscsi->socket, &digest,
+				  sizeof ( digest ) );
+}
+
+/**
+ * Transmit data digest of an iSCSI PDU
+ *
+ * @v iscsi		iSCSI session
+ * @ret rc		Return status code
+ *
+ * The digest is calculated over the data segment (including padding)
+ * as it is constructed, and stored in iscsi::tx_digest.
+ */
+static int iscsi_tx_data_digest ( struct iscsi_session *iscsi ) {
+	return xfer_deliver_raw ( &iscsi->socket, &iscsi->tx_digest,
+				  sizeof ( iscsi->tx_digest ) );
+}
+
 /**
  * Transmit data segment of an iSCSI PDU
  *
@@ -1451,6 +1679,10 @@ static void iscsi_tx_done ( struct iscsi_session *iscsi ) {
 		/* No action */
 		break;
 	}
+
+	/* Start transmitting on behalf of the next command, if idle */
+	if ( iscsi->tx_state == ISCSI_TX_IDLE )
+		iscsi_start_next ( iscsi );
 }
 
 /**
@@ -1480,11 +1712,34 @@ static void iscsi_tx_step ( struct iscsi_session *iscsi ) {
 		case ISCSI_TX_AHS:
 			tx = iscsi_tx_nothing;
 			tx_len = 0;
+			next_state = ISCSI_TX_HEADER_DIGEST;
+			break;
+		case ISCSI_TX_HEADER_DIGEST:
+			if ( iscsi->header_digest &&
+			     iscsi_pdu_digested ( common->opcode ) ) {
+				tx = iscsi_tx_header_digest;
+				tx_len = ISCSI_DIGEST_LEN;
+			} else {
+				tx = iscsi_tx_nothing;
+				tx_len = 0;
+			}
 			next_state = ISCSI_TX_DATA;
 			break;
 		case ISCSI_TX_DATA:
 			tx = iscsi_tx_data;
 			tx_len = ISCSI_DATA_LEN ( common->lengths );
+			next_state = ISCSI_TX_DATA_DIGEST;
+			break;
+		case ISCSI_TX_DATA_DIGEST:
+			if ( iscsi->data_digest &&
+			     iscsi_pdu_digested ( common->opcode ) &&
+			     ISCSI_DATA_LEN ( common->lengths ) ) {
+				tx = iscsi_tx_data_digest;
+				tx_len = ISCSI_DIGEST_LEN;
+			} else {
+				tx = iscsi_tx_nothing;
+				tx_len = 0;
+			}
 			next_state = ISCSI_TX_IDLE;
 			break;
 		case ISCSI_TX_IDLE:
@@ -1570,6 +1825,42 @@ static int iscsi_rx_discard ( struct iscsi_session *iscsi __unused,
 	return 0;
 }
 
+/**
+ * Receive and verify a digest of an iSCSI PDU
+ *
+ * @v iscsi		iSCSI session
+ * @v data		Received data
+ * @v len		Length of received data
+ * @v remaining		Data remaining after this data
+ * @ret rc		Return status code
+ *
+ * This accumulates the received digest word and, once complete,
+ * compares it against the running digest calculated over the
+ * protected portion of the PDU.
+ */
+static int iscsi_rx_digest ( struct iscsi_session *iscsi, const void *data,
+			     size_t len, size_t remaining ) {
+	uint32_t expected;
+
+	/* Accumulate received digest */
+	memcpy ( ( ( ( void * ) &iscsi->rx_digest_wire ) +
+		   iscsi->rx_offset ), data, len );
+	if ( remaining )
+		return 0;
+
+	/* Verify digest */
+	expected = cpu_to_le32 ( ~iscsi->rx_digest );
+	if ( iscsi->rx_digest_wire != expected ) {
+		DBGC ( iscsi, "iSCSI %p invalid digest %08x (expected "
+		       "%08x)\n", iscsi,
+		       le32_to_cpu ( iscsi->rx_digest_wire ),
+		       le32_to_cpu ( expected ) );
+		return -EPROTO_INVALID_DIGEST;
+	}
+
+	return 0;
+}
+
 /**
  * Receive data segment of an iSCSI PDU
  *
@@ -1587,8 +1878,14 @@ static int iscsi_rx_data ( struct iscsi_session *iscsi, const void *data,
 	struct iscsi_bhs_common_response *response
 		= &iscsi->rx_bhs.common_response;
 
-	/* Update cmdsn and statsn */
-	iscsi->cmdsn = ntohl ( response->expcmdsn );
+	/* Update statsn, and resynchronise cmdsn with the target's
+	 * ExpCmdSN.  We cannot blindly adopt ExpCmdSN while commands
+	 * are outstanding, since a response to an earlier command may
+	 * arrive after we have already consumed later sequence
+	 * numbers.
+	 */
+	if ( list_empty ( &iscsi->commands ) )
+		iscsi->cmdsn = ntohl ( response->expcmdsn );
 	iscsi->statsn = ntohl ( response->statsn );
 
 	switch ( response->opcode & ISCSI_OPCODE_MASK ) {
@@ -1647,6 +1944,14 @@ static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 		case ISCSI_RX_AHS:
 			rx = iscsi_rx_discard;
 			iscsi->rx_len = 4 * ISCSI_AHS_LEN ( common->lengths );
+			next_state = ISCSI_RX_HEADER_DIGEST;
+			break;
+		case ISCSI_RX_HEADER_DIGEST:
+			rx = iscsi_rx_digest;
+			iscsi->rx_len =
+				( ( iscsi->header_digest &&
+				    iscsi_pdu_digested ( common->opcode ) ) ?
+				  ISCSI_DIGEST_LEN : 0 );
 			next_state = ISCSI_RX_DATA;
 			break;
 		case ISCSI_RX_DATA:
@@ -1657,6 +1962,15 @@ static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 		case ISCSI_RX_DATA_PADDING:
 			rx = iscsi_rx_discard;
 			iscsi->rx_len = ISCSI_DATA_PAD_LEN ( common->lengths );
+			next_state = ISCSI_RX_DATA_DIGEST;
+			break;
+		case ISCSI_RX_DATA_DIGEST:
+			rx = iscsi_rx_digest;
+			iscsi->rx_len =
+				( ( iscsi->data_digest &&
+				    iscsi_pdu_digested ( common->opcode ) &&
+				    ISCSI_DATA_LEN ( common->lengths ) ) ?
+				  ISCSI_DIGEST_LEN : 0 );
 			next_state = ISCSI_RX_BHS;
 			break;
 		default:
@@ -1669,6 +1983,30 @@ static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 		if ( frag_len > iob_len ( iobuf ) )
 			frag_len = iob_len ( iobuf );
 		remaining = iscsi->rx_len - iscsi->rx_offset - frag_len;
+
+		/* Update running digest over the protected portions
+		 * of the PDU (BHS plus AHS for the header digest,
+		 * data plus padding for the data digest), if enabled.
+		 */
+		if ( iscsi->header_digest &&
+		     ( ( iscsi->rx_state == ISCSI_RX_BHS ) ||
+		       ( iscsi->rx_state == ISCSI_RX_AHS ) ) ) {
+			if ( ( iscsi->rx_state == ISCSI_RX_BHS ) &&
+			     ( iscsi->rx_offset == 0 ) )
+				iscsi->rx_digest = ~( ( uint32_t ) 0 );
+			iscsi->rx_digest = crc32c ( iscsi->rx_digest,
+						    iobuf->data, frag_len );
+		}
+		if ( iscsi->data_digest &&
+		     ( ( iscsi->rx_state == ISCSI_RX_DATA ) ||
+		       ( iscsi->rx_state == ISCSI_RX_DATA_PADDING ) ) ) {
+			if ( ( iscsi->rx_state == ISCSI_RX_DATA ) &&
+			     ( iscsi->rx_offset == 0 ) )
+				iscsi->rx_digest = ~( ( uint32_t ) 0 );
+			iscsi->rx_digest = crc32c ( iscsi->rx_digest,
+						    iobuf->data, frag_len );
+		}
+
 		if ( ( rc = rx ( iscsi, iobuf->data, frag_len,
 				 remaining ) ) != 0 ) {
 			DBGC ( iscsi, "iSCSI %p could not process received "
@@ -1767,15 +2105,32 @@ static struct interface_descriptor iscsi_socket_desc =
  * @ret len		Length of window
  */
 static size_t iscsi_scsi_window ( struct iscsi_session *iscsi ) {
+	struct iscsi_command *iscsicmd;
+	unsigned int count = 0;
 
-	if ( ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) ==
-	       ISCSI_STATUS_FULL_FEATURE_PHASE ) &&
-	     ( iscsi->command == NULL ) ) {
-		/* We cannot handle concurrent commands */
-		return 1;
-	} else {
+	/* Commands may not be issued before login is complete */
+	if ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) !=
+	     ISCSI_STATUS_FULL_FEATURE_PHASE )
 		return 0;
-	}
+
+	/* Count outstanding commands */
+	list_for_each_entry ( iscsicmd, &iscsi->commands, list )
+		count++;
+
+	return ( ( count < ISCSI_MAX_COMMANDS ) ? 1 : 0 );
+}
+
+/**
+ * Free iSCSI command
+ *
+ * @v refcnt		Reference count
+ */
+static void iscsi_command_free ( struct refcnt *refcnt ) {
+	struct iscsi_command *iscsicmd =
+		container_of ( refcnt, struct iscsi_command, refcnt );
+
+	ref_put ( &iscsicmd->iscsi->refcnt );
+	free ( iscsicmd );
 }
 
 /**
@@ -1789,31 +2144,40 @@ static size_t iscsi_scsi_window ( struct iscsi_session *iscsi ) {
 static int iscsi_scsi_command ( struct iscsi_session *iscsi,
 				struct interface *parent,
 				struct scsi_cmd *command ) {
+	struct iscsi_command *iscsicmd;
 
-	/* This iSCSI implementation cannot handle multiple concurrent
-	 * commands or commands arriving before login is complete.
+	/* Refuse commands arriving before login is complete, or
+	 * beyond our queue depth.
 	 */
 	if ( iscsi_scsi_window ( iscsi ) == 0 ) {
-		DBGC ( iscsi, "iSCSI %p cannot handle concurrent commands\n",
-		       iscsi );
+		DBGC ( iscsi, "iSCSI %p cannot accept new command\n", iscsi );
 		return -EOPNOTSUPP;
 	}
 
-	/* Store command */
-	iscsi->command = malloc ( sizeof ( *command ) );
-	if ( ! iscsi->command )
+	/* Allocate and initialise command */
+	iscsicmd = zalloc ( sizeof ( *iscsicmd ) );
+	if ( ! iscsicmd )
 		return -ENOMEM;
-	memcpy ( iscsi->command, command, sizeof ( *command ) );
-
-	/* Assign new ITT */
-	iscsi_new_itt ( iscsi );
+	ref_init ( &iscsicmd->refcnt, iscsi_command_free );
+	intf_init ( &iscsicmd->data, &iscsi_command_desc,
+		    &iscsicmd->refcnt );
+	ref_get ( &iscsi->refcnt );
+	iscsicmd->iscsi = iscsi;
+	memcpy ( &iscsicmd->command, command, sizeof ( iscsicmd->command ) );
+	iscsicmd->itt = iscsi_new_itt();
+
+	/* Add to list of outstanding commands; the list holds a
+	 * reference, released in iscsi_command_done().
+	 */
+	list_add_tail ( &iscsicmd->list, &iscsi->commands );
 
-	/* Start sending command */
-	iscsi_start_command ( iscsi );
+	/* Start sending command if the TX engine is idle */
+	if ( iscsi->tx_state == ISCSI_TX_IDLE )
+		iscsi_start_next ( iscsi );
 
 	/* Attach to parent interface and return */
-	intf_plug_plug ( &iscsi->data, parent );
-	return iscsi->itt;
+	intf_plug_plug ( &iscsicmd->data, parent );
+	return iscsicmd->itt;
 }
 
 /**
@@ -1842,29 +2206,29 @@ static struct interface_descriptor iscsi_control_desc =
 /**
  * Close iSCSI command
  *
- * @v iscsi		iSCSI session
+ * @v iscsicmd		iSCSI command
  * @v rc		Reason for close
  */
-static void iscsi_command_close ( struct iscsi_session *iscsi, int rc ) {
+static void iscsi_command_close ( struct iscsi_command *iscsicmd, int rc ) {
+	struct iscsi_session *iscsi = iscsicmd->iscsi;
 
-	/* Restart interface */
-	intf_restart ( &iscsi->data, rc );
+	/* Complete command */
+	iscsi_command_done ( iscsicmd, rc, NULL );
 
 	/* Treat unsolicited command closures mid-command as fatal,
 	 * because we have no code to handle partially-completed PDUs.
 	 */
-	if ( iscsi->command != NULL )
-		iscsi_close ( iscsi, ( ( rc == 0 ) ? -ECANCELED : rc ) );
+	iscsi_close ( iscsi, ( ( rc == 0 ) ? -ECANCELED : rc ) );
 }
 
 /** iSCSI SCSI command interface operations */
-static struct interface_operation iscsi_data_op[] = {
-	INTF_OP ( intf_close, struct iscsi_session *, iscsi_command_close ),
+static struct interface_operation iscsi_command_op[] = {
+	INTF_OP ( intf_close, struct iscsi_command *, iscsi_command_close ),
 };
 
 /** iSCSI SCSI command interface descriptor */
-static struct interface_descriptor iscsi_data_desc =
-	INTF_DESC ( struct iscsi_session, data, iscsi_data_op );
+static struct interface_descriptor iscsi_command_desc =
+	INTF_DESC ( struct iscsi_command, data, iscsi_command_op );
 
 /****************************************************************************
  *
@@ -2082,8 +2446,8 @@ static int iscsi_open ( struct interface *parent, struct uri *uri ) {
 	}
 	ref_init ( &iscsi->refcnt, iscsi_free );
 	intf_init ( &iscsi->control, &iscsi_control_desc, &iscsi->refcnt );
-	intf_init ( &iscsi->data, &iscsi_data_desc, &iscsi->refcnt );
 	intf_init ( &iscsi->socket, &iscsi_socket_desc, &iscsi->refcnt );
+	INIT_LIST_HEAD ( &iscsi->commands );
 	process_init_stopped ( &iscsi->process, &iscsi_process_desc,
 			       &iscsi->refcnt );
 	acpi_init ( &iscsi->desc, &ibft_model, &iscsi->refcnt );
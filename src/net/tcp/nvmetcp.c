@@ -0,0 +1,1603 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * NVMe over TCP protocol
+ *
+ * The NVMe/TCP transport maps NVMe queue pairs onto TCP connections:
+ * one connection for the admin queue and one for the I/O queue.  Each
+ * connection carries a stream of PDUs (command capsules, response
+ * capsules, and data transfers), optionally protected by CRC32C
+ * digests.
+ *
+ * Session establishment connects the admin queue, enables the
+ * controller, identifies the boot namespace to determine capacity,
+ * and then connects the I/O queue.  Block device commands are mapped
+ * directly onto NVMe Read and Write commands with transport SGLs;
+ * read data arrives in controller-to-host data PDUs and write data is
+ * sent in host-to-controller data PDUs in response to ready-to-
+ * transfer PDUs.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <byteswap.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/list.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/open.h>
+#include <ipxe/uri.h>
+#include <ipxe/socket.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/features.h>
+#include <ipxe/blockdev.h>
+#include <ipxe/crc32c.h>
+#include <ipxe/nvmetcp.h>
+
+FEATURE ( FEATURE_PROTOCOL, "NVMeTCP", DHCP_EB_FEATURE_NVMETCP, 1 );
+
+/* Disambiguate the various error causes */
+#define EPROTO_INVALID_PDU __einfo_error ( EINFO_EPROTO_INVALID_PDU )
+#define EINFO_EPROTO_INVALID_PDU					\
+	__einfo_uniqify ( EINFO_EPROTO, 0x01, "Invalid PDU" )
+#define EPROTO_INVALID_DIGEST __einfo_error ( EINFO_EPROTO_INVALID_DIGEST )
+#define EINFO_EPROTO_INVALID_DIGEST					\
+	__einfo_uniqify ( EINFO_EPROTO, 0x02, "Invalid digest" )
+#define EPROTO_TERMINATED __einfo_error ( EINFO_EPROTO_TERMINATED )
+#define EINFO_EPROTO_TERMINATED						\
+	__einfo_uniqify ( EINFO_EPROTO, 0x03,				\
+			  "Connection terminated by controller" )
+#define EIO_COMMAND_STATUS __einfo_error ( EINFO_EIO_COMMAND_STATUS )
+#define EINFO_EIO_COMMAND_STATUS					\
+	__einfo_uniqify ( EINFO_EIO, 0x01, "Command failed" )
+#define ETIMEDOUT_READY __einfo_error ( EINFO_ETIMEDOUT_READY )
+#define EINFO_ETIMEDOUT_READY						\
+	__einfo_uniqify ( EINFO_ETIMEDOUT, 0x01,			\
+			  "Controller failed to become ready" )
+
+static void nvmetcp_close ( struct nvmetcp_session *nvmetcp, int rc );
+static void nvmetcp_start_next ( struct nvmetcp_session *nvmetcp );
+
+/**
+ * Calculate PDU digest
+ *
+ * @v data		Data to digest
+ * @v len		Length of data
+ * @ret dgst		Digest (in wire format)
+ */
+static uint32_t nvmetcp_digest ( const void *data, size_t len ) {
+	return cpu_to_le32 ( ~crc32c ( 0xffffffffUL, data, len ) );
+}
+
+/**
+ * Free NVMe/TCP session
+ *
+ * @v refcnt		Reference count
+ */
+static void nvmetcp_free ( struct refcnt *refcnt ) {
+	struct nvmetcp_session *nvmetcp =
+		container_of ( refcnt, struct nvmetcp_session, refcnt );
+
+	assert ( list_empty ( &nvmetcp->commands ) );
+
+	uri_put ( nvmetcp->uri );
+	free ( nvmetcp->subnqn );
+	free ( nvmetcp->identify );
+	free ( nvmetcp );
+}
+
+/**
+ * Get reference to NVMe/TCP session
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @ret nvmetcp		NVMe/TCP session
+ */
+static inline __attribute__ (( always_inline )) struct nvmetcp_session *
+nvmetcp_get ( struct nvmetcp_session *nvmetcp ) {
+	ref_get ( &nvmetcp->refcnt );
+	return nvmetcp;
+}
+
+/**
+ * Drop reference to NVMe/TCP session
+ *
+ * @v nvmetcp		NVMe/TCP session
+ */
+static inline __attribute__ (( always_inline )) void
+nvmetcp_put ( struct nvmetcp_session *nvmetcp ) {
+	ref_put ( &nvmetcp->refcnt );
+}
+
+/****************************************************************************
+ *
+ * Commands
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Free NVMe/TCP command
+ *
+ * @v refcnt		Reference count
+ */
+static void nvmetcp_command_free ( struct refcnt *refcnt ) {
+	struct nvmetcp_command *cmd =
+		container_of ( refcnt, struct nvmetcp_command, refcnt );
+
+	assert ( list_empty ( &cmd->list ) );
+
+	nvmetcp_put ( cmd->nvmetcp );
+	free ( cmd );
+}
+
+/**
+ * Close NVMe/TCP command
+ *
+ * @v cmd		NVMe/TCP command
+ * @v rc		Reason for close
+ */
+static void nvmetcp_command_close ( struct nvmetcp_command *cmd, int rc ) {
+	struct nvmetcp_session *nvmetcp = cmd->nvmetcp;
+
+	if ( rc != 0 ) {
+		DBGC ( nvmetcp, "NVMETCP %p CID %#04x closed: %s\n",
+		       nvmetcp, cmd->cid, strerror ( rc ) );
+	}
+
+	/* Remove from list of commands */
+	if ( ! list_empty ( &cmd->list ) ) {
+		list_del ( &cmd->list );
+		INIT_LIST_HEAD ( &cmd->list );
+		ref_put ( &cmd->refcnt );
+	}
+
+	/* Shut down interfaces */
+	intf_shutdown ( &cmd->block, rc );
+}
+
+/**
+ * Identify NVMe/TCP command by CID
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v cid		Command identifier
+ * @ret cmd		Command, or NULL
+ */
+static struct nvmetcp_command *
+nvmetcp_find_cid ( struct nvmetcp_session *nvmetcp, uint16_t cid ) {
+	struct nvmetcp_command *cmd;
+
+	list_for_each_entry ( cmd, &nvmetcp->commands, list ) {
+		if ( cmd->issued && ( cmd->cid == cid ) )
+			return cmd;
+	}
+	return NULL;
+}
+
+/****************************************************************************
+ *
+ * PDU transmission
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Transmit initialise connection request
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_icreq ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct io_buffer *iobuf;
+	struct nvmetcp_icreq *icreq;
+	int rc;
+
+	/* Allocate I/O buffer */
+	iobuf = xfer_alloc_iob ( &queue->socket, sizeof ( *icreq ) );
+	if ( ! iobuf )
+		return -ENOMEM;
+
+	/* Construct initialise connection request */
+	icreq = iob_put ( iobuf, sizeof ( *icreq ) );
+	memset ( icreq, 0, sizeof ( *icreq ) );
+	icreq->header.type = NVMETCP_ICREQ;
+	icreq->header.hlen = sizeof ( *icreq );
+	icreq->header.plen = cpu_to_le32 ( sizeof ( *icreq ) );
+	icreq->pfv = cpu_to_le16 ( 0 );
+	icreq->hpda = 0;
+	icreq->dgst = ( NVMETCP_DGST_HDGST | NVMETCP_DGST_DDGST );
+	icreq->maxr2t = cpu_to_le32 ( 0 );
+
+	DBGC2 ( nvmetcp, "NVMETCP %p QID %d ICREQ\n", nvmetcp, queue->qid );
+
+	/* Send initialise connection request */
+	if ( ( rc = xfer_deliver_iob ( &queue->socket, iobuf ) ) != 0 ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d could not send ICREQ: %s\n",
+		       nvmetcp, queue->qid, strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Transmit command capsule
+ *
+ * @v queue		NVMe/TCP queue
+ * @v sqe		Submission queue entry
+ * @v data		In-capsule data (or NULL)
+ * @v data_len		Length of in-capsule data
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_cmd ( struct nvmetcp_queue *queue,
+			    const union nvmetcp_sqe *sqe,
+			    const void *data, size_t data_len ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct io_buffer *iobuf;
+	struct nvmetcp_header *header;
+	size_t hdgst_len = ( queue->hdgst ? NVMETCP_DIGEST_LEN : 0 );
+	size_t ddgst_len = ( ( queue->ddgst && data_len ) ?
+			     NVMETCP_DIGEST_LEN : 0 );
+	size_t pdo = 0;
+	size_t pad = 0;
+	size_t plen;
+	uint32_t dgst;
+	int rc;
+
+	/* Calculate PDU data offset, if applicable */
+	if ( data_len ) {
+		pdo = ( NVMETCP_CMD_LEN + hdgst_len );
+		if ( pdo % queue->cpda )
+			pad = ( queue->cpda - ( pdo % queue->cpda ) );
+		pdo += pad;
+	}
+	plen = ( data_len ? ( pdo + data_len + ddgst_len ) :
+		 ( NVMETCP_CMD_LEN + hdgst_len ) );
+
+	/* Allocate I/O buffer */
+	iobuf = xfer_alloc_iob ( &queue->socket, plen );
+	if ( ! iobuf )
+		return -ENOMEM;
+
+	/* Construct command capsule */
+	header = iob_put ( iobuf, sizeof ( *header ) );
+	memset ( header, 0, sizeof ( *header ) );
+	header->type = NVMETCP_CMD;
+	header->flags = ( ( queue->hdgst ? NVMETCP_FLAG_HDGST : 0 ) |
+			  ( ddgst_len ? NVMETCP_FLAG_DDGST : 0 ) );
+	header->hlen = NVMETCP_CMD_LEN;
+	header->pdo = pdo;
+	header->plen = cpu_to_le32 ( plen );
+	memcpy ( iob_put ( iobuf, sizeof ( *sqe ) ), sqe, sizeof ( *sqe ) );
+
+	/* Append header digest, if applicable */
+	if ( hdgst_len ) {
+		dgst = nvmetcp_digest ( iobuf->data, NVMETCP_CMD_LEN );
+		memcpy ( iob_put ( iobuf, sizeof ( dgst ) ), &dgst,
+			 sizeof ( dgst ) );
+	}
+
+	/* Append in-capsule data, if applicable */
+	if ( data_len ) {
+		memset ( iob_put ( iobuf, pad ), 0, pad );
+		memcpy ( iob_put ( iobuf, data_len ), data, data_len );
+		if ( ddgst_len ) {
+			dgst = nvmetcp_digest ( data, data_len );
+			memcpy ( iob_put ( iobuf, sizeof ( dgst ) ), &dgst,
+				 sizeof ( dgst ) );
+		}
+	}
+
+	/* Send command capsule */
+	if ( ( rc = xfer_deliver_iob ( &queue->socket, iobuf ) ) != 0 ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d could not send command: "
+		       "%s\n", nvmetcp, queue->qid, strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
+
+/** An SGL data block descriptor */
+struct nvmetcp_sgl_desc {
+	/** Address (unused for transport and in-capsule data) */
+	uint64_t addr;
+	/** Data length */
+	uint32_t len;
+	/** Reserved */
+	uint8_t reserved[3];
+	/** Descriptor type and subtype */
+	uint8_t type;
+} __attribute__ (( packed ));
+
+/**
+ * Construct SGL descriptor
+ *
+ * @v dptr		Data pointer to fill in
+ * @v len		Data length
+ * @v type		SGL descriptor type and subtype
+ */
+static void nvmetcp_sgl ( uint8_t *dptr, size_t len, uint8_t type ) {
+	struct nvmetcp_sgl_desc *desc = ( ( void * ) dptr );
+
+	memset ( desc, 0, sizeof ( *desc ) );
+	desc->len = cpu_to_le32 ( len );
+	desc->type = type;
+}
+
+/** Transport SGL data block descriptor */
+#define NVMETCP_SGL_TRANSPORT 0x5a
+
+/** In-capsule SGL data block descriptor (offset-based) */
+#define NVMETCP_SGL_IN_CAPSULE 0x01
+
+/**
+ * Transmit connect command
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_connect ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	union nvmetcp_sqe sqe;
+	struct nvme_connect_data data;
+
+	/* Construct connect command */
+	memset ( &sqe, 0, sizeof ( sqe ) );
+	sqe.fabrics.opcode = NVME_OP_FABRICS;
+	sqe.fabrics.flags = NVME_SQE_FLAG_SGL;
+	sqe.fabrics.cid = cpu_to_le16 ( queue->cid );
+	sqe.fabrics.fctype = NVME_FABRICS_CONNECT;
+	nvmetcp_sgl ( sqe.fabrics.dptr, sizeof ( data ),
+		      NVMETCP_SGL_IN_CAPSULE );
+	sqe.fabrics.spec.connect.recfmt = cpu_to_le16 ( 0 );
+	sqe.fabrics.spec.connect.qid = cpu_to_le16 ( queue->qid );
+	sqe.fabrics.spec.connect.sqsize = cpu_to_le16 ( NVMETCP_SQSIZE );
+	sqe.fabrics.spec.connect.kato = cpu_to_le32 ( 0 );
+
+	/* Construct connect data */
+	memset ( &data, 0, sizeof ( data ) );
+	memcpy ( data.hostid, nvmetcp->hostid, sizeof ( data.hostid ) );
+	data.cntlid = cpu_to_le16 ( queue->qid ? nvmetcp->cntlid :
+				    NVME_CNTLID_DYNAMIC );
+	snprintf ( data.subnqn, sizeof ( data.subnqn ), "%s",
+		   nvmetcp->subnqn );
+	snprintf ( data.hostnqn, sizeof ( data.hostnqn ), "%s",
+		   nvmetcp->hostnqn );
+
+	DBGC ( nvmetcp, "NVMETCP %p QID %d connecting to %s\n",
+	       nvmetcp, queue->qid, nvmetcp->subnqn );
+
+	/* Record admin command CID, if applicable */
+	if ( queue == &nvmetcp->admin )
+		nvmetcp->admin_cid = queue->cid;
+	queue->cid++;
+
+	return nvmetcp_tx_cmd ( queue, &sqe, &data, sizeof ( data ) );
+}
+
+/**
+ * Transmit property set or get command
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v fctype		Fabrics command type
+ * @v ofst		Property offset
+ * @v value		Property value (for set)
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_property ( struct nvmetcp_session *nvmetcp,
+				 unsigned int fctype, unsigned int ofst,
+				 uint64_t value ) {
+	struct nvmetcp_queue *queue = &nvmetcp->admin;
+	union nvmetcp_sqe sqe;
+
+	/* Construct property command */
+	memset ( &sqe, 0, sizeof ( sqe ) );
+	sqe.fabrics.opcode = NVME_OP_FABRICS;
+	sqe.fabrics.flags = NVME_SQE_FLAG_SGL;
+	sqe.fabrics.cid = cpu_to_le16 ( queue->cid );
+	sqe.fabrics.fctype = fctype;
+	sqe.fabrics.spec.property.attrib = 0;
+	sqe.fabrics.spec.property.ofst = cpu_to_le32 ( ofst );
+	sqe.fabrics.spec.property.value = cpu_to_le64 ( value );
+
+	/* Record admin command CID */
+	nvmetcp->admin_cid = queue->cid;
+	queue->cid++;
+
+	return nvmetcp_tx_cmd ( queue, &sqe, NULL, 0 );
+}
+
+/**
+ * Transmit identify namespace command
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_identify ( struct nvmetcp_session *nvmetcp ) {
+	struct nvmetcp_queue *queue = &nvmetcp->admin;
+	union nvmetcp_sqe sqe;
+
+	/* Allocate identify data buffer */
+	assert ( nvmetcp->identify == NULL );
+	nvmetcp->identify = zalloc ( sizeof ( *nvmetcp->identify ) );
+	if ( ! nvmetcp->identify )
+		return -ENOMEM;
+
+	/* Construct identify namespace command */
+	memset ( &sqe, 0, sizeof ( sqe ) );
+	sqe.nvme.opcode = NVME_OP_IDENTIFY;
+	sqe.nvme.flags = NVME_SQE_FLAG_SGL;
+	sqe.nvme.cid = cpu_to_le16 ( queue->cid );
+	sqe.nvme.nsid = cpu_to_le32 ( nvmetcp->nsid );
+	sqe.nvme.cdw10 = cpu_to_le32 ( NVME_IDENTIFY_NS );
+	nvmetcp_sgl ( sqe.nvme.dptr, sizeof ( *nvmetcp->identify ),
+		      NVMETCP_SGL_TRANSPORT );
+
+	/* Record admin command CID */
+	nvmetcp->admin_cid = queue->cid;
+	queue->cid++;
+
+	return nvmetcp_tx_cmd ( queue, &sqe, NULL, 0 );
+}
+
+/**
+ * Transmit host-to-controller data in response to a ready-to-transfer
+ *
+ * @v queue		NVMe/TCP queue
+ * @v cmd		NVMe/TCP command
+ * @v ttag		Transfer tag
+ * @v offset		Requested data offset
+ * @v len		Requested data length
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_h2cdata ( struct nvmetcp_queue *queue,
+				struct nvmetcp_command *cmd,
+				uint16_t ttag, size_t offset, size_t len ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct io_buffer *iobuf;
+	struct nvmetcp_data *h2c;
+	size_t hdgst_len = ( queue->hdgst ? NVMETCP_DIGEST_LEN : 0 );
+	size_t ddgst_len = ( queue->ddgst ? NVMETCP_DIGEST_LEN : 0 );
+	size_t chunk;
+	size_t pdo;
+	size_t pad;
+	size_t plen;
+	uint32_t dgst;
+	void *data;
+	int rc;
+
+	while ( len ) {
+
+		/* Calculate chunk length and PDU layout */
+		chunk = len;
+		if ( chunk > queue->maxh2cdata )
+			chunk = queue->maxh2cdata;
+		pdo = ( sizeof ( *h2c ) + hdgst_len );
+		pad = ( ( pdo % queue->cpda ) ?
+			( queue->cpda - ( pdo % queue->cpda ) ) : 0 );
+		pdo += pad;
+		plen = ( pdo + chunk + ddgst_len );
+
+		/* Allocate I/O buffer */
+		iobuf = xfer_alloc_iob ( &queue->socket, plen );
+		if ( ! iobuf )
+			return -ENOMEM;
+
+		/* Construct data PDU */
+		h2c = iob_put ( iobuf, sizeof ( *h2c ) );
+		memset ( h2c, 0, sizeof ( *h2c ) );
+		h2c->header.type = NVMETCP_H2C_DATA;
+		h2c->header.flags =
+			( ( queue->hdgst ? NVMETCP_FLAG_HDGST : 0 ) |
+			  ( queue->ddgst ? NVMETCP_FLAG_DDGST : 0 ) |
+			  ( ( chunk == len ) ? NVMETCP_FLAG_DATA_LAST : 0 ) );
+		h2c->header.hlen = sizeof ( *h2c );
+		h2c->header.pdo = pdo;
+		h2c->header.plen = cpu_to_le32 ( plen );
+		h2c->cccid = cpu_to_le16 ( cmd->cid );
+		h2c->ttag = cpu_to_le16 ( ttag );
+		h2c->datao = cpu_to_le32 ( offset );
+		h2c->datal = cpu_to_le32 ( chunk );
+		if ( hdgst_len ) {
+			dgst = nvmetcp_digest ( h2c, sizeof ( *h2c ) );
+			memcpy ( iob_put ( iobuf, sizeof ( dgst ) ), &dgst,
+				 sizeof ( dgst ) );
+		}
+		memset ( iob_put ( iobuf, pad ), 0, pad );
+		data = iob_put ( iobuf, chunk );
+		copy_from_user ( data, cmd->buffer, offset, chunk );
+		if ( ddgst_len ) {
+			dgst = nvmetcp_digest ( data, chunk );
+			memcpy ( iob_put ( iobuf, sizeof ( dgst ) ), &dgst,
+				 sizeof ( dgst ) );
+		}
+
+		DBGC2 ( nvmetcp, "NVMETCP %p CID %#04x H2CDATA [%zx,%zx)\n",
+			nvmetcp, cmd->cid, offset, ( offset + chunk ) );
+
+		/* Send data PDU */
+		if ( ( rc = xfer_deliver_iob ( &queue->socket,
+					       iobuf ) ) != 0 ) {
+			DBGC ( nvmetcp, "NVMETCP %p CID %#04x could not send "
+			       "data: %s\n", nvmetcp, cmd->cid,
+			       strerror ( rc ) );
+			return rc;
+		}
+
+		offset += chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+/****************************************************************************
+ *
+ * Command issuing
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Issue NVMe I/O command
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v cmd		NVMe/TCP command
+ * @ret rc		Return status code
+ */
+static int nvmetcp_issue ( struct nvmetcp_session *nvmetcp,
+			   struct nvmetcp_command *cmd ) {
+	struct nvmetcp_queue *queue = &nvmetcp->io;
+	union nvmetcp_sqe sqe;
+
+	/* Assign command identifier */
+	cmd->cid = queue->cid++;
+
+	/* Construct I/O command */
+	memset ( &sqe, 0, sizeof ( sqe ) );
+	sqe.nvme.opcode = cmd->opcode;
+	sqe.nvme.flags = NVME_SQE_FLAG_SGL;
+	sqe.nvme.cid = cpu_to_le16 ( cmd->cid );
+	sqe.nvme.nsid = cpu_to_le32 ( nvmetcp->nsid );
+	sqe.nvme.cdw10 = cpu_to_le32 ( cmd->lba & 0xffffffffUL );
+	sqe.nvme.cdw11 = cpu_to_le32 ( cmd->lba >> 32 );
+	sqe.nvme.cdw12 = cpu_to_le32 ( cmd->count - 1 );
+	nvmetcp_sgl ( sqe.nvme.dptr, cmd->len, NVMETCP_SGL_TRANSPORT );
+
+	DBGC2 ( nvmetcp, "NVMETCP %p CID %#04x %s LBA %#llx count %#x\n",
+		nvmetcp, cmd->cid,
+		( ( cmd->opcode == NVME_OP_READ ) ? "READ" : "WRITE" ),
+		( ( unsigned long long ) cmd->lba ), cmd->count );
+
+	return nvmetcp_tx_cmd ( queue, &sqe, NULL, 0 );
+}
+
+/**
+ * Issue any permissible queued commands
+ *
+ * @v nvmetcp		NVMe/TCP session
+ */
+static void nvmetcp_start_next ( struct nvmetcp_session *nvmetcp ) {
+	struct nvmetcp_command *cmd;
+	struct nvmetcp_command *tmp;
+	unsigned int outstanding = 0;
+	int rc;
+
+	/* Do nothing unless the session is ready for I/O */
+	if ( nvmetcp->status != NVMETCP_STATUS_READY )
+		return;
+
+	/* Count commands already in flight */
+	list_for_each_entry ( cmd, &nvmetcp->commands, list ) {
+		if ( cmd->issued )
+			outstanding++;
+	}
+
+	/* Issue queued commands while command slots remain */
+	list_for_each_entry_safe ( cmd, tmp, &nvmetcp->commands, list ) {
+		if ( cmd->issued )
+			continue;
+
+		/* Complete capacity reports immediately */
+		if ( cmd->opcode == NVMETCP_OP_READ_CAPACITY ) {
+			block_capacity ( &cmd->block, &nvmetcp->capacity );
+			nvmetcp_command_close ( cmd, 0 );
+			continue;
+		}
+
+		/* Issue command, if a slot is available */
+		if ( outstanding >= NVMETCP_MAX_COMMANDS )
+			break;
+		if ( ( rc = nvmetcp_issue ( nvmetcp, cmd ) ) != 0 ) {
+			nvmetcp_close ( nvmetcp, rc );
+			return;
+		}
+		cmd->issued = 1;
+		outstanding++;
+	}
+}
+
+/****************************************************************************
+ *
+ * Session establishment
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Open NVMe/TCP queue transport connection
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_open_queue ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct sockaddr_tcpip target;
+	int rc;
+
+	/* Open socket */
+	memset ( &target, 0, sizeof ( target ) );
+	target.st_port = htons ( uri_port ( nvmetcp->uri, NVMETCP_PORT ) );
+	if ( ( rc = xfer_open_named_socket ( &queue->socket, SOCK_STREAM,
+					     ( struct sockaddr * ) &target,
+					     nvmetcp->uri->host,
+					     NULL ) ) != 0 ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d could not open socket: "
+		       "%s\n", nvmetcp, queue->qid, strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Handle admin command completion
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v status		Command status
+ * @v dw0		Completion dword 0
+ */
+static void nvmetcp_admin_complete ( struct nvmetcp_session *nvmetcp,
+				     unsigned int status, uint32_t dw0 ) {
+	struct nvme_identify_ns *identify = nvmetcp->identify;
+	struct nvme_lbaf *lbaf;
+	int rc;
+
+	/* Fail session on any admin command error */
+	if ( status != 0 ) {
+		DBGC ( nvmetcp, "NVMETCP %p admin command failed (status "
+		       "%#04x) in state %d\n", nvmetcp, status,
+		       nvmetcp->status );
+		rc = -EIO_COMMAND_STATUS;
+		goto err;
+	}
+
+	switch ( nvmetcp->status ) {
+
+	case NVMETCP_STATUS_ADMIN_CONNECT:
+		/* Record controller ID and enable controller */
+		nvmetcp->cntlid = ( dw0 & 0xffff );
+		DBGC ( nvmetcp, "NVMETCP %p connected to controller %#04x\n",
+		       nvmetcp, nvmetcp->cntlid );
+		nvmetcp->status = NVMETCP_STATUS_ENABLE;
+		if ( ( rc = nvmetcp_tx_property ( nvmetcp,
+						  NVME_FABRICS_PROPERTY_SET,
+						  NVME_PROPERTY_CC,
+						  NVME_CC_ENABLE ) ) != 0 )
+			goto err;
+		break;
+
+	case NVMETCP_STATUS_ENABLE:
+		/* Poll for controller readiness */
+		nvmetcp->status = NVMETCP_STATUS_READY_WAIT;
+		nvmetcp->ready_polls = NVMETCP_MAX_READY_POLLS;
+		if ( ( rc = nvmetcp_tx_property ( nvmetcp,
+						  NVME_FABRICS_PROPERTY_GET,
+						  NVME_PROPERTY_CSTS,
+						  0 ) ) != 0 )
+			goto err;
+		break;
+
+	case NVMETCP_STATUS_READY_WAIT:
+		/* Identify namespace once controller is ready */
+		if ( dw0 & NVME_CSTS_RDY ) {
+			nvmetcp->status = NVMETCP_STATUS_IDENTIFY;
+			if ( ( rc = nvmetcp_tx_identify ( nvmetcp ) ) != 0 )
+				goto err;
+			break;
+		}
+		if ( ! nvmetcp->ready_polls-- ) {
+			rc = -ETIMEDOUT_READY;
+			goto err;
+		}
+		if ( ( rc = nvmetcp_tx_property ( nvmetcp,
+						  NVME_FABRICS_PROPERTY_GET,
+						  NVME_PROPERTY_CSTS,
+						  0 ) ) != 0 )
+			goto err;
+		break;
+
+	case NVMETCP_STATUS_IDENTIFY:
+		/* Extract namespace capacity */
+		lbaf = &identify->lbaf[ identify->flbas & 0x0f ];
+		nvmetcp->capacity.blocks = le64_to_cpu ( identify->nsze );
+		nvmetcp->capacity.blksize = ( 1UL << lbaf->lbads );
+		nvmetcp->capacity.max_count = NVMETCP_MAX_BLOCK_COUNT;
+		free ( identify );
+		nvmetcp->identify = NULL;
+		if ( ( ! nvmetcp->capacity.blocks ) ||
+		     ( nvmetcp->capacity.blksize < 512 ) ) {
+			DBGC ( nvmetcp, "NVMETCP %p invalid namespace %d\n",
+			       nvmetcp, nvmetcp->nsid );
+			rc = -ENODEV;
+			goto err;
+		}
+		DBGC ( nvmetcp, "NVMETCP %p namespace %d has %#llx blocks of "
+		       "%zd bytes\n", nvmetcp, nvmetcp->nsid,
+		       ( ( unsigned long long ) nvmetcp->capacity.blocks ),
+		       nvmetcp->capacity.blksize );
+
+		/* Open I/O queue connection */
+		nvmetcp->status = NVMETCP_STATUS_IO_ICREQ;
+		if ( ( rc = nvmetcp_open_queue ( &nvmetcp->io ) ) != 0 )
+			goto err;
+		break;
+
+	default:
+		DBGC ( nvmetcp, "NVMETCP %p unexpected admin completion in "
+		       "state %d\n", nvmetcp, nvmetcp->status );
+		rc = -EPROTO_INVALID_PDU;
+		goto err;
+	}
+
+	return;
+
+ err:
+	nvmetcp_close ( nvmetcp, rc );
+}
+
+/****************************************************************************
+ *
+ * PDU reception
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Handle received initialise connection response
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_icresp ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvmetcp_icresp *icresp = &queue->rx_pdu.icresp;
+	unsigned int expected = ( ( queue == &nvmetcp->admin ) ?
+				  NVMETCP_STATUS_ADMIN_ICREQ :
+				  NVMETCP_STATUS_IO_ICREQ );
+	int rc;
+
+	/* Sanity checks */
+	if ( nvmetcp->status != expected ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d unexpected ICRESP\n",
+		       nvmetcp, queue->qid );
+		return -EPROTO_INVALID_PDU;
+	}
+	if ( icresp->pfv != cpu_to_le16 ( 0 ) ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d unsupported PDU format "
+		       "%#04x\n", nvmetcp, queue->qid,
+		       le16_to_cpu ( icresp->pfv ) );
+		return -ENOTSUP;
+	}
+
+	/* Record negotiated connection parameters */
+	queue->hdgst = ( !! ( icresp->dgst & NVMETCP_DGST_HDGST ) );
+	queue->ddgst = ( !! ( icresp->dgst & NVMETCP_DGST_DDGST ) );
+	queue->cpda = ( ( icresp->cpda + 1 ) * 4 );
+	queue->maxh2cdata = le32_to_cpu ( icresp->maxh2cdata );
+	if ( queue->maxh2cdata > NVMETCP_MAX_H2CDATA_LEN )
+		queue->maxh2cdata = NVMETCP_MAX_H2CDATA_LEN;
+	DBGC ( nvmetcp, "NVMETCP %p QID %d connection established "
+	       "(%s%s maxh2cdata %zd)\n", nvmetcp, queue->qid,
+	       ( queue->hdgst ? "hdgst " : "" ),
+	       ( queue->ddgst ? "ddgst " : "" ), queue->maxh2cdata );
+
+	/* Issue connect command for this queue */
+	nvmetcp->status = ( ( queue == &nvmetcp->admin ) ?
+			    NVMETCP_STATUS_ADMIN_CONNECT :
+			    NVMETCP_STATUS_IO_CONNECT );
+	if ( ( rc = nvmetcp_tx_connect ( queue ) ) != 0 )
+		return rc;
+
+	return 0;
+}
+
+/**
+ * Handle received response capsule
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_rsp ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvme_cqe *cqe = &queue->rx_pdu.rsp.cqe;
+	struct nvmetcp_command *cmd;
+	unsigned int status = ( le16_to_cpu ( cqe->status ) >> 1 );
+	uint16_t cid = le16_to_cpu ( cqe->cid );
+	int rc;
+
+	/* Handle admin queue completions */
+	if ( queue == &nvmetcp->admin ) {
+		if ( cid != nvmetcp->admin_cid ) {
+			DBGC ( nvmetcp, "NVMETCP %p unexpected admin CID "
+			       "%#04x\n", nvmetcp, cid );
+			return -EPROTO_INVALID_PDU;
+		}
+		nvmetcp_admin_complete ( nvmetcp, status,
+					 le32_to_cpu ( cqe->dw0 ) );
+		return 0;
+	}
+
+	/* Handle I/O queue connect completion */
+	if ( nvmetcp->status == NVMETCP_STATUS_IO_CONNECT ) {
+		if ( status != 0 ) {
+			DBGC ( nvmetcp, "NVMETCP %p I/O connect failed "
+			       "(status %#04x)\n", nvmetcp, status );
+			return -EPERM;
+		}
+		DBGC ( nvmetcp, "NVMETCP %p session ready\n", nvmetcp );
+		nvmetcp->status = NVMETCP_STATUS_READY;
+		nvmetcp_start_next ( nvmetcp );
+		return 0;
+	}
+
+	/* Handle I/O command completions */
+	cmd = nvmetcp_find_cid ( nvmetcp, cid );
+	if ( ! cmd ) {
+		DBGC ( nvmetcp, "NVMETCP %p unrecognised CID %#04x\n",
+		       nvmetcp, cid );
+		return 0;
+	}
+	rc = ( status ? -EIO_COMMAND_STATUS : 0 );
+	if ( status ) {
+		DBGC ( nvmetcp, "NVMETCP %p CID %#04x failed (status "
+		       "%#04x)\n", nvmetcp, cid, status );
+	}
+	ref_get ( &cmd->refcnt );
+	nvmetcp_command_close ( cmd, rc );
+	ref_put ( &cmd->refcnt );
+
+	/* Start any queued commands */
+	nvmetcp_start_next ( nvmetcp );
+
+	return 0;
+}
+
+/**
+ * Handle received ready-to-transfer
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_r2t ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvmetcp_r2t *r2t = &queue->rx_pdu.r2t;
+	struct nvmetcp_command *cmd;
+	size_t offset = le32_to_cpu ( r2t->r2to );
+	size_t len = le32_to_cpu ( r2t->r2tl );
+
+	/* Identify command */
+	cmd = nvmetcp_find_cid ( nvmetcp, le16_to_cpu ( r2t->cccid ) );
+	if ( ! cmd ) {
+		DBGC ( nvmetcp, "NVMETCP %p R2T for unrecognised CID %#04x\n",
+		       nvmetcp, le16_to_cpu ( r2t->cccid ) );
+		return -EPROTO_INVALID_PDU;
+	}
+
+	/* Sanity check */
+	if ( ( offset > cmd->len ) || ( len > ( cmd->len - offset ) ) ) {
+		DBGC ( nvmetcp, "NVMETCP %p CID %#04x invalid R2T [%zx,%zx)\n",
+		       nvmetcp, cmd->cid, offset, ( offset + len ) );
+		return -EPROTO_INVALID_PDU;
+	}
+
+	/* Send requested data */
+	return nvmetcp_tx_h2cdata ( queue, cmd, le16_to_cpu ( r2t->ttag ),
+				    offset, len );
+}
+
+/**
+ * Handle received data PDU header
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_c2hdata ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvmetcp_data *c2h = &queue->rx_pdu.data;
+	struct nvmetcp_command *cmd;
+	size_t datao = le32_to_cpu ( c2h->datao );
+	size_t datal = le32_to_cpu ( c2h->datal );
+	size_t hdgst_len = ( ( c2h->header.flags & NVMETCP_FLAG_HDGST ) ?
+			     NVMETCP_DIGEST_LEN : 0 );
+
+	/* Sanity check PDU layout */
+	if ( c2h->header.pdo < ( c2h->header.hlen + hdgst_len ) ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d invalid data offset %d\n",
+		       nvmetcp, queue->qid, c2h->header.pdo );
+		return -EPROTO_INVALID_PDU;
+	}
+	queue->rx_pad = ( c2h->header.pdo - c2h->header.hlen - hdgst_len );
+	queue->rx_len = datal;
+
+	/* Identify data destination */
+	queue->rx_dest = UNULL;
+	queue->rx_dest_len = 0;
+	if ( queue == &nvmetcp->admin ) {
+		/* Admin queue data is identification data */
+		if ( nvmetcp->identify &&
+		     ( le16_to_cpu ( c2h->cccid ) == nvmetcp->admin_cid ) &&
+		     ( datao <= sizeof ( *nvmetcp->identify ) ) &&
+		     ( datal <= ( sizeof ( *nvmetcp->identify ) - datao ) ) ){
+			queue->rx_dest = userptr_add (
+				virt_to_user ( nvmetcp->identify ), datao );
+			queue->rx_dest_len = datal;
+		}
+	} else {
+		/* I/O queue data belongs to a read command */
+		cmd = nvmetcp_find_cid ( nvmetcp,
+					 le16_to_cpu ( c2h->cccid ) );
+		if ( cmd && ( datao <= cmd->len ) &&
+		     ( datal <= ( cmd->len - datao ) ) ) {
+			queue->rx_dest = userptr_add ( cmd->buffer, datao );
+			queue->rx_dest_len = datal;
+		}
+	}
+	if ( ( queue->rx_dest == UNULL ) && datal ) {
+		DBGC ( nvmetcp, "NVMETCP %p QID %d discarding data for CID "
+		       "%#04x [%zx,%zx)\n", nvmetcp, queue->qid,
+		       le16_to_cpu ( c2h->cccid ), datao, ( datao + datal ) );
+	}
+
+	/* Initialise data digest */
+	queue->rx_crc = 0xffffffffUL;
+
+	return 0;
+}
+
+/**
+ * Handle data transfer completion
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_data_done ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvmetcp_data *c2h = &queue->rx_pdu.data;
+	struct nvmetcp_command *cmd;
+
+	/* A data transfer marked successful completes the command
+	 * without a separate response capsule.
+	 */
+	if ( ! ( c2h->header.flags & NVMETCP_FLAG_DATA_SUCCESS ) )
+		return 0;
+
+	if ( queue == &nvmetcp->admin ) {
+		nvmetcp_admin_complete ( nvmetcp, 0, 0 );
+	} else {
+		cmd = nvmetcp_find_cid ( nvmetcp,
+					 le16_to_cpu ( c2h->cccid ) );
+		if ( cmd ) {
+			ref_get ( &cmd->refcnt );
+			nvmetcp_command_close ( cmd, 0 );
+			ref_put ( &cmd->refcnt );
+		}
+		nvmetcp_start_next ( nvmetcp );
+	}
+
+	return 0;
+}
+
+/**
+ * Handle received PDU header
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_header ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvmetcp_header *header = &queue->rx_pdu.header;
+	int rc;
+
+	/* No data expected unless the header indicates otherwise */
+	queue->rx_pad = 0;
+	queue->rx_len = 0;
+
+	switch ( header->type ) {
+	case NVMETCP_ICRESP:
+		if ( ( rc = nvmetcp_rx_icresp ( queue ) ) != 0 )
+			return rc;
+		break;
+	case NVMETCP_RSP:
+		if ( ( rc = nvmetcp_rx_rsp ( queue ) ) != 0 )
+			return rc;
+		break;
+	case NVMETCP_R2T:
+		if ( ( rc = nvmetcp_rx_r2t ( queue ) ) != 0 )
+			return rc;
+		break;
+	case NVMETCP_C2H_DATA:
+		if ( ( rc = nvmetcp_rx_c2hdata ( queue ) ) != 0 )
+			return rc;
+		break;
+	case NVMETCP_C2H_TERM:
+		DBGC ( nvmetcp, "NVMETCP %p QID %d terminated by "
+		       "controller:\n", nvmetcp, queue->qid );
+		DBGC_HDA ( nvmetcp, 0, header, header->hlen );
+		return -EPROTO_TERMINATED;
+	default:
+		DBGC ( nvmetcp, "NVMETCP %p QID %d unknown PDU type %#02x\n",
+		       nvmetcp, queue->qid, header->type );
+		return -EPROTO_INVALID_PDU;
+	}
+
+	return 0;
+}
+
+/**
+ * Receive new data
+ *
+ * @v queue		NVMe/TCP queue
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int nvmetcp_queue_deliver ( struct nvmetcp_queue *queue,
+				   struct io_buffer *iobuf,
+				   struct xfer_metadata *meta __unused ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	struct nvmetcp_header *header = &queue->rx_pdu.header;
+	uint8_t *bytes = ( ( uint8_t * ) &queue->rx_pdu );
+	size_t len;
+	size_t remaining;
+	uint32_t dgst;
+	int rc = 0;
+
+	while ( iob_len ( iobuf ) ) {
+		len = iob_len ( iobuf );
+
+		switch ( queue->rx_state ) {
+
+		case NVMETCP_RX_CH:
+		case NVMETCP_RX_HEADER:
+			/* Accumulate PDU header */
+			remaining = ( ( queue->rx_state == NVMETCP_RX_CH ) ?
+				      sizeof ( *header ) : header->hlen );
+			remaining -= queue->rx_offset;
+			if ( len > remaining )
+				len = remaining;
+			memcpy ( ( bytes + queue->rx_offset ), iobuf->data,
+				 len );
+			iob_pull ( iobuf, len );
+			queue->rx_offset += len;
+			if ( len < remaining )
+				break;
+			if ( queue->rx_state == NVMETCP_RX_CH ) {
+				/* Validate header length */
+				if ( ( header->hlen < sizeof ( *header ) ) ||
+				     ( header->hlen >
+				       sizeof ( queue->rx_pdu ) ) ) {
+					DBGC ( nvmetcp, "NVMETCP %p QID %d "
+					       "invalid header length %d\n",
+					       nvmetcp, queue->qid,
+					       header->hlen );
+					rc = -EPROTO_INVALID_PDU;
+					goto err;
+				}
+				if ( header->hlen > sizeof ( *header ) ) {
+					queue->rx_state = NVMETCP_RX_HEADER;
+					break;
+				}
+			}
+			/* Header is complete */
+			queue->rx_offset = 0;
+			if ( header->flags & NVMETCP_FLAG_HDGST ) {
+				queue->rx_state = NVMETCP_RX_HDGST;
+				break;
+			}
+			goto header_complete;
+
+		case NVMETCP_RX_HDGST:
+			/* Accumulate and verify header digest */
+			remaining = ( sizeof ( queue->rx_dgst ) -
+				      queue->rx_offset );
+			if ( len > remaining )
+				len = remaining;
+			memcpy ( ( ( ( uint8_t * ) &queue->rx_dgst ) +
+				   queue->rx_offset ), iobuf->data, len );
+			iob_pull ( iobuf, len );
+			queue->rx_offset += len;
+			if ( len < remaining )
+				break;
+			queue->rx_offset = 0;
+			dgst = nvmetcp_digest ( &queue->rx_pdu,
+						header->hlen );
+			if ( dgst != queue->rx_dgst ) {
+				DBGC ( nvmetcp, "NVMETCP %p QID %d header "
+				       "digest mismatch\n", nvmetcp,
+				       queue->qid );
+				rc = -EPROTO_INVALID_DIGEST;
+				goto err;
+			}
+		header_complete:
+			/* Process completed header */
+			if ( ( rc = nvmetcp_rx_header ( queue ) ) != 0 )
+				goto err;
+			if ( queue->rx_pad ) {
+				queue->rx_state = NVMETCP_RX_PAD;
+			} else if ( queue->rx_len ) {
+				queue->rx_state = NVMETCP_RX_DATA;
+			} else {
+				queue->rx_state = NVMETCP_RX_CH;
+			}
+			break;
+
+		case NVMETCP_RX_PAD:
+			/* Discard padding before data */
+			remaining = ( queue->rx_pad - queue->rx_offset );
+			if ( len > remaining )
+				len = remaining;
+			iob_pull ( iobuf, len );
+			queue->rx_offset += len;
+			if ( len < remaining )
+				break;
+			queue->rx_offset = 0;
+			queue->rx_state = NVMETCP_RX_DATA;
+			break;
+
+		case NVMETCP_RX_DATA:
+			/* Accumulate data into destination buffer */
+			remaining = ( queue->rx_len - queue->rx_offset );
+			if ( len > remaining )
+				len = remaining;
+			if ( header->flags & NVMETCP_FLAG_DDGST ) {
+				queue->rx_crc = crc32c ( queue->rx_crc,
+							 iobuf->data, len );
+			}
+			if ( queue->rx_dest != UNULL ) {
+				copy_to_user ( queue->rx_dest,
+					       queue->rx_offset, iobuf->data,
+					       len );
+			}
+			iob_pull ( iobuf, len );
+			queue->rx_offset += len;
+			if ( len < remaining )
+				break;
+			queue->rx_offset = 0;
+			if ( header->flags & NVMETCP_FLAG_DDGST ) {
+				queue->rx_state = NVMETCP_RX_DDGST;
+				break;
+			}
+			if ( ( rc = nvmetcp_rx_data_done ( queue ) ) != 0 )
+				goto err;
+			queue->rx_state = NVMETCP_RX_CH;
+			break;
+
+		case NVMETCP_RX_DDGST:
+			/* Accumulate and verify data digest */
+			remaining = ( sizeof ( queue->rx_dgst ) -
+				      queue->rx_offset );
+			if ( len > remaining )
+				len = remaining;
+			memcpy ( ( ( ( uint8_t * ) &queue->rx_dgst ) +
+				   queue->rx_offset ), iobuf->data, len );
+			iob_pull ( iobuf, len );
+			queue->rx_offset += len;
+			if ( len < remaining )
+				break;
+			queue->rx_offset = 0;
+			dgst = cpu_to_le32 ( ~queue->rx_crc );
+			if ( dgst != queue->rx_dgst ) {
+				DBGC ( nvmetcp, "NVMETCP %p QID %d data "
+				       "digest mismatch\n", nvmetcp,
+				       queue->qid );
+				rc = -EPROTO_INVALID_DIGEST;
+				goto err;
+			}
+			if ( ( rc = nvmetcp_rx_data_done ( queue ) ) != 0 )
+				goto err;
+			queue->rx_state = NVMETCP_RX_CH;
+			break;
+
+		default:
+			assert ( 0 );
+			rc = -EINVAL;
+			goto err;
+		}
+	}
+
+	free_iob ( iobuf );
+	return 0;
+
+ err:
+	free_iob ( iobuf );
+	nvmetcp_close ( nvmetcp, rc );
+	return rc;
+}
+
+/**
+ * Handle transport connection window change
+ *
+ * @v queue		NVMe/TCP queue
+ */
+static void nvmetcp_queue_window_changed ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *nvmetcp = queue->nvmetcp;
+	int rc;
+
+	/* Initiate connection establishment as soon as the transport
+	 * connection can accept data.
+	 */
+	if ( ( ! queue->icreq_sent ) &&
+	     ( xfer_window ( &queue->socket ) > 0 ) ) {
+		queue->icreq_sent = 1;
+		if ( ( rc = nvmetcp_tx_icreq ( queue ) ) != 0 )
+			nvmetcp_close ( nvmetcp, rc );
+	}
+}
+
+/****************************************************************************
+ *
+ * Interfaces
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Close NVMe/TCP session
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v rc		Reason for close
+ */
+static void nvmetcp_close ( struct nvmetcp_session *nvmetcp, int rc ) {
+	struct nvmetcp_command *cmd;
+	struct nvmetcp_command *tmp;
+
+	if ( rc != 0 ) {
+		DBGC ( nvmetcp, "NVMETCP %p closed: %s\n",
+		       nvmetcp, strerror ( rc ) );
+	}
+
+	/* Shut down interfaces */
+	intf_shutdown ( &nvmetcp->io.socket, rc );
+	intf_shutdown ( &nvmetcp->admin.socket, rc );
+	intf_shutdown ( &nvmetcp->block, rc );
+
+	/* Shut down any active commands */
+	list_for_each_entry_safe ( cmd, tmp, &nvmetcp->commands, list ) {
+		ref_get ( &cmd->refcnt );
+		nvmetcp_command_close ( cmd, rc );
+		ref_put ( &cmd->refcnt );
+	}
+}
+
+/**
+ * Receive data on admin queue
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int nvmetcp_admin_deliver ( struct nvmetcp_session *nvmetcp,
+				   struct io_buffer *iobuf,
+				   struct xfer_metadata *meta ) {
+	return nvmetcp_queue_deliver ( &nvmetcp->admin, iobuf, meta );
+}
+
+/**
+ * Receive data on I/O queue
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int nvmetcp_io_deliver ( struct nvmetcp_session *nvmetcp,
+				struct io_buffer *iobuf,
+				struct xfer_metadata *meta ) {
+	return nvmetcp_queue_deliver ( &nvmetcp->io, iobuf, meta );
+}
+
+/**
+ * Handle admin queue window change
+ *
+ * @v nvmetcp		NVMe/TCP session
+ */
+static void nvmetcp_admin_window_changed ( struct nvmetcp_session *nvmetcp ) {
+	nvmetcp_queue_window_changed ( &nvmetcp->admin );
+}
+
+/**
+ * Handle I/O queue window change
+ *
+ * @v nvmetcp		NVMe/TCP session
+ */
+static void nvmetcp_io_window_changed ( struct nvmetcp_session *nvmetcp ) {
+	nvmetcp_queue_window_changed ( &nvmetcp->io );
+}
+
+/** NVMe/TCP admin queue socket interface operations */
+static struct interface_operation nvmetcp_admin_op[] = {
+	INTF_OP ( xfer_deliver, struct nvmetcp_session *,
+		  nvmetcp_admin_deliver ),
+	INTF_OP ( xfer_window_changed, struct nvmetcp_session *,
+		  nvmetcp_admin_window_changed ),
+	INTF_OP ( intf_close, struct nvmetcp_session *, nvmetcp_close ),
+};
+
+/** NVMe/TCP admin queue socket interface descriptor */
+static struct interface_descriptor nvmetcp_admin_desc =
+	INTF_DESC ( struct nvmetcp_session, admin.socket, nvmetcp_admin_op );
+
+/** NVMe/TCP I/O queue socket interface operations */
+static struct interface_operation nvmetcp_io_op[] = {
+	INTF_OP ( xfer_deliver, struct nvmetcp_session *,
+		  nvmetcp_io_deliver ),
+	INTF_OP ( xfer_window_changed, struct nvmetcp_session *,
+		  nvmetcp_io_window_changed ),
+	INTF_OP ( intf_close, struct nvmetcp_session *, nvmetcp_close ),
+};
+
+/** NVMe/TCP I/O queue socket interface descriptor */
+static struct interface_descriptor nvmetcp_io_desc =
+	INTF_DESC ( struct nvmetcp_session, io.socket, nvmetcp_io_op );
+
+/** NVMe/TCP command block interface operations */
+static struct interface_operation nvmetcp_command_op[] = {
+	INTF_OP ( intf_close, struct nvmetcp_command *,
+		  nvmetcp_command_close ),
+};
+
+/** NVMe/TCP command block interface descriptor */
+static struct interface_descriptor nvmetcp_command_desc =
+	INTF_DESC ( struct nvmetcp_command, block, nvmetcp_command_op );
+
+/**
+ * Enqueue block device command
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v data		Block data interface
+ * @v opcode		NVMe opcode (or pseudo-opcode)
+ * @v lba		Starting logical block address
+ * @v count		Number of blocks to transfer
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int nvmetcp_command ( struct nvmetcp_session *nvmetcp,
+			     struct interface *data, uint8_t opcode,
+			     uint64_t lba, unsigned int count,
+			     userptr_t buffer, size_t len ) {
+	struct nvmetcp_command *cmd;
+
+	/* Allocate and initialise structure */
+	cmd = zalloc ( sizeof ( *cmd ) );
+	if ( ! cmd )
+		return -ENOMEM;
+	ref_init ( &cmd->refcnt, nvmetcp_command_free );
+	intf_init ( &cmd->block, &nvmetcp_command_desc, &cmd->refcnt );
+	cmd->nvmetcp = nvmetcp_get ( nvmetcp );
+	cmd->opcode = opcode;
+	cmd->lba = lba;
+	cmd->count = count;
+	cmd->buffer = buffer;
+	cmd->len = len;
+	list_add_tail ( &cmd->list, &nvmetcp->commands );
+
+	/* Attach to parent interface, leave reference with command
+	 * list, and issue if possible.
+	 */
+	intf_plug_plug ( &cmd->block, data );
+	nvmetcp_start_next ( nvmetcp );
+
+	return 0;
+}
+
+/**
+ * Issue block device read
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v data		Block data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of blocks to transfer
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_read ( struct nvmetcp_session *nvmetcp,
+				struct interface *data, uint64_t lba,
+				unsigned int count, userptr_t buffer,
+				size_t len ) {
+	return nvmetcp_command ( nvmetcp, data, NVME_OP_READ,
+				 lba, count, buffer, len );
+}
+
+/**
+ * Issue block device write
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v data		Block data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of blocks to transfer
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_write ( struct nvmetcp_session *nvmetcp,
+				 struct interface *data, uint64_t lba,
+				 unsigned int count, userptr_t buffer,
+				 size_t len ) {
+	return nvmetcp_command ( nvmetcp, data, NVME_OP_WRITE,
+				 lba, count, buffer, len );
+}
+
+/**
+ * Read block device capacity
+ *
+ * @v nvmetcp		NVMe/TCP session
+ * @v data		Block data interface
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_read_capacity ( struct nvmetcp_session *nvmetcp,
+					 struct interface *data ) {
+	return nvmetcp_command ( nvmetcp, data, NVMETCP_OP_READ_CAPACITY,
+				 0, 0, UNULL, 0 );
+}
+
+/** NVMe/TCP session block interface operations */
+static struct interface_operation nvmetcp_block_op[] = {
+	INTF_OP ( block_read, struct nvmetcp_session *, nvmetcp_block_read ),
+	INTF_OP ( block_write, struct nvmetcp_session *,
+		  nvmetcp_block_write ),
+	INTF_OP ( block_read_capacity, struct nvmetcp_session *,
+		  nvmetcp_block_read_capacity ),
+	INTF_OP ( intf_close, struct nvmetcp_session *, nvmetcp_close ),
+};
+
+/** NVMe/TCP session block interface descriptor */
+static struct interface_descriptor nvmetcp_block_desc =
+	INTF_DESC ( struct nvmetcp_session, block, nvmetcp_block_op );
+
+/****************************************************************************
+ *
+ * Opener
+ *
+ ****************************************************************************
+ */
+
+/**
+ * Open NVMe/TCP URI
+ *
+ * @v parent		Parent interface
+ * @v uri		URI
+ * @ret rc		Return status code
+ *
+ * The URI takes the form
+ * nvme-tcp://<host>[:<port>]/<subsystem-nqn>[?nsid=<nsid>]
+ */
+static int nvmetcp_open ( struct interface *parent, struct uri *uri ) {
+	struct nvmetcp_session *nvmetcp;
+	const char *subnqn;
+	unsigned int i;
+	int rc;
+
+	/* Sanity checks */
+	if ( ( ! uri->host ) || ( ! uri->path ) ||
+	     ( uri->path[0] != '/' ) || ( ! uri->path[1] ) ) {
+		rc = -EINVAL;
+		goto err_sanity;
+	}
+	subnqn = &uri->path[1];
+
+	/* Allocate and initialise structure */
+	nvmetcp = zalloc ( sizeof ( *nvmetcp ) );
+	if ( ! nvmetcp ) {
+		rc = -ENOMEM;
+		goto err_zalloc;
+	}
+	ref_init ( &nvmetcp->refcnt, nvmetcp_free );
+	intf_init ( &nvmetcp->block, &nvmetcp_block_desc, &nvmetcp->refcnt );
+	intf_init ( &nvmetcp->admin.socket, &nvmetcp_admin_desc,
+		    &nvmetcp->refcnt );
+	intf_init ( &nvmetcp->io.socket, &nvmetcp_io_desc,
+		    &nvmetcp->refcnt );
+	nvmetcp->admin.nvmetcp = nvmetcp;
+	nvmetcp->admin.qid = 0;
+	nvmetcp->io.nvmetcp = nvmetcp;
+	nvmetcp->io.qid = 1;
+	INIT_LIST_HEAD ( &nvmetcp->commands );
+	nvmetcp->uri = uri_get ( uri );
+	nvmetcp->status = NVMETCP_STATUS_ADMIN_ICREQ;
+
+	/* Record subsystem NQN and namespace ID */
+	nvmetcp->subnqn = strdup ( subnqn );
+	if ( ! nvmetcp->subnqn ) {
+		rc = -ENOMEM;
+		goto err_subnqn;
+	}
+	nvmetcp->nsid = 1;
+	if ( uri->query &&
+	     ( strncmp ( uri->query, "nsid=", 5 /* "nsid=" */ ) == 0 ) ) {
+		nvmetcp->nsid = strtoul ( &uri->query[5], NULL, 0 );
+	}
+
+	/* Generate host identity */
+	for ( i = 0 ; i < sizeof ( nvmetcp->hostid ) ; i++ )
+		nvmetcp->hostid[i] = random();
+	snprintf ( nvmetcp->hostnqn, sizeof ( nvmetcp->hostnqn ),
+		   "nqn.2014-08.org.nvmexpress:uuid:"
+		   "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-"
+		   "%02x%02x%02x%02x%02x%02x",
+		   nvmetcp->hostid[0], nvmetcp->hostid[1],
+		   nvmetcp->hostid[2], nvmetcp->hostid[3],
+		   nvmetcp->hostid[4], nvmetcp->hostid[5],
+		   nvmetcp->hostid[6], nvmetcp->hostid[7],
+		   nvmetcp->hostid[8], nvmetcp->hostid[9],
+		   nvmetcp->hostid[10], nvmetcp->hostid[11],
+		   nvmetcp->hostid[12], nvmetcp->hostid[13],
+		   nvmetcp->hostid[14], nvmetcp->hostid[15] );
+
+	DBGC ( nvmetcp, "NVMETCP %p target %s %s nsid %d\n", nvmetcp,
+	       uri->host, nvmetcp->subnqn, nvmetcp->nsid );
+
+	/* Open admin queue connection */
+	if ( ( rc = nvmetcp_open_queue ( &nvmetcp->admin ) ) != 0 )
+		goto err_open_queue;
+
+	/* Attach to parent interface, mortalise self, and return */
+	intf_plug_plug ( &nvmetcp->block, parent );
+	ref_put ( &nvmetcp->refcnt );
+	return 0;
+
+ err_open_queue:
+ err_subnqn:
+	nvmetcp_close ( nvmetcp, rc );
+	ref_put ( &nvmetcp->refcnt );
+ err_zalloc:
+ err_sanity:
+	return rc;
+}
+
+/** NVMe/TCP URI opener */
+struct uri_opener nvmetcp_uri_opener __uri_opener = {
+	.scheme = "nvme-tcp",
+	.open = nvmetcp_open,
+};
@@ -34,6 +34,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <byteswap.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
+#include <ipxe/process.h>
 #include <ipxe/tcpip.h>
 #include <ipxe/dhcp.h>
 #include <ipxe/settings.h>
@@ -148,13 +149,90 @@ static struct line_console syslogs_line = {
 /** Encrypted syslog recursion marker */
 static int syslogs_entered;
 
+/** Encrypted syslog message queue length
+ *
+ * This is a policy decision
+ */
+#define SYSLOGS_QUEUE_LEN 4
+
+/** A queued encrypted syslog message */
+struct syslogs_message {
+	/** Severity */
+	unsigned int severity;
+	/** Message */
+	char message[SYSLOG_BUFSIZE];
+};
+
+/** Encrypted syslog message queue
+ *
+ * Completed log lines are queued and transmitted from the process
+ * (i.e. from the event loop), so that logging under load does not
+ * insert a synchronous TLS transmission into whatever code path
+ * generated the message.
+ */
+static struct syslogs_message syslogs_queue[SYSLOGS_QUEUE_LEN];
+
+/** Encrypted syslog message queue producer counter */
+static unsigned int syslogs_prod;
+
+/** Encrypted syslog message queue consumer counter */
+static unsigned int syslogs_cons;
+
+/**
+ * Transmit queued log message
+ *
+ * @v message		Queued message
+ */
+static void syslogs_flush ( struct syslogs_message *message ) {
+	int rc;
+
+	/* Guard against re-entry */
+	syslogs_entered = 1;
+
+	/* Send log message */
+	if ( ( rc = syslog_send ( &syslogs, message->severity,
+				  message->message, "\n" ) ) != 0 ) {
+		DBG ( "SYSLOGS could not send log message: %s\n",
+		      strerror ( rc ) );
+	}
+
+	/* Clear re-entry flag */
+	syslogs_entered = 0;
+}
+
+/**
+ * Transmit queued log messages
+ *
+ * @v process		Encrypted syslog process
+ */
+static void syslogs_step ( struct process *process ) {
+
+	/* Transmit one queued message per step */
+	if ( syslogs_cons != syslogs_prod ) {
+		syslogs_flush ( &syslogs_queue[ syslogs_cons++ %
+						SYSLOGS_QUEUE_LEN ] );
+	}
+
+	/* Stop process when queue is empty */
+	if ( syslogs_cons == syslogs_prod )
+		process_del ( process );
+}
+
+/** Encrypted syslog process descriptor */
+static struct process_descriptor syslogs_process_desc =
+	PROC_DESC_PURE ( syslogs_step );
+
+/** Encrypted syslog process */
+static struct process syslogs_process =
+	PROC_INIT ( syslogs_process, &syslogs_process_desc );
+
 /**
  * Print a character to encrypted syslog console
  *
  * @v character		Character to be printed
  */
 static void syslogs_putchar ( int character ) {
-	int rc;
+	struct syslogs_message *message;
 
 	/* Ignore if we are already mid-logging */
 	if ( syslogs_entered )
@@ -164,18 +242,31 @@ static void syslogs_putchar ( int character ) {
 	if ( line_putchar ( &syslogs_line, character ) == 0 )
 		return;
 
-	/* Guard against re-entry */
-	syslogs_entered = 1;
-
-	/* Send log message */
-	if ( ( rc = syslog_send ( &syslogs, syslogs_severity,
-				  syslogs_buffer, "\n" ) ) != 0 ) {
-		DBG ( "SYSLOGS could not send log message: %s\n",
-		      strerror ( rc ) );
+	/* Transmit oldest message immediately if queue is full */
+	if ( ( syslogs_prod - syslogs_cons ) == SYSLOGS_QUEUE_LEN ) {
+		syslogs_flush ( &syslogs_queue[ syslogs_cons++ %
+						SYSLOGS_QUEUE_LEN ] );
 	}
 
-	/* Clear re-entry flag */
-	syslogs_entered = 0;
+	/* Queue completed log message */
+	message = &syslogs_queue[ syslogs_prod++ % SYSLOGS_QUEUE_LEN ];
+	message->severity = syslogs_severity;
+	memcpy ( message->message, syslogs_buffer,
+		 sizeof ( message->message ) );
+
+	/* Transmit queue immediately for messages of error severity
+	 * or higher (which may precede a crash), otherwise defer
+	 * transmission to the process.
+	 */
+	if ( syslogs_severity <= LOG_ERR ) {
+		while ( syslogs_cons != syslogs_prod ) {
+			syslogs_flush ( &syslogs_queue[ syslogs_cons++ %
+							SYSLOGS_QUEUE_LEN ] );
+		}
+		process_del ( &syslogs_process );
+	} else {
+		process_add ( &syslogs_process );
+	}
 }
 
 /** Encrypted syslog console driver */
@@ -19,6 +19,30 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+/** Transport-layer protocol dispatch map
+ *
+ * The set of transport-layer protocols is fixed at build time; a
+ * dispatch map indexed directly by protocol number replaces the
+ * per-packet table walk on the receive hot path.  The map is built
+ * lazily on first use, since linker table contents cannot be used in
+ * static initialisers.
+ */
+static struct tcpip_protocol *tcpip_map[256];
+
+/** Dispatch map has been initialised */
+static int tcpip_map_initialised;
+
+/**
+ * Initialise transport-layer protocol dispatch map
+ */
+static void tcpip_map_init ( void ) {
+	struct tcpip_protocol *tcpip;
+
+	for_each_table_entry ( tcpip, TCPIP_PROTOCOLS )
+		tcpip_map[ tcpip->tcpip_proto ] = tcpip;
+	tcpip_map_initialised = 1;
+}
+
 /**
  * Process a received TCP/IP packet
  *
@@ -43,14 +67,17 @@ int tcpip_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 	       struct ip_statistics *stats ) {
 	struct tcpip_protocol *tcpip;
 
+	/* Build dispatch map, if necessary */
+	if ( ! tcpip_map_initialised )
+		tcpip_map_init();
+
 	/* Hand off packet to the appropriate transport-layer protocol */
-	for_each_table_entry ( tcpip, TCPIP_PROTOCOLS ) {
-		if ( tcpip->tcpip_proto == tcpip_proto ) {
-			DBG ( "TCP/IP received %s packet\n", tcpip->name );
-			stats->in_delivers++;
-			return tcpip->rx ( iobuf, netdev, st_src, st_dest,
-					   pshdr_csum );
-		}
+	tcpip = tcpip_map[tcpip_proto];
+	if ( tcpip ) {
+		DBG ( "TCP/IP received %s packet\n", tcpip->name );
+		stats->in_delivers++;
+		return tcpip->rx ( iobuf, netdev, st_src, st_dest,
+				   pshdr_csum );
 	}
 
 	DBG ( "Unrecognised TCP/IP protocol %d\n", tcpip_proto );
@@ -169,25 +196,89 @@ size_t tcpip_mtu ( struct sockaddr_tcpip *st_dest ) {
  */
 uint16_t generic_tcpip_continue_chksum ( uint16_t partial,
 					 const void *data, size_t len ) {
-	unsigned int cksum = ( ( ~partial ) & 0xffff );
-	unsigned int value;
-	unsigned int i;
-	
-	for ( i = 0 ; i < len ; i++ ) {
-		value = * ( ( uint8_t * ) data + i );
-		if ( i & 1 ) {
-			/* Odd bytes: swap on little-endian systems */
-			value = be16_to_cpu ( value );
-		} else {
-			/* Even bytes: swap on big-endian systems */
-			value = le16_to_cpu ( value );
-		}
-		cksum += value;
-		if ( cksum > 0xffff )
-			cksum -= 0xffff;
+	uint64_t sum = ( ( ~partial ) & 0xffff );
+	uint64_t acc0 = 0;
+	uint64_t acc1 = 0;
+	uint64_t acc2 = 0;
+	uint64_t acc3 = 0;
+	const uint8_t *bytes = data;
+	const uint32_t *words;
+	unsigned int swapped = 0;
+	unsigned int odd;
+
+	/* Sum individual leading bytes until the data is aligned to a
+	 * 32-bit boundary.  Even bytes are swapped on big-endian
+	 * systems and odd bytes on little-endian systems, as in the
+	 * byte-at-a-time definition of the checksum.
+	 */
+	while ( len && ( ( ( intptr_t ) bytes ) & ( sizeof ( *words ) - 1 ) )){
+		sum += ( swapped ? be16_to_cpu ( *bytes ) :
+			 le16_to_cpu ( *bytes ) );
+		swapped = ( ! swapped );
+		bytes++;
+		len--;
 	}
-	
-	return ( ~cksum );
+
+	/* If an odd number of leading bytes was consumed, then the
+	 * aligned data starts at an odd offset within the stream.
+	 * Fold and byte-swap the partial sum so that the aligned data
+	 * can be summed natively, and swap back afterwards.  (A
+	 * folded one's complement sum is unaffected by being
+	 * byte-swapped along with its data.)
+	 */
+	if ( swapped ) {
+		while ( sum >> 16 )
+			sum = ( ( sum & 0xffff ) + ( sum >> 16 ) );
+		sum = ( ( ( sum & 0xff ) << 8 ) | ( sum >> 8 ) );
+	}
+
+	/* Sum aligned 32-bit words using four independent wide
+	 * accumulators, with all carries deferred to a single final
+	 * fold.  The additions within each iteration have no
+	 * interdependencies and so can be issued in parallel (or
+	 * autovectorised, on targets where the compiler is permitted
+	 * to use vector instructions).
+	 */
+	words = ( ( const void * ) bytes );
+	while ( len >= ( 4 * sizeof ( *words ) ) ) {
+		acc0 += words[0];
+		acc1 += words[1];
+		acc2 += words[2];
+		acc3 += words[3];
+		words += 4;
+		len -= ( 4 * sizeof ( *words ) );
+	}
+	sum += ( acc0 + acc1 + acc2 + acc3 );
+
+	/* Sum remaining aligned 32-bit words */
+	while ( len >= sizeof ( *words ) ) {
+		sum += *(words++);
+		len -= sizeof ( *words );
+	}
+	bytes = ( ( const void * ) words );
+
+	/* Sum trailing bytes (starting at an even offset relative to
+	 * the aligned data, since whole 32-bit words have been
+	 * consumed).
+	 */
+	odd = 0;
+	while ( len ) {
+		sum += ( odd ? be16_to_cpu ( *bytes ) :
+			 le16_to_cpu ( *bytes ) );
+		odd = ( ! odd );
+		bytes++;
+		len--;
+	}
+
+	/* Fold down to 16 bits with end-around carry, and undo any
+	 * byte-swapping performed for odd alignment.
+	 */
+	while ( sum >> 16 )
+		sum = ( ( sum & 0xffff ) + ( sum >> 16 ) );
+	if ( swapped )
+		sum = ( ( ( sum & 0xff ) << 8 ) | ( sum >> 8 ) );
+
+	return ( ~sum );
 }
 
 /**
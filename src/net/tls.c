@@ -45,9 +45,12 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #include <ipxe/x509.h>
 #include <ipxe/privkey.h>
 #include <ipxe/certstore.h>
+#include <ipxe/settings.h>
 #include <ipxe/rbg.h>
 #include <ipxe/validator.h>
 #include <ipxe/job.h>
+#include <ipxe/milestone.h>
+#include <ipxe/x25519.h>
 #include <ipxe/tls.h>
 
 /* Disambiguate the various error causes */
@@ -107,6 +110,18 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #define EINFO_EINVAL_TICKET						\
 	__einfo_uniqify ( EINFO_EINVAL, 0x0e,				\
 			  "Invalid New Session Ticket record")
+#define EINVAL_AEAD __einfo_error ( EINFO_EINVAL_AEAD )
+#define EINFO_EINVAL_AEAD						\
+	__einfo_uniqify ( EINFO_EINVAL, 0x0f,				\
+			  "Invalid AEAD-ciphered record" )
+#define EINVAL_STATUS __einfo_error ( EINFO_EINVAL_STATUS )
+#define EINFO_EINVAL_STATUS						\
+	__einfo_uniqify ( EINFO_EINVAL, 0x10,				\
+			  "Invalid Certificate Status record" )
+#define EINVAL_KEY_EXCHANGE __einfo_error ( EINFO_EINVAL_KEY_EXCHANGE )
+#define EINFO_EINVAL_KEY_EXCHANGE					\
+	__einfo_uniqify ( EINFO_EINVAL, 0x11,				\
+			  "Invalid Server Key Exchange record" )
 #define EIO_ALERT __einfo_error ( EINFO_EIO_ALERT )
 #define EINFO_EIO_ALERT							\
 	__einfo_uniqify ( EINFO_EIO, 0x01,				\
@@ -188,6 +203,7 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 				const void *data, size_t len );
 static void tls_clear_cipher ( struct tls_connection *tls,
 			       struct tls_cipherspec *cipherspec );
+static void tls_session_save ( struct tls_session *session );
 
 /******************************************************************************
  *
@@ -352,6 +368,8 @@ static void free_tls ( struct refcnt *refcnt ) {
 
 	/* Free dynamically-allocated resources */
 	free ( tls->new_session_ticket );
+	free ( tls->server_key );
+	free ( tls->staple );
 	tls_clear_cipher ( tls, &tls->tx_cipherspec );
 	tls_clear_cipher ( tls, &tls->tx_cipherspec_pending );
 	tls_clear_cipher ( tls, &tls->rx_cipherspec );
@@ -462,10 +480,10 @@ static void tls_hmac_update_va ( struct digest_algorithm *digest,
  */
 static void tls_p_hash_va ( struct tls_connection *tls,
 			    struct digest_algorithm *digest,
-			    void *secret, size_t secret_len,
+			    const void *secret, size_t secret_len,
 			    void *out, size_t out_len,
 			    va_list seeds ) {
-	uint8_t secret_copy[secret_len];
+	uint8_t hmac_ctx[ hmac_ctxsize ( digest ) ];
 	uint8_t digest_ctx[digest->ctxsize];
 	uint8_t digest_ctx_partial[digest->ctxsize];
 	uint8_t a[digest->digestsize];
@@ -473,32 +491,31 @@ static void tls_p_hash_va ( struct tls_connection *tls,
 	size_t frag_len = digest->digestsize;
 	va_list tmp;
 
-	/* Copy the secret, in case HMAC modifies it */
-	memcpy ( secret_copy, secret, secret_len );
-	secret = secret_copy;
 	DBGC2 ( tls, "TLS %p %s secret:\n", tls, digest->name );
 	DBGC2_HD ( tls, secret, secret_len );
 
+	/* Precompute HMAC key schedule for the secret */
+	hmac_precompute ( digest, hmac_ctx, secret, secret_len );
+
 	/* Calculate A(1) */
-	hmac_init ( digest, digest_ctx, secret, &secret_len );
+	hmac_start ( digest, hmac_ctx, digest_ctx );
 	va_copy ( tmp, seeds );
 	tls_hmac_update_va ( digest, digest_ctx, tmp );
 	va_end ( tmp );
-	hmac_final ( digest, digest_ctx, secret, &secret_len, a );
+	hmac_finish ( digest, hmac_ctx, digest_ctx, a );
 	DBGC2 ( tls, "TLS %p %s A(1):\n", tls, digest->name );
 	DBGC2_HD ( tls, &a, sizeof ( a ) );
 
 	/* Generate as much data as required */
 	while ( out_len ) {
 		/* Calculate output portion */
-		hmac_init ( digest, digest_ctx, secret, &secret_len );
+		hmac_start ( digest, hmac_ctx, digest_ctx );
 		hmac_update ( digest, digest_ctx, a, sizeof ( a ) );
 		memcpy ( digest_ctx_partial, digest_ctx, digest->ctxsize );
 		va_copy ( tmp, seeds );
 		tls_hmac_update_va ( digest, digest_ctx, tmp );
 		va_end ( tmp );
-		hmac_final ( digest, digest_ctx,
-			     secret, &secret_len, out_tmp );
+		hmac_finish ( digest, hmac_ctx, digest_ctx, out_tmp );
 
 		/* Copy output */
 		if ( frag_len > out_len )
@@ -508,8 +525,7 @@ static void tls_p_hash_va ( struct tls_connection *tls,
 		DBGC2_HD ( tls, out, frag_len );
 
 		/* Calculate A(i) */
-		hmac_final ( digest, digest_ctx_partial,
-			     secret, &secret_len, a );
+		hmac_finish ( digest, hmac_ctx, digest_ctx_partial, a );
 		DBGC2 ( tls, "TLS %p %s A(n):\n", tls, digest->name );
 		DBGC2_HD ( tls, &a, sizeof ( a ) );
 
@@ -528,13 +544,13 @@ static void tls_p_hash_va ( struct tls_connection *tls,
  * @v out_len		Length of output buffer
  * @v ...		( data, len ) pairs of seed data, terminated by NULL
  */
-static void tls_prf ( struct tls_connection *tls, void *secret,
+static void tls_prf ( struct tls_connection *tls, const void *secret,
 		      size_t secret_len, void *out, size_t out_len, ... ) {
 	va_list seeds;
 	va_list tmp;
 	size_t subsecret_len;
-	void *md5_secret;
-	void *sha1_secret;
+	const void *md5_secret;
+	const void *sha1_secret;
 	uint8_t buf[out_len];
 	unsigned int i;
 
@@ -599,21 +615,22 @@ static void tls_prf ( struct tls_connection *tls, void *secret,
  * Generate master secret
  *
  * @v tls		TLS connection
+ * @v pre_master_secret	Pre-master secret
+ * @v pre_master_secret_len Length of pre-master secret
  *
- * The pre-master secret and the client and server random values must
- * already be known.
+ * The client and server random values must already be known.
  */
-static void tls_generate_master_secret ( struct tls_connection *tls ) {
+static void tls_generate_master_secret ( struct tls_connection *tls,
+					 const void *pre_master_secret,
+					 size_t pre_master_secret_len ) {
 	DBGC ( tls, "TLS %p pre-master-secret:\n", tls );
-	DBGC_HD ( tls, &tls->pre_master_secret,
-		  sizeof ( tls->pre_master_secret ) );
+	DBGC_HD ( tls, pre_master_secret, pre_master_secret_len );
 	DBGC ( tls, "TLS %p client random bytes:\n", tls );
 	DBGC_HD ( tls, &tls->client_random, sizeof ( tls->client_random ) );
 	DBGC ( tls, "TLS %p server random bytes:\n", tls );
 	DBGC_HD ( tls, &tls->server_random, sizeof ( tls->server_random ) );
 
-	tls_prf_label ( tls, &tls->pre_master_secret,
-			sizeof ( tls->pre_master_secret ),
+	tls_prf_label ( tls, pre_master_secret, pre_master_secret_len,
 			&tls->master_secret, sizeof ( tls->master_secret ),
 			"master secret",
 			&tls->client_random, sizeof ( tls->client_random ),
@@ -633,9 +650,13 @@ static void tls_generate_master_secret ( struct tls_connection *tls ) {
 static int tls_generate_keys ( struct tls_connection *tls ) {
 	struct tls_cipherspec *tx_cipherspec = &tls->tx_cipherspec_pending;
 	struct tls_cipherspec *rx_cipherspec = &tls->rx_cipherspec_pending;
-	size_t hash_size = tx_cipherspec->suite->digest->digestsize;
+	struct cipher_algorithm *cipher = tx_cipherspec->suite->cipher;
+	size_t hash_size = ( is_auth_cipher ( cipher ) ? 0 :
+			     tx_cipherspec->suite->digest->digestsize );
 	size_t key_size = tx_cipherspec->suite->key_len;
-	size_t iv_size = tx_cipherspec->suite->cipher->blocksize;
+	size_t iv_size = ( is_auth_cipher ( cipher ) ?
+			   tx_cipherspec->suite->fixed_iv_len :
+			   cipher->blocksize );
 	size_t total = ( 2 * ( hash_size + key_size + iv_size ) );
 	uint8_t key_block[total];
 	uint8_t *key;
@@ -688,14 +709,14 @@ static int tls_generate_keys ( struct tls_connection *tls ) {
 
 	/* TX initialisation vector */
 	cipher_setiv ( tx_cipherspec->suite->cipher,
-		       tx_cipherspec->cipher_ctx, key );
+		       tx_cipherspec->cipher_ctx, key, iv_size );
 	DBGC ( tls, "TLS %p TX IV:\n", tls );
 	DBGC_HD ( tls, key, iv_size );
 	key += iv_size;
 
 	/* RX initialisation vector */
 	cipher_setiv ( rx_cipherspec->suite->cipher,
-		       rx_cipherspec->cipher_ctx, key );
+		       rx_cipherspec->cipher_ctx, key, iv_size );
 	DBGC ( tls, "TLS %p RX IV:\n", tls );
 	DBGC_HD ( tls, key, iv_size );
 	key += iv_size;
@@ -714,6 +735,7 @@ static int tls_generate_keys ( struct tls_connection *tls ) {
 
 /** Null cipher suite */
 struct tls_cipher_suite tls_cipher_suite_null = {
+	.exchange = &tls_pubkey_exchange_algorithm,
 	.pubkey = &pubkey_null,
 	.cipher = &cipher_null,
 	.digest = &digest_null,
@@ -893,6 +915,27 @@ tls_signature_hash_algorithm ( struct pubkey_algorithm *pubkey,
 	return NULL;
 }
 
+/**
+ * Find TLS signature and hash algorithm by numeric code
+ *
+ * @v code		Numeric code
+ * @ret sig_hash	Signature and hash algorithm, or NULL
+ */
+static struct tls_signature_hash_algorithm *
+tls_signature_hash_code ( const struct tls_signature_hash_id *code ) {
+	struct tls_signature_hash_algorithm *sig_hash;
+
+	/* Identify signature and hash algorithm */
+	for_each_table_entry ( sig_hash, TLS_SIG_HASH_ALGORITHMS ) {
+		if ( memcmp ( &sig_hash->code, code,
+			      sizeof ( sig_hash->code ) ) == 0 ) {
+			return sig_hash;
+		}
+	}
+
+	return NULL;
+}
+
 /******************************************************************************
  *
  * Handshake verification
@@ -1041,6 +1084,19 @@ static int tls_send_client_hello ( struct tls_connection *tls ) {
 			struct {
 				uint8_t max;
 			} __attribute__ (( packed )) max_fragment_length;
+			uint16_t status_request_type;
+			uint16_t status_request_len;
+			struct {
+				uint8_t type;
+				uint16_t responders_len;
+				uint16_t extensions_len;
+			} __attribute__ (( packed )) status_request;
+			uint16_t elliptic_curves_type;
+			uint16_t elliptic_curves_len;
+			struct {
+				uint16_t len;
+				uint16_t code[1];
+			} __attribute__ (( packed )) elliptic_curves;
 			uint16_t signature_algorithms_type;
 			uint16_t signature_algorithms_len;
 			struct {
@@ -1071,6 +1127,7 @@ static int tls_send_client_hello ( struct tls_connection *tls ) {
 	hello.type_length = ( cpu_to_le32 ( TLS_CLIENT_HELLO ) |
 			      htonl ( sizeof ( hello ) -
 				      sizeof ( hello.type_length ) ) );
+	tls->client_version = tls->version;
 	hello.version = htons ( tls->version );
 	memcpy ( &hello.random, &tls->client_random, sizeof ( hello.random ) );
 	hello.session_id_len = tls->session_id_len;
@@ -1097,6 +1154,17 @@ static int tls_send_client_hello ( struct tls_connection *tls ) {
 		= htons ( sizeof ( hello.extensions.max_fragment_length ) );
 	hello.extensions.max_fragment_length.max
 		= TLS_MAX_FRAGMENT_LENGTH_4096;
+	hello.extensions.status_request_type = htons ( TLS_STATUS_REQUEST );
+	hello.extensions.status_request_len
+		= htons ( sizeof ( hello.extensions.status_request ) );
+	hello.extensions.status_request.type = TLS_STATUS_TYPE_OCSP;
+	hello.extensions.elliptic_curves_type = htons ( TLS_ELLIPTIC_CURVES );
+	hello.extensions.elliptic_curves_len
+		= htons ( sizeof ( hello.extensions.elliptic_curves ) );
+	hello.extensions.elliptic_curves.len
+		= htons ( sizeof ( hello.extensions.elliptic_curves.code ) );
+	hello.extensions.elliptic_curves.code[0]
+		= htons ( TLS_NAMED_CURVE_X25519 );
 	hello.extensions.signature_algorithms_type
 		= htons ( TLS_SIGNATURE_ALGORITHMS );
 	hello.extensions.signature_algorithms_len
@@ -1169,15 +1237,16 @@ static int tls_send_certificate ( struct tls_connection *tls ) {
 }
 
 /**
- * Transmit Client Key Exchange record
+ * Transmit Client Key Exchange record using public key exchange
  *
  * @v tls		TLS connection
  * @ret rc		Return status code
  */
-static int tls_send_client_key_exchange ( struct tls_connection *tls ) {
+static int tls_send_client_key_exchange_pubkey ( struct tls_connection *tls ) {
 	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec_pending;
 	struct pubkey_algorithm *pubkey = cipherspec->suite->pubkey;
 	size_t max_len = pubkey_max_len ( pubkey, cipherspec->pubkey_ctx );
+	struct tls_pre_master_secret pre_master_secret;
 	struct {
 		uint32_t type_length;
 		uint16_t encrypted_pre_master_secret_len;
@@ -1187,11 +1256,24 @@ static int tls_send_client_key_exchange ( struct tls_connection *tls ) {
 	int len;
 	int rc;
 
+	/* Generate pre-master secret */
+	pre_master_secret.version = htons ( tls->client_version );
+	if ( ( rc = tls_generate_random ( tls, &pre_master_secret.random,
+			  ( sizeof ( pre_master_secret.random ) ) ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not generate pre-master secret: "
+		       "%s\n", tls, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Generate master secret */
+	tls_generate_master_secret ( tls, &pre_master_secret,
+				     sizeof ( pre_master_secret ) );
+
 	/* Encrypt pre-master secret using server's public key */
 	memset ( &key_xchg, 0, sizeof ( key_xchg ) );
 	len = pubkey_encrypt ( pubkey, cipherspec->pubkey_ctx,
-			       &tls->pre_master_secret,
-			       sizeof ( tls->pre_master_secret ),
+			       &pre_master_secret,
+			       sizeof ( pre_master_secret ),
 			       key_xchg.encrypted_pre_master_secret );
 	if ( len < 0 ) {
 		rc = len;
@@ -1212,6 +1294,183 @@ static int tls_send_client_key_exchange ( struct tls_connection *tls ) {
 				    ( sizeof ( key_xchg ) - unused ) );
 }
 
+/** Public key exchange algorithm */
+struct tls_key_exchange_algorithm tls_pubkey_exchange_algorithm = {
+	.name = "pubkey",
+	.exchange = tls_send_client_key_exchange_pubkey,
+};
+
+/**
+ * Transmit Client Key Exchange record using ECDHE key exchange
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls_send_client_key_exchange_ecdhe ( struct tls_connection *tls ) {
+	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec_pending;
+	struct pubkey_algorithm *pubkey = cipherspec->suite->pubkey;
+	struct digest_algorithm *digest;
+	const struct {
+		uint8_t curve_type;
+		uint16_t named_curve;
+		uint8_t public_len;
+		uint8_t public[X25519_LEN];
+	} __attribute__ (( packed )) *ecdh = tls->server_key;
+	const struct {
+		uint16_t len;
+		uint8_t data[0];
+	} __attribute__ (( packed )) *signature;
+	struct {
+		uint32_t type_length;
+		uint8_t public_len;
+		uint8_t public[X25519_LEN];
+	} __attribute__ (( packed )) key_xchg;
+	uint8_t private[X25519_LEN];
+	uint8_t shared[X25519_LEN];
+	const void *remaining;
+	size_t remaining_len;
+	int rc;
+
+	/* Parse ephemeral ECDH parameters */
+	if ( ( tls->server_key_len < sizeof ( *ecdh ) ) ||
+	     ( ecdh->curve_type != TLS_NAMED_CURVE_TYPE ) ||
+	     ( ecdh->named_curve != htons ( TLS_NAMED_CURVE_X25519 ) ) ||
+	     ( ecdh->public_len != sizeof ( ecdh->public ) ) ) {
+		DBGC ( tls, "TLS %p received unsupported ECDH parameters\n",
+		       tls );
+		DBGC_HD ( tls, tls->server_key, tls->server_key_len );
+		return -EINVAL_KEY_EXCHANGE;
+	}
+	remaining = ( tls->server_key + sizeof ( *ecdh ) );
+	remaining_len = ( tls->server_key_len - sizeof ( *ecdh ) );
+
+	/* Identify signature and hash algorithm.  TLSv1.2 and later
+	 * use explicit algorithm identifiers; earlier versions use a
+	 * combined MD5+SHA1 digest.
+	 */
+	if ( tls->version >= TLS_VERSION_TLS_1_2 ) {
+		const struct tls_signature_hash_id *code = remaining;
+		struct tls_signature_hash_algorithm *sig_hash;
+
+		if ( remaining_len < sizeof ( *code ) ) {
+			DBGC ( tls, "TLS %p received underlength Server Key "
+			       "Exchange\n", tls );
+			DBGC_HD ( tls, tls->server_key, tls->server_key_len );
+			return -EINVAL_KEY_EXCHANGE;
+		}
+		sig_hash = tls_signature_hash_code ( code );
+		if ( ( sig_hash == NULL ) || ( sig_hash->pubkey != pubkey ) ) {
+			DBGC ( tls, "TLS %p unsupported signature and hash "
+			       "algorithm (%d,%d)\n", tls, code->hash,
+			       code->signature );
+			return -ENOTSUP_SIG_HASH;
+		}
+		digest = sig_hash->digest;
+		remaining += sizeof ( *code );
+		remaining_len -= sizeof ( *code );
+	} else {
+		digest = &md5_sha1_algorithm;
+	}
+
+	/* Parse signature */
+	signature = remaining;
+	if ( ( remaining_len < sizeof ( *signature ) ) ||
+	     ( ntohs ( signature->len ) !=
+	       ( remaining_len - sizeof ( *signature ) ) ) ) {
+		DBGC ( tls, "TLS %p received malformed ECDH signature\n", tls );
+		DBGC_HD ( tls, tls->server_key, tls->server_key_len );
+		return -EINVAL_KEY_EXCHANGE;
+	}
+
+	/* Verify signature over the client and server random values
+	 * and the ephemeral ECDH parameters, using the server's
+	 * certified public key.
+	 */
+	{
+		uint8_t ctx[ digest->ctxsize ];
+		uint8_t hash[ digest->digestsize ];
+
+		digest_init ( digest, ctx );
+		digest_update ( digest, ctx, &tls->client_random,
+				sizeof ( tls->client_random ) );
+		digest_update ( digest, ctx, tls->server_random,
+				sizeof ( tls->server_random ) );
+		digest_update ( digest, ctx, ecdh, sizeof ( *ecdh ) );
+		digest_final ( digest, ctx, hash );
+		if ( ( rc = pubkey_verify ( pubkey, cipherspec->pubkey_ctx,
+					    digest, hash, signature->data,
+					    ntohs ( signature->len ) ) ) != 0 ){
+			DBGC ( tls, "TLS %p could not verify ECDH parameters: "
+			       "%s\n", tls, strerror ( rc ) );
+			return rc;
+		}
+	}
+
+	/* Generate ephemeral private key and corresponding public point */
+	if ( ( rc = tls_generate_random ( tls, private,
+					  sizeof ( private ) ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not generate ECDH private key: "
+		       "%s\n", tls, strerror ( rc ) );
+		return rc;
+	}
+	memset ( &key_xchg, 0, sizeof ( key_xchg ) );
+	if ( ( rc = x25519 ( private, x25519_base, key_xchg.public ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not generate ECDH public key: %s\n",
+		       tls, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Calculate shared secret and generate master secret */
+	if ( ( rc = x25519 ( private, ecdh->public, shared ) ) != 0 ) {
+		DBGC ( tls, "TLS %p invalid ECDH server public key: %s\n",
+		       tls, strerror ( rc ) );
+		return rc;
+	}
+	tls_generate_master_secret ( tls, shared, sizeof ( shared ) );
+
+	/* Transmit Client Key Exchange record */
+	key_xchg.type_length =
+		( cpu_to_le32 ( TLS_CLIENT_KEY_EXCHANGE ) |
+		  htonl ( sizeof ( key_xchg ) -
+			  sizeof ( key_xchg.type_length ) ) );
+	key_xchg.public_len = sizeof ( key_xchg.public );
+
+	return tls_send_handshake ( tls, &key_xchg, sizeof ( key_xchg ) );
+}
+
+/** Ephemeral ECDH key exchange algorithm */
+struct tls_key_exchange_algorithm tls_ecdhe_exchange_algorithm = {
+	.name = "ecdhe",
+	.exchange = tls_send_client_key_exchange_ecdhe,
+};
+
+/**
+ * Transmit Client Key Exchange record
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls_send_client_key_exchange ( struct tls_connection *tls ) {
+	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec_pending;
+	struct tls_cipher_suite *suite = cipherspec->suite;
+	int rc;
+
+	/* Perform key exchange */
+	if ( ( rc = suite->exchange->exchange ( tls ) ) != 0 )
+		return rc;
+
+	/* Generate keys from the newly generated master secret */
+	if ( ( rc = tls_generate_keys ( tls ) ) != 0 )
+		return rc;
+
+	/* Free any recorded Server Key Exchange record */
+	free ( tls->server_key );
+	tls->server_key = NULL;
+	tls->server_key_len = 0;
+
+	return 0;
+}
+
 /**
  * Transmit Certificate Verify record
  *
@@ -1589,20 +1848,26 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 	if ( ( rc = tls_select_cipher ( tls, hello_b->cipher_suite ) ) != 0 )
 		return rc;
 
-	/* Reuse or generate master secret */
+	/* Reuse or defer generation of master secret */
 	if ( hello_a->session_id_len &&
 	     ( hello_a->session_id_len == tls->session_id_len ) &&
 	     ( memcmp ( session_id, tls->session_id,
 			tls->session_id_len ) == 0 ) ) {
 
-		/* Session ID match: reuse master secret */
+		/* Session ID match: reuse master secret, and
+		 * generate keys immediately since no Client Key
+		 * Exchange will be sent.
+		 */
 		DBGC ( tls, "TLS %p resuming session ID:\n", tls );
 		DBGC_HDA ( tls, 0, tls->session_id, tls->session_id_len );
+		if ( ( rc = tls_generate_keys ( tls ) ) != 0 )
+			return rc;
 
 	} else {
 
-		/* Generate new master secret */
-		tls_generate_master_secret ( tls );
+		/* Full handshake: master secret and keys will be
+		 * generated at the time of the Client Key Exchange.
+		 */
 
 		/* Record new session ID, if present */
 		if ( hello_a->session_id_len &&
@@ -1616,10 +1881,6 @@ static int tls_new_server_hello ( struct tls_connection *tls,
 		}
 	}
 
-	/* Generate keys */
-	if ( ( rc = tls_generate_keys ( tls ) ) != 0 )
-		return rc;
-
 	/* Handle secure renegotiation */
 	if ( tls->secure_renegotiation ) {
 
@@ -1790,6 +2051,8 @@ static int tls_new_certificate ( struct tls_connection *tls,
 		tls24_t length;
 		uint8_t certificates[0];
 	} __attribute__ (( packed )) *certificate = data;
+	struct digest_algorithm *digest = &sha256_algorithm;
+	uint8_t ctx[digest->ctxsize];
 	size_t certificates_len;
 	int rc;
 
@@ -1813,6 +2076,99 @@ static int tls_new_certificate ( struct tls_connection *tls,
 				      certificates_len ) ) != 0 )
 		return rc;
 
+	/* Record digest of certificate message contents, for
+	 * comparison against any trusted transcript.
+	 */
+	digest_init ( digest, ctx );
+	digest_update ( digest, ctx, certificate->certificates,
+			certificates_len );
+	digest_final ( digest, ctx, tls->chain_digest );
+
+	return 0;
+}
+
+/**
+ * Receive new Certificate Status handshake record
+ *
+ * @v tls		TLS connection
+ * @v data		Plaintext handshake record
+ * @v len		Length of plaintext handshake record
+ * @ret rc		Return status code
+ */
+static int tls_new_certificate_status ( struct tls_connection *tls,
+					const void *data, size_t len ) {
+	const struct {
+		uint8_t type;
+		tls24_t length;
+		uint8_t response[0];
+	} __attribute__ (( packed )) *status = data;
+	size_t response_len;
+
+	/* Parse header */
+	if ( sizeof ( *status ) > len ) {
+		DBGC ( tls, "TLS %p received underlength Certificate "
+		       "Status\n", tls );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_STATUS;
+	}
+	response_len = tls_uint24 ( &status->length );
+	if ( response_len > ( len - sizeof ( *status ) ) ) {
+		DBGC ( tls, "TLS %p received overlength Certificate Status\n",
+		       tls );
+		DBGC_HD ( tls, data, len );
+		return -EINVAL_STATUS;
+	}
+
+	/* Ignore any status type other than OCSP */
+	if ( status->type != TLS_STATUS_TYPE_OCSP ) {
+		DBGC ( tls, "TLS %p ignoring status type %d\n",
+		       tls, status->type );
+		return 0;
+	}
+
+	/* Discard any previous stapled response */
+	free ( tls->staple );
+	tls->staple = NULL;
+	tls->staple_len = 0;
+
+	/* Record stapled OCSP response */
+	tls->staple = malloc ( response_len );
+	if ( ! tls->staple )
+		return -ENOMEM;
+	memcpy ( tls->staple, status->response, response_len );
+	tls->staple_len = response_len;
+	DBGC ( tls, "TLS %p received stapled OCSP response:\n", tls );
+	DBGC_HDA ( tls, 0, tls->staple, tls->staple_len );
+
+	return 0;
+}
+
+/**
+ * Receive new Server Key Exchange handshake record
+ *
+ * @v tls		TLS connection
+ * @v data		Plaintext handshake record
+ * @v len		Length of plaintext handshake record
+ * @ret rc		Return status code
+ */
+static int tls_new_server_key_exchange ( struct tls_connection *tls,
+					 const void *data, size_t len ) {
+
+	/* Free any existing Server Key Exchange record */
+	free ( tls->server_key );
+	tls->server_key = NULL;
+	tls->server_key_len = 0;
+
+	/* Record Server Key Exchange record for processing by the key
+	 * exchange mechanism at the time of the Client Key Exchange
+	 * (i.e. after certificate validation has completed).
+	 */
+	tls->server_key = malloc ( len );
+	if ( ! tls->server_key )
+		return -ENOMEM;
+	memcpy ( tls->server_key, data, len );
+	tls->server_key_len = len;
+
 	return 0;
 }
 
@@ -1849,6 +2205,155 @@ static int tls_new_certificate_request ( struct tls_connection *tls,
 	return 0;
 }
 
+/** Trusted certificate transcript setting
+ *
+ * This setting is updated only if it already exists: create it (with
+ * any value) within a non-volatile settings block to allow a server
+ * Certificate message that matches the previously validated handshake
+ * byte-for-byte to be trusted without revalidation.  Note that this
+ * bypasses revocation checks until the server's certificate chain
+ * next changes.
+ */
+static struct setting cert_trust_setting __setting ( SETTING_CRYPTO,
+						     cert-trust ) = {
+	.name = "cert-trust",
+	.description = "Trusted certificate digest",
+	.type = &setting_type_hex,
+};
+
+/** A persistent certificate trust record */
+struct tls_persistent_trust {
+	/** Digest of the server Certificate message contents */
+	uint8_t digest[SHA256_DIGEST_SIZE];
+	/** Server name (NUL-terminated) */
+	char name[0];
+} __attribute__ (( packed ));
+
+/**
+ * Check certificate chain against trusted transcript, if applicable
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls_trust_check ( struct tls_connection *tls ) {
+	struct tls_session *session = tls->session;
+	struct tls_persistent_trust *trust;
+	void *data;
+	size_t name_len;
+	int len;
+	int rc;
+
+	/* Fetch trust record, if any */
+	len = fetch_raw_setting_copy ( NULL, &cert_trust_setting, &data );
+	if ( len < 0 )
+		return len;
+	trust = data;
+
+	/* Ignore records that are malformed, for other servers, or
+	 * for other certificate chains.
+	 */
+	rc = -ENOENT;
+	if ( ( ( size_t ) len ) <= sizeof ( *trust ) )
+		goto mismatch;
+	name_len = strnlen ( trust->name, ( len - sizeof ( *trust ) ) );
+	if ( name_len == ( len - sizeof ( *trust ) ) )
+		goto mismatch;
+	if ( strcmp ( trust->name, session->name ) != 0 )
+		goto mismatch;
+	if ( memcmp ( trust->digest, tls->chain_digest,
+		      sizeof ( trust->digest ) ) != 0 )
+		goto mismatch;
+	rc = 0;
+
+ mismatch:
+	free ( data );
+	return rc;
+}
+
+/**
+ * Persist trusted certificate transcript, if applicable
+ *
+ * @v tls		TLS connection
+ */
+static void tls_trust_save ( struct tls_connection *tls ) {
+	struct tls_session *session = tls->session;
+	struct tls_persistent_trust *trust;
+	struct settings *origin;
+	size_t name_len = strlen ( session->name );
+	size_t len;
+	int rc;
+
+	/* Persist trust records only if the setting already exists,
+	 * so that bypassing revalidation remains an explicit opt-in.
+	 */
+	if ( fetch_setting ( NULL, &cert_trust_setting, &origin, NULL,
+			     NULL, 0 ) < 0 )
+		return;
+
+	/* Construct trust record */
+	len = ( sizeof ( *trust ) + name_len + 1 /* NUL */ );
+	trust = zalloc ( len );
+	if ( ! trust )
+		return;
+	memcpy ( trust->digest, tls->chain_digest,
+		 sizeof ( trust->digest ) );
+	strcpy ( trust->name, session->name );
+
+	/* Store in the setting's originating settings block */
+	if ( ( rc = store_setting ( origin, &cert_trust_setting,
+				    trust, len ) ) != 0 ) {
+		DBGC ( tls, "TLS %p could not persist trust record: %s\n",
+		       tls, strerror ( rc ) );
+	}
+	free ( trust );
+}
+
+/**
+ * Proceed with handshake using a trusted certificate chain
+ *
+ * @v tls		TLS connection
+ * @ret rc		Return status code
+ */
+static int tls_trusted ( struct tls_connection *tls ) {
+	struct tls_session *session = tls->session;
+	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec_pending;
+	struct pubkey_algorithm *pubkey = cipherspec->suite->pubkey;
+	struct x509_certificate *cert;
+	int rc;
+
+	/* Extract first certificate */
+	cert = x509_first ( tls->chain );
+	assert ( cert != NULL );
+
+	/* Verify server name */
+	if ( ( rc = x509_check_name ( cert, session->name ) ) != 0 ) {
+		DBGC ( tls, "TLS %p server certificate does not match %s: %s\n",
+		       tls, session->name, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Initialise public key algorithm */
+	if ( ( rc = pubkey_init ( pubkey, cipherspec->pubkey_ctx,
+				  cert->subject.public_key.raw.data,
+				  cert->subject.public_key.raw.len ) ) != 0 ) {
+		DBGC ( tls, "TLS %p cannot initialise public key: %s\n",
+		       tls, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Schedule Client Key Exchange, Change Cipher, and Finished */
+	tls->tx_pending |= ( TLS_TX_CLIENT_KEY_EXCHANGE |
+			     TLS_TX_CHANGE_CIPHER |
+			     TLS_TX_FINISHED );
+	if ( tls->cert ) {
+		tls->tx_pending |= ( TLS_TX_CERTIFICATE |
+				     TLS_TX_CERTIFICATE_VERIFY );
+	}
+	tls_tx_resume ( tls );
+
+	return 0;
+}
+
 /**
  * Receive new Server Hello Done handshake record
  *
@@ -1872,8 +2377,18 @@ static int tls_new_server_hello_done ( struct tls_connection *tls,
 		return -EINVAL_HELLO_DONE;
 	}
 
+	/* Skip cryptographic validation if the certificate chain
+	 * matches a previously validated transcript byte-for-byte.
+	 */
+	if ( tls_trust_check ( tls ) == 0 ) {
+		DBGC ( tls, "TLS %p certificate chain matches trusted "
+		       "transcript\n", tls );
+		return tls_trusted ( tls );
+	}
+
 	/* Begin certificate validation */
-	if ( ( rc = create_validator ( &tls->validator, tls->chain ) ) != 0 ) {
+	if ( ( rc = create_validator ( &tls->validator, tls->chain,
+				       tls->staple, tls->staple_len ) ) != 0 ) {
 		DBGC ( tls, "TLS %p could not start certificate validation: "
 		       "%s\n", tls, strerror ( rc ) );
 		return rc;
@@ -1922,6 +2437,9 @@ static int tls_new_finished ( struct tls_connection *tls,
 	/* Mark server as finished */
 	pending_put ( &tls->server_negotiation );
 
+	/* Record milestone */
+	milestone ( "tls" );
+
 	/* If we are resuming a session (i.e. if the server Finished
 	 * arrives before the client Finished is sent), then schedule
 	 * transmission of Change Cipher and Finished.
@@ -1946,6 +2464,7 @@ static int tls_new_finished ( struct tls_connection *tls,
 		session->ticket_len = tls->new_session_ticket_len;
 		tls->new_session_ticket = NULL;
 		tls->new_session_ticket_len = 0;
+		tls_session_save ( session );
 	}
 
 	/* Move to end of session's connection list and allow other
@@ -2017,6 +2536,14 @@ static int tls_new_handshake ( struct tls_connection *tls,
 		case TLS_CERTIFICATE:
 			rc = tls_new_certificate ( tls, payload, payload_len );
 			break;
+		case TLS_CERTIFICATE_STATUS:
+			rc = tls_new_certificate_status ( tls, payload,
+							  payload_len );
+			break;
+		case TLS_SERVER_KEY_EXCHANGE:
+			rc = tls_new_server_key_exchange ( tls, payload,
+							   payload_len );
+			break;
 		case TLS_CERTIFICATE_REQUEST:
 			rc = tls_new_certificate_request ( tls, payload,
 							   payload_len );
@@ -2282,6 +2809,48 @@ static void * tls_assemble_block ( struct tls_connection *tls,
 	return plaintext;
 }
 
+/**
+ * Allocate and assemble AEAD-ciphered record from data portion
+ *
+ * @v tls		TLS connection
+ * @ret data		Data
+ * @ret len		Length of data
+ * @ret plaintext_len	Length of plaintext record
+ * @ret plaintext	Allocated plaintext record
+ */
+static void * tls_assemble_aead ( struct tls_connection *tls, const void *data,
+				  size_t len, size_t *plaintext_len ) {
+	struct tls_cipher_suite *suite = tls->tx_cipherspec.suite;
+	size_t authsize = suite->cipher->authsize;
+	uint64_t nonce;
+	void *plaintext;
+	void *content;
+
+	/* Calculate record length, including the explicit portion of
+	 * the nonce (if any)
+	 */
+	*plaintext_len = ( suite->record_iv_len + len + authsize );
+
+	/* Allocate AEAD-ciphered struct, always including space for
+	 * the full sequence number since the cipher consumes it as
+	 * per-record nonce material even when none of it appears
+	 * explicitly within the record
+	 */
+	plaintext = zalloc ( sizeof ( nonce ) + len + authsize );
+	if ( ! plaintext )
+		return NULL;
+	content = ( plaintext + sizeof ( nonce ) );
+
+	/* Fill in AEAD-ciphered struct, using the record sequence
+	 * number as the per-record portion of the nonce
+	 */
+	nonce = cpu_to_be64 ( tls->tx_seq );
+	memcpy ( plaintext, &nonce, sizeof ( nonce ) );
+	memcpy ( content, data, len );
+
+	return plaintext;
+}
+
 /**
  * Send plaintext record
  *
@@ -2297,12 +2866,15 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 	struct tls_header *tlshdr;
 	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec;
 	struct cipher_algorithm *cipher = cipherspec->suite->cipher;
+	size_t record_iv_len = cipherspec->suite->record_iv_len;
 	void *plaintext = NULL;
 	size_t plaintext_len;
 	struct io_buffer *ciphertext = NULL;
 	size_t ciphertext_len;
 	size_t mac_len = cipherspec->suite->digest->digestsize;
 	uint8_t mac[mac_len];
+	uint64_t aead_seq;
+	void *aead;
 	int rc;
 
 	/* Construct header */
@@ -2310,11 +2882,17 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 	plaintext_tlshdr.version = htons ( tls->version );
 	plaintext_tlshdr.length = htons ( len );
 
-	/* Calculate MAC */
-	tls_hmac ( cipherspec, tls->tx_seq, &plaintext_tlshdr, data, len, mac );
+	/* Calculate MAC (not used by AEAD ciphers) */
+	if ( ! is_auth_cipher ( cipher ) ) {
+		tls_hmac ( cipherspec, tls->tx_seq, &plaintext_tlshdr, data,
+			   len, mac );
+	}
 
 	/* Allocate and assemble plaintext struct */
-	if ( is_stream_cipher ( cipher ) ) {
+	if ( is_auth_cipher ( cipher ) ) {
+		plaintext = tls_assemble_aead ( tls, data, len,
+						&plaintext_len );
+	} else if ( is_stream_cipher ( cipher ) ) {
 		plaintext = tls_assemble_stream ( tls, data, len, mac,
 						  &plaintext_len );
 	} else {
@@ -2348,8 +2926,36 @@ static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 	tlshdr->length = htons ( plaintext_len );
 	memcpy ( cipherspec->cipher_next_ctx, cipherspec->cipher_ctx,
 		 cipher->ctxsize );
-	cipher_encrypt ( cipher, cipherspec->cipher_next_ctx, plaintext,
-			 iob_put ( ciphertext, plaintext_len ), plaintext_len );
+	if ( is_auth_cipher ( cipher ) ) {
+
+		/* Set per-record nonce and authenticate the implicit
+		 * record header
+		 */
+		aead = iob_put ( ciphertext, plaintext_len );
+		aead_seq = cpu_to_be64 ( tls->tx_seq );
+		cipher_setiv ( cipher, cipherspec->cipher_next_ctx, plaintext,
+			       sizeof ( aead_seq ) );
+		cipher_encrypt ( cipher, cipherspec->cipher_next_ctx,
+				 &aead_seq, NULL, sizeof ( aead_seq ) );
+		cipher_encrypt ( cipher, cipherspec->cipher_next_ctx,
+				 &plaintext_tlshdr, NULL,
+				 sizeof ( plaintext_tlshdr ) );
+
+		/* Copy explicit nonce (if any), encrypt data, and
+		 * append tag
+		 */
+		memcpy ( aead, plaintext, record_iv_len );
+		cipher_encrypt ( cipher, cipherspec->cipher_next_ctx,
+				 ( plaintext + sizeof ( aead_seq ) ),
+				 ( aead + record_iv_len ), len );
+		cipher_auth ( cipher, cipherspec->cipher_next_ctx,
+			      ( aead + record_iv_len + len ) );
+	} else {
+		cipher_encrypt ( cipher, cipherspec->cipher_next_ctx,
+				 plaintext,
+				 iob_put ( ciphertext, plaintext_len ),
+				 plaintext_len );
+	}
 
 	/* Free plaintext as soon as possible to conserve memory */
 	free ( plaintext );
@@ -2459,6 +3065,91 @@ static int tls_split_block ( struct tls_connection *tls,
 	return 0;
 }
 
+/**
+ * Decrypt and verify received AEAD-ciphered record
+ *
+ * @v tls		TLS connection
+ * @v tlshdr		Record header
+ * @v rx_data		List of received data buffers
+ * @ret rc		Return status code
+ */
+static int tls_new_ciphertext_aead ( struct tls_connection *tls,
+				     struct tls_header *tlshdr,
+				     struct list_head *rx_data ) {
+	struct tls_cipherspec *cipherspec = &tls->rx_cipherspec;
+	struct cipher_algorithm *cipher = cipherspec->suite->cipher;
+	size_t record_iv_len = cipherspec->suite->record_iv_len;
+	struct tls_header plaintext_tlshdr;
+	uint8_t verify_auth[cipher->authsize];
+	struct io_buffer *iobuf;
+	uint64_t seq;
+	void *auth;
+	size_t len = 0;
+
+	/* Initialise the cipher using the explicit nonce, if the
+	 * suite includes one, or the implicit record sequence number
+	 * otherwise
+	 */
+	seq = cpu_to_be64 ( tls->rx_seq );
+	if ( record_iv_len ) {
+		iobuf = list_first_entry ( rx_data, struct io_buffer, list );
+		assert ( iobuf != NULL );
+		if ( iob_len ( iobuf ) < record_iv_len ) {
+			DBGC ( tls, "TLS %p received underlength nonce\n",
+			       tls );
+			DBGC_HD ( tls, iobuf->data, iob_len ( iobuf ) );
+			return -EINVAL_AEAD;
+		}
+		cipher_setiv ( cipher, cipherspec->cipher_ctx, iobuf->data,
+			       record_iv_len );
+		iob_pull ( iobuf, record_iv_len );
+	} else {
+		cipher_setiv ( cipher, cipherspec->cipher_ctx, &seq,
+			       sizeof ( seq ) );
+	}
+
+	/* Extract authentication tag */
+	iobuf = list_last_entry ( rx_data, struct io_buffer, list );
+	assert ( iobuf != NULL );
+	if ( iob_len ( iobuf ) < cipher->authsize ) {
+		DBGC ( tls, "TLS %p received underlength auth tag\n", tls );
+		DBGC_HD ( tls, iobuf->data, iob_len ( iobuf ) );
+		return -EINVAL_AEAD;
+	}
+	iob_unput ( iobuf, cipher->authsize );
+	auth = iobuf->tail;
+
+	/* Calculate plaintext length */
+	list_for_each_entry ( iobuf, rx_data, list )
+		len += iob_len ( iobuf );
+
+	/* Authenticate the implicit record header */
+	plaintext_tlshdr.type = tlshdr->type;
+	plaintext_tlshdr.version = tlshdr->version;
+	plaintext_tlshdr.length = htons ( len );
+	cipher_decrypt ( cipher, cipherspec->cipher_ctx, &seq, NULL,
+			 sizeof ( seq ) );
+	cipher_decrypt ( cipher, cipherspec->cipher_ctx, &plaintext_tlshdr,
+			 NULL, sizeof ( plaintext_tlshdr ) );
+
+	/* Decrypt the received data */
+	DBGC2 ( tls, "Received plaintext data:\n" );
+	list_for_each_entry ( iobuf, rx_data, list ) {
+		cipher_decrypt ( cipher, cipherspec->cipher_ctx,
+				 iobuf->data, iobuf->data, iob_len ( iobuf ) );
+		DBGC2_HD ( tls, iobuf->data, iob_len ( iobuf ) );
+	}
+
+	/* Verify authentication tag */
+	cipher_auth ( cipher, cipherspec->cipher_ctx, verify_auth );
+	if ( memcmp ( auth, verify_auth, sizeof ( verify_auth ) ) != 0 ) {
+		DBGC ( tls, "TLS %p failed AEAD authentication\n", tls );
+		return -EINVAL_MAC;
+	}
+
+	return 0;
+}
+
 /**
  * Receive new ciphertext record
  *
@@ -2481,8 +3172,16 @@ static int tls_new_ciphertext ( struct tls_connection *tls,
 	size_t len = 0;
 	int rc;
 
+	/* AEAD ciphers authenticate and decrypt in a single pass */
+	if ( is_auth_cipher ( cipher ) ) {
+		if ( ( rc = tls_new_ciphertext_aead ( tls, tlshdr,
+						      rx_data ) ) != 0 )
+			return rc;
+		return tls_new_record ( tls, tlshdr->type, rx_data );
+	}
+
 	/* Decrypt the received data */
-	list_for_each_entry ( iobuf, &tls->rx_data, list ) {
+	list_for_each_entry ( iobuf, rx_data, list ) {
 		cipher_decrypt ( cipher, cipherspec->cipher_ctx,
 				 iobuf->data, iobuf->data, iob_len ( iobuf ) );
 	}
@@ -2819,10 +3518,6 @@ static struct interface_descriptor tls_cipherstream_desc =
  * @v rc		Reason for completion
  */
 static void tls_validator_done ( struct tls_connection *tls, int rc ) {
-	struct tls_session *session = tls->session;
-	struct tls_cipherspec *cipherspec = &tls->tx_cipherspec_pending;
-	struct pubkey_algorithm *pubkey = cipherspec->suite->pubkey;
-	struct x509_certificate *cert;
 
 	/* Mark validation as complete */
 	pending_put ( &tls->validation );
@@ -2838,35 +3533,15 @@ static void tls_validator_done ( struct tls_connection *tls, int rc ) {
 	}
 	DBGC ( tls, "TLS %p certificate validation succeeded\n", tls );
 
-	/* Extract first certificate */
-	cert = x509_first ( tls->chain );
-	assert ( cert != NULL );
-
-	/* Verify server name */
-	if ( ( rc = x509_check_name ( cert, session->name ) ) != 0 ) {
-		DBGC ( tls, "TLS %p server certificate does not match %s: %s\n",
-		       tls, session->name, strerror ( rc ) );
+	/* Proceed with now-trusted certificate chain */
+	if ( ( rc = tls_trusted ( tls ) ) != 0 )
 		goto err;
-	}
 
-	/* Initialise public key algorithm */
-	if ( ( rc = pubkey_init ( pubkey, cipherspec->pubkey_ctx,
-				  cert->subject.public_key.raw.data,
-				  cert->subject.public_key.raw.len ) ) != 0 ) {
-		DBGC ( tls, "TLS %p cannot initialise public key: %s\n",
-		       tls, strerror ( rc ) );
-		goto err;
-	}
-
-	/* Schedule Client Key Exchange, Change Cipher, and Finished */
-	tls->tx_pending |= ( TLS_TX_CLIENT_KEY_EXCHANGE |
-			     TLS_TX_CHANGE_CIPHER |
-			     TLS_TX_FINISHED );
-	if ( tls->cert ) {
-		tls->tx_pending |= ( TLS_TX_CERTIFICATE |
-				     TLS_TX_CERTIFICATE_VERIFY );
-	}
-	tls_tx_resume ( tls );
+	/* Persist trusted transcript, to allow future handshakes
+	 * presenting an identical certificate chain to skip
+	 * revalidation.
+	 */
+	tls_trust_save ( tls );
 
 	return;
 
@@ -3016,6 +3691,115 @@ static struct process_descriptor tls_process_desc =
  ******************************************************************************
  */
 
+/** TLS session ticket setting
+ *
+ * This setting is updated only if it already exists: create it (with
+ * any value) within a non-volatile settings block to allow the next
+ * boot's first connection to attempt an abbreviated handshake.  Note
+ * that the stored value includes the session's master secret.
+ */
+const struct setting session_ticket_setting __setting ( SETTING_CRYPTO,
+							session-ticket ) = {
+	.name = "session-ticket",
+	.description = "TLS session ticket",
+	.type = &setting_type_hex,
+};
+
+/** A persistent TLS session ticket */
+struct tls_persistent_ticket {
+	/** Master secret */
+	uint8_t master_secret[48];
+	/** Server name (NUL-terminated), followed by the session ticket */
+	char name[0];
+} __attribute__ (( packed ));
+
+/**
+ * Restore persistent session ticket, if applicable
+ *
+ * @v session		Session
+ */
+static void tls_session_restore ( struct tls_session *session ) {
+	struct tls_persistent_ticket *persist;
+	void *data;
+	size_t name_len;
+	size_t ticket_len;
+	int len;
+
+	/* Fetch persistent ticket, if any */
+	len = fetch_raw_setting_copy ( NULL, &session_ticket_setting, &data );
+	if ( len < 0 )
+		return;
+	persist = data;
+
+	/* Ignore tickets that are malformed or for other servers */
+	if ( ( ( size_t ) len ) <= sizeof ( *persist ) )
+		goto discard;
+	name_len = strnlen ( persist->name, ( len - sizeof ( *persist ) ) );
+	if ( name_len == ( len - sizeof ( *persist ) ) )
+		goto discard;
+	if ( strcmp ( persist->name, session->name ) != 0 )
+		goto discard;
+	ticket_len = ( len - sizeof ( *persist ) - name_len - 1 /* NUL */ );
+	if ( ! ticket_len )
+		goto discard;
+
+	/* Restore session ticket and master secret */
+	session->ticket = malloc ( ticket_len );
+	if ( ! session->ticket )
+		goto discard;
+	memcpy ( session->ticket, ( persist->name + name_len + 1 /* NUL */ ),
+		 ticket_len );
+	session->ticket_len = ticket_len;
+	memcpy ( session->master_secret, persist->master_secret,
+		 sizeof ( session->master_secret ) );
+	DBGC ( session, "TLS session %s restored persistent ticket\n",
+	       session->name );
+
+ discard:
+	free ( data );
+}
+
+/**
+ * Persist session ticket, if applicable
+ *
+ * @v session		Session
+ */
+static void tls_session_save ( struct tls_session *session ) {
+	struct tls_persistent_ticket *persist;
+	struct settings *origin;
+	size_t name_len = strlen ( session->name );
+	size_t len;
+	int rc;
+
+	/* Persist tickets only if the setting already exists, so that
+	 * storing the master secret in non-volatile storage remains
+	 * an explicit opt-in.
+	 */
+	if ( fetch_setting ( NULL, &session_ticket_setting, &origin, NULL,
+			     NULL, 0 ) < 0 )
+		return;
+
+	/* Construct persistent ticket */
+	len = ( sizeof ( *persist ) + name_len + 1 /* NUL */ +
+		session->ticket_len );
+	persist = zalloc ( len );
+	if ( ! persist )
+		return;
+	memcpy ( persist->master_secret, session->master_secret,
+		 sizeof ( persist->master_secret ) );
+	strcpy ( persist->name, session->name );
+	memcpy ( ( persist->name + name_len + 1 /* NUL */ ), session->ticket,
+		 session->ticket_len );
+
+	/* Store in the setting's originating settings block */
+	if ( ( rc = store_setting ( origin, &session_ticket_setting,
+				    persist, len ) ) != 0 ) {
+		DBGC ( session, "TLS session %s could not persist ticket: "
+		       "%s\n", session->name, strerror ( rc ) );
+	}
+	free ( persist );
+}
+
 /**
  * Find or create session for TLS connection
  *
@@ -3052,6 +3836,9 @@ static int tls_session ( struct tls_connection *tls, const char *name ) {
 	INIT_LIST_HEAD ( &session->conn );
 	list_add ( &session->list, &tls_sessions );
 
+	/* Restore persistent session ticket, if applicable */
+	tls_session_restore ( session );
+
 	/* Record session */
 	tls->session = session;
 
@@ -3102,11 +3889,6 @@ int add_tls ( struct interface *xfer, const char *name,
 			  ( sizeof ( tls->client_random.random ) ) ) ) != 0 ) {
 		goto err_random;
 	}
-	tls->pre_master_secret.version = htons ( tls->version );
-	if ( ( rc = tls_generate_random ( tls, &tls->pre_master_secret.random,
-		      ( sizeof ( tls->pre_master_secret.random ) ) ) ) != 0 ) {
-		goto err_random;
-	}
 	if ( ( rc = tls_session ( tls, name ) ) != 0 )
 		goto err_session;
 	list_add_tail ( &tls->list, &tls->session->conn );
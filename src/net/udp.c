@@ -4,6 +4,7 @@
 #include <assert.h>
 #include <byteswap.h>
 #include <errno.h>
+#include <ipxe/in.h>
 #include <ipxe/tcpip.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/xfer.h>
@@ -47,6 +48,53 @@ static LIST_HEAD ( udp_conns );
 static struct interface_descriptor udp_xfer_desc;
 struct tcpip_protocol udp_protocol __tcpip_protocol;
 
+/**
+ * Join or leave local multicast group, if applicable
+ *
+ * @v udp		UDP connection
+ * @v join		Join (rather than leave) the group
+ *
+ * Connections listening on a multicast address (e.g. for SLAM) join
+ * the corresponding link-layer multicast group on all network
+ * devices, so that hardware receive filters do not discard the
+ * datagrams.
+ */
+static void udp_mcast ( struct udp_connection *udp, int join ) {
+	struct sockaddr_in *sin = ( struct sockaddr_in * ) &udp->local;
+	struct sockaddr_in6 *sin6 = ( struct sockaddr_in6 * ) &udp->local;
+	struct net_device *netdev;
+	uint8_t ll_addr[MAX_LL_ADDR_LEN];
+	const void *net_addr;
+
+	/* Identify multicast local addresses */
+	switch ( udp->local.st_family ) {
+	case AF_INET:
+		if ( ! IN_IS_MULTICAST ( sin->sin_addr.s_addr ) )
+			return;
+		net_addr = &sin->sin_addr;
+		break;
+	case AF_INET6:
+		if ( ! IN6_IS_ADDR_MULTICAST ( &sin6->sin6_addr ) )
+			return;
+		net_addr = &sin6->sin6_addr;
+		break;
+	default:
+		return;
+	}
+
+	/* Update link-layer multicast filters on all network devices */
+	for_each_netdev ( netdev ) {
+		if ( netdev->ll_protocol->mc_hash ( udp->local.st_family,
+						    net_addr, ll_addr ) != 0 )
+			continue;
+		if ( join ) {
+			netdev_mcast_add ( netdev, ll_addr );
+		} else {
+			netdev_mcast_del ( netdev, ll_addr );
+		}
+	}
+}
+
 /**
  * Check if local UDP port is available
  *
@@ -107,6 +155,9 @@ static int udp_open_common ( struct interface *xfer,
 		       udp, ntohs ( udp->local.st_port ) );
 	}
 
+	/* Join local multicast group, if applicable */
+	udp_mcast ( udp, 1 );
+
 	/* Attach parent interface, transfer reference to connection
 	 * list and return
 	 */
@@ -153,6 +204,9 @@ int udp_open_promisc ( struct interface *xfer ) {
  */
 static void udp_close ( struct udp_connection *udp, int rc ) {
 
+	/* Leave local multicast group, if applicable */
+	udp_mcast ( udp, 0 );
+
 	/* Close data transfer interface */
 	intf_shutdown ( &udp->xfer, rc );
 
@@ -285,7 +339,7 @@ static int udp_rx ( struct io_buffer *iobuf,
 		rc = -EINVAL;
 		goto done;
 	}
-	if ( udphdr->chksum ) {
+	if ( udphdr->chksum && ( ! ( iobuf->flags & IOB_FL_CSUM_OK ) ) ) {
 		csum = tcpip_continue_chksum ( pshdr_csum, iobuf->data, ulen );
 		if ( csum != 0 ) {
 			DBG ( "UDP checksum incorrect (is %04x including "
@@ -1336,6 +1336,7 @@ int start_dhcp ( struct interface *job, struct net_device *netdev ) {
 	intf_init ( &dhcp->job, &dhcp_job_desc, &dhcp->refcnt );
 	intf_init ( &dhcp->xfer, &dhcp_xfer_desc, &dhcp->refcnt );
 	timer_init ( &dhcp->timer, dhcp_timer_expired, &dhcp->refcnt );
+	set_timer_profile ( &dhcp->timer, &retry_profile_lan );
 	dhcp->netdev = netdev_get ( netdev );
 	dhcp->local.sin_family = AF_INET;
 	dhcp->local.sin_port = htons ( BOOTPC_PORT );
@@ -1444,6 +1445,7 @@ int start_pxebs ( struct interface *job, struct net_device *netdev,
 	intf_init ( &dhcp->job, &dhcp_job_desc, &dhcp->refcnt );
 	intf_init ( &dhcp->xfer, &dhcp_xfer_desc, &dhcp->refcnt );
 	timer_init ( &dhcp->timer, dhcp_timer_expired, &dhcp->refcnt );
+	set_timer_profile ( &dhcp->timer, &retry_profile_lan );
 	dhcp->netdev = netdev_get ( netdev );
 	dhcp->local.sin_family = AF_INET;
 	fetch_ipv4_setting ( netdev_settings ( netdev ), &ip_setting,
@@ -29,11 +29,15 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <stdio.h>
 #include <ctype.h>
 #include <errno.h>
 #include <byteswap.h>
 #include <ipxe/refcnt.h>
+#include <ipxe/list.h>
+#include <ipxe/process.h>
+#include <ipxe/timer.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
@@ -63,21 +67,86 @@ FEATURE ( FEATURE_PROTOCOL, "DNS", DHCP_EB_FEATURE_DNS, 1 );
 #define EINFO_ENXIO_NO_NAMESERVER \
 	__einfo_uniqify ( EINFO_ENXIO, 0x02, "No DNS servers available" )
 
-/** The DNS server */
-static union {
-	struct sockaddr sa;
-	struct sockaddr_tcpip st;
-	struct sockaddr_in sin;
-	struct sockaddr_in6 sin6;
-} nameserver = {
-	.st = {
-		.st_port = htons ( DNS_PORT ),
-	},
+/** Maximum number of DNS servers
+ *
+ * This is a policy decision.
+ */
+#define DNS_MAX_SERVERS 4
+
+/** Smoothing weight (log2) for server round-trip time estimates
+ *
+ * This is a policy decision.
+ */
+#define DNS_SRTT_WEIGHT 3
+
+/** A DNS server */
+struct dns_server {
+	/** Server address */
+	union {
+		struct sockaddr sa;
+		struct sockaddr_tcpip st;
+		struct sockaddr_in sin;
+		struct sockaddr_in6 sin6;
+	} address;
+	/** Smoothed round-trip time (in ticks), or zero if unmeasured */
+	unsigned long srtt;
 };
 
+/** The DNS server list */
+static struct dns_server dns_servers[DNS_MAX_SERVERS];
+
+/** Number of configured DNS servers */
+static unsigned int dns_server_count;
+
 /** The DNS search list */
 static struct dns_name dns_search;
 
+/**
+ * Update server round-trip time estimate
+ *
+ * @v server		DNS server
+ * @v rtt		Measured round-trip time (in ticks)
+ */
+static void dns_update_srtt ( struct dns_server *server, unsigned long rtt ) {
+
+	/* Ensure that a measured server is distinguishable from an
+	 * unmeasured server, even for sub-tick round-trip times.
+	 */
+	if ( rtt == 0 )
+		rtt = 1;
+
+	/* Initialise or update exponentially weighted moving average */
+	if ( server->srtt ) {
+		server->srtt = ( server->srtt - ( server->srtt >>
+						  DNS_SRTT_WEIGHT ) +
+				 ( rtt >> DNS_SRTT_WEIGHT ) );
+	} else {
+		server->srtt = rtt;
+	}
+	if ( server->srtt == 0 )
+		server->srtt = 1;
+}
+
+/**
+ * Select best DNS server
+ *
+ * @ret server		Fastest measured server (or first unmeasured server)
+ */
+static struct dns_server * dns_best_server ( void ) {
+	struct dns_server *best = NULL;
+	struct dns_server *server;
+	unsigned int i;
+
+	for ( i = 0 ; i < dns_server_count ; i++ ) {
+		server = &dns_servers[i];
+		if ( ( best == NULL ) ||
+		     ( server->srtt && ( ( ! best->srtt ) ||
+					 ( server->srtt < best->srtt ) ) ) )
+			best = server;
+	}
+	return best;
+}
+
 /**
  * Encode a DNS name using RFC1035 encoding
  *
@@ -436,6 +505,208 @@ static const char * dns_type ( uint16_t type ) {
 	}
 }
 
+/** Validity period for negative cache entries (in seconds)
+ *
+ * We do not parse the SOA record from the authority section, and so
+ * use a fixed validity period for cached lookup failures.  This is a
+ * policy decision.
+ */
+#define DNS_CACHE_NEGATIVE_TTL 60
+
+/** Maximum validity period for cache entries (in seconds)
+ *
+ * This is a policy decision.
+ */
+#define DNS_CACHE_MAX_TTL 3600
+
+/** Maximum number of cache entries
+ *
+ * Boot scripts tend to resolve a small set of names repeatedly; a
+ * handful of entries is sufficient.  This is a policy decision.
+ */
+#define DNS_CACHE_ENTRIES 8
+
+/** A DNS cache entry */
+struct dns_cache_entry {
+	/** List of cache entries (most recently used first) */
+	struct list_head list;
+	/** Lookup status code */
+	int rc;
+	/** Resolved address (if lookup succeeded) */
+	union {
+		struct sockaddr sa;
+		struct sockaddr_in sin;
+		struct sockaddr_in6 sin6;
+	} address;
+	/** Expiry time (in ticks) */
+	unsigned long expiry;
+	/** Resolved name */
+	char name[0];
+};
+
+/** The DNS cache */
+static LIST_HEAD ( dns_cache );
+
+/**
+ * Find unexpired DNS cache entry
+ *
+ * @v name		Name to resolve
+ * @ret entry		Cache entry, or NULL if not found
+ */
+static struct dns_cache_entry * dns_cache_find ( const char *name ) {
+	struct dns_cache_entry *entry;
+	struct dns_cache_entry *tmp;
+
+	list_for_each_entry_safe ( entry, tmp, &dns_cache, list ) {
+
+		/* Discard expired entries */
+		if ( ( ( signed long ) ( entry->expiry - currticks() ) ) < 0 ) {
+			list_del ( &entry->list );
+			free ( entry );
+			continue;
+		}
+
+		/* Check for matching name (case-insensitively) */
+		if ( strcasecmp ( name, entry->name ) == 0 ) {
+
+			/* Mark as most recently used */
+			list_del ( &entry->list );
+			list_add ( &entry->list, &dns_cache );
+
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Add DNS cache entry
+ *
+ * @v name		Resolved name
+ * @v sa		Resolved address (if lookup succeeded)
+ * @v rc		Lookup status code
+ * @v ttl		Validity period (in seconds)
+ */
+static void dns_cache_add ( const char *name, struct sockaddr *sa, int rc,
+			    unsigned long ttl ) {
+	struct dns_cache_entry *entry;
+	unsigned int used = 0;
+
+	/* Discard any existing entry for this name */
+	entry = dns_cache_find ( name );
+	if ( entry ) {
+		list_del ( &entry->list );
+		free ( entry );
+	}
+
+	/* Evict least recently used entry if cache is full */
+	list_for_each_entry ( entry, &dns_cache, list )
+		used++;
+	if ( used >= DNS_CACHE_ENTRIES ) {
+		entry = list_last_entry ( &dns_cache, struct dns_cache_entry,
+					  list );
+		list_del ( &entry->list );
+		free ( entry );
+	}
+
+	/* Allocate and initialise entry.  Failures are harmless; the
+	 * name will simply not be cached.
+	 */
+	entry = zalloc ( sizeof ( *entry ) + strlen ( name ) + 1 /* NUL */ );
+	if ( ! entry )
+		return;
+	entry->rc = rc;
+	if ( sa )
+		memcpy ( &entry->address.sa, sa, sizeof ( entry->address.sa ) );
+	if ( ttl > DNS_CACHE_MAX_TTL )
+		ttl = DNS_CACHE_MAX_TTL;
+	entry->expiry = ( currticks() + ( ttl * TICKS_PER_SEC ) );
+	strcpy ( entry->name, name );
+
+	/* Add as most recently used */
+	list_add ( &entry->list, &dns_cache );
+}
+
+/** A cached DNS resolution */
+struct dns_cached_resolv {
+	/** Reference counter */
+	struct refcnt refcnt;
+	/** Name resolution interface */
+	struct interface resolv;
+	/** Process */
+	struct process process;
+	/** Completed socket address */
+	union {
+		struct sockaddr sa;
+		struct sockaddr_in sin;
+		struct sockaddr_in6 sin6;
+	} address;
+	/** Overall status code */
+	int rc;
+};
+
+/**
+ * Complete cached DNS resolution
+ *
+ * @v cached		Cached DNS resolution
+ */
+static void dns_cache_step ( struct dns_cached_resolv *cached ) {
+
+	if ( cached->rc == 0 )
+		resolv_done ( &cached->resolv, &cached->address.sa );
+	intf_shutdown ( &cached->resolv, cached->rc );
+}
+
+/** Cached DNS resolution process descriptor */
+static struct process_descriptor dns_cache_process_desc =
+	PROC_DESC_ONCE ( struct dns_cached_resolv, process, dns_cache_step );
+
+/**
+ * Resolve name from DNS cache
+ *
+ * @v resolv		Name resolution interface
+ * @v entry		Cache entry
+ * @v sa		Socket address to fill in
+ * @ret rc		Return status code
+ */
+static int dns_resolv_cached ( struct interface *resolv,
+			       struct dns_cache_entry *entry,
+			       struct sockaddr *sa ) {
+	struct dns_cached_resolv *cached;
+
+	/* Allocate and initialise structure */
+	cached = zalloc ( sizeof ( *cached ) );
+	if ( ! cached )
+		return -ENOMEM;
+	ref_init ( &cached->refcnt, NULL );
+	intf_init ( &cached->resolv, &null_intf_desc, &cached->refcnt );
+	process_init ( &cached->process, &dns_cache_process_desc,
+		       &cached->refcnt );
+	cached->rc = entry->rc;
+
+	/* Construct completed address, preserving the caller's
+	 * non-address fields (e.g. port number).
+	 */
+	memcpy ( &cached->address.sa, sa, sizeof ( cached->address.sa ) );
+	switch ( entry->address.sa.sa_family ) {
+	case AF_INET:
+		cached->address.sin.sin_family = AF_INET;
+		cached->address.sin.sin_addr = entry->address.sin.sin_addr;
+		break;
+	case AF_INET6:
+		cached->address.sin6.sin6_family = AF_INET6;
+		memcpy ( &cached->address.sin6.sin6_addr,
+			 &entry->address.sin6.sin6_addr,
+			 sizeof ( cached->address.sin6.sin6_addr ) );
+		break;
+	}
+
+	/* Attach to parent interface, mortalise self, and return */
+	intf_plug_plug ( &cached->resolv, resolv );
+	ref_put ( &cached->refcnt );
+	return 0;
+}
+
 /** A DNS request */
 struct dns_request {
 	/** Reference counter */
@@ -446,6 +717,12 @@ struct dns_request {
 	struct interface socket;
 	/** Retry timer */
 	struct retry_timer timer;
+	/** DNS server */
+	struct dns_server *server;
+	/** Time of most recent transmission (in ticks) */
+	unsigned long sent;
+	/** Query has been retransmitted */
+	int resent;
 
 	/** Socket address to fill in with resolved address */
 	union {
@@ -455,6 +732,8 @@ struct dns_request {
 	} address;
 	/** Initial query type */
 	uint16_t qtype;
+	/** Restrict query to a single address family */
+	int single;
 	/** Buffer for current query */
 	struct {
 		/** Query header */
@@ -476,6 +755,8 @@ struct dns_request {
 	struct dns_name search;
 	/** Recursion counter */
 	unsigned int recursion;
+	/** Original name being resolved */
+	char *hostname;
 };
 
 /**
@@ -498,12 +779,15 @@ static void dns_done ( struct dns_request *dns, int rc ) {
  * Mark DNS request as resolved and complete
  *
  * @v dns		DNS request
- * @v rc		Return status code
+ * @v ttl		Validity period (in seconds)
  */
-static void dns_resolved ( struct dns_request *dns ) {
+static void dns_resolved ( struct dns_request *dns, unsigned long ttl ) {
 
-	DBGC ( dns, "DNS %p found address %s\n",
-	       dns, sock_ntoa ( &dns->address.sa ) );
+	DBGC ( dns, "DNS %p found address %s (TTL %ld)\n",
+	       dns, sock_ntoa ( &dns->address.sa ), ttl );
+
+	/* Add to cache */
+	dns_cache_add ( dns->hostname, &dns->address.sa, 0, ttl );
 
 	/* Return resolved address */
 	resolv_done ( &dns->resolv, &dns->address.sa );
@@ -573,6 +857,9 @@ static int dns_send_packet ( struct dns_request *dns ) {
 	/* Start retransmission timer */
 	start_timer ( &dns->timer );
 
+	/* Record transmission time */
+	dns->sent = currticks();
+
 	/* Generate query identifier */
 	query->id = random();
 
@@ -596,8 +883,14 @@ static void dns_timer_expired ( struct retry_timer *timer, int fail ) {
 		container_of ( timer, struct dns_request, timer );
 
 	if ( fail ) {
+		/* Discard round-trip time estimate for an unresponsive
+		 * server, so that the next lookup will race all
+		 * servers afresh rather than continuing to prefer it.
+		 */
+		dns->server->srtt = 0;
 		dns_done ( dns, -ETIMEDOUT );
 	} else {
+		dns->resent = 1;
 		dns_send_packet ( dns );
 	}
 }
@@ -644,6 +937,13 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 	DBGC ( dns, "DNS %p received response ID %#04x\n",
 	       dns, ntohs ( response->id ) );
 
+	/* Update server round-trip time estimate, unless the query
+	 * has been retransmitted (in which case the response cannot
+	 * be unambiguously paired with a single transmission).
+	 */
+	if ( ! dns->resent )
+		dns_update_srtt ( dns->server, ( currticks() - dns->sent ) );
+
 	/* Check that we have exactly one question */
 	if ( response->qdcount != htons ( 1 ) ) {
 		DBGC ( dns, "DNS %p received response with %d questions\n",
@@ -723,7 +1023,7 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 			memcpy ( &dns->address.sin6.sin6_addr,
 				 &rr->aaaa.in6_addr,
 				 sizeof ( dns->address.sin6.sin6_addr ) );
-			dns_resolved ( dns );
+			dns_resolved ( dns, ntohl ( rr->common.ttl ) );
 			rc = 0;
 			goto done;
 
@@ -738,7 +1038,7 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 			}
 			dns->address.sin.sin_family = AF_INET;
 			dns->address.sin.sin_addr = rr->a.in_addr;
-			dns_resolved ( dns );
+			dns_resolved ( dns, ntohl ( rr->common.ttl ) );
 			rc = 0;
 			goto done;
 
@@ -789,10 +1089,18 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 
 	case htons ( DNS_TYPE_AAAA ):
 		/* We asked for an AAAA record and got nothing; try
-		 * the A.
+		 * the A (unless restricted to a single address
+		 * family, in which case skip straight to the CNAME).
 		 */
-		DBGC ( dns, "DNS %p found no AAAA record; trying A\n", dns );
-		dns->question->qtype = htons ( DNS_TYPE_A );
+		if ( dns->single ) {
+			DBGC ( dns, "DNS %p found no AAAA record; trying "
+			       "CNAME\n", dns );
+			dns->question->qtype = htons ( DNS_TYPE_CNAME );
+		} else {
+			DBGC ( dns, "DNS %p found no AAAA record; trying A\n",
+			       dns );
+			dns->question->qtype = htons ( DNS_TYPE_A );
+		}
 		dns_send_packet ( dns );
 		rc = 0;
 		goto done;
@@ -824,6 +1132,8 @@ static int dns_xfer_deliver ( struct dns_request *dns,
 		if ( dns->search.offset == dns->search.len ) {
 			DBGC ( dns, "DNS %p found no CNAME record\n", dns );
 			rc = -ENXIO_NO_RECORD;
+			dns_cache_add ( dns->hostname, NULL, rc,
+					DNS_CACHE_NEGATIVE_TTL );
 			dns_done ( dns, rc );
 			goto done;
 		}
@@ -911,34 +1221,31 @@ static struct interface_descriptor dns_resolv_desc =
 	INTF_DESC ( struct dns_request, resolv, dns_resolv_op );
 
 /**
- * Resolve name using DNS
+ * Resolve name using a single DNS query chain
  *
  * @v resolv		Name resolution interface
  * @v name		Name to resolve
  * @v sa		Socket address to fill in
+ * @v qtype		Initial query type (or zero to choose automatically)
+ * @v server		DNS server
  * @ret rc		Return status code
  */
-static int dns_resolv ( struct interface *resolv,
-			const char *name, struct sockaddr *sa ) {
+static int dns_resolv_qtype ( struct interface *resolv, const char *name,
+			      struct sockaddr *sa, uint16_t qtype,
+			      struct dns_server *server ) {
 	struct dns_request *dns;
 	struct dns_header *query;
 	size_t search_len;
+	size_t hostname_len;
 	int name_len;
 	int rc;
 
-	/* Fail immediately if no DNS servers */
-	if ( ! nameserver.sa.sa_family ) {
-		DBG ( "DNS not attempting to resolve \"%s\": "
-		      "no DNS servers\n", name );
-		rc = -ENXIO_NO_NAMESERVER;
-		goto err_no_nameserver;
-	}
-
 	/* Determine whether or not to use search list */
 	search_len = ( strchr ( name, '.' ) ? 0 : dns_search.len );
 
 	/* Allocate DNS structure */
-	dns = zalloc ( sizeof ( *dns ) + search_len );
+	hostname_len = ( strlen ( name ) + 1 /* NUL */ );
+	dns = zalloc ( sizeof ( *dns ) + search_len + hostname_len );
 	if ( ! dns ) {
 		rc = -ENOMEM;
 		goto err_alloc_dns;
@@ -947,22 +1254,30 @@ static int dns_resolv ( struct interface *resolv,
 	intf_init ( &dns->resolv, &dns_resolv_desc, &dns->refcnt );
 	intf_init ( &dns->socket, &dns_socket_desc, &dns->refcnt );
 	timer_init ( &dns->timer, dns_timer_expired, &dns->refcnt );
+	dns->server = server;
 	memcpy ( &dns->address.sa, sa, sizeof ( dns->address.sa ) );
 	dns->search.data = ( ( ( void * ) dns ) + sizeof ( *dns ) );
 	dns->search.len = search_len;
 	memcpy ( dns->search.data, dns_search.data, search_len );
+	dns->hostname = ( dns->search.data + search_len );
+	memcpy ( dns->hostname, name, hostname_len );
 
 	/* Determine initial query type */
-	switch ( nameserver.sa.sa_family ) {
-	case AF_INET:
-		dns->qtype = htons ( DNS_TYPE_A );
-		break;
-	case AF_INET6:
-		dns->qtype = htons ( DNS_TYPE_AAAA );
-		break;
-	default:
-		rc = -ENOTSUP;
-		goto err_type;
+	if ( qtype ) {
+		dns->qtype = qtype;
+		dns->single = 1;
+	} else {
+		switch ( server->address.sa.sa_family ) {
+		case AF_INET:
+			dns->qtype = htons ( DNS_TYPE_A );
+			break;
+		case AF_INET6:
+			dns->qtype = htons ( DNS_TYPE_AAAA );
+			break;
+		default:
+			rc = -ENOTSUP;
+			goto err_type;
+		}
 	}
 
 	/* Construct query */
@@ -984,7 +1299,7 @@ static int dns_resolv ( struct interface *resolv,
 
 	/* Open UDP connection */
 	if ( ( rc = xfer_open_socket ( &dns->socket, SOCK_DGRAM,
-				       &nameserver.sa, NULL ) ) != 0 ) {
+				       &server->address.sa, NULL ) ) != 0 ) {
 		DBGC ( dns, "DNS %p could not open socket: %s\n",
 		       dns, strerror ( rc ) );
 		goto err_open_socket;
@@ -1004,10 +1319,500 @@ static int dns_resolv ( struct interface *resolv,
  err_type:
 	ref_put ( &dns->refcnt );
  err_alloc_dns:
- err_no_nameserver:
 	return rc;
 }
 
+/** Delay before completing resolution with only one address family
+ *
+ * When racing A and AAAA queries, this is the length of time for
+ * which we will wait for the remaining query once the first usable
+ * address has arrived.
+ *
+ * This is a policy decision.
+ */
+#define DNS_HAPPY_DELAY ( TICKS_PER_SEC / 4 )
+
+/** A parallel A/AAAA resolution */
+struct dns_happy {
+	/** Reference counter */
+	struct refcnt refcnt;
+	/** Name resolution interface */
+	struct interface resolv;
+	/** AAAA query interface */
+	struct interface aaaa;
+	/** A query interface */
+	struct interface a;
+	/** Completion delay timer */
+	struct retry_timer timer;
+
+	/** Resolved addresses (in order of preference) */
+	struct sockaddr address[2];
+	/** Resolved address existence flags */
+	int have[2];
+	/** Number of queries still in progress */
+	unsigned int pending;
+	/** First recorded failure */
+	int rc;
+};
+
+/**
+ * Terminate parallel A/AAAA resolution
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v rc		Reason for termination
+ */
+static void dns_happy_close ( struct dns_happy *happy, int rc ) {
+
+	/* Stop delay timer */
+	stop_timer ( &happy->timer );
+
+	/* Shut down interfaces */
+	intf_shutdown ( &happy->aaaa, rc );
+	intf_shutdown ( &happy->a, rc );
+	intf_shutdown ( &happy->resolv, rc );
+}
+
+/**
+ * Complete parallel A/AAAA resolution
+ *
+ * @v happy		Parallel A/AAAA resolution
+ */
+static void dns_happy_finished ( struct dns_happy *happy ) {
+	int rc = ( ( happy->have[0] || happy->have[1] ) ? 0 : happy->rc );
+	unsigned int i;
+
+	/* Stop delay timer */
+	stop_timer ( &happy->timer );
+
+	/* Shut down any remaining query */
+	intf_shutdown ( &happy->aaaa, rc );
+	intf_shutdown ( &happy->a, rc );
+
+	/* Report all resolved addresses, most preferred first */
+	for ( i = 0 ; i < ( sizeof ( happy->have ) /
+			    sizeof ( happy->have[0] ) ) ; i++ ) {
+		if ( happy->have[i] )
+			resolv_done ( &happy->resolv, &happy->address[i] );
+	}
+
+	/* Mark operation as complete */
+	intf_shutdown ( &happy->resolv, rc );
+}
+
+/**
+ * Record address resolved by a child query
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v index		Preference order index
+ * @v sa		Completed socket address
+ */
+static void dns_happy_record ( struct dns_happy *happy, unsigned int index,
+			       struct sockaddr *sa ) {
+
+	DBGC ( happy, "DNS %p found %s address %s\n", happy,
+	       ( index ? "fallback" : "preferred" ), sock_ntoa ( sa ) );
+	memcpy ( &happy->address[index], sa, sizeof ( happy->address[index] ) );
+	happy->have[index] = 1;
+}
+
+/**
+ * Handle completion of a child query
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v child		Child query interface
+ * @v rc		Return status code
+ */
+static void dns_happy_child_close ( struct dns_happy *happy,
+				    struct interface *child, int rc ) {
+
+	/* Restart child interface */
+	intf_restart ( child, rc );
+
+	/* Record first failure */
+	if ( ( rc != 0 ) && ( happy->rc == 0 ) )
+		happy->rc = rc;
+
+	/* Complete resolution once both queries have finished */
+	assert ( happy->pending > 0 );
+	if ( --happy->pending == 0 ) {
+		dns_happy_finished ( happy );
+		return;
+	}
+
+	/* Wait only briefly for the remaining query if we already
+	 * have a usable address.
+	 */
+	if ( happy->have[0] || happy->have[1] )
+		start_timer_fixed ( &happy->timer, DNS_HAPPY_DELAY );
+}
+
+/**
+ * Handle AAAA query completed address
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v sa		Completed socket address
+ */
+static void dns_happy_aaaa_done ( struct dns_happy *happy,
+				  struct sockaddr *sa ) {
+	dns_happy_record ( happy, 0, sa );
+}
+
+/**
+ * Handle AAAA query completion
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v rc		Return status code
+ */
+static void dns_happy_aaaa_close ( struct dns_happy *happy, int rc ) {
+	dns_happy_child_close ( happy, &happy->aaaa, rc );
+}
+
+/**
+ * Handle A query completed address
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v sa		Completed socket address
+ */
+static void dns_happy_a_done ( struct dns_happy *happy,
+			       struct sockaddr *sa ) {
+	dns_happy_record ( happy, 1, sa );
+}
+
+/**
+ * Handle A query completion
+ *
+ * @v happy		Parallel A/AAAA resolution
+ * @v rc		Return status code
+ */
+static void dns_happy_a_close ( struct dns_happy *happy, int rc ) {
+	dns_happy_child_close ( happy, &happy->a, rc );
+}
+
+/**
+ * Handle completion delay timer expiry
+ *
+ * @v timer		Retry timer
+ * @v over		Failure indicator
+ */
+static void dns_happy_expired ( struct retry_timer *timer,
+				int over __unused ) {
+	struct dns_happy *happy =
+		container_of ( timer, struct dns_happy, timer );
+
+	dns_happy_finished ( happy );
+}
+
+/** Parallel A/AAAA resolution AAAA query interface operations */
+static struct interface_operation dns_happy_aaaa_op[] = {
+	INTF_OP ( resolv_done, struct dns_happy *, dns_happy_aaaa_done ),
+	INTF_OP ( intf_close, struct dns_happy *, dns_happy_aaaa_close ),
+};
+
+/** Parallel A/AAAA resolution AAAA query interface descriptor */
+static struct interface_descriptor dns_happy_aaaa_desc =
+	INTF_DESC_PASSTHRU ( struct dns_happy, aaaa, dns_happy_aaaa_op,
+			     resolv );
+
+/** Parallel A/AAAA resolution A query interface operations */
+static struct interface_operation dns_happy_a_op[] = {
+	INTF_OP ( resolv_done, struct dns_happy *, dns_happy_a_done ),
+	INTF_OP ( intf_close, struct dns_happy *, dns_happy_a_close ),
+};
+
+/** Parallel A/AAAA resolution A query interface descriptor */
+static struct interface_descriptor dns_happy_a_desc =
+	INTF_DESC_PASSTHRU ( struct dns_happy, a, dns_happy_a_op, resolv );
+
+/** Parallel A/AAAA resolution parent interface operations */
+static struct interface_operation dns_happy_resolv_op[] = {
+	INTF_OP ( intf_close, struct dns_happy *, dns_happy_close ),
+};
+
+/** Parallel A/AAAA resolution parent interface descriptor */
+static struct interface_descriptor dns_happy_resolv_desc =
+	INTF_DESC_PASSTHRU ( struct dns_happy, resolv, dns_happy_resolv_op,
+			     aaaa );
+
+/**
+ * Resolve name using parallel A and AAAA queries
+ *
+ * @v resolv		Name resolution interface
+ * @v name		Name to resolve
+ * @v sa		Socket address to fill in
+ * @v server		DNS server
+ * @ret rc		Return status code
+ */
+static int dns_happy_resolv ( struct interface *resolv, const char *name,
+			      struct sockaddr *sa,
+			      struct dns_server *server ) {
+	struct dns_happy *happy;
+	int rc;
+
+	/* Allocate and initialise structure */
+	happy = zalloc ( sizeof ( *happy ) );
+	if ( ! happy )
+		return -ENOMEM;
+	ref_init ( &happy->refcnt, NULL );
+	intf_init ( &happy->resolv, &dns_happy_resolv_desc, &happy->refcnt );
+	intf_init ( &happy->aaaa, &dns_happy_aaaa_desc, &happy->refcnt );
+	intf_init ( &happy->a, &dns_happy_a_desc, &happy->refcnt );
+	timer_init ( &happy->timer, dns_happy_expired, &happy->refcnt );
+
+	DBGC ( happy, "DNS %p racing AAAA and A queries for \"%s\"\n",
+	       happy, name );
+
+	/* Start child queries.  Treat a failure to start the
+	 * (less-preferred) A query as nonfatal.
+	 */
+	if ( ( rc = dns_resolv_qtype ( &happy->aaaa, name, sa,
+				       htons ( DNS_TYPE_AAAA ),
+				       server ) ) != 0 )
+		goto err_aaaa;
+	happy->pending++;
+	if ( ( rc = dns_resolv_qtype ( &happy->a, name, sa,
+				       htons ( DNS_TYPE_A ), server ) ) == 0 )
+		happy->pending++;
+
+	/* Attach parent interface, mortalise self, and return */
+	intf_plug_plug ( &happy->resolv, resolv );
+	ref_put ( &happy->refcnt );
+	return 0;
+
+ err_aaaa:
+	ref_put ( &happy->refcnt );
+	return rc;
+}
+
+/**
+ * Resolve name using a single DNS server
+ *
+ * @v resolv		Name resolution interface
+ * @v name		Name to resolve
+ * @v sa		Socket address to fill in
+ * @v server		DNS server
+ * @ret rc		Return status code
+ */
+static int dns_resolv_server ( struct interface *resolv, const char *name,
+			       struct sockaddr *sa,
+			       struct dns_server *server ) {
+
+	/* Race A and AAAA queries in parallel when using an IPv6
+	 * nameserver, since we are then very likely to be on a
+	 * dual-stack network where either address family may turn out
+	 * to be broken.  Delivering both addresses allows the socket
+	 * opener to race connection attempts.
+	 */
+	if ( server->address.sa.sa_family == AF_INET6 )
+		return dns_happy_resolv ( resolv, name, sa, server );
+
+	return dns_resolv_qtype ( resolv, name, sa, 0, server );
+}
+
+/** A multi-server racing resolution */
+struct dns_race {
+	/** Reference counter */
+	struct refcnt refcnt;
+	/** Name resolution interface */
+	struct interface resolv;
+	/** Per-server child queries */
+	struct dns_race_query {
+		/** Child query interface */
+		struct interface child;
+		/** Containing racing resolution */
+		struct dns_race *race;
+	} queries[DNS_MAX_SERVERS];
+
+	/** Resolved address */
+	struct sockaddr address;
+	/** Resolved address existence flag */
+	int have;
+	/** Number of queries still in progress */
+	unsigned int pending;
+	/** First recorded failure */
+	int rc;
+};
+
+/**
+ * Terminate multi-server racing resolution
+ *
+ * @v race		Multi-server racing resolution
+ * @v rc		Reason for termination
+ */
+static void dns_race_close ( struct dns_race *race, int rc ) {
+	unsigned int i;
+
+	/* Shut down interfaces */
+	for ( i = 0 ; i < DNS_MAX_SERVERS ; i++ )
+		intf_shutdown ( &race->queries[i].child, rc );
+	intf_shutdown ( &race->resolv, rc );
+}
+
+/**
+ * Handle address resolved by a child query
+ *
+ * @v query		Child query
+ * @v sa		Completed socket address
+ */
+static void dns_race_done ( struct dns_race_query *query,
+			    struct sockaddr *sa ) {
+	struct dns_race *race = query->race;
+
+	/* Record address, if this is the first answer to arrive */
+	if ( ! race->have ) {
+		DBGC ( race, "DNS %p got first answer %s\n",
+		       race, sock_ntoa ( sa ) );
+		memcpy ( &race->address, sa, sizeof ( race->address ) );
+		race->have = 1;
+	}
+}
+
+/**
+ * Handle completion of a child query
+ *
+ * @v query		Child query
+ * @v rc		Return status code
+ */
+static void dns_race_child_close ( struct dns_race_query *query, int rc ) {
+	struct dns_race *race = query->race;
+
+	/* Restart child interface */
+	intf_restart ( &query->child, rc );
+
+	/* Record first failure */
+	if ( ( rc != 0 ) && ( race->rc == 0 ) )
+		race->rc = rc;
+
+	/* Complete resolution as soon as we have an answer: all
+	 * servers are expected to return equivalent results, so there
+	 * is no point in waiting for the slower ones.
+	 */
+	if ( race->have ) {
+		resolv_done ( &race->resolv, &race->address );
+		dns_race_close ( race, 0 );
+		return;
+	}
+
+	/* Fail resolution once all queries have failed */
+	assert ( race->pending > 0 );
+	if ( --race->pending == 0 )
+		dns_race_close ( race, race->rc );
+}
+
+/** Multi-server racing resolution child query interface operations */
+static struct interface_operation dns_race_child_op[] = {
+	INTF_OP ( resolv_done, struct dns_race_query *, dns_race_done ),
+	INTF_OP ( intf_close, struct dns_race_query *, dns_race_child_close ),
+};
+
+/** Multi-server racing resolution child query interface descriptor */
+static struct interface_descriptor dns_race_child_desc =
+	INTF_DESC ( struct dns_race_query, child, dns_race_child_op );
+
+/** Multi-server racing resolution parent interface operations */
+static struct interface_operation dns_race_resolv_op[] = {
+	INTF_OP ( intf_close, struct dns_race *, dns_race_close ),
+};
+
+/** Multi-server racing resolution parent interface descriptor */
+static struct interface_descriptor dns_race_resolv_desc =
+	INTF_DESC ( struct dns_race, resolv, dns_race_resolv_op );
+
+/**
+ * Resolve name by racing queries to all configured DNS servers
+ *
+ * @v resolv		Name resolution interface
+ * @v name		Name to resolve
+ * @v sa		Socket address to fill in
+ * @ret rc		Return status code
+ */
+static int dns_race_resolv ( struct interface *resolv, const char *name,
+			     struct sockaddr *sa ) {
+	struct dns_race *race;
+	struct dns_race_query *query;
+	unsigned int i;
+	int rc;
+
+	/* Allocate and initialise structure */
+	race = zalloc ( sizeof ( *race ) );
+	if ( ! race )
+		return -ENOMEM;
+	ref_init ( &race->refcnt, NULL );
+	intf_init ( &race->resolv, &dns_race_resolv_desc, &race->refcnt );
+	for ( i = 0 ; i < DNS_MAX_SERVERS ; i++ ) {
+		query = &race->queries[i];
+		intf_init ( &query->child, &dns_race_child_desc,
+			    &race->refcnt );
+		query->race = race;
+	}
+
+	DBGC ( race, "DNS %p racing %d servers for \"%s\"\n",
+	       race, dns_server_count, name );
+
+	/* Start child queries.  Treat a failure to start any
+	 * individual query as nonfatal, provided that at least one
+	 * query starts successfully.
+	 */
+	rc = -ENXIO_NO_NAMESERVER;
+	for ( i = 0 ; i < dns_server_count ; i++ ) {
+		query = &race->queries[i];
+		if ( ( rc = dns_resolv_server ( &query->child, name, sa,
+						&dns_servers[i] ) ) == 0 )
+			race->pending++;
+	}
+	if ( race->pending == 0 )
+		goto err_queries;
+
+	/* Attach parent interface, mortalise self, and return */
+	intf_plug_plug ( &race->resolv, resolv );
+	ref_put ( &race->refcnt );
+	return 0;
+
+ err_queries:
+	ref_put ( &race->refcnt );
+	return rc;
+}
+
+/**
+ * Resolve name using DNS
+ *
+ * @v resolv		Name resolution interface
+ * @v name		Name to resolve
+ * @v sa		Socket address to fill in
+ * @ret rc		Return status code
+ */
+static int dns_resolv ( struct interface *resolv,
+			const char *name, struct sockaddr *sa ) {
+	struct dns_cache_entry *entry;
+	struct dns_server *server;
+
+	/* Complete immediately if we have an unexpired cached result */
+	entry = dns_cache_find ( name );
+	if ( entry ) {
+		DBG ( "DNS returning cached %s for \"%s\"\n",
+		      ( entry->rc ? "failure" : "address" ), name );
+		return dns_resolv_cached ( resolv, entry, sa );
+	}
+
+	/* Fail immediately if no DNS servers */
+	if ( ! dns_server_count ) {
+		DBG ( "DNS not attempting to resolve \"%s\": "
+		      "no DNS servers\n", name );
+		return -ENXIO_NO_NAMESERVER;
+	}
+
+	/* Race queries to all configured servers until we have
+	 * latency data, so that a dead or slow first server can never
+	 * delay resolution beyond the best server's response time.
+	 * Once a server has been measured, use the fastest known
+	 * server directly.
+	 */
+	server = dns_best_server();
+	if ( ( ! server->srtt ) && ( dns_server_count > 1 ) )
+		return dns_race_resolv ( resolv, name, sa );
+
+	return dns_resolv_server ( resolv, name, sa, server );
+}
+
 /** DNS name resolver */
 struct resolver dns_resolver __resolver ( RESOLV_NORMAL ) = {
 	.name = "DNS",
@@ -1138,19 +1943,69 @@ static void apply_dns_search ( void ) {
  * @ret rc		Return status code
  */
 static int apply_dns_settings ( void ) {
+	struct dns_server old[DNS_MAX_SERVERS];
+	unsigned int old_count = dns_server_count;
+	struct dns_server *server;
+	struct in6_addr *in6;
+	struct in_addr *in;
+	void *data;
+	unsigned int i;
+	unsigned int j;
+	int len;
+
+	/* Preserve existing server list, then clear it */
+	memcpy ( old, dns_servers, sizeof ( old ) );
+	memset ( dns_servers, 0, sizeof ( dns_servers ) );
+	dns_server_count = 0;
 
-	/* Fetch DNS server address */
-	nameserver.sa.sa_family = 0;
-	if ( fetch_ipv6_setting ( NULL, &dns6_setting,
-				  &nameserver.sin6.sin6_addr ) >= 0 ) {
-		nameserver.sin6.sin6_family = AF_INET6;
-	} else if ( fetch_ipv4_setting ( NULL, &dns_setting,
-					 &nameserver.sin.sin_addr ) >= 0 ) {
-		nameserver.sin.sin_family = AF_INET;
+	/* Fetch IPv6 DNS server list, if any */
+	len = fetch_setting_copy ( NULL, &dns6_setting, NULL, NULL, &data );
+	if ( len >= 0 ) {
+		for ( in6 = data ;
+		      ( ( len >= ( ( int ) sizeof ( *in6 ) ) ) &&
+			( dns_server_count < DNS_MAX_SERVERS ) ) ;
+		      in6++, len -= sizeof ( *in6 ) ) {
+			server = &dns_servers[dns_server_count++];
+			server->address.sin6.sin6_family = AF_INET6;
+			server->address.st.st_port = htons ( DNS_PORT );
+			memcpy ( &server->address.sin6.sin6_addr, in6,
+				 sizeof ( server->address.sin6.sin6_addr ) );
+		}
+		free ( data );
 	}
-	if ( nameserver.sa.sa_family ) {
-		DBG ( "DNS using nameserver %s\n",
-		      sock_ntoa ( &nameserver.sa ) );
+
+	/* Fetch IPv4 DNS server list, if any */
+	len = fetch_setting_copy ( NULL, &dns_setting, NULL, NULL, &data );
+	if ( len >= 0 ) {
+		for ( in = data ;
+		      ( ( len >= ( ( int ) sizeof ( *in ) ) ) &&
+			( dns_server_count < DNS_MAX_SERVERS ) ) ;
+		      in++, len -= sizeof ( *in ) ) {
+			server = &dns_servers[dns_server_count++];
+			server->address.sin.sin_family = AF_INET;
+			server->address.st.st_port = htons ( DNS_PORT );
+			server->address.sin.sin_addr = *in;
+		}
+		free ( data );
+	}
+
+	/* Preserve round-trip time estimates for retained servers */
+	for ( i = 0 ; i < dns_server_count ; i++ ) {
+		server = &dns_servers[i];
+		for ( j = 0 ; j < old_count ; j++ ) {
+			if ( memcmp ( &server->address, &old[j].address,
+				      sizeof ( server->address ) ) == 0 ) {
+				server->srtt = old[j].srtt;
+				break;
+			}
+		}
+	}
+
+	if ( DBG_LOG && dns_server_count ) {
+		DBG ( "DNS using nameservers" );
+		for ( i = 0 ; i < dns_server_count ; i++ )
+			DBG ( " %s", sock_ntoa ( &dns_servers[i].address.sa ) );
+		DBG ( "\n" );
 	}
 
 	/* Fetch DNS search list */
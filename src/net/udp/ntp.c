@@ -54,6 +54,17 @@ struct ntp_client {
 	struct interface xfer;
 	/** Retransmission timer */
 	struct retry_timer timer;
+
+	/** Transmission times of burst requests (in ticks) */
+	unsigned long sent[NTP_BURST_COUNT];
+	/** Number of requests sent in current burst */
+	unsigned int requests;
+	/** Number of responses received in current burst */
+	unsigned int responses;
+	/** Lowest round-trip delay observed (in ticks) */
+	unsigned long best;
+	/** Clock delta from lowest-delay sample */
+	int32_t delta;
 };
 
 /**
@@ -82,13 +93,17 @@ static int ntp_request ( struct ntp_client *ntp ) {
 	struct ntp_header hdr;
 	int rc;
 
-	DBGC ( ntp, "NTP %p sending request\n", ntp );
+	DBGC ( ntp, "NTP %p sending request %d\n", ntp, ntp->requests );
 
-	/* Construct header */
+	/* Construct header, tagging the fraction of a second with the
+	 * burst request index so that the response (which echoes it
+	 * as the originate timestamp) can be paired with this
+	 * request.
+	 */
 	memset ( &hdr, 0, sizeof ( hdr ) );
 	hdr.flags = ( NTP_FL_LI_UNKNOWN | NTP_FL_VN_1 | NTP_FL_MODE_CLIENT );
 	hdr.transmit.seconds = htonl ( time ( NULL ) + NTP_EPOCH );
-	hdr.transmit.fraction = htonl ( NTP_FRACTION_MAGIC );
+	hdr.transmit.fraction = htonl ( NTP_FRACTION_MAGIC ^ ntp->requests );
 
 	/* Send request */
 	if ( ( rc = xfer_deliver_raw ( &ntp->xfer, &hdr,
@@ -98,9 +113,30 @@ static int ntp_request ( struct ntp_client *ntp ) {
 		return rc;
 	}
 
+	/* Record transmission time */
+	ntp->sent[ntp->requests++] = currticks();
+
 	return 0;
 }
 
+/**
+ * Apply lowest-delay clock sample and terminate successfully
+ *
+ * @v ntp		NTP client
+ */
+static void ntp_apply ( struct ntp_client *ntp ) {
+
+	DBGC ( ntp, "NTP %p applying delta %d seconds (delay %ld ticks, "
+	       "%d/%d responses)\n", ntp, ntp->delta, ntp->best,
+	       ntp->responses, ntp->requests );
+
+	/* Adjust system clock */
+	time_adjust ( ntp->delta );
+
+	/* Mark operation as complete */
+	ntp_close ( ntp, 0 );
+}
+
 /**
  * Handle NTP response
  *
@@ -113,6 +149,8 @@ static int ntp_deliver ( struct ntp_client *ntp, struct io_buffer *iobuf,
 			 struct xfer_metadata *meta ) {
 	struct ntp_header *hdr;
 	struct sockaddr_tcpip *st_src;
+	unsigned int index;
+	unsigned long rtt;
 	int32_t delta;
 	int rc;
 
@@ -139,8 +177,9 @@ static int ntp_deliver ( struct ntp_client *ntp, struct io_buffer *iobuf,
 		goto ignore;
 	}
 
-	/* Check magic value */
-	if ( hdr->originate.fraction != htonl ( NTP_FRACTION_MAGIC ) ) {
+	/* Check magic value and identify originating burst request */
+	index = ( ntohl ( hdr->originate.fraction ) ^ NTP_FRACTION_MAGIC );
+	if ( index >= ntp->requests ) {
 		DBGC ( ntp, "NTP %p received unrecognised packet:\n", ntp );
 		DBGC_HDA ( ntp, 0, iobuf->data, iob_len ( iobuf ) );
 		goto ignore;
@@ -154,16 +193,31 @@ static int ntp_deliver ( struct ntp_client *ntp, struct io_buffer *iobuf,
 		goto close;
 	}
 
-	/* Calculate clock delta */
+	/* Calculate round-trip delay and clock delta */
+	rtt = ( currticks() - ntp->sent[index] );
 	delta = ( ntohl ( hdr->receive.seconds ) -
 		  ntohl ( hdr->originate.seconds ) );
-	DBGC ( ntp, "NTP %p delta %d seconds\n", ntp, delta );
-
-	/* Adjust system clock */
-	time_adjust ( delta );
-
-	/* Success */
-	rc = 0;
+	DBGC ( ntp, "NTP %p request %d delta %d seconds (delay %ld ticks)\n",
+	       ntp, index, delta, rtt );
+
+	/* Record sample if it has the lowest round-trip delay so far:
+	 * such samples suffer least from path asymmetry.
+	 */
+	if ( ( ntp->responses == 0 ) || ( rtt < ntp->best ) ) {
+		ntp->best = rtt;
+		ntp->delta = delta;
+	}
+	ntp->responses++;
+
+	/* Apply immediately once every burst request has been
+	 * answered; otherwise continue to wait (until the
+	 * retransmission timer expires) for better samples.
+	 */
+	if ( ( ntp->requests == NTP_BURST_COUNT ) &&
+	     ( ntp->responses >= NTP_BURST_COUNT ) ) {
+		ntp_apply ( ntp );
+	}
+	goto ignore;
 
  close:
 	ntp_close ( ntp, rc );
@@ -179,8 +233,9 @@ static int ntp_deliver ( struct ntp_client *ntp, struct io_buffer *iobuf,
  */
 static void ntp_window_changed ( struct ntp_client *ntp ) {
 
-	/* Start timer to send initial request */
-	start_timer_nodelay ( &ntp->timer );
+	/* Start timer to send initial request, if not already started */
+	if ( ! timer_running ( &ntp->timer ) )
+		start_timer_nodelay ( &ntp->timer );
 }
 
 /** Data transfer interface operations */
@@ -214,15 +269,36 @@ static void ntp_expired ( struct retry_timer *timer, int fail ) {
 	struct ntp_client *ntp =
 		container_of ( timer, struct ntp_client, timer );
 
-	/* Shut down client if we have failed */
-	if ( fail ) {
-		ntp_close ( ntp, -ETIMEDOUT );
-		return;
+	/* Handle closure of the burst window */
+	if ( ntp->requests == NTP_BURST_COUNT ) {
+
+		/* Apply best sample, if the burst produced any */
+		if ( ntp->responses ) {
+			ntp_apply ( ntp );
+			return;
+		}
+
+		/* Shut down client if we have failed */
+		if ( fail ) {
+			ntp_close ( ntp, -ETIMEDOUT );
+			return;
+		}
+
+		/* Otherwise, start a fresh burst */
+		ntp->requests = 0;
 	}
 
-	/* Otherwise, restart timer and (re)transmit request */
-	start_timer ( &ntp->timer );
+	/* Transmit next request, and restart timer: using the burst
+	 * spacing interval while requests remain to be sent, and the
+	 * (backed-off) retransmission timeout to await stragglers
+	 * thereafter.
+	 */
 	ntp_request ( ntp );
+	if ( ntp->requests < NTP_BURST_COUNT ) {
+		start_timer_fixed ( &ntp->timer, NTP_BURST_INTERVAL );
+	} else {
+		start_timer ( &ntp->timer );
+	}
 }
 
 /**
@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <strings.h>
 #include <errno.h>
@@ -35,6 +36,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/bitmap.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
+#include <ipxe/job.h>
 #include <ipxe/uri.h>
 #include <ipxe/tcpip.h>
 #include <ipxe/timer.h>
@@ -118,6 +120,20 @@ FEATURE ( FEATURE_PROTOCOL, "SLAM", DHCP_EB_FEATURE_SLAM, 1 );
 /** SLAM slave timeout */
 #define SLAM_SLAVE_TIMEOUT ( 1 * TICKS_PER_SEC )
 
+/** SLAM slave timeout jitter
+ *
+ * In a large multicast group, a dropped packet will cause every
+ * client's slave timer to expire at almost exactly the same moment,
+ * and the server will then be hit by a NACK from each client
+ * simultaneously.  Randomising the slave timeout within this window
+ * means that one client will become the master client first; its NACK
+ * restarts the data stream, which in turn restarts every other
+ * client's slave timer before it can expire.
+ *
+ * This is a policy decision.
+ */
+#define SLAM_SLAVE_JITTER ( TICKS_PER_SEC / 2 )
+
 /** A SLAM request */
 struct slam_request {
 	/** Reference counter */
@@ -149,6 +165,12 @@ struct slam_request {
 	struct bitmap bitmap;
 	/** NACK sent flag */
 	int nack_sent;
+	/** Number of data packets received */
+	unsigned long packets;
+	/** Number of duplicate data packets received */
+	unsigned long duplicates;
+	/** Number of NACKs sent */
+	unsigned long nacks;
 };
 
 /**
@@ -261,6 +283,9 @@ static int slam_tx_nack ( struct slam_request *slam ) {
 	/* Mark NACK as sent, so that we know we have to disconnect later */
 	slam->nack_sent = 1;
 
+	/* Update statistics */
+	slam->nacks++;
+
 	/* Allocate I/O buffer */
 	iobuf = xfer_alloc_iob ( &slam->socket,	SLAM_MAX_NACK_LEN );
 	if ( ! iobuf ) {
@@ -357,6 +382,21 @@ static void slam_slave_timer_expired ( struct retry_timer *timer,
 	}
 }
 
+/**
+ * Restart SLAM slave client retry timer
+ *
+ * @v slam		SLAM request
+ *
+ * The timeout is jittered to desynchronise the clients within a
+ * multicast group; see @c SLAM_SLAVE_JITTER.
+ */
+static void slam_restart_slave_timer ( struct slam_request *slam ) {
+	unsigned long timeout;
+
+	timeout = ( SLAM_SLAVE_TIMEOUT + ( random() % SLAM_SLAVE_JITTER ) );
+	start_timer_fixed ( &slam->slave_timer, timeout );
+}
+
 /****************************************************************************
  *
  * RX datapath
@@ -506,7 +546,7 @@ static int slam_mc_socket_deliver ( struct slam_request *slam,
 	/* Stop the master client timer.  Restart the slave client timer. */
 	stop_timer ( &slam->master_timer );
 	stop_timer ( &slam->slave_timer );
-	start_timer_fixed ( &slam->slave_timer, SLAM_SLAVE_TIMEOUT );
+	slam_restart_slave_timer ( slam );
 
 	/* Read and strip packet header */
 	if ( ( rc = slam_pull_header ( slam, iobuf ) ) != 0 )
@@ -542,9 +582,13 @@ static int slam_mc_socket_deliver ( struct slam_request *slam,
 
 	/* If we have already seen this packet, discard it */
 	if ( bitmap_test ( &slam->bitmap, packet ) ) {
+		slam->duplicates++;
 		goto discard;
 	}
 
+	/* Update statistics */
+	slam->packets++;
+
 	/* Pass to recipient */
 	memset ( &meta, 0, sizeof ( meta ) );
 	meta.flags = XFER_FL_ABS_OFFSET;
@@ -636,8 +680,27 @@ static struct interface_descriptor slam_mc_socket_desc =
  *
  */
 
+/**
+ * Report progress of SLAM download
+ *
+ * @v slam		SLAM request
+ * @v progress		Progress report to fill in
+ * @ret ongoing_rc	Ongoing job status code (if known)
+ */
+static int slam_progress ( struct slam_request *slam,
+			   struct job_progress *progress ) {
+
+	/* Construct reception statistics message */
+	snprintf ( progress->message, sizeof ( progress->message ),
+		   "%ld/%ld blks %ld dup %ld nack", slam->packets,
+		   slam->num_blocks, slam->duplicates, slam->nacks );
+
+	return 0;
+}
+
 /** SLAM data transfer interface operations */
 static struct interface_operation slam_xfer_operations[] = {
+	INTF_OP ( job_progress, struct slam_request *, slam_progress ),
 	INTF_OP ( intf_close, struct slam_request *, slam_finished ),
 };
 
@@ -757,7 +820,7 @@ static int slam_open ( struct interface *xfer, struct uri *uri ) {
 	}
 
 	/* Start slave retry timer */
-	start_timer_fixed ( &slam->slave_timer, SLAM_SLAVE_TIMEOUT );
+	slam_restart_slave_timer ( slam );
 
 	/* Attach to parent interface, mortalise self, and return */
 	intf_plug_plug ( &slam->xfer, xfer );
@@ -35,6 +35,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <byteswap.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
+#include <ipxe/process.h>
 #include <ipxe/tcpip.h>
 #include <ipxe/dhcp.h>
 #include <ipxe/dhcpv6.h>
@@ -155,13 +156,89 @@ static struct line_console syslog_line = {
 /** Syslog recursion marker */
 static int syslog_entered;
 
+/** Syslog message queue length
+ *
+ * This is a policy decision
+ */
+#define SYSLOG_QUEUE_LEN 4
+
+/** A queued syslog message */
+struct syslog_message {
+	/** Severity */
+	unsigned int severity;
+	/** Message */
+	char message[SYSLOG_BUFSIZE];
+};
+
+/** Syslog message queue
+ *
+ * Completed log lines are queued and transmitted from the process
+ * (i.e. from the event loop), so that logging under load does not
+ * insert a synchronous UDP transmission into whatever code path
+ * generated the message.
+ */
+static struct syslog_message syslog_queue[SYSLOG_QUEUE_LEN];
+
+/** Syslog message queue producer counter */
+static unsigned int syslog_prod;
+
+/** Syslog message queue consumer counter */
+static unsigned int syslog_cons;
+
+/**
+ * Transmit queued log message
+ *
+ * @v message		Queued message
+ */
+static void syslog_flush ( struct syslog_message *message ) {
+	int rc;
+
+	/* Guard against re-entry */
+	syslog_entered = 1;
+
+	/* Send log message */
+	if ( ( rc = syslog_send ( &syslogger, message->severity,
+				  message->message, "" ) ) != 0 ) {
+		DBG ( "SYSLOG could not send log message: %s\n",
+		      strerror ( rc ) );
+	}
+
+	/* Clear re-entry flag */
+	syslog_entered = 0;
+}
+
+/**
+ * Transmit queued log messages
+ *
+ * @v process		Syslog process
+ */
+static void syslog_step ( struct process *process ) {
+
+	/* Transmit one queued message per step */
+	if ( syslog_cons != syslog_prod ) {
+		syslog_flush ( &syslog_queue[ syslog_cons++ %
+					      SYSLOG_QUEUE_LEN ] );
+	}
+
+	/* Stop process when queue is empty */
+	if ( syslog_cons == syslog_prod )
+		process_del ( process );
+}
+
+/** Syslog process descriptor */
+static struct process_descriptor syslog_desc = PROC_DESC_PURE ( syslog_step );
+
+/** Syslog process */
+static struct process syslog_process =
+	PROC_INIT ( syslog_process, &syslog_desc );
+
 /**
  * Print a character to syslog console
  *
  * @v character		Character to be printed
  */
 static void syslog_putchar ( int character ) {
-	int rc;
+	struct syslog_message *message;
 
 	/* Ignore if we are already mid-logging */
 	if ( syslog_entered )
@@ -171,18 +248,31 @@ static void syslog_putchar ( int character ) {
 	if ( line_putchar ( &syslog_line, character ) == 0 )
 		return;
 
-	/* Guard against re-entry */
-	syslog_entered = 1;
-
-	/* Send log message */
-	if ( ( rc = syslog_send ( &syslogger, syslog_severity,
-				  syslog_buffer, "" ) ) != 0 ) {
-		DBG ( "SYSLOG could not send log message: %s\n",
-		      strerror ( rc ) );
+	/* Transmit oldest message immediately if queue is full */
+	if ( ( syslog_prod - syslog_cons ) == SYSLOG_QUEUE_LEN ) {
+		syslog_flush ( &syslog_queue[ syslog_cons++ %
+					      SYSLOG_QUEUE_LEN ] );
 	}
 
-	/* Clear re-entry flag */
-	syslog_entered = 0;
+	/* Queue completed log message */
+	message = &syslog_queue[ syslog_prod++ % SYSLOG_QUEUE_LEN ];
+	message->severity = syslog_severity;
+	memcpy ( message->message, syslog_buffer,
+		 sizeof ( message->message ) );
+
+	/* Transmit queue immediately for messages of error severity
+	 * or higher (which may precede a crash), otherwise defer
+	 * transmission to the process.
+	 */
+	if ( syslog_severity <= LOG_ERR ) {
+		while ( syslog_cons != syslog_prod ) {
+			syslog_flush ( &syslog_queue[ syslog_cons++ %
+						      SYSLOG_QUEUE_LEN ] );
+		}
+		process_del ( &syslog_process );
+	} else {
+		process_add ( &syslog_process );
+	}
 }
 
 /** Syslog console driver */
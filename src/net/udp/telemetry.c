@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Binary telemetry export
+ *
+ * Exports boot milestones, profiler results, and IP system statistics
+ * as compact versioned TLV records, batched into single UDP datagrams
+ * and sent at defined points during boot (after network configuration
+ * and immediately before image execution).  The telemetry server is
+ * the configured syslog server, on a dedicated port.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <byteswap.h>
+#include <ipxe/xfer.h>
+#include <ipxe/open.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/settings.h>
+#include <ipxe/timer.h>
+#include <ipxe/profile.h>
+#include <ipxe/ipstat.h>
+#include <ipxe/milestone.h>
+#include <ipxe/syslog.h>
+#include <ipxe/telemetry.h>
+
+/** The telemetry server */
+static union {
+	struct sockaddr sa;
+	struct sockaddr_tcpip st;
+	struct sockaddr_in sin;
+	struct sockaddr_in6 sin6;
+} telemetry_server = {
+	.st = {
+		.st_port = htons ( TELEMETRY_PORT ),
+	},
+};
+
+/** Telemetry UDP interface operations */
+static struct interface_operation telemetry_operations[] = {};
+
+/** Telemetry UDP interface descriptor */
+static struct interface_descriptor telemetry_desc =
+	INTF_DESC_PURE ( telemetry_operations );
+
+/** The telemetry UDP interface */
+static struct interface telemetry = INTF_INIT ( telemetry_desc );
+
+/** Telemetry export is enabled */
+static int telemetry_enabled;
+
+/** Telemetry datagram currently under construction */
+static struct io_buffer *telemetry_iobuf;
+
+/**
+ * Transmit telemetry datagram under construction
+ *
+ * @ret rc		Return status code
+ */
+static int telemetry_tx ( void ) {
+	struct telemetry_header *header;
+	struct io_buffer *iobuf = telemetry_iobuf;
+	int rc;
+
+	/* Do nothing unless a datagram is under construction */
+	if ( ! iobuf )
+		return 0;
+	telemetry_iobuf = NULL;
+
+	/* Complete datagram header */
+	header = iobuf->data;
+	header->len = htons ( iob_len ( iobuf ) );
+
+	/* Transmit datagram */
+	if ( ( rc = xfer_deliver_iob ( &telemetry, iobuf ) ) != 0 ) {
+		DBG ( "TELEMETRY could not transmit datagram: %s\n",
+		      strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Append record to telemetry datagram under construction
+ *
+ * @v event		Export event
+ * @v type		Record type
+ * @v len		Payload length
+ * @ret data		Payload to fill in, or NULL on failure
+ *
+ * Starts a new datagram if the record will not fit within the current
+ * one (or if no datagram is under construction).
+ */
+static void * telemetry_add ( unsigned int event, unsigned int type,
+			      size_t len ) {
+	struct telemetry_header *header;
+	struct telemetry_record *record;
+
+	/* Transmit current datagram if record will not fit */
+	if ( telemetry_iobuf &&
+	     ( ( iob_len ( telemetry_iobuf ) + sizeof ( *record ) + len ) >
+	       TELEMETRY_MTU ) ) {
+		telemetry_tx();
+	}
+
+	/* Begin new datagram if applicable */
+	if ( ! telemetry_iobuf ) {
+		telemetry_iobuf = xfer_alloc_iob ( &telemetry, TELEMETRY_MTU );
+		if ( ! telemetry_iobuf )
+			return NULL;
+		header = iob_put ( telemetry_iobuf, sizeof ( *header ) );
+		memset ( header, 0, sizeof ( *header ) );
+		header->magic = htonl ( TELEMETRY_MAGIC );
+		header->version = TELEMETRY_VERSION;
+		header->event = event;
+	}
+
+	/* Append record header */
+	record = iob_put ( telemetry_iobuf, ( sizeof ( *record ) + len ) );
+	memset ( record, 0, ( sizeof ( *record ) + len ) );
+	record->type = type;
+	record->len = htons ( len );
+
+	return record->data;
+}
+
+/**
+ * Append boot milestone records
+ *
+ * @v event		Export event
+ */
+static void telemetry_milestones ( unsigned int event ) {
+	struct telemetry_milestone *data;
+	struct milestone *list;
+	unsigned int count;
+	unsigned int i;
+
+	count = milestone_list ( &list );
+	for ( i = 0 ; i < count ; i++ ) {
+		data = telemetry_add ( event, TELEMETRY_MILESTONE,
+				       sizeof ( *data ) );
+		if ( ! data )
+			return;
+		memcpy ( data->name, list[i].name, sizeof ( data->name ) );
+		data->ms = htonl ( ( list[i].ticks * 1000 ) / TICKS_PER_SEC );
+	}
+}
+
+/**
+ * Append profiler result records
+ *
+ * @v event		Export event
+ */
+static void telemetry_profilers ( unsigned int event ) {
+	struct telemetry_profiler *data;
+	struct profiler *profiler;
+	size_t name_len;
+
+	for_each_table_entry ( profiler, PROFILERS ) {
+		if ( ! profiler->count )
+			continue;
+		name_len = ( strlen ( profiler->name ) + 1 /* NUL */ );
+		data = telemetry_add ( event, TELEMETRY_PROFILER,
+				       ( sizeof ( *data ) + name_len ) );
+		if ( ! data )
+			return;
+		data->count = htonl ( profiler->count );
+		data->mean = htonl ( profile_mean ( profiler ) );
+		data->stddev = htonl ( profile_stddev ( profiler ) );
+		memcpy ( data->name, profiler->name, name_len );
+	}
+}
+
+/**
+ * Append IP system statistics records
+ *
+ * @v event		Export event
+ */
+static void telemetry_ipstats ( unsigned int event ) {
+	struct telemetry_ipstat *data;
+	struct ip_statistics_family *family;
+	struct ip_statistics *stats;
+
+	for_each_table_entry ( family, IP_STATISTICS_FAMILIES ) {
+		stats = family->stats;
+		data = telemetry_add ( event, TELEMETRY_IPSTAT,
+				       sizeof ( *data ) );
+		if ( ! data )
+			return;
+		data->version = family->version;
+		data->in_receives = htonl ( stats->in_receives );
+		data->in_octets = htonl ( stats->in_octets );
+		data->in_hdr_errors = htonl ( stats->in_hdr_errors );
+		data->in_delivers = htonl ( stats->in_delivers );
+		data->out_requests = htonl ( stats->out_requests );
+		data->out_transmits = htonl ( stats->out_transmits );
+		data->out_octets = htonl ( stats->out_octets );
+	}
+}
+
+/**
+ * Export telemetry records
+ *
+ * @v event		Export event
+ *
+ * Batches all telemetry records into as few UDP datagrams as possible
+ * and transmits them to the telemetry server, if one is configured.
+ */
+void telemetry_export ( unsigned int event ) {
+
+	/* Do nothing unless telemetry is enabled */
+	if ( ! telemetry_enabled )
+		return;
+
+	/* Batch and transmit all records */
+	telemetry_milestones ( event );
+	telemetry_profilers ( event );
+	telemetry_ipstats ( event );
+	telemetry_tx();
+}
+
+/**
+ * Apply telemetry settings
+ *
+ * @ret rc		Return status code
+ */
+static int apply_telemetry_settings ( void ) {
+	struct sockaddr old_server;
+	int rc;
+
+	/* Fetch telemetry server (shared with the syslog console) */
+	telemetry_enabled = 0;
+	memcpy ( &old_server, &telemetry_server, sizeof ( old_server ) );
+	telemetry_server.sa.sa_family = 0;
+	if ( fetch_ipv6_setting ( NULL, &syslog6_setting,
+				  &telemetry_server.sin6.sin6_addr ) >= 0 ) {
+		telemetry_server.sin6.sin6_family = AF_INET6;
+	} else if ( fetch_ipv4_setting ( NULL, &syslog_setting,
+					 &telemetry_server.sin.sin_addr ) >= 0){
+		telemetry_server.sin.sin_family = AF_INET;
+	}
+	if ( telemetry_server.sa.sa_family ) {
+		telemetry_enabled = 1;
+		DBG ( "TELEMETRY using server %s\n",
+		      sock_ntoa ( &telemetry_server.sa ) );
+	}
+
+	/* Do nothing more unless server has changed */
+	if ( memcmp ( &telemetry_server, &old_server,
+		      sizeof ( telemetry_server ) ) == 0 )
+		return 0;
+
+	/* Reset telemetry connection */
+	intf_restart ( &telemetry, 0 );
+
+	/* Do nothing more unless we have a server */
+	if ( ! telemetry_enabled ) {
+		DBG ( "TELEMETRY has no server\n" );
+		return 0;
+	}
+
+	/* Connect to server */
+	if ( ( rc = xfer_open_socket ( &telemetry, SOCK_DGRAM,
+				       &telemetry_server.sa, NULL ) ) != 0 ) {
+		DBG ( "TELEMETRY cannot connect to server: %s\n",
+		      strerror ( rc ) );
+		telemetry_enabled = 0;
+		return rc;
+	}
+
+	/* Export configuration-time telemetry */
+	telemetry_export ( TELEMETRY_EVENT_CONFIG );
+
+	return 0;
+}
+
+/** Telemetry settings applicator */
+struct settings_applicator telemetry_applicator __settings_applicator = {
+	.apply = apply_telemetry_settings,
+};
@@ -40,6 +40,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/base64.h>
 #include <ipxe/crc32.h>
 #include <ipxe/ocsp.h>
+#include <ipxe/certstore.h>
 #include <ipxe/job.h>
 #include <ipxe/validator.h>
 #include <config/crypto.h>
@@ -51,13 +52,29 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 
 struct validator;
+struct validator_fetch;
 
 /** A certificate validator action */
 struct validator_action {
 	/** Name */
 	const char *name;
-	/** Action to take upon completed transfer */
-	int ( * done ) ( struct validator *validator, const void *data,
+	/** Check whether or not a completed fetch can yet be applied
+	 *
+	 * @v fetch		Validator fetch
+	 * @ret ready		Fetch can be applied
+	 *
+	 * A NULL method indicates that a completed fetch can always
+	 * be applied.
+	 */
+	int ( * ready ) ( struct validator_fetch *fetch );
+	/** Action to take upon completed fetch
+	 *
+	 * @v fetch		Validator fetch
+	 * @v data		Raw downloaded data
+	 * @v len		Length of raw data
+	 * @ret rc		Return status code
+	 */
+	int ( * done ) ( struct validator_fetch *fetch, const void *data,
 			 size_t len );
 };
 
@@ -67,30 +84,56 @@ struct validator {
 	struct refcnt refcnt;
 	/** Job control interface */
 	struct interface job;
-	/** Data transfer interface */
-	struct interface xfer;
 
 	/** Process */
 	struct process process;
 
 	/** X.509 certificate chain */
 	struct x509_chain *chain;
-	/** OCSP check */
-	struct ocsp_check *ocsp;
+	/** Stapled OCSP response, if any */
+	void *staple;
+	/** Length of stapled OCSP response */
+	size_t staple_len;
+
+	/** List of fetches */
+	struct list_head fetches;
+};
+
+/** A certificate validator fetch
+ *
+ * Fetches are independent HTTP exchanges and so can proceed
+ * concurrently, even though their results may have to be applied in
+ * chain order.
+ */
+struct validator_fetch {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Certificate validator */
+	struct validator *validator;
+	/** List of fetches */
+	struct list_head list;
+	/** Data transfer interface */
+	struct interface xfer;
 	/** Data buffer */
 	struct xfer_buffer buffer;
 
-	/** Current action */
+	/** Action to take upon completed fetch */
 	const struct validator_action *action;
-	/** Current certificate
+	/** Certificate
 	 *
 	 * This will always be present within the certificate chain
 	 * and so this pointer does not hold a reference to the
 	 * certificate.
 	 */
 	struct x509_certificate *cert;
+	/** OCSP check (for OCSP fetches only) */
+	struct ocsp_check *ocsp;
+	/** Transfer has completed */
+	int done;
 };
 
+static void validator_finished ( struct validator *validator, int rc );
+
 /**
  * Get validator name (for debug messages)
  *
@@ -115,11 +158,211 @@ static void validator_free ( struct refcnt *refcnt ) {
 	DBGC2 ( validator, "VALIDATOR %p \"%s\" freed\n",
 		validator, validator_name ( validator ) );
 	x509_chain_put ( validator->chain );
-	ocsp_put ( validator->ocsp );
-	xferbuf_free ( &validator->buffer );
+	free ( validator->staple );
 	free ( validator );
 }
 
+/****************************************************************************
+ *
+ * Fetches
+ *
+ */
+
+/**
+ * Free validator fetch
+ *
+ * @v refcnt		Reference count
+ */
+static void validator_fetch_free ( struct refcnt *refcnt ) {
+	struct validator_fetch *fetch =
+		container_of ( refcnt, struct validator_fetch, refcnt );
+
+	ocsp_put ( fetch->ocsp );
+	xferbuf_free ( &fetch->buffer );
+	ref_put ( &fetch->validator->refcnt );
+	free ( fetch );
+}
+
+/**
+ * Remove fetch from list of fetches
+ *
+ * @v fetch		Validator fetch
+ * @v rc		Reason for removal
+ */
+static void validator_fetch_del ( struct validator_fetch *fetch, int rc ) {
+
+	/* Shut down data transfer interface */
+	intf_shutdown ( &fetch->xfer, rc );
+
+	/* Remove from list of fetches and drop list's reference */
+	list_del ( &fetch->list );
+	ref_put ( &fetch->refcnt );
+}
+
+/**
+ * Find fetch in list of fetches
+ *
+ * @v validator		Certificate validator
+ * @v action		Validator action
+ * @v cert		X.509 certificate, or NULL to match any certificate
+ * @ret fetch		Validator fetch, or NULL if not found
+ */
+static struct validator_fetch *
+validator_fetch_find ( struct validator *validator,
+		       const struct validator_action *action,
+		       struct x509_certificate *cert ) {
+	struct validator_fetch *fetch;
+
+	list_for_each_entry ( fetch, &validator->fetches, list ) {
+		if ( fetch->action != action )
+			continue;
+		if ( cert && ( fetch->cert != cert ) )
+			continue;
+		return fetch;
+	}
+	return NULL;
+}
+
+/**
+ * Check whether or not any fetch transfers are still in progress
+ *
+ * @v validator		Certificate validator
+ * @ret busy		Transfers are still in progress
+ */
+static int validator_busy ( struct validator *validator ) {
+	struct validator_fetch *fetch;
+
+	list_for_each_entry ( fetch, &validator->fetches, list ) {
+		if ( ! fetch->done )
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * Close fetch data transfer interface
+ *
+ * @v fetch		Validator fetch
+ * @v rc		Reason for close
+ */
+static void validator_fetch_close ( struct validator_fetch *fetch, int rc ) {
+	struct validator *validator = fetch->validator;
+
+	/* Close data transfer interface */
+	intf_restart ( &fetch->xfer, rc );
+
+	/* Check for errors */
+	if ( rc != 0 ) {
+		DBGC ( validator, "VALIDATOR %p \"%s\" %s transfer failed: "
+		       "%s\n", validator, validator_name ( validator ),
+		       fetch->action->name, strerror ( rc ) );
+		validator_finished ( validator, rc );
+		return;
+	}
+	DBGC2 ( validator, "VALIDATOR %p \"%s\" %s transfer complete\n",
+		validator, validator_name ( validator ),
+		fetch->action->name );
+
+	/* Mark transfer as complete */
+	fetch->done = 1;
+
+	/* Resume validation process */
+	process_add ( &validator->process );
+}
+
+/**
+ * Receive fetch data
+ *
+ * @v fetch		Validator fetch
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int validator_fetch_deliver ( struct validator_fetch *fetch,
+				     struct io_buffer *iobuf,
+				     struct xfer_metadata *meta ) {
+	struct validator *validator = fetch->validator;
+	int rc;
+
+	/* Add data to buffer */
+	if ( ( rc = xferbuf_deliver ( &fetch->buffer, iob_disown ( iobuf ),
+				      meta ) ) != 0 ) {
+		DBGC ( validator, "VALIDATOR %p \"%s\" could not receive "
+		       "data: %s\n", validator, validator_name ( validator ),
+		       strerror ( rc ) );
+		validator_finished ( validator, rc );
+		return rc;
+	}
+
+	return 0;
+}
+
+/** Validator fetch data transfer interface operations */
+static struct interface_operation validator_fetch_operations[] = {
+	INTF_OP ( xfer_deliver, struct validator_fetch *,
+		  validator_fetch_deliver ),
+	INTF_OP ( intf_close, struct validator_fetch *,
+		  validator_fetch_close ),
+};
+
+/** Validator fetch data transfer interface descriptor */
+static struct interface_descriptor validator_fetch_desc =
+	INTF_DESC ( struct validator_fetch, xfer, validator_fetch_operations );
+
+/**
+ * Start a fetch
+ *
+ * @v validator		Certificate validator
+ * @v action		Validator action
+ * @v cert		X.509 certificate
+ * @v ocsp		OCSP check, or NULL
+ * @v uri_string	URI string
+ * @ret rc		Return status code
+ */
+static int validator_fetch ( struct validator *validator,
+			     const struct validator_action *action,
+			     struct x509_certificate *cert,
+			     struct ocsp_check *ocsp,
+			     const char *uri_string ) {
+	struct validator_fetch *fetch;
+	int rc;
+
+	/* Allocate and initialise fetch */
+	fetch = zalloc ( sizeof ( *fetch ) );
+	if ( ! fetch ) {
+		rc = -ENOMEM;
+		goto err_alloc;
+	}
+	ref_init ( &fetch->refcnt, validator_fetch_free );
+	intf_init ( &fetch->xfer, &validator_fetch_desc, &fetch->refcnt );
+	fetch->validator = validator;
+	ref_get ( &validator->refcnt );
+	fetch->action = action;
+	fetch->cert = cert;
+	if ( ocsp )
+		fetch->ocsp = ocsp_get ( ocsp );
+	xferbuf_malloc_init ( &fetch->buffer );
+
+	/* Open URI */
+	if ( ( rc = xfer_open_uri_string ( &fetch->xfer,
+					   uri_string ) ) != 0 ) {
+		DBGC ( validator, "VALIDATOR %p \"%s\" could not open %s: "
+		       "%s\n", validator, validator_name ( validator ),
+		       uri_string, strerror ( rc ) );
+		goto err_open_uri_string;
+	}
+
+	/* Add to list of fetches and transfer ownership to list */
+	list_add_tail ( &fetch->list, &validator->fetches );
+
+	return 0;
+
+ err_open_uri_string:
+	ref_put ( &fetch->refcnt );
+ err_alloc:
+	return rc;
+}
+
 /**
  * Mark certificate validation as finished
  *
@@ -127,12 +370,17 @@ static void validator_free ( struct refcnt *refcnt ) {
  * @v rc		Reason for finishing
  */
 static void validator_finished ( struct validator *validator, int rc ) {
+	struct validator_fetch *fetch;
+	struct validator_fetch *tmp;
 
 	/* Remove process */
 	process_del ( &validator->process );
 
+	/* Terminate any remaining fetches */
+	list_for_each_entry_safe ( fetch, tmp, &validator->fetches, list )
+		validator_fetch_del ( fetch, rc );
+
 	/* Close all interfaces */
-	intf_shutdown ( &validator->xfer, rc );
 	intf_shutdown ( &validator->job, rc );
 }
 
@@ -151,12 +399,15 @@ static void validator_finished ( struct validator *validator, int rc ) {
  */
 static int validator_progress ( struct validator *validator,
 				struct job_progress *progress ) {
+	struct validator_fetch *fetch;
 
-	/* Report current action, if applicable */
-	if ( validator->action ) {
+	/* Report first outstanding fetch, if applicable */
+	fetch = list_first_entry ( &validator->fetches,
+				   struct validator_fetch, list );
+	if ( fetch ) {
 		snprintf ( progress->message, sizeof ( progress->message ),
-			   "%s %s", validator->action->name,
-			   x509_name ( validator->cert ) );
+			   "%s %s", fetch->action->name,
+			   x509_name ( fetch->cert ) );
 	}
 
 	return 0;
@@ -192,13 +443,14 @@ static const char crosscert_default[] = CROSSCERT;
 /**
  * Append cross-signing certificates to certificate chain
  *
- * @v validator		Certificate validator
+ * @v fetch		Validator fetch
  * @v data		Raw cross-signing certificate data
  * @v len		Length of raw data
  * @ret rc		Return status code
  */
-static int validator_append ( struct validator *validator,
+static int validator_append ( struct validator_fetch *fetch,
 			      const void *data, size_t len ) {
+	struct validator *validator = fetch->validator;
 	struct asn1_cursor cursor;
 	struct x509_chain *certs;
 	struct x509_certificate *cert;
@@ -241,6 +493,12 @@ static int validator_append ( struct validator *validator,
 		       validator, validator_name ( validator ) );
 		DBGC ( validator, "%s\n", x509_name ( cert ) );
 
+		/* Mark downloaded certificate as eligible for the
+		 * persistent certificate cache, since it was
+		 * expensive to obtain.
+		 */
+		cert->flags |= X509_FL_CACHEABLE;
+
 		/* Move to next certificate */
 		asn1_skip_any ( &cursor );
 	}
@@ -330,23 +588,15 @@ static int validator_start_download ( struct validator *validator,
 	DBGC ( validator, "\"%s\" cross-signature from %s\n",
 	       x509_name ( cert ), uri_string );
 
-	/* Set completion handler */
-	validator->action = &validator_crosscert;
-	validator->cert = cert;
-
-	/* Open URI */
-	if ( ( rc = xfer_open_uri_string ( &validator->xfer,
-					   uri_string ) ) != 0 ) {
-		DBGC ( validator, "VALIDATOR %p \"%s\" could not open %s: "
-		       "%s\n", validator, validator_name ( validator ),
-		       uri_string, strerror ( rc ) );
-		goto err_open_uri_string;
-	}
+	/* Start fetch */
+	if ( ( rc = validator_fetch ( validator, &validator_crosscert, cert,
+				      NULL, uri_string ) ) != 0 )
+		goto err_fetch;
 
 	/* Success */
 	rc = 0;
 
- err_open_uri_string:
+ err_fetch:
 	free ( uri_string );
  err_alloc_uri_string:
  err_check_uri_string:
@@ -360,21 +610,36 @@ static int validator_start_download ( struct validator *validator,
  *
  */
 
+/**
+ * Check whether or not an OCSP response can yet be validated
+ *
+ * @v fetch		Validator fetch
+ * @ret ready		OCSP response can be validated
+ */
+static int validator_ocsp_ready ( struct validator_fetch *fetch ) {
+
+	/* An OCSP response cannot be validated until its issuer has
+	 * itself been validated.
+	 */
+	return x509_is_valid ( fetch->ocsp->issuer );
+}
+
 /**
  * Validate OCSP response
  *
- * @v validator		Certificate validator
+ * @v fetch		Validator fetch
  * @v data		Raw OCSP response
  * @v len		Length of raw data
  * @ret rc		Return status code
  */
-static int validator_ocsp_validate ( struct validator *validator,
+static int validator_ocsp_validate ( struct validator_fetch *fetch,
 				     const void *data, size_t len ) {
+	struct validator *validator = fetch->validator;
 	time_t now;
 	int rc;
 
 	/* Record OCSP response */
-	if ( ( rc = ocsp_response ( validator->ocsp, data, len ) ) != 0 ) {
+	if ( ( rc = ocsp_response ( fetch->ocsp, data, len ) ) != 0 ) {
 		DBGC ( validator, "VALIDATOR %p \"%s\" could not record OCSP "
 		       "response: %s\n", validator,
 		       validator_name ( validator ),strerror ( rc ) );
@@ -383,23 +648,20 @@ static int validator_ocsp_validate ( struct validator *validator,
 
 	/* Validate OCSP response */
 	now = time ( NULL );
-	if ( ( rc = ocsp_validate ( validator->ocsp, now ) ) != 0 ) {
+	if ( ( rc = ocsp_validate ( fetch->ocsp, now ) ) != 0 ) {
 		DBGC ( validator, "VALIDATOR %p \"%s\" could not validate "
 		       "OCSP response: %s\n", validator,
 		       validator_name ( validator ), strerror ( rc ) );
 		return rc;
 	}
 
-	/* Drop reference to OCSP check */
-	ocsp_put ( validator->ocsp );
-	validator->ocsp = NULL;
-
 	return 0;
 }
 
 /** OCSP validator action */
 static const struct validator_action validator_ocsp = {
 	.name = "OCSP",
+	.ready = validator_ocsp_ready,
 	.done = validator_ocsp_validate,
 };
 
@@ -414,120 +676,91 @@ static const struct validator_action validator_ocsp = {
 static int validator_start_ocsp ( struct validator *validator,
 				  struct x509_certificate *cert,
 				  struct x509_certificate *issuer ) {
-	const char *uri_string;
+	struct ocsp_check *ocsp;
 	int rc;
 
 	/* Create OCSP check */
-	assert ( validator->ocsp == NULL );
-	if ( ( rc = ocsp_check ( cert, issuer, &validator->ocsp ) ) != 0 ) {
+	if ( ( rc = ocsp_check ( cert, issuer, &ocsp ) ) != 0 ) {
 		DBGC ( validator, "VALIDATOR %p \"%s\" could not create OCSP "
 		       "check: %s\n", validator, validator_name ( validator ),
 		       strerror ( rc ) );
-		return rc;
+		goto err_check;
 	}
 
-	/* Set completion handler */
-	validator->action = &validator_ocsp;
-	validator->cert = cert;
-
-	/* Open URI */
-	uri_string = validator->ocsp->uri_string;
+	/* Start fetch */
 	DBGC ( validator, "VALIDATOR %p \"%s\" checking ",
 	       validator, validator_name ( validator ) );
 	DBGC ( validator, "\"%s\" via %s\n",
-	       x509_name ( cert ), uri_string );
-	if ( ( rc = xfer_open_uri_string ( &validator->xfer,
-					   uri_string ) ) != 0 ) {
-		DBGC ( validator, "VALIDATOR %p \"%s\" could not open %s: "
-		       "%s\n", validator, validator_name ( validator ),
-		       uri_string, strerror ( rc ) );
-		return rc;
-	}
-
-	return 0;
-}
-
-/****************************************************************************
- *
- * Data transfer interface
- *
- */
-
-/**
- * Close data transfer interface
- *
- * @v validator		Certificate validator
- * @v rc		Reason for close
- */
-static void validator_xfer_close ( struct validator *validator, int rc ) {
-
-	/* Close data transfer interface */
-	intf_restart ( &validator->xfer, rc );
-
-	/* Check for errors */
-	if ( rc != 0 ) {
-		DBGC ( validator, "VALIDATOR %p \"%s\" transfer failed: %s\n",
-		       validator, validator_name ( validator ),
-		       strerror ( rc ) );
-		goto err_transfer;
-	}
-	DBGC2 ( validator, "VALIDATOR %p \"%s\" transfer complete\n",
-		validator, validator_name ( validator ) );
-
-	/* Process completed download */
-	assert ( validator->action != NULL );
-	if ( ( rc = validator->action->done ( validator, validator->buffer.data,
-					      validator->buffer.len ) ) != 0 )
-		goto err_append;
-
-	/* Free downloaded data */
-	xferbuf_free ( &validator->buffer );
-
-	/* Resume validation process */
-	process_add ( &validator->process );
-
-	return;
-
- err_append:
- err_transfer:
-	validator_finished ( validator, rc );
+	       x509_name ( cert ), ocsp->uri_string );
+	if ( ( rc = validator_fetch ( validator, &validator_ocsp, cert, ocsp,
+				      ocsp->uri_string ) ) != 0 )
+		goto err_fetch;
+
+ err_fetch:
+	/* Drop our reference to OCSP check; fetch holds its own */
+	ocsp_put ( ocsp );
+ err_check:
+	return rc;
 }
 
 /**
- * Receive data
+ * Apply stapled OCSP response
  *
  * @v validator		Certificate validator
- * @v iobuf		I/O buffer
- * @v meta		Data transfer metadata
+ * @v cert		Certificate to check
+ * @v issuer		Issuing certificate
  * @ret rc		Return status code
+ *
+ * The stapled response is consumed by this attempt: if it does not
+ * validate the certificate then validation will fall back to
+ * downloading a fresh response from the OCSP responder.
  */
-static int validator_xfer_deliver ( struct validator *validator,
-				    struct io_buffer *iobuf,
-				    struct xfer_metadata *meta ) {
+static int validator_staple ( struct validator *validator,
+			      struct x509_certificate *cert,
+			      struct x509_certificate *issuer ) {
+	struct ocsp_check *ocsp;
+	time_t now;
 	int rc;
 
-	/* Add data to buffer */
-	if ( ( rc = xferbuf_deliver ( &validator->buffer, iob_disown ( iobuf ),
-				      meta ) ) != 0 ) {
-		DBGC ( validator, "VALIDATOR %p \"%s\" could not receive "
-		       "data: %s\n", validator, validator_name ( validator ),
+	/* Create OCSP check */
+	if ( ( rc = ocsp_check ( cert, issuer, &ocsp ) ) != 0 ) {
+		DBGC ( validator, "VALIDATOR %p \"%s\" could not create OCSP "
+		       "check: %s\n", validator, validator_name ( validator ),
 		       strerror ( rc ) );
-		validator_finished ( validator, rc );
-		return rc;
+		goto err_check;
 	}
 
-	return 0;
-}
-
-/** Certificate validator data transfer interface operations */
-static struct interface_operation validator_xfer_operations[] = {
-	INTF_OP ( xfer_deliver, struct validator *, validator_xfer_deliver ),
-	INTF_OP ( intf_close, struct validator *, validator_xfer_close ),
-};
+	/* Record stapled response */
+	if ( ( rc = ocsp_response ( ocsp, validator->staple,
+				    validator->staple_len ) ) != 0 ) {
+		DBGC ( validator, "VALIDATOR %p \"%s\" could not record "
+		       "stapled OCSP response: %s\n", validator,
+		       validator_name ( validator ), strerror ( rc ) );
+		goto err_response;
+	}
 
-/** Certificate validator data transfer interface descriptor */
-static struct interface_descriptor validator_xfer_desc =
-	INTF_DESC ( struct validator, xfer, validator_xfer_operations );
+	/* Validate stapled response */
+	now = time ( NULL );
+	if ( ( rc = ocsp_validate ( ocsp, now ) ) != 0 ) {
+		DBGC ( validator, "VALIDATOR %p \"%s\" could not validate "
+		       "stapled OCSP response: %s\n", validator,
+		       validator_name ( validator ), strerror ( rc ) );
+		goto err_validate;
+	}
+	DBGC ( validator, "VALIDATOR %p \"%s\" used stapled OCSP response ",
+	       validator, validator_name ( validator ) );
+	DBGC ( validator, "for \"%s\"\n", x509_name ( cert ) );
+
+ err_validate:
+ err_response:
+	ocsp_put ( ocsp );
+ err_check:
+	/* Consume stapled response */
+	free ( validator->staple );
+	validator->staple = NULL;
+	validator->staple_len = 0;
+	return rc;
+}
 
 /****************************************************************************
  *
@@ -541,13 +774,35 @@ static struct interface_descriptor validator_xfer_desc =
  * @v validator		Certificate validator
  */
 static void validator_step ( struct validator *validator ) {
+	struct validator_fetch *fetch;
+	struct validator_fetch *tmp;
 	struct x509_link *link;
 	struct x509_certificate *cert;
-	struct x509_certificate *issuer = NULL;
+	struct x509_certificate *issuer;
 	struct x509_certificate *last;
 	time_t now;
 	int rc;
 
+	/* Apply any completed fetches that have become applicable.
+	 * OCSP responses can be applied only in chain order, and so
+	 * may have to wait for other responses even after their own
+	 * transfers have completed.
+	 */
+	list_for_each_entry_safe ( fetch, tmp, &validator->fetches, list ) {
+		if ( ! fetch->done )
+			continue;
+		if ( fetch->action->ready &&
+		     ( ! fetch->action->ready ( fetch ) ) )
+			continue;
+		rc = fetch->action->done ( fetch, fetch->buffer.data,
+					   fetch->buffer.len );
+		validator_fetch_del ( fetch, rc );
+		if ( rc != 0 ) {
+			validator_finished ( validator, rc );
+			return;
+		}
+	}
+
 	/* Try validating chain.  Try even if the chain is incomplete,
 	 * since certificates may already have been validated
 	 * previously.
@@ -557,13 +812,21 @@ static void validator_step ( struct validator *validator ) {
 					  NULL ) ) == 0 ) {
 		DBGC ( validator, "VALIDATOR %p \"%s\" validated\n",
 		       validator, validator_name ( validator ) );
+
+		/* Persist any downloaded certificates, now that they
+		 * are known to form part of a valid chain.
+		 */
+		certstore_save();
+
 		validator_finished ( validator, 0 );
 		return;
 	}
 
-	/* If there is a certificate that could be validated using
-	 * OCSP, try it.
+	/* Check for a permanent failure: a certificate that is not
+	 * yet valid and cannot be validated via OCSP, despite having
+	 * an issuer that has already been validated.
 	 */
+	issuer = NULL;
 	list_for_each_entry ( link, &validator->chain->links, list ) {
 		cert = issuer;
 		issuer = link->cert;
@@ -571,35 +834,68 @@ static void validator_step ( struct validator *validator ) {
 			continue;
 		if ( ! x509_is_valid ( issuer ) )
 			continue;
-		/* The issuer is valid, but this certificate is not
-		 * yet valid.  If OCSP is applicable, start it.
+		if ( x509_is_valid ( cert ) )
+			continue;
+		if ( ! ocsp_required ( cert, now ) ) {
+			validator_finished ( validator, rc );
+			return;
+		}
+	}
+
+	/* Start OCSP checks for all certificates that require them.
+	 * The checks are independent HTTP exchanges and so can
+	 * proceed concurrently (and concurrently with any
+	 * cross-signing certificate download), even though their
+	 * responses must be applied in chain order: checks are
+	 * therefore started speculatively before the relevant
+	 * issuers have themselves been validated.
+	 */
+	issuer = NULL;
+	list_for_each_entry ( link, &validator->chain->links, list ) {
+		cert = issuer;
+		issuer = link->cert;
+		if ( ! cert )
+			continue;
+		if ( x509_is_valid ( cert ) )
+			continue;
+		if ( ! ocsp_required ( cert, now ) )
+			continue;
+		/* Try any stapled OCSP response, once the issuer has
+		 * been validated.
 		 */
-		if ( ocsp_required ( cert ) ) {
-			/* Start OCSP */
-			if ( ( rc = validator_start_ocsp ( validator, cert,
-							   issuer ) ) != 0 ) {
-				validator_finished ( validator, rc );
-				return;
-			}
+		if ( validator->staple && x509_is_valid ( issuer ) &&
+		     ( validator_staple ( validator, cert, issuer ) == 0 ) ) {
+			/* Resume validation */
+			process_add ( &validator->process );
+			return;
+		}
+		/* Start OCSP check, if one is not already in progress */
+		if ( validator_fetch_find ( validator, &validator_ocsp,
+					    cert ) )
+			continue;
+		if ( ( rc = validator_start_ocsp ( validator, cert,
+						   issuer ) ) != 0 ) {
+			validator_finished ( validator, rc );
 			return;
 		}
-		/* Otherwise, this is a permanent failure */
-		validator_finished ( validator, rc );
-		return;
 	}
 
-	/* If chain ends with a self-issued certificate, then there is
-	 * nothing more to do.
+	/* If chain ends with a self-issued certificate, then there
+	 * are no more certificates that could be fetched: fail unless
+	 * fetch transfers are still in progress.
 	 */
 	last = x509_last ( validator->chain );
 	if ( asn1_compare ( &last->issuer.raw, &last->subject.raw ) == 0 ) {
-		validator_finished ( validator, rc );
+		if ( ! validator_busy ( validator ) )
+			validator_finished ( validator, rc );
 		return;
 	}
 
 	/* Otherwise, try to download a suitable cross-signing
-	 * certificate.
+	 * certificate, if a download is not already in progress.
 	 */
+	if ( validator_fetch_find ( validator, &validator_crosscert, NULL ) )
+		return;
 	if ( ( rc = validator_start_download ( validator, last ) ) != 0 ) {
 		validator_finished ( validator, rc );
 		return;
@@ -621,9 +917,12 @@ static struct process_descriptor validator_process_desc =
  *
  * @v job		Job control interface
  * @v chain		X.509 certificate chain
+ * @v staple		Stapled OCSP response, or NULL
+ * @v staple_len	Length of stapled OCSP response
  * @ret rc		Return status code
  */
-int create_validator ( struct interface *job, struct x509_chain *chain ) {
+int create_validator ( struct interface *job, struct x509_chain *chain,
+		       const void *staple, size_t staple_len ) {
 	struct validator *validator;
 	int rc;
 
@@ -639,15 +938,23 @@ int create_validator ( struct interface *job, struct x509_chain *chain ) {
 		rc = -ENOMEM;
 		goto err_alloc;
 	}
+	if ( staple ) {
+		validator->staple = malloc ( staple_len );
+		if ( ! validator->staple ) {
+			rc = -ENOMEM;
+			free ( validator );
+			goto err_alloc;
+		}
+		memcpy ( validator->staple, staple, staple_len );
+		validator->staple_len = staple_len;
+	}
 	ref_init ( &validator->refcnt, validator_free );
 	intf_init ( &validator->job, &validator_job_desc,
 		    &validator->refcnt );
-	intf_init ( &validator->xfer, &validator_xfer_desc,
-		    &validator->refcnt );
 	process_init ( &validator->process, &validator_process_desc,
 		       &validator->refcnt );
 	validator->chain = x509_chain_get ( chain );
-	xferbuf_malloc_init ( &validator->buffer );
+	INIT_LIST_HEAD ( &validator->fetches );
 
 	/* Attach parent interface, mortalise self, and return */
 	intf_plug_plug ( &validator->job, job );
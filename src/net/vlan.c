@@ -47,14 +47,54 @@ struct net_protocol vlan_protocol __net_protocol;
 
 /** VLAN device private data */
 struct vlan_device {
+	/** VLAN network device */
+	struct net_device *netdev;
 	/** Trunk network device */
 	struct net_device *trunk;
 	/** VLAN tag */
 	unsigned int tag;
 	/** Default priority */
 	unsigned int priority;
+	/** List of VLAN devices in the same hash bucket */
+	struct list_head hashed;
 };
 
+/** Number of VLAN device hash buckets */
+#define VLAN_NUM_BUCKETS 16
+
+/** VLAN device hash buckets, keyed by trunk device and tag
+ *
+ * Tagged frames on a trunk carrying many VLANs arrive at line rate;
+ * the hash index keeps the per-frame device lookup constant-time
+ * rather than scanning the full network device list.
+ */
+static struct list_head vlan_buckets[VLAN_NUM_BUCKETS];
+
+/** VLAN device hash buckets have been initialised */
+static int vlan_buckets_initialised;
+
+/**
+ * Get hash bucket for VLAN device
+ *
+ * @v trunk		Trunk network device
+ * @v tag		VLAN tag
+ * @ret bucket		Hash bucket
+ */
+static struct list_head * vlan_bucket ( struct net_device *trunk,
+					unsigned int tag ) {
+	unsigned int i;
+
+	/* Initialise buckets, if not already done */
+	if ( ! vlan_buckets_initialised ) {
+		for ( i = 0 ; i < VLAN_NUM_BUCKETS ; i++ )
+			INIT_LIST_HEAD ( &vlan_buckets[i] );
+		vlan_buckets_initialised = 1;
+	}
+
+	return &vlan_buckets[ ( ( ( unsigned long ) trunk ) ^ tag ) %
+			      VLAN_NUM_BUCKETS ];
+}
+
 /**
  * Open VLAN device
  *
@@ -201,15 +241,13 @@ static void vlan_sync ( struct net_device *netdev ) {
  */
 static struct net_device * vlan_find ( struct net_device *trunk,
 				       unsigned int tag ) {
-	struct net_device *netdev;
 	struct vlan_device *vlan;
+	struct list_head *bucket;
 
-	for_each_netdev ( netdev ) {
-		if ( netdev->op != &vlan_operations )
-			continue;
-		vlan = netdev->priv;
+	bucket = vlan_bucket ( trunk, tag );
+	list_for_each_entry ( vlan, bucket, hashed ) {
 		if ( ( vlan->trunk == trunk ) && ( vlan->tag == tag ) )
-			return netdev;
+			return vlan->netdev;
 	}
 	return NULL;
 }
@@ -382,6 +420,7 @@ int vlan_create ( struct net_device *trunk, unsigned int tag,
 	netdev->dev = trunk->dev;
 	memcpy ( netdev->hw_addr, trunk->ll_addr, ETH_ALEN );
 	vlan = netdev->priv;
+	vlan->netdev = netdev;
 	vlan->trunk = netdev_get ( trunk );
 	vlan->tag = tag;
 	vlan->priority = priority;
@@ -401,6 +440,9 @@ int vlan_create ( struct net_device *trunk, unsigned int tag,
 		goto err_register;
 	}
 
+	/* Add to hash index */
+	list_add ( &vlan->hashed, vlan_bucket ( trunk, tag ) );
+
 	/* Synchronise with trunk device */
 	vlan_sync ( netdev );
 
@@ -438,6 +480,9 @@ int vlan_destroy ( struct net_device *netdev ) {
 
 	DBGC ( netdev, "VLAN %s destroyed\n", netdev->name );
 
+	/* Remove from hash index */
+	list_del ( &vlan->hashed );
+
 	/* Remove VLAN device */
 	unregister_netdev ( netdev );
 	trunk = vlan->trunk;
@@ -156,6 +156,62 @@ CIPHER_TEST ( aes_256_cbc, &aes_cbc_algorithm,
 		     0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9, 0xfc,
 		     0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b ) );
 
+/** Initialisation vector used for GCM-mode test vectors */
+#define AES_IV_GCM							\
+	IV ( 0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde,	\
+	     0xca, 0xf8, 0x88 )
+
+/** Additional authenticated data used for GCM-mode test vectors */
+#define AES_ADDITIONAL_GCM						\
+	ADDITIONAL ( 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,	\
+		     0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,	\
+		     0xab, 0xad, 0xda, 0xd2 )
+
+/** Plaintext used for GCM-mode test vectors */
+#define AES_PLAINTEXT_GCM						\
+	PLAINTEXT ( 0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,	\
+		    0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,	\
+		    0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,	\
+		    0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,	\
+		    0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,	\
+		    0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,	\
+		    0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,	\
+		    0xba, 0x63, 0x7b, 0x39 )
+
+/** AES-128-GCM (GCM specification test case 4) */
+CIPHER_AUTH_TEST ( aes_128_gcm, &aes_gcm_algorithm,
+	KEY ( 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d,
+	      0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08 ),
+	AES_IV_GCM, AES_ADDITIONAL_GCM, AES_PLAINTEXT_GCM,
+	CIPHERTEXT ( 0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+		     0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+		     0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+		     0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+		     0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+		     0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+		     0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+		     0x3d, 0x58, 0xe0, 0x91 ),
+	AUTH ( 0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb, 0x94,
+	       0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47 ) );
+
+/** AES-256-GCM (GCM specification test case 16) */
+CIPHER_AUTH_TEST ( aes_256_gcm, &aes_gcm_algorithm,
+	KEY ( 0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d,
+	      0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08, 0xfe, 0xff,
+	      0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c, 0x6d, 0x6a, 0x8f,
+	      0x94, 0x67, 0x30, 0x83, 0x08 ),
+	AES_IV_GCM, AES_ADDITIONAL_GCM, AES_PLAINTEXT_GCM,
+	CIPHERTEXT ( 0x52, 0x2d, 0xc1, 0xf0, 0x99, 0x56, 0x7d, 0x07,
+		     0xf4, 0x7f, 0x37, 0xa3, 0x2a, 0x84, 0x42, 0x7d,
+		     0x64, 0x3a, 0x8c, 0xdc, 0xbf, 0xe5, 0xc0, 0xc9,
+		     0x75, 0x98, 0xa2, 0xbd, 0x25, 0x55, 0xd1, 0xaa,
+		     0x8c, 0xb0, 0x8e, 0x48, 0x59, 0x0d, 0xbb, 0x3d,
+		     0xa7, 0xb0, 0x8b, 0x10, 0x56, 0x82, 0x88, 0x38,
+		     0xc5, 0xf6, 0x1e, 0x63, 0x93, 0xba, 0x7a, 0x0a,
+		     0xbc, 0xc9, 0xf6, 0x62 ),
+	AUTH ( 0x76, 0xfc, 0x6e, 0xce, 0x0f, 0x4e, 0x17, 0x68, 0xcd,
+	       0xdf, 0x88, 0x53, 0xbb, 0x2d, 0x55, 0x1b ) );
+
 /**
  * Perform AES self-test
  *
@@ -172,6 +228,8 @@ static void aes_test_exec ( void ) {
 	cipher_ok ( &aes_192_cbc );
 	cipher_ok ( &aes_256_ecb );
 	cipher_ok ( &aes_256_cbc );
+	cipher_ok ( &aes_128_gcm );
+	cipher_ok ( &aes_256_gcm );
 
 	/* Speed tests */
 	for ( keylen = 128 ; keylen <= 256 ; keylen += 64 ) {
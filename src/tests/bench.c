@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Micro-benchmark collection
+ *
+ * The benchmark suite measures the throughput of the low-level
+ * memory, checksum, and cryptographic primitives on the machine
+ * actually being netbooted, where cache sizes and instruction set
+ * extensions cause performance to differ from development machines.
+ * Build a dedicated benchmark image using e.g.
+ *
+ *   make bin/bench.ipxe
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/bench.h>
+#include <ipxe/profile.h>
+#include <ipxe/init.h>
+#include <ipxe/image.h>
+#include <usr/profstat.h>
+
+/* Drag in all applicable benchmarks */
+PROVIDE_REQUIRING_SYMBOL();
+REQUIRE_OBJECT ( mem_bench );
+REQUIRE_OBJECT ( crypto_bench );
+REQUIRE_OBJECT ( deflate_bench );
+REQUIRE_OBJECT ( tcpip_bench );
+
+/**
+ * Report benchmark result
+ *
+ * @v name		Benchmark name
+ * @v len		Number of bytes processed per sample
+ * @v profiler		Profiler
+ */
+void bench_report ( const char *name, size_t len,
+		    struct profiler *profiler ) {
+	unsigned long mean = profile_mean ( profiler );
+
+	printf ( "%-20s %10zd %12ld %12ld %10ld\n", name, len, mean,
+		 profile_stddev ( profiler ),
+		 ( ( ( mean * 1024 ) + ( len / 2 ) ) / len ) );
+}
+
+/**
+ * Run all benchmarks
+ *
+ * @ret rc		Return status code
+ */
+static int run_all_benchmarks ( void ) {
+	struct self_benchmark *bench;
+
+	/* Run all compiled-in benchmarks */
+	printf ( "Starting benchmarks\n" );
+	printf ( "%-20s %10s %12s %12s %10s\n",
+		 "Benchmark", "bytes", "ticks", "stddev", "ticks/kB" );
+	for_each_table_entry ( bench, BENCHMARKS )
+		bench->exec();
+
+	/* Print statistics from any registered profilers */
+	profstat();
+	printf ( "OK: benchmarks complete\n" );
+
+	return 0;
+}
+
+static int bench_image_probe ( struct image *image __unused ) {
+	return -ENOTTY;
+}
+
+static int bench_image_exec ( struct image *image __unused ) {
+	return run_all_benchmarks();
+}
+
+static struct image_type bench_image_type = {
+	.name = "benchmarks",
+	.probe = bench_image_probe,
+	.exec = bench_image_exec,
+};
+
+static struct image bench_image = {
+	.refcnt = REF_INIT ( ref_no_free ),
+	.name = "<BENCH>",
+	.type = &bench_image_type,
+};
+
+static void bench_init ( void ) {
+	int rc;
+
+	/* Register benchmark image */
+	if ( ( rc = register_image ( &bench_image ) ) != 0 ) {
+		DBG ( "Could not register benchmark image: %s\n",
+		      strerror ( rc ) );
+		/* No way to report failure */
+		return;
+	}
+}
+
+/** Benchmark initialisation function */
+struct init_fn bench_init_fn __init_fn ( INIT_EARLY ) = {
+	.initialise = bench_init,
+};
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Coroutine tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <assert.h>
+#include <ipxe/coroutine.h>
+#include <ipxe/test.h>
+
+/** Event log */
+static char coroutine_test_log[32];
+
+/** Event log position */
+static unsigned int coroutine_test_logged;
+
+/**
+ * Record an event
+ *
+ * @v event		Event character
+ */
+static void coroutine_test_record ( char event ) {
+
+	assert ( coroutine_test_logged <
+		 ( sizeof ( coroutine_test_log ) - 1 ) );
+	coroutine_test_log[ coroutine_test_logged++ ] = event;
+}
+
+/**
+ * Coroutine body
+ *
+ * @v coro		Coroutine
+ */
+static void coroutine_test_entry ( struct coroutine *coro __unused ) {
+	unsigned int depth[4];
+
+	/* Touch some stack to verify that we have our own */
+	memset ( depth, 0xaa, sizeof ( depth ) );
+
+	/* Record events, yielding in between */
+	coroutine_test_record ( 'b' );
+	coroutine_yield();
+	coroutine_test_record ( 'd' );
+	coroutine_yield();
+	coroutine_test_record ( 'f' );
+}
+
+/**
+ * Perform coroutine self-tests
+ *
+ */
+static void coroutine_test_exec ( void ) {
+	struct coroutine coro;
+
+	/* Reset event log */
+	memset ( coroutine_test_log, 0, sizeof ( coroutine_test_log ) );
+	coroutine_test_logged = 0;
+
+	/* Run coroutine to completion, interleaving events */
+	coroutine_init ( &coro, coroutine_test_entry );
+	coroutine_test_record ( 'a' );
+	ok ( coroutine_resume ( &coro ) == 0 );
+	ok ( ! coroutine_done ( &coro ) );
+	coroutine_test_record ( 'c' );
+	ok ( coroutine_resume ( &coro ) == 0 );
+	ok ( ! coroutine_done ( &coro ) );
+	coroutine_test_record ( 'e' );
+	ok ( coroutine_resume ( &coro ) == 0 );
+	ok ( coroutine_done ( &coro ) );
+	coroutine_test_record ( 'g' );
+
+	/* Resuming a completed coroutine is a harmless no-op */
+	ok ( coroutine_resume ( &coro ) == 0 );
+	ok ( coroutine_done ( &coro ) );
+
+	/* Check event interleaving */
+	ok ( strcmp ( coroutine_test_log, "abcdefg" ) == 0 );
+}
+
+/** Coroutine self-test */
+struct self_test coroutine_test __self_test = {
+	.name = "coroutine",
+	.exec = coroutine_test_exec,
+};
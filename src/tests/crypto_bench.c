@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Cryptographic primitive benchmarks
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ipxe/crypto.h>
+#include <ipxe/sha256.h>
+#include <ipxe/aes.h>
+#include <ipxe/profile.h>
+#include <ipxe/bench.h>
+
+/** Data buffer (too large for stack) */
+static uint8_t crypto_bench_data[8192];
+
+/**
+ * Run SHA-256 benchmark
+ *
+ */
+static void crypto_bench_sha256 ( void ) {
+	struct digest_algorithm *digest = &sha256_algorithm;
+	uint8_t ctx[digest->ctxsize];
+	uint8_t out[digest->digestsize];
+	struct profiler profiler;
+	unsigned int i;
+
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+		profile_start ( &profiler );
+		digest_init ( digest, ctx );
+		digest_update ( digest, ctx, crypto_bench_data,
+				sizeof ( crypto_bench_data ) );
+		digest_final ( digest, ctx, out );
+		profile_stop ( &profiler );
+	}
+	bench_report ( "sha256", sizeof ( crypto_bench_data ), &profiler );
+}
+
+/**
+ * Run AES-128-CBC benchmark
+ *
+ */
+static void crypto_bench_aes ( void ) {
+	struct cipher_algorithm *cipher = &aes_cbc_algorithm;
+	uint8_t key[16];
+	uint8_t iv[cipher->blocksize];
+	uint8_t ctx[cipher->ctxsize];
+	struct profiler profiler;
+	unsigned int i;
+	int rc;
+
+	/* Initialise cipher */
+	for ( i = 0 ; i < sizeof ( key ) ; i++ )
+		key[i] = rand();
+	for ( i = 0 ; i < sizeof ( iv ) ; i++ )
+		iv[i] = rand();
+	rc = cipher_setkey ( cipher, ctx, key, sizeof ( key ) );
+	assert ( rc == 0 );
+	cipher_setiv ( cipher, ctx, iv, sizeof ( iv ) );
+
+	/* Profile encryption */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+		profile_start ( &profiler );
+		cipher_encrypt ( cipher, ctx, crypto_bench_data,
+				 crypto_bench_data,
+				 sizeof ( crypto_bench_data ) );
+		profile_stop ( &profiler );
+	}
+	bench_report ( "aes128cbc/enc", sizeof ( crypto_bench_data ),
+		       &profiler );
+
+	/* Profile decryption */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+		profile_start ( &profiler );
+		cipher_decrypt ( cipher, ctx, crypto_bench_data,
+				 crypto_bench_data,
+				 sizeof ( crypto_bench_data ) );
+		profile_stop ( &profiler );
+	}
+	bench_report ( "aes128cbc/dec", sizeof ( crypto_bench_data ),
+		       &profiler );
+}
+
+/**
+ * Run cryptographic primitive benchmarks
+ *
+ */
+static void crypto_bench_exec ( void ) {
+	unsigned int i;
+
+	/* Fill buffer with pseudo-random data */
+	srand ( 0x1234568 );
+	for ( i = 0 ; i < sizeof ( crypto_bench_data ) ; i++ )
+		crypto_bench_data[i] = rand();
+
+	crypto_bench_sha256();
+	crypto_bench_aes();
+}
+
+/** Cryptographic primitive benchmarks */
+struct self_benchmark crypto_bench __benchmark = {
+	.name = "crypto",
+	.exec = crypto_bench_exec,
+};
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * DEFLATE decompression benchmark
+ *
+ * There is no compressor in iPXE, so the compressed input is
+ * synthesised at run time as a static-Huffman block of literals
+ * restricted to the eight-bit code range.  This exercises the Huffman
+ * decode path (the hot path for compressed images) rather than the
+ * stored-block copy path.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ipxe/deflate.h>
+#include <ipxe/profile.h>
+#include <ipxe/bench.h>
+#include <ipxe/uaccess.h>
+
+/** Decompressed data length */
+#define DEFLATE_BENCH_LEN 8192
+
+/** Compressed data stream (too large for stack) */
+static uint8_t deflate_bench_stream[ DEFLATE_BENCH_LEN + 16 ];
+
+/** Decompression output buffer (too large for stack) */
+static uint8_t deflate_bench_out[DEFLATE_BENCH_LEN];
+
+/** Decompressor (too large for stack) */
+static struct deflate deflate_bench_deflate;
+
+/** Current bit offset within the compressed stream */
+static size_t deflate_bench_bits;
+
+/**
+ * Write bits to the compressed stream (least significant bit first)
+ *
+ * @v data		Data to write
+ * @v len		Number of bits
+ */
+static void deflate_bench_write ( unsigned int data, unsigned int len ) {
+
+	while ( len-- ) {
+		if ( data & 1 ) {
+			deflate_bench_stream[ deflate_bench_bits / 8 ] |=
+				( 1 << ( deflate_bench_bits % 8 ) );
+		}
+		deflate_bench_bits++;
+		data >>= 1;
+	}
+}
+
+/**
+ * Write a Huffman code to the compressed stream (most significant bit first)
+ *
+ * @v code		Huffman code
+ * @v count		Number of bits
+ */
+static void deflate_bench_write_huf ( unsigned int code,
+				      unsigned int count ) {
+
+	while ( count-- )
+		deflate_bench_write ( ( ( code >> count ) & 1 ), 1 );
+}
+
+/**
+ * Synthesise compressed data stream
+ *
+ * @ret len		Length of compressed stream
+ */
+static size_t deflate_bench_synthesise ( void ) {
+	unsigned int i;
+
+	/* Construct a single static-Huffman block of literals.
+	 * Literals below 144 have eight-bit codes (0x30 + literal),
+	 * and the end-of-block code is seven zero bits.
+	 */
+	memset ( deflate_bench_stream, 0,
+		 sizeof ( deflate_bench_stream ) );
+	deflate_bench_bits = 0;
+	deflate_bench_write ( 1, 1 );	/* BFINAL */
+	deflate_bench_write ( 1, 2 );	/* BTYPE: static Huffman */
+	srand ( 0x1234568 );
+	for ( i = 0 ; i < DEFLATE_BENCH_LEN ; i++ ) {
+		deflate_bench_write_huf ( ( 0x30 + ( rand() % 144 ) ), 8 );
+	}
+	deflate_bench_write_huf ( 0, 7 ); /* End of block */
+
+	return ( ( deflate_bench_bits + 7 ) / 8 );
+}
+
+/**
+ * Run DEFLATE decompression benchmark
+ *
+ */
+static void deflate_bench_exec ( void ) {
+	struct deflate *deflate = &deflate_bench_deflate;
+	struct deflate_chunk in;
+	struct deflate_chunk out;
+	struct profiler profiler;
+	size_t len;
+	unsigned int i;
+
+	/* Synthesise compressed data */
+	len = deflate_bench_synthesise();
+
+	/* Profile decompression */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+		deflate_init ( deflate, DEFLATE_RAW );
+		deflate_chunk_init ( &in,
+				     virt_to_user ( deflate_bench_stream ),
+				     0, len );
+		deflate_chunk_init ( &out,
+				     virt_to_user ( deflate_bench_out ),
+				     0, sizeof ( deflate_bench_out ) );
+		profile_start ( &profiler );
+		deflate_inflate ( deflate, &in, &out );
+		profile_stop ( &profiler );
+		assert ( deflate_finished ( deflate ) );
+		assert ( out.offset == DEFLATE_BENCH_LEN );
+	}
+	bench_report ( "deflate", DEFLATE_BENCH_LEN, &profiler );
+}
+
+/** DEFLATE decompression benchmark */
+struct self_benchmark deflate_bench __benchmark = {
+	.name = "deflate",
+	.exec = deflate_bench_exec,
+};
@@ -35,9 +35,14 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <assert.h>
 #include <ipxe/deflate.h>
+#include <ipxe/profile.h>
 #include <ipxe/test.h>
 
+/** Number of sample iterations for profiling */
+#define PROFILE_COUNT 16
+
 /** A DEFLATE test */
 struct deflate_test {
 	/** Compression format */
@@ -143,6 +148,26 @@ static struct deflate_test_fragments zlib_fragments[] = {
 	{ { 48, -1UL } },
 };
 
+/* "Hello hello world", gzipped with stored file name "hello.txt" */
+DEFLATE ( gzip, DEFLATE_GZIP,
+	  DATA ( 0x1f, 0x8b, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+		 0x68, 0x65, 0x6c, 0x6c, 0x6f, 0x2e, 0x74, 0x78, 0x74, 0x00,
+		 0xf3, 0x48, 0xcd, 0xc9, 0xc9, 0x57, 0xc8, 0x00, 0x93, 0xe5,
+		 0xf9, 0x45, 0x39, 0x29, 0x00, 0xbf, 0x0d, 0x3d, 0xc7, 0x11,
+		 0x00, 0x00, 0x00 ),
+	  DATA ( 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x20, 0x68, 0x65, 0x6c, 0x6c,
+		 0x6f, 0x20, 0x77, 0x6f, 0x72, 0x6c, 0x64 ) );
+
+/* Gzipped "Hello hello world" fragment list */
+static struct deflate_test_fragments gzip_fragments[] = {
+	{ { -1UL, } },
+	{ { 0, 1, 1, 5, 9, -1UL, } },
+	{ { 4, 6, 8, 3, 14, 5, -1UL } },
+	{ { 19, 16, 4, -1UL } },
+	{ { 35, -1UL } },
+	{ { 42, -1UL } },
+};
+
 /**
  * Report DEFLATE test result
  *
@@ -207,6 +232,143 @@ static void deflate_okx ( struct deflate *deflate,
 #define deflate_ok( deflate, test, frags ) \
 	deflate_okx ( deflate, test, frags, __FILE__, __LINE__ )
 
+/** A benchmark bit stream writer */
+struct deflate_test_bits {
+	/** Data buffer */
+	uint8_t *data;
+	/** Current offset (in bits) */
+	size_t offset;
+};
+
+/**
+ * Write bits to benchmark bit stream (least significant bit first)
+ *
+ * @v bits		Benchmark bit stream writer
+ * @v value		Value
+ * @v count		Number of bits
+ */
+static void deflate_test_write ( struct deflate_test_bits *bits,
+				 unsigned int value, unsigned int count ) {
+
+	while ( count-- ) {
+		if ( value & 1 )
+			bits->data[ bits->offset / 8 ] |=
+				( 1 << ( bits->offset % 8 ) );
+		bits->offset++;
+		value >>= 1;
+	}
+}
+
+/**
+ * Write Huffman-coded symbol to benchmark bit stream
+ *
+ * Huffman-coded symbols are stored most significant bit first.
+ *
+ * @v bits		Benchmark bit stream writer
+ * @v code		Huffman-coded symbol
+ * @v count		Length of Huffman-coded symbol (in bits)
+ */
+static void deflate_test_write_huf ( struct deflate_test_bits *bits,
+				     unsigned int code, unsigned int count ) {
+
+	while ( count-- )
+		deflate_test_write ( bits, ( ( code >> count ) & 1 ), 1 );
+}
+
+/**
+ * Calculate DEFLATE decompression cost
+ *
+ * @v deflate		Decompressor
+ * @v format		Compression format
+ * @v compressed	Compressed data
+ * @v compressed_len	Length of compressed data
+ * @v expected_len	Length of decompressed data
+ * @ret cost		Cost (in cycles per decompressed byte)
+ */
+static unsigned long deflate_cost ( struct deflate *deflate,
+				    enum deflate_format format,
+				    const void *compressed,
+				    size_t compressed_len,
+				    size_t expected_len ) {
+	static uint8_t data[8192]; /* Too large for stack */
+	struct deflate_chunk in;
+	struct deflate_chunk out;
+	struct profiler profiler;
+	unsigned int i;
+
+	/* Sanity check */
+	assert ( expected_len <= sizeof ( data ) );
+
+	/* Profile decompression */
+	memset ( &profiler, 0, sizeof ( profiler ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		deflate_init ( deflate, format );
+		deflate_chunk_init ( &in, virt_to_user ( compressed ), 0,
+				     compressed_len );
+		deflate_chunk_init ( &out, virt_to_user ( data ), 0,
+				     sizeof ( data ) );
+		profile_start ( &profiler );
+		deflate_inflate ( deflate, &in, &out );
+		profile_stop ( &profiler );
+		assert ( deflate_finished ( deflate ) );
+		assert ( out.offset == expected_len );
+	}
+
+	/* Round to nearest whole number of cycles per byte */
+	return ( ( profile_mean ( &profiler ) + ( expected_len / 2 ) ) /
+		 expected_len );
+}
+
+/**
+ * Benchmark DEFLATE decompression speed
+ *
+ * @v deflate		Decompressor
+ */
+static void deflate_test_speed ( struct deflate *deflate ) {
+	static uint8_t literal[ 5 + 4096 ];   /* Too large for stack */
+	static uint8_t huffman[32];
+	struct deflate_test_bits bits;
+	unsigned int dups = 15;
+	size_t huffman_expected_len = ( 1 + ( 258 * dups ) );
+	unsigned int i;
+
+	/* Construct single literal block (uncompressed data path) */
+	memset ( literal, 0, sizeof ( literal ) );
+	literal[0] = 0x01;	/* BFINAL, BTYPE=00 */
+	literal[1] = ( ( sizeof ( literal ) - 5 ) & 0xff );
+	literal[2] = ( ( sizeof ( literal ) - 5 ) >> 8 );
+	literal[3] = ~literal[1];
+	literal[4] = ~literal[2];
+	srand ( 0x1234568 );
+	for ( i = 5 ; i < sizeof ( literal ) ; i++ )
+		literal[i] = rand();
+
+	/* Construct static Huffman block comprising a single literal
+	 * followed by maximum-length duplications at distance one
+	 * (Huffman decode and match copy paths).
+	 */
+	memset ( huffman, 0, sizeof ( huffman ) );
+	bits.data = huffman;
+	bits.offset = 0;
+	deflate_test_write ( &bits, 0x03, 3 );	 /* BFINAL, BTYPE=01 */
+	deflate_test_write_huf ( &bits, ( 0x30 + 'A' ), 8 ); /* Literal 'A' */
+	for ( i = 0 ; i < dups ; i++ ) {
+		deflate_test_write_huf ( &bits, 0xc5, 8 ); /* Length 258 */
+		deflate_test_write_huf ( &bits, 0x00, 5 ); /* Distance 1 */
+	}
+	deflate_test_write_huf ( &bits, 0x00, 7 ); /* End of block */
+	assert ( bits.offset <= ( 8 * sizeof ( huffman ) ) );
+
+	/* Report costs */
+	DBG ( "DEFLATE literal decompression required %ld cycles per byte\n",
+	      deflate_cost ( deflate, DEFLATE_RAW, literal,
+			     sizeof ( literal ), ( sizeof ( literal ) - 5 ) ) );
+	DBG ( "DEFLATE match decompression required %ld cycles per byte\n",
+	      deflate_cost ( deflate, DEFLATE_RAW, huffman,
+			     ( ( bits.offset + 7 ) / 8 ),
+			     huffman_expected_len ) );
+}
+
 /**
  * Perform DEFLATE self-test
  *
@@ -231,12 +393,20 @@ static void deflate_test_exec ( void ) {
 		deflate_ok ( deflate, &hello_hello_world, NULL );
 		deflate_ok ( deflate, &rfc_sentence, NULL );
 		deflate_ok ( deflate, &zlib, NULL );
+		deflate_ok ( deflate, &gzip, NULL );
 
 		/* Test fragmentation */
 		for ( i = 0 ; i < ( sizeof ( zlib_fragments ) /
 				    sizeof ( zlib_fragments[0] ) ) ; i++ ) {
 			deflate_ok ( deflate, &zlib, &zlib_fragments[i] );
 		}
+		for ( i = 0 ; i < ( sizeof ( gzip_fragments ) /
+				    sizeof ( gzip_fragments[0] ) ) ; i++ ) {
+			deflate_ok ( deflate, &gzip, &gzip_fragments[i] );
+		}
+
+		/* Speed tests */
+		deflate_test_speed ( deflate );
 	}
 
 	/* Free shared structure */
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * HMAC-based key derivation function (HKDF) tests
+ *
+ * These test vectors are taken from RFC 5869 appendix A.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <assert.h>
+#include <string.h>
+#include <ipxe/hkdf.h>
+#include <ipxe/sha256.h>
+#include <ipxe/test.h>
+
+/** Define inline data */
+#define DATA(...) { __VA_ARGS__ }
+
+/** An HKDF test */
+struct hkdf_test {
+	/** Digest algorithm */
+	struct digest_algorithm *digest;
+	/** Input keying material */
+	const void *ikm;
+	/** Length of input keying material */
+	size_t ikm_len;
+	/** Salt */
+	const void *salt;
+	/** Length of salt */
+	size_t salt_len;
+	/** Context information */
+	const void *info;
+	/** Length of context information */
+	size_t info_len;
+	/** Expected pseudorandom key */
+	const void *prk;
+	/** Length of expected pseudorandom key */
+	size_t prk_len;
+	/** Expected output keying material */
+	const void *okm;
+	/** Length of expected output keying material */
+	size_t okm_len;
+};
+
+/** Define an HKDF test */
+#define HKDF_TEST( name, DIGEST, IKM, SALT, INFO, PRK, OKM )		\
+	static const uint8_t name ## _ikm[] = IKM;			\
+	static const uint8_t name ## _salt[] = SALT;			\
+	static const uint8_t name ## _info[] = INFO;			\
+	static const uint8_t name ## _prk[] = PRK;			\
+	static const uint8_t name ## _okm[] = OKM;			\
+	static struct hkdf_test name = {				\
+		.digest = DIGEST,					\
+		.ikm = name ## _ikm,					\
+		.ikm_len = sizeof ( name ## _ikm ),			\
+		.salt = name ## _salt,					\
+		.salt_len = sizeof ( name ## _salt ),			\
+		.info = name ## _info,					\
+		.info_len = sizeof ( name ## _info ),			\
+		.prk = name ## _prk,					\
+		.prk_len = sizeof ( name ## _prk ),			\
+		.okm = name ## _okm,					\
+		.okm_len = sizeof ( name ## _okm ),			\
+	}
+
+/** RFC 5869 test case 1: basic SHA-256 */
+HKDF_TEST ( hkdf_sha256_basic, &sha256_algorithm,
+	DATA ( 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+	       0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+	       0x0b, 0x0b ),
+	DATA ( 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+	       0x0a, 0x0b, 0x0c ),
+	DATA ( 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9 ),
+	DATA ( 0x07, 0x77, 0x09, 0x36, 0x2c, 0x2e, 0x32, 0xdf, 0x0d, 0xdc,
+	       0x3f, 0x0d, 0xc4, 0x7b, 0xba, 0x63, 0x90, 0xb6, 0xc7, 0x3b,
+	       0xb5, 0x0f, 0x9c, 0x31, 0x22, 0xec, 0x84, 0x4a, 0xd7, 0xc2,
+	       0xb3, 0xe5 ),
+	DATA ( 0x3c, 0xb2, 0x5f, 0x25, 0xfa, 0xac, 0xd5, 0x7a, 0x90, 0x43,
+	       0x4f, 0x64, 0xd0, 0x36, 0x2f, 0x2a, 0x2d, 0x2d, 0x0a, 0x90,
+	       0xcf, 0x1a, 0x5a, 0x4c, 0x5d, 0xb0, 0x2d, 0x56, 0xec, 0xc4,
+	       0xc5, 0xbf, 0x34, 0x00, 0x72, 0x08, 0xd5, 0xb8, 0x87, 0x18,
+	       0x58, 0x65 ) );
+
+/** RFC 5869 test case 2: SHA-256 with longer inputs/outputs */
+HKDF_TEST ( hkdf_sha256_long, &sha256_algorithm,
+	DATA ( 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+	       0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13,
+	       0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+	       0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+	       0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31,
+	       0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+	       0x3c, 0x3d, 0x3e, 0x3f, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45,
+	       0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f ),
+	DATA ( 0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	       0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72, 0x73,
+	       0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x7b, 0x7c, 0x7d,
+	       0x7e, 0x7f, 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	       0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91,
+	       0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b,
+	       0x9c, 0x9d, 0x9e, 0x9f, 0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5,
+	       0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf ),
+	DATA ( 0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9,
+	       0xba, 0xbb, 0xbc, 0xbd, 0xbe, 0xbf, 0xc0, 0xc1, 0xc2, 0xc3,
+	       0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd,
+	       0xce, 0xcf, 0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7,
+	       0xd8, 0xd9, 0xda, 0xdb, 0xdc, 0xdd, 0xde, 0xdf, 0xe0, 0xe1,
+	       0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xeb,
+	       0xec, 0xed, 0xee, 0xef, 0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5,
+	       0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff ),
+	DATA ( 0x06, 0xa6, 0xb8, 0x8c, 0x58, 0x53, 0x36, 0x1a, 0x06, 0x10,
+	       0x4c, 0x9c, 0xeb, 0x35, 0xb4, 0x5c, 0xef, 0x76, 0x00, 0x14,
+	       0x90, 0x46, 0x71, 0x01, 0x4a, 0x19, 0x3f, 0x40, 0xc1, 0x5f,
+	       0xc2, 0x44 ),
+	DATA ( 0xb1, 0x1e, 0x39, 0x8d, 0xc8, 0x03, 0x27, 0xa1, 0xc8, 0xe7,
+	       0xf7, 0x8c, 0x59, 0x6a, 0x49, 0x34, 0x4f, 0x01, 0x2e, 0xda,
+	       0x2d, 0x4e, 0xfa, 0xd8, 0xa0, 0x50, 0xcc, 0x4c, 0x19, 0xaf,
+	       0xa9, 0x7c, 0x59, 0x04, 0x5a, 0x99, 0xca, 0xc7, 0x82, 0x72,
+	       0x71, 0xcb, 0x41, 0xc6, 0x5e, 0x59, 0x0e, 0x09, 0xda, 0x32,
+	       0x75, 0x60, 0x0c, 0x2f, 0x09, 0xb8, 0x36, 0x77, 0x93, 0xa9,
+	       0xac, 0xa3, 0xdb, 0x71, 0xcc, 0x30, 0xc5, 0x81, 0x79, 0xec,
+	       0x3e, 0x87, 0xc1, 0x4c, 0x01, 0xd5, 0xc1, 0xf3, 0x43, 0x4f,
+	       0x1d, 0x87 ) );
+
+/**
+ * Report an HKDF test result
+ *
+ * @v test		HKDF test
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void hkdf_okx ( struct hkdf_test *test, const char *file,
+		       unsigned int line ) {
+	struct digest_algorithm *digest = test->digest;
+	uint8_t prk[ digest->digestsize ];
+	uint8_t okm[ test->okm_len ];
+
+	/* Check pseudorandom key extraction */
+	okx ( test->prk_len == sizeof ( prk ), file, line );
+	hkdf_extract ( digest, test->salt, test->salt_len, test->ikm,
+		       test->ikm_len, prk );
+	okx ( memcmp ( prk, test->prk, sizeof ( prk ) ) == 0, file, line );
+
+	/* Check output keying material expansion */
+	okx ( hkdf_expand ( digest, prk, sizeof ( prk ), test->info,
+			    test->info_len, okm, sizeof ( okm ) ) == 0,
+	      file, line );
+	okx ( memcmp ( okm, test->okm, sizeof ( okm ) ) == 0, file, line );
+}
+#define hkdf_ok( test ) hkdf_okx ( test, __FILE__, __LINE__ )
+
+/** RFC 5869 test case 3: SHA-256 with zero-length salt and info */
+static const uint8_t hkdf_sha256_nosalt_ikm[22] = {
+	0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+	0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b
+};
+static const uint8_t hkdf_sha256_nosalt_okm[42] = {
+	0x8d, 0xa4, 0xe7, 0x75, 0xa5, 0x63, 0xc1, 0x8f, 0x71, 0x5f, 0x80,
+	0x2a, 0x06, 0x3c, 0x5a, 0x31, 0xb8, 0xa1, 0x1f, 0x5c, 0x5e, 0xe1,
+	0x87, 0x9e, 0xc3, 0x45, 0x4e, 0x5f, 0x3c, 0x73, 0x8d, 0x2d, 0x9d,
+	0x20, 0x13, 0x95, 0xfa, 0xa4, 0xb6, 0x1a, 0x96, 0xc8
+};
+
+/**
+ * Perform HKDF self-tests
+ *
+ */
+static void hkdf_test_exec ( void ) {
+	struct digest_algorithm *sha256 = &sha256_algorithm;
+	uint8_t prk[SHA256_DIGEST_SIZE];
+	uint8_t okm[ sizeof ( hkdf_sha256_nosalt_okm ) ];
+
+	/* RFC 5869 test cases 1 and 2 */
+	hkdf_ok ( &hkdf_sha256_basic );
+	hkdf_ok ( &hkdf_sha256_long );
+
+	/* RFC 5869 test case 3 (zero-length salt and info) */
+	hkdf_extract ( sha256, NULL, 0, hkdf_sha256_nosalt_ikm,
+		       sizeof ( hkdf_sha256_nosalt_ikm ), prk );
+	ok ( hkdf_expand ( sha256, prk, sizeof ( prk ), NULL, 0, okm,
+			   sizeof ( okm ) ) == 0 );
+	ok ( memcmp ( okm, hkdf_sha256_nosalt_okm, sizeof ( okm ) ) == 0 );
+
+	/* Over-length output must be refused */
+	ok ( hkdf_expand ( sha256, prk, sizeof ( prk ), NULL, 0, NULL,
+			   ( 255 * SHA256_DIGEST_SIZE + 1 ) ) != 0 );
+}
+
+/** HKDF self-test */
+struct self_test hkdf_test __self_test = {
+	.name = "hkdf",
+	.exec = hkdf_test_exec,
+};
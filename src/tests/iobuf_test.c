@@ -104,6 +104,8 @@ static inline void alloc_iob_fail_okx ( size_t len, size_t align, size_t offset,
  *
  */
 static void iobuf_test_exec ( void ) {
+	struct io_buffer *iobuf;
+	struct io_buffer *frag;
 
 	/* Check zero-length allocations */
 	alloc_iob_ok ( 0, 0, 0 );
@@ -127,6 +129,22 @@ static void iobuf_test_exec ( void ) {
 	alloc_iob_fail_ok ( -1UL, 1024, 0 );
 	alloc_iob_fail_ok ( 0, -1UL, 0 );
 	alloc_iob_fail_ok ( 1024, -1UL, 0 );
+
+	/* Check fragment chaining and flattening */
+	iobuf = alloc_iob ( 16 );
+	ok ( iobuf != NULL );
+	memcpy ( iob_put ( iobuf, 6 ), "chain ", 6 );
+	frag = alloc_iob ( 16 );
+	ok ( frag != NULL );
+	memcpy ( iob_put ( frag, 4 ), "test", 4 );
+	iob_chain ( iobuf, frag );
+	ok ( iob_total_len ( iobuf ) == 10 );
+	iobuf = iob_defrag ( iobuf );
+	ok ( iobuf != NULL );
+	ok ( list_empty ( &iobuf->fragments ) );
+	ok ( iob_len ( iobuf ) == 10 );
+	ok ( memcmp ( iobuf->data, "chain test", 10 ) == 0 );
+	free_iob ( iobuf );
 }
 
 /** I/O buffer self-test */
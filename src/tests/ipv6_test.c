@@ -35,6 +35,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <string.h>
 #include <byteswap.h>
+#include <ipxe/ethernet.h>
 #include <ipxe/ipv6.h>
 #include <ipxe/test.h>
 
@@ -109,9 +110,14 @@ static const struct in6_addr sample_multicast = {
 			  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 ),
 };
 
+/** Dummy network device operations */
+static struct net_device_operations ipv6_test_netdev_operations = {};
+
 /** Dummy network device used for routing tests */
 static struct net_device ipv6_test_netdev = {
 	.refcnt = REF_INIT ( ref_no_free ),
+	.op = &ipv6_test_netdev_operations,
+	.ll_protocol = &ethernet_protocol,
 	.index = 42,
 	.state = NETDEV_OPEN,
 };
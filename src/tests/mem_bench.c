@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Memory primitive benchmarks
+ *
+ * Small lengths are repeated within each sample so that the
+ * measurement is not dominated by timestamp overhead.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ipxe/profile.h>
+#include <ipxe/bench.h>
+
+/** Benchmarked transfer lengths */
+static const size_t mem_bench_lens[] = { 64, 1500, 4096, 65536 };
+
+/** Number of operations per sample */
+#define MEM_BENCH_LOOPS 16
+
+/** Source buffer (too large for stack) */
+static uint8_t mem_bench_src[65536];
+
+/** Destination buffer (too large for stack) */
+static uint8_t mem_bench_dst[65536];
+
+/**
+ * Run memory primitive benchmarks
+ *
+ */
+static void mem_bench_exec ( void ) {
+	struct profiler profiler;
+	char name[32];
+	unsigned int i;
+	unsigned int loop;
+	unsigned int len_idx;
+	size_t len;
+
+	for ( len_idx = 0 ; len_idx < ( sizeof ( mem_bench_lens ) /
+					sizeof ( mem_bench_lens[0] ) ) ;
+	      len_idx++ ) {
+		len = mem_bench_lens[len_idx];
+
+		/* Profile memcpy() */
+		memset ( &profiler, 0, sizeof ( profiler ) );
+		for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+			profile_start ( &profiler );
+			for ( loop = 0 ; loop < MEM_BENCH_LOOPS ; loop++ ) {
+				memcpy ( mem_bench_dst, mem_bench_src, len );
+			}
+			profile_stop ( &profiler );
+		}
+		snprintf ( name, sizeof ( name ), "memcpy/%zd", len );
+		bench_report ( name, ( len * MEM_BENCH_LOOPS ), &profiler );
+
+		/* Profile memset() */
+		memset ( &profiler, 0, sizeof ( profiler ) );
+		for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+			profile_start ( &profiler );
+			for ( loop = 0 ; loop < MEM_BENCH_LOOPS ; loop++ ) {
+				memset ( mem_bench_dst, 0xaa, len );
+			}
+			profile_stop ( &profiler );
+		}
+		snprintf ( name, sizeof ( name ), "memset/%zd", len );
+		bench_report ( name, ( len * MEM_BENCH_LOOPS ), &profiler );
+	}
+}
+
+/** Memory primitive benchmarks */
+struct self_benchmark mem_bench __benchmark = {
+	.name = "memory",
+	.exec = mem_bench_exec,
+};
@@ -391,7 +391,7 @@ static void peerdist_info_okx ( struct peerdist_info_test *test,
  * @v line		Test code line
  */
 static void peerdist_info_segment_okx ( struct peerdist_info_segment_test *test,
-					const struct peerdist_info *info,
+					struct peerdist_info *info,
 					struct peerdist_info_segment *segment,
 					const char *file, unsigned int line ) {
 	size_t digestsize = info->digestsize;
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * TCP/IP checksum benchmark
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/profile.h>
+#include <ipxe/bench.h>
+
+/** Benchmarked checksum lengths (MTU-sized and bulk) */
+static const size_t tcpip_bench_lens[] = { 1500, 8192 };
+
+/** Number of checksums per sample */
+#define TCPIP_BENCH_LOOPS 16
+
+/** Data buffer (too large for stack) */
+static uint8_t tcpip_bench_data[8192];
+
+/**
+ * Run TCP/IP checksum benchmark
+ *
+ */
+static void tcpip_bench_exec ( void ) {
+	struct profiler profiler;
+	char name[32];
+	unsigned int i;
+	unsigned int loop;
+	unsigned int len_idx;
+	size_t len;
+
+	/* Fill buffer with pseudo-random data */
+	srand ( 0x1234568 );
+	for ( i = 0 ; i < sizeof ( tcpip_bench_data ) ; i++ )
+		tcpip_bench_data[i] = rand();
+
+	for ( len_idx = 0 ; len_idx < ( sizeof ( tcpip_bench_lens ) /
+					sizeof ( tcpip_bench_lens[0] ) ) ;
+	      len_idx++ ) {
+		len = tcpip_bench_lens[len_idx];
+
+		/* Profile checksum calculation */
+		memset ( &profiler, 0, sizeof ( profiler ) );
+		for ( i = 0 ; i < BENCH_COUNT ; i++ ) {
+			profile_start ( &profiler );
+			for ( loop = 0 ; loop < TCPIP_BENCH_LOOPS ; loop++ ) {
+				tcpip_chksum ( tcpip_bench_data, len );
+			}
+			profile_stop ( &profiler );
+		}
+		snprintf ( name, sizeof ( name ), "tcpip_chksum/%zd", len );
+		bench_report ( name, ( len * TCPIP_BENCH_LOOPS ), &profiler );
+	}
+}
+
+/** TCP/IP checksum benchmark */
+struct self_benchmark tcpip_bench __benchmark = {
+	.name = "tcpip",
+	.exec = tcpip_bench_exec,
+};
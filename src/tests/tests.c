@@ -52,9 +52,12 @@ REQUIRE_OBJECT ( sha1_test );
 REQUIRE_OBJECT ( sha256_test );
 REQUIRE_OBJECT ( sha512_test );
 REQUIRE_OBJECT ( aes_test );
+REQUIRE_OBJECT ( chacha20poly1305_test );
 REQUIRE_OBJECT ( hmac_drbg_test );
 REQUIRE_OBJECT ( hash_df_test );
+REQUIRE_OBJECT ( hkdf_test );
 REQUIRE_OBJECT ( bigint_test );
+REQUIRE_OBJECT ( x25519_test );
 REQUIRE_OBJECT ( rsa_test );
 REQUIRE_OBJECT ( x509_test );
 REQUIRE_OBJECT ( ocsp_test );
@@ -66,6 +69,7 @@ REQUIRE_OBJECT ( dns_test );
 REQUIRE_OBJECT ( uri_test );
 REQUIRE_OBJECT ( profile_test );
 REQUIRE_OBJECT ( setjmp_test );
+REQUIRE_OBJECT ( coroutine_test );
 REQUIRE_OBJECT ( pccrc_test );
 REQUIRE_OBJECT ( linebuf_test );
 REQUIRE_OBJECT ( iobuf_test );
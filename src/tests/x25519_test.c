@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * X25519 key exchange tests
+ *
+ * These test vectors are taken from RFC 7748.
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <ipxe/x25519.h>
+#include <ipxe/test.h>
+
+/** An X25519 test */
+struct x25519_test {
+	/** Scalar */
+	uint8_t scalar[X25519_LEN];
+	/** Point */
+	uint8_t point[X25519_LEN];
+	/** Expected result */
+	uint8_t expected[X25519_LEN];
+};
+
+/**
+ * Report X25519 test result
+ *
+ * @v test		X25519 test
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void x25519_okx ( struct x25519_test *test, const char *file,
+			 unsigned int line ) {
+	uint8_t result[X25519_LEN];
+
+	okx ( x25519 ( test->scalar, test->point, result ) == 0, file, line );
+	okx ( memcmp ( result, test->expected, sizeof ( result ) ) == 0,
+	      file, line );
+}
+#define x25519_ok( test ) x25519_okx ( test, __FILE__, __LINE__ )
+
+/** Basic scalar multiplication (RFC 7748 section 5.2) */
+static struct x25519_test x25519_vector = {
+	.scalar = { 0xa5, 0x46, 0xe3, 0x6b, 0xf0, 0x52, 0x7c, 0x9d,
+		    0x3b, 0x16, 0x15, 0x4b, 0x82, 0x46, 0x5e, 0xdd,
+		    0x62, 0x14, 0x4c, 0x0a, 0xc1, 0xfc, 0x5a, 0x18,
+		    0x50, 0x6a, 0x22, 0x44, 0xba, 0x44, 0x9a, 0xc4 },
+	.point = { 0xe6, 0xdb, 0x68, 0x67, 0x58, 0x30, 0x30, 0xdb,
+		   0x35, 0x94, 0xc1, 0xa4, 0x24, 0xb1, 0x5f, 0x7c,
+		   0x72, 0x66, 0x24, 0xec, 0x26, 0xb3, 0x35, 0x3b,
+		   0x10, 0xa9, 0x03, 0xa6, 0xd0, 0xab, 0x1c, 0x4c },
+	.expected = { 0xc3, 0xda, 0x55, 0x37, 0x9d, 0xe9, 0xc6, 0x90,
+		      0x8e, 0x94, 0xea, 0x4d, 0xf2, 0x8d, 0x08, 0x4f,
+		      0x32, 0xec, 0xcf, 0x03, 0x49, 0x1c, 0x71, 0xf7,
+		      0x54, 0xb4, 0x07, 0x55, 0x77, 0xa2, 0x85, 0x52 },
+};
+
+/** Alice's private key (RFC 7748 section 6.1) */
+static const uint8_t x25519_alice_private[X25519_LEN] = {
+	0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d,
+	0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45,
+	0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a,
+	0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a,
+};
+
+/** Alice's public key (RFC 7748 section 6.1) */
+static const uint8_t x25519_alice_public[X25519_LEN] = {
+	0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54,
+	0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a,
+	0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4,
+	0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a,
+};
+
+/** Bob's private key (RFC 7748 section 6.1) */
+static const uint8_t x25519_bob_private[X25519_LEN] = {
+	0x5d, 0xab, 0x08, 0x7e, 0x62, 0x4a, 0x8a, 0x4b,
+	0x79, 0xe1, 0x7f, 0x8b, 0x83, 0x80, 0x0e, 0xe6,
+	0x6f, 0x3b, 0xb1, 0x29, 0x26, 0x18, 0xb6, 0xfd,
+	0x1c, 0x2f, 0x8b, 0x27, 0xff, 0x88, 0xe0, 0xeb,
+};
+
+/** Bob's public key (RFC 7748 section 6.1) */
+static const uint8_t x25519_bob_public[X25519_LEN] = {
+	0xde, 0x9e, 0xdb, 0x7d, 0x7b, 0x7d, 0xc1, 0xb4,
+	0xd3, 0x5b, 0x61, 0xc2, 0xec, 0xe4, 0x35, 0x37,
+	0x3f, 0x83, 0x43, 0xc8, 0x5b, 0x78, 0x67, 0x4d,
+	0xad, 0xfc, 0x7e, 0x14, 0x6f, 0x88, 0x2b, 0x4f,
+};
+
+/** Shared secret (RFC 7748 section 6.1) */
+static const uint8_t x25519_shared[X25519_LEN] = {
+	0x4a, 0x5d, 0x9d, 0x5b, 0xa4, 0xce, 0x2d, 0xe1,
+	0x72, 0x8e, 0x3b, 0xf4, 0x80, 0x35, 0x0f, 0x25,
+	0xe0, 0x7e, 0x21, 0xc9, 0x47, 0xd1, 0x9e, 0x33,
+	0x76, 0xf0, 0x9b, 0x3c, 0x1e, 0x16, 0x17, 0x42,
+};
+
+/**
+ * Perform X25519 self-test
+ *
+ */
+static void x25519_test_exec ( void ) {
+	uint8_t result[X25519_LEN];
+	uint8_t zero[X25519_LEN];
+
+	/* Basic scalar multiplication */
+	x25519_ok ( &x25519_vector );
+
+	/* Public key calculation */
+	ok ( x25519 ( x25519_alice_private, x25519_base, result ) == 0 );
+	ok ( memcmp ( result, x25519_alice_public, sizeof ( result ) ) == 0 );
+	ok ( x25519 ( x25519_bob_private, x25519_base, result ) == 0 );
+	ok ( memcmp ( result, x25519_bob_public, sizeof ( result ) ) == 0 );
+
+	/* Shared secret calculation */
+	ok ( x25519 ( x25519_alice_private, x25519_bob_public, result ) == 0 );
+	ok ( memcmp ( result, x25519_shared, sizeof ( result ) ) == 0 );
+	ok ( x25519 ( x25519_bob_private, x25519_alice_public, result ) == 0 );
+	ok ( memcmp ( result, x25519_shared, sizeof ( result ) ) == 0 );
+
+	/* Rejection of small-order points yielding an all-zero result */
+	memset ( zero, 0, sizeof ( zero ) );
+	ok ( x25519 ( x25519_alice_private, zero, result ) != 0 );
+}
+
+/** X25519 self-test */
+struct self_test x25519_test __self_test = {
+	.name = "x25519",
+	.exec = x25519_test_exec,
+};
@@ -28,6 +28,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <errno.h>
 #include <ipxe/netdevice.h>
 #include <ipxe/dhcp.h>
+#include <ipxe/process.h>
+#include <ipxe/console.h>
 #include <ipxe/settings.h>
 #include <ipxe/image.h>
 #include <ipxe/sanboot.h>
@@ -210,18 +212,21 @@ int uriboot ( struct uri *filename, struct uri **root_paths,
 }
 
 /**
- * Close all open net devices
+ * Close all open net devices except one
+ *
+ * @v keep		Network device to keep open, or NULL
  *
  * Called before a fresh boot attempt in order to free up memory.  We
  * don't just close the device immediately after the boot fails,
  * because there may still be TCP connections in the process of
  * closing.
  */
-static void close_all_netdevs ( void ) {
+static void close_other_netdevs ( struct net_device *keep ) {
 	struct net_device *netdev;
 
 	for_each_netdev ( netdev ) {
-		ifclose ( netdev );
+		if ( netdev != keep )
+			ifclose ( netdev );
 	}
 }
 
@@ -375,6 +380,24 @@ static int have_pxe_menu ( void ) {
 		       setting_exists ( NULL, &filename_setting ) ) ) );
 }
 
+/**
+ * Check for an existing DHCP lease
+ *
+ * @v netdev		Network device
+ * @ret has_lease	Network device already holds a DHCP lease
+ *
+ * A chainloaded iPXE inherits the first-stage lease as a cached
+ * DHCPACK, which is registered as the network device's DHCP settings
+ * block before autoboot begins.  Such a device needs no further
+ * configuration: repeating the DHCP exchange would merely waste time
+ * reacquiring the same lease.
+ */
+static int netdev_has_lease ( struct net_device *netdev ) {
+
+	return ( find_child_settings ( netdev_settings ( netdev ),
+				       DHCP_SETTINGS_NAME ) != NULL );
+}
+
 /**
  * Boot from a network device
  *
@@ -388,16 +411,22 @@ int netboot ( struct net_device *netdev ) {
 	int rc;
 
 	/* Close all other network devices */
-	close_all_netdevs();
+	close_other_netdevs ( netdev );
 
 	/* Open device and display device status */
 	if ( ( rc = ifopen ( netdev ) ) != 0 )
 		goto err_ifopen;
 	ifstat ( netdev );
 
-	/* Configure device */
-	if ( ( rc = ifconf ( netdev, NULL ) ) != 0 )
-		goto err_dhcp;
+	/* Configure device, unless already configured (e.g. by a
+	 * concurrent configuration attempt across all devices) or
+	 * holding an inherited lease
+	 */
+	if ( ( ! netdev_has_lease ( netdev ) ) &&
+	     ( ! netdev_configuration_ok ( netdev ) ) ) {
+		if ( ( rc = ifconf ( netdev, NULL ) ) != 0 )
+			goto err_dhcp;
+	}
 	route();
 
 	/* Try PXE menu boot, if applicable */
@@ -514,6 +543,107 @@ void set_autoboot_ll_addr ( const void *ll_addr, size_t len ) {
 	is_autoboot_device = is_autoboot_ll_addr;
 }
 
+/** Timeout within which a device's link must come up to remain a
+ * candidate for concurrent configuration
+ */
+#define AUTOBOOT_LINK_TIMEOUT ( 15 * TICKS_PER_SEC )
+
+/**
+ * Test if network device is an autoboot candidate
+ *
+ * @v netdev		Network device
+ * @ret is_candidate	Network device is an autoboot candidate
+ */
+static int autoboot_candidate ( struct net_device *netdev ) {
+
+	return ( ( ! is_autoboot_device ) || is_autoboot_device ( netdev ) );
+}
+
+/**
+ * Concurrently configure all candidate network devices
+ *
+ * @ret netdev		First successfully configured device, or NULL
+ *
+ * Opens every candidate device and runs their configuration (e.g.
+ * DHCP) sessions concurrently, returning the first device to be
+ * successfully configured.  Devices whose link never comes up, or
+ * whose configuration fails, are closed as they drop out, and never
+ * delay the eventual winner.
+ */
+static struct net_device * netconf_all ( void ) {
+	struct net_device *netdev;
+	unsigned long start;
+	unsigned int count = 0;
+	int rc;
+
+	/* Open all candidate devices and start configuration */
+	for_each_netdev ( netdev ) {
+		if ( ! autoboot_candidate ( netdev ) )
+			continue;
+		if ( ( rc = ifopen ( netdev ) ) != 0 )
+			continue;
+		/* Proceed directly with an inherited lease, if present */
+		if ( netdev_has_lease ( netdev ) )
+			return netdev;
+		if ( ( rc = netdev_configure_all ( netdev ) ) != 0 ) {
+			printf ( "Could not configure %s: %s\n",
+				 netdev->name, strerror ( rc ) );
+			ifclose ( netdev );
+			continue;
+		}
+		printf ( "Configuring (%s %s)\n", netdev->name,
+			 netdev->ll_protocol->ntoa ( netdev->ll_addr ) );
+		count++;
+	}
+
+	/* Wait for first device to be successfully configured */
+	start = currticks();
+	while ( count ) {
+
+		/* Allow configuration jobs to progress */
+		step();
+
+		/* Allow user to cancel */
+		if ( iskey() && ( getchar() == CTRL_C ) )
+			break;
+
+		for_each_netdev ( netdev ) {
+
+			/* Skip non-candidate and already-closed devices */
+			if ( ! autoboot_candidate ( netdev ) )
+				continue;
+			if ( ! netdev_is_open ( netdev ) )
+				continue;
+
+			/* Drop devices whose link is still down after
+			 * the link-up timeout: their configuration
+			 * can no longer usefully complete.
+			 */
+			if ( netdev_configuration_in_progress ( netdev ) ) {
+				if ( ( ! netdev_link_ok ( netdev ) ) &&
+				     ( ( currticks() - start ) >
+				       AUTOBOOT_LINK_TIMEOUT ) ) {
+					printf ( "Link down on %s\n",
+						 netdev->name );
+					ifclose ( netdev );
+					count--;
+				}
+				continue;
+			}
+
+			/* Proceed with the first configured device */
+			if ( netdev_configuration_ok ( netdev ) )
+				return netdev;
+
+			/* Drop devices that failed configuration */
+			ifclose ( netdev );
+			count--;
+		}
+	}
+
+	return NULL;
+}
+
 /**
  * Boot the system
  */
@@ -521,14 +651,24 @@ static int autoboot ( void ) {
 	struct net_device *netdev;
 	int rc = -ENODEV;
 
-	/* Try booting from each network device.  If we have a
-	 * specified autoboot device location, then use only devices
-	 * matching that location.
+	/* Configure all candidate devices concurrently, and attempt
+	 * to boot from the first device to be successfully
+	 * configured.  This avoids waiting out full configuration
+	 * timeouts on dead ports before trying live ones.
+	 */
+	if ( ( netdev = netconf_all() ) != NULL ) {
+		if ( ( rc = netboot ( netdev ) ) == 0 )
+			return rc;
+	}
+
+	/* Fall back to trying each remaining network device in turn.
+	 * If we have a specified autoboot device location, then use
+	 * only devices matching that location.
 	 */
 	for_each_netdev ( netdev ) {
 
 		/* Skip any non-matching devices, if applicable */
-		if ( is_autoboot_device && ( ! is_autoboot_device ( netdev ) ) )
+		if ( ! autoboot_candidate ( netdev ) )
 			continue;
 
 		/* Attempt booting from this device */
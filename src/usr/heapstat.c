@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <ipxe/malloc.h>
+#include <usr/heapstat.h>
+
+/** @file
+ *
+ * Heap statistics
+ *
+ */
+
+/**
+ * Print heap statistics
+ *
+ */
+void heapstat ( void ) {
+	struct memory_stats stats;
+
+	mstats ( &stats );
+	printf ( "Free:%zd Used:%zd MaxUsed:%zd\n",
+		 stats.free, stats.used, stats.maxused );
+	printf ( "Largest free block:%zd Free blocks:%d Cached:%zd\n",
+		 stats.largest, stats.blocks, stats.cached );
+}
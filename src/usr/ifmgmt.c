@@ -33,7 +33,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/job.h>
 #include <ipxe/monojob.h>
 #include <ipxe/timer.h>
+#include <ipxe/tcp.h>
 #include <ipxe/errortab.h>
+#include <ipxe/milestone.h>
 #include <usr/ifmgmt.h>
 
 /** @file
@@ -125,6 +127,62 @@ void ifstat ( struct net_device *netdev ) {
 	ifstat_errors ( &netdev->rx_stats, "RXE" );
 }
 
+/**
+ * Get TCP rate history window
+ *
+ * This is a weak definition, which will be overridden if the TCP
+ * protocol is present in the build.
+ *
+ * @v age		Window age in seconds (0 = most recent)
+ * @v retransmits	Number of retransmissions to fill in
+ * @v stalls		Number of transmit window stalls to fill in
+ * @ret rc		Return status code
+ */
+__weak int tcp_rate_window ( unsigned int age __unused,
+			     unsigned int *retransmits __unused,
+			     unsigned int *stalls __unused ) {
+	return -ENOENT;
+}
+
+/**
+ * Print traffic rate history of network device
+ *
+ * @v netdev		Network device
+ */
+void ifstat_history ( struct net_device *netdev ) {
+	struct net_device_history *history = &netdev->history;
+	struct net_device_history_window *window;
+	unsigned int retransmits;
+	unsigned int stalls;
+	unsigned int age;
+	unsigned int index;
+	int has_tcp;
+
+	/* Determine whether or not TCP counters are available */
+	has_tcp = ( tcp_rate_window ( 0, &retransmits, &stalls ) == 0 );
+
+	/* Print one row per one-second window, oldest first */
+	printf ( "%s: %4s %10s %10s %6s %6s%s\n", netdev->name, "age",
+		 "TXB/s", "RXB/s", "TX/s", "RX/s",
+		 ( has_tcp ? "  RETR STALL" : "" ) );
+	for ( age = ( NETDEV_HISTORY_WINDOWS - 1 ) ; ; age-- ) {
+		index = ( ( history->index + NETDEV_HISTORY_WINDOWS - age ) %
+			  NETDEV_HISTORY_WINDOWS );
+		window = &history->windows[index];
+		printf ( "%*s  %3ds %10ld %10ld %6d %6d",
+			 ( ( int ) strlen ( netdev->name ) ), "", -age,
+			 window->tx_bytes, window->rx_bytes,
+			 window->tx_good, window->rx_good );
+		if ( has_tcp &&
+		     ( tcp_rate_window ( age, &retransmits, &stalls ) == 0 ) ) {
+			printf ( " %5d %5d", retransmits, stalls );
+		}
+		printf ( "\n" );
+		if ( age == 0 )
+			break;
+	}
+}
+
 /** Network device poller */
 struct ifpoller {
 	/** Job control interface */
@@ -296,5 +354,11 @@ int ifconf ( struct net_device *netdev,
 		 ( configurator ? configurator->name : "" ),
 		 ( configurator ? "] " : "" ),
 		 netdev->name, netdev->ll_protocol->ntoa ( netdev->ll_addr ) );
-	return ifpoller_wait ( netdev, configurator, 0, ifconf_progress );
+	rc = ifpoller_wait ( netdev, configurator, 0, ifconf_progress );
+
+	/* Record milestone on successful configuration */
+	if ( rc == 0 )
+		milestone ( configurator ? configurator->name : "config" );
+
+	return rc;
 }
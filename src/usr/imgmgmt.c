@@ -32,6 +32,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/monojob.h>
 #include <ipxe/open.h>
 #include <ipxe/uri.h>
+#include <ipxe/list.h>
+#include <ipxe/interface.h>
+#include <ipxe/process.h>
+#include <ipxe/console.h>
+#include <ipxe/keys.h>
+#include <ipxe/timer.h>
 #include <usr/imgmgmt.h>
 
 /** @file
@@ -130,6 +136,196 @@ int imgdownload_string ( const char *uri_string, unsigned long timeout,
 	return rc;
 }
 
+/** A background download */
+struct image_download {
+	/** Reference count for this object */
+	struct refcnt refcnt;
+	/** Job control interface to downloader */
+	struct interface job;
+	/** Image being downloaded */
+	struct image *image;
+	/** List of background downloads */
+	struct list_head list;
+	/** Download has completed */
+	int done;
+	/** Completion status */
+	int rc;
+};
+
+/** List of background downloads */
+static LIST_HEAD ( image_downloads );
+
+/**
+ * Free background download
+ *
+ * @v refcnt		Reference count
+ */
+static void image_download_free ( struct refcnt *refcnt ) {
+	struct image_download *download =
+		container_of ( refcnt, struct image_download, refcnt );
+
+	image_put ( download->image );
+	free ( download );
+}
+
+/**
+ * Handle background download completion
+ *
+ * @v download		Background download
+ * @v rc		Reason for completion
+ */
+static void image_download_close ( struct image_download *download, int rc ) {
+
+	/* Register image, if the download succeeded */
+	if ( rc == 0 )
+		rc = register_image ( download->image );
+
+	/* Record completion; the download is reaped by imgwait() */
+	download->done = 1;
+	download->rc = rc;
+	intf_shutdown ( &download->job, rc );
+}
+
+/** Background download interface operations */
+static struct interface_operation image_download_operations[] = {
+	INTF_OP ( intf_close, struct image_download *, image_download_close ),
+};
+
+/** Background download interface descriptor */
+static struct interface_descriptor image_download_desc =
+	INTF_DESC ( struct image_download, job, image_download_operations );
+
+/**
+ * Start downloading a new image in the background
+ *
+ * @v uri_string	URI string
+ * @v image		Image to fill in
+ * @ret rc		Return status code
+ *
+ * The image is registered (and the download reported) only when the
+ * download completes; use imgwait() to wait for completion.
+ */
+int imgdownload_bg_string ( const char *uri_string, struct image **image ) {
+	struct image_download *download;
+	struct uri *uri;
+	int rc;
+
+	/* Parse and resolve URI */
+	uri = parse_uri ( uri_string );
+	if ( ! uri ) {
+		rc = -ENOMEM;
+		goto err_parse_uri;
+	}
+	uri = resolve_uri ( cwuri, uri );
+	if ( ! uri ) {
+		rc = -ENOMEM;
+		goto err_resolve_uri;
+	}
+
+	/* Allocate image */
+	*image = alloc_image ( uri );
+	if ( ! *image ) {
+		rc = -ENOMEM;
+		goto err_alloc_image;
+	}
+
+	/* Allocate and initialise download */
+	download = zalloc ( sizeof ( *download ) );
+	if ( ! download ) {
+		rc = -ENOMEM;
+		goto err_alloc_download;
+	}
+	ref_init ( &download->refcnt, image_download_free );
+	intf_init ( &download->job, &image_download_desc, &download->refcnt );
+	download->image = image_get ( *image );
+
+	/* Create downloader */
+	if ( ( rc = create_downloader ( &download->job, *image ) ) != 0 ) {
+		printf ( "Could not start download: %s\n", strerror ( rc ) );
+		goto err_create_downloader;
+	}
+
+	/* Add to list of background downloads (transferring reference) */
+	list_add_tail ( &download->list, &image_downloads );
+
+	image_put ( *image );
+	uri_put ( uri );
+	return 0;
+
+ err_create_downloader:
+	ref_put ( &download->refcnt );
+ err_alloc_download:
+	image_put ( *image );
+ err_alloc_image:
+ err_resolve_uri:
+	uri_put ( uri );
+ err_parse_uri:
+	return rc;
+}
+
+/**
+ * Wait for all background downloads to complete
+ *
+ * @v timeout		Timeout period, in ticks (0=indefinite)
+ * @ret rc		Return status code
+ *
+ * Completed downloads are reported and reaped as they finish.  The
+ * return status is that of the first failed download, if any.
+ */
+int imgwait ( unsigned long timeout ) {
+	struct image_download *download;
+	struct image_download *tmp;
+	unsigned long start = currticks();
+	int cancel_rc = 0;
+	int rc = 0;
+	int key;
+
+	while ( ! list_empty ( &image_downloads ) ) {
+
+		/* Allow downloads to progress */
+		step();
+
+		/* Reap completed downloads */
+		list_for_each_entry_safe ( download, tmp, &image_downloads,
+					   list ) {
+			if ( ! download->done )
+				continue;
+			if ( download->rc == 0 ) {
+				printf ( "Downloaded %s\n",
+					 download->image->name );
+			} else {
+				printf ( "Could not download %s: %s\n",
+					 download->image->name,
+					 strerror ( download->rc ) );
+				if ( rc == 0 )
+					rc = download->rc;
+			}
+			list_del ( &download->list );
+			ref_put ( &download->refcnt );
+		}
+
+		/* Check for cancellation or timeout */
+		if ( iskey() && ( ( key = getchar() ) == CTRL_C ) )
+			cancel_rc = -ECANCELED;
+		if ( timeout && ( ( currticks() - start ) >= timeout ) )
+			cancel_rc = -ETIMEDOUT;
+
+		/* Cancel all remaining downloads, if applicable */
+		if ( cancel_rc ) {
+			list_for_each_entry ( download, &image_downloads,
+					      list ) {
+				intf_shutdown ( &download->job, cancel_rc );
+				download->done = 1;
+				download->rc = cancel_rc;
+			}
+			if ( rc == 0 )
+				rc = cancel_rc;
+		}
+	}
+
+	return rc;
+}
+
 /**
  * Acquire an image
  *
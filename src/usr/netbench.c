@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <byteswap.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/job.h>
+#include <ipxe/xfer.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/open.h>
+#include <ipxe/socket.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/udp.h>
+#include <ipxe/process.h>
+#include <ipxe/timer.h>
+#include <ipxe/monojob.h>
+#include <usr/netbench.h>
+
+/** @file
+ *
+ * Network benchmarking
+ *
+ * Unlike the loopback test, which exercises the raw driver datapath
+ * between two local ports, the network benchmark measures achievable
+ * throughput against a remote peer via the normal protocol stack.
+ * The transmit modes flood the peer as fast as the data transfer
+ * window allows; the receive mode acts as a sink and uses sequence
+ * numbers (as generated by a peer running in UDP transmit mode) to
+ * account for dropped datagrams.
+ */
+
+/** A network benchmark datagram header */
+struct netbench_header {
+	/** Sequence number */
+	uint32_t sequence;
+} __attribute__ (( packed ));
+
+/** Maximum number of packets to transmit per process step
+ *
+ * This is a policy decision.  Bounding the per-step burst keeps the
+ * transmit pump from starving other processes (including the network
+ * device polling that refills hardware rings).
+ */
+#define NETBENCH_BURST 8
+
+/** A network benchmark */
+struct netbench_test {
+	/** Reference count */
+	struct refcnt refcnt;
+
+	/** Job control interface */
+	struct interface job;
+	/** Data transfer interface */
+	struct interface socket;
+	/** Transmit process */
+	struct process process;
+
+	/** Benchmark mode */
+	int mode;
+	/** Payload length */
+	size_t len;
+	/** Benchmark duration (in ticks) */
+	unsigned long duration;
+
+	/** Benchmark has started (first packet transferred) */
+	int started;
+	/** Start time (in ticks) */
+	unsigned long start;
+	/** Next transmit (or expected receive) sequence number */
+	uint32_t sequence;
+	/** Number of packets transferred */
+	unsigned long packets;
+	/** Number of bytes transferred */
+	unsigned long long bytes;
+	/** Number of dropped packets (from sequence gaps) */
+	unsigned long drops;
+};
+
+/**
+ * Print benchmark report
+ *
+ * @v netbench		Network benchmark
+ */
+static void netbench_report ( struct netbench_test *netbench ) {
+	unsigned long long bps;
+	unsigned long ticks;
+	unsigned long pps;
+
+	/* Do nothing if no packets were ever transferred */
+	if ( ! netbench->started )
+		return;
+
+	/* Calculate rates, avoiding division by zero */
+	ticks = ( currticks() - netbench->start );
+	if ( ! ticks )
+		ticks = 1;
+	pps = ( ( netbench->packets * TICKS_PER_SEC ) / ticks );
+	bps = ( ( netbench->bytes * 8 * TICKS_PER_SEC ) / ticks );
+
+	/* Print report */
+	printf ( "%ld packets, %lld bytes, %ld dropped in %ld.%02ld "
+		 "seconds\n", netbench->packets, netbench->bytes,
+		 netbench->drops, ( ticks / TICKS_PER_SEC ),
+		 ( ( ( ticks % TICKS_PER_SEC ) * 100 ) / TICKS_PER_SEC ) );
+	printf ( "%ld packets/s, %lld.%02lld Mbit/s\n", pps,
+		 ( bps / 1000000 ), ( ( bps % 1000000 ) / 10000 ) );
+}
+
+/**
+ * Close network benchmark
+ *
+ * @v netbench		Network benchmark
+ * @v rc		Reason for close
+ */
+static void netbench_close ( struct netbench_test *netbench, int rc ) {
+
+	/* Print benchmark report */
+	netbench_report ( netbench );
+
+	/* Stop transmit process */
+	process_del ( &netbench->process );
+
+	/* Shut down interfaces */
+	intf_shutdown ( &netbench->socket, rc );
+	intf_shutdown ( &netbench->job, rc );
+}
+
+/**
+ * Transmit packets and check for benchmark completion
+ *
+ * @v netbench		Network benchmark
+ */
+static void netbench_step ( struct netbench_test *netbench ) {
+	struct netbench_header *hdr;
+	struct io_buffer *iobuf;
+	unsigned int burst;
+	int rc;
+
+	/* Terminate when the benchmark duration has elapsed */
+	if ( netbench->started &&
+	     ( ( currticks() - netbench->start ) >= netbench->duration ) ) {
+		netbench_close ( netbench, 0 );
+		return;
+	}
+
+	/* Do nothing more in receive mode */
+	if ( netbench->mode == NETBENCH_UDP_RX )
+		return;
+
+	/* Transmit a burst of packets, as permitted by the window */
+	for ( burst = 0 ; burst < NETBENCH_BURST ; burst++ ) {
+
+		/* Wait for the window to reopen */
+		if ( xfer_window ( &netbench->socket ) < netbench->len )
+			break;
+
+		/* Allocate and fill I/O buffer */
+		iobuf = xfer_alloc_iob ( &netbench->socket, netbench->len );
+		if ( ! iobuf )
+			break;
+		memset ( iob_put ( iobuf, netbench->len ), 0,
+			 netbench->len );
+		if ( netbench->mode == NETBENCH_UDP_TX ) {
+			hdr = iobuf->data;
+			hdr->sequence = htonl ( netbench->sequence++ );
+		}
+
+		/* Transmit packet */
+		if ( ( rc = xfer_deliver_iob ( &netbench->socket,
+					       iob_disown ( iobuf ) ) ) != 0 ){
+			netbench_close ( netbench, rc );
+			return;
+		}
+
+		/* Update statistics */
+		if ( ! netbench->started ) {
+			netbench->started = 1;
+			netbench->start = currticks();
+		}
+		netbench->packets++;
+		netbench->bytes += netbench->len;
+	}
+}
+
+/**
+ * Handle received data
+ *
+ * @v netbench		Network benchmark
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int netbench_deliver ( struct netbench_test *netbench,
+			      struct io_buffer *iobuf,
+			      struct xfer_metadata *meta __unused ) {
+	struct netbench_header *hdr;
+	uint32_t sequence;
+
+	/* Record start time on first packet */
+	if ( ! netbench->started ) {
+		netbench->started = 1;
+		netbench->start = currticks();
+	}
+
+	/* Update statistics */
+	netbench->packets++;
+	netbench->bytes += iob_len ( iobuf );
+
+	/* Account for sequence gaps, if applicable.  Late or
+	 * duplicated datagrams are simply ignored.
+	 */
+	if ( ( netbench->mode == NETBENCH_UDP_RX ) &&
+	     ( iob_len ( iobuf ) >= sizeof ( *hdr ) ) ) {
+		hdr = iobuf->data;
+		sequence = ntohl ( hdr->sequence );
+		if ( netbench->packets == 1 ) {
+			netbench->sequence = ( sequence + 1 );
+		} else if ( sequence >= netbench->sequence ) {
+			netbench->drops += ( sequence - netbench->sequence );
+			netbench->sequence = ( sequence + 1 );
+		}
+	}
+
+	free_iob ( iobuf );
+	return 0;
+}
+
+/** Network benchmark data transfer interface operations */
+static struct interface_operation netbench_socket_op[] = {
+	INTF_OP ( xfer_deliver, struct netbench_test *, netbench_deliver ),
+	INTF_OP ( intf_close, struct netbench_test *, netbench_close ),
+};
+
+/** Network benchmark data transfer interface descriptor */
+static struct interface_descriptor netbench_socket_desc =
+	INTF_DESC ( struct netbench_test, socket, netbench_socket_op );
+
+/** Network benchmark job control interface operations */
+static struct interface_operation netbench_job_op[] = {
+	INTF_OP ( intf_close, struct netbench_test *, netbench_close ),
+};
+
+/** Network benchmark job control interface descriptor */
+static struct interface_descriptor netbench_job_desc =
+	INTF_DESC ( struct netbench_test, job, netbench_job_op );
+
+/** Network benchmark process descriptor */
+static struct process_descriptor netbench_process_desc =
+	PROC_DESC ( struct netbench_test, process, netbench_step );
+
+/**
+ * Create network benchmark
+ *
+ * @v job		Job control interface
+ * @v mode		Benchmark mode
+ * @v hostname		Hostname (or NULL in receive mode)
+ * @v port		Port number
+ * @v len		Payload length
+ * @v duration		Benchmark duration (in ticks)
+ * @ret rc		Return status code
+ */
+static int create_netbench ( struct interface *job, int mode,
+			     const char *hostname, unsigned int port,
+			     size_t len, unsigned long duration ) {
+	struct netbench_test *netbench;
+	struct sockaddr_tcpip st;
+	int rc;
+
+	/* Sanity checks */
+	if ( len < sizeof ( struct netbench_header ) )
+		return -EINVAL;
+
+	/* Allocate and initialise structure */
+	netbench = zalloc ( sizeof ( *netbench ) );
+	if ( ! netbench )
+		return -ENOMEM;
+	ref_init ( &netbench->refcnt, NULL );
+	intf_init ( &netbench->job, &netbench_job_desc, &netbench->refcnt );
+	intf_init ( &netbench->socket, &netbench_socket_desc,
+		    &netbench->refcnt );
+	process_init ( &netbench->process, &netbench_process_desc,
+		       &netbench->refcnt );
+	netbench->mode = mode;
+	netbench->len = len;
+	netbench->duration = duration;
+
+	/* Open socket */
+	memset ( &st, 0, sizeof ( st ) );
+	st.st_port = htons ( port );
+	if ( mode == NETBENCH_UDP_RX ) {
+		rc = udp_open ( &netbench->socket, NULL,
+				( ( struct sockaddr * ) &st ) );
+	} else {
+		rc = xfer_open_named_socket ( &netbench->socket,
+					      ( ( mode == NETBENCH_TCP_TX ) ?
+						SOCK_STREAM : SOCK_DGRAM ),
+					      ( ( struct sockaddr * ) &st ),
+					      hostname, NULL );
+	}
+	if ( rc != 0 ) {
+		DBGC ( netbench, "NETBENCH %p could not open socket: %s\n",
+		       netbench, strerror ( rc ) );
+		goto err;
+	}
+
+	/* Attach parent interface, mortalise self, and return */
+	intf_plug_plug ( &netbench->job, job );
+	ref_put ( &netbench->refcnt );
+	return 0;
+
+ err:
+	netbench_close ( netbench, rc );
+	ref_put ( &netbench->refcnt );
+	return rc;
+}
+
+/**
+ * Run network benchmark
+ *
+ * @v mode		Benchmark mode
+ * @v hostname		Hostname (or NULL in receive mode)
+ * @v port		Port number
+ * @v len		Payload length
+ * @v duration		Benchmark duration (in ticks)
+ * @ret rc		Return status code
+ */
+int netbench ( int mode, const char *hostname, unsigned int port,
+	       size_t len, unsigned long duration ) {
+	int rc;
+
+	/* Create benchmark */
+	if ( ( rc = create_netbench ( &monojob, mode, hostname, port, len,
+				      duration ) ) != 0 ) {
+		printf ( "Could not start benchmark: %s\n", strerror ( rc ) );
+		return rc;
+	}
+
+	/* Wait for benchmark to complete */
+	if ( ( rc = monojob_wait ( NULL, 0 ) ) != 0 ) {
+		printf ( "Finished: %s\n", strerror ( rc ) );
+		return rc;
+	}
+
+	return 0;
+}
@@ -29,6 +29,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/pinger.h>
 #include <ipxe/monojob.h>
 #include <ipxe/timer.h>
+#include <ipxe/profile.h>
 #include <usr/pingmgmt.h>
 
 /** @file
@@ -37,52 +38,123 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Ping statistics */
+struct ping_statistics {
+	/** Number of responses received */
+	unsigned int received;
+	/** Number of timeouts and errors */
+	unsigned int errors;
+	/** Round-trip time profiler */
+	struct profiler rtt;
+};
+
+/** Statistics for the ping currently in progress */
+static struct ping_statistics ping_stats;
+
+/** Inhibit per-response output */
+static int ping_quiet;
+
+/**
+ * Convert ticks to milliseconds
+ *
+ * @v ticks		Number of ticks
+ * @ret ms		Number of milliseconds
+ */
+static unsigned long ping_ms ( unsigned long ticks ) {
+	return ( ticks * 1000 / TICKS_PER_SEC );
+}
+
 /**
- * Display ping result
+ * Record and display ping result
  *
  * @v src		Source socket address, or NULL
  * @v sequence		Sequence number
  * @v len		Payload length
+ * @v rtt		Round-trip time (in ticks), or zero if unknown
  * @v rc		Status code
  */
 static void ping_callback ( struct sockaddr *peer, unsigned int sequence,
-			    size_t len, int rc ) {
+			    size_t len, unsigned long rtt, int rc ) {
+
+	/* Update statistics */
+	if ( rc == 0 ) {
+		ping_stats.received++;
+		profile_update ( &ping_stats.rtt, rtt );
+	} else {
+		ping_stats.errors++;
+	}
 
-	/* Display ping response */
+	/* Display ping response, unless in summary-only mode */
+	if ( ping_quiet )
+		return;
 	printf ( "%zd bytes from %s: seq=%d",
 		 len, ( peer ? sock_ntoa ( peer ) : "<none>" ), sequence );
+	if ( rtt )
+		printf ( " time=%ldms", ping_ms ( rtt ) );
 	if ( rc != 0 )
 		printf ( ": %s", strerror ( rc ) );
 	printf ( "\n" );
 }
 
+/**
+ * Display ping summary
+ *
+ * @v count		Number of packets sent (or zero if unlimited)
+ */
+static void ping_summary ( unsigned int count ) {
+	unsigned int sent;
+	unsigned int lost;
+
+	/* Calculate number of packets sent and lost.  In flood mode,
+	 * unanswered requests generate no per-packet callback and are
+	 * visible only here.
+	 */
+	sent = ( count ? count : ( ping_stats.received + ping_stats.errors ) );
+	lost = ( sent - ping_stats.received );
+
+	/* Display summary line */
+	printf ( "%d packets sent, %d received, %d%% lost",
+		 sent, ping_stats.received,
+		 ( sent ? ( lost * 100 / sent ) : 0 ) );
+	if ( ping_stats.received ) {
+		printf ( ", rtt avg/p50/p99 = %ld/%ld/%ldms",
+			 ping_ms ( profile_mean ( &ping_stats.rtt ) ),
+			 ping_ms ( profile_percentile ( &ping_stats.rtt, 50 )),
+			 ping_ms ( profile_percentile ( &ping_stats.rtt, 99 )));
+	}
+	printf ( "\n" );
+}
+
 /**
  * Ping a host
  *
  * @v hostname		Hostname
- * @v timeout		Timeout between pings, in ticks
+ * @v timeout		Timeout between pings in ticks, or zero to flood
  * @v len		Payload length
  * @v count		Number of packets to send (or zero for no limit)
- * @v quiet		Inhibit output
+ * @v quiet		Inhibit per-response output
  * @ret rc		Return status code
  */
 int ping ( const char *hostname, unsigned long timeout, size_t len,
 	   unsigned int count, int quiet ) {
 	int rc;
 
+	/* Reset statistics */
+	memset ( &ping_stats, 0, sizeof ( ping_stats ) );
+	ping_quiet = quiet;
+
 	/* Create pinger */
 	if ( ( rc = create_pinger ( &monojob, hostname, timeout, len, count,
-				    ( quiet ? NULL : ping_callback ) ) ) != 0 ){
+				    ping_callback ) ) != 0 ) {
 		printf ( "Could not start ping: %s\n", strerror ( rc ) );
 		return rc;
 	}
 
 	/* Wait for ping to complete */
-	if ( ( rc = monojob_wait ( NULL, 0 ) ) != 0 ) {
-		if ( ! quiet )
-			printf ( "Finished: %s\n", strerror ( rc ) );
-		return rc;
-	}
+	rc = monojob_wait ( NULL, 0 );
+
+	/* Display summary */
+	ping_summary ( count );
 
-	return 0;
+	return rc;
 }
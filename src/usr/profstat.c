@@ -24,6 +24,7 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdio.h>
+#include <syslog.h>
 #include <ipxe/profile.h>
 #include <usr/profstat.h>
 
@@ -41,8 +42,52 @@ void profstat ( void ) {
 	struct profiler *profiler;
 
 	for_each_table_entry ( profiler, PROFILERS ) {
-		printf ( "%s: %ld +/- %ld ticks (%d samples)\n",
+		printf ( "%s: %ld +/- %ld ticks (%d samples) "
+			 "p50 %ld p90 %ld p99 %ld",
 			 profiler->name, profile_mean ( profiler ),
-			 profile_stddev ( profiler ), profiler->count );
+			 profile_stddev ( profiler ), profiler->count,
+			 profile_percentile ( profiler, 50 ),
+			 profile_percentile ( profiler, 90 ),
+			 profile_percentile ( profiler, 99 ) );
+		if ( profile_mhz ) {
+			printf ( " (%lld ns)",
+				 ( ( ( ( unsigned long long )
+				       profile_mean ( profiler ) ) * 1000 ) /
+				   profile_mhz ) );
+		}
+		if ( profiler->pmc_count )
+			printf ( " pmc %ld", profile_pmc_mean ( profiler ) );
+		printf ( "\n" );
+	}
+}
+
+/**
+ * Export profiling statistics to the system log
+ *
+ * Each profiler is emitted as a single machine-parseable line of
+ * space-separated key=value fields, delivered to any console
+ * accepting log messages (e.g. a configured syslog server), so that
+ * external tooling can aggregate latency distributions across
+ * machines.
+ */
+void profstat_export ( void ) {
+	struct profiler *profiler;
+
+	for_each_table_entry ( profiler, PROFILERS ) {
+		log_printf ( "PROFSTAT name=%s count=%d mean=%ld stddev=%ld "
+			     "p50=%ld p90=%ld p99=%ld",
+			     profiler->name, profiler->count,
+			     profile_mean ( profiler ),
+			     profile_stddev ( profiler ),
+			     profile_percentile ( profiler, 50 ),
+			     profile_percentile ( profiler, 90 ),
+			     profile_percentile ( profiler, 99 ) );
+		if ( profile_mhz )
+			log_printf ( " mhz=%ld", profile_mhz );
+		if ( profiler->pmc_count ) {
+			log_printf ( " pmc=%ld",
+				     profile_pmc_mean ( profiler ) );
+		}
+		log_printf ( "\n" );
 	}
 }
@@ -35,6 +35,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dhcp.h>
 #include <ipxe/keys.h>
 #include <ipxe/timer.h>
+#include <ipxe/process.h>
 #include <ipxe/uri.h>
 #include <ipxe/ansicol.h>
 #include <usr/dhcpmgmt.h>
@@ -299,6 +300,10 @@ static int pxe_menu_prompt_and_select ( struct pxe_menu *menu ) {
 
 	/* Wait for timeout, if specified */
 	while ( menu->timeout > 0 ) {
+		/* Allow background work (e.g. speculative boot
+		 * server discovery) to proceed while waiting
+		 */
+		step();
 		if ( ! len )
 			len = printf ( " (%d)", menu->timeout );
 		if ( iskey() ) {
@@ -332,6 +337,34 @@ static int pxe_menu_prompt_and_select ( struct pxe_menu *menu ) {
 	return rc;
 }
 
+/** Speculative boot server discovery status */
+static int pxe_menu_discovery_rc;
+
+/**
+ * Handle speculative boot server discovery completion
+ *
+ * @v intf		Speculative boot server discovery interface
+ * @v rc		Reason for close
+ */
+static void pxe_menu_discovery_close ( struct interface *intf, int rc ) {
+
+	pxe_menu_discovery_rc = rc;
+	intf_restart ( intf, rc );
+}
+
+/** Speculative boot server discovery interface operations */
+static struct interface_operation pxe_menu_discovery_operations[] = {
+	INTF_OP ( intf_close, struct interface *, pxe_menu_discovery_close ),
+};
+
+/** Speculative boot server discovery interface descriptor */
+static struct interface_descriptor pxe_menu_discovery_desc =
+	INTF_DESC_PURE ( pxe_menu_discovery_operations );
+
+/** Speculative boot server discovery interface */
+static struct interface pxe_menu_discovery =
+	INTF_INIT ( pxe_menu_discovery_desc );
+
 /**
  * Boot using PXE boot menu
  *
@@ -344,6 +377,7 @@ static int pxe_menu_prompt_and_select ( struct pxe_menu *menu ) {
 int pxe_menu_boot ( struct net_device *netdev ) {
 	struct pxe_menu *menu;
 	unsigned int pxe_type;
+	unsigned int speculative;
 	struct settings *pxebs_settings;
 	struct uri *uri;
 	int rc;
@@ -352,8 +386,25 @@ int pxe_menu_boot ( struct net_device *netdev ) {
 	if ( ( rc = pxe_menu_parse ( &menu ) ) != 0 )
 		return rc;
 
+	/* Begin speculative boot server discovery for the default
+	 * menu item.  Discovery proceeds while the menu prompt is
+	 * counting down, so the common press-Enter-or-time-out path
+	 * finds its network legwork already complete.
+	 */
+	speculative = menu->items[0].type;
+	if ( speculative ) {
+		pxe_menu_discovery_rc = -EINPROGRESS;
+		if ( ( rc = start_pxebs ( &pxe_menu_discovery, netdev,
+					  speculative ) ) != 0 ) {
+			DBG ( "Could not start speculative discovery: %s\n",
+			      strerror ( rc ) );
+			speculative = 0;
+		}
+	}
+
 	/* Make selection from boot menu */
 	if ( ( rc = pxe_menu_prompt_and_select ( menu ) ) != 0 ) {
+		intf_restart ( &pxe_menu_discovery, -ECANCELED );
 		free ( menu );
 		return rc;
 	}
@@ -362,13 +413,36 @@ int pxe_menu_boot ( struct net_device *netdev ) {
 	/* Free boot menu */
 	free ( menu );
 
+	/* Cancel speculative discovery unless it matches the
+	 * selected item
+	 */
+	if ( speculative != pxe_type ) {
+		intf_restart ( &pxe_menu_discovery, -ECANCELED );
+		speculative = 0;
+	}
+
 	/* Return immediately if local boot selected */
 	if ( ! pxe_type )
 		return 0;
 
-	/* Attempt PXE Boot Server Discovery */
-	if ( ( rc = pxebs ( netdev, pxe_type ) ) != 0 )
+	/* Complete or perform PXE Boot Server Discovery */
+	if ( speculative ) {
+		printf ( "PXEBS (%s type %d)...", netdev->name, pxe_type );
+		while ( pxe_menu_discovery_rc == -EINPROGRESS ) {
+			step();
+			if ( iskey() && ( getchar() == CTRL_C ) ) {
+				pxe_menu_discovery_rc = -ECANCELED;
+				break;
+			}
+		}
+		rc = pxe_menu_discovery_rc;
+		intf_restart ( &pxe_menu_discovery, rc );
+		printf ( " %s\n", ( rc ? strerror ( rc ) : "ok" ) );
+		if ( rc != 0 )
+			return rc;
+	} else if ( ( rc = pxebs ( netdev, pxe_type ) ) != 0 ) {
 		return rc;
+	}
 
 	/* Fetch next server and filename */
 	pxebs_settings = find_settings ( PXEBS_SETTINGS_NAME );
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <ipxe/refcnt.h>
+#include <usr/refstat.h>
+
+/** @file
+ *
+ * Reference-counted object statistics
+ *
+ */
+
+/**
+ * Print reference-counted object statistics
+ *
+ */
+void refstat ( void ) {
+#ifdef REFCNT_STATS
+	struct refcnt_stat *stat;
+	unsigned int i;
+
+	for ( i = 0 ; i < REFCNT_STAT_MAX ; i++ ) {
+		stat = &refcnt_stats[i];
+		if ( ! stat->name )
+			continue;
+		printf ( "%s: live %d peak %d total %d\n", stat->name,
+			 stat->live, stat->peak, stat->total );
+	}
+#else
+	printf ( "Object tracking not enabled (REFCNT_STATS)\n" );
+#endif
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026 Michael Brown <mbrown@fensystems.co.uk>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <ipxe/timer.h>
+#include <ipxe/tcp.h>
+#include <usr/tcpstat.h>
+
+/** @file
+ *
+ * TCP connection statistics
+ *
+ */
+
+/**
+ * Convert ticks to milliseconds
+ *
+ * @v ticks		Number of ticks
+ * @ret ms		Number of milliseconds
+ */
+static unsigned long tcpstat_ms ( unsigned long ticks ) {
+	return ( ( ticks * 1000 ) / TICKS_PER_SEC );
+}
+
+/**
+ * Print TCP connection statistics
+ *
+ * Each connection reports the figures needed to attribute a slow
+ * transfer: round-trip time inflation (srtt), window exhaustion
+ * (in-flight versus peer and congestion windows, and accumulated
+ * zero-window time), and receiver-side stall (time for which our own
+ * data-transfer interface blocked reception).
+ */
+void tcpstat ( void ) {
+	struct tcp_stats stats;
+	unsigned int index;
+
+	for ( index = 0 ; tcp_stats ( index, &stats ) == 0 ; index++ ) {
+		printf ( "TCP :%d rtt %ldms +/- %ldms (%d samples)\n",
+			 stats.local_port, tcpstat_ms ( stats.srtt ),
+			 tcpstat_ms ( stats.rttvar ), stats.rtt_count );
+		printf ( "  inflight %d win %d cwnd %d\n",
+			 stats.in_flight, stats.snd_win, stats.snd_cwnd );
+		printf ( "  retrans %d stalls %d zerowin %ldms xferblock "
+			 "%ldms\n", stats.retransmits, stats.stalls,
+			 tcpstat_ms ( stats.zero_win_time ),
+			 tcpstat_ms ( stats.xfer_block_time ) );
+	}
+}
@@ -16,6 +16,20 @@
 /* LZMA preset choice.  This is a policy decision */
 #define LZMA_PRESET ( LZMA_PRESET_DEFAULT | LZMA_PRESET_EXTREME )
 
+/* LZ4 block format parameters.  Must match those used by unlz4.S */
+#define LZ4_MIN_MATCH 4
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_LAST_LITERALS 5
+#define LZ4_SAFE_DISTANCE 12
+
+/* LZ4 match finder parameters.  These are policy decisions */
+#define LZ4_HASH_BITS 16
+#define LZ4_HASH_SIZE ( 1UL << LZ4_HASH_BITS )
+#define LZ4_MAX_CHAIN 1024
+
+/* Compression format (defaulting to LZMA) */
+static const char *pack_fmt = "lzma";
+
 struct input_file {
 	void *buf;
 	size_t len;
@@ -260,6 +274,154 @@ static uint32_t crc32_le ( uint32_t crc, const void *data, size_t len ) {
 	return crc;
 }
 
+static unsigned int lz4_hash ( const uint8_t *data ) {
+	uint32_t seq;
+
+	memcpy ( &seq, data, sizeof ( seq ) );
+	seq *= 2654435761U;
+	return ( seq >> ( 32 - LZ4_HASH_BITS ) );
+}
+
+static uint8_t * lz4_put_length ( uint8_t *out, size_t len ) {
+	/* Write continuation bytes for a length of 15 or greater */
+	for ( len -= 15 ; len >= 255 ; len -= 255 )
+		*(out++) = 255;
+	*(out++) = len;
+	return out;
+}
+
+static int lz4_compress ( const void *data, size_t len, void *packed,
+			  size_t *packed_len, size_t max_len ) {
+	const uint8_t *src = data;
+	uint8_t *out = packed;
+	uint8_t *token;
+	int32_t *head = NULL;
+	int32_t *prev = NULL;
+	size_t anchor = 0;
+	size_t pos = 0;
+	size_t insert;
+	size_t limit;
+	size_t match_len;
+	size_t best_len;
+	size_t best_pos = 0;
+	size_t literals;
+	size_t offset;
+	size_t needed;
+	unsigned int chain;
+	int32_t cand;
+	int rc = -1;
+
+	/* Allocate hash chain match finder state */
+	head = malloc ( LZ4_HASH_SIZE * sizeof ( *head ) );
+	prev = malloc ( len * sizeof ( *prev ) );
+	if ( ( ! head ) || ( ! prev ) ) {
+		fprintf ( stderr, "Could not allocate LZ4 state\n" );
+		goto done;
+	}
+	memset ( head, 0xff, ( LZ4_HASH_SIZE * sizeof ( *head ) ) );
+
+	while ( pos < len ) {
+
+		/* Find longest match at current position, honouring the
+		 * block format's end-of-block restrictions: a match may
+		 * not start within the last twelve bytes, and the last
+		 * five bytes must be literals.
+		 */
+		best_len = 0;
+		if ( ( pos + LZ4_SAFE_DISTANCE ) <= len ) {
+			limit = ( len - LZ4_LAST_LITERALS - pos );
+			cand = head[ lz4_hash ( src + pos ) ];
+			for ( chain = 0 ; ( ( cand >= 0 ) &&
+					    ( chain < LZ4_MAX_CHAIN ) ) ;
+			      chain++, cand = prev[cand] ) {
+				if ( ( pos - cand ) > LZ4_MAX_OFFSET )
+					break;
+				match_len = 0;
+				while ( ( match_len < limit ) &&
+					( src[ cand + match_len ] ==
+					  src[ pos + match_len ] ) )
+					match_len++;
+				if ( match_len > best_len ) {
+					best_len = match_len;
+					best_pos = cand;
+				}
+			}
+		}
+
+		/* Emit literals only, if no usable match was found */
+		if ( best_len < LZ4_MIN_MATCH ) {
+			if ( ( pos + LZ4_MIN_MATCH ) <= len ) {
+				insert = lz4_hash ( src + pos );
+				prev[pos] = head[insert];
+				head[insert] = pos;
+			}
+			pos++;
+			continue;
+		}
+
+		/* Check for output buffer overrun */
+		literals = ( pos - anchor );
+		needed = ( 3 /* token and match offset */ + literals +
+			   ( literals / 255 ) + ( best_len / 255 ) + 2 );
+		if ( ( ( out - ( ( uint8_t * ) packed ) ) + needed ) > max_len )
+			goto done;
+
+		/* Emit sequence */
+		token = out++;
+		if ( literals >= 15 ) {
+			*token = 0xf0;
+			out = lz4_put_length ( out, literals );
+		} else {
+			*token = ( literals << 4 );
+		}
+		memcpy ( out, ( src + anchor ), literals );
+		out += literals;
+		offset = ( pos - best_pos );
+		*(out++) = ( offset & 0xff );
+		*(out++) = ( offset >> 8 );
+		if ( ( best_len - LZ4_MIN_MATCH ) >= 15 ) {
+			*token |= 0x0f;
+			out = lz4_put_length ( out, ( best_len -
+						      LZ4_MIN_MATCH ) );
+		} else {
+			*token |= ( best_len - LZ4_MIN_MATCH );
+		}
+
+		/* Index the matched bytes */
+		for ( ; pos < ( anchor + literals + best_len ) ; pos++ ) {
+			if ( ( pos + LZ4_MIN_MATCH ) > len )
+				continue;
+			insert = lz4_hash ( src + pos );
+			prev[pos] = head[insert];
+			head[insert] = pos;
+		}
+		anchor = pos;
+	}
+
+	/* Emit trailing literals */
+	literals = ( len - anchor );
+	needed = ( 1 + literals + ( literals / 255 ) );
+	if ( ( ( out - ( ( uint8_t * ) packed ) ) + needed ) > max_len )
+		goto done;
+	token = out++;
+	if ( literals >= 15 ) {
+		*token = 0xf0;
+		out = lz4_put_length ( out, literals );
+	} else {
+		*token = ( literals << 4 );
+	}
+	memcpy ( out, ( src + anchor ), literals );
+	out += literals;
+
+	*packed_len = ( out - ( ( uint8_t * ) packed ) );
+	rc = 0;
+
+ done:
+	free ( prev );
+	free ( head );
+	return rc;
+}
+
 static int process_zinfo_pack ( struct input_file *input,
 				struct output_file *output,
 				union zinfo_record *zinfo ) {
@@ -296,15 +458,24 @@ static int process_zinfo_pack ( struct input_file *input,
 
 	packed = ( output->buf + output->len );
 	remaining = ( output->max_len - output->len );
-	lzma_lzma_preset ( &options, LZMA_PRESET );
-	options.lc = LZMA_LC;
-	options.lp = LZMA_LP;
-	options.pb = LZMA_PB;
-	if ( lzma_raw_buffer_encode ( filters, NULL, ( input->buf + offset ),
-				      len, packed, &packed_len,
-				      remaining ) != LZMA_OK ) {
-		fprintf ( stderr, "Compression failure\n" );
-		return -1;
+	if ( strcmp ( pack_fmt, "lz4" ) == 0 ) {
+		if ( lz4_compress ( ( input->buf + offset ), len, packed,
+				    &packed_len, remaining ) != 0 ) {
+			fprintf ( stderr, "Compression failure\n" );
+			return -1;
+		}
+	} else {
+		lzma_lzma_preset ( &options, LZMA_PRESET );
+		options.lc = LZMA_LC;
+		options.lp = LZMA_LP;
+		options.pb = LZMA_PB;
+		if ( lzma_raw_buffer_encode ( filters, NULL,
+					      ( input->buf + offset ),
+					      len, packed, &packed_len,
+					      remaining ) != LZMA_OK ) {
+			fprintf ( stderr, "Compression failure\n" );
+			return -1;
+		}
 	}
 	output->len += packed_len;
 
@@ -573,11 +744,19 @@ int main ( int argc, char **argv ) {
 	struct zinfo_file zinfo;
 	unsigned int i;
 
-	if ( argc != 3 ) {
-		fprintf ( stderr, "Syntax: %s file.bin file.zinfo "
+	if ( ( argc < 3 ) || ( argc > 4 ) ) {
+		fprintf ( stderr, "Syntax: %s file.bin file.zinfo [lzma|lz4] "
 			  "> file.zbin\n", argv[0] );
 		exit ( 1 );
 	}
+	if ( argc == 4 ) {
+		pack_fmt = argv[3];
+		if ( ( strcmp ( pack_fmt, "lzma" ) != 0 ) &&
+		     ( strcmp ( pack_fmt, "lz4" ) != 0 ) ) {
+			fprintf ( stderr, "Unknown format \"%s\"\n", pack_fmt );
+			exit ( 1 );
+		}
+	}
 
 	if ( read_input_file ( argv[1], &input ) < 0 )
 		exit ( 1 );
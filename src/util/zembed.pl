@@ -0,0 +1,35 @@
+#!/usr/bin/perl -w
+#
+# Compress an embedded image file.  The output comprises a 4-byte
+# little-endian uncompressed length followed by a raw DEFLATE stream,
+# as expected by embedded_decompress() in image/embedded.c.
+#
+# Usage:
+#
+#   zembed.pl <input> <output>
+#
+
+use strict;
+use warnings;
+use IO::Compress::RawDeflate qw ( rawdeflate $RawDeflateError );
+
+die "Syntax: $0 <input> <output>\n" unless @ARGV == 2;
+my ( $input, $output ) = @ARGV;
+
+# Read input file
+open ( my $in, '<', $input ) or die "Could not open $input: $!\n";
+binmode $in;
+my $data = do { local $/; <$in> };
+close ( $in );
+
+# Compress to a raw DEFLATE stream
+my $compressed;
+rawdeflate ( \$data => \$compressed, Level => 9 )
+    or die "Could not compress $input: $RawDeflateError\n";
+
+# Write uncompressed length and compressed data
+open ( my $out, '>', $output ) or die "Could not open $output: $!\n";
+binmode $out;
+print $out pack ( 'V', length $data );
+print $out $compressed;
+close ( $out );